@@ -71,6 +71,10 @@ endif()
 
 if (ENABLE_CPU)
     add_compile_definitions(ENABLE_CPU)
+    if (NOT ${CMAKE_SYSTEM_NAME} MATCHES "Windows")
+        set(ENABLE_CPUQUE ON)
+        add_compile_definitions(ENABLE_CPUQUE)
+    endif()
 endif()
 
 if (ENABLE_GE)
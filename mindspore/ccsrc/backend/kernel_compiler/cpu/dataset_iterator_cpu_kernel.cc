@@ -0,0 +1,119 @@
+/**
+ * Copyright 2021 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "backend/kernel_compiler/cpu/dataset_iterator_cpu_kernel.h"
+#include <algorithm>
+#include "runtime/device/cpu/cpu_device_address.h"
+
+namespace mindspore {
+namespace kernel {
+namespace {
+constexpr size_t kMaxWaitRetry = 10;
+}  // namespace
+
+void DatasetIteratorCPUKernel::InitKernel(const CNodePtr &kernel_node) {
+  MS_EXCEPTION_IF_NULL(kernel_node);
+  queue_name_ = AnfAlgo::GetNodeAttr<std::string>(kernel_node, "shared_name");
+  queue_ = device::cpu::CpuDataQueueMgr::GetInstance().Get(queue_name_, device::cpu::kCpuDataQueueWaitTimeInSec);
+  if (queue_ == nullptr) {
+    MS_LOG(EXCEPTION) << "Cpu Queue(" << queue_name_ << ") Open Failed";
+  }
+}
+
+void DatasetIteratorCPUKernel::InitInputOutputSize(const CNodePtr &kernel_node) {
+  MS_EXCEPTION_IF_NULL(kernel_node);
+  auto shapes = AnfAlgo::GetNodeAttr<std::vector<std::vector<int64_t>>>(kernel_node, "shapes");
+  auto types = AnfAlgo::GetNodeAttr<std::vector<TypePtr>>(kernel_node, "types");
+  if (shapes.size() != types.size()) {
+    MS_LOG(EXCEPTION) << "Invalid shapes: " << shapes << ", types: " << types;
+  }
+  for (size_t i = 0; i < shapes.size(); i++) {
+    MS_EXCEPTION_IF_NULL(types[i]);
+    size_t bytes = GetTypeByte(types[i]);
+    for (auto dim : shapes[i]) {
+      bytes *= LongToSize(dim);
+    }
+    output_size_list_.push_back(bytes);
+  }
+}
+
+bool DatasetIteratorCPUKernel::BindFrontData(std::vector<device::cpu::DataItemCpu> *items) {
+  MS_EXCEPTION_IF_NULL(items);
+  MS_EXCEPTION_IF_NULL(queue_);
+  size_t repeat = 0;
+  while (true) {
+    auto ret = queue_->Front(items, device::cpu::kCpuDataQueueWaitTimeInSec);
+    if (ret == device::cpu::kCpuQueueSuccess) {
+      break;
+    }
+    if (ret == device::cpu::kCpuQueueTimeout && ++repeat < kMaxWaitRetry) {
+      MS_LOG(INFO) << "Waiting for data...(" << repeat << " / " << kMaxWaitRetry << ")";
+      continue;
+    }
+    MS_LOG(ERROR) << "Get data from cpu queue " << queue_name_ << " failed, errcode " << ret;
+    return false;
+  }
+  if (items->size() != output_size_list_.size()) {
+    MS_LOG(ERROR) << "Dataset front error. read " << items->size() << " items, expect: " << output_size_list_.size();
+    return false;
+  }
+  for (size_t i = 0; i < items->size(); i++) {
+    if ((*items)[i].data_len_ != output_size_list_[i]) {
+      MS_LOG(ERROR) << "Dataset front error. item " << i << " read: " << (*items)[i].data_len_
+                    << ", expect: " << output_size_list_[i];
+      return false;
+    }
+  }
+  front_bound_ = true;
+  return true;
+}
+
+void DatasetIteratorCPUKernel::ReleaseFrontData() {
+  if (front_bound_ && queue_ != nullptr) {
+    (void)queue_->Pop();
+  }
+  front_bound_ = false;
+}
+
+bool DatasetIteratorCPUKernel::Launch(const std::vector<kernel::AddressPtr> & /*inputs*/,
+                                      const std::vector<kernel::AddressPtr> & /*workspace*/,
+                                      const std::vector<kernel::AddressPtr> &outputs) {
+  std::vector<device::cpu::DataItemCpu> items;
+  if (front_bound_) {
+    if (queue_->Front(&items, 0) != device::cpu::kCpuQueueSuccess) {
+      MS_LOG(ERROR) << "Get the bound data from cpu queue " << queue_name_ << " failed.";
+      return false;
+    }
+  } else if (!BindFrontData(&items)) {
+    return false;
+  }
+  if (outputs.size() != items.size()) {
+    MS_LOG(ERROR) << "Output number " << outputs.size() << " does not match the data number " << items.size();
+    return false;
+  }
+  for (size_t i = 0; i < outputs.size(); i++) {
+    // Nothing to do when the runtime has bound this output to the staging slot already.
+    if (outputs[i]->addr == items[i].data_ptr_ || items[i].data_len_ == 0) {
+      continue;
+    }
+    if (memcpy_s(outputs[i]->addr, outputs[i]->size, items[i].data_ptr_, items[i].data_len_) != EOK) {
+      MS_LOG(ERROR) << "Memcpy of output " << i << " failed.";
+      return false;
+    }
+  }
+  return true;
+}
+}  // namespace kernel
+}  // namespace mindspore
@@ -0,0 +1,57 @@
+/**
+ * Copyright 2021 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef MINDSPORE_CCSRC_BACKEND_KERNEL_COMPILER_CPU_DATASET_ITERATOR_CPU_KERNEL_H_
+#define MINDSPORE_CCSRC_BACKEND_KERNEL_COMPILER_CPU_DATASET_ITERATOR_CPU_KERNEL_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+#include "backend/kernel_compiler/cpu/cpu_kernel.h"
+#include "runtime/device/cpu/cpu_data_queue.h"
+
+namespace mindspore {
+namespace kernel {
+// GetNext on CPU. The outputs are not copied: the cpu runtime binds the output addresses of this kernel to the
+// staging slot at the front of the dataset queue (BindFrontData) and gives the slot back once the graph has run
+// (ReleaseFrontData), while the dataset fills the other slot with the next batch.
+class DatasetIteratorCPUKernel : public CPUKernel {
+ public:
+  DatasetIteratorCPUKernel() = default;
+  ~DatasetIteratorCPUKernel() override = default;
+
+  void InitKernel(const CNodePtr &kernel_node) override;
+
+  // Fallback used when the outputs were not bound to the queue, copies the front batch into the outputs.
+  bool Launch(const std::vector<AddressPtr> &inputs, const std::vector<AddressPtr> &workspace,
+              const std::vector<AddressPtr> &outputs) override;
+
+  // Get the buffers of the batch at the front of the queue, one per output.
+  bool BindFrontData(std::vector<device::cpu::DataItemCpu> *items);
+  // Give the slot of the current batch back to the dataset.
+  void ReleaseFrontData();
+
+ protected:
+  void InitInputOutputSize(const CNodePtr &kernel_node) override;
+
+ private:
+  std::string queue_name_;
+  std::shared_ptr<device::cpu::CpuDataQueue> queue_{nullptr};
+  bool front_bound_{false};
+};
+}  // namespace kernel
+}  // namespace mindspore
+
+#endif  // MINDSPORE_CCSRC_BACKEND_KERNEL_COMPILER_CPU_DATASET_ITERATOR_CPU_KERNEL_H_
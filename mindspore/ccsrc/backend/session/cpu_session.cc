@@ -24,6 +24,9 @@
 #include "backend/session/anf_runtime_algorithm.h"
 #include "runtime/device/kernel_runtime.h"
 #include "backend/kernel_compiler/cpu/cpu_kernel_factory.h"
+#ifdef ENABLE_CPUQUE
+#include "backend/kernel_compiler/cpu/dataset_iterator_cpu_kernel.h"
+#endif
 #include "runtime/device/cpu/kernel_select_cpu.h"
 #include "backend/optimizer/common/optimizer.h"
 #include "backend/optimizer/common/pass_manager.h"
@@ -153,6 +156,10 @@ void CPUSession::BuildOpImpl(const OpRunInfo &op_run_info, const GraphInfo &grap
   MS_EXCEPTION_IF_NULL(kernel_graph);
   SetKernelInfo(kernel_graph.get());
   BuildKernel(kernel_graph.get());
+  // the execution order of a cached op graph is fixed, reorder it once here instead of on every run
+  auto execution_order = kernel_graph->execution_order();
+  Reorder(&execution_order);
+  kernel_graph->set_execution_order(execution_order);
   run_op_graphs_[graph_info] = kernel_graph;
 }
 
@@ -178,7 +185,11 @@ void CPUSession::RunOpImpl(const GraphInfo &graph_info, OpRunInfo *op_run_info,
   BuildOpImpl(*op_run_info, graph_info, *input_tensors, tensors_mask);
   EraseValueNodeTensor(tensors_mask, input_tensors);
 
-  auto kernel_graph = run_op_graphs_[graph_info];
+  auto graph_iter = run_op_graphs_.find(graph_info);
+  if (graph_iter == run_op_graphs_.end()) {
+    MS_LOG(EXCEPTION) << "Can not find the graph of op " << op_run_info->op_name;
+  }
+  const auto &kernel_graph = graph_iter->second;
   MS_EXCEPTION_IF_NULL(kernel_graph);
 
   runtime_.AssignKernelAddress(kernel_graph.get());
@@ -187,11 +198,6 @@ void CPUSession::RunOpImpl(const GraphInfo &graph_info, OpRunInfo *op_run_info,
   runtime_.BindInputOutput(kernel_graph.get(), *input_tensors, outputs);
 
   MS_LOG(INFO) << "Run Op start";
-  auto execution_order = kernel_graph->execution_order();
-  Reorder(&execution_order);
-
-  kernel_graph->set_execution_order(execution_order);
-
   bool ret = runtime_.Run(kernel_graph.get(), false);
   if (!ret) {
     MS_LOG(EXCEPTION) << "Run Op failed";
@@ -260,8 +266,15 @@ void CPUSession::BuildKernel(const KernelGraph *kernel_graph) {
     MS_EXCEPTION_IF_NULL(kernel_node);
     std::string kernel_name = AnfAlgo::GetCNodeName(kernel_node);
     MS_LOG(INFO) << "Cpu building operator[" << kernel_name << "].";
-    std::shared_ptr<kernel::CPUKernel> cpu_kernel =
-      kernel::CPUKernelFactory::GetInstance().Create(kernel_name, kernel_node);
+    std::shared_ptr<kernel::CPUKernel> cpu_kernel = nullptr;
+#ifdef ENABLE_CPUQUE
+    if (kernel_name == kGetNextOpName) {
+      cpu_kernel = std::make_shared<kernel::DatasetIteratorCPUKernel>();
+    }
+#endif
+    if (cpu_kernel == nullptr) {
+      cpu_kernel = kernel::CPUKernelFactory::GetInstance().Create(kernel_name, kernel_node);
+    }
     if (cpu_kernel == nullptr) {
       KernelNotSupportException(kernel_node);
     }
@@ -431,14 +431,14 @@ BucketBatchByLengthDataset::BucketBatchByLengthDataset(
   const std::vector<int32_t> &bucket_boundaries, const std::vector<int32_t> &bucket_batch_sizes,
   std::function<TensorRow(TensorRow)> element_length_function,
   const std::map<std::string, std::pair<TensorShape, std::shared_ptr<Tensor>>> &pad_info, bool pad_to_bucket_boundary,
-  bool drop_remainder) {
+  bool drop_remainder, int64_t max_tokens_per_batch, int32_t lookahead_rows) {
   std::shared_ptr<TensorOp> c_func = nullptr;
   if (element_length_function != nullptr) {
     c_func = std::make_shared<CFuncOp>(element_length_function);
   }
-  auto ds =
-    std::make_shared<BucketBatchByLengthNode>(input->IRNode(), column_names, bucket_boundaries, bucket_batch_sizes,
-                                              c_func, pad_info, pad_to_bucket_boundary, drop_remainder);
+  auto ds = std::make_shared<BucketBatchByLengthNode>(input->IRNode(), column_names, bucket_boundaries,
+                                                      bucket_batch_sizes, c_func, pad_info, pad_to_bucket_boundary,
+                                                      drop_remainder, max_tokens_per_batch, lookahead_rows);
 
   ir_node_ = std::static_pointer_cast<DatasetNode>(ds);
 }
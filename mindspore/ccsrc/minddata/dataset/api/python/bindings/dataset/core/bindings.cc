@@ -39,6 +39,8 @@ PYBIND_REGISTER(ConfigManager, 0, ([](const py::module *m) {
                     .def("get_callback_timeout", &ConfigManager::callback_timeout)
                     .def("get_monitor_sampling_interval", &ConfigManager::monitor_sampling_interval)
                     .def("get_num_parallel_workers", &ConfigManager::num_parallel_workers)
+                    .def("get_numa_node_set", &ConfigManager::numa_node_set)
+                    .def("get_numa_policy", &ConfigManager::numa_policy)
                     .def("get_op_connector_size", &ConfigManager::op_connector_size)
                     .def("get_rows_per_buffer", &ConfigManager::rows_per_buffer)
                     .def("get_seed", &ConfigManager::seed)
@@ -48,6 +50,8 @@ PYBIND_REGISTER(ConfigManager, 0, ([](const py::module *m) {
                     .def("set_callback_timeout", &ConfigManager::set_callback_timeout)
                     .def("set_monitor_sampling_interval", &ConfigManager::set_monitor_sampling_interval)
                     .def("set_num_parallel_workers", &ConfigManager::set_num_parallel_workers)
+                    .def("set_numa_node_set", &ConfigManager::set_numa_node_set)
+                    .def("set_numa_policy", &ConfigManager::set_numa_policy)
                     .def("set_op_connector_size", &ConfigManager::set_op_connector_size)
                     .def("set_rows_per_buffer", &ConfigManager::set_rows_per_buffer)
                     .def("set_seed", &ConfigManager::set_seed)
@@ -124,5 +128,13 @@ PYBIND_REGISTER(ImageBatchFormat, 0, ([](const py::module *m) {
                     .export_values();
                 }));
 
+PYBIND_REGISTER(NumaPolicy, 0, ([](const py::module *m) {
+                  (void)py::enum_<NumaPolicy>(*m, "NumaPolicy", py::arithmetic())
+                    .value("DE_NUMA_POLICY_NONE", NumaPolicy::kNone)
+                    .value("DE_NUMA_POLICY_COMPACT", NumaPolicy::kCompact)
+                    .value("DE_NUMA_POLICY_SPREAD", NumaPolicy::kSpread)
+                    .export_values();
+                }));
+
 }  // namespace dataset
 }  // namespace mindspore
@@ -359,20 +359,21 @@ PYBIND_REGISTER(BucketBatchByLengthNode, 2, ([](const py::module *m) {
                     .def(py::init([](std::shared_ptr<DatasetNode> dataset, py::list column_names,
                                      std::vector<int32_t> bucket_boundaries, std::vector<int32_t> bucket_batch_sizes,
                                      py::object element_length_function, py::dict pad_info, bool pad_to_bucket_boundary,
-                                     bool drop_remainder) {
+                                     bool drop_remainder, int64_t max_tokens_per_batch, int32_t lookahead_rows) {
                            std::map<std::string, std::pair<TensorShape, std::shared_ptr<Tensor>>> c_pad_info;
                            THROW_IF_ERROR(toPadInfo(pad_info, &c_pad_info));
 
                            auto bucket_batch = std::make_shared<BucketBatchByLengthNode>(
                              dataset, toStringVector(column_names), bucket_boundaries, bucket_batch_sizes,
                              toPyFuncOp(std::move(element_length_function), DataType::DE_INT32), c_pad_info,
-                             pad_to_bucket_boundary, drop_remainder);
+                             pad_to_bucket_boundary, drop_remainder, max_tokens_per_batch, lookahead_rows);
                            THROW_IF_ERROR(bucket_batch->ValidateParams());
                            return bucket_batch;
                          }),
                          py::arg("dataset"), py::arg("column_names"), py::arg("bucket_boundaries"),
                          py::arg("bucket_batch_sizes"), py::arg("element_length_function") = py::none(),
-                         py::arg("pad_info"), py::arg("pad_to_bucket_boundary"), py::arg("drop_remainder"));
+                         py::arg("pad_info"), py::arg("pad_to_bucket_boundary"), py::arg("drop_remainder"),
+                         py::arg("max_tokens_per_batch") = 0, py::arg("lookahead_rows") = 1024);
                 }));
 
 PYBIND_REGISTER(BuildSentenceVocabNode, 2, ([](const py::module *m) {
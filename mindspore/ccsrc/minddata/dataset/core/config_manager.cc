@@ -45,7 +45,8 @@ ConfigManager::ConfigManager()
       auto_num_workers_(kDftAutoNumWorkers),
       num_cpu_threads_(std::thread::hardware_concurrency()),
       auto_num_workers_num_shards_(1),
-      auto_worker_config_(0) {
+      auto_worker_config_(0),
+      numa_policy_(kDftNumaPolicy) {
   auto env_cache_host = std::getenv("MS_CACHE_HOST");
   auto env_cache_port = std::getenv("MS_CACHE_PORT");
   if (env_cache_host != nullptr) {
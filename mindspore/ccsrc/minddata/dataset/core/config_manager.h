@@ -19,6 +19,7 @@
 #include <ostream>
 #include <sstream>
 #include <string>
+#include <vector>
 
 #include <nlohmann/json.hpp>
 
@@ -111,6 +112,14 @@ class ConfigManager {
   /// \return auto_num_workers_
   bool auto_num_workers() const { return auto_num_workers_; }
 
+  /// getter function
+  /// \return The numa placement policy of the pipeline threads
+  NumaPolicy numa_policy() const { return numa_policy_; }
+
+  /// getter function
+  /// \return The numa nodes the pipeline may run on, empty means decided by the policy
+  std::vector<int32_t> numa_node_set() const { return numa_node_set_; }
+
   // setter function
   // @param rows_per_buffer - The setting to apply to the config
   void set_rows_per_buffer(int32_t rows_per_buffer);
@@ -143,6 +152,14 @@ class ConfigManager {
   /// \param prefetch_size
   void set_prefetch_size(int32_t prefetch_size);
 
+  /// setter function
+  /// \param policy - The numa placement policy of the pipeline threads
+  void set_numa_policy(NumaPolicy policy) { numa_policy_ = policy; }
+
+  /// setter function
+  /// \param node_set - The numa nodes the pipeline may run on, empty lets the policy decide
+  void set_numa_node_set(const std::vector<int32_t> &node_set) { numa_node_set_ = node_set; }
+
   uint32_t seed() const;
 
   // setter function
@@ -207,6 +224,8 @@ class ConfigManager {
   const int32_t num_cpu_threads_;
   int32_t auto_num_workers_num_shards_;
   uint8_t auto_worker_config_;
+  NumaPolicy numa_policy_;
+  std::vector<int32_t> numa_node_set_;
   // Private helper function that takes a nlohmann json format and populates the settings
   // @param j - The json nlohmann json info
   Status FromJson(const nlohmann::json &j);
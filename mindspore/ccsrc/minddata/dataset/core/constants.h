@@ -68,6 +68,13 @@ enum class NormalizeForm {
   kNfkd,
 };
 
+// Possible placements of the pipeline threads on the numa nodes of the host
+enum class NumaPolicy {
+  kNone = 0,     // Threads are left to the OS scheduler
+  kCompact = 1,  // All ops share the cpus of the configured node set
+  kSpread = 2,   // Each op is pinned to one node of the node set, balanced by the number of workers
+};
+
 // convenience functions for 32bit int bitmask
 inline bool BitTest(uint32_t bits, uint32_t bitMask) { return (bits & bitMask) == bitMask; }
 
@@ -92,6 +99,7 @@ constexpr char kCfgDefaultCacheHost[] = "127.0.0.1";
 constexpr int32_t kDftPrefetchSize = 20;
 constexpr int32_t kDftNumConnections = 12;
 constexpr int32_t kDftAutoNumWorkers = false;
+constexpr NumaPolicy kDftNumaPolicy = NumaPolicy::kNone;
 
 // Invalid OpenCV type should not be from 0 to 7 (opencv4/opencv2/core/hal/interface.h)
 constexpr uint8_t kCVInvalidType = 255;
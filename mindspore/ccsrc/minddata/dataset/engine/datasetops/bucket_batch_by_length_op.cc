@@ -15,6 +15,7 @@
  */
 #include "minddata/dataset/engine/datasetops/bucket_batch_by_length_op.h"
 
+#include <algorithm>
 #include <map>
 #include <memory>
 #include <string>
@@ -30,7 +31,9 @@
 #include "minddata/dataset/core/tensor_shape.h"
 #include "minddata/dataset/engine/dataset_iterator.h"
 #include "minddata/dataset/engine/datasetops/parallel_op.h"
+#include "minddata/dataset/engine/execution_tree.h"
 #include "minddata/dataset/engine/opt/pass.h"
+#include "minddata/dataset/engine/perf/batch_padding_tracing.h"
 #include "minddata/dataset/util/status.h"
 
 namespace py = pybind11;
@@ -43,7 +46,9 @@ BucketBatchByLengthOp::Builder::Builder(std::vector<std::string> length_dependen
       builder_bucket_batch_sizes_(bucket_batch_sizes),
       builder_pad_info_({}),
       builder_pad_to_bucket_boundary_(false),
-      builder_drop_remainder_(false) {
+      builder_drop_remainder_(false),
+      builder_max_tokens_per_batch_(0),
+      builder_lookahead_rows_(kDefaultLookaheadRows) {
   std::shared_ptr<ConfigManager> config_manager = GlobalContext::config_manager();
   builder_op_connector_size_ = config_manager->op_connector_size();
 }
@@ -55,6 +60,26 @@ Status BucketBatchByLengthOp::Builder::SanityCheck() {
     error_message += "Invalid parameter, at least 1 column must be specified for element length calculation.\n";
   }
 
+  if (builder_max_tokens_per_batch_ < 0) {
+    error_message += "Invalid parameter, max_tokens_per_batch must be greater than or equal to 0.\n";
+  }
+
+  if (builder_max_tokens_per_batch_ > 0) {
+    // token-budget mode, buckets are not used
+    if (!builder_bucket_boundaries_.empty() || !builder_bucket_batch_sizes_.empty()) {
+      error_message +=
+        "Invalid parameter, bucket_boundaries and bucket_batch_sizes must be empty when max_tokens_per_batch is set.\n";
+    }
+    if (builder_pad_to_bucket_boundary_) {
+      error_message += "Invalid parameter, pad_to_bucket_boundary can not be used with max_tokens_per_batch.\n";
+    }
+    if (builder_lookahead_rows_ <= 0) {
+      error_message += "Invalid parameter, lookahead_rows must be greater than 0.\n";
+    }
+    CHECK_FAIL_RETURN_UNEXPECTED(error_message.empty(), error_message);
+    return Status::OK();
+  }
+
   if (builder_bucket_boundaries_.empty()) {
     error_message += "Invalid parameter, at least 1 bucket boundary must be specified.\n";
   }
@@ -78,7 +103,7 @@ Status BucketBatchByLengthOp::Builder::Build(std::shared_ptr<BucketBatchByLength
   *new_bucket_batch_by_length_op = std::make_shared<BucketBatchByLengthOp>(
     builder_length_dependent_columns_, builder_bucket_boundaries_, builder_bucket_batch_sizes_,
     builder_element_length_function_, builder_pad_info_, builder_pad_to_bucket_boundary_, builder_drop_remainder_,
-    builder_op_connector_size_);
+    builder_op_connector_size_, builder_max_tokens_per_batch_, builder_lookahead_rows_);
 
   return Status::OK();
 }
@@ -88,7 +113,8 @@ BucketBatchByLengthOp::BucketBatchByLengthOp(std::vector<std::string> length_dep
                                              std::vector<int32_t> bucket_batch_sizes,
                                              std::shared_ptr<TensorOp> element_length_function, PadInfo pad_info,
                                              bool pad_to_bucket_boundary, bool drop_remainder,
-                                             int32_t op_connector_size)
+                                             int32_t op_connector_size, int64_t max_tokens_per_batch,
+                                             int32_t lookahead_rows)
     : PipelineOp(op_connector_size),
       length_dependent_columns_(length_dependent_columns),
       bucket_boundaries_(bucket_boundaries),
@@ -97,12 +123,40 @@ BucketBatchByLengthOp::BucketBatchByLengthOp(std::vector<std::string> length_dep
       pad_info_(pad_info),
       pad_to_bucket_boundary_(pad_to_bucket_boundary),
       drop_remainder_(drop_remainder),
-      batch_count_(0) {
+      max_tokens_per_batch_(max_tokens_per_batch),
+      lookahead_rows_(lookahead_rows),
+      batch_count_(0),
+      epoch_real_tokens_(0),
+      epoch_padded_tokens_(0) {
   for (int i = 0; i < bucket_batch_sizes_.size(); i++) {
     buckets_.push_back(std::make_unique<TensorQTable>());
   }
 }
 
+void BucketBatchByLengthOp::Print(std::ostream &out, bool show_all) const {
+  if (!show_all) {
+    // Call the super class for displaying any common 1-liner info
+    PipelineOp::Print(out, show_all);
+    // Then show any custom derived-internal 1-liner info for this op
+    if (max_tokens_per_batch_ > 0) {
+      out << " [max tokens per batch: " << max_tokens_per_batch_ << "]\n";
+    } else {
+      out << " [buckets: " << bucket_batch_sizes_.size() << "]\n";
+    }
+  } else {
+    // Call the super class for displaying any common detailed info
+    PipelineOp::Print(out, show_all);
+    // Then show any custom derived-internal stuff
+    if (max_tokens_per_batch_ > 0) {
+      out << "\nMax tokens per batch: " << max_tokens_per_batch_ << "\nLookahead rows: " << lookahead_rows_;
+    } else {
+      out << "\nNumber of buckets: " << bucket_batch_sizes_.size()
+          << "\nPad to bucket boundary: " << (pad_to_bucket_boundary_ ? "yes" : "no");
+    }
+    out << "\nDrop remainder: " << (drop_remainder_ ? "yes" : "no") << "\n\n";
+  }
+}
+
 Status BucketBatchByLengthOp::EoeReceived(int32_t) {
   state_ = OpState::kDeOpIdle;
   return Status::OK();
@@ -119,6 +173,15 @@ Status BucketBatchByLengthOp::operator()() {
       int32_t element_length;
       RETURN_IF_NOT_OK(ObtainElementLength(&element_length, current_row));
 
+      if (max_tokens_per_batch_ > 0) {
+        lookahead_window_.emplace_back(element_length, std::move(current_row));
+        if (lookahead_window_.size() >= static_cast<size_t>(lookahead_rows_)) {
+          RETURN_IF_NOT_OK(PackLookaheadWindow(false));
+        }
+        RETURN_IF_NOT_OK(child_iterator_->FetchNextTensorRow(&current_row));
+        continue;
+      }
+
       int bucket_index = bucket_boundaries_.size() - 1;
       while (element_length < bucket_boundaries_[bucket_index]) {
         bucket_index--;
@@ -134,7 +197,16 @@ Status BucketBatchByLengthOp::operator()() {
     }
 
     // got EOE, do what we need to do with remainders in each bucket
-    if (!drop_remainder_) {
+    if (max_tokens_per_batch_ > 0) {
+      RETURN_IF_NOT_OK(PackLookaheadWindow(true));
+      if (epoch_padded_tokens_ > 0) {
+        MS_LOG(INFO) << "BucketBatchByLength: padding efficiency of this epoch is "
+                     << static_cast<double>(epoch_real_tokens_) / epoch_padded_tokens_ << " (" << epoch_real_tokens_
+                     << " real tokens out of " << epoch_padded_tokens_ << " padded tokens).";
+      }
+      epoch_real_tokens_ = 0;
+      epoch_padded_tokens_ = 0;
+    } else if (!drop_remainder_) {
       for (int i = 0; i < bucket_boundaries_.size(); i++) {
         if (!buckets_[i]->empty()) {
           RETURN_IF_NOT_OK(PadAndBatchBucket(i, buckets_[i]->size()));
@@ -202,15 +274,21 @@ Status BucketBatchByLengthOp::PadAndBatchBucket(int32_t bucket_index, int32_t ba
     }
   }
 
-  // PadColumns will change the data in bucket
-  RETURN_IF_NOT_OK(BatchOp::PadColumns(bucket, pad_info_copy, column_name_id_map_));
+  CHECK_FAIL_RETURN_UNEXPECTED((*bucket)->size() == batch_size,
+                               "[Internal ERROR] Bucket size does not match the batch_size.");
+  return PadAndBatchRows(bucket, pad_info_copy);
+}
+
+Status BucketBatchByLengthOp::PadAndBatchRows(std::unique_ptr<TensorQTable> *table, const PadInfo &pad_info) {
+  // PadColumns will change the data in table
+  RETURN_IF_NOT_OK(BatchOp::PadColumns(table, pad_info, column_name_id_map_));
 
-  std::unique_ptr<TensorQTable> batched_bucket = std::make_unique<TensorQTable>();
-  RETURN_IF_NOT_OK(BatchOp::BatchRows(bucket, &batched_bucket, batch_size));
-  (*bucket)->clear();
+  std::unique_ptr<TensorQTable> batched_table = std::make_unique<TensorQTable>();
+  RETURN_IF_NOT_OK(BatchOp::BatchRows(table, &batched_table, (*table)->size()));
+  (*table)->clear();
 
   std::unique_ptr<DataBuffer> batched_buffer = std::make_unique<DataBuffer>(batch_count_, DataBuffer::kDeBFlagNone);
-  batched_buffer->set_tensor_table(std::move(batched_bucket));
+  batched_buffer->set_tensor_table(std::move(batched_table));
   RETURN_IF_NOT_OK(out_connector_->Add(0, std::move(batched_buffer)));
 
   batch_count_++;
@@ -218,6 +296,58 @@ Status BucketBatchByLengthOp::PadAndBatchBucket(int32_t bucket_index, int32_t ba
   return Status::OK();
 }
 
+Status BucketBatchByLengthOp::PackLookaheadWindow(bool end_of_epoch) {
+  // Sorting by length keeps rows of similar length in the same batch, so little padding is needed. Stable sort keeps
+  // the order of the input for rows of the same length.
+  std::stable_sort(lookahead_window_.begin(), lookahead_window_.end(),
+                   [](const std::pair<int32_t, TensorRow> &a, const std::pair<int32_t, TensorRow> &b) {
+                     return a.first < b.first;
+                   });
+
+  size_t begin = 0;
+  while (begin < lookahead_window_.size()) {
+    // Each batch is padded to its longest row, so its cost is (number of rows) * (longest length). The window is
+    // sorted, hence the longest row is always the last one added. A row longer than the budget forms its own batch.
+    size_t end = begin + 1;
+    int64_t real_tokens = lookahead_window_[begin].first;
+    while (end < lookahead_window_.size() &&
+           static_cast<int64_t>(end - begin + 1) * lookahead_window_[end].first <= max_tokens_per_batch_) {
+      real_tokens += lookahead_window_[end].first;
+      end++;
+    }
+    bool budget_full = end < lookahead_window_.size();
+    if (!budget_full && !end_of_epoch && begin > 0) {
+      // keep the last batch in the window, the following rows may fill it up
+      break;
+    }
+    if (budget_full || !end_of_epoch || !drop_remainder_) {
+      std::unique_ptr<TensorQTable> table = std::make_unique<TensorQTable>();
+      for (size_t i = begin; i < end; i++) {
+        table->push_back(std::move(lookahead_window_[i].second));
+      }
+      int64_t padded_tokens = static_cast<int64_t>(end - begin) * lookahead_window_[end - 1].first;
+      RETURN_IF_NOT_OK(PadAndBatchRows(&table, pad_info_));
+      RETURN_IF_NOT_OK(RecordPadding(real_tokens, padded_tokens));
+    }
+    begin = end;
+  }
+  lookahead_window_.erase(lookahead_window_.begin(), lookahead_window_.begin() + begin);
+  return Status::OK();
+}
+
+Status BucketBatchByLengthOp::RecordPadding(int64_t real_tokens, int64_t padded_tokens) {
+  epoch_real_tokens_ += real_tokens;
+  epoch_padded_tokens_ += padded_tokens;
+  if (tree_ != nullptr && tree_->GetProfilingManager()->IsProfilingEnable()) {
+    std::shared_ptr<Tracing> node;
+    RETURN_IF_NOT_OK(tree_->GetProfilingManager()->GetTracingNode(kBatchPaddingTracingName, &node));
+    auto padding_node = std::dynamic_pointer_cast<BatchPaddingTracing>(node);
+    RETURN_UNEXPECTED_IF_NULL(padding_node);
+    RETURN_IF_NOT_OK(padding_node->Record(id(), batch_count_, real_tokens, padded_tokens));
+  }
+  return Status::OK();
+}
+
 // Computing the assignment of the column name map and check compute input columns.
 Status BucketBatchByLengthOp::ComputeColMap() {
   RETURN_IF_NOT_OK(DatasetOp::ComputeColMap());
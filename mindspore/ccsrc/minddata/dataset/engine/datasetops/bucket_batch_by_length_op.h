@@ -20,6 +20,7 @@
 #include <memory>
 #include <queue>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "minddata/dataset/core/config_manager.h"
@@ -83,6 +84,22 @@ class BucketBatchByLengthOp : public PipelineOp {
       return *this;
     }
 
+    // Setter method. A positive budget switches the op into token-budget mode, buckets are then not used.
+    // @param int64_t max_tokens_per_batch
+    // @return Builder setter method returns reference to the builder.
+    Builder &SetMaxTokensPerBatch(int64_t max_tokens_per_batch) {
+      builder_max_tokens_per_batch_ = max_tokens_per_batch;
+      return *this;
+    }
+
+    // Setter method.
+    // @param int32_t lookahead_rows - number of rows sorted together before they are packed (token-budget mode)
+    // @return Builder setter method returns reference to the builder.
+    Builder &SetLookaheadRows(int32_t lookahead_rows) {
+      builder_lookahead_rows_ = lookahead_rows;
+      return *this;
+    }
+
     Status Build(std::shared_ptr<BucketBatchByLengthOp> *new_bucket_batch_by_length_op);
 
    private:
@@ -96,11 +113,14 @@ class BucketBatchByLengthOp : public PipelineOp {
     bool builder_pad_to_bucket_boundary_;
     bool builder_drop_remainder_;
     int32_t builder_op_connector_size_;
+    int64_t builder_max_tokens_per_batch_;
+    int32_t builder_lookahead_rows_;
   };
 
   BucketBatchByLengthOp(std::vector<std::string> length_dependent_columns, std::vector<int32_t> bucket_boundaries,
                         std::vector<int32_t> bucket_batch_sizes, std::shared_ptr<TensorOp> element_length_function,
-                        PadInfo pad_info, bool pad_to_bucket_boundary, bool drop_remainder, int32_t op_connector_size);
+                        PadInfo pad_info, bool pad_to_bucket_boundary, bool drop_remainder, int32_t op_connector_size,
+                        int64_t max_tokens_per_batch = 0, int32_t lookahead_rows = kDefaultLookaheadRows);
 
   // Destructor
   ~BucketBatchByLengthOp() = default;
@@ -126,11 +146,37 @@ class BucketBatchByLengthOp : public PipelineOp {
   // @return Status The status code returned
   Status operator()() override;
 
+  // A print method typically used for debugging
+  // @param out - The output stream to write output to
+  // @param show_all - A bool to control if you want to show all info or just a summary
+  void Print(std::ostream &out, bool show_all) const override;
+
+  // Number of rows sorted by length together in token-budget mode when the user does not specify it.
+  static constexpr int32_t kDefaultLookaheadRows = 1024;
+
  private:
   Status ObtainElementLength(int32_t *out_element_length, TensorRow element);
 
   Status PadAndBatchBucket(int32_t bucket_index, int32_t batch_size);
 
+  // Pad the rows in the table according to pad_info, batch them and send the batch to the out connector
+  // @param table - rows to be batched, the table is cleared afterwards
+  // @param pad_info - padding info used for this batch
+  // @return Status The status code returned
+  Status PadAndBatchRows(std::unique_ptr<TensorQTable> *table, const PadInfo &pad_info);
+
+  // Token-budget mode: sort the lookahead window by length and emit batches whose padded size fits the budget
+  // @param end_of_epoch - if true, every row left in the window is emitted, otherwise the last (not yet full)
+  //     batch is kept in the window to be packed together with the following rows
+  // @return Status The status code returned
+  Status PackLookaheadWindow(bool end_of_epoch);
+
+  // Record the padding efficiency of a batch emitted in token-budget mode
+  // @param real_tokens - sum of the lengths of the rows in the batch
+  // @param padded_tokens - number of rows in the batch times the longest length in the batch
+  // @return Status The status code returned
+  Status RecordPadding(int64_t real_tokens, int64_t padded_tokens);
+
   Status ComputeColMap() override;
 
   std::vector<std::string> length_dependent_columns_;
@@ -141,9 +187,15 @@ class BucketBatchByLengthOp : public PipelineOp {
   bool pad_to_bucket_boundary_;
   bool drop_remainder_;
 
+  int64_t max_tokens_per_batch_;  // 0 means bucket mode, positive value means token-budget mode
+  int32_t lookahead_rows_;
+
   int32_t batch_count_;
   std::unique_ptr<ChildIterator> child_iterator_;
   std::vector<std::unique_ptr<TensorQTable>> buckets_;
+  std::vector<std::pair<int32_t, TensorRow>> lookahead_window_;  // (element length, row) pairs in token-budget mode
+  int64_t epoch_real_tokens_;
+  int64_t epoch_padded_tokens_;
 };
 }  // namespace dataset
 }  // namespace mindspore
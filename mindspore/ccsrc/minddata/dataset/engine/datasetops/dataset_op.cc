@@ -247,6 +247,12 @@ void DatasetOp::Print(std::ostream &out, bool show_all) const {
     }
     out << "\nConnector queue size   : " << oc_queue_size_ << "\nTotal repeats : " << op_total_repeats_
         << "\nNumber repeats per epoch : " << op_num_repeats_per_epoch_;
+    if (!numa_nodes_.empty()) {
+      out << "\nNuma nodes             :";
+      for (auto node_id : numa_nodes_) {
+        out << " " << node_id;
+      }
+    }
     if (sampler_) {
       out << "\nSampler:\n";
       sampler_->SamplerPrint(out, show_all);
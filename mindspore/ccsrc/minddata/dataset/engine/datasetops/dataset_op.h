@@ -387,6 +387,10 @@ class DatasetOp : public std::enable_shared_from_this<DatasetOp> {
   /// \return Status
   virtual Status WaitForWorkers() { return Status::OK(); }
 
+  /// \brief Getter function
+  /// \return The numa nodes the threads of this op are pinned to, empty if the op is not placed
+  const std::vector<int32_t> &numa_nodes() const { return numa_nodes_; }
+
   /// \brief Add callback to DatasetOp, only MapOp supports Callback at the moment
   void AddCallbacks(std::vector<std::shared_ptr<DSCallback>> callbacks) { callback_manager_.AddCallbacks(callbacks); }
 
@@ -432,6 +436,7 @@ class DatasetOp : public std::enable_shared_from_this<DatasetOp> {
   CallbackManager callback_manager_;                             // Manages callbacks associated with a DatasetOp
   int64_t dataset_size_;                                         // Size of the dataset
   int64_t num_classes_;                                          // Number of classes
+  std::vector<int32_t> numa_nodes_;                              // Numa nodes assigned by the execution tree
 
  private:
   /// Sets the operator id.
@@ -388,25 +388,80 @@ Status DeviceQueueOp::MallocForGPUData(std::vector<device::DataItemGpu> *items,
 Status DeviceQueueOp::SendDataToCPU() {
   MS_LOG(INFO) << "Device queue, sending data to CPU.";
   int64_t total_batch = 0;
+#ifdef ENABLE_CPUQUE
+  auto queue =
+    device::cpu::CpuDataQueueMgr::GetInstance().Create(channel_name_, device::cpu::kCpuDataQueueCapacity);
+#endif
 
+  Status rc;
   std::unique_ptr<ChildIterator> child_iterator = std::make_unique<ChildIterator>(this, 0, 0);
-  while (!(child_iterator->eof_handled())) {
+  while (!(child_iterator->eof_handled()) && !stop_send_) {
     TensorRow curr_row;
-    RETURN_IF_NOT_OK(child_iterator->FetchNextTensorRow(&curr_row));
+    rc = child_iterator->FetchNextTensorRow(&curr_row);
+    if (rc.IsError()) {
+      break;
+    }
 
     if (!curr_row.empty()) {
       for (auto &tensor : curr_row) {
         MS_LOG(DEBUG) << "Feature size is " << tensor->SizeInBytes() << ".";
       }
+#ifdef ENABLE_CPUQUE
+      rc = PushCPUData(queue, curr_row);
+      if (rc.IsError()) {
+        break;
+      }
+#endif
       total_batch++;
-      if (stop_send_) break;
     }
   }
+#ifdef ENABLE_CPUQUE
+  // On eof, stop or error: the consumer still gets the committed batches, then Front returns closed instead of
+  // waiting for the timeout.
+  device::cpu::CpuDataQueueMgr::GetInstance().Destroy(channel_name_);
+#endif
 
   MS_LOG(INFO) << "Device queue total batch is " << total_batch << ".";
 
+  return rc;
+}
+
+#ifdef ENABLE_CPUQUE
+Status DeviceQueueOp::PushCPUData(const std::shared_ptr<device::cpu::CpuDataQueue> &queue, const TensorRow &curr_row) {
+  RETURN_UNEXPECTED_IF_NULL(queue);
+  std::vector<size_t> data_size;
+  for (auto &tensor : curr_row) {
+    data_size.push_back(static_cast<size_t>(tensor->SizeInBytes()));
+  }
+  std::vector<device::cpu::DataItemCpu> items;
+  while (true) {
+    // Blocks while both slots are in use, so at most one batch is prefetched ahead of the current step. The sending
+    // starts before the graph is compiled, the first batches wait in the slots until the GetNext kernel reads them.
+    auto ret = queue->Reserve(data_size, &items, device::cpu::kCpuDataQueueWaitTimeInSec);
+    if (ret == device::cpu::kCpuQueueSuccess) {
+      break;
+    }
+    if (ret == device::cpu::kCpuQueueErrorInput) {
+      return Status(StatusCode::kOutOfMemory, __LINE__, __FILE__, "Failed to reserve cpu queue memory.");
+    }
+    if (ret == device::cpu::kCpuQueueClosed || stop_send_) {
+      return Status::OK();
+    }
+    MS_LOG(DEBUG) << "Retry pushing data to cpu queue...";
+  }
+  for (size_t i = 0; i < items.size(); i++) {
+    if (data_size[i] == 0) {
+      continue;
+    }
+    int ret = memcpy_s(items[i].data_ptr_, items[i].data_len_, curr_row[i]->GetBuffer(), data_size[i]);
+    if (ret != 0) {
+      return Status(StatusCode::kUnexpectedError, __LINE__, __FILE__, "memcpy_s failed.");
+    }
+  }
+  (void)queue->Commit();
   return Status::OK();
 }
+#endif
 
 void DeviceQueueOp::Print(std::ostream &out, bool show_all) const {
   if (!show_all) {
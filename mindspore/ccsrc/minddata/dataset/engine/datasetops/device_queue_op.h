@@ -38,6 +38,10 @@ using mindspore::device::BlockQueueStatus_T;
 using mindspore::device::GpuBufferMgr;
 #endif
 
+#ifdef ENABLE_CPUQUE
+#include "runtime/device/cpu/cpu_data_queue.h"
+#endif
+
 namespace mindspore {
 namespace dataset {
 using DATA_INFO = std::vector<std::pair<DataType, TensorShape>>;
@@ -140,7 +144,15 @@ class DeviceQueueOp : public PipelineOp {
 
   const int32_t get_prefetch_size() { return prefetch_size_; }
 
-  void StopSend() { stop_send_ = true; }
+  void StopSend() {
+    stop_send_ = true;
+#ifdef ENABLE_CPUQUE
+    // Wake up a row waiting for a free cpu queue slot at once, the cpu path does not continue after a stop.
+    if (device_type_ == DeviceType::CPU) {
+      device::cpu::CpuDataQueueMgr::GetInstance().Destroy(channel_name_);
+    }
+#endif
+  }
 
   void ContinueSend() {
     MS_LOG(INFO) << "continue send at the beginning of the epoch";
@@ -198,6 +210,13 @@ class DeviceQueueOp : public PipelineOp {
 #endif
 
   Status SendDataToCPU();
+#ifdef ENABLE_CPUQUE
+  // Write a row straight into a staging slot of the cpu data queue, the cpu graph reads it from there
+  // @param queue - the staging queue of this channel
+  // @param curr_row - the row to be sent
+  // @return Status The status code returned
+  Status PushCPUData(const std::shared_ptr<device::cpu::CpuDataQueue> &queue, const TensorRow &curr_row);
+#endif
   std::string channel_name_;
   DeviceType device_type_;
   const int32_t device_id_;
@@ -32,15 +32,22 @@
 #include "minddata/dataset/engine/opt/pre/epoch_injection_pass.h"
 #include "minddata/dataset/engine/perf/profiling.h"
 #include "minddata/dataset/engine/perf/monitor.h"
+#include "minddata/dataset/engine/perf/pipeline_analyzer.h"
 
 namespace mindspore {
 namespace dataset {
 // Constructor
-ExecutionTree::ExecutionTree() : id_count_(0), pre_pass_override_(nullptr) {
+namespace {
+// Id of the op owning the current thread, the workers launched from the thread belong to the same op
+thread_local int32_t current_op_id = -1;
+}  // namespace
+
+ExecutionTree::ExecutionTree() : id_count_(0), analyzer_(nullptr), pre_pass_override_(nullptr) {
   tg_ = std::make_unique<TaskGroup>();
   tree_state_ = kDeTStateInit;
   prepare_flags_ = kDePrepNone;
   profiling_manager_ = std::make_unique<ProfilingManager>(this);
+  numa_placement_ = std::make_unique<NumaPlacement>();
   optimize_ = common::GetEnv("OPTIMIZE") == "true" ? true : false;
 }
 
@@ -110,6 +117,8 @@ void ExecutionTree::Print(std::ostream &out, const std::shared_ptr<DatasetOp> &o
   out << "Execution tree summary:\n"
       << "-----------------------\n";
   this->PrintNode(out, op == nullptr ? root_ : op, "", true, false);
+  out << "\n";
+  numa_placement_->Print(out);
   out << "\nExecution tree operator details:\n"
       << "--------------------------------\n";
   this->PrintNode(out, op == nullptr ? root_ : op, "", true, true);
@@ -162,8 +171,14 @@ Status ExecutionTree::Launch() {
     RETURN_IF_NOT_OK(profiling_manager_->Initialize());
     // Launch Monitor Thread
     RETURN_IF_NOT_OK(profiling_manager_->LaunchMonitor());
+    std::shared_ptr<Sampling> node;
+    RETURN_IF_NOT_OK(profiling_manager_->GetSamplingNode(kPipelineAnalyzerName, &node));
+    analyzer_ = dynamic_cast<PipelineAnalyzer *>(node.get());
   }
 
+  // Place the ops before printing so that the placement shows up in the tree
+  RETURN_IF_NOT_OK(this->PlaceOps());
+
   std::ostringstream ss;
   ss << *this;
   MS_LOG(DEBUG) << "Printing the tree before launch tasks:\n" << ss.str();
@@ -174,7 +189,7 @@ Status ExecutionTree::Launch() {
     // the launching tree/user thread.  Do not exec any thread for an inlined op.
     itr->state_ = DatasetOp::OpState::kDeOpRunning;
     if (!itr->inlined()) {
-      RETURN_IF_NOT_OK(tg_->CreateAsyncTask(itr->NameWithID(), std::ref(*itr)));
+      RETURN_IF_NOT_OK(tg_->CreateAsyncTask(itr->NameWithID(), OpThreadEntry(itr.get().get())));
       // Set the state of the Operator as running. This only matters in Leaf ops, CacheOp and TakeOp
     }
   }
@@ -184,6 +199,40 @@ Status ExecutionTree::Launch() {
   return Status::OK();
 }
 
+std::function<Status()> ExecutionTree::OpThreadEntry(DatasetOp *dataset_op) {
+  if (dataset_op->numa_nodes().empty() && analyzer_ == nullptr) {
+    return std::ref(*dataset_op);
+  }
+  const NumaPlacement *placement = numa_placement_.get();
+  PipelineAnalyzer *analyzer = analyzer_;
+  return [dataset_op, placement, analyzer]() -> Status {
+    // The workers launched by the op inherit the cpus of its main thread.
+    Status rc = placement->BindCurrentThread(dataset_op->numa_nodes());
+    if (rc.IsError()) {
+      MS_LOG(WARNING) << dataset_op->NameWithID() << " runs without numa placement. " << rc.ToString();
+    }
+    current_op_id = dataset_op->id();
+    if (analyzer != nullptr) {
+      analyzer->RegisterCurrentThread(current_op_id);
+    }
+    return (*dataset_op)();
+  };
+}
+
+// Assign numa nodes to the ops according to the numa policy of the config manager.
+Status ExecutionTree::PlaceOps() {
+  std::shared_ptr<ConfigManager> cfg = GlobalContext::config_manager();
+  RETURN_IF_NOT_OK(numa_placement_->Init(cfg->numa_policy(), cfg->numa_node_set()));
+  for (auto itr = this->begin(); itr != this->end(); ++itr) {
+    if (itr->inlined()) {
+      itr->numa_nodes_.clear();
+    } else {
+      numa_placement_->Assign(*itr, &itr->numa_nodes_);
+    }
+  }
+  return Status::OK();
+}
+
 // A function that traverse the tree in postorder then save the results in nodes
 void ExecutionTree::Iterator::PostOrderTraverse(const std::shared_ptr<DatasetOp> &node) {
   if (node == nullptr) {
@@ -214,8 +263,19 @@ Status ExecutionTree::LaunchWorkers(int32_t num_workers, std::function<Status(ui
     MS_LOG(WARNING) << name + " is launched with " << std::to_string(num_workers) << " worker threads which exceeds "
                     << std::to_string(num_cpu_threads) << ", the maximum number of threads on this CPU.";
   }
+  // Workers count for the op launching them in the pipeline analysis.
+  int32_t op_id = current_op_id;
+  PipelineAnalyzer *analyzer = op_id >= 0 ? analyzer_ : nullptr;
   for (int32_t i = 0; i < num_workers; ++i) {
-    RETURN_IF_NOT_OK(tg_->CreateAsyncTask(name, std::bind(func, i)));
+    if (analyzer != nullptr) {
+      RETURN_IF_NOT_OK(tg_->CreateAsyncTask(name, [func, i, op_id, analyzer]() -> Status {
+        current_op_id = op_id;
+        analyzer->RegisterCurrentThread(op_id);
+        return func(i);
+      }));
+    } else {
+      RETURN_IF_NOT_OK(tg_->CreateAsyncTask(name, std::bind(func, i)));
+    }
   }
   return Status::OK();
 }
@@ -28,6 +28,7 @@
 #endif
 #endif
 #include "minddata/dataset/engine/datasetops/dataset_op.h"
+#include "minddata/dataset/engine/numa_placement.h"
 #include "minddata/dataset/util/status.h"
 #include "mindspore/ccsrc/minddata/dataset/engine/perf/profiling.h"
 namespace mindspore {
@@ -35,6 +36,7 @@ namespace dataset {
 // Forward declares
 class TaskGroup;
 class DatasetOp;
+class PipelineAnalyzer;
 class Pass;
 using OptPass = std::vector<std::unique_ptr<Pass>>;
 class ExecutionTree {
@@ -264,6 +266,16 @@ class ExecutionTree {
   void SetPrePassOverride(std::function<OptPass(OptPass)> pre_pass_override) { pre_pass_override_ = pre_pass_override; }
 
  private:
+  // Assign numa nodes to the ops according to the numa policy of the config manager.
+  // @return Status The status code returned
+  Status PlaceOps();
+
+  // Build the entry function of the main thread of an op. It places the thread on the numa nodes of the op and
+  // tags it for the pipeline analyzer.
+  // @param dataset_op - The op to run
+  // @return The entry function
+  std::function<Status()> OpThreadEntry(DatasetOp *dataset_op);
+
   // A helper functions for doing the recursive printing
   // @param dataset_op - The dataset op to print
   // @param indent - an indent string for aligning child levels in output
@@ -279,6 +291,8 @@ class ExecutionTree {
   TreeState tree_state_;                                 // Tracking the current tree state
   int32_t num_epochs_;                                   // Total number of epochs to run for this tree
   std::unique_ptr<ProfilingManager> profiling_manager_;  // Profiling manager
+  std::unique_ptr<NumaPlacement> numa_placement_;        // Placement of the op threads on numa nodes
+  PipelineAnalyzer *analyzer_;                           // Pipeline analyzer, null if profiling is off. No ownership
   bool optimize_;                                        // Flag to enable optional optimizations
   std::function<OptPass(OptPass)> pre_pass_override_;    // function ptr that overrides pre pass, called in PrePrepare()
   bool partially_prepare_;                               // Temp: during migration to IR, if true, run remaining passes.
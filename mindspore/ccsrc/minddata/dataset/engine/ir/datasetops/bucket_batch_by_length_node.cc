@@ -33,21 +33,23 @@ BucketBatchByLengthNode::BucketBatchByLengthNode(
   const std::vector<int32_t> &bucket_boundaries, const std::vector<int32_t> &bucket_batch_sizes,
   std::shared_ptr<TensorOp> element_length_function,
   const std::map<std::string, std::pair<TensorShape, std::shared_ptr<Tensor>>> &pad_info, bool pad_to_bucket_boundary,
-  bool drop_remainder)
+  bool drop_remainder, int64_t max_tokens_per_batch, int32_t lookahead_rows)
     : column_names_(column_names),
       bucket_boundaries_(bucket_boundaries),
       bucket_batch_sizes_(bucket_batch_sizes),
       element_length_function_(element_length_function),
       pad_info_(pad_info),
       pad_to_bucket_boundary_(pad_to_bucket_boundary),
-      drop_remainder_(drop_remainder) {
+      drop_remainder_(drop_remainder),
+      max_tokens_per_batch_(max_tokens_per_batch),
+      lookahead_rows_(lookahead_rows) {
   this->AddChild(child);
 }
 
 std::shared_ptr<DatasetNode> BucketBatchByLengthNode::Copy() {
   auto node = std::make_shared<BucketBatchByLengthNode>(nullptr, column_names_, bucket_boundaries_, bucket_batch_sizes_,
                                                         element_length_function_, pad_info_, pad_to_bucket_boundary_,
-                                                        drop_remainder_);
+                                                        drop_remainder_, max_tokens_per_batch_, lookahead_rows_);
   return node;
 }
 
@@ -79,10 +81,20 @@ void BucketBatchByLengthNode::Print(std::ostream &out) const {
     }
     i++;
   }
+  if (max_tokens_per_batch_ > 0) {
+    out << ",max_tokens_per_batch:" << max_tokens_per_batch_ << ",lookahead_rows:" << lookahead_rows_;
+  }
   out << ")";
 }
 
 Status BucketBatchByLengthNode::Build(std::vector<std::shared_ptr<DatasetOp>> *node_ops) {
+  if (max_tokens_per_batch_ > 0) {
+    // token-budget mode does not use buckets
+    node_ops->push_back(std::make_shared<BucketBatchByLengthOp>(
+      column_names_, std::vector<int32_t>(), std::vector<int32_t>(), element_length_function_, pad_info_, false,
+      drop_remainder_, connector_que_size_, max_tokens_per_batch_, lookahead_rows_));
+    return Status::OK();
+  }
   bucket_boundaries_.insert(bucket_boundaries_.begin(), 0);
   node_ops->push_back(std::make_shared<BucketBatchByLengthOp>(
     column_names_, bucket_boundaries_, bucket_batch_sizes_, element_length_function_, pad_info_,
@@ -102,6 +114,38 @@ Status BucketBatchByLengthNode::ValidateParams() {
     RETURN_STATUS_SYNTAX_ERROR(err_msg);
   }
 
+  if (max_tokens_per_batch_ < 0) {
+    std::string err_msg = "BucketBatchByLengthNode: max_tokens_per_batch must be greater than or equal to 0.";
+    MS_LOG(ERROR) << err_msg;
+    RETURN_STATUS_SYNTAX_ERROR(err_msg);
+  }
+
+  if (max_tokens_per_batch_ > 0) {
+    // token-budget mode, batches are formed by the budget instead of buckets
+    if (!bucket_boundaries_.empty() || !bucket_batch_sizes_.empty()) {
+      std::string err_msg =
+        "BucketBatchByLengthNode: bucket_boundaries and bucket_batch_sizes must be empty when max_tokens_per_batch is "
+        "set.";
+      MS_LOG(ERROR) << err_msg;
+      RETURN_STATUS_SYNTAX_ERROR(err_msg);
+    }
+    if (pad_to_bucket_boundary_) {
+      std::string err_msg = "BucketBatchByLengthNode: pad_to_bucket_boundary can not be used with max_tokens_per_batch.";
+      MS_LOG(ERROR) << err_msg;
+      RETURN_STATUS_SYNTAX_ERROR(err_msg);
+    }
+    if (lookahead_rows_ <= 0) {
+      std::string err_msg = "BucketBatchByLengthNode: lookahead_rows must be greater than 0, but got: " +
+                            std::to_string(lookahead_rows_);
+      MS_LOG(ERROR) << err_msg;
+      RETURN_STATUS_SYNTAX_ERROR(err_msg);
+    }
+    if (!column_names_.empty()) {
+      RETURN_IF_NOT_OK(ValidateDatasetColumnParam("BucketBatchByLengthNode", "column_names", column_names_));
+    }
+    return Status::OK();
+  }
+
   // Check bucket_boundaries: must be positive and strictly increasing
   if (bucket_boundaries_.empty()) {
     std::string err_msg = "BucketBatchByLengthNode: bucket_boundaries cannot be empty.";
@@ -35,7 +35,8 @@ class BucketBatchByLengthNode : public DatasetNode {
                           const std::vector<int32_t> &bucket_boundaries, const std::vector<int32_t> &bucket_batch_sizes,
                           std::shared_ptr<TensorOp> element_length_function = nullptr,
                           const std::map<std::string, std::pair<TensorShape, std::shared_ptr<Tensor>>> &pad_info = {},
-                          bool pad_to_bucket_boundary = false, bool drop_remainder = false);
+                          bool pad_to_bucket_boundary = false, bool drop_remainder = false,
+                          int64_t max_tokens_per_batch = 0, int32_t lookahead_rows = 1024);
 
   /// \brief Destructor
   ~BucketBatchByLengthNode() = default;
@@ -71,6 +72,8 @@ class BucketBatchByLengthNode : public DatasetNode {
   std::map<std::string, std::pair<TensorShape, std::shared_ptr<Tensor>>> pad_info_;
   bool pad_to_bucket_boundary_;
   bool drop_remainder_;
+  int64_t max_tokens_per_batch_;
+  int32_t lookahead_rows_;
 };
 
 }  // namespace dataset
@@ -0,0 +1,211 @@
+/**
+ * Copyright 2021 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "minddata/dataset/engine/numa_placement.h"
+#if !defined(_WIN32) && !defined(_WIN64) && !defined(__APPLE__) && !defined(ENABLE_ANDROID)
+#include <sched.h>
+#define NUMA_PLACEMENT_SUPPORTED
+#endif
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <utility>
+#include "minddata/dataset/engine/datasetops/dataset_op.h"
+#include "minddata/dataset/util/path.h"
+#include "utils/log_adapter.h"
+
+namespace mindspore {
+namespace dataset {
+namespace {
+constexpr char kSysNodePath[] = "/sys/devices/system/node";
+constexpr char kNodeName[] = "node";
+constexpr char kCpuList[] = "cpulist";
+}  // namespace
+
+Status NumaPlacement::ParseCpuList(const std::string &cpu_list, std::vector<int32_t> *cpus) {
+  RETURN_UNEXPECTED_IF_NULL(cpus);
+  std::stringstream ss(cpu_list);
+  std::string range;
+  while (std::getline(ss, range, ',')) {
+    range.erase(std::remove_if(range.begin(), range.end(), [](unsigned char c) { return std::isspace(c); }),
+                range.end());
+    if (range.empty()) {
+      continue;
+    }
+    auto pos = range.find('-');
+    std::string first = range.substr(0, pos);
+    std::string last = pos == std::string::npos ? first : range.substr(pos + 1);
+    auto is_number = [](const std::string &s) {
+      return !s.empty() && std::all_of(s.begin(), s.end(), [](unsigned char c) { return std::isdigit(c); });
+    };
+    CHECK_FAIL_RETURN_UNEXPECTED(is_number(first) && is_number(last), "Invalid cpu list: " + cpu_list);
+    int32_t cpu_min = std::stoi(first);
+    int32_t cpu_max = std::stoi(last);
+    CHECK_FAIL_RETURN_UNEXPECTED(cpu_min <= cpu_max, "Invalid cpu range: " + range);
+    for (int32_t i = cpu_min; i <= cpu_max; ++i) {
+      cpus->push_back(i);
+    }
+  }
+  return Status::OK();
+}
+
+std::string NumaPlacement::PolicyName(NumaPolicy policy) {
+  switch (policy) {
+    case NumaPolicy::kCompact:
+      return "compact";
+    case NumaPolicy::kSpread:
+      return "spread";
+    default:
+      return "none";
+  }
+}
+
+Status NumaPlacement::GetNodeCpus() {
+  node_cpus_.clear();
+  Path node(kSysNodePath);
+  auto it = Path::DirIterator::OpenDirectory(&node);
+  if (it == nullptr) {
+    MS_LOG(WARNING) << "Unable to open directory " << kSysNodePath << ". Numa placement is skipped.";
+    return Status::OK();
+  }
+  const size_t prefix_len = strlen(kNodeName);
+  while (it->hasNext()) {
+    auto p = it->next();
+    const std::string entry = p.Basename();
+    if (entry.compare(0, prefix_len, kNodeName) != 0 || entry.size() == prefix_len ||
+        !std::all_of(entry.begin() + prefix_len, entry.end(), [](unsigned char c) { return std::isdigit(c); })) {
+      continue;
+    }
+    int32_t node_id = std::stoi(entry.substr(prefix_len));
+    Path f = p / kCpuList;
+    std::ifstream fs(f.toString());
+    CHECK_FAIL_RETURN_UNEXPECTED(!fs.fail(), "Fail to open file: " + f.toString());
+    std::string cpu_string;
+    std::getline(fs, cpu_string);
+    CHECK_FAIL_RETURN_UNEXPECTED(!fs.bad(), "Fail to read file: " + f.toString());
+    fs.close();
+    std::vector<int32_t> cpus;
+    RETURN_IF_NOT_OK(ParseCpuList(cpu_string, &cpus));
+    // Memory only nodes have no cpu to run on.
+    if (!cpus.empty()) {
+      node_cpus_[node_id] = std::move(cpus);
+    }
+  }
+  return Status::OK();
+}
+
+Status NumaPlacement::Init(NumaPolicy policy, const std::vector<int32_t> &node_set) {
+  policy_ = policy;
+  node_set_.clear();
+  node_load_.clear();
+  if (policy_ == NumaPolicy::kNone) {
+    return Status::OK();
+  }
+#ifndef NUMA_PLACEMENT_SUPPORTED
+  MS_LOG(WARNING) << "Numa placement is not supported on this platform, policy " << PolicyName(policy_)
+                  << " is ignored.";
+  return Status::OK();
+#else
+  RETURN_IF_NOT_OK(GetNodeCpus());
+  // A single node host has nothing to place.
+  if (node_cpus_.size() <= 1) {
+    MS_LOG(INFO) << "Found " << node_cpus_.size() << " numa node(s), numa placement is skipped.";
+    return Status::OK();
+  }
+  for (auto node_id : node_set) {
+    CHECK_FAIL_RETURN_UNEXPECTED(node_cpus_.find(node_id) != node_cpus_.end(),
+                                 "Numa node " + std::to_string(node_id) + " not found or has no cpu.");
+    if (std::find(node_set_.begin(), node_set_.end(), node_id) == node_set_.end()) {
+      node_set_.push_back(node_id);
+    }
+  }
+  if (node_set_.empty()) {
+    if (policy_ == NumaPolicy::kCompact) {
+      // Stay with the thread that launches the pipeline, it is the one consuming the rows.
+      int32_t cpu = sched_getcpu();
+      for (const auto &item : node_cpus_) {
+        if (std::find(item.second.begin(), item.second.end(), cpu) != item.second.end()) {
+          node_set_.push_back(item.first);
+          break;
+        }
+      }
+    } else {
+      for (const auto &item : node_cpus_) {
+        node_set_.push_back(item.first);
+      }
+    }
+  }
+  for (auto node_id : node_set_) {
+    node_load_[node_id] = 0;
+  }
+  return Status::OK();
+#endif
+}
+
+void NumaPlacement::Assign(const DatasetOp &op, std::vector<int32_t> *nodes) {
+  if (nodes == nullptr) {
+    return;
+  }
+  nodes->clear();
+  if (!enabled()) {
+    return;
+  }
+  if (policy_ == NumaPolicy::kCompact) {
+    *nodes = node_set_;
+    return;
+  }
+  // The main thread of the op counts as one more worker.
+  auto least_loaded = std::min_element(node_load_.begin(), node_load_.end(),
+                                       [](const std::pair<const int32_t, int64_t> &a,
+                                          const std::pair<const int32_t, int64_t> &b) { return a.second < b.second; });
+  least_loaded->second += std::max(op.num_workers(), 0) + 1;
+  nodes->push_back(least_loaded->first);
+}
+
+Status NumaPlacement::BindCurrentThread(const std::vector<int32_t> &nodes) const {
+#ifdef NUMA_PLACEMENT_SUPPORTED
+  if (nodes.empty()) {
+    return Status::OK();
+  }
+  cpu_set_t cpuset;
+  CPU_ZERO(&cpuset);
+  for (auto node_id : nodes) {
+    auto it = node_cpus_.find(node_id);
+    CHECK_FAIL_RETURN_UNEXPECTED(it != node_cpus_.end(), "Numa node " + std::to_string(node_id) + " not found.");
+    for (auto cpu : it->second) {
+      CPU_SET(cpu, &cpuset);
+    }
+  }
+  if (sched_setaffinity(0, sizeof(cpuset), &cpuset) != 0) {
+    RETURN_STATUS_UNEXPECTED("Unable to set affinity. Errno = " + std::to_string(errno));
+  }
+#endif
+  return Status::OK();
+}
+
+void NumaPlacement::Print(std::ostream &out) const {
+  out << "Numa policy            : " << PolicyName(policy_);
+  if (enabled()) {
+    out << "\nNuma node set          :";
+    for (auto node_id : node_set_) {
+      out << " " << node_id;
+    }
+  }
+}
+}  // namespace dataset
+}  // namespace mindspore
@@ -0,0 +1,84 @@
+/**
+ * Copyright 2021 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef MINDSPORE_CCSRC_MINDDATA_DATASET_ENGINE_NUMA_PLACEMENT_H_
+#define MINDSPORE_CCSRC_MINDDATA_DATASET_ENGINE_NUMA_PLACEMENT_H_
+
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "minddata/dataset/core/constants.h"
+#include "minddata/dataset/util/status.h"
+
+namespace mindspore {
+namespace dataset {
+class DatasetOp;
+
+/// \brief Places the threads of an execution tree on the numa nodes of the host.
+/// \note The placement only pins threads. Tensors get node local memory from the first touch policy of the OS, since
+///     every worker allocates and fills its own tensors. Threads created by a pinned thread inherit its cpus, so
+///     pinning the main thread of an op also places all the workers the op launches.
+class NumaPlacement {
+ public:
+  NumaPlacement() = default;
+  ~NumaPlacement() = default;
+
+  /// \brief Scan the numa topology of the host and validate the configured node set.
+  /// \param[in] policy The placement policy
+  /// \param[in] node_set The nodes the pipeline may run on. If empty, compact uses the node of the calling thread
+  ///     and spread uses all the nodes.
+  /// \return Status The status code returned
+  Status Init(NumaPolicy policy, const std::vector<int32_t> &node_set);
+
+  /// \brief Assign numa nodes to an op. Spread picks the node with the fewest workers assigned so far.
+  /// \param[in] op The op to place
+  /// \param[out] nodes The nodes assigned to the op, empty if the op is not placed
+  void Assign(const DatasetOp &op, std::vector<int32_t> *nodes);
+
+  /// \brief Pin the calling thread to the cpus of the given nodes.
+  /// \param[in] nodes The nodes assigned by Assign
+  /// \return Status The status code returned
+  Status BindCurrentThread(const std::vector<int32_t> &nodes) const;
+
+  /// \return T/F if threads are being placed
+  bool enabled() const { return policy_ != NumaPolicy::kNone && !node_set_.empty(); }
+
+  /// \brief A print method typically used for debugging
+  /// \param out - The output stream to write output to
+  void Print(std::ostream &out) const;
+
+  /// \brief Parse the content of a sysfs cpulist file, e.g. "0-3,8,10-11".
+  /// \param[in] cpu_list The list to parse
+  /// \param[out] cpus The cpu ids
+  /// \return Status The status code returned
+  static Status ParseCpuList(const std::string &cpu_list, std::vector<int32_t> *cpus);
+
+  /// \brief Name of a numa policy, used by the printers.
+  static std::string PolicyName(NumaPolicy policy);
+
+ private:
+  /// \brief Read the cpus of each node from sysfs.
+  Status GetNodeCpus();
+
+  NumaPolicy policy_{NumaPolicy::kNone};
+  std::vector<int32_t> node_set_;                       // Nodes the pipeline runs on
+  std::map<int32_t, std::vector<int32_t>> node_cpus_;  // Cpus of each numa node of the host
+  std::map<int32_t, int64_t> node_load_;               // Workers assigned to each node of the node set
+};
+}  // namespace dataset
+}  // namespace mindspore
+
+#endif  // MINDSPORE_CCSRC_MINDDATA_DATASET_ENGINE_NUMA_PLACEMENT_H_
@@ -0,0 +1,72 @@
+/**
+ * Copyright 2021 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <sys/stat.h>
+#include <fstream>
+#include <string>
+#include "minddata/dataset/engine/perf/batch_padding_tracing.h"
+#include "minddata/dataset/util/path.h"
+#include "mindspore/core/utils/ms_utils.h"
+
+namespace mindspore {
+namespace dataset {
+
+Status BatchPaddingTracing::Record(const int32_t op_id, const int32_t batch_num, const int64_t real_tokens,
+                                   const int64_t padded_tokens) {
+  // Format: "op-id batch-num real-tokens padded-tokens"
+  // Padding efficiency of a batch is real-tokens / padded-tokens.
+  // Example:
+  // 3 20 950 1024 - The 20th batch of op 3 holds 950 tokens and is padded to 1024 tokens.
+  std::string data = std::to_string(op_id) + " " + std::to_string(batch_num) + " " + std::to_string(real_tokens) +
+                     " " + std::to_string(padded_tokens);
+  value_.emplace_back(data);
+  return Status::OK();
+}
+
+Status BatchPaddingTracing::SaveToFile() {
+  if (value_.empty()) {
+    return Status::OK();
+  }
+
+  std::ofstream handle(file_path_, std::ios::trunc);
+  if (!handle.is_open()) {
+    RETURN_STATUS_UNEXPECTED("Profiling file can not be opened.");
+  }
+  for (auto value : value_) {
+    handle << value << "\n";
+  }
+  handle.close();
+
+  return Status::OK();
+}
+
+Status BatchPaddingTracing::Init(const std::string &dir_path, const std::string &device_id) {
+  file_path_ = (Path(dir_path) / Path("batch_padding_profiling_" + device_id + ".txt")).toString();
+  return Status::OK();
+}
+
+Status BatchPaddingTracing::ChangeFileMode() {
+  if (value_.empty()) {
+    return Status::OK();
+  }
+
+  if (chmod(common::SafeCStr(file_path_), S_IRUSR | S_IWUSR) == -1) {
+    std::string err_str = "Change file mode failed," + file_path_;
+    return Status(StatusCode::kUnexpectedError, err_str);
+  }
+  return Status::OK();
+}
+}  // namespace dataset
+}  // namespace mindspore
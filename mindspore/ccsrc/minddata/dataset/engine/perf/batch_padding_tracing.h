@@ -0,0 +1,58 @@
+/**
+ * Copyright 2021 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MINDSPORE_BATCH_PADDING_TRACING_H
+#define MINDSPORE_BATCH_PADDING_TRACING_H
+
+#include <string>
+#include <vector>
+#include "minddata/dataset/engine/perf/profiling.h"
+
+namespace mindspore {
+namespace dataset {
+class BatchPaddingTracing : public Tracing {
+ public:
+  // Constructor
+  BatchPaddingTracing() = default;
+
+  // Destructor
+  ~BatchPaddingTracing() override = default;
+
+  // Record the padding of one batch
+  // @param op_id - id of the op that emitted the batch
+  // @param batch_num - batch number
+  // @param real_tokens - sum of the lengths of all rows in the batch
+  // @param padded_tokens - size of the batch after padding, in the same unit as real_tokens
+  // @return Status The status code returned
+  Status Record(const int32_t op_id, const int32_t batch_num, const int64_t real_tokens, const int64_t padded_tokens);
+
+  std::string Name() const override { return kBatchPaddingTracingName; };
+
+  // Save tracing data to file
+  // @return Status The status code returned
+  Status SaveToFile() override;
+
+  Status Init(const std::string &dir_path, const std::string &device_id) override;
+
+  Status ChangeFileMode() override;
+
+ private:
+  std::vector<std::string> value_;
+};
+}  // namespace dataset
+}  // namespace mindspore
+
+#endif  // MINDSPORE_BATCH_PADDING_TRACING_H
@@ -0,0 +1,377 @@
+/**
+ * Copyright 2021 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "minddata/dataset/engine/perf/pipeline_analyzer.h"
+#include <sys/stat.h>
+#ifdef THREAD_CPU_CLOCK_SUPPORTED
+#include <pthread.h>
+#endif
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include "minddata/dataset/core/config_manager.h"
+#include "minddata/dataset/engine/execution_tree.h"
+#include "minddata/dataset/util/log_adapter.h"
+#include "minddata/dataset/util/path.h"
+#include "mindspore/core/utils/ms_utils.h"
+
+namespace mindspore {
+namespace dataset {
+namespace {
+// An op is limiting when its children queues are much fuller than its own output queue
+constexpr double kMinBottleneckScore = 0.2;
+// The output queue of the pipeline is full this often when the consumer is slower than the pipeline
+constexpr double kConsumerBoundRatio = 0.5;
+// Threads busier than this are compute bound
+constexpr double kComputeBoundUtil = 0.7;
+// Workers less busy than this are wasted when the cpus are saturated
+constexpr double kIdleUtil = 0.1;
+// A queue both full and empty this often sees bursts larger than its capacity
+constexpr double kBurstRatio = 0.2;
+
+bool HasOutputQueue(const DatasetOp &op) { return op.Name() != "DeviceQueueOp"; }
+
+std::string FormatRatio(double ratio) {
+  std::ostringstream ss;
+  ss << std::fixed << std::setprecision(2) << ratio;
+  return ss.str();
+}
+}  // namespace
+
+Status PipelineAnalyzer::Init(const std::string &dir_path, const std::string &device_id) {
+  file_path_ = (Path(dir_path) / Path("pipeline_analysis_" + device_id + ".json")).toString();
+  text_file_path_ = (Path(dir_path) / Path("pipeline_analysis_" + device_id + ".txt")).toString();
+  reports_ = nlohmann::json::array();
+  return Status::OK();
+}
+
+void PipelineAnalyzer::RegisterCurrentThread(int32_t op_id) {
+#ifdef THREAD_CPU_CLOCK_SUPPORTED
+  clockid_t clock;
+  if (pthread_getcpuclockid(pthread_self(), &clock) != 0) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(threads_mutex_);
+  ThreadClock thread{op_id, 0};
+  thread.clock = clock;
+  threads_.push_back(thread);
+#endif
+}
+
+std::map<int32_t, double> PipelineAnalyzer::SampleCpuTime() {
+  std::map<int32_t, double> cpu_time;
+  std::lock_guard<std::mutex> lock(threads_mutex_);
+  for (auto &thread : threads_) {
+#ifdef THREAD_CPU_CLOCK_SUPPORTED
+    struct timespec ts;
+    // The clock is gone with its thread, the last reading is its total.
+    if (clock_gettime(thread.clock, &ts) == 0) {
+      thread.last_cpu = static_cast<double>(ts.tv_sec) + static_cast<double>(ts.tv_nsec) * 1e-9;
+    }
+#endif
+    cpu_time[thread.op_id] += thread.last_cpu;
+  }
+  return cpu_time;
+}
+
+Status PipelineAnalyzer::Sample() {
+  auto now = std::chrono::steady_clock::now();
+  auto cpu_time = SampleCpuTime();
+  for (auto &op : *tree_) {
+    if (op.inlined()) {
+      continue;
+    }
+    OpWindow &window = windows_[op.id()];
+    if (window.samples == 0) {
+      window.start_buffers = op.ConnectorOutBufferCount();
+      window.start_cpu = cpu_time[op.id()];
+    }
+    window.samples++;
+    window.last_buffers = op.ConnectorOutBufferCount();
+    window.last_cpu = cpu_time[op.id()];
+    if (HasOutputQueue(op) && op.ConnectorCapacity() > 0) {
+      int32_t size = op.ConnectorSize();
+      int32_t capacity = op.ConnectorCapacity();
+      window.output_occupancy_sum += static_cast<double>(size) / capacity;
+      window.output_empty += size == 0 ? 1 : 0;
+      window.output_full += size >= capacity ? 1 : 0;
+    }
+    auto children = op.Children();
+    if (!children.empty()) {
+      double occupancy = 0;
+      bool empty = false;
+      for (int32_t i = 0; i < static_cast<int32_t>(children.size()); ++i) {
+        int32_t capacity = op.ChildOpConnectorCapacity(i);
+        int32_t size = op.ChildOpConnectorSize(i);
+        occupancy += capacity > 0 ? static_cast<double>(size) / capacity : 0;
+        empty = empty || size == 0;
+      }
+      window.input_occupancy_sum += occupancy / children.size();
+      window.input_empty += empty ? 1 : 0;
+    }
+  }
+  if (!window_started_) {
+    window_start_ = now;
+    window_started_ = true;
+  }
+  window_last_ = now;
+  return Status::OK();
+}
+
+std::vector<OpPerfStats> PipelineAnalyzer::CollectStats() {
+  std::vector<OpPerfStats> ops;
+  double duration = std::chrono::duration<double>(window_last_ - window_start_).count();
+  std::map<int32_t, int32_t> thread_count;
+  {
+    std::lock_guard<std::mutex> lock(threads_mutex_);
+    for (const auto &thread : threads_) {
+      thread_count[thread.op_id]++;
+    }
+  }
+  // The pipeline output is the first op owning a thread below the root, the ops above it are inlined.
+  std::shared_ptr<DatasetOp> output_op = tree_->root();
+  while (output_op != nullptr && output_op->inlined() && !output_op->Children().empty()) {
+    output_op = output_op->Children()[0];
+  }
+  for (auto &op : *tree_) {
+    auto it = windows_.find(op.id());
+    if (op.inlined() || it == windows_.end() || it->second.samples == 0) {
+      continue;
+    }
+    const OpWindow &window = it->second;
+    OpPerfStats stats;
+    stats.op_id = op.id();
+    stats.op_type = op.Name();
+    stats.num_workers = op.num_workers();
+    stats.num_threads = thread_count[op.id()];
+    stats.is_leaf = op.Children().empty();
+    stats.is_pipeline_output = output_op != nullptr && output_op->id() == op.id();
+    stats.has_output_queue = HasOutputQueue(op);
+    auto samples = static_cast<double>(window.samples);
+    if (duration > 0) {
+      stats.throughput = (window.last_buffers - window.start_buffers) / duration;
+      if (stats.num_threads > 0) {
+        stats.cpu_util = (window.last_cpu - window.start_cpu) / (duration * stats.num_threads);
+      }
+    }
+    stats.input_occupancy = stats.is_leaf ? 1 : window.input_occupancy_sum / samples;
+    stats.output_occupancy = window.output_occupancy_sum / samples;
+    stats.starvation = window.input_empty / samples;
+    stats.back_pressure = window.output_full / samples;
+    stats.output_empty = window.output_empty / samples;
+    ops.push_back(stats);
+  }
+  windows_.clear();
+  window_started_ = false;
+  return ops;
+}
+
+PerfReport PipelineAnalyzer::Analyze(const std::vector<OpPerfStats> &ops, int32_t num_cpu_threads,
+                                     int32_t op_connector_size) {
+  PerfReport report;
+  if (ops.empty()) {
+    report.summary = "No sample collected.";
+    return report;
+  }
+  auto output = std::find_if(ops.begin(), ops.end(), [](const OpPerfStats &op) { return op.is_pipeline_output; });
+  if (output != ops.end() && output->has_output_queue && output->back_pressure >= kConsumerBoundRatio) {
+    report.consumer_bound = true;
+    report.summary = "The output queue of the pipeline is full " + FormatRatio(output->back_pressure) +
+                     " of the time, the consumer of the pipeline is the bottleneck.";
+    return report;
+  }
+
+  // The limiting op is fed faster than it produces: its input queues fill up while its output queue runs dry.
+  const OpPerfStats *bottleneck = nullptr;
+  double best_score = kMinBottleneckScore;
+  for (const auto &op : ops) {
+    double score = op.input_occupancy - (op.has_output_queue ? op.output_occupancy : 0);
+    if (score > best_score || (bottleneck != nullptr && score == best_score && op.cpu_util > bottleneck->cpu_util)) {
+      best_score = score;
+      bottleneck = &op;
+    }
+  }
+  if (bottleneck == nullptr) {
+    report.summary = "The pipeline is balanced, no op is limiting it.";
+    return report;
+  }
+  if (!bottleneck->has_output_queue) {
+    report.consumer_bound = true;
+    report.summary = bottleneck->op_type + "(" + std::to_string(bottleneck->op_id) +
+                     ") is fed faster than the device consumes, the consumer of the pipeline is the bottleneck.";
+    return report;
+  }
+  report.bottleneck_op_id = bottleneck->op_id;
+  std::ostringstream summary;
+  summary << bottleneck->op_type << "(" << bottleneck->op_id << ") limits the pipeline: its ";
+  if (!bottleneck->is_leaf) {
+    summary << "input queue is " << FormatRatio(bottleneck->input_occupancy) << " full and its ";
+  }
+  summary << "output queue " << FormatRatio(bottleneck->output_occupancy) << " full on average.";
+
+  // Cpus used by the whole pipeline, to tell whether more workers can run.
+  double busy_cpus = 0;
+  for (const auto &op : ops) {
+    if (op.cpu_util > 0) {
+      busy_cpus += op.cpu_util * op.num_threads;
+    }
+  }
+  double idle_cpus = std::max(0.0, num_cpu_threads - busy_cpus);
+  bool cpu_saturated = idle_cpus < 1;
+
+  if (bottleneck->num_workers > 0) {
+    int64_t current = bottleneck->num_workers;
+    int64_t suggested = 0;
+    std::string reason;
+    if (bottleneck->cpu_util >= kComputeBoundUtil) {
+      summary << " Its threads are " << FormatRatio(bottleneck->cpu_util) << " busy, it is compute bound.";
+      if (!cpu_saturated) {
+        suggested = std::min(current * 2, current + static_cast<int64_t>(std::floor(idle_cpus)));
+        reason = "compute bound with " + std::to_string(static_cast<int64_t>(std::floor(idle_cpus))) + " idle cpus";
+      }
+    } else {
+      if (bottleneck->cpu_util >= 0) {
+        summary << " Its threads are only " << FormatRatio(bottleneck->cpu_util)
+                << " busy, it is waiting on IO, locks or the python GIL.";
+      }
+      suggested = std::min<int64_t>(current * 2, std::max(num_cpu_threads, 1));
+      reason = "more workers overlap the waits of the op";
+    }
+    if (suggested > current) {
+      report.suggestions.push_back({bottleneck->op_id, "num_parallel_workers", current, suggested, reason});
+    } else if (cpu_saturated) {
+      summary << " All the cpus are busy.";
+    }
+  } else {
+    summary << " The op runs on a single thread, consider moving its work into a parallel op.";
+  }
+
+  for (const auto &op : ops) {
+    // A queue swinging between empty and full is too short for the bursts of its producer.
+    if (op.has_output_queue && op.back_pressure >= kBurstRatio && op.output_empty >= kBurstRatio) {
+      report.suggestions.push_back({op.op_id, "prefetch_size", op_connector_size, op_connector_size * 2,
+                                    "output queue is often full and often empty"});
+    }
+    // Idle workers take cpus from the bottleneck when there is none left.
+    if (cpu_saturated && op.op_id != bottleneck->op_id && op.num_workers > 1 && op.cpu_util >= 0 &&
+        op.cpu_util < kIdleUtil) {
+      int64_t suggested = std::max<int64_t>(1, std::ceil(op.num_workers * op.cpu_util / kComputeBoundUtil));
+      report.suggestions.push_back({op.op_id, "num_parallel_workers", op.num_workers, suggested,
+                                    "workers are idle while the cpus are saturated"});
+    }
+  }
+  report.summary = summary.str();
+  return report;
+}
+
+nlohmann::json PipelineAnalyzer::ReportToJson(const std::vector<OpPerfStats> &ops, const PerfReport &report,
+                                              double duration) const {
+  nlohmann::json output;
+  output["epoch"] = epoch_;
+  output["duration_ms"] = static_cast<int64_t>(duration * 1000);
+  for (const auto &op : ops) {
+    nlohmann::json json_op;
+    json_op["op_id"] = op.op_id;
+    json_op["op_type"] = op.op_type;
+    json_op["num_workers"] = op.num_workers;
+    json_op["throughput"] = op.throughput;
+    json_op["cpu_util"] = op.cpu_util;
+    json_op["input_occupancy"] = op.input_occupancy;
+    json_op["output_occupancy"] = op.output_occupancy;
+    json_op["starvation"] = op.starvation;
+    json_op["back_pressure"] = op.back_pressure;
+    output["op_info"].push_back(json_op);
+  }
+  output["bottleneck_op_id"] = report.bottleneck_op_id;
+  output["consumer_bound"] = report.consumer_bound;
+  output["summary"] = report.summary;
+  output["suggestions"] = nlohmann::json::array();
+  for (const auto &suggestion : report.suggestions) {
+    output["suggestions"].push_back({{"op_id", suggestion.op_id},
+                                     {"setting", suggestion.setting},
+                                     {"current", suggestion.current},
+                                     {"suggested", suggestion.suggested},
+                                     {"reason", suggestion.reason}});
+  }
+  return output;
+}
+
+std::string PipelineAnalyzer::ReportToText(const std::vector<OpPerfStats> &ops, const PerfReport &report,
+                                           double duration) const {
+  std::ostringstream ss;
+  ss << "Epoch " << epoch_ << ", " << static_cast<int64_t>(duration * 1000) << " ms\n";
+  ss << std::left << std::setw(24) << "op" << std::right << std::setw(8) << "workers" << std::setw(12) << "buffers/s"
+     << std::setw(8) << "cpu" << std::setw(8) << "in_q" << std::setw(8) << "out_q" << std::setw(8) << "starve"
+     << std::setw(8) << "backp" << "\n";
+  for (const auto &op : ops) {
+    ss << std::left << std::setw(24) << (op.op_type + "(" + std::to_string(op.op_id) + ")") << std::right
+       << std::setw(8) << op.num_workers << std::setw(12) << std::fixed << std::setprecision(1) << op.throughput
+       << std::setw(8) << (op.cpu_util >= 0 ? FormatRatio(op.cpu_util) : "n/a") << std::setw(8)
+       << FormatRatio(op.input_occupancy) << std::setw(8) << FormatRatio(op.output_occupancy) << std::setw(8)
+       << FormatRatio(op.starvation) << std::setw(8) << FormatRatio(op.back_pressure) << "\n";
+  }
+  ss << report.summary << "\n";
+  for (const auto &suggestion : report.suggestions) {
+    ss << "Suggestion: op " << suggestion.op_id << " " << suggestion.setting << " " << suggestion.current << " -> "
+       << suggestion.suggested << " (" << suggestion.reason << ")\n";
+  }
+  ss << "\n";
+  return ss.str();
+}
+
+Status PipelineAnalyzer::SaveToFile() {
+  if (!window_started_) {
+    return Status::OK();
+  }
+  double duration = std::chrono::duration<double>(window_last_ - window_start_).count();
+  auto ops = CollectStats();
+  epoch_++;
+  std::shared_ptr<ConfigManager> cfg = GlobalContext::config_manager();
+  PerfReport report = Analyze(ops, cfg->num_cpu_threads(), cfg->op_connector_size());
+  MS_LOG(INFO) << "Pipeline analysis of epoch " << epoch_ << ": " << report.summary;
+
+  reports_.push_back(ReportToJson(ops, report, duration));
+  std::ofstream os(file_path_, std::ios::trunc);
+  if (!os.is_open()) {
+    RETURN_STATUS_UNEXPECTED("Profiling file can not be opened: " + file_path_);
+  }
+  os << reports_.dump(2);
+  os.close();
+
+  std::ofstream text(text_file_path_, epoch_ == 1 ? std::ios::trunc : std::ios::app);
+  if (!text.is_open()) {
+    RETURN_STATUS_UNEXPECTED("Profiling file can not be opened: " + text_file_path_);
+  }
+  text << ReportToText(ops, report, duration);
+  return Status::OK();
+}
+
+Status PipelineAnalyzer::ChangeFileMode() {
+  for (const auto &file_path : {file_path_, text_file_path_}) {
+    if (!Path(file_path).Exists()) {
+      continue;
+    }
+    if (chmod(common::SafeCStr(file_path), S_IRUSR | S_IWUSR) == -1) {
+      std::string err_str = "Change file mode failed," + file_path;
+      return Status(StatusCode::kUnexpectedError, err_str);
+    }
+  }
+  return Status::OK();
+}
+}  // namespace dataset
+}  // namespace mindspore
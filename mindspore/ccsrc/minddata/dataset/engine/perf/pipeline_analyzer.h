@@ -0,0 +1,154 @@
+/**
+ * Copyright 2021 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MINDSPORE_CCSRC_MINDDATA_DATASET_ENGINE_PERF_PIPELINE_ANALYZER_H_
+#define MINDSPORE_CCSRC_MINDDATA_DATASET_ENGINE_PERF_PIPELINE_ANALYZER_H_
+
+#if !defined(_WIN32) && !defined(_WIN64) && !defined(__APPLE__)
+#include <time.h>
+#define THREAD_CPU_CLOCK_SUPPORTED
+#endif
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+#include "minddata/dataset/engine/perf/profiling.h"
+
+namespace mindspore {
+namespace dataset {
+class DatasetOp;
+class ExecutionTree;
+
+// Statistics of one op over an analysis window
+struct OpPerfStats {
+  int32_t op_id = -1;
+  std::string op_type;
+  int32_t num_workers = 0;
+  int32_t num_threads = 0;          // Threads of the op, including its main thread
+  bool is_leaf = false;             // The op reads from a source, not from a child
+  bool is_pipeline_output = false;  // The op feeds the consumer of the pipeline
+  bool has_output_queue = true;     // DeviceQueueOp sends its output to the device instead
+  double throughput = 0;            // Buffers sent per second
+  double cpu_util = -1;             // Busy fraction of the op threads, -1 if unknown
+  double input_occupancy = 1;       // Mean size / capacity of the child connectors, 1 for leaf ops
+  double output_occupancy = 0;      // Mean size / capacity of the output connector
+  double starvation = 0;            // Fraction of samples with an empty input connector
+  double back_pressure = 0;         // Fraction of samples with a full output connector
+  double output_empty = 0;          // Fraction of samples with an empty output connector
+};
+
+// A setting the analyzer recommends to change
+struct PerfSuggestion {
+  int32_t op_id = -1;
+  std::string setting;
+  int64_t current = 0;
+  int64_t suggested = 0;
+  std::string reason;
+};
+
+// Outcome of the analysis of one window
+struct PerfReport {
+  int32_t bottleneck_op_id = -1;  // -1 if the pipeline is balanced or the consumer is the bottleneck
+  bool consumer_bound = false;
+  std::string summary;
+  std::vector<PerfSuggestion> suggestions;
+};
+
+// PipelineAnalyzer samples the connectors and the cpu time of every op, and at the end of each epoch finds the op
+// limiting the pipeline and suggests settings to change. The reports are saved as json and as text.
+class PipelineAnalyzer : public Sampling {
+ public:
+  explicit PipelineAnalyzer(ExecutionTree *tree) : tree_(tree) {}
+
+  ~PipelineAnalyzer() override = default;
+
+  // Sample the connectors of every op and the cpu time of their threads
+  Status Sample() override;
+
+  std::string Name() const override { return kPipelineAnalyzerName; }
+
+  // Analyze the samples since the last call, and save the report to file
+  // @return Status The status code returned
+  Status SaveToFile() override;
+
+  Status Init(const std::string &dir_path, const std::string &device_id) override;
+
+  Status ChangeFileMode() override;
+
+  // Tag the calling thread as a thread of an op, its cpu time counts for that op.
+  // @param op_id - The id of the op
+  void RegisterCurrentThread(int32_t op_id);
+
+  // Find the op limiting the pipeline and the settings worth changing
+  // @param ops - Statistics of the ops that own a thread
+  // @param num_cpu_threads - Number of cpus of the host
+  // @param op_connector_size - Capacity of the connectors between ops
+  // @return The report
+  static PerfReport Analyze(const std::vector<OpPerfStats> &ops, int32_t num_cpu_threads, int32_t op_connector_size);
+
+ private:
+  using TimePoint = std::chrono::time_point<std::chrono::steady_clock>;
+
+  // Running sums of the samples of one op
+  struct OpWindow {
+    int64_t samples = 0;
+    int64_t start_buffers = 0;
+    int64_t last_buffers = 0;
+    double start_cpu = 0;
+    double last_cpu = 0;
+    double input_occupancy_sum = 0;
+    double output_occupancy_sum = 0;
+    int64_t input_empty = 0;
+    int64_t output_empty = 0;
+    int64_t output_full = 0;
+  };
+
+  // Cpu clock of a thread registered by an op
+  struct ThreadClock {
+    int32_t op_id;
+    double last_cpu;  // Kept once the thread has exited
+#ifdef THREAD_CPU_CLOCK_SUPPORTED
+    clockid_t clock;
+#endif
+  };
+
+  // Cpu time in seconds consumed so far by the threads of each op
+  std::map<int32_t, double> SampleCpuTime();
+
+  // Turn the window into statistics and reset it
+  std::vector<OpPerfStats> CollectStats();
+
+  nlohmann::json ReportToJson(const std::vector<OpPerfStats> &ops, const PerfReport &report, double duration) const;
+
+  std::string ReportToText(const std::vector<OpPerfStats> &ops, const PerfReport &report, double duration) const;
+
+  ExecutionTree *tree_ = nullptr;
+  std::string text_file_path_;
+  int32_t epoch_ = 0;
+  bool window_started_ = false;
+  TimePoint window_start_;
+  TimePoint window_last_;
+  std::map<int32_t, OpWindow> windows_;
+  nlohmann::json reports_;
+  std::mutex threads_mutex_;
+  std::vector<ThreadClock> threads_;
+};
+}  // namespace dataset
+}  // namespace mindspore
+
+#endif  // MINDSPORE_CCSRC_MINDDATA_DATASET_ENGINE_PERF_PIPELINE_ANALYZER_H_
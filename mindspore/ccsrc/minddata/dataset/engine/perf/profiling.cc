@@ -25,6 +25,8 @@
 #include "minddata/dataset/engine/perf/connector_size.h"
 #include "minddata/dataset/engine/perf/connector_throughput.h"
 #include "minddata/dataset/engine/perf/dataset_iterator_tracing.h"
+#include "minddata/dataset/engine/perf/batch_padding_tracing.h"
+#include "minddata/dataset/engine/perf/pipeline_analyzer.h"
 #include "minddata/dataset/util/log_adapter.h"
 
 namespace mindspore {
@@ -79,12 +81,19 @@ Status ProfilingManager::Initialize() {
   std::shared_ptr<Tracing> dataset_iterator_tracing = std::make_shared<DatasetIteratorTracing>();
   RETURN_IF_NOT_OK(RegisterTracingNode(dataset_iterator_tracing));
 
+  // batch_padding node is used by token-budget batching
+  std::shared_ptr<Tracing> batch_padding_tracing = std::make_shared<BatchPaddingTracing>();
+  RETURN_IF_NOT_OK(RegisterTracingNode(batch_padding_tracing));
+
   std::shared_ptr<Sampling> connector_size_sampling = std::make_shared<ConnectorSize>(tree_);
   RETURN_IF_NOT_OK(RegisterSamplingNode(connector_size_sampling));
 
   std::shared_ptr<Sampling> connector_thr_sampling = std::make_shared<ConnectorThroughput>(tree_);
   RETURN_IF_NOT_OK(RegisterSamplingNode(connector_thr_sampling));
 
+  std::shared_ptr<Sampling> pipeline_analyzer = std::make_shared<PipelineAnalyzer>(tree_);
+  RETURN_IF_NOT_OK(RegisterSamplingNode(pipeline_analyzer));
+
   return Status::OK();
 }
 
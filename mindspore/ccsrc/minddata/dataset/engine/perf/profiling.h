@@ -33,6 +33,8 @@ const char kDeviceQueueTracingName[] = "Device_Queue_Tracing";
 const char kDatasetIteratorTracingName[] = "Dataset_Iterator_Tracing";
 const char kConnectorSizeSamplingName[] = "Connector_Size_Sampling";
 const char kConnectorThroughputSamplingName[] = "Connector_Throughput_Sampling";
+const char kBatchPaddingTracingName[] = "Batch_Padding_Tracing";
+const char kPipelineAnalyzerName[] = "Pipeline_Analyzer";
 
 // Profiling is a class of basic unit of profiling action
 // This base class encapsulate the serialization output logic
@@ -209,16 +209,23 @@ class Dataset : public std::enable_shared_from_this<Dataset> {
   ///    an error will occur (default=false).
   /// \param[in] drop_remainder If true, will drop the last batch for each bucket if it is not a full batch
   ///    (default=false).
+  /// \param[in] max_tokens_per_batch If positive, rows are packed into batches whose padded size
+  ///    (number of rows * longest length in the batch) does not exceed this budget, instead of being bucketed.
+  ///    bucket_boundaries and bucket_batch_sizes must then be empty. The length returned by
+  ///    element_length_function can be a token count or a byte count (default=0, bucketing is used).
+  /// \param[in] lookahead_rows Number of rows sorted by length together before they are packed when
+  ///    max_tokens_per_batch is set (default=1024).
   /// \return Shared pointer to the current BucketBatchByLengthDataset
   std::shared_ptr<BucketBatchByLengthDataset> BucketBatchByLength(
     const std::vector<std::string> &column_names, const std::vector<int32_t> &bucket_boundaries,
     const std::vector<int32_t> &bucket_batch_sizes,
     std::function<TensorRow(TensorRow)> element_length_function = nullptr,
     const std::map<std::string, std::pair<TensorShape, std::shared_ptr<Tensor>>> &pad_info = {},
-    bool pad_to_bucket_boundary = false, bool drop_remainder = false) {
-    return std::make_shared<BucketBatchByLengthDataset>(shared_from_this(), column_names, bucket_boundaries,
-                                                        bucket_batch_sizes, element_length_function, pad_info,
-                                                        pad_to_bucket_boundary, drop_remainder);
+    bool pad_to_bucket_boundary = false, bool drop_remainder = false, int64_t max_tokens_per_batch = 0,
+    int32_t lookahead_rows = 1024) {
+    return std::make_shared<BucketBatchByLengthDataset>(
+      shared_from_this(), column_names, bucket_boundaries, bucket_batch_sizes, element_length_function, pad_info,
+      pad_to_bucket_boundary, drop_remainder, max_tokens_per_batch, lookahead_rows);
   }
 
   /// \brief Function to create a SentencePieceVocab from source dataset
@@ -466,7 +473,8 @@ class BucketBatchByLengthDataset : public Dataset {
     const std::vector<int32_t> &bucket_boundaries, const std::vector<int32_t> &bucket_batch_sizes,
     std::function<TensorRow(TensorRow)> element_length_function = nullptr,
     const std::map<std::string, std::pair<TensorShape, std::shared_ptr<Tensor>>> &pad_info = {},
-    bool pad_to_bucket_boundary = false, bool drop_remainder = false);
+    bool pad_to_bucket_boundary = false, bool drop_remainder = false, int64_t max_tokens_per_batch = 0,
+    int32_t lookahead_rows = 1024);
   ~BucketBatchByLengthDataset() = default;
 };
 
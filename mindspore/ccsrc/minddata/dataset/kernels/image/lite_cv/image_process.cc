@@ -21,6 +21,8 @@
 #include <cmath>
 #include <vector>
 
+#include "minddata/dataset/kernels/image/lite_cv/image_process_simd.h"
+
 namespace mindspore {
 namespace dataset {
 
@@ -71,7 +73,7 @@ static void ResizeBilinear3C(const unsigned char *src, int src_width, int src_he
   int *y_offset = data_buf + dst_width;
 
   int16_t *x_weight = reinterpret_cast<int16_t *>(data_buf + dst_width + dst_height);
-  int16_t *y_weight = reinterpret_cast<int16_t *>(x_weight + dst_width);
+  int16_t *y_weight = reinterpret_cast<int16_t *>(x_weight + 2 * dst_width);
 
   InitBilinearWeight(x_offset, x_weight, scale_width, dst_width, src_width, 3);
   InitBilinearWeight(y_offset, y_weight, scale_height, dst_height, src_height, 1);
@@ -125,15 +127,8 @@ static void ResizeBilinear3C(const unsigned char *src, int src_width, int src_he
     }
     prev_height = y_span;
 
-    int16_t *row0_ptr0 = row0_ptr;
-    int16_t *row1_ptr1 = row1_ptr;
     unsigned char *dst_ptr = dst + dst_width * 3 * (y);
-
-    for (int k = 0; k < dst_width * 3; k++) {
-      int16_t t0 = (int16_t)((y_weight[0] * (int16_t)(*row0_ptr0++)) >> 16);
-      int16_t t1 = (int16_t)((y_weight[1] * (int16_t)(*row1_ptr1++)) >> 16);
-      *dst_ptr++ = static_cast<unsigned char>((t0 + t1 + 2) >> 2);
-    }
+    ResizeBilinearVertical(row0_ptr, row1_ptr, y_weight[0], y_weight[1], dst_ptr, dst_width * 3);
     y_weight += 2;
   }
   delete[] data_buf;
@@ -153,7 +148,7 @@ static void ResizeBilinear1C(const unsigned char *src, int src_width, int src_he
   int *y_offset = data_buf + dst_width;
 
   int16_t *x_weight = reinterpret_cast<int16_t *>(data_buf + dst_width + dst_height);
-  int16_t *y_weight = reinterpret_cast<int16_t *>(x_weight + dst_width);
+  int16_t *y_weight = reinterpret_cast<int16_t *>(x_weight + 2 * dst_width);
 
   InitBilinearWeight(x_offset, x_weight, scale_width, dst_width, src_width, 1);
   InitBilinearWeight(y_offset, y_weight, scale_height, dst_height, src_height, 1);
@@ -200,15 +195,8 @@ static void ResizeBilinear1C(const unsigned char *src, int src_width, int src_he
     }
     prev_height = y_span;
 
-    int16_t *row0_ptr0 = row0_ptr;
-    int16_t *row1_ptr1 = row1_ptr;
     unsigned char *dst_ptr = dst + dst_width * (y);
-
-    for (int k = 0; k < dst_width; k++) {
-      int16_t t0 = (int16_t)((y_weight[0] * (int16_t)(*row0_ptr0++)) >> 16);
-      int16_t t1 = (int16_t)((y_weight[1] * (int16_t)(*row1_ptr1++)) >> 16);
-      *dst_ptr++ = static_cast<unsigned char>((t0 + t1 + 2) >> 2);
-    }
+    ResizeBilinearVertical(row0_ptr, row1_ptr, y_weight[0], y_weight[1], dst_ptr, dst_width);
 
     y_weight += 2;
   }
@@ -301,53 +289,7 @@ static bool ConvertYUV420SPToBGR(const uint8_t *data, LDataType data_type, bool
     int bgr_stride = 3 * w;
 
     for (int y = 0; y < h; ++y) {
-      uint8_t *bgr_buf = bgr_ptr;
-      const uint8_t *uv_buf = uv_ptr;
-      const uint8_t *y_buf = y_ptr;
-      uint8_t u;
-      uint8_t v;
-      for (int x = 0; x < w - 1; x += 2) {
-        if (flag) {
-          // NV21
-          u = uv_buf[1];
-          v = uv_buf[0];
-        } else {
-          // NV12
-          u = uv_buf[0];
-          v = uv_buf[1];
-        }
-        uint32_t tmp_y = (uint32_t)(y_buf[0] * YSCALE * YTOG) >> 16;
-        // b
-        bgr_buf[0] = std::clamp((int32_t)(-(u * UTOB) + tmp_y + BTOB) >> 6, 0, 255);
-        // g
-        bgr_buf[1] = std::clamp((int32_t)(-(u * UTOG + v * VTOG) + tmp_y + BTOG) >> 6, 0, 255);
-        // r
-        bgr_buf[2] = std::clamp((int32_t)(-(v * VTOR) + tmp_y + BTOR) >> 6, 0, 255);
-
-        tmp_y = (uint32_t)(y_buf[1] * YSCALE * YTOG) >> 16;
-        bgr_buf[3] = std::clamp((int32_t)(-(u * UTOB) + tmp_y + BTOB) >> 6, 0, 255);
-        bgr_buf[4] = std::clamp((int32_t)(-(u * UTOG + v * VTOG) + tmp_y + BTOG) >> 6, 0, 255);
-        bgr_buf[5] = std::clamp((int32_t)(-(v * VTOR) + tmp_y + BTOR) >> 6, 0, 255);
-
-        y_buf += 2;
-        uv_buf += 2;
-        bgr_buf += 6;
-      }
-      if (w & 1) {
-        if (flag) {
-          // NV21
-          u = uv_buf[1];
-          v = uv_buf[0];
-        } else {
-          // NV12
-          u = uv_buf[0];
-          v = uv_buf[1];
-        }
-        uint32_t tmp_y = (uint32_t)(y_buf[0] * YSCALE * YTOG) >> 16;
-        bgr_buf[0] = std::clamp((int32_t)(-(u * UTOB) + tmp_y + BTOB) >> 6, 0, 255);
-        bgr_buf[1] = std::clamp((int32_t)(-(u * UTOG + v * VTOG) + tmp_y + BTOG) >> 6, 0, 255);
-        bgr_buf[2] = std::clamp((int32_t)(-(v * VTOR) + tmp_y + BTOR) >> 6, 0, 255);
-      }
+      YUV420SPRowToBGR(y_ptr, uv_ptr, bgr_ptr, w, flag);
 
       bgr_ptr += bgr_stride;
       y_ptr += w;
@@ -421,14 +363,8 @@ bool ConvertTo(const LiteMat &src, LiteMat &dst, double scale) {
   (void)dst.Init(src.width_, src.height_, src.channel_, LDataType::FLOAT32);
   const unsigned char *src_start_p = src;
   float *dst_start_p = dst;
-  for (int h = 0; h < src.height_; h++) {
-    for (int w = 0; w < src.width_; w++) {
-      uint32_t index = (h * src.width_ + w) * src.channel_;
-      for (int c = 0; c < src.channel_; c++) {
-        dst_start_p[index + c] = (static_cast<float>(src_start_p[index + c] * scale));
-      }
-    }
-  }
+  int64_t total = static_cast<int64_t>(src.height_) * src.width_ * src.channel_;
+  ConvertU8ToF32(src_start_p, dst_start_p, total, scale);
   return true;
 }
 
@@ -514,41 +450,13 @@ bool SubStractMeanNormalize(const LiteMat &src, LiteMat &dst, const std::vector<
 
   dst.Init(src.width_, src.height_, src.channel_, LDataType::FLOAT32);
 
+  // an empty mean or std is the identity, (x - 0) / 1 gives exactly x
+  std::vector<float> mean_buf = mean.empty() ? std::vector<float>(src.channel_, 0.0f) : mean;
+  std::vector<float> std_buf = std.empty() ? std::vector<float>(src.channel_, 1.0f) : std;
   const float *src_start_p = src;
   float *dst_start_p = dst;
-  if ((!mean.empty()) && std.empty()) {
-    for (int h = 0; h < src.height_; h++) {
-      for (int w = 0; w < src.width_; w++) {
-        uint32_t src_start = (h * src.width_ + w) * src.channel_;
-        for (int c = 0; c < src.channel_; c++) {
-          uint32_t index = src_start + c;
-          dst_start_p[index] = src_start_p[index] - mean[c];
-        }
-      }
-    }
-  } else if (mean.empty() && (!std.empty())) {
-    for (int h = 0; h < src.height_; h++) {
-      for (int w = 0; w < src.width_; w++) {
-        uint32_t src_start = (h * src.width_ + w) * src.channel_;
-        for (int c = 0; c < src.channel_; c++) {
-          uint32_t index = src_start + c;
-          dst_start_p[index] = src_start_p[index] / std[c];
-        }
-      }
-    }
-  } else if ((!mean.empty()) && (!std.empty())) {
-    for (int h = 0; h < src.height_; h++) {
-      for (int w = 0; w < src.width_; w++) {
-        uint32_t src_start = (h * src.width_ + w) * src.channel_;
-        for (int c = 0; c < src.channel_; c++) {
-          uint32_t index = src_start + c;
-          dst_start_p[index] = (src_start_p[index] - mean[c]) / std[c];
-        }
-      }
-    }
-  } else {
-    return false;
-  }
+  int64_t total = static_cast<int64_t>(src.height_) * src.width_ * src.channel_;
+  SubtractMeanNormalizeF32(src_start_p, dst_start_p, total, src.channel_, mean_buf.data(), std_buf.data());
   return true;
 }
 
@@ -882,10 +790,14 @@ bool ImplementAffine(LiteMat &src, LiteMat &out_img, const double M[6], std::vec
   IM[5] = b2;
 
   out_img.Init(dsize[0], dsize[1], sizeof(Pixel_Type));
+  std::vector<int> src_x_buf(out_img.width_);
+  std::vector<int> src_y_buf(out_img.width_);
   for (int y = 0; y < out_img.height_; y++) {
+    AffineRowCoordinate(IM[0], IM[1] * y, IM[2], out_img.width_, src_x_buf.data());
+    AffineRowCoordinate(IM[3], IM[4] * y, IM[5], out_img.width_, src_y_buf.data());
     for (int x = 0; x < out_img.width_; x++) {
-      int src_x = IM[0] * x + IM[1] * y + IM[2];
-      int src_y = IM[3] * x + IM[4] * y + IM[5];
+      int src_x = src_x_buf[x];
+      int src_y = src_y_buf[x];
       if (src_x >= 0 && src_y >= 0 && src_x < src.width_ && src_y < src.height_) {
         Pixel_Type src_pixel = static_cast<Pixel_Type *>(src.data_ptr_)[src_y * src.width_ + src_x];
         static_cast<Pixel_Type *>(out_img.data_ptr_)[y * out_img.width_ + x] = src_pixel;
@@ -0,0 +1,619 @@
+/**
+ * Copyright 2021 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "minddata/dataset/kernels/image/lite_cv/image_process_simd.h"
+
+#include <algorithm>
+#include <atomic>
+
+#include "minddata/dataset/kernels/image/lite_cv/image_process.h"
+
+// NEON follows lite_mat.cc: only the android arm builds are compiled with it.
+#if defined(ENABLE_ANDROID) && (defined(__arm__) || defined(__aarch64__) || defined(_M_ARM) || defined(_M_ARM64))
+#define USE_NEON
+#include <arm_neon.h>
+#elif (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+// The x86 kernels are compiled for their own target with function attributes and picked at runtime,
+// so the library itself does not need to be built with -msse4.1 or -mavx2.
+#define USE_X86_SIMD
+#include <immintrin.h>
+#define TARGET_SSE41 __attribute__((target("sse4.1")))
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+namespace mindspore {
+namespace dataset {
+
+namespace {
+constexpr int kMaxSimdNormalizeChannel = 4;
+
+SimdLevel DetectSimdLevel() {
+#if defined(USE_NEON)
+  return SimdLevel::kNEON;
+#elif defined(USE_X86_SIMD)
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2")) {
+    return SimdLevel::kAVX2;
+  }
+  if (__builtin_cpu_supports("sse4.1")) {
+    return SimdLevel::kSSE41;
+  }
+  return SimdLevel::kScalar;
+#else
+  return SimdLevel::kScalar;
+#endif
+}
+
+std::atomic<int> &ActiveSimdLevel() {
+  static std::atomic<int> level(static_cast<int>(GetSupportedSimdLevel()));
+  return level;
+}
+}  // namespace
+
+SimdLevel GetSupportedSimdLevel() {
+  static const SimdLevel level = DetectSimdLevel();
+  return level;
+}
+
+SimdLevel GetSimdLevel() { return static_cast<SimdLevel>(ActiveSimdLevel().load(std::memory_order_relaxed)); }
+
+bool SetSimdLevel(SimdLevel level) {
+  SimdLevel supported = GetSupportedSimdLevel();
+  // x86 levels are ordered, a lower one is always available; NEON is all or nothing.
+  bool valid = level == SimdLevel::kScalar || level == supported ||
+               (supported != SimdLevel::kNEON && level != SimdLevel::kNEON && level < supported);
+  if (!valid) {
+    return false;
+  }
+  ActiveSimdLevel().store(static_cast<int>(level), std::memory_order_relaxed);
+  return true;
+}
+
+// Scalar kernels, they are the reference of the vectorised ones and process the remaining tail of every row.
+static void ResizeBilinearVerticalScalar(const int16_t *row0, const int16_t *row1, int16_t weight0, int16_t weight1,
+                                         uint8_t *dst, int begin, int len) {
+  for (int k = begin; k < len; k++) {
+    int16_t t0 = (int16_t)((weight0 * row0[k]) >> 16);
+    int16_t t1 = (int16_t)((weight1 * row1[k]) >> 16);
+    dst[k] = static_cast<uint8_t>((t0 + t1 + 2) >> 2);
+  }
+}
+
+static void ConvertU8ToF32Scalar(const uint8_t *src, float *dst, int64_t begin, int64_t total, double scale) {
+  for (int64_t i = begin; i < total; i++) {
+    dst[i] = static_cast<float>(src[i] * scale);
+  }
+}
+
+static void SubtractMeanNormalizeF32Scalar(const float *src, float *dst, int64_t begin, int64_t total, int channel,
+                                           const float *mean, const float *std) {
+  for (int64_t i = begin; i < total; i += channel) {
+    for (int c = 0; c < channel; c++) {
+      dst[i + c] = (src[i + c] - mean[c]) / std[c];
+    }
+  }
+}
+
+static inline void YUVToBGRScalar(uint8_t y, uint8_t u, uint8_t v, uint8_t *bgr) {
+  uint32_t tmp_y = (uint32_t)(y * YSCALE * YTOG) >> 16;
+  // b
+  bgr[0] = std::clamp((int32_t)(-(u * UTOB) + tmp_y + BTOB) >> 6, 0, 255);
+  // g
+  bgr[1] = std::clamp((int32_t)(-(u * UTOG + v * VTOG) + tmp_y + BTOG) >> 6, 0, 255);
+  // r
+  bgr[2] = std::clamp((int32_t)(-(v * VTOR) + tmp_y + BTOR) >> 6, 0, 255);
+}
+
+static void YUV420SPRowToBGRScalar(const uint8_t *y_buf, const uint8_t *uv_buf, uint8_t *bgr_buf, int begin,
+                                   int width, bool nv21) {
+  int x = begin;
+  for (; x < width; x += 2) {
+    uint8_t u = nv21 ? uv_buf[x + 1] : uv_buf[x];
+    uint8_t v = nv21 ? uv_buf[x] : uv_buf[x + 1];
+    YUVToBGRScalar(y_buf[x], u, v, bgr_buf + 3 * x);
+    if (x + 1 < width) {
+      YUVToBGRScalar(y_buf[x + 1], u, v, bgr_buf + 3 * x + 3);
+    }
+  }
+}
+
+static void AffineRowCoordinateScalar(double a, double b, double c, int begin, int width, int *coord) {
+  for (int x = begin; x < width; x++) {
+    coord[x] = static_cast<int>(a * x + b + c);
+  }
+}
+
+#ifdef USE_X86_SIMD
+TARGET_SSE41 static int ResizeBilinearVerticalSSE41(const int16_t *row0, const int16_t *row1, int16_t weight0,
+                                                    int16_t weight1, uint8_t *dst, int len) {
+  const __m128i v_w0 = _mm_set1_epi16(weight0);
+  const __m128i v_w1 = _mm_set1_epi16(weight1);
+  const __m128i v_two = _mm_set1_epi16(2);
+  const __m128i v_low_byte = _mm_set1_epi16(0x00FF);
+  int k = 0;
+  for (; k <= len - 16; k += 16) {
+    __m128i r00 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(row0 + k));
+    __m128i r01 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(row0 + k + 8));
+    __m128i r10 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(row1 + k));
+    __m128i r11 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(row1 + k + 8));
+    // mulhi is exactly (w * r) >> 16, keeping the low byte before packus matches the wrapping uint8 cast
+    __m128i s0 = _mm_add_epi16(_mm_mulhi_epi16(r00, v_w0), _mm_mulhi_epi16(r10, v_w1));
+    __m128i s1 = _mm_add_epi16(_mm_mulhi_epi16(r01, v_w0), _mm_mulhi_epi16(r11, v_w1));
+    s0 = _mm_and_si128(_mm_srai_epi16(_mm_add_epi16(s0, v_two), 2), v_low_byte);
+    s1 = _mm_and_si128(_mm_srai_epi16(_mm_add_epi16(s1, v_two), 2), v_low_byte);
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + k), _mm_packus_epi16(s0, s1));
+  }
+  return k;
+}
+
+TARGET_AVX2 static int ResizeBilinearVerticalAVX2(const int16_t *row0, const int16_t *row1, int16_t weight0,
+                                                  int16_t weight1, uint8_t *dst, int len) {
+  const __m256i v_w0 = _mm256_set1_epi16(weight0);
+  const __m256i v_w1 = _mm256_set1_epi16(weight1);
+  const __m256i v_two = _mm256_set1_epi16(2);
+  const __m256i v_low_byte = _mm256_set1_epi16(0x00FF);
+  int k = 0;
+  for (; k <= len - 32; k += 32) {
+    __m256i r00 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(row0 + k));
+    __m256i r01 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(row0 + k + 16));
+    __m256i r10 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(row1 + k));
+    __m256i r11 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(row1 + k + 16));
+    __m256i s0 = _mm256_add_epi16(_mm256_mulhi_epi16(r00, v_w0), _mm256_mulhi_epi16(r10, v_w1));
+    __m256i s1 = _mm256_add_epi16(_mm256_mulhi_epi16(r01, v_w0), _mm256_mulhi_epi16(r11, v_w1));
+    s0 = _mm256_and_si256(_mm256_srai_epi16(_mm256_add_epi16(s0, v_two), 2), v_low_byte);
+    s1 = _mm256_and_si256(_mm256_srai_epi16(_mm256_add_epi16(s1, v_two), 2), v_low_byte);
+    // packus works per 128-bit lane, restore the element order afterwards
+    __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi16(s0, s1), 0xD8);
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + k), packed);
+  }
+  return k;
+}
+
+TARGET_SSE41 static inline void ConvertI32ScaledSSE41(__m128i v, __m128d scale, float *dst) {
+  // multiply in double and round once to float, as the scalar static_cast<float>(src * scale) does
+  __m128d lo = _mm_mul_pd(_mm_cvtepi32_pd(v), scale);
+  __m128d hi = _mm_mul_pd(_mm_cvtepi32_pd(_mm_srli_si128(v, 8)), scale);
+  _mm_storeu_ps(dst, _mm_movelh_ps(_mm_cvtpd_ps(lo), _mm_cvtpd_ps(hi)));
+}
+
+TARGET_SSE41 static int64_t ConvertU8ToF32SSE41(const uint8_t *src, float *dst, int64_t total, double scale) {
+  int64_t i = 0;
+  if (scale == 1.0) {
+    for (; i <= total - 16; i += 16) {
+      __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+      _mm_storeu_ps(dst + i, _mm_cvtepi32_ps(_mm_cvtepu8_epi32(v)));
+      _mm_storeu_ps(dst + i + 4, _mm_cvtepi32_ps(_mm_cvtepu8_epi32(_mm_srli_si128(v, 4))));
+      _mm_storeu_ps(dst + i + 8, _mm_cvtepi32_ps(_mm_cvtepu8_epi32(_mm_srli_si128(v, 8))));
+      _mm_storeu_ps(dst + i + 12, _mm_cvtepi32_ps(_mm_cvtepu8_epi32(_mm_srli_si128(v, 12))));
+    }
+    return i;
+  }
+  const __m128d v_scale = _mm_set1_pd(scale);
+  for (; i <= total - 16; i += 16) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+    ConvertI32ScaledSSE41(_mm_cvtepu8_epi32(v), v_scale, dst + i);
+    ConvertI32ScaledSSE41(_mm_cvtepu8_epi32(_mm_srli_si128(v, 4)), v_scale, dst + i + 4);
+    ConvertI32ScaledSSE41(_mm_cvtepu8_epi32(_mm_srli_si128(v, 8)), v_scale, dst + i + 8);
+    ConvertI32ScaledSSE41(_mm_cvtepu8_epi32(_mm_srli_si128(v, 12)), v_scale, dst + i + 12);
+  }
+  return i;
+}
+
+TARGET_AVX2 static int64_t ConvertU8ToF32AVX2(const uint8_t *src, float *dst, int64_t total, double scale) {
+  int64_t i = 0;
+  if (scale == 1.0) {
+    for (; i <= total - 16; i += 16) {
+      __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+      _mm256_storeu_ps(dst + i, _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(v)));
+      _mm256_storeu_ps(dst + i + 8, _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(_mm_srli_si128(v, 8))));
+    }
+    return i;
+  }
+  const __m256d v_scale = _mm256_set1_pd(scale);
+  for (; i <= total - 8; i += 8) {
+    __m256i v = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(src + i)));
+    __m128 lo = _mm256_cvtpd_ps(_mm256_mul_pd(_mm256_cvtepi32_pd(_mm256_castsi256_si128(v)), v_scale));
+    __m128 hi = _mm256_cvtpd_ps(_mm256_mul_pd(_mm256_cvtepi32_pd(_mm256_extracti128_si256(v, 1)), v_scale));
+    _mm256_storeu_ps(dst + i, _mm256_insertf128_ps(_mm256_castps128_ps256(lo), hi, 1));
+  }
+  return i;
+}
+
+// For interleaved data the per element mean and std repeat every channel * lanes elements, so a block of that size
+// is covered by `channel` vectors whose lanes are laid out once up front.
+TARGET_SSE41 static int64_t SubtractMeanNormalizeF32SSE41(const float *src, float *dst, int64_t total, int channel,
+                                                          const float *mean, const float *std) {
+  const int lanes = 4;
+  __m128 v_mean[kMaxSimdNormalizeChannel];
+  __m128 v_std[kMaxSimdNormalizeChannel];
+  for (int j = 0; j < channel; j++) {
+    float m[lanes];
+    float s[lanes];
+    for (int l = 0; l < lanes; l++) {
+      m[l] = mean[(j * lanes + l) % channel];
+      s[l] = std[(j * lanes + l) % channel];
+    }
+    v_mean[j] = _mm_loadu_ps(m);
+    v_std[j] = _mm_loadu_ps(s);
+  }
+  const int64_t block = channel * lanes;
+  int64_t i = 0;
+  for (; i <= total - block; i += block) {
+    for (int j = 0; j < channel; j++) {
+      __m128 v = _mm_loadu_ps(src + i + j * lanes);
+      _mm_storeu_ps(dst + i + j * lanes, _mm_div_ps(_mm_sub_ps(v, v_mean[j]), v_std[j]));
+    }
+  }
+  return i;
+}
+
+TARGET_AVX2 static int64_t SubtractMeanNormalizeF32AVX2(const float *src, float *dst, int64_t total, int channel,
+                                                        const float *mean, const float *std) {
+  const int lanes = 8;
+  __m256 v_mean[kMaxSimdNormalizeChannel];
+  __m256 v_std[kMaxSimdNormalizeChannel];
+  for (int j = 0; j < channel; j++) {
+    float m[lanes];
+    float s[lanes];
+    for (int l = 0; l < lanes; l++) {
+      m[l] = mean[(j * lanes + l) % channel];
+      s[l] = std[(j * lanes + l) % channel];
+    }
+    v_mean[j] = _mm256_loadu_ps(m);
+    v_std[j] = _mm256_loadu_ps(s);
+  }
+  const int64_t block = channel * lanes;
+  int64_t i = 0;
+  for (; i <= total - block; i += block) {
+    for (int j = 0; j < channel; j++) {
+      __m256 v = _mm256_loadu_ps(src + i + j * lanes);
+      _mm256_storeu_ps(dst + i + j * lanes, _mm256_div_ps(_mm256_sub_ps(v, v_mean[j]), v_std[j]));
+    }
+  }
+  return i;
+}
+
+TARGET_SSE41 static inline void YUVToBGRSSE41(__m128i y, __m128i u, __m128i v, __m128i *b, __m128i *g, __m128i *r) {
+  // same int32 arithmetic as the scalar path, y * YSCALE * YTOG stays below 2^31
+  __m128i tmp_y = _mm_srli_epi32(_mm_mullo_epi32(y, _mm_set1_epi32(YSCALE * YTOG)), 16);
+  __m128i b_uv = _mm_mullo_epi32(u, _mm_set1_epi32(-UTOB));
+  __m128i g_uv = _mm_add_epi32(_mm_mullo_epi32(u, _mm_set1_epi32(UTOG)), _mm_mullo_epi32(v, _mm_set1_epi32(VTOG)));
+  __m128i r_uv = _mm_mullo_epi32(v, _mm_set1_epi32(-VTOR));
+  *b = _mm_srai_epi32(_mm_add_epi32(_mm_add_epi32(b_uv, tmp_y), _mm_set1_epi32(BTOB)), 6);
+  *g = _mm_srai_epi32(_mm_add_epi32(_mm_sub_epi32(tmp_y, g_uv), _mm_set1_epi32(BTOG)), 6);
+  *r = _mm_srai_epi32(_mm_add_epi32(_mm_add_epi32(r_uv, tmp_y), _mm_set1_epi32(BTOR)), 6);
+}
+
+// pshufb masks interleaving 16 b, g and r bytes into 48 bgr bytes, mask[k][ch] fills output block k from channel ch
+struct BGRShuffleMask {
+  BGRShuffleMask() {
+    for (int k = 0; k < 3; k++) {
+      for (int ch = 0; ch < 3; ch++) {
+        for (int t = 0; t < 16; t++) {
+          int pos = k * 16 + t;
+          mask[k][ch][t] = (pos % 3 == ch) ? static_cast<uint8_t>(pos / 3) : 0x80;
+        }
+      }
+    }
+  }
+  uint8_t mask[3][3][16];
+};
+
+TARGET_SSE41 static int YUV420SPRowToBGRSSE41(const uint8_t *y_buf, const uint8_t *uv_buf, uint8_t *bgr_buf,
+                                              int width, bool nv21) {
+  static const BGRShuffleMask shuffle;
+  __m128i mask[3][3];
+  for (int k = 0; k < 3; k++) {
+    for (int ch = 0; ch < 3; ch++) {
+      mask[k][ch] = _mm_loadu_si128(reinterpret_cast<const __m128i *>(shuffle.mask[k][ch]));
+    }
+  }
+  const __m128i low_byte = _mm_set1_epi16(0x00FF);
+  int x = 0;
+  for (; x <= width - 16; x += 16) {
+    __m128i y8 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(y_buf + x));
+    __m128i uv8 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(uv_buf + x));
+    __m128i even = _mm_and_si128(uv8, low_byte);
+    __m128i odd = _mm_srli_epi16(uv8, 8);
+    __m128i u16 = nv21 ? odd : even;
+    __m128i v16 = nv21 ? even : odd;
+    // every chroma sample is shared by two neighbouring pixels
+    __m128i u_lo = _mm_unpacklo_epi16(u16, u16);
+    __m128i u_hi = _mm_unpackhi_epi16(u16, u16);
+    __m128i v_lo = _mm_unpacklo_epi16(v16, v16);
+    __m128i v_hi = _mm_unpackhi_epi16(v16, v16);
+    __m128i y_lo = _mm_cvtepu8_epi16(y8);
+    __m128i y_hi = _mm_cvtepu8_epi16(_mm_srli_si128(y8, 8));
+
+    __m128i b[4];
+    __m128i g[4];
+    __m128i r[4];
+    YUVToBGRSSE41(_mm_cvtepu16_epi32(y_lo), _mm_cvtepu16_epi32(u_lo), _mm_cvtepu16_epi32(v_lo), &b[0], &g[0], &r[0]);
+    YUVToBGRSSE41(_mm_cvtepu16_epi32(_mm_srli_si128(y_lo, 8)), _mm_cvtepu16_epi32(_mm_srli_si128(u_lo, 8)),
+                  _mm_cvtepu16_epi32(_mm_srli_si128(v_lo, 8)), &b[1], &g[1], &r[1]);
+    YUVToBGRSSE41(_mm_cvtepu16_epi32(y_hi), _mm_cvtepu16_epi32(u_hi), _mm_cvtepu16_epi32(v_hi), &b[2], &g[2], &r[2]);
+    YUVToBGRSSE41(_mm_cvtepu16_epi32(_mm_srli_si128(y_hi, 8)), _mm_cvtepu16_epi32(_mm_srli_si128(u_hi, 8)),
+                  _mm_cvtepu16_epi32(_mm_srli_si128(v_hi, 8)), &b[3], &g[3], &r[3]);
+    // saturating int32 -> int16 -> uint8 packs give the same result as clamping to [0, 255]
+    __m128i b8 = _mm_packus_epi16(_mm_packs_epi32(b[0], b[1]), _mm_packs_epi32(b[2], b[3]));
+    __m128i g8 = _mm_packus_epi16(_mm_packs_epi32(g[0], g[1]), _mm_packs_epi32(g[2], g[3]));
+    __m128i r8 = _mm_packus_epi16(_mm_packs_epi32(r[0], r[1]), _mm_packs_epi32(r[2], r[3]));
+
+    uint8_t *bgr = bgr_buf + 3 * x;
+    for (int k = 0; k < 3; k++) {
+      __m128i out = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(b8, mask[k][0]), _mm_shuffle_epi8(g8, mask[k][1])),
+                                 _mm_shuffle_epi8(r8, mask[k][2]));
+      _mm_storeu_si128(reinterpret_cast<__m128i *>(bgr + 16 * k), out);
+    }
+  }
+  return x;
+}
+
+TARGET_SSE41 static int AffineRowCoordinateSSE41(double a, double b, double c, int width, int *coord) {
+  const __m128d v_a = _mm_set1_pd(a);
+  const __m128d v_b = _mm_set1_pd(b);
+  const __m128d v_c = _mm_set1_pd(c);
+  const __m128d v_two = _mm_set1_pd(2.0);
+  const __m128d v_four = _mm_set1_pd(4.0);
+  __m128d v_x = _mm_set_pd(1.0, 0.0);
+  int x = 0;
+  for (; x <= width - 4; x += 4) {
+    // keep the scalar evaluation order (a * x + b) + c so the truncated results match
+    __m128d lo = _mm_add_pd(_mm_add_pd(_mm_mul_pd(v_a, v_x), v_b), v_c);
+    __m128d hi = _mm_add_pd(_mm_add_pd(_mm_mul_pd(v_a, _mm_add_pd(v_x, v_two)), v_b), v_c);
+    __m128i out = _mm_unpacklo_epi64(_mm_cvttpd_epi32(lo), _mm_cvttpd_epi32(hi));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(coord + x), out);
+    v_x = _mm_add_pd(v_x, v_four);
+  }
+  return x;
+}
+
+TARGET_AVX2 static int AffineRowCoordinateAVX2(double a, double b, double c, int width, int *coord) {
+  const __m256d v_a = _mm256_set1_pd(a);
+  const __m256d v_b = _mm256_set1_pd(b);
+  const __m256d v_c = _mm256_set1_pd(c);
+  const __m256d v_four = _mm256_set1_pd(4.0);
+  const __m256d v_eight = _mm256_set1_pd(8.0);
+  __m256d v_x = _mm256_set_pd(3.0, 2.0, 1.0, 0.0);
+  int x = 0;
+  for (; x <= width - 8; x += 8) {
+    __m256d lo = _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(v_a, v_x), v_b), v_c);
+    __m256d hi = _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(v_a, _mm256_add_pd(v_x, v_four)), v_b), v_c);
+    __m256i out = _mm256_insertf128_si256(_mm256_castsi128_si256(_mm256_cvttpd_epi32(lo)), _mm256_cvttpd_epi32(hi), 1);
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(coord + x), out);
+    v_x = _mm256_add_pd(v_x, v_eight);
+  }
+  return x;
+}
+#endif
+
+#ifdef USE_NEON
+static int ResizeBilinearVerticalNeon(const int16_t *row0, const int16_t *row1, int16_t weight0, int16_t weight1,
+                                      uint8_t *dst, int len) {
+  const int16x4_t v_w0 = vdup_n_s16(weight0);
+  const int16x4_t v_w1 = vdup_n_s16(weight1);
+  const int16x8_t v_two = vdupq_n_s16(2);
+  int k = 0;
+  for (; k <= len - 8; k += 8) {
+    int16x8_t r0 = vld1q_s16(row0 + k);
+    int16x8_t r1 = vld1q_s16(row1 + k);
+    // widen, multiply and narrow back with a truncating shift, exactly (w * r) >> 16
+    int16x8_t t0 = vcombine_s16(vshrn_n_s32(vmull_s16(vget_low_s16(r0), v_w0), 16),
+                                vshrn_n_s32(vmull_s16(vget_high_s16(r0), v_w0), 16));
+    int16x8_t t1 = vcombine_s16(vshrn_n_s32(vmull_s16(vget_low_s16(r1), v_w1), 16),
+                                vshrn_n_s32(vmull_s16(vget_high_s16(r1), v_w1), 16));
+    int16x8_t sum = vshrq_n_s16(vaddq_s16(vaddq_s16(t0, t1), v_two), 2);
+    // plain narrowing keeps the low byte, as the uint8 cast of the scalar path does
+    vst1_u8(dst + k, vmovn_u16(vreinterpretq_u16_s16(sum)));
+  }
+  return k;
+}
+
+#ifdef __aarch64__
+static inline float32x4_t ConvertU32ScaledNeon(uint32x4_t v, float64x2_t scale) {
+  float64x2_t lo = vmulq_f64(vcvtq_f64_u64(vmovl_u32(vget_low_u32(v))), scale);
+  float64x2_t hi = vmulq_f64(vcvtq_f64_u64(vmovl_u32(vget_high_u32(v))), scale);
+  return vcombine_f32(vcvt_f32_f64(lo), vcvt_f32_f64(hi));
+}
+#endif
+
+static int64_t ConvertU8ToF32Neon(const uint8_t *src, float *dst, int64_t total, double scale) {
+  int64_t i = 0;
+  if (scale == 1.0) {
+    for (; i <= total - 16; i += 16) {
+      uint8x16_t v = vld1q_u8(src + i);
+      uint16x8_t lo = vmovl_u8(vget_low_u8(v));
+      uint16x8_t hi = vmovl_u8(vget_high_u8(v));
+      vst1q_f32(dst + i, vcvtq_f32_u32(vmovl_u16(vget_low_u16(lo))));
+      vst1q_f32(dst + i + 4, vcvtq_f32_u32(vmovl_u16(vget_high_u16(lo))));
+      vst1q_f32(dst + i + 8, vcvtq_f32_u32(vmovl_u16(vget_low_u16(hi))));
+      vst1q_f32(dst + i + 12, vcvtq_f32_u32(vmovl_u16(vget_high_u16(hi))));
+    }
+    return i;
+  }
+#ifdef __aarch64__
+  // arm32 has no double vectors, scaled conversion stays scalar there
+  const float64x2_t v_scale = vdupq_n_f64(scale);
+  for (; i <= total - 8; i += 8) {
+    uint16x8_t v = vmovl_u8(vld1_u8(src + i));
+    vst1q_f32(dst + i, ConvertU32ScaledNeon(vmovl_u16(vget_low_u16(v)), v_scale));
+    vst1q_f32(dst + i + 4, ConvertU32ScaledNeon(vmovl_u16(vget_high_u16(v)), v_scale));
+  }
+#endif
+  return i;
+}
+
+static int64_t SubtractMeanNormalizeF32Neon(const float *src, float *dst, int64_t total, int channel,
+                                            const float *mean, const float *std) {
+  int64_t i = 0;
+#ifdef __aarch64__
+  // arm32 only has an approximate reciprocal, which would not match the scalar division
+  const int lanes = 4;
+  float32x4_t v_mean[kMaxSimdNormalizeChannel];
+  float32x4_t v_std[kMaxSimdNormalizeChannel];
+  for (int j = 0; j < channel; j++) {
+    float m[lanes];
+    float s[lanes];
+    for (int l = 0; l < lanes; l++) {
+      m[l] = mean[(j * lanes + l) % channel];
+      s[l] = std[(j * lanes + l) % channel];
+    }
+    v_mean[j] = vld1q_f32(m);
+    v_std[j] = vld1q_f32(s);
+  }
+  const int64_t block = channel * lanes;
+  for (; i <= total - block; i += block) {
+    for (int j = 0; j < channel; j++) {
+      float32x4_t v = vld1q_f32(src + i + j * lanes);
+      vst1q_f32(dst + i + j * lanes, vdivq_f32(vsubq_f32(v, v_mean[j]), v_std[j]));
+    }
+  }
+#endif
+  return i;
+}
+
+static inline void YUVToBGRNeon(int32x4_t y, int32x4_t u, int32x4_t v, int32x4_t *b, int32x4_t *g, int32x4_t *r) {
+  int32x4_t tmp_y = vreinterpretq_s32_u32(vshrq_n_u32(vreinterpretq_u32_s32(vmulq_n_s32(y, YSCALE * YTOG)), 16));
+  int32x4_t g_uv = vaddq_s32(vmulq_n_s32(u, UTOG), vmulq_n_s32(v, VTOG));
+  *b = vshrq_n_s32(vaddq_s32(vaddq_s32(vmulq_n_s32(u, -UTOB), tmp_y), vdupq_n_s32(BTOB)), 6);
+  *g = vshrq_n_s32(vaddq_s32(vsubq_s32(tmp_y, g_uv), vdupq_n_s32(BTOG)), 6);
+  *r = vshrq_n_s32(vaddq_s32(vaddq_s32(vmulq_n_s32(v, -VTOR), tmp_y), vdupq_n_s32(BTOR)), 6);
+}
+
+static inline uint8x8x3_t YUVToBGRx8Neon(uint8x8_t y, uint8x8_t u, uint8x8_t v) {
+  int16x8_t y16 = vreinterpretq_s16_u16(vmovl_u8(y));
+  int16x8_t u16 = vreinterpretq_s16_u16(vmovl_u8(u));
+  int16x8_t v16 = vreinterpretq_s16_u16(vmovl_u8(v));
+  int32x4_t b0, g0, r0, b1, g1, r1;
+  YUVToBGRNeon(vmovl_s16(vget_low_s16(y16)), vmovl_s16(vget_low_s16(u16)), vmovl_s16(vget_low_s16(v16)), &b0, &g0,
+               &r0);
+  YUVToBGRNeon(vmovl_s16(vget_high_s16(y16)), vmovl_s16(vget_high_s16(u16)), vmovl_s16(vget_high_s16(v16)), &b1, &g1,
+               &r1);
+  uint8x8x3_t bgr;
+  bgr.val[0] = vqmovun_s16(vcombine_s16(vqmovn_s32(b0), vqmovn_s32(b1)));
+  bgr.val[1] = vqmovun_s16(vcombine_s16(vqmovn_s32(g0), vqmovn_s32(g1)));
+  bgr.val[2] = vqmovun_s16(vcombine_s16(vqmovn_s32(r0), vqmovn_s32(r1)));
+  return bgr;
+}
+
+static int YUV420SPRowToBGRNeon(const uint8_t *y_buf, const uint8_t *uv_buf, uint8_t *bgr_buf, int width,
+                                bool nv21) {
+  int x = 0;
+  for (; x <= width - 16; x += 16) {
+    uint8x16_t y8 = vld1q_u8(y_buf + x);
+    uint8x8x2_t uv = vld2_u8(uv_buf + x);
+    uint8x8_t u = nv21 ? uv.val[1] : uv.val[0];
+    uint8x8_t v = nv21 ? uv.val[0] : uv.val[1];
+    uint8x8x2_t u2 = vzip_u8(u, u);
+    uint8x8x2_t v2 = vzip_u8(v, v);
+    uint8x8x3_t lo = YUVToBGRx8Neon(vget_low_u8(y8), u2.val[0], v2.val[0]);
+    uint8x8x3_t hi = YUVToBGRx8Neon(vget_high_u8(y8), u2.val[1], v2.val[1]);
+    uint8x16x3_t bgr;
+    bgr.val[0] = vcombine_u8(lo.val[0], hi.val[0]);
+    bgr.val[1] = vcombine_u8(lo.val[1], hi.val[1]);
+    bgr.val[2] = vcombine_u8(lo.val[2], hi.val[2]);
+    vst3q_u8(bgr_buf + 3 * x, bgr);
+  }
+  return x;
+}
+#endif
+
+void ResizeBilinearVertical(const int16_t *row0, const int16_t *row1, int16_t weight0, int16_t weight1, uint8_t *dst,
+                            int len) {
+  int k = 0;
+#if defined(USE_X86_SIMD)
+  SimdLevel level = GetSimdLevel();
+  if (level == SimdLevel::kAVX2) {
+    k = ResizeBilinearVerticalAVX2(row0, row1, weight0, weight1, dst, len);
+  } else if (level == SimdLevel::kSSE41) {
+    k = ResizeBilinearVerticalSSE41(row0, row1, weight0, weight1, dst, len);
+  }
+#elif defined(USE_NEON)
+  if (GetSimdLevel() == SimdLevel::kNEON) {
+    k = ResizeBilinearVerticalNeon(row0, row1, weight0, weight1, dst, len);
+  }
+#endif
+  ResizeBilinearVerticalScalar(row0, row1, weight0, weight1, dst, k, len);
+}
+
+void ConvertU8ToF32(const uint8_t *src, float *dst, int64_t total, double scale) {
+  int64_t i = 0;
+#if defined(USE_X86_SIMD)
+  SimdLevel level = GetSimdLevel();
+  if (level == SimdLevel::kAVX2) {
+    i = ConvertU8ToF32AVX2(src, dst, total, scale);
+  } else if (level == SimdLevel::kSSE41) {
+    i = ConvertU8ToF32SSE41(src, dst, total, scale);
+  }
+#elif defined(USE_NEON)
+  if (GetSimdLevel() == SimdLevel::kNEON) {
+    i = ConvertU8ToF32Neon(src, dst, total, scale);
+  }
+#endif
+  ConvertU8ToF32Scalar(src, dst, i, total, scale);
+}
+
+void SubtractMeanNormalizeF32(const float *src, float *dst, int64_t total, int channel, const float *mean,
+                              const float *std) {
+  int64_t i = 0;
+  if (channel <= kMaxSimdNormalizeChannel) {
+#if defined(USE_X86_SIMD)
+    SimdLevel level = GetSimdLevel();
+    if (level == SimdLevel::kAVX2) {
+      i = SubtractMeanNormalizeF32AVX2(src, dst, total, channel, mean, std);
+    } else if (level == SimdLevel::kSSE41) {
+      i = SubtractMeanNormalizeF32SSE41(src, dst, total, channel, mean, std);
+    }
+#elif defined(USE_NEON)
+    if (GetSimdLevel() == SimdLevel::kNEON) {
+      i = SubtractMeanNormalizeF32Neon(src, dst, total, channel, mean, std);
+    }
+#endif
+  }
+  SubtractMeanNormalizeF32Scalar(src, dst, i, total, channel, mean, std);
+}
+
+void YUV420SPRowToBGR(const uint8_t *y_buf, const uint8_t *uv_buf, uint8_t *bgr_buf, int width, bool nv21) {
+  int x = 0;
+#if defined(USE_X86_SIMD)
+  SimdLevel level = GetSimdLevel();
+  // the shuffle based interleave has no wider AVX2 counterpart, AVX2 machines use the SSE4.1 kernel
+  if (level == SimdLevel::kAVX2 || level == SimdLevel::kSSE41) {
+    x = YUV420SPRowToBGRSSE41(y_buf, uv_buf, bgr_buf, width, nv21);
+  }
+#elif defined(USE_NEON)
+  if (GetSimdLevel() == SimdLevel::kNEON) {
+    x = YUV420SPRowToBGRNeon(y_buf, uv_buf, bgr_buf, width, nv21);
+  }
+#endif
+  YUV420SPRowToBGRScalar(y_buf, uv_buf, bgr_buf, x, width, nv21);
+}
+
+void AffineRowCoordinate(double a, double b, double c, int width, int *coord) {
+  int x = 0;
+#if defined(USE_X86_SIMD)
+  SimdLevel level = GetSimdLevel();
+  if (level == SimdLevel::kAVX2) {
+    x = AffineRowCoordinateAVX2(a, b, c, width, coord);
+  } else if (level == SimdLevel::kSSE41) {
+    x = AffineRowCoordinateSSE41(a, b, c, width, coord);
+  }
+#endif
+  AffineRowCoordinateScalar(a, b, c, x, width, coord);
+}
+
+}  // namespace dataset
+}  // namespace mindspore
@@ -0,0 +1,57 @@
+/**
+ * Copyright 2021 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef IMAGE_PROCESS_SIMD_H_
+#define IMAGE_PROCESS_SIMD_H_
+
+#include <stdint.h>
+
+namespace mindspore {
+namespace dataset {
+
+/// \brief Instruction set used by the vectorised lite_cv kernels
+enum class SimdLevel { kScalar = 0, kSSE41 = 1, kAVX2 = 2, kNEON = 3 };
+
+/// \brief Best instruction set supported by the running CPU, detected once at runtime on x86
+SimdLevel GetSupportedSimdLevel();
+
+/// \brief Instruction set the lite_cv kernels currently dispatch to, the supported level by default
+SimdLevel GetSimdLevel();
+
+/// \brief Restrict the lite_cv kernels to the given instruction set, mainly for testing and benchmarking.
+///        Returns false and keeps the current level if the CPU does not support it
+bool SetSimdLevel(SimdLevel level);
+
+/// \brief Vertical pass of the bilinear resize, blends two horizontally resized int16 rows into one uint8 row
+void ResizeBilinearVertical(const int16_t *row0, const int16_t *row1, int16_t weight0, int16_t weight1, uint8_t *dst,
+                            int len);
+
+/// \brief Convert uint8 data to float32 as static_cast<float>(src * scale)
+void ConvertU8ToF32(const uint8_t *src, float *dst, int64_t total, double scale);
+
+/// \brief Compute (src - mean[c]) / std[c] on interleaved float32 data, c being the channel of each element
+void SubtractMeanNormalizeF32(const float *src, float *dst, int64_t total, int channel, const float *mean,
+                              const float *std);
+
+/// \brief Convert one row of NV21 (nv21 is true) or NV12 data to BGR
+void YUV420SPRowToBGR(const uint8_t *y_buf, const uint8_t *uv_buf, uint8_t *bgr_buf, int width, bool nv21);
+
+/// \brief Compute the truncated affine source coordinate static_cast<int>(a * x + b + c) for x in [0, width)
+void AffineRowCoordinate(double a, double b, double c, int width, int *coord);
+
+}  // namespace dataset
+}  // namespace mindspore
+#endif  // IMAGE_PROCESS_SIMD_H_
@@ -54,6 +54,7 @@ using ParallelContext = mindspore::parallel::ParallelContext;
 using CostModelContext = mindspore::parallel::CostModelContext;
 using mindspore::MsCtxParam;
 using PSContext = mindspore::ps::PSContext;
+using DynamicEmbeddingMetrics = mindspore::ps::DynamicEmbeddingMetrics;
 
 // Interface with python
 PYBIND11_MODULE(_c_expression, m) {
@@ -315,7 +316,38 @@ PYBIND11_MODULE(_c_expression, m) {
     .def("insert_weight_init_info", &PSContext::InsertWeightInitInfo, "Insert embedding table initialization seed.")
     .def("insert_accumu_init_info", &PSContext::InsertAccumuInitInfo, "Insert accumulation initialization value.")
     .def("clone_hash_table", &PSContext::CloneHashTable, "Clone a hash table.")
-    .def("set_cache_enable", &PSContext::set_cache_enable, "Set ps mode cache enable or not.");
+    .def("set_cache_enable", &PSContext::set_cache_enable, "Set ps mode cache enable or not.")
+    .def("set_consistency_mode", &PSContext::set_consistency_mode, "Set the consistency mode of ps mode.")
+    .def("consistency_mode", &PSContext::consistency_mode, "Get the consistency mode of ps mode.")
+    .def("set_staleness_threshold", &PSContext::set_staleness_threshold, "Set the staleness threshold of ssp mode.")
+    .def("staleness_threshold", &PSContext::staleness_threshold, "Get the staleness threshold of ssp mode.")
+    .def("set_compression", &PSContext::set_compression, "Set the compression of the values sent in ps mode.")
+    .def("compression", &PSContext::compression, "Get the compression of the values sent in ps mode.")
+    .def("set_topk_ratio", &PSContext::set_topk_ratio, "Set the ratio of the values sent by topk compression.")
+    .def("topk_ratio", &PSContext::topk_ratio, "Get the ratio of the values sent by topk compression.")
+    .def("set_embedding_storage", &PSContext::set_embedding_storage, "Set the storage of ps cache embedding tables.")
+    .def("embedding_storage", &PSContext::embedding_storage, "Get the storage of ps cache embedding tables.")
+    .def("set_embedding_admit_threshold", &PSContext::set_embedding_admit_threshold,
+         "Set the occurrences of an id before it is admitted to a dynamic embedding table.")
+    .def("embedding_admit_threshold", &PSContext::embedding_admit_threshold,
+         "Get the occurrences of an id before it is admitted to a dynamic embedding table.")
+    .def("set_embedding_ttl", &PSContext::set_embedding_ttl, "Set the ttl of the rows of dynamic embedding tables.")
+    .def("embedding_ttl", &PSContext::embedding_ttl, "Get the ttl of the rows of dynamic embedding tables.")
+    .def("set_embedding_max_rows", &PSContext::set_embedding_max_rows,
+         "Set the max rows of a dynamic embedding table.")
+    .def("embedding_max_rows", &PSContext::embedding_max_rows, "Get the max rows of a dynamic embedding table.")
+    .def("embedding_metrics", &PSContext::embedding_metrics, "Get the metrics of the dynamic embedding tables.");
+
+  (void)py::class_<DynamicEmbeddingMetrics>(m, "DynamicEmbeddingMetrics")
+    .def_readonly("row_num", &DynamicEmbeddingMetrics::row_num)
+    .def_readonly("memory_bytes", &DynamicEmbeddingMetrics::memory_bytes)
+    .def_readonly("lookup_ids", &DynamicEmbeddingMetrics::lookup_ids)
+    .def_readonly("lookup_hits", &DynamicEmbeddingMetrics::lookup_hits)
+    .def_readonly("admitted_ids", &DynamicEmbeddingMetrics::admitted_ids)
+    .def_readonly("rejected_ids", &DynamicEmbeddingMetrics::rejected_ids)
+    .def_readonly("ttl_evicted_rows", &DynamicEmbeddingMetrics::ttl_evicted_rows)
+    .def_readonly("lfu_evicted_rows", &DynamicEmbeddingMetrics::lfu_evicted_rows)
+    .def_readonly("lookup_seconds", &DynamicEmbeddingMetrics::lookup_seconds);
 
   (void)py::class_<OpInfoLoaderPy, std::shared_ptr<OpInfoLoaderPy>>(m, "OpInfoLoaderPy")
     .def(py::init())
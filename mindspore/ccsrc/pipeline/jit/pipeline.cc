@@ -927,6 +927,15 @@ bool InitExecDatasetVm(const std::string &queue_name, int64_t size, int64_t batc
     return true;
   }
 #endif
+  if (MsContext::GetInstance()->get_param<std::string>(MS_CTX_DEVICE_TARGET) == kCPUDevice) {
+#ifdef ENABLE_CPUQUE
+    // The dataset creates the cpu queue of the channel and the GetNext kernel opens it, there is no init graph to run.
+    MS_LOG(INFO) << "Dataset sink on cpu through queue " << queue_name;
+    return true;
+#else
+    MS_LOG(EXCEPTION) << "Dataset sink mode is not supported on cpu by this build.";
+#endif
+  }
   MS_LOG(INFO) << "Start InitDataSet Entry";
   ShapeVector int_input_indexes;
   (void)std::transform(input_indexes.begin(), input_indexes.end(), std::back_inserter(int_input_indexes),
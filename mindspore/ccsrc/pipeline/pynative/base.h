@@ -63,6 +63,8 @@ struct OpExecInfo {
   std::string next_op_name = "";
   bool is_mixed_precision_cast = false;
   size_t next_input_index = 0;
+  // set from the abstract cache on a hit, built with the graph info otherwise
+  std::string graph_info_suffix;
 };
 using OpExecInfoPtr = std::shared_ptr<OpExecInfo>;
 
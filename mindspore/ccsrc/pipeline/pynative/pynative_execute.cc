@@ -64,6 +64,8 @@
 using mindspore::tensor::TensorPy;
 
 const size_t PTR_LEN = 15;
+// enough for the graph info of most single ops, saves regrowing the string while it is built
+const size_t GRAPH_INFO_RESERVE_SIZE = 256;
 // primitive unable to infer value for constant input in PyNative mode
 const std::set<std::string> vm_operators = {"make_ref", "HookBackward", "InsertGradientOf", "stop_gradient",
                                             "mixed_precision_cast"};
@@ -254,32 +256,23 @@ void PynativeInfer(const PrimitivePyPtr &prim, const py::list &py_args, OpExecIn
   MS_LOG(DEBUG) << "Prim " << prim->name() << " infer result " << op_exec_info->abstract->ToString();
 }
 
-std::string GetSingleOpGraphInfo(const OpExecInfoPtr &op_exec_info,
-                                 const std::vector<tensor::TensorPtr> &input_tensors) {
+// The attr and output abstract part of the graph info only depends on the attrs, including the const inputs
+// converted to attrs, and on the inferred abstract. It is built once per entry of the abstract cache and reused while
+// the op hits that entry.
+std::string GetGraphInfoSuffix(const OpExecInfoPtr &op_exec_info) {
   MS_EXCEPTION_IF_NULL(op_exec_info);
-  std::string graph_info;
-  // get input tensor info
-  for (const auto &tensor : input_tensors) {
-    MS_EXCEPTION_IF_NULL(tensor);
-    auto tensor_shape = tensor->shape();
-    (void)std::for_each(tensor_shape.begin(), tensor_shape.end(),
-                        [&](const auto &dim) { (void)graph_info.append(std::to_string(dim) + "_"); });
-    (void)graph_info.append(std::to_string(tensor->data_type()) + "_");
-    if (tensor->device_address() != nullptr) {
-      (void)graph_info.append(
-        std::to_string(std::dynamic_pointer_cast<device::DeviceAddress>(tensor->device_address())->type_id()) + "_");
-      (void)graph_info.append(std::dynamic_pointer_cast<device::DeviceAddress>(tensor->device_address())->format() +
-                              "_");
-    }
-  }
-  // get prim and abstract info
-  (void)graph_info.append(op_exec_info->prim_id + "_");
-  // get attr info
+  std::string suffix;
+  // get attr info, the kernel of the op graph is built with every attr of the prim
   const auto &op_prim = op_exec_info->py_primitive;
   MS_EXCEPTION_IF_NULL(op_prim);
-  const auto &attr_map = op_prim->evaluate_added_attrs();
-  (void)std::for_each(attr_map.begin(), attr_map.end(),
-                      [&](const auto &element) { (void)graph_info.append(element.second->ToString() + "_"); });
+  const std::map<std::string, ValuePtr> attr_map(op_prim->attrs().begin(), op_prim->attrs().end());
+  (void)std::for_each(attr_map.begin(), attr_map.end(), [&](const auto &element) {
+    MS_EXCEPTION_IF_NULL(element.second);
+    (void)suffix.append(element.first);
+    (void)suffix.append(":");
+    (void)suffix.append(element.second->ToString());
+    (void)suffix.append("_");
+  });
 
   // Add output information(shape, type id) of the operator to graph_info to solve the problem of cache missing
   // caused by operators like DropoutGenMask whose output is related to values of input when input shapes are
@@ -288,11 +281,44 @@ std::string GetSingleOpGraphInfo(const OpExecInfoPtr &op_exec_info,
   MS_EXCEPTION_IF_NULL(abstr);
   auto build_shape = abstr->BuildShape();
   MS_EXCEPTION_IF_NULL(build_shape);
-  (void)graph_info.append(build_shape->ToString() + "_");
+  (void)suffix.append(build_shape->ToString());
+  (void)suffix.append("_");
   auto build_type = abstr->BuildType();
   MS_EXCEPTION_IF_NULL(build_type);
-  (void)graph_info.append(std::to_string(build_type->type_id()) + "_");
+  (void)suffix.append(std::to_string(build_type->type_id()));
+  (void)suffix.append("_");
+  return suffix;
+}
 
+std::string GetSingleOpGraphInfo(const OpExecInfoPtr &op_exec_info,
+                                 const std::vector<tensor::TensorPtr> &input_tensors) {
+  MS_EXCEPTION_IF_NULL(op_exec_info);
+  std::string graph_info;
+  graph_info.reserve(GRAPH_INFO_RESERVE_SIZE);
+  // get input tensor info
+  for (const auto &tensor : input_tensors) {
+    MS_EXCEPTION_IF_NULL(tensor);
+    for (const auto &dim : tensor->shape()) {
+      (void)graph_info.append(std::to_string(dim));
+      (void)graph_info.append("_");
+    }
+    (void)graph_info.append(std::to_string(tensor->data_type()));
+    (void)graph_info.append("_");
+    auto device_address = std::dynamic_pointer_cast<device::DeviceAddress>(tensor->device_address());
+    if (device_address != nullptr) {
+      (void)graph_info.append(std::to_string(device_address->type_id()));
+      (void)graph_info.append("_");
+      (void)graph_info.append(device_address->format());
+      (void)graph_info.append("_");
+    }
+  }
+  // get prim and abstract info
+  (void)graph_info.append(op_exec_info->prim_id);
+  (void)graph_info.append("_");
+  if (op_exec_info->graph_info_suffix.empty()) {
+    op_exec_info->graph_info_suffix = GetGraphInfoSuffix(op_exec_info);
+  }
+  (void)graph_info.append(op_exec_info->graph_info_suffix);
   return graph_info;
 }
 
@@ -564,11 +590,15 @@ py::tuple PynativeExecutor::RunOpInner(const OpExecInfoPtr &op_exec_info) {
   // infer output value for const prim
   auto prim = op_exec_info->py_primitive;
   MS_EXCEPTION_IF_NULL(prim);
-  py::dict output = abstract::ConvertAbstractToPython(op_exec_info->abstract);
-  if (!output["value"].is_none()) {
-    py::tuple value_ret(1);
-    value_ret[0] = output["value"];
-    return value_ret;
+  // a cached abstract holds no const value, the conversion to python is only needed on a miss
+  bool check_value = !is_find || force_infer_prim.find(op_exec_info->op_name) != force_infer_prim.end();
+  if (check_value) {
+    py::dict output = abstract::ConvertAbstractToPython(op_exec_info->abstract);
+    if (!output["value"].is_none()) {
+      py::tuple value_ret(1);
+      value_ret[0] = output["value"];
+      return value_ret;
+    }
   }
   if (prim->is_const_prim()) {
     py::tuple value_ret(1);
@@ -576,15 +606,15 @@ py::tuple PynativeExecutor::RunOpInner(const OpExecInfoPtr &op_exec_info) {
     return value_ret;
   }
   // add output abstract info into cache
-  if (!is_find && !op_exec_info->is_dynamic_shape) {
-    // const_value need infer every step
-    auto &out = prim_abs_list_[prim->id()];
-    out[args_spec_list].abs = op_exec_info->abstract;
-    out[args_spec_list].attrs = prim->evaluate_added_attrs();
-    MS_LOG(DEBUG) << "Set prim " << op_exec_info->op_name << mindspore::ToString(args_spec_list);
+  bool add_to_cache = !is_find && !op_exec_info->is_dynamic_shape;
+  if (add_to_cache) {
+    CacheOpOutputAbstract(op_exec_info, args_spec_list);
   }
   // run op with selected backend
   auto result = RunOpWithInitBackendPolicy(op_exec_info);
+  if (add_to_cache) {
+    CacheGraphInfoSuffix(op_exec_info, args_spec_list);
+  }
   py::object out_real = result;
   if (result.size() == 1) {
     MS_LOG(DEBUG) << "Output size is 1";
@@ -721,14 +751,21 @@ void PynativeExecutor::GetOpOutputAbstract(const OpExecInfoPtr &op_exec_info,
   auto op_name = op_exec_info->op_name;
   auto prim = op_exec_info->py_primitive;
   MS_EXCEPTION_IF_NULL(prim);
-  if (prim_abs_list_.find(prim->id()) != prim_abs_list_.end()) {
-    auto abs_list = prim_abs_list_[prim->id()];
+  auto prim_iter = prim_abs_list_.find(prim->id());
+  if (prim_iter != prim_abs_list_.end()) {
     MS_LOG(DEBUG) << "Match prim input args " << op_name << mindspore::ToString(args_spec_list);
-    if (abs_list.find(args_spec_list) != abs_list.end()) {
+    auto abs_iter = prim_iter->second.find(args_spec_list);
+    // an attr set from python since the entry was inferred may change the output, the op is inferred again
+    if (abs_iter != prim_iter->second.end() && abs_iter->second.attr_version == prim->attr_version()) {
       MS_LOG(DEBUG) << "Match prim ok " << op_name;
-      op_exec_info->abstract = abs_list[args_spec_list].abs;
-      prim->set_evaluate_added_attrs(abs_list[args_spec_list].attrs);
+      op_exec_info->abstract = abs_iter->second.abs;
+      prim->set_evaluate_added_attrs(abs_iter->second.attrs);
       *is_find = true;
+      if (force_infer_prim.find(op_name) == force_infer_prim.end()) {
+        // Only abstracts of static shape are cached, there is nothing left to infer or to check
+        op_exec_info->graph_info_suffix = abs_iter->second.graph_info_suffix;
+        return;
+      }
     }
   }
   if (op_exec_info->abstract == nullptr || force_infer_prim.find(op_name) != force_infer_prim.end()) {
@@ -756,6 +793,39 @@ void PynativeExecutor::GetOpOutputAbstract(const OpExecInfoPtr &op_exec_info,
   }
 }
 
+void PynativeExecutor::CacheOpOutputAbstract(const OpExecInfoPtr &op_exec_info,
+                                             const abstract::AbstractBasePtrList &args_spec_list) {
+  MS_EXCEPTION_IF_NULL(op_exec_info);
+  auto prim = op_exec_info->py_primitive;
+  MS_EXCEPTION_IF_NULL(prim);
+  // const_value need infer every step
+  auto &out = prim_abs_list_[prim->id()][args_spec_list];
+  out.abs = op_exec_info->abstract;
+  out.attrs = prim->evaluate_added_attrs();
+  out.attr_version = prim->attr_version();
+  out.graph_info_suffix.clear();
+  MS_LOG(DEBUG) << "Set prim " << op_exec_info->op_name << mindspore::ToString(args_spec_list);
+}
+
+void PynativeExecutor::CacheGraphInfoSuffix(const OpExecInfoPtr &op_exec_info,
+                                            const abstract::AbstractBasePtrList &args_spec_list) {
+  MS_EXCEPTION_IF_NULL(op_exec_info);
+  // the const inputs are converted to attrs while running, the suffix built then is kept for the next hits
+  if (op_exec_info->graph_info_suffix.empty()) {
+    return;
+  }
+  auto prim = op_exec_info->py_primitive;
+  MS_EXCEPTION_IF_NULL(prim);
+  auto prim_iter = prim_abs_list_.find(prim->id());
+  if (prim_iter == prim_abs_list_.end()) {
+    return;
+  }
+  auto abs_iter = prim_iter->second.find(args_spec_list);
+  if (abs_iter != prim_iter->second.end() && abs_iter->second.attr_version == prim->attr_version()) {
+    abs_iter->second.graph_info_suffix = op_exec_info->graph_info_suffix;
+  }
+}
+
 py::object PynativeExecutor::DoAutoCast(const py::object &arg, const TypeId &type_id, const std::string &op_name,
                                         size_t index) {
   py::tuple cast_args(3);
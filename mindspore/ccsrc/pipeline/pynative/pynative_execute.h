@@ -48,6 +48,10 @@ struct PrimAbsInfo {
   abstract::AbstractBasePtr abs;
   bool is_dynamic_shape = false;
   std::unordered_map<std::string, ValuePtr> attrs;
+  // attr version of the prim the abstract was inferred with
+  uint64_t attr_version = 0;
+  // attr and output part of the single op graph info, reused by every op hitting this entry
+  std::string graph_info_suffix;
 };
 
 using AbstractListMap = std::unordered_map<abstract::AbstractBasePtrList, PrimAbsInfo,
@@ -55,6 +59,10 @@ using AbstractListMap = std::unordered_map<abstract::AbstractBasePtrList, PrimAb
 
 py::tuple RunOp(const py::args &args);
 
+// key of the single op graph run for the op on input_tensors
+std::string GetSingleOpGraphInfo(const OpExecInfoPtr &op_exec_info,
+                                 const std::vector<tensor::TensorPtr> &input_tensors);
+
 void ClearPyNativeSession();
 
 struct GraphInfo {
@@ -132,6 +140,8 @@ class PynativeExecutor : public std::enable_shared_from_this<PynativeExecutor> {
                        abstract::AbstractBasePtrList *args_spec_list);
   void GetOpOutputAbstract(const OpExecInfoPtr &op_exec_info, const abstract::AbstractBasePtrList &args_spec_list,
                            bool *is_find);
+  void CacheOpOutputAbstract(const OpExecInfoPtr &op_exec_info, const abstract::AbstractBasePtrList &args_spec_list);
+  void CacheGraphInfoSuffix(const OpExecInfoPtr &op_exec_info, const abstract::AbstractBasePtrList &args_spec_list);
   void SaveOutputNodeMap(const std::string &obj_id, const py::object &out_real, const AnfNodePtr &cnode);
 
   // replace for grad graph
@@ -0,0 +1,387 @@
+/**
+ * Copyright 2021 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "ps/compression.h"
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstring>
+#include <numeric>
+#include <vector>
+#ifdef __F16C__
+#include <immintrin.h>
+#endif
+#include "utils/log_adapter.h"
+
+namespace mindspore {
+namespace ps {
+namespace {
+// codec and original length of the segment
+constexpr size_t kHeaderSize = 2;
+// set in the codec of a segment encoded as the delta against a base
+constexpr uint32_t kDeltaFlag = 0x80000000;
+
+// the header of an encoded segment
+struct Segment {
+  CompressCodec codec;
+  bool delta;
+  size_t num;
+  size_t k;
+  size_t encoded_size;
+};
+
+inline uint32_t FloatBits(float value) {
+  uint32_t bits;
+  (void)memcpy(&bits, &value, sizeof(bits));
+  return bits;
+}
+
+inline float BitsFloat(uint32_t bits) {
+  float value;
+  (void)memcpy(&value, &bits, sizeof(value));
+  return value;
+}
+
+// Round to nearest even, as the F16C instructions do.
+inline uint16_t FloatToHalfScalar(float value) {
+  uint32_t bits = FloatBits(value);
+  uint32_t sign = (bits >> 16) & 0x8000;
+  uint32_t abs = bits & 0x7fffffff;
+  if (abs >= 0x47800000) {
+    // too large for half, infinity or nan
+    return static_cast<uint16_t>(sign | (abs > 0x7f800000 ? 0x7e00 : 0x7c00));
+  }
+  if (abs < 0x38800000) {
+    // subnormal in half, the addition of 0.5 rounds the mantissa into place
+    return static_cast<uint16_t>(sign | (FloatBits(BitsFloat(abs) + 0.5f) - 0x3f000000));
+  }
+  uint32_t mant_odd = (abs >> 13) & 1;
+  abs += 0xc8000fff + mant_odd;
+  return static_cast<uint16_t>(sign | (abs >> 13));
+}
+
+inline float HalfToFloatScalar(uint16_t value) {
+  uint32_t sign = static_cast<uint32_t>(value & 0x8000) << 16;
+  uint32_t bits = static_cast<uint32_t>(value & 0x7fff) << 13;
+  uint32_t exp = bits & 0x0f800000;
+  bits += (127 - 15) << 23;
+  if (exp == 0x0f800000) {
+    // infinity or nan
+    bits += (128 - 16) << 23;
+  } else if (exp == 0) {
+    // subnormal
+    bits = FloatBits(BitsFloat(bits + (1 << 23)) - BitsFloat(113 << 23));
+  }
+  return BitsFloat(bits | sign);
+}
+
+inline size_t PackedSize(size_t num) { return (num + 1) / 2; }
+
+size_t TopKNum(size_t num, float topk_ratio) {
+  size_t k = static_cast<size_t>(std::ceil(num * topk_ratio));
+  return std::min(std::max(k, static_cast<size_t>(1)), num);
+}
+
+CompressCodec SegmentCodec(CompressCodec codec, size_t num) { return num < kMinCompressSize ? kCodecNone : codec; }
+
+size_t SegmentEncodedSize(CompressCodec codec, size_t num, size_t k) {
+  switch (codec) {
+    case kCodecFp16:
+    case kCodecBf16:
+      return kHeaderSize + PackedSize(num);
+    case kCodecTopK:
+      return kHeaderSize + 1 + 2 * k;
+    default:
+      return kHeaderSize + num;
+  }
+}
+
+// Read the header of the segment at pos and check that the segment fits in the size encoded values.
+Segment ParseSegment(const float *encoded, size_t size, size_t pos) {
+  if (size - pos < kHeaderSize) {
+    MS_LOG(EXCEPTION) << "The encoded values are truncated at " << pos << ", size is " << size;
+  }
+  Segment seg;
+  uint32_t codec_bits = FloatBits(encoded[pos]);
+  seg.codec = static_cast<CompressCodec>(codec_bits & ~kDeltaFlag);
+  seg.delta = (codec_bits & kDeltaFlag) != 0;
+  seg.num = FloatBits(encoded[pos + 1]);
+  seg.k = 0;
+  if (seg.codec > kCodecTopK) {
+    MS_LOG(EXCEPTION) << "Unknown codec " << seg.codec << " of the encoded values at " << pos;
+  }
+  if (seg.num > INT_MAX) {
+    MS_LOG(EXCEPTION) << "The length " << seg.num << " of the encoded segment at " << pos << " is out of range";
+  }
+  if (seg.codec == kCodecTopK) {
+    if (size - pos < kHeaderSize + 1) {
+      MS_LOG(EXCEPTION) << "The encoded values are truncated at " << pos << ", size is " << size;
+    }
+    seg.k = FloatBits(encoded[pos + kHeaderSize]);
+    if (seg.k > seg.num) {
+      MS_LOG(EXCEPTION) << "The topk number " << seg.k << " of the segment at " << pos << " exceeds its length "
+                        << seg.num;
+    }
+  }
+  seg.encoded_size = SegmentEncodedSize(seg.codec, seg.num, seg.k);
+  if (seg.encoded_size > size - pos) {
+    MS_LOG(EXCEPTION) << "The segment at " << pos << " of " << seg.encoded_size
+                      << " encoded values exceeds the size " << size;
+  }
+  return seg;
+}
+
+// Encode num values of src with codec to out, returns the encoded size.
+size_t EncodeSegment(CompressCodec codec, const float *src, size_t num, float topk_ratio, float *residual,
+                     float *out) {
+  size_t k = TopKNum(num, topk_ratio);
+  out[0] = BitsFloat(codec);
+  out[1] = BitsFloat(static_cast<uint32_t>(num));
+  float *payload = out + kHeaderSize;
+  switch (codec) {
+    case kCodecFp16:
+      FloatToHalf(src, num, reinterpret_cast<uint16_t *>(payload));
+      break;
+    case kCodecBf16:
+      FloatToBf16(src, num, reinterpret_cast<uint16_t *>(payload));
+      break;
+    case kCodecTopK:
+      payload[0] = BitsFloat(static_cast<uint32_t>(k));
+      TopKSparsify(src, num, k, residual, reinterpret_cast<uint32_t *>(payload + 1), payload + 1 + k);
+      break;
+    default:
+      (void)std::copy(src, src + num, payload);
+      break;
+  }
+  return SegmentEncodedSize(codec, num, k);
+}
+
+void DecodeSegment(const Segment &seg, const float *payload, float *out) {
+  switch (seg.codec) {
+    case kCodecFp16:
+      HalfToFloat(reinterpret_cast<const uint16_t *>(payload), seg.num, out);
+      break;
+    case kCodecBf16:
+      Bf16ToFloat(reinterpret_cast<const uint16_t *>(payload), seg.num, out);
+      break;
+    case kCodecTopK: {
+      const uint32_t *indices = reinterpret_cast<const uint32_t *>(payload + 1);
+      const float *values = payload + 1 + seg.k;
+      std::fill(out, out + seg.num, 0.0f);
+      for (size_t j = 0; j < seg.k; j++) {
+        if (indices[j] >= seg.num) {
+          MS_LOG(EXCEPTION) << "The index " << indices[j] << " of topk values is out of range " << seg.num;
+        }
+        out[indices[j]] = values[j];
+      }
+      break;
+    }
+    default:
+      (void)std::copy(payload, payload + seg.num, out);
+      break;
+  }
+}
+}  // namespace
+
+CompressCodec StringToCodec(const std::string &compression) {
+  if (compression == kCompressionNone) {
+    return kCodecNone;
+  } else if (compression == kCompressionFp16) {
+    return kCodecFp16;
+  } else if (compression == kCompressionBf16) {
+    return kCodecBf16;
+  } else if (compression == kCompressionTopK) {
+    return kCodecTopK;
+  }
+  MS_LOG(EXCEPTION) << "Compression should be one of none, fp16, bf16 and topk, but got " << compression;
+}
+
+CompressCodec CastCodec(CompressCodec codec) { return codec == kCodecTopK ? kCodecNone : codec; }
+
+void FloatToHalf(const float *src, size_t num, uint16_t *dst) {
+  size_t i = 0;
+#ifdef __F16C__
+  for (; i + 8 <= num; i += 8) {
+    __m128i half = _mm256_cvtps_ph(_mm256_loadu_ps(src + i), _MM_FROUND_TO_NEAREST_INT);
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), half);
+  }
+#endif
+  for (; i < num; i++) {
+    dst[i] = FloatToHalfScalar(src[i]);
+  }
+}
+
+void HalfToFloat(const uint16_t *src, size_t num, float *dst) {
+  size_t i = 0;
+#ifdef __F16C__
+  for (; i + 8 <= num; i += 8) {
+    __m128i half = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+    _mm256_storeu_ps(dst + i, _mm256_cvtph_ps(half));
+  }
+#endif
+  for (; i < num; i++) {
+    dst[i] = HalfToFloatScalar(src[i]);
+  }
+}
+
+// Plain integer arithmetic without branches, the compiler vectorizes both loops.
+void FloatToBf16(const float *src, size_t num, uint16_t *dst) {
+  const uint32_t *bits = reinterpret_cast<const uint32_t *>(src);
+  for (size_t i = 0; i < num; i++) {
+    uint32_t value = bits[i];
+    uint32_t rounded = (value + 0x7fff + ((value >> 16) & 1)) >> 16;
+    uint32_t quiet_nan = (value >> 16) | 0x40;
+    dst[i] = static_cast<uint16_t>((value & 0x7fffffff) > 0x7f800000 ? quiet_nan : rounded);
+  }
+}
+
+void Bf16ToFloat(const uint16_t *src, size_t num, float *dst) {
+  uint32_t *bits = reinterpret_cast<uint32_t *>(dst);
+  for (size_t i = 0; i < num; i++) {
+    bits[i] = static_cast<uint32_t>(src[i]) << 16;
+  }
+}
+
+void TopKSparsify(const float *src, size_t num, size_t k, float *residual, uint32_t *indices, float *values) {
+  for (size_t i = 0; i < num; i++) {
+    residual[i] += src[i];
+  }
+  std::vector<uint32_t> order(num);
+  std::iota(order.begin(), order.end(), 0);
+  if (k < num) {
+    (void)std::nth_element(order.begin(), order.begin() + k, order.end(), [residual](uint32_t a, uint32_t b) {
+      return std::fabs(residual[a]) > std::fabs(residual[b]);
+    });
+  }
+  std::sort(order.begin(), order.begin() + k);
+  for (size_t i = 0; i < k; i++) {
+    indices[i] = order[i];
+    values[i] = residual[order[i]];
+    residual[order[i]] = 0;
+  }
+}
+
+size_t EncodedSize(CompressCodec codec, const int *lens, size_t len_num, float topk_ratio) {
+  std::vector<CompressCodec> codecs(len_num, codec);
+  return EncodedSize(codecs.data(), lens, len_num, topk_ratio);
+}
+
+size_t EncodedSize(const CompressCodec *codecs, const int *lens, size_t len_num, float topk_ratio) {
+  size_t total_size = 0;
+  for (size_t i = 0; i < len_num; i++) {
+    size_t num = static_cast<size_t>(lens[i]);
+    total_size += SegmentEncodedSize(SegmentCodec(codecs[i], num), num, TopKNum(num, topk_ratio));
+  }
+  return total_size;
+}
+
+void EncodeValues(CompressCodec codec, const float *src, const int *lens, size_t len_num, float topk_ratio,
+                  float *residual, float *encoded, int *encoded_lens) {
+  std::vector<CompressCodec> codecs(len_num, codec);
+  EncodeValues(codecs.data(), src, lens, len_num, topk_ratio, residual, encoded, encoded_lens);
+}
+
+void EncodeValues(const CompressCodec *codecs, const float *src, const int *lens, size_t len_num, float topk_ratio,
+                  float *residual, float *encoded, int *encoded_lens) {
+  MS_EXCEPTION_IF_NULL(codecs);
+  MS_EXCEPTION_IF_NULL(src);
+  MS_EXCEPTION_IF_NULL(lens);
+  MS_EXCEPTION_IF_NULL(encoded);
+  MS_EXCEPTION_IF_NULL(encoded_lens);
+  float *out = encoded;
+  size_t offset = 0;
+  for (size_t i = 0; i < len_num; i++) {
+    size_t num = static_cast<size_t>(lens[i]);
+    CompressCodec seg_codec = SegmentCodec(codecs[i], num);
+    if (seg_codec == kCodecTopK) {
+      MS_EXCEPTION_IF_NULL(residual);
+    }
+    size_t encoded_size =
+      EncodeSegment(seg_codec, src + offset, num, topk_ratio, residual == nullptr ? nullptr : residual + offset, out);
+    encoded_lens[i] = static_cast<int>(encoded_size);
+    out += encoded_size;
+    offset += num;
+  }
+}
+
+size_t DeltaEncodedSize(CompressCodec codec, size_t num) {
+  return SegmentEncodedSize(SegmentCodec(codec, num), num, 0);
+}
+
+void EncodeDelta(CompressCodec codec, const float *src, size_t num, float *base, float *encoded) {
+  MS_EXCEPTION_IF_NULL(src);
+  MS_EXCEPTION_IF_NULL(base);
+  MS_EXCEPTION_IF_NULL(encoded);
+  if (codec == kCodecTopK) {
+    MS_LOG(EXCEPTION) << "The deltas are not sparsified by topk";
+  }
+  std::vector<float> delta(num);
+  for (size_t i = 0; i < num; i++) {
+    delta[i] = src[i] - base[i];
+  }
+  size_t encoded_size = EncodeSegment(SegmentCodec(codec, num), delta.data(), num, 0, nullptr, encoded);
+  encoded[0] = BitsFloat(FloatBits(encoded[0]) | kDeltaFlag);
+  // the receiver adds the decoded delta to the same base
+  Segment seg = ParseSegment(encoded, encoded_size, 0);
+  DecodeSegment(seg, encoded + kHeaderSize, delta.data());
+  for (size_t i = 0; i < num; i++) {
+    base[i] = delta[i] + base[i];
+  }
+}
+
+size_t DecodedSize(const float *encoded, size_t size, size_t *segment_num) {
+  MS_EXCEPTION_IF_NULL(encoded);
+  MS_EXCEPTION_IF_NULL(segment_num);
+  size_t total_num = 0;
+  *segment_num = 0;
+  for (size_t pos = 0; pos < size;) {
+    Segment seg = ParseSegment(encoded, size, pos);
+    total_num += seg.num;
+    (*segment_num)++;
+    pos += seg.encoded_size;
+  }
+  return total_num;
+}
+
+void DecodeValues(const float *encoded, size_t size, float *dst, size_t dst_size, int *lens, const float *base) {
+  MS_EXCEPTION_IF_NULL(encoded);
+  MS_EXCEPTION_IF_NULL(dst);
+  size_t offset = 0;
+  for (size_t pos = 0, i = 0; pos < size; i++) {
+    Segment seg = ParseSegment(encoded, size, pos);
+    if (seg.num > dst_size - offset) {
+      MS_LOG(EXCEPTION) << "The segment at " << pos << " decodes to " << seg.num << " values, only "
+                        << dst_size - offset << " are left of " << dst_size;
+    }
+    float *out = dst + offset;
+    DecodeSegment(seg, encoded + pos + kHeaderSize, out);
+    if (seg.delta) {
+      if (base == nullptr) {
+        MS_LOG(EXCEPTION) << "The segment at " << pos << " is a delta, but there is no base to add it to";
+      }
+      for (size_t j = 0; j < seg.num; j++) {
+        out[j] = out[j] + base[offset + j];
+      }
+    }
+    if (lens != nullptr) {
+      lens[i] = static_cast<int>(seg.num);
+    }
+    offset += seg.num;
+    pos += seg.encoded_size;
+  }
+}
+}  // namespace ps
+}  // namespace mindspore
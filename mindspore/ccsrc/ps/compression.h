@@ -0,0 +1,85 @@
+/**
+ * Copyright 2021 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MINDSPORE_CCSRC_PS_COMPRESSION_H_
+#define MINDSPORE_CCSRC_PS_COMPRESSION_H_
+
+#include <cstdint>
+#include <string>
+#include "ps/ps_context.h"
+
+namespace mindspore {
+namespace ps {
+// Codecs of the values sent between the workers and the servers. fp16 and bf16 cast the values to 16 bits, topk
+// sends the largest values of a gradient only and keeps the rest in a residual which is added to the next one.
+enum CompressCodec : uint32_t { kCodecNone = 0, kCodecFp16 = 1, kCodecBf16 = 2, kCodecTopK = 3 };
+
+// Segments shorter than this, such as the learning rate pushed with a gradient, are not compressed.
+constexpr size_t kMinCompressSize = 1024;
+
+CompressCodec StringToCodec(const std::string &compression);
+
+// codec without topk, which sparsifies the dense gradients only. The weights pulled and the rows of the embedding
+// tables, in the sparse gradients and the lookups, are cast to 16 bits with fp16 and bf16 and sent whole with topk.
+CompressCodec CastCodec(CompressCodec codec);
+
+void FloatToHalf(const float *src, size_t num, uint16_t *dst);
+void HalfToFloat(const uint16_t *src, size_t num, float *dst);
+void FloatToBf16(const float *src, size_t num, uint16_t *dst);
+void Bf16ToFloat(const uint16_t *src, size_t num, float *dst);
+
+// Add src to residual and move the k values of residual with the largest magnitude to indices and values, ordered
+// by index. What is not sent stays in residual.
+void TopKSparsify(const float *src, size_t num, size_t k, float *residual, uint32_t *indices, float *values);
+
+// Size of the len_num segments of the lengths in lens encoded with codec.
+size_t EncodedSize(CompressCodec codec, const int *lens, size_t len_num, float topk_ratio);
+// Same with the codec of every segment in codecs.
+size_t EncodedSize(const CompressCodec *codecs, const int *lens, size_t len_num, float topk_ratio);
+
+// Encode the segments of src described by lens with codec into encoded, which has EncodedSize of them, and write
+// the encoded lengths to encoded_lens. Every encoded segment starts with a header of its codec and its original
+// length, so it decodes without lens. residual is the error feedback of topk, it has the size of src.
+void EncodeValues(CompressCodec codec, const float *src, const int *lens, size_t len_num, float topk_ratio,
+                  float *residual, float *encoded, int *encoded_lens);
+// Same with the codec of every segment in codecs, such as a sparse gradient whose indices are sent exactly.
+void EncodeValues(const CompressCodec *codecs, const float *src, const int *lens, size_t len_num, float topk_ratio,
+                  float *residual, float *encoded, int *encoded_lens);
+
+// The pulls of the weights carry the id of the snapshot of the weights the worker holds, and the responses the id
+// of the one they decode to. The ids wrap around below this bound, so they stay exact in a float.
+constexpr uint32_t kMaxPullSnapshotId = 1 << 24;
+
+// Size of num values encoded with codec as their delta against a base.
+size_t DeltaEncodedSize(CompressCodec codec, size_t num);
+
+// Encode src - base with codec, fp16, bf16 or none, into encoded, which has DeltaEncodedSize values, and add the
+// decoded delta to base. base stays what the receiver decodes, so the rounding of a delta is sent with the next one
+// instead of adding up, and the deltas of weights moving slowly keep more precision than the weights in 16 bits.
+void EncodeDelta(CompressCodec codec, const float *src, size_t num, float *base, float *encoded);
+
+// Size of the values decoded from the size encoded ones, segment_num gets the number of their segments. Raises an
+// exception when a segment does not fit in the encoded values.
+size_t DecodedSize(const float *encoded, size_t size, size_t *segment_num);
+
+// Decode the segments of encoded into dst, which has dst_size values, and write the original lengths to lens when
+// it is not nullptr. The segments encoded as deltas are added to base, which has the size of dst and the values
+// the receiver decoded last time. Raises an exception when a segment does not fit in encoded or in dst.
+void DecodeValues(const float *encoded, size_t size, float *dst, size_t dst_size, int *lens = nullptr,
+                  const float *base = nullptr);
+}  // namespace ps
+}  // namespace mindspore
+#endif  // MINDSPORE_CCSRC_PS_COMPRESSION_H_
@@ -137,10 +137,10 @@ bool Node::Send(const NodeRole &node_role, const std::vector<uint32_t> &rank_ids
 
     CommMessage comm_message;
     *comm_message.mutable_pb_meta() = {message_meta};
-    comm_message.set_data(data.at(it));
 
+    // the data is sent as a raw segment after the message instead of being copied into it
     auto client = GetOrCreateTcpClient(rank_ids.at(it));
-    client->SendMessage(comm_message);
+    client->SendMessage(comm_message, {{data.at(it).data(), data.at(it).size()}});
   }
   return Wait(request_id, timeout);
 }
@@ -167,9 +167,8 @@ bool Node::Send(const enum NodeRole &node_role, const uint32_t &rank_id, const s
 
   CommMessage comm_message;
   *comm_message.mutable_pb_meta() = {message_meta};
-  comm_message.set_data(message);
   auto client = GetOrCreateTcpClient(rank_id);
-  client->SendMessage(comm_message);
+  client->SendMessage(comm_message, {{message.data(), message.size()}});
   return Wait(request_id, timeout);
 }
 
@@ -205,10 +204,10 @@ bool Node::Send(const NodeRole &node_role, const std::vector<uint32_t> &rank_ids
 
     CommMessage comm_message;
     *comm_message.mutable_pb_meta() = {message_meta};
-    comm_message.set_data(data.at(it));
 
+    // the data is sent as a raw segment after the message instead of being copied into it
     auto client = GetOrCreateTcpClient(rank_ids.at(it));
-    client->SendMessage(comm_message);
+    client->SendMessage(comm_message, {{data.at(it).data(), data.at(it).size()}});
   }
   return Wait(request_id, timeout);
 }
@@ -298,24 +297,38 @@ const std::shared_ptr<TcpClient> &Node::GetOrCreateTcpClient(const int &rank_id)
       }
       NotifyMessageArrival(message);
     });
+    client->SetSegmentAllocator([this](const CommMessage &message, size_t, size_t len) -> void * {
+      return AllocateSendDataSegment(message, len);
+    });
     client->Init();
     connected_nodes_[rank_id] = client;
     return connected_nodes_[rank_id];
   }
 }
 
+void *Node::AllocateSendDataSegment(const CommMessage &message, size_t len) {
+  const MessageMeta &message_meta = message.pb_meta();
+  if (message_meta.cmd() != NodeCommand::SEND_DATA) {
+    return nullptr;
+  }
+  // The segments are received one after another, so the data may grow once the previous segment is written.
+  std::lock_guard<std::mutex> lock(receive_messages_mutex_);
+  std::string *data = receive_messages_[message_meta.request_id()][message_meta.rank_id()].mutable_data();
+  size_t offset = data->size();
+  data->resize(offset + len);
+  return &(*data)[offset];
+}
+
 void Node::ProcessSendDataResp(const CommMessage &message) {
   std::lock_guard<std::mutex> lock(receive_messages_mutex_);
   const MessageMeta &message_meta = message.pb_meta();
   const uint32_t &rank_id = message_meta.rank_id();
   const uint64_t request_id = message_meta.request_id();
-  auto it = receive_messages_.find(request_id);
-  if (it != receive_messages_.end()) {
-    it->second.insert(std::make_pair(rank_id, message));
-  } else {
-    std::unordered_map<uint32_t, CommMessage> res;
-    res.insert(std::make_pair(rank_id, message));
-    receive_messages_[request_id] = res;
+  // the segments are already in the data of the response, only the meta and the data in the message are added
+  CommMessage &response = receive_messages_[request_id][rank_id];
+  *response.mutable_pb_meta() = message_meta;
+  if (!message.data().empty()) {
+    response.mutable_data()->insert(0, message.data());
   }
 
   RunMessageCallback(request_id);
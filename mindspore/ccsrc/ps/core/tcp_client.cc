@@ -89,9 +89,10 @@ void TcpClient::Init() {
   sin.sin_addr.s_addr = inet_addr(server_address_.c_str());
   sin.sin_port = htons(server_port_);
 
-  buffer_event_ = bufferevent_socket_new(event_base_, -1, BEV_OPT_CLOSE_ON_FREE);
+  buffer_event_ = bufferevent_socket_new(event_base_, -1, BEV_OPT_CLOSE_ON_FREE | BEV_OPT_THREADSAFE);
   MS_EXCEPTION_IF_NULL(buffer_event_);
 
+  message_writer_.Init(buffer_event_);
   bufferevent_setcb(buffer_event_, ReadCallback, nullptr, EventCallback, this);
   if (bufferevent_enable(buffer_event_, EV_READ | EV_WRITE) == -1) {
     MS_LOG(EXCEPTION) << "Buffer event enable read and write failed!";
@@ -125,6 +126,7 @@ void TcpClient::Stop() {
   std::lock_guard<std::mutex> lock(connection_mutex_);
   MS_LOG(INFO) << "Stop tcp client event buffer!";
   if (!is_stop_.load()) {
+    message_writer_.Reset();
     if (buffer_event_) {
       bufferevent_free(buffer_event_);
       buffer_event_ = nullptr;
@@ -171,6 +173,11 @@ void TcpClient::ReadCallback(struct bufferevent *bev, void *ctx) {
   struct evbuffer *input = bufferevent_get_input(const_cast<struct bufferevent *>(bev));
   MS_EXCEPTION_IF_NULL(input);
 
+  if (!tcp_client->read_callback_) {
+    tcp_client->message_handler_.ReceiveMessage(input);
+    return;
+  }
+
   char read_buffer[4096];
 
   while (EVBUFFER_LENGTH(input) > 0) {
@@ -247,17 +254,18 @@ void TcpClient::StartWithNoBlock() {
 
 void TcpClient::SetMessageCallback(const OnMessage &cb) { message_callback_ = cb; }
 
+void TcpClient::SetSegmentAllocator(const segmentAllocate &allocator) {
+  message_handler_.SetSegmentAllocator(allocator);
+}
+
 void TcpClient::SendMessage(const CommMessage &message) const {
   MS_EXCEPTION_IF_NULL(buffer_event_);
-  size_t buf_size = message.ByteSizeLong();
-  std::vector<unsigned char> serialized(buf_size);
-  message.SerializeToArray(serialized.data(), static_cast<int>(buf_size));
-  if (evbuffer_add(bufferevent_get_output(buffer_event_), &buf_size, sizeof(buf_size)) == -1) {
-    MS_LOG(EXCEPTION) << "Event buffer add header failed!";
-  }
-  if (evbuffer_add(bufferevent_get_output(buffer_event_), serialized.data(), buf_size) == -1) {
-    MS_LOG(EXCEPTION) << "Event buffer add protobuf data failed!";
-  }
+  message_writer_.SendMessage(message);
+}
+
+void TcpClient::SendMessage(const CommMessage &message, const std::vector<MessageSegment> &segments) const {
+  MS_EXCEPTION_IF_NULL(buffer_event_);
+  message_writer_.SendMessage(message, segments);
 }
 
 void TcpClient::StartTimer(const uint32_t &time) {
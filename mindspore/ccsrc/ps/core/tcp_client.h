@@ -61,7 +61,10 @@ class TcpClient {
   void Start();
   void StartWithNoBlock();
   void SetMessageCallback(const OnMessage &cb);
+  void SetSegmentAllocator(const segmentAllocate &allocator);
   void SendMessage(const CommMessage &message) const;
+  // Send message followed by the raw segments, the receiver gets the segments in the buffers of its segment allocator.
+  void SendMessage(const CommMessage &message, const std::vector<MessageSegment> &segments) const;
   void StartTimer(const uint32_t &time);
   void set_timer_callback(const OnTimer &timer);
   const event_base &eventbase();
@@ -77,6 +80,7 @@ class TcpClient {
  private:
   OnMessage message_callback_;
   TcpMessageHandler message_handler_;
+  mutable TcpMessageWriter message_writer_;
 
   OnConnected connected_callback_;
   OnDisconnected disconnected_callback_;
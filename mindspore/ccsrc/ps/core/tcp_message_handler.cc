@@ -17,57 +17,310 @@
 #include "ps/core/tcp_message_handler.h"
 
 #include <arpa/inet.h>
+#include <algorithm>
 #include <iostream>
 #include <utility>
 
 namespace mindspore {
 namespace ps {
 namespace core {
+namespace {
+// The receive buffers larger than this are released after the message instead of being reused.
+constexpr size_t kMaxRetainedBufferSize = 1 << 20;
+
+// Reads the bytes received in an array.
+class ArrayReader {
+ public:
+  ArrayReader(const unsigned char *data, size_t num) : data_(data), num_(num) {}
+  size_t size() const { return num_; }
+  const unsigned char *Peek(size_t len) const { return len <= num_ ? data_ : nullptr; }
+  void Read(void *dst, size_t len) {
+    int ret = memcpy_s(dst, len, data_, len);
+    if (ret != 0) {
+      MS_LOG(EXCEPTION) << "The memcpy_s error, errorno(" << ret << ")";
+    }
+    Skip(len);
+  }
+  void Skip(size_t len) {
+    data_ += len;
+    num_ -= len;
+  }
+
+ private:
+  const unsigned char *data_;
+  size_t num_;
+};
+
+class BuffereventLockGuard {
+ public:
+  explicit BuffereventLockGuard(struct bufferevent *bev) : bev_(bev) { bufferevent_lock(bev_); }
+  ~BuffereventLockGuard() { bufferevent_unlock(bev_); }
+
+ private:
+  struct bufferevent *bev_;
+};
+}  // namespace
+
 void TcpMessageHandler::SetCallback(const messageReceive &message_receive) { message_callback_ = message_receive; }
 
+void TcpMessageHandler::SetSegmentAllocator(const segmentAllocate &allocator) { segment_allocator_ = allocator; }
+
 void TcpMessageHandler::ReceiveMessage(const void *buffer, size_t num) {
   MS_EXCEPTION_IF_NULL(buffer);
-  auto buffer_data = reinterpret_cast<const unsigned char *>(buffer);
-
-  while (num > 0) {
-    if (remaining_length_ == 0) {
-      for (int i = 0; i < kHeaderLen && num > 0; ++i) {
-        header_[++header_index_] = *(buffer_data + i);
-        --num;
-        if (header_index_ == kHeaderLen - 1) {
-          message_length_ = *reinterpret_cast<const size_t *>(header_);
-          remaining_length_ = message_length_;
-          message_buffer_.reset(new unsigned char[remaining_length_]);
-          buffer_data += (i + 1);
-          break;
-        }
-      }
+  ArrayReader reader(reinterpret_cast<const unsigned char *>(buffer), num);
+  Receive(&reader);
+}
+
+void TcpMessageHandler::ReceiveMessage(struct evbuffer *input) {
+  MS_EXCEPTION_IF_NULL(input);
+  // Every chain of input is parsed where it is and drained at once, the frames are not removed one by one.
+  while (evbuffer_get_length(input) > 0) {
+    struct evbuffer_iovec vec {};
+    if (evbuffer_peek(input, -1, nullptr, &vec, 1) < 1 || vec.iov_len == 0) {
+      MS_LOG(EXCEPTION) << "Can not peek data from the event buffer!";
+    }
+    ArrayReader reader(reinterpret_cast<const unsigned char *>(vec.iov_base), vec.iov_len);
+    Receive(&reader);
+    if (evbuffer_drain(input, vec.iov_len) == -1) {
+      MS_LOG(EXCEPTION) << "Can not drain data from the event buffer!";
     }
+  }
+}
 
-    if (remaining_length_ > 0 && num > 0) {
-      size_t copy_len = remaining_length_ <= num ? remaining_length_ : num;
-      remaining_length_ -= copy_len;
-      num -= copy_len;
+template <typename Reader>
+void TcpMessageHandler::Receive(Reader *reader) {
+  while (true) {
+    if (state_ == ReceiveState::kHeader && !ReceiveHeader(reader)) {
+      return;
+    }
+    if (state_ == ReceiveState::kProtobuf && !ReceiveProtobuf(reader)) {
+      return;
+    }
+    if (state_ == ReceiveState::kSegments && !ReceiveSegments(reader)) {
+      return;
+    }
+  }
+}
 
-      int ret = memcpy_s(message_buffer_.get() + last_copy_len_, copy_len, buffer_data, copy_len);
+template <typename Reader>
+bool TcpMessageHandler::ReceiveHeader(Reader *reader) {
+  size_t copy_len = std::min(static_cast<size_t>(kHeaderLen - header_index_ - 1), reader->size());
+  if (copy_len == 0) {
+    return false;
+  }
+  reader->Read(header_ + header_index_ + 1, copy_len);
+  header_index_ += static_cast<int>(copy_len);
+  if (header_index_ < kHeaderLen - 1) {
+    return false;
+  }
+  message_length_ = *reinterpret_cast<const size_t *>(header_);
+  remaining_length_ = message_length_;
+  last_copy_len_ = 0;
+  state_ = ReceiveState::kProtobuf;
+  return true;
+}
+
+template <typename Reader>
+bool TcpMessageHandler::ReceiveProtobuf(Reader *reader) {
+  if (last_copy_len_ == 0) {
+    // the whole protobuf is received, parse it where it is
+    const unsigned char *data = message_length_ == 0 ? nullptr : reader->Peek(message_length_);
+    if (data != nullptr || message_length_ == 0) {
+      ParseMessage(data);
+      reader->Skip(message_length_);
+      return true;
+    }
+  }
+
+  if (message_buffer_.size() < message_length_) {
+    message_buffer_.resize(message_length_);
+  }
+  size_t copy_len = std::min(remaining_length_, reader->size());
+  if (copy_len > 0) {
+    reader->Read(message_buffer_.data() + last_copy_len_, copy_len);
+    last_copy_len_ += copy_len;
+    remaining_length_ -= copy_len;
+  }
+  if (remaining_length_ > 0) {
+    return false;
+  }
+  ParseMessage(message_buffer_.data());
+  if (message_buffer_.size() > kMaxRetainedBufferSize) {
+    std::vector<unsigned char>().swap(message_buffer_);
+  }
+  return true;
+}
+
+template <typename Reader>
+bool TcpMessageHandler::ReceiveSegments(Reader *reader) {
+  while (segment_index_ < static_cast<size_t>(message_.segment_lens_size())) {
+    size_t copy_len = std::min(remaining_length_, reader->size());
+    if (copy_len > 0) {
+      reader->Read(segment_buffer_ + last_copy_len_, copy_len);
       last_copy_len_ += copy_len;
-      buffer_data += copy_len;
-      if (ret != 0) {
-        MS_LOG(EXCEPTION) << "The memcpy_s error, errorno(" << ret << ")";
-      }
-
-      if (remaining_length_ == 0) {
-        CommMessage pb_message;
-        pb_message.ParseFromArray(message_buffer_.get(), message_length_);
-        if (message_callback_) {
-          message_callback_(pb_message);
-        }
-        message_buffer_.reset();
-        message_buffer_ = nullptr;
-        header_index_ = -1;
-        last_copy_len_ = 0;
-      }
+      remaining_length_ -= copy_len;
+    }
+    if (remaining_length_ > 0) {
+      return false;
+    }
+    ++segment_index_;
+    StartSegment();
+  }
+  FinishMessage();
+  return true;
+}
+
+void TcpMessageHandler::ParseMessage(const unsigned char *data) {
+  message_.Clear();
+  if (message_length_ > 0 && !message_.ParseFromArray(data, static_cast<int>(message_length_))) {
+    MS_LOG(EXCEPTION) << "Parse the message of " << message_length_ << " bytes failed!";
+  }
+  segment_index_ = 0;
+  state_ = ReceiveState::kSegments;
+  StartSegment();
+}
+
+void TcpMessageHandler::StartSegment() {
+  if (segment_index_ >= static_cast<size_t>(message_.segment_lens_size())) {
+    return;
+  }
+  size_t len = message_.segment_lens(static_cast<int>(segment_index_));
+  remaining_length_ = len;
+  last_copy_len_ = 0;
+  segment_buffer_ = nullptr;
+  if (segment_allocator_) {
+    segment_buffer_ = reinterpret_cast<unsigned char *>(segment_allocator_(message_, segment_index_, len));
+  }
+  if (segment_buffer_ == nullptr) {
+    std::string *data = message_.mutable_data();
+    size_t offset = data->size();
+    data->resize(offset + len);
+    segment_buffer_ = reinterpret_cast<unsigned char *>(&(*data)[0]) + offset;
+  }
+}
+
+void TcpMessageHandler::FinishMessage() {
+  if (message_callback_) {
+    message_callback_(message_);
+  }
+  if (message_.data().capacity() > kMaxRetainedBufferSize) {
+    CommMessage().Swap(&message_);
+  }
+  state_ = ReceiveState::kHeader;
+  header_index_ = -1;
+  last_copy_len_ = 0;
+  segment_buffer_ = nullptr;
+}
+
+TcpMessageWriter::~TcpMessageWriter() { Reset(); }
+
+void TcpMessageWriter::Init(struct bufferevent *bev) {
+  MS_EXCEPTION_IF_NULL(bev);
+  Reset();
+  pending_ = evbuffer_new();
+  MS_EXCEPTION_IF_NULL(pending_);
+  flush_event_ = event_new(bufferevent_get_base(bev), -1, 0, FlushCallback, this);
+  MS_EXCEPTION_IF_NULL(flush_event_);
+  buffer_event_ = bev;
+  is_flush_scheduled_ = false;
+}
+
+void TcpMessageWriter::Reset() {
+  // Freeing the event waits for a running flush callback, which takes the lock, so it is freed without the lock.
+  if (flush_event_ != nullptr) {
+    event_free(flush_event_);
+    flush_event_ = nullptr;
+  }
+  if (pending_ != nullptr) {
+    evbuffer_free(pending_);
+    pending_ = nullptr;
+  }
+  buffer_event_ = nullptr;
+  is_flush_scheduled_ = false;
+}
+
+void TcpMessageWriter::SendMessage(const CommMessage &message, const std::vector<MessageSegment> &segments) {
+  if (message.segment_lens_size() > 0) {
+    MS_LOG(EXCEPTION) << "The segment lens of the message are set by the writer!";
+  }
+  // The serialized protobufs are merged when parsed, so the lens are serialized after the message instead of copying
+  // the message to set them.
+  CommMessage lens_message;
+  size_t frame_size = kHeaderLen + message.ByteSizeLong();
+  for (const auto &segment : segments) {
+    lens_message.add_segment_lens(segment.len);
+    frame_size += segment.len;
+  }
+  frame_size += lens_message.ByteSizeLong();
+
+  if (buffer_event_ == nullptr) {
+    MS_LOG(EXCEPTION) << "The message writer is not initialized!";
+  }
+  BuffereventLockGuard lock(buffer_event_);
+  if (frame_size < kCoalesceFrameSize) {
+    AddFrame(pending_, message, lens_message, segments);
+    if (evbuffer_get_length(pending_) >= kCoalesceFlushSize) {
+      FlushLocked();
+    } else if (!is_flush_scheduled_) {
+      is_flush_scheduled_ = true;
+      event_active(flush_event_, EV_TIMEOUT, 0);
     }
+    return;
+  }
+  FlushLocked();
+  AddFrame(bufferevent_get_output(buffer_event_), message, lens_message, segments);
+}
+
+void TcpMessageWriter::Flush() {
+  if (buffer_event_ == nullptr) {
+    return;
+  }
+  BuffereventLockGuard lock(buffer_event_);
+  FlushLocked();
+}
+
+void TcpMessageWriter::FlushCallback(evutil_socket_t, int16_t, void *arg) {
+  MS_EXCEPTION_IF_NULL(arg);
+  auto writer = reinterpret_cast<TcpMessageWriter *>(arg);
+  BuffereventLockGuard lock(writer->buffer_event_);
+  writer->is_flush_scheduled_ = false;
+  writer->FlushLocked();
+}
+
+void TcpMessageWriter::AddFrame(struct evbuffer *output, const CommMessage &message, const CommMessage &lens_message,
+                                const std::vector<MessageSegment> &segments) {
+  MS_EXCEPTION_IF_NULL(output);
+  size_t message_size = message.ByteSizeLong();
+  size_t buf_size = message_size + lens_message.ByteSizeLong();
+  // the header and the protobufs are serialized straight into the space of the event buffer
+  struct evbuffer_iovec vec {};
+  if (evbuffer_reserve_space(output, kHeaderLen + buf_size, &vec, 1) != 1) {
+    MS_LOG(EXCEPTION) << "Event buffer reserve " << kHeaderLen + buf_size << " bytes failed!";
+  }
+  auto data = reinterpret_cast<unsigned char *>(vec.iov_base);
+  int ret = memcpy_s(data, kHeaderLen, &buf_size, sizeof(buf_size));
+  if (ret != 0) {
+    MS_LOG(EXCEPTION) << "The memcpy_s error, errorno(" << ret << ")";
+  }
+  message.SerializeWithCachedSizesToArray(data + kHeaderLen);
+  lens_message.SerializeWithCachedSizesToArray(data + kHeaderLen + message_size);
+  vec.iov_len = kHeaderLen + buf_size;
+  if (evbuffer_commit_space(output, &vec, 1) == -1) {
+    MS_LOG(EXCEPTION) << "Event buffer add protobuf data failed!";
+  }
+  for (const auto &segment : segments) {
+    if (segment.len > 0 && evbuffer_add(output, segment.data, segment.len) == -1) {
+      MS_LOG(EXCEPTION) << "Event buffer add segment data failed!";
+    }
+  }
+}
+
+void TcpMessageWriter::FlushLocked() {
+  if (pending_ == nullptr || evbuffer_get_length(pending_) == 0) {
+    return;
+  }
+  if (evbuffer_add_buffer(bufferevent_get_output(buffer_event_), pending_) == -1) {
+    MS_LOG(EXCEPTION) << "Event buffer add the coalesced messages failed!";
   }
 }
 }  // namespace core
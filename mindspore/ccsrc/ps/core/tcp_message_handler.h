@@ -17,6 +17,10 @@
 #ifndef MINDSPORE_CCSRC_PS_CORE_TCP_MESSAGE_HANDLER_H_
 #define MINDSPORE_CCSRC_PS_CORE_TCP_MESSAGE_HANDLER_H_
 
+#include <event2/buffer.h>
+#include <event2/bufferevent.h>
+#include <event2/event.h>
+
 #include <functional>
 #include <iostream>
 #include <string>
@@ -31,31 +35,98 @@ namespace mindspore {
 namespace ps {
 namespace core {
 using messageReceive = std::function<void(const CommMessage &message)>;
+// Returns the buffer which receives the index-th raw segment of message, or nullptr to append the segment to the
+// data of message.
+using segmentAllocate = std::function<void *(const CommMessage &message, size_t index, size_t len)>;
 constexpr int kHeaderLen = 8;
+enum class ReceiveState { kHeader, kProtobuf, kSegments };
+// The frames smaller than this are coalesced with the other small frames of the connection.
+constexpr size_t kCoalesceFrameSize = 4096;
+// The coalesced frames are written at once when they reach this size, instead of waiting for the event loop.
+constexpr size_t kCoalesceFlushSize = 65536;
+
+// A raw payload sent after the protobuf of a message.
+struct MessageSegment {
+  const void *data;
+  size_t len;
+};
 
+// A frame is the 8 bytes length of the protobuf, the protobuf of CommMessage and the raw segments whose lengths are
+// in segment_lens of the protobuf.
 class TcpMessageHandler {
  public:
   TcpMessageHandler()
       : is_parsed_(false),
-        message_buffer_(nullptr),
+        state_(ReceiveState::kHeader),
         message_length_(0),
         remaining_length_(0),
         header_index_(-1),
-        last_copy_len_(0) {}
+        last_copy_len_(0),
+        segment_index_(0),
+        segment_buffer_(nullptr) {}
   virtual ~TcpMessageHandler() = default;
 
   void SetCallback(const messageReceive &cb);
+  void SetSegmentAllocator(const segmentAllocate &allocator);
   void ReceiveMessage(const void *buffer, size_t num);
+  // Drain the frames from input, the protobufs are parsed in place when they are contiguous in input and the raw
+  // segments are copied from input straight into the buffers of the segment allocator.
+  void ReceiveMessage(struct evbuffer *input);
 
  private:
+  template <typename Reader>
+  void Receive(Reader *reader);
+  template <typename Reader>
+  bool ReceiveHeader(Reader *reader);
+  template <typename Reader>
+  bool ReceiveProtobuf(Reader *reader);
+  template <typename Reader>
+  bool ReceiveSegments(Reader *reader);
+  void ParseMessage(const unsigned char *data);
+  void StartSegment();
+  void FinishMessage();
+
   messageReceive message_callback_;
+  segmentAllocate segment_allocator_;
   bool is_parsed_;
-  std::unique_ptr<unsigned char> message_buffer_;
+  ReceiveState state_;
+  std::vector<unsigned char> message_buffer_;
   size_t message_length_;
   size_t remaining_length_;
   char header_[8];
   int header_index_;
   size_t last_copy_len_;
+  CommMessage message_;
+  size_t segment_index_;
+  // the buffer of the current segment, nullptr when the segment is appended to the data of message_
+  unsigned char *segment_buffer_;
+};
+
+// Writes the frames of the messages to the output of a buffer event. The frames of the small messages are coalesced
+// and moved to the output together on the next pass of the event loop, so a burst of control messages wakes up the
+// loop and reaches the socket once. A large frame flushes the coalesced frames first to keep the order. The writer is
+// guarded by the lock of the buffer event, so the messages sent from the callbacks of the buffer event do not deadlock.
+class TcpMessageWriter {
+ public:
+  TcpMessageWriter() : buffer_event_(nullptr), flush_event_(nullptr), pending_(nullptr), is_flush_scheduled_(false) {}
+  virtual ~TcpMessageWriter();
+
+  void Init(struct bufferevent *bev);
+  // Drop the coalesced frames before the buffer event is freed, it is not called together with SendMessage.
+  void Reset();
+  void SendMessage(const CommMessage &message, const std::vector<MessageSegment> &segments = {});
+  void Flush();
+
+ private:
+  static void FlushCallback(evutil_socket_t fd, int16_t event, void *arg);
+  static void AddFrame(struct evbuffer *output, const CommMessage &message, const CommMessage &lens_message,
+                       const std::vector<MessageSegment> &segments);
+  void FlushLocked();
+
+  struct bufferevent *buffer_event_;
+  struct event *flush_event_;
+  struct evbuffer *pending_;
+  bool is_flush_scheduled_;
 };
 }  // namespace core
 }  // namespace ps
@@ -39,11 +39,20 @@ void TcpConnection::InitConnection() {
       on_server_receive(*server_, *this, message);
     }
   });
+  tcp_message_handler_.SetSegmentAllocator([&](const CommMessage &message, size_t index, size_t len) -> void * {
+    OnServerAllocateSegment allocate_segment = server_->GetSegmentAllocator();
+    return allocate_segment ? allocate_segment(*this, message, index, len) : nullptr;
+  });
+  tcp_message_writer_.Init(buffer_event_);
 }
 
 void TcpConnection::OnReadHandler(const void *buffer, size_t num) { tcp_message_handler_.ReceiveMessage(buffer, num); }
 
+void TcpConnection::OnReadHandler(struct evbuffer *input) { tcp_message_handler_.ReceiveMessage(input); }
+
 void TcpConnection::SendMessage(const void *buffer, size_t num) const {
+  // the coalesced messages go first to keep the order
+  tcp_message_writer_.Flush();
   if (bufferevent_write(buffer_event_, buffer, num) == -1) {
     MS_LOG(ERROR) << "Write message to buffer event failed!";
   }
@@ -55,17 +64,12 @@ const evutil_socket_t &TcpConnection::GetFd() const { return fd_; }
 
 void TcpConnection::SendMessage(const CommMessage &message) const {
   MS_EXCEPTION_IF_NULL(buffer_event_);
-  size_t buf_size = message.ByteSizeLong();
-  std::vector<unsigned char> serialized(buf_size);
-  message.SerializeToArray(serialized.data(), static_cast<int>(buf_size));
-  if (evbuffer_add(bufferevent_get_output(const_cast<struct bufferevent *>(buffer_event_)), &buf_size,
-                   sizeof(buf_size)) == -1) {
-    MS_LOG(EXCEPTION) << "Event buffer add header failed!";
-  }
-  if (evbuffer_add(bufferevent_get_output(const_cast<struct bufferevent *>(buffer_event_)), serialized.data(),
-                   buf_size) == -1) {
-    MS_LOG(EXCEPTION) << "Event buffer add protobuf data failed!";
-  }
+  tcp_message_writer_.SendMessage(message);
+}
+
+void TcpConnection::SendMessage(const CommMessage &message, const std::vector<MessageSegment> &segments) const {
+  MS_EXCEPTION_IF_NULL(buffer_event_);
+  tcp_message_writer_.SendMessage(message, segments);
 }
 
 TcpServer::TcpServer(const std::string &address, std::uint16_t port)
@@ -193,6 +197,8 @@ void TcpServer::Stop() {
     if (ret != 0) {
       MS_LOG(EXCEPTION) << "event base loop break failed!";
     }
+    // Start holds the mutex while the event loop runs, wait for the loop to return before freeing the event base.
+    std::unique_lock<std::recursive_mutex> lock(connection_mutex_);
     if (signal_event_ != nullptr) {
       event_free(signal_event_);
       signal_event_ = nullptr;
@@ -227,9 +233,11 @@ void TcpServer::AddConnection(const evutil_socket_t &fd, const TcpConnection *co
 
 void TcpServer::RemoveConnection(const evutil_socket_t &fd) {
   std::unique_lock<std::recursive_mutex> lock(connection_mutex_);
-  TcpConnection *connection = const_cast<TcpConnection *>(connections_.find(fd)->second);
+  // fd may refer to the fd of the connection, which is deleted
+  evutil_socket_t socket = fd;
+  TcpConnection *connection = const_cast<TcpConnection *>(connections_.find(socket)->second);
   delete connection;
-  connections_.erase(fd);
+  connections_.erase(socket);
 }
 
 void TcpServer::ListenerCallback(struct evconnlistener *, evutil_socket_t fd, struct sockaddr *sockaddr, int,
@@ -240,7 +248,7 @@ void TcpServer::ListenerCallback(struct evconnlistener *, evutil_socket_t fd, st
   MS_EXCEPTION_IF_NULL(base);
   MS_EXCEPTION_IF_NULL(sockaddr);
 
-  struct bufferevent *bev = bufferevent_socket_new(base, fd, BEV_OPT_CLOSE_ON_FREE);
+  struct bufferevent *bev = bufferevent_socket_new(base, fd, BEV_OPT_CLOSE_ON_FREE | BEV_OPT_THREADSAFE);
   if (!bev) {
     MS_LOG(ERROR) << "Error constructing buffer event!";
     int ret = event_base_loopbreak(base);
@@ -291,14 +299,8 @@ void TcpServer::ReadCallback(struct bufferevent *bev, void *connection) {
 
   auto conn = static_cast<class TcpConnection *>(connection);
   struct evbuffer *buf = bufferevent_get_input(bev);
-  char read_buffer[4096];
-  while (EVBUFFER_LENGTH(buf) > 0) {
-    int read = evbuffer_remove(buf, &read_buffer, sizeof(read_buffer));
-    if (read == -1) {
-      MS_LOG(EXCEPTION) << "Can not drain data from the event buffer!";
-    }
-    conn->OnReadHandler(read_buffer, static_cast<size_t>(read));
-  }
+  MS_EXCEPTION_IF_NULL(buf);
+  conn->OnReadHandler(buf);
 }
 
 void TcpServer::EventCallback(struct bufferevent *bev, std::int16_t events, void *data) {
@@ -351,6 +353,11 @@ void TcpServer::TimerOnceCallback(evutil_socket_t, int16_t, void *arg) {
 
 void TcpServer::SendMessage(const TcpConnection &conn, const CommMessage &message) { conn.SendMessage(message); }
 
+void TcpServer::SendMessage(const TcpConnection &conn, const CommMessage &message,
+                            const std::vector<MessageSegment> &segments) {
+  conn.SendMessage(message, segments);
+}
+
 void TcpServer::SendMessage(const CommMessage &message) {
   std::unique_lock<std::recursive_mutex> lock(connection_mutex_);
 
@@ -368,6 +375,10 @@ int TcpServer::ConnectionNum() const { return connections_.size(); }
 const std::map<evutil_socket_t, const TcpConnection *> &TcpServer::Connections() const { return connections_; }
 
 void TcpServer::SetMessageCallback(const OnServerReceiveMessage &cb) { message_callback_ = cb; }
+
+OnServerAllocateSegment TcpServer::GetSegmentAllocator() const { return segment_allocator_; }
+
+void TcpServer::SetSegmentAllocator(const OnServerAllocateSegment &allocator) { segment_allocator_ = allocator; }
 }  // namespace core
 }  // namespace ps
 }  // namespace mindspore
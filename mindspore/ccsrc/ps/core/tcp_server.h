@@ -53,7 +53,9 @@ class TcpConnection {
   virtual void InitConnection();
   virtual void SendMessage(const void *buffer, size_t num) const;
   void SendMessage(const CommMessage &message) const;
+  void SendMessage(const CommMessage &message, const std::vector<MessageSegment> &segments) const;
   virtual void OnReadHandler(const void *buffer, size_t numBytes);
+  virtual void OnReadHandler(struct evbuffer *input);
   TcpServer *GetServer() const;
   const evutil_socket_t &GetFd() const;
 
@@ -62,10 +64,13 @@ class TcpConnection {
   evutil_socket_t fd_;
   const TcpServer *server_;
   TcpMessageHandler tcp_message_handler_;
+  mutable TcpMessageWriter tcp_message_writer_;
 };
 
 using OnServerReceiveMessage =
   std::function<void(const TcpServer &tcp_server, const TcpConnection &conn, const CommMessage &)>;
+using OnServerAllocateSegment =
+  std::function<void *(const TcpConnection &conn, const CommMessage &message, size_t index, size_t len)>;
 
 class TcpServer {
  public:
@@ -93,7 +98,10 @@ class TcpServer {
   void RemoveConnection(const evutil_socket_t &fd);
   OnServerReceiveMessage GetServerReceive() const;
   void SetMessageCallback(const OnServerReceiveMessage &cb);
+  OnServerAllocateSegment GetSegmentAllocator() const;
+  void SetSegmentAllocator(const OnServerAllocateSegment &allocator);
   void SendMessage(const TcpConnection &conn, const CommMessage &message);
+  void SendMessage(const TcpConnection &conn, const CommMessage &message, const std::vector<MessageSegment> &segments);
   void SendMessage(const CommMessage &message);
   uint16_t BoundPort() const;
   std::string BoundIp() const;
@@ -123,6 +131,7 @@ class TcpServer {
   OnAccepted client_accept_;
   std::recursive_mutex connection_mutex_;
   OnServerReceiveMessage message_callback_;
+  OnServerAllocateSegment segment_allocator_;
   OnTimerOnce on_timer_once_callback_;
   OnTimer on_timer_callback_;
 };
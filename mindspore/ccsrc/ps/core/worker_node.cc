@@ -176,9 +176,8 @@ bool WorkerNode::BroadcastToServers(const std::string &message) {
 
     CommMessage comm_message;
     *comm_message.mutable_pb_meta() = {message_meta};
-    comm_message.set_data(message);
     auto client = GetOrCreateTcpClient((*it).first.second);
-    client->SendMessage(comm_message);
+    client->SendMessage(comm_message, {{message.data(), message.size()}});
   }
   return Wait(request_id);
 }
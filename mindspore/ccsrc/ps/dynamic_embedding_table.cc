@@ -0,0 +1,357 @@
+/**
+ * Copyright 2021 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "ps/dynamic_embedding_table.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include "utils/log_adapter.h"
+
+namespace mindspore {
+namespace ps {
+namespace {
+constexpr size_t kInitialRowNum = 1024;
+constexpr size_t kSketchWidth = 1 << 16;
+constexpr size_t kSketchDepth = 4;
+constexpr size_t kSketchAgingFactor = 10;
+// The least frequently used 1 / kLfuEvictDivisor of the rows are evicted at a time.
+constexpr size_t kLfuEvictDivisor = 8;
+// The frequencies of the rows are halved after kFreqAgingFactor touches per row.
+constexpr size_t kFreqAgingFactor = 10;
+
+inline uint64_t SplitMix64(uint64_t value) {
+  value += 0x9E3779B97F4A7C15ULL;
+  value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  value = (value ^ (value >> 27)) * 0x94D049BB133111EBULL;
+  return value ^ (value >> 31);
+}
+}  // namespace
+
+CountMinSketch::CountMinSketch(size_t width, size_t depth) : width_(1), depth_(depth), width_bits_(0) {
+  while (width_ < width) {
+    width_ <<= 1;
+    width_bits_++;
+  }
+  counters_.assign(width_ * depth_, 0);
+}
+
+size_t CountMinSketch::Index(int64_t id, size_t row) const {
+  uint64_t hash = SplitMix64(static_cast<uint64_t>(id) + row * kFibonacciMultiplier);
+  return row * width_ + static_cast<size_t>(width_bits_ == 0 ? 0 : hash >> (64 - width_bits_));
+}
+
+uint32_t CountMinSketch::Estimate(int64_t id) const {
+  uint32_t count = UINT32_MAX;
+  for (size_t row = 0; row < depth_; row++) {
+    count = std::min(count, counters_[Index(id, row)]);
+  }
+  return count;
+}
+
+uint32_t CountMinSketch::Add(int64_t id) {
+  // Conservative update, only the counters at the minimum are increased, which keeps the overestimation low.
+  uint32_t count = Estimate(id);
+  if (count < UINT32_MAX) {
+    count++;
+  }
+  for (size_t row = 0; row < depth_; row++) {
+    auto &counter = counters_[Index(id, row)];
+    counter = std::max(counter, count);
+  }
+  if (++additions_ >= kSketchAgingFactor * width_) {
+    for (auto &counter : counters_) {
+      counter >>= 1;
+    }
+    additions_ = 0;
+  }
+  return count;
+}
+
+DynamicEmbeddingTable::DynamicEmbeddingTable(size_t embedding_size, const DynamicEmbeddingConfig &config,
+                                             const DynamicEmbeddingInit &init)
+    : embedding_size_(embedding_size),
+      config_(config),
+      init_(init),
+      id_to_row_(0),
+      capacity_(0),
+      sketch_(nullptr) {
+  if (embedding_size_ == 0) {
+    MS_LOG(EXCEPTION) << "The embedding size of the dynamic embedding table should be positive.";
+  }
+  if (config_.admit_threshold > 1) {
+    sketch_ = std::make_unique<CountMinSketch>(kSketchWidth, kSketchDepth);
+  }
+  Grow();
+}
+
+bool DynamicEmbeddingTable::Admit(int64_t id) {
+  if (sketch_ == nullptr) {
+    return true;
+  }
+  return sketch_->Add(id) >= config_.admit_threshold;
+}
+
+void DynamicEmbeddingTable::Grow() {
+  size_t new_capacity = capacity_ == 0 ? kInitialRowNum : capacity_ * 2;
+  if (config_.max_rows > 0) {
+    new_capacity = std::min(new_capacity, config_.max_rows);
+  }
+  if (new_capacity <= capacity_) {
+    MS_LOG(EXCEPTION) << "The dynamic embedding table can't grow beyond " << capacity_ << " rows.";
+  }
+  values_.resize(new_capacity * embedding_size_);
+  row_ids_.resize(new_capacity, kEmptyId);
+  row_freqs_.resize(new_capacity, 0);
+  row_clocks_.resize(new_capacity, 0);
+  if (config_.ttl > 0) {
+    prev_rows_.resize(new_capacity, INVALID_INDEX_VALUE);
+    next_rows_.resize(new_capacity, INVALID_INDEX_VALUE);
+  }
+  for (size_t row = new_capacity; row > capacity_; row--) {
+    free_rows_.push_back(SizeToInt(row - 1));
+  }
+  IdIndexMap id_to_row(new_capacity);
+  id_to_row_.ForEach([&id_to_row](int64_t id, int row) { id_to_row.Insert(id, row); });
+  id_to_row_ = std::move(id_to_row);
+  capacity_ = new_capacity;
+}
+
+int DynamicEmbeddingTable::AllocRow(int64_t id) {
+  if (config_.max_rows > 0 && row_num() >= config_.max_rows) {
+    EvictLeastFrequent();
+  }
+  if (free_rows_.empty()) {
+    Grow();
+  }
+  int row = free_rows_.back();
+  free_rows_.pop_back();
+  row_ids_[row] = id;
+  row_freqs_[row] = 0;
+  row_clocks_[row] = clock_;
+  if (config_.ttl > 0) {
+    LinkNewest(row);
+  }
+  InitRow(id, values_.data() + IntToSize(row) * embedding_size_);
+  id_to_row_.Insert(id, row);
+  return row;
+}
+
+void DynamicEmbeddingTable::FreeRow(int row) {
+  if (config_.ttl > 0) {
+    Unlink(row);
+  }
+  id_to_row_.Erase(row_ids_[row]);
+  row_ids_[row] = kEmptyId;
+  free_rows_.push_back(row);
+}
+
+void DynamicEmbeddingTable::Touch(int row) {
+  if (row_freqs_[row] < UINT32_MAX) {
+    row_freqs_[row]++;
+  }
+  // a row touched in this lookup already is behind every older row, so the order holds without moving it
+  if (config_.ttl > 0 && row_clocks_[row] != clock_) {
+    Unlink(row);
+    LinkNewest(row);
+  }
+  row_clocks_[row] = clock_;
+  touches_++;
+}
+
+void DynamicEmbeddingTable::LinkNewest(int row) {
+  prev_rows_[row] = newest_row_;
+  next_rows_[row] = INVALID_INDEX_VALUE;
+  if (newest_row_ == INVALID_INDEX_VALUE) {
+    oldest_row_ = row;
+  } else {
+    next_rows_[newest_row_] = row;
+  }
+  newest_row_ = row;
+}
+
+void DynamicEmbeddingTable::Unlink(int row) {
+  int prev = prev_rows_[row];
+  int next = next_rows_[row];
+  if (prev == INVALID_INDEX_VALUE) {
+    oldest_row_ = next;
+  } else {
+    next_rows_[prev] = next;
+  }
+  if (next == INVALID_INDEX_VALUE) {
+    newest_row_ = prev;
+  } else {
+    prev_rows_[next] = prev;
+  }
+  prev_rows_[row] = INVALID_INDEX_VALUE;
+  next_rows_[row] = INVALID_INDEX_VALUE;
+}
+
+void DynamicEmbeddingTable::InitRow(int64_t id, float *row) const {
+  if (!init_.random_normal) {
+    std::fill(row, row + embedding_size_, init_.value);
+    return;
+  }
+  // Box-Muller on a random sequence seeded by the id, so a row is initialized the same after it is evicted.
+  constexpr double kTwoPi = 6.283185307179586;
+  constexpr double kTwoPow53 = 9007199254740992.0;
+  uint64_t state = SplitMix64(static_cast<uint64_t>(id) ^ SplitMix64(init_.seed));
+  for (size_t i = 0; i < embedding_size_; i += 2) {
+    state = SplitMix64(state);
+    double u1 = (static_cast<double>(state >> 11) + 1) / (kTwoPow53 + 1);
+    state = SplitMix64(state);
+    double u2 = static_cast<double>(state >> 11) / kTwoPow53;
+    double radius = std::sqrt(-2 * std::log(u1)) * init_.stddev;
+    row[i] = static_cast<float>(radius * std::cos(kTwoPi * u2));
+    if (i + 1 < embedding_size_) {
+      row[i + 1] = static_cast<float>(radius * std::sin(kTwoPi * u2));
+    }
+  }
+}
+
+void DynamicEmbeddingTable::Lookup(const size_t *ids, size_t ids_size, float *output) {
+  MS_EXCEPTION_IF_NULL(ids);
+  MS_EXCEPTION_IF_NULL(output);
+  auto start = std::chrono::steady_clock::now();
+  clock_++;
+  if (config_.ttl > 0) {
+    EvictExpired();
+  }
+  size_t copy_size = embedding_size_ * sizeof(float);
+  for (size_t i = 0; i < ids_size; i++) {
+    auto id = static_cast<int64_t>(ids[i]);
+    float *out = output + i * embedding_size_;
+    int row = id_to_row_.Find(id);
+    if (row != INVALID_INDEX_VALUE) {
+      metrics_.lookup_hits++;
+    } else if (config_.admit_threshold > 0 && Admit(id)) {
+      row = AllocRow(id);
+      metrics_.admitted_ids++;
+    } else {
+      InitRow(id, out);
+      metrics_.rejected_ids++;
+      continue;
+    }
+    Touch(row);
+    (void)memcpy(out, values_.data() + IntToSize(row) * embedding_size_, copy_size);
+  }
+  metrics_.lookup_ids += ids_size;
+  std::chrono::duration<double> cost = std::chrono::steady_clock::now() - start;
+  metrics_.lookup_seconds += cost.count();
+}
+
+void DynamicEmbeddingTable::Read(const size_t *ids, size_t ids_size, float *output) const {
+  MS_EXCEPTION_IF_NULL(ids);
+  MS_EXCEPTION_IF_NULL(output);
+  size_t copy_size = embedding_size_ * sizeof(float);
+  for (size_t i = 0; i < ids_size; i++) {
+    auto id = static_cast<int64_t>(ids[i]);
+    float *out = output + i * embedding_size_;
+    int row = id_to_row_.Find(id);
+    if (row == INVALID_INDEX_VALUE) {
+      InitRow(id, out);
+      continue;
+    }
+    (void)memcpy(out, values_.data() + IntToSize(row) * embedding_size_, copy_size);
+  }
+}
+
+void DynamicEmbeddingTable::Update(const size_t *ids, size_t ids_size, const float *values) {
+  MS_EXCEPTION_IF_NULL(ids);
+  MS_EXCEPTION_IF_NULL(values);
+  size_t copy_size = embedding_size_ * sizeof(float);
+  for (size_t i = 0; i < ids_size; i++) {
+    auto id = static_cast<int64_t>(ids[i]);
+    int row = id_to_row_.Find(id);
+    if (row == INVALID_INDEX_VALUE) {
+      row = AllocRow(id);
+      metrics_.admitted_ids++;
+    }
+    Touch(row);
+    (void)memcpy(values_.data() + IntToSize(row) * embedding_size_, values + i * embedding_size_, copy_size);
+  }
+}
+
+void DynamicEmbeddingTable::ToDense(size_t begin, size_t end, float *dense) const {
+  MS_EXCEPTION_IF_NULL(dense);
+  for (size_t id = begin; id < end; id++) {
+    InitRow(static_cast<int64_t>(id), dense + (id - begin) * embedding_size_);
+  }
+  size_t copy_size = embedding_size_ * sizeof(float);
+  size_t out_of_range_rows = 0;
+  id_to_row_.ForEach([&](int64_t id, int row) {
+    if (id < 0 || static_cast<size_t>(id) < begin || static_cast<size_t>(id) >= end) {
+      out_of_range_rows++;
+      return;
+    }
+    (void)memcpy(dense + (static_cast<size_t>(id) - begin) * embedding_size_,
+                 values_.data() + IntToSize(row) * embedding_size_, copy_size);
+  });
+  if (out_of_range_rows > 0) {
+    MS_LOG(WARNING) << out_of_range_rows << " rows of the dynamic embedding table are out of the dense range [" << begin
+                    << ", " << end << ").";
+  }
+}
+
+void DynamicEmbeddingTable::EvictExpired() {
+  // Only the expired rows are visited, they are at the oldest end of the clock order.
+  while (oldest_row_ != INVALID_INDEX_VALUE && clock_ - row_clocks_[oldest_row_] > config_.ttl) {
+    FreeRow(oldest_row_);
+    metrics_.ttl_evicted_rows++;
+  }
+}
+
+void DynamicEmbeddingTable::EvictLeastFrequent() {
+  std::vector<int> rows;
+  rows.reserve(row_num());
+  for (size_t row = 0; row < capacity_; row++) {
+    if (row_ids_[row] != kEmptyId) {
+      rows.push_back(SizeToInt(row));
+    }
+  }
+  size_t evict_num = std::max(rows.size() / kLfuEvictDivisor, static_cast<size_t>(1));
+  evict_num = std::min(evict_num, rows.size());
+  // the least frequent rows go first, and the least recently used among the equally frequent ones
+  (void)std::nth_element(rows.begin(), rows.begin() + evict_num, rows.end(), [this](int a, int b) {
+    return row_freqs_[a] != row_freqs_[b] ? row_freqs_[a] < row_freqs_[b] : row_clocks_[a] < row_clocks_[b];
+  });
+  for (size_t i = 0; i < evict_num; i++) {
+    FreeRow(rows[i]);
+  }
+  metrics_.lfu_evicted_rows += evict_num;
+  // age the frequencies, so the rows which were hot long ago are evicted in time
+  if (touches_ >= kFreqAgingFactor * rows.size()) {
+    for (size_t i = evict_num; i < rows.size(); i++) {
+      row_freqs_[rows[i]] >>= 1;
+    }
+    touches_ = 0;
+  }
+}
+
+DynamicEmbeddingMetrics DynamicEmbeddingTable::metrics() const {
+  DynamicEmbeddingMetrics metrics = metrics_;
+  metrics.row_num = row_num();
+  metrics.memory_bytes = values_.capacity() * sizeof(float) + row_ids_.capacity() * sizeof(int64_t) +
+                         row_freqs_.capacity() * sizeof(uint32_t) + row_clocks_.capacity() * sizeof(uint64_t) +
+                         (prev_rows_.capacity() + next_rows_.capacity()) * sizeof(int) +
+                         free_rows_.capacity() * sizeof(int) + id_to_row_.slot_num() * (sizeof(int64_t) + sizeof(int));
+  if (sketch_ != nullptr) {
+    metrics.memory_bytes += sketch_->memory_bytes();
+  }
+  return metrics;
+}
+}  // namespace ps
+}  // namespace mindspore
@@ -0,0 +1,141 @@
+/**
+ * Copyright 2021 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MINDSPORE_CCSRC_PS_DYNAMIC_EMBEDDING_TABLE_H_
+#define MINDSPORE_CCSRC_PS_DYNAMIC_EMBEDDING_TABLE_H_
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "ps/ps_cache/embedding_hash_map.h"
+
+namespace mindspore {
+namespace ps {
+// Counts the occurrences of ids in a fixed memory with overestimation only. The counters are halved after every
+// kSketchAgingFactor * width additions, so ids which stop occurring are forgotten.
+class CountMinSketch {
+ public:
+  CountMinSketch(size_t width, size_t depth);
+  ~CountMinSketch() = default;
+  // Count one occurrence of id and return the estimated count of it.
+  uint32_t Add(int64_t id);
+  uint32_t Estimate(int64_t id) const;
+  size_t memory_bytes() const { return counters_.size() * sizeof(uint32_t); }
+
+ private:
+  size_t Index(int64_t id, size_t row) const;
+  size_t width_;
+  size_t depth_;
+  size_t width_bits_;
+  std::vector<uint32_t> counters_;
+  size_t additions_{0};
+};
+
+struct DynamicEmbeddingConfig {
+  // An id gets a row after it is looked up admit_threshold times, 1 admits every id at once, 0 leaves the rows to the
+  // updates.
+  size_t admit_threshold{1};
+  // Rows not looked up or updated in the last ttl lookups of the table are evicted, 0 keeps them.
+  size_t ttl{0};
+  // The least frequently used rows are evicted when a new row exceeds max_rows, 0 does not limit the rows.
+  size_t max_rows{0};
+};
+
+// How the rows of a missing id are initialized, the same id always gets the same row.
+struct DynamicEmbeddingInit {
+  bool random_normal{true};
+  float stddev{0.01};
+  float value{0};
+  size_t seed{0};
+};
+
+// The lookups of the ids without rows read the initial rows and count as rejected.
+struct DynamicEmbeddingMetrics {
+  size_t row_num{0};
+  size_t memory_bytes{0};
+  uint64_t lookup_ids{0};
+  uint64_t lookup_hits{0};
+  uint64_t admitted_ids{0};
+  uint64_t rejected_ids{0};
+  uint64_t ttl_evicted_rows{0};
+  uint64_t lfu_evicted_rows{0};
+  double lookup_seconds{0};
+};
+
+// Embedding table of the parameter server for unbounded vocabularies. The rows are created for the ids as they are
+// admitted and the storage grows on demand, instead of holding a row for every id of the vocabulary. Ids which are
+// not admitted read their initial rows. An update creates the row of its id anyway, so the values the callers trained
+// are never dropped. It is not thread safe.
+class DynamicEmbeddingTable {
+ public:
+  DynamicEmbeddingTable(size_t embedding_size, const DynamicEmbeddingConfig &config,
+                        const DynamicEmbeddingInit &init);
+  ~DynamicEmbeddingTable() = default;
+
+  // Copy the rows of ids_size ids into output, which has ids_size * embedding_size values.
+  void Lookup(const size_t *ids, size_t ids_size, float *output);
+  // Same as Lookup, without counting, admitting or touching the ids.
+  void Read(const size_t *ids, size_t ids_size, float *output) const;
+  // Overwrite the rows of ids_size ids with values, the missing rows are created.
+  void Update(const size_t *ids, size_t ids_size, const float *values);
+  // Copy the row of every id in [begin, end) to dense[id - begin], the other rows of dense are initialized.
+  void ToDense(size_t begin, size_t end, float *dense) const;
+
+  size_t embedding_size() const { return embedding_size_; }
+  size_t row_num() const { return id_to_row_.size(); }
+  DynamicEmbeddingMetrics metrics() const;
+
+ private:
+  bool Admit(int64_t id);
+  int AllocRow(int64_t id);
+  void FreeRow(int row);
+  void Grow();
+  void Touch(int row);
+  // Move a row to the newest end of the clock order, or take it out of the order.
+  void LinkNewest(int row);
+  void Unlink(int row);
+  void EvictExpired();
+  void EvictLeastFrequent();
+  void InitRow(int64_t id, float *row) const;
+
+  size_t embedding_size_;
+  DynamicEmbeddingConfig config_;
+  DynamicEmbeddingInit init_;
+  IdIndexMap id_to_row_;
+  std::vector<float> values_;
+  // id, access frequency and the clock of the last access of every row, the id of a free row is kEmptyId
+  std::vector<int64_t> row_ids_;
+  std::vector<uint32_t> row_freqs_;
+  std::vector<uint64_t> row_clocks_;
+  // the rows in the order of their clocks, the oldest first, kept only with a ttl so the expired rows are found
+  // without a scan
+  std::vector<int> prev_rows_;
+  std::vector<int> next_rows_;
+  int oldest_row_{INVALID_INDEX_VALUE};
+  int newest_row_{INVALID_INDEX_VALUE};
+  std::vector<int> free_rows_;
+  size_t capacity_;
+  // touches of the rows since the frequencies were aged last
+  size_t touches_{0};
+  // counts the lookups of the ids without rows, only when the ids are not admitted at once
+  std::unique_ptr<CountMinSketch> sketch_;
+  // number of lookups on the table, the age of the rows for ttl
+  uint64_t clock_{0};
+  DynamicEmbeddingMetrics metrics_;
+};
+}  // namespace ps
+}  // namespace mindspore
+#endif  // MINDSPORE_CCSRC_PS_DYNAMIC_EMBEDDING_TABLE_H_
@@ -24,6 +24,7 @@
 #include <memory>
 #include <vector>
 #include <mutex>
+#include <shared_mutex>
 #include <condition_variable>
 #include <thread>
 #include <cmath>
@@ -32,6 +33,8 @@
 #include <list>
 #include <map>
 #include <functional>
+#include <algorithm>
+#include <numeric>
 #include "ir/func_graph.h"
 #include "backend/session/session_basic.h"
 #include "backend/session/anf_runtime_algorithm.h"
@@ -41,6 +44,9 @@
 #include "ps/optimizer_info_builder.h"
 #include "ps/util.h"
 #include "ps/ps_context.h"
+#include "ps/server_thread_pool.h"
+#include "ps/compression.h"
+#include "ps/dynamic_embedding_table.h"
 #include "runtime/device/cpu/kernel_select_cpu.h"
 #include "utils/ms_context.h"
 #include "backend/kernel_compiler/kernel.h"
@@ -67,6 +73,8 @@ class ParameterServer {
   }
 
   void Run(const FuncGraphPtr &func_graph);
+  // Metrics of the dynamic embedding tables of this server, by key.
+  std::map<Key, DynamicEmbeddingMetrics> EmbeddingMetrics();
 
  private:
   ParameterServer()
@@ -79,6 +87,10 @@ class ParameterServer {
         func_graph_(nullptr),
         sess_(nullptr),
         running_(true),
+        sync_mode_(true),
+        staleness_threshold_(0),
+        dynamic_embedding_(false),
+        grad_key_num_(0),
         thread_(nullptr) {}
   ~ParameterServer() = default;
   ParameterServer(const ParameterServer &) = delete;
@@ -90,6 +102,8 @@ class ParameterServer {
     ~ServerHandler() = default;
     void Init();
     void operator()(const ::ps::KVMeta &req_meta, const ::ps::KVPairs<T> &req_data, ::ps::KVServer<T> *server);
+    // Run the handler of the request in the calling thread and fill its response.
+    void Handle(const ::ps::KVMeta &req_meta, const ::ps::KVPairs<T> &req_data, ::ps::KVPairs<T> *res);
 
    private:
     void HandlePushReq(const ::ps::KVMeta &req_meta, const ::ps::KVPairs<T> &req_data, ::ps::KVPairs<T> *res);
@@ -98,6 +112,7 @@ class ParameterServer {
     void HandleInitWeightToOptimId(const ::ps::KVMeta &req_meta, const ::ps::KVPairs<T> &req_data,
                                    ::ps::KVPairs<T> *res);
     void HandleInitInputsShape(const ::ps::KVMeta &req_meta, const ::ps::KVPairs<T> &req_data, ::ps::KVPairs<T> *res);
+    void HandleInitKeyCodec(const ::ps::KVMeta &req_meta, const ::ps::KVPairs<T> &req_data, ::ps::KVPairs<T> *res);
     void HandleInitEmbeddings(const ::ps::KVMeta &req_meta, const ::ps::KVPairs<T> &req_data, ::ps::KVPairs<T> *res);
     void HandleCheckReadyForPush(const ::ps::KVMeta &req_meta, const ::ps::KVPairs<T> &req_data, ::ps::KVPairs<T> *res);
     void HandleCheckReadyForPull(const ::ps::KVMeta &req_meta, const ::ps::KVPairs<T> &req_data, ::ps::KVPairs<T> *res);
@@ -124,20 +139,26 @@ class ParameterServer {
                           const std::shared_ptr<std::vector<std::shared_ptr<std::vector<size_t>>>> &shapes,
                           const ParamInitInfo &param_init_info);
   bool HasWeight(const Key &key);
+  CompressCodec KeyCodec(const Key &key);
   void Finalize();
   void UpdateWeights();
-  void AccumGrad(const Keys &key, const Values &values, const Lengths &lengths);
+  void UpdateWeight(const Key &key);
+  void ApplyGrads(const Key &key);
+  void AccumGrad(const Keys &key, const Values &values, const Lengths &lengths, int sender);
   WeightPtr weight(const Key &key);
+  void EncodePull(const Key &key, uint32_t held_snapshot_id, CompressCodec codec, Values *encoded);
   void DoEmbeddingLookup(Key key, const LookupIds &lookup_ids, ::ps::KVPairs<T> *res);
+  void ReadRows(const Key &key, const LookupIds &lookup_ids, bool lookup, Values *rows);
   void UpdateEmbeddings(const Key &key, const LookupIds &lookup_ids, const Values &vals);
   bool ReadyForUpdateWeights();
   bool ReadyForPush(const Key &key);
-  bool ReadyForPull(const Key &key);
+  bool ReadyForPull(const Key &key, int sender);
   void ResetGradAccumCount();
   const CNodePtr GetCNode(const std::string &name) const;
-  std::mutex &mutex();
+  std::shared_mutex &mutex();
   void GetEmbeddingTableParamPtr();
   void SyncEmbeddingTables();
+  void LogDynamicEmbeddingMetrics();
 
   size_t pserver_num_;
   size_t worker_num_;
@@ -148,6 +169,13 @@ class ParameterServer {
   FuncGraphPtr func_graph_;
   std::shared_ptr<session::SessionBasic> sess_;
   bool running_;
+  // false in the ssp and async consistency modes, which apply the gradients of a worker as they arrive
+  bool sync_mode_;
+  // in ssp mode, how many pushes a worker may be ahead of the slowest worker on a key and still pull it
+  uint64_t staleness_threshold_;
+  // whether the embedding tables of the ps cache are dynamic tables, configured by dynamic_embedding_config_
+  bool dynamic_embedding_;
+  DynamicEmbeddingConfig dynamic_embedding_config_;
 
   std::unordered_map<Key, std::shared_ptr<PServerKernel>> optimizers_;
   std::unordered_map<Key, InputsShapePtr> optim_inputs_shape_;
@@ -162,10 +190,37 @@ class ParameterServer {
   std::unordered_map<Key, size_t> grads_accum_counter_;
   std::unordered_map<Key, std::shared_ptr<PServerKernel>> embedding_lookup_ops_;
   std::unordered_map<Key, uint64_t> tokens_;
-
-  std::mutex mutex_;
+  // number of optimizer updates applied to a key
+  std::unordered_map<Key, uint64_t> versions_;
+  // pushes of every worker on a key, by the node id of the worker
+  std::unordered_map<Key, std::unordered_map<int, uint64_t>> worker_clocks_;
+  // codecs of the pushes and the pulls of the keys, negotiated by the workers
+  std::unordered_map<Key, CompressCodec> key_codecs_;
+  // The weights of a key as the workers decode them from their pulls, shared by all the workers. A worker holding
+  // the previous snapshot is sent the delta to the current one, which is encoded once, the others the current one
+  // whole. A new snapshot is taken when the weights were updated since the current one.
+  struct PullSnapshot {
+    uint32_t id{0};
+    uint32_t prev_id{0};
+    uint64_t weight_version{0};
+    std::vector<T> values;
+    Values delta;
+  };
+  std::unordered_map<Key, PullSnapshot> pull_snapshots_;
+  // the tables of the dynamic embedding keys, whose weights are empty, and the first ids of their shards
+  std::unordered_map<Key, std::shared_ptr<DynamicEmbeddingTable>> dynamic_tables_;
+  std::unordered_map<Key, size_t> dynamic_table_offsets_;
+
+  // Held exclusively while keys are added, shared by the requests and the updates on the keys. The state of a
+  // key is guarded by its lock in key_locks_, the state of the round by round_mutex_.
+  std::shared_mutex mutex_;
+  KeyLocks key_locks_;
+  std::mutex round_mutex_;
   std::condition_variable apply_grads_cv_;
+  // number of the keys taking gradients, guarded by round_mutex_
+  size_t grad_key_num_;
 
+  std::unique_ptr<ServerThreadPool> thread_pool_;
   std::unique_ptr<std::thread> thread_;
   std::map<Key, ParameterPtr> embedding_tables_;
 
@@ -177,16 +232,27 @@ template <typename T>
 void ParameterServer<T>::ServerHandler::operator()(const ::ps::KVMeta &req_meta, const ::ps::KVPairs<T> &req_data,
                                                    ::ps::KVServer<T> *server) {
   MS_EXCEPTION_IF_NULL(server);
-  ::ps::KVPairs<T> res;
-  if (handlers_.count(req_meta.cmd) > 0) {
-    auto &handler_ptr = handlers_[req_meta.cmd];
-    (this->*handler_ptr)(req_meta, req_data, &res);
+  // Handle the request on the pool, so requests of different workers and on different keys run concurrently.
+  // Every request of a worker waits for its response, so the requests of one worker keep their order.
+  ps_->thread_pool_->Submit([this, req_meta, req_data, server]() {
+    ::ps::KVPairs<T> res;
+    Handle(req_meta, req_data, &res);
+    server->Response(req_meta, res);
+  });
+}
+
+template <typename T>
+void ParameterServer<T>::ServerHandler::Handle(const ::ps::KVMeta &req_meta, const ::ps::KVPairs<T> &req_data,
+                                               ::ps::KVPairs<T> *res) {
+  auto iter = handlers_.find(req_meta.cmd);
+  if (iter != handlers_.end()) {
+    auto &handler_ptr = iter->second;
+    (this->*handler_ptr)(req_meta, req_data, res);
   } else if (req_meta.push) {
-    HandlePushReq(req_meta, req_data, &res);
+    HandlePushReq(req_meta, req_data, res);
   } else {
-    HandlePullReq(req_meta, req_data, &res);
+    HandlePullReq(req_meta, req_data, res);
   }
-  server->Response(req_meta, res);
 }
 
 template <typename T>
@@ -194,6 +260,7 @@ void ParameterServer<T>::ServerHandler::Init() {
   handlers_[kInitWeightsCmd] = &ServerHandler::HandleInitWeights;
   handlers_[kInitWeightToOptimIdCmd] = &ServerHandler::HandleInitWeightToOptimId;
   handlers_[kInitOptimInputsShapeCmd] = &ServerHandler::HandleInitInputsShape;
+  handlers_[kInitKeyCodecCmd] = &ServerHandler::HandleInitKeyCodec;
   handlers_[kInitEmbeddingsCmd] = &ServerHandler::HandleInitEmbeddings;
   handlers_[kCheckReadyForPushCmd] = &ServerHandler::HandleCheckReadyForPush;
   handlers_[kCheckReadyForPullCmd] = &ServerHandler::HandleCheckReadyForPull;
@@ -206,7 +273,15 @@ template <typename T>
 void ParameterServer<T>::ServerHandler::HandlePushReq(const ::ps::KVMeta &req_meta, const ::ps::KVPairs<T> &req_data,
                                                       ::ps::KVPairs<T> *res) {
   MS_EXCEPTION_IF_NULL(res);
-  ps_->AccumGrad(req_data.keys, req_data.vals, req_data.lens);
+  if (ps_->KeyCodec(req_data.keys[0]) == kCodecNone) {
+    ps_->AccumGrad(req_data.keys, req_data.vals, req_data.lens, req_meta.sender);
+    return;
+  }
+  size_t segment_num = 0;
+  Values vals(DecodedSize(req_data.vals.data(), req_data.vals.size(), &segment_num), 0);
+  Lengths lens(segment_num, 0);
+  DecodeValues(req_data.vals.data(), req_data.vals.size(), vals.data(), vals.size(), lens.data());
+  ps_->AccumGrad(req_data.keys, vals, lens, req_meta.sender);
 }
 
 template <typename T>
@@ -215,13 +290,20 @@ void ParameterServer<T>::ServerHandler::HandlePullReq(const ::ps::KVMeta &req_me
   MS_EXCEPTION_IF_NULL(res);
   res->keys = req_data.keys;
   ::ps::Key key = req_data.keys[0];
-  res->vals = *(ps_->weight(key));
+  // the workers send the id of the snapshot they hold in the pulls they decode, the tables of the embeddings are
+  // sliced over the servers and pulled whole
+  CompressCodec codec = CastCodec(ps_->KeyCodec(key));
+  if (codec == kCodecNone || req_data.vals.empty()) {
+    res->vals = *(ps_->weight(key));
+    return;
+  }
+  ps_->EncodePull(key, static_cast<uint32_t>(req_data.vals[0]), codec, &res->vals);
 }
 
 template <typename T>
 void ParameterServer<T>::ServerHandler::HandleInitWeights(const ::ps::KVMeta &req_meta,
                                                           const ::ps::KVPairs<T> &req_data, ::ps::KVPairs<T> *res) {
-  std::unique_lock<std::mutex> lock(ps_->mutex());
+  std::unique_lock<std::shared_mutex> lock(ps_->mutex());
   MS_EXCEPTION_IF_NULL(res);
   size_t key_num = req_data.keys.size();
   T *data_ptr = req_data.vals.data();
@@ -248,7 +330,7 @@ template <typename T>
 void ParameterServer<T>::ServerHandler::HandleInitWeightToOptimId(const ::ps::KVMeta &req_meta,
                                                                   const ::ps::KVPairs<T> &req_data,
                                                                   ::ps::KVPairs<T> *res) {
-  std::unique_lock<std::mutex> lock(ps_->mutex());
+  std::unique_lock<std::shared_mutex> lock(ps_->mutex());
   MS_EXCEPTION_IF_NULL(res);
   size_t key_num = req_data.keys.size();
   for (size_t i = 0; i < key_num; i++) {
@@ -266,7 +348,7 @@ void ParameterServer<T>::ServerHandler::HandleInitWeightToOptimId(const ::ps::KV
 template <typename T>
 void ParameterServer<T>::ServerHandler::HandleInitInputsShape(const ::ps::KVMeta &req_meta,
                                                               const ::ps::KVPairs<T> &req_data, ::ps::KVPairs<T> *res) {
-  std::unique_lock<std::mutex> lock(ps_->mutex());
+  std::unique_lock<std::shared_mutex> lock(ps_->mutex());
   MS_EXCEPTION_IF_NULL(res);
   const Key &key = req_data.keys[0];
   if (init_optim_info_[key]) {
@@ -277,10 +359,21 @@ void ParameterServer<T>::ServerHandler::HandleInitInputsShape(const ::ps::KVMeta
   ps_->InitOptimInputsShape(req_data.keys, req_data.vals, req_data.lens);
 }
 
+template <typename T>
+void ParameterServer<T>::ServerHandler::HandleInitKeyCodec(const ::ps::KVMeta &req_meta,
+                                                           const ::ps::KVPairs<T> &req_data, ::ps::KVPairs<T> *res) {
+  std::unique_lock<std::shared_mutex> lock(ps_->mutex());
+  MS_EXCEPTION_IF_NULL(res);
+  const Key &key = req_data.keys[0];
+  auto codec = static_cast<CompressCodec>(req_data.vals[0]);
+  MS_LOG(INFO) << "The codec of key " << key << " is " << codec;
+  ps_->key_codecs_[key] = codec;
+}
+
 template <typename T>
 void ParameterServer<T>::ServerHandler::HandleInitEmbeddings(const ::ps::KVMeta &req_meta,
                                                              const ::ps::KVPairs<T> &req_data, ::ps::KVPairs<T> *res) {
-  std::unique_lock<std::mutex> lock(ps_->mutex());
+  std::unique_lock<std::shared_mutex> lock(ps_->mutex());
   MS_EXCEPTION_IF_NULL(res);
   const Key &key = req_data.keys[0];
   MS_LOG(INFO) << "Initializing embedding table for key:" << key;
@@ -338,7 +431,7 @@ void ParameterServer<T>::ServerHandler::HandleCheckReadyForPull(const ::ps::KVMe
                                                                 ::ps::KVPairs<T> *res) {
   MS_EXCEPTION_IF_NULL(res);
   const Key &key = req_data.keys[0];
-  bool ready = ps_->ReadyForPull(key);
+  bool ready = ps_->ReadyForPull(key, req_meta.sender);
   res->keys.push_back(key);
   res->vals.push_back(ready);
 }
@@ -352,13 +445,22 @@ void ParameterServer<T>::ServerHandler::HandleEmbeddingLookup(const ::ps::KVMeta
     res->keys.push_back(req_data.keys[i]);
   }
   ps_->DoEmbeddingLookup(key, req_data.keys.segment(1, req_data.keys.size()), res);
+  CompressCodec codec = CastCodec(ps_->KeyCodec(key));
+  if (codec == kCodecNone) {
+    return;
+  }
+  int len = static_cast<int>(res->vals.size());
+  int encoded_len = 0;
+  Values encoded(EncodedSize(codec, &len, 1, 0), 0);
+  EncodeValues(codec, res->vals.data(), &len, 1, 0, nullptr, encoded.data(), &encoded_len);
+  res->vals = encoded;
+  res->lens = {encoded_len};
 }
 
 template <typename T>
 void ParameterServer<T>::ServerHandler::HandleUpdateEmbeddings(const ::ps::KVMeta &req_meta,
                                                                const ::ps::KVPairs<T> &req_data,
                                                                ::ps::KVPairs<T> *res) {
-  std::unique_lock<std::mutex> lock(ps_->mutex());
   MS_EXCEPTION_IF_NULL(res);
   const Key &key = req_data.keys[0];
   const LookupIds &lookup_ids = req_data.keys.segment(1, req_data.keys.size());
@@ -383,6 +485,18 @@ bool ParameterServer<T>::Init(const FuncGraphPtr &func_graph) {
   handler_->Init();
 
   InitOptimInfoBuilders();
+  auto ps_context = PSContext::instance();
+  sync_mode_ = ps_context->consistency_mode() == kConsistencySync;
+  staleness_threshold_ = ps_context->consistency_mode() == kConsistencySSP
+                           ? static_cast<uint64_t>(ps_context->staleness_threshold())
+                           : UINT64_MAX;
+  MS_LOG(INFO) << "Consistency mode is " << ps_context->consistency_mode() << ", staleness threshold is "
+               << ps_context->staleness_threshold();
+  dynamic_embedding_ = ps_context->embedding_storage() == kEmbeddingStorageDynamic;
+  dynamic_embedding_config_.ttl = LongToSize(ps_context->embedding_ttl());
+  dynamic_embedding_config_.max_rows = LongToSize(ps_context->embedding_max_rows());
+  size_t thread_num = std::min(static_cast<size_t>(std::thread::hardware_concurrency()), kMaxServerThreadNum);
+  thread_pool_.reset(new ServerThreadPool(thread_num));
   ps_->set_request_handle(*handler_);
   thread_.reset(new std::thread(&ParameterServer::UpdateWeights, this));
   GetEmbeddingTableParamPtr();
@@ -490,6 +604,11 @@ void ParameterServer<T>::InitWeight(const Key &key, const WeightPtr &weight) {
     weights_[key] = weight;
     tokens_[key] = 0;
     is_embedding_[key] = false;
+    versions_[key] = 0;
+    // added here so the requests on the key only look it up
+    (void)optim_infos_[key];
+    (void)worker_clocks_[key];
+    (void)pull_snapshots_[key];
   }
 }
 
@@ -499,6 +618,8 @@ void ParameterServer<T>::InitGrad(const Key &key, const GradPtr &grad) {
   if (grads_.count(key) == 0) {
     grads_[key] = grad;
     grads_accum_counter_[key] = 0;
+    std::unique_lock<std::mutex> round_lock(round_mutex_);
+    grad_key_num_ = grads_accum_counter_.size();
   }
 }
 
@@ -515,31 +636,68 @@ void ParameterServer<T>::InitEmbeddingTable(
 
     // Init embedding weight
     const std::vector<size_t> &input_shapes = lookup->input_sizes();
-    size_t total_dims =
-      std::accumulate(input_shapes.begin(), input_shapes.end(), IntToSize(1), std::multiplies<size_t>());
-    WeightPtr embedding = std::make_shared<Weight>(total_dims, 0);
-    MS_EXCEPTION_IF_NULL(embedding);
-    T *embedding_data = embedding->data();
-    std::default_random_engine engine;
-    std::normal_distribution<float> random(0, 0.01);
-    if (ps::PsDataPrefetch::GetInstance().cache_enable()) {
-      if (param_init_info.param_type_ == kWeight) {
-        InitRandomNormal(0, 0.01, input_shapes, param_init_info.global_seed_, param_init_info.op_seed_, embedding_data);
-      } else if (param_init_info.param_type_ == kAccumulation) {
-        for (size_t i = 0; i < total_dims; i++) {
-          embedding_data[i] = param_init_info.init_val_;
-        }
+    bool cache_enable = ps::PsDataPrefetch::GetInstance().cache_enable();
+    if (dynamic_embedding_ && !cache_enable) {
+      // the optimizers of the servers update the dense tables by the ids directly
+      MS_LOG(WARNING) << "The dynamic embedding storage takes the embedding tables of the ps cache only, the table of "
+                      << "key " << key << " is dense.";
+    }
+    if (dynamic_embedding_ && cache_enable) {
+      // the rows of the table are created as the ids come, the weight of the key stays empty
+      DynamicEmbeddingInit init;
+      init.random_normal = param_init_info.param_type_ == kWeight;
+      init.value = param_init_info.init_val_;
+      init.seed = param_init_info.global_seed_ * kFibonacciMultiplier + param_init_info.op_seed_;
+      size_t embedding_size =
+        std::accumulate(input_shapes.begin() + 1, input_shapes.end(), IntToSize(1), std::multiplies<size_t>());
+      // The lookups of the ps cache only come on its misses, so the workers count the ids of their batches instead
+      // and push the rows of the admitted ids only. The rows are created by the pushes.
+      DynamicEmbeddingConfig config = dynamic_embedding_config_;
+      config.admit_threshold = 0;
+      dynamic_tables_[key] = std::make_shared<DynamicEmbeddingTable>(embedding_size, config, init);
+      size_t vocab_size = (*shapes)[0]->at(0);
+      size_t offset = 0;
+      for (size_t i = 0; i < rank_id_; i++) {
+        offset += LongToSize(Util::LocalShard(SizeToLong(vocab_size), SizeToLong(i), SizeToLong(pserver_num_)));
       }
+      dynamic_table_offsets_[key] = offset;
+      weights_[key] = std::make_shared<Weight>();
+      MS_LOG(INFO) << "The embedding table of key " << key << " is dynamic, embedding size " << embedding_size
+                   << ", ttl " << dynamic_embedding_config_.ttl << ", max rows " << dynamic_embedding_config_.max_rows;
     } else {
-      for (size_t i = 0; i < total_dims; i++) {
-        embedding_data[i] = random(engine);
+      size_t total_dims =
+        std::accumulate(input_shapes.begin(), input_shapes.end(), IntToSize(1), std::multiplies<size_t>());
+      WeightPtr embedding = std::make_shared<Weight>(total_dims, 0);
+      MS_EXCEPTION_IF_NULL(embedding);
+      T *embedding_data = embedding->data();
+      std::default_random_engine engine;
+      std::normal_distribution<float> random(0, 0.01);
+      if (cache_enable) {
+        if (param_init_info.param_type_ == kWeight) {
+          InitRandomNormal(0, 0.01, input_shapes, param_init_info.global_seed_, param_init_info.op_seed_,
+                           embedding_data);
+        } else if (param_init_info.param_type_ == kAccumulation) {
+          for (size_t i = 0; i < total_dims; i++) {
+            embedding_data[i] = param_init_info.init_val_;
+          }
+        }
+      } else {
+        for (size_t i = 0; i < total_dims; i++) {
+          embedding_data[i] = random(engine);
+        }
       }
+      weights_[key] = embedding;
     }
-    weights_[key] = embedding;
     tokens_[key] = 0;
     is_embedding_[key] = true;
+    versions_[key] = 0;
+    (void)optim_infos_[key];
+    (void)worker_clocks_[key];
+    (void)pull_snapshots_[key];
 
     grads_accum_counter_[key] = 0;
+    std::unique_lock<std::mutex> round_lock(round_mutex_);
+    grad_key_num_ = grads_accum_counter_.size();
   }
 }
 
@@ -548,114 +706,213 @@ bool ParameterServer<T>::HasWeight(const Key &key) {
   return (weights_.count(key) > 0 && !is_embedding_.count(key));
 }
 
+template <typename T>
+CompressCodec ParameterServer<T>::KeyCodec(const Key &key) {
+  std::shared_lock<std::shared_mutex> lock(mutex_);
+  auto iter = key_codecs_.find(key);
+  return iter == key_codecs_.end() ? kCodecNone : iter->second;
+}
+
 template <typename T>
 void ParameterServer<T>::Finalize() {
-  running_ = false;
+  {
+    std::unique_lock<std::mutex> round_lock(round_mutex_);
+    running_ = false;
+  }
   apply_grads_cv_.notify_one();
+  // every worker sends a finalize request, they sync the tables one after another
+  std::unique_lock<std::shared_mutex> lock(mutex_);
   SyncEmbeddingTables();
+  LogDynamicEmbeddingMetrics();
 }
 
 template <typename T>
 void ParameterServer<T>::UpdateWeights() {
   while (true) {
-    std::unique_lock<std::mutex> lock(mutex_);
-    apply_grads_cv_.wait(lock, [this] { return this->ReadyForUpdateWeights() || !running_; });
-    if (!running_) {
-      break;
+    {
+      std::unique_lock<std::mutex> round_lock(round_mutex_);
+      apply_grads_cv_.wait(round_lock, [this] { return this->ReadyForUpdateWeights() || !running_; });
+      if (!running_) {
+        break;
+      }
     }
 
+    // No push comes in before the round is reset, pulls on a key start as soon as the key is updated.
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    std::vector<Key> keys;
+    keys.reserve(weights_.size());
     for (auto iter = weights_.begin(); iter != weights_.end(); iter++) {
-      Key key = iter->first;
-      WeightPtr weight_ptr = iter->second;
+      keys.push_back(iter->first);
+    }
+    thread_pool_->ParallelFor(keys.size(), [this, &keys](size_t i) { UpdateWeight(keys[i]); });
+    ResetGradAccumCount();
+  }
+}
 
-      std::shared_ptr<PServerKernel> optimizer = nullptr;
-      if (weight_key_to_optims_.count(key) > 0) {
-        optimizer = optimizers_[key];
-      }
-      MS_EXCEPTION_IF_NULL(optimizer);
-
-      std::shared_ptr<OptimizerInfo> optim_info = optim_infos_[key];
-      if (optim_info != nullptr) {
-        const std::vector<kernel::AddressPtr> &inputs = optim_info->inputs();
-        const std::vector<kernel::AddressPtr> &workspaces = optim_info->workspaces();
-        const std::vector<kernel::AddressPtr> &outputs = optim_info->outputs();
-
-        std::vector<std::vector<size_t>> shapes = {};
-        std::vector<size_t> indices_shape = {};
-        indices_shape.emplace_back(optim_info->indice_size());
-        shapes.push_back(indices_shape);
-
-        if (original_optim_inputs_shape_.count(key) != 0) {
-          for (auto input_shapes : *(original_optim_inputs_shape_[key])) {
-            shapes.push_back(*input_shapes);
-          }
-        }
-        optimizer->ReInit(shapes);
-        optim_info->ComputeMean(shapes, worker_num_, pserver_num_, rank_id_);
-        optimizer->Execute(inputs, workspaces, outputs);
-        optim_info->Reset();
-      }
-      if (!is_embedding_[key]) {
-        tokens_[key] = worker_num_;
+template <typename T>
+void ParameterServer<T>::UpdateWeight(const Key &key) {
+  std::unique_lock<std::mutex> key_lock(key_locks_[key]);
+  ApplyGrads(key);
+  if (!is_embedding_.at(key)) {
+    tokens_.at(key) = worker_num_;
+  }
+}
+
+template <typename T>
+void ParameterServer<T>::ApplyGrads(const Key &key) {
+  // called with the lock of key held
+  std::shared_ptr<PServerKernel> optimizer = nullptr;
+  auto optimizer_iter = optimizers_.find(key);
+  if (weight_key_to_optims_.count(key) > 0 && optimizer_iter != optimizers_.end()) {
+    optimizer = optimizer_iter->second;
+  }
+  MS_EXCEPTION_IF_NULL(optimizer);
+
+  auto optim_info_iter = optim_infos_.find(key);
+  std::shared_ptr<OptimizerInfo> optim_info = optim_info_iter == optim_infos_.end() ? nullptr : optim_info_iter->second;
+  if (optim_info != nullptr) {
+    const std::vector<kernel::AddressPtr> &inputs = optim_info->inputs();
+    const std::vector<kernel::AddressPtr> &workspaces = optim_info->workspaces();
+    const std::vector<kernel::AddressPtr> &outputs = optim_info->outputs();
+
+    std::vector<std::vector<size_t>> shapes = {};
+    std::vector<size_t> indices_shape = {};
+    indices_shape.emplace_back(optim_info->indice_size());
+    shapes.push_back(indices_shape);
+
+    if (original_optim_inputs_shape_.count(key) != 0) {
+      for (auto input_shapes : *(original_optim_inputs_shape_.at(key))) {
+        shapes.push_back(*input_shapes);
       }
     }
-    ResetGradAccumCount();
+    optimizer->ReInit(shapes);
+    optim_info->ComputeMean(shapes, worker_num_, pserver_num_, rank_id_);
+    optimizer->Execute(inputs, workspaces, outputs);
+    optim_info->Reset();
+    versions_.at(key)++;
   }
 }
 
 template <typename T>
-void ParameterServer<T>::AccumGrad(const Keys &keys, const Values &values, const Lengths &lengths) {
-  std::unique_lock<std::mutex> lock(mutex_);
+void ParameterServer<T>::AccumGrad(const Keys &keys, const Values &values, const Lengths &lengths, int sender) {
+  std::shared_lock<std::shared_mutex> lock(mutex_);
   const Key &key = keys[0];
+  auto optim_iter = optim_infos_.find(key);
+  auto counter_iter = grads_accum_counter_.find(key);
+  if (optim_iter == optim_infos_.end() || counter_iter == grads_accum_counter_.end()) {
+    MS_LOG(EXCEPTION) << "Invalid weight key " << key;
+  }
+  std::unique_lock<std::mutex> key_lock(key_locks_[key]);
   bool no_sparse_grad = values.size() == 1 && values[0] == -100;
   if (!no_sparse_grad) {
-    std::shared_ptr<OptimizerInfo> optim_info = optim_infos_[key];
+    std::shared_ptr<OptimizerInfo> optim_info = optim_iter->second;
 
     // Create or update the optimizer info
     if (optim_info == nullptr) {
-      const std::shared_ptr<OptimizerInfoBuilder> &builder = optim_info_builders_[weight_key_to_optims_[key]];
-      std::shared_ptr<kernel::ps::PServerKernel> pserver_kernel = optimizers_[key];
-      if (pserver_kernel == nullptr) {
-        MS_LOG(EXCEPTION) << "no optimizer found for key " << key << " optim name " << weight_key_to_optims_[key];
+      auto optim_name_iter = weight_key_to_optims_.find(key);
+      auto pserver_kernel_iter = optimizers_.find(key);
+      auto inputs_shape_iter = optim_inputs_shape_.find(key);
+      if (optim_name_iter == weight_key_to_optims_.end() || pserver_kernel_iter == optimizers_.end() ||
+          pserver_kernel_iter->second == nullptr || inputs_shape_iter == optim_inputs_shape_.end()) {
+        MS_LOG(EXCEPTION) << "no optimizer found for key " << key;
       }
-      MS_EXCEPTION_IF_NULL(pserver_kernel);
-      OptimizerInfo *optim =
-        builder->Build(pserver_kernel, weights_[key], keys, values, lengths, optim_inputs_shape_[key], worker_num_);
+      auto builder_iter = optim_info_builders_.find(optim_name_iter->second);
+      if (builder_iter == optim_info_builders_.end()) {
+        MS_LOG(EXCEPTION) << "no optimizer info builder found for optim name " << optim_name_iter->second;
+      }
+      OptimizerInfo *optim = builder_iter->second->Build(pserver_kernel_iter->second, weights_.at(key), keys, values,
+                                                         lengths, inputs_shape_iter->second, worker_num_);
       optim_info.reset(optim);
-      optim_infos_[key] = optim_info;
+      optim_iter->second = optim_info;
     } else {
       optim_info->Update(values, lengths);
       optim_info->Accumulate(values, lengths);
     }
   }
 
-  grads_accum_counter_[key] += 1;
-  if (grads_accum_counter_[key] == worker_num_) {
-    grad_accum_count_++;
+  if (!sync_mode_) {
+    // The gradient is applied at once. ComputeMean still divides it by the worker number, so a step of every
+    // worker moves the weight as far as one synchronous step does.
+    worker_clocks_.at(key)[sender]++;
+    if (!no_sparse_grad) {
+      ApplyGrads(key);
+    }
+    return;
   }
-  if (ReadyForUpdateWeights()) {
-    apply_grads_cv_.notify_one();
+  counter_iter->second += 1;
+  if (counter_iter->second == worker_num_) {
+    std::unique_lock<std::mutex> round_lock(round_mutex_);
+    grad_accum_count_++;
+    if (ReadyForUpdateWeights()) {
+      apply_grads_cv_.notify_one();
+    }
   }
 }
 
 template <typename T>
 WeightPtr ParameterServer<T>::weight(const Key &key) {
-  std::unique_lock<std::mutex> lock(mutex_);
-  if (weights_.count(key) == 0) {
+  std::shared_lock<std::shared_mutex> lock(mutex_);
+  if (weights_.count(key) == 0 || tokens_.count(key) == 0) {
     MS_LOG(EXCEPTION) << "Invalid weight key " << key;
   }
-  WeightPtr weight_ptr = weights_[key];
+  std::unique_lock<std::mutex> key_lock(key_locks_[key]);
+  WeightPtr weight_ptr = weights_.at(key);
   MS_EXCEPTION_IF_NULL(weight_ptr);
   WeightPtr copy_weight_ptr = std::make_shared<::ps::SArray<T>>(weight_ptr->size(), 0);
   MS_EXCEPTION_IF_NULL(copy_weight_ptr);
   copy_weight_ptr->CopyFrom(weight_ptr->data(), weight_ptr->size());
-  tokens_[key] -= 1;
+  if (sync_mode_) {
+    tokens_.at(key) -= 1;
+  }
   return copy_weight_ptr;
 }
 
+template <typename T>
+void ParameterServer<T>::EncodePull(const Key &key, uint32_t held_snapshot_id, CompressCodec codec, Values *encoded) {
+  std::shared_lock<std::shared_mutex> lock(mutex_);
+  MS_EXCEPTION_IF_NULL(encoded);
+  auto snapshot_iter = pull_snapshots_.find(key);
+  if (snapshot_iter == pull_snapshots_.end() || weights_.count(key) == 0 || tokens_.count(key) == 0) {
+    MS_LOG(EXCEPTION) << "Invalid weight key " << key;
+  }
+  std::unique_lock<std::mutex> key_lock(key_locks_[key]);
+  const WeightPtr &weight = weights_.at(key);
+  MS_EXCEPTION_IF_NULL(weight);
+  if (sync_mode_) {
+    tokens_.at(key) -= 1;
+  }
+  auto &snapshot = snapshot_iter->second;
+  uint64_t weight_version = versions_.at(key);
+  if (snapshot.id == 0 || snapshot.weight_version != weight_version) {
+    // the first snapshot is the delta against zeros, which the workers start from
+    snapshot.values.resize(weight->size(), 0);
+    snapshot.delta = Values(DeltaEncodedSize(codec, weight->size()), 0);
+    EncodeDelta(codec, weight->data(), weight->size(), snapshot.values.data(), snapshot.delta.data());
+    snapshot.prev_id = snapshot.id;
+    snapshot.id = snapshot.id % kMaxPullSnapshotId + 1;
+    snapshot.weight_version = weight_version;
+  }
+  encoded->clear();
+  encoded->push_back(static_cast<T>(snapshot.id));
+  if (held_snapshot_id == snapshot.id) {
+    // nothing changed since the last pull of the worker
+    return;
+  }
+  if (held_snapshot_id == snapshot.prev_id) {
+    encoded->append(snapshot.delta);
+    return;
+  }
+  // the snapshot of the worker is older than the previous one, or it has none
+  int len = SizeToInt(snapshot.values.size());
+  int encoded_len = 0;
+  Values whole(EncodedSize(kCodecNone, &len, 1, 0), 0);
+  EncodeValues(kCodecNone, snapshot.values.data(), &len, 1, 0, nullptr, whole.data(), &encoded_len);
+  encoded->append(whole);
+}
+
 template <typename T>
 void ParameterServer<T>::DoEmbeddingLookup(Key key, const LookupIds &lookup_ids, ::ps::KVPairs<T> *res) {
-  std::unique_lock<std::mutex> lock(mutex_);
+  std::shared_lock<std::shared_mutex> lock(mutex_);
   MS_EXCEPTION_IF_NULL(res);
   if (weights_.count(key) == 0) {
     MS_LOG(ERROR) << "Invalid embedding table key " << key;
@@ -665,9 +922,30 @@ void ParameterServer<T>::DoEmbeddingLookup(Key key, const LookupIds &lookup_ids,
     MS_LOG(ERROR) << "Invalid embedding lookup op key " << key;
     return;
   }
-  WeightPtr table_ptr = weights_[key];
+  // the lookup op of the table is reshaped for every lookup
+  std::unique_lock<std::mutex> key_lock(key_locks_[key]);
+  ReadRows(key, lookup_ids, true, &res->vals);
+  res->lens.push_back(res->vals.size());
+}
+
+// Called with the lock of the key held. The rows read from a dynamic table count as a lookup when lookup is true.
+template <typename T>
+void ParameterServer<T>::ReadRows(const Key &key, const LookupIds &lookup_ids, bool lookup, Values *rows) {
+  MS_EXCEPTION_IF_NULL(rows);
+  auto dynamic_table_iter = dynamic_tables_.find(key);
+  if (dynamic_table_iter != dynamic_tables_.end()) {
+    auto &dynamic_table = dynamic_table_iter->second;
+    rows->resize(lookup_ids.size() * dynamic_table->embedding_size());
+    if (lookup) {
+      dynamic_table->Lookup(lookup_ids.data(), lookup_ids.size(), rows->data());
+    } else {
+      dynamic_table->Read(lookup_ids.data(), lookup_ids.size(), rows->data());
+    }
+    return;
+  }
+  WeightPtr table_ptr = weights_.at(key);
   MS_EXCEPTION_IF_NULL(table_ptr);
-  std::shared_ptr<PServerKernel> table_lookup_op = embedding_lookup_ops_[key];
+  std::shared_ptr<PServerKernel> table_lookup_op = embedding_lookup_ops_.at(key);
   MS_EXCEPTION_IF_NULL(table_lookup_op);
 
   // Update shapes of lookup operator
@@ -708,12 +986,12 @@ void ParameterServer<T>::DoEmbeddingLookup(Key key, const LookupIds &lookup_ids,
   outputs.push_back(output);
 
   table_lookup_op->Execute(inputs, workspaces, outputs);
-  res->vals = *addr;
-  res->lens.push_back(res->vals.size());
+  *rows = *addr;
 }
 
 template <typename T>
 void ParameterServer<T>::UpdateEmbeddings(const Key &key, const LookupIds &lookup_ids, const Values &vals) {
+  std::shared_lock<std::shared_mutex> lock(mutex_);
   if (weights_.count(key) == 0) {
     MS_LOG(ERROR) << "Invalid embedding table key " << key;
     return;
@@ -722,47 +1000,111 @@ void ParameterServer<T>::UpdateEmbeddings(const Key &key, const LookupIds &looku
     MS_LOG(ERROR) << "Invalid embedding lookup op key " << key;
     return;
   }
-  WeightPtr table_ptr = weights_[key];
+  std::unique_lock<std::mutex> key_lock(key_locks_[key]);
+  // the rows of a table with a codec are sent as their deltas against the rows the worker looked up, or whole
+  auto codec_iter = key_codecs_.find(key);
+  bool encoded = codec_iter != key_codecs_.end() && codec_iter->second != kCodecNone;
+  Values decoded;
+  if (encoded) {
+    Values rows;
+    ReadRows(key, lookup_ids, false, &rows);
+    size_t segment_num = 0;
+    if (DecodedSize(vals.data(), vals.size(), &segment_num) != rows.size()) {
+      MS_LOG(EXCEPTION) << "The encoded update values of key " << key << " do not decode to the " << lookup_ids.size()
+                        << " rows of " << rows.size() << " values.";
+    }
+    decoded = Values(rows.size(), 0);
+    DecodeValues(vals.data(), vals.size(), decoded.data(), decoded.size(), nullptr, rows.data());
+  }
+  const Values &update_vals = encoded ? decoded : vals;
+  auto dynamic_table_iter = dynamic_tables_.find(key);
+  if (dynamic_table_iter != dynamic_tables_.end()) {
+    auto &dynamic_table = dynamic_table_iter->second;
+    if (update_vals.size() != lookup_ids.size() * dynamic_table->embedding_size()) {
+      MS_LOG(EXCEPTION) << "The update values of key " << key << " have size " << update_vals.size() << ", but "
+                        << lookup_ids.size() << " rows of " << dynamic_table->embedding_size() << " are expected.";
+    }
+    dynamic_table->Update(lookup_ids.data(), lookup_ids.size(), update_vals.data());
+    return;
+  }
+  WeightPtr table_ptr = weights_.at(key);
   MS_EXCEPTION_IF_NULL(table_ptr);
-  std::shared_ptr<PServerKernel> table_lookup_op = embedding_lookup_ops_[key];
+  std::shared_ptr<PServerKernel> table_lookup_op = embedding_lookup_ops_.at(key);
   MS_EXCEPTION_IF_NULL(table_lookup_op);
-  table_lookup_op->UpdateEmbeddings(table_ptr->data(), lookup_ids.data(), vals.data(), lookup_ids.size());
+  table_lookup_op->UpdateEmbeddings(table_ptr->data(), lookup_ids.data(), update_vals.data(), lookup_ids.size());
 }
 
 template <typename T>
 inline bool ParameterServer<T>::ReadyForUpdateWeights() {
-  return grads_accum_counter_.size() > 0 && grad_accum_count_ == grads_accum_counter_.size();
+  // called with round_mutex_ held
+  return grad_key_num_ > 0 && grad_accum_count_ == grad_key_num_;
 }
 
 template <typename T>
 inline bool ParameterServer<T>::ReadyForPush(const Key &key) {
-  std::unique_lock<std::mutex> lock(mutex_);
+  std::shared_lock<std::shared_mutex> lock(mutex_);
   if (weights_.empty()) {
     MS_LOG(EXCEPTION) << "The weights in server is empty. Many reasons could cause this: 1.The Worker didn't send "
                          "kInitWeightsCmd command. 2.The Server failed to initialize weights.";
   }
-  return grad_accum_count_ < weights_.size() && tokens_[key] <= 0;
+  if (!sync_mode_) {
+    return true;
+  }
+  {
+    std::unique_lock<std::mutex> round_lock(round_mutex_);
+    if (grad_accum_count_ >= weights_.size()) {
+      return false;
+    }
+  }
+  auto iter = tokens_.find(key);
+  if (iter == tokens_.end()) {
+    return true;
+  }
+  std::unique_lock<std::mutex> key_lock(key_locks_[key]);
+  return iter->second <= 0;
 }
 
 template <typename T>
-inline bool ParameterServer<T>::ReadyForPull(const Key &key) {
-  std::unique_lock<std::mutex> lock(mutex_);
-  if (tokens_.count(key) == 0 || weights_[key] == 0) {
+inline bool ParameterServer<T>::ReadyForPull(const Key &key, int sender) {
+  std::shared_lock<std::shared_mutex> lock(mutex_);
+  auto iter = tokens_.find(key);
+  if (iter == tokens_.end() || weights_.count(key) == 0 || weights_.at(key) == nullptr) {
     MS_LOG(EXCEPTION) << "Invalid weight key " << key;
   }
-  return tokens_[key] > 0;
+  std::unique_lock<std::mutex> key_lock(key_locks_[key]);
+  if (sync_mode_) {
+    return iter->second > 0;
+  }
+  if (staleness_threshold_ == UINT64_MAX) {
+    return true;
+  }
+  // the worker waits while it is more than staleness_threshold_ pushes ahead of the slowest worker
+  const auto &clocks = worker_clocks_.at(key);
+  auto clock_iter = clocks.find(sender);
+  uint64_t clock = clock_iter == clocks.end() ? 0 : clock_iter->second;
+  uint64_t slowest = 0;
+  if (clocks.size() >= worker_num_) {
+    slowest = UINT64_MAX;
+    for (const auto &worker_clock : clocks) {
+      slowest = std::min(slowest, worker_clock.second);
+    }
+  }
+  return clock <= slowest + staleness_threshold_;
 }
 
 template <typename T>
 inline void ParameterServer<T>::ResetGradAccumCount() {
-  grad_accum_count_ = 0;
+  // the counters first, a push waits for grad_accum_count_ to be reset and must see them cleared
   for (auto iter = grads_accum_counter_.begin(); iter != grads_accum_counter_.end(); iter++) {
-    grads_accum_counter_[iter->first] = 0;
+    std::unique_lock<std::mutex> key_lock(key_locks_[iter->first]);
+    iter->second = 0;
   }
+  std::unique_lock<std::mutex> round_lock(round_mutex_);
+  grad_accum_count_ = 0;
 }
 
 template <typename T>
-inline std::mutex &ParameterServer<T>::mutex() {
+inline std::shared_mutex &ParameterServer<T>::mutex() {
   return mutex_;
 }
 
@@ -800,17 +1142,24 @@ void ParameterServer<T>::SyncEmbeddingTables() {
     MS_EXCEPTION_IF_NULL(new_tensor);
     float *new_tensor_data_ptr = reinterpret_cast<float *>(new_tensor->data_c());
     size_t new_tensor_size = static_cast<size_t>(new_tensor->data().nbytes());
-    size_t embedding_table_size = weights_[key]->size() * sizeof(float);
-    if (new_tensor_size != embedding_table_size) {
-      MS_LOG(EXCEPTION) << "Shape of embedding table can't match. New tensor size:" << new_tensor_size
-                        << ", embedding_table size:" << embedding_table_size;
-    }
     MS_EXCEPTION_IF_NULL(new_tensor_data_ptr);
-    MS_EXCEPTION_IF_NULL(weights_[key]->data());
-    int64_t ret = memcpy_s(new_tensor_data_ptr, new_tensor_size, weights_[key]->data(), embedding_table_size);
-    if (ret != 0) {
-      MS_LOG(EXCEPTION) << "memcpy_s error, errorno(" << ret << ")";
-      return;
+    auto dynamic_table_iter = dynamic_tables_.find(key);
+    if (dynamic_table_iter != dynamic_tables_.end()) {
+      // the rows which are not created get their initial values
+      size_t offset = dynamic_table_offsets_[key];
+      dynamic_table_iter->second->ToDense(offset, offset + input_shapes[0], new_tensor_data_ptr);
+    } else {
+      size_t embedding_table_size = weights_[key]->size() * sizeof(float);
+      if (new_tensor_size != embedding_table_size) {
+        MS_LOG(EXCEPTION) << "Shape of embedding table can't match. New tensor size:" << new_tensor_size
+                          << ", embedding_table size:" << embedding_table_size;
+      }
+      MS_EXCEPTION_IF_NULL(weights_[key]->data());
+      int64_t ret = memcpy_s(new_tensor_data_ptr, new_tensor_size, weights_[key]->data(), embedding_table_size);
+      if (ret != 0) {
+        MS_LOG(EXCEPTION) << "memcpy_s error, errorno(" << ret << ")";
+        return;
+      }
     }
 
     auto paramter_tensor_ptr = embedding_table.second->default_param();
@@ -819,6 +1168,33 @@ void ParameterServer<T>::SyncEmbeddingTables() {
   }
 }
 
+template <typename T>
+std::map<Key, DynamicEmbeddingMetrics> ParameterServer<T>::EmbeddingMetrics() {
+  std::shared_lock<std::shared_mutex> lock(mutex_);
+  std::map<Key, DynamicEmbeddingMetrics> metrics;
+  for (const auto &item : dynamic_tables_) {
+    MS_EXCEPTION_IF_NULL(item.second);
+    std::unique_lock<std::mutex> key_lock(key_locks_[item.first]);
+    metrics[item.first] = item.second->metrics();
+  }
+  return metrics;
+}
+
+template <typename T>
+void ParameterServer<T>::LogDynamicEmbeddingMetrics() {
+  for (const auto &item : dynamic_tables_) {
+    MS_EXCEPTION_IF_NULL(item.second);
+    auto metrics = item.second->metrics();
+    double hit_rate = metrics.lookup_ids == 0 ? 0 : static_cast<double>(metrics.lookup_hits) / metrics.lookup_ids;
+    double lookup_qps = metrics.lookup_seconds == 0 ? 0 : metrics.lookup_ids / metrics.lookup_seconds;
+    MS_LOG(INFO) << "Dynamic embedding table of key " << item.first << ": " << metrics.row_num << " rows in "
+                 << metrics.memory_bytes << " bytes, " << metrics.lookup_ids << " ids looked up at " << lookup_qps
+                 << " ids/s, hit rate " << hit_rate * 100 << "%, " << metrics.admitted_ids << " ids admitted, "
+                 << metrics.rejected_ids << " lookups rejected, " << metrics.ttl_evicted_rows << " rows expired, "
+                 << metrics.lfu_evicted_rows << " rows evicted by frequency.";
+  }
+}
+
 template <typename T>
 void ParameterServer<T>::Run(const FuncGraphPtr &func_graph) {
   MS_EXCEPTION_IF_NULL(func_graph);
@@ -0,0 +1,95 @@
+/**
+ * Copyright 2021 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "ps/ps_cache/cpu/cpu_ps_cache.h"
+#include "ps/ps_cache/ps_cache_factory.h"
+#include "utils/convert_utils_base.h"
+#include "utils/log_adapter.h"
+#include "utils/ms_context.h"
+
+namespace mindspore {
+namespace ps {
+namespace cpu {
+MS_REG_PS_CACHE(kCPUDevice, CPUPsCache);
+void *CPUPsCache::MallocMemory(size_t size) {
+  // The memory is aligned as float, the hash tables and the swap values are floats.
+  auto memory = std::make_unique<float[]>((size + sizeof(float) - 1) / sizeof(float));
+  void *addr = memory.get();
+  std::lock_guard<std::mutex> locker(memory_mutex_);
+  memory_.push_back(std::move(memory));
+  return addr;
+}
+
+void CPUPsCache::CopyHostMemToDevice(void *dst, void *src, size_t size) {
+  MS_EXCEPTION_IF_NULL(dst);
+  MS_EXCEPTION_IF_NULL(src);
+  if (size > 0 && memcpy_s(dst, size, src, size) != EOK) {
+    MS_LOG(EXCEPTION) << "Copy host memory to device failed, size:" << size;
+  }
+}
+
+void CPUPsCache::CopyDeviceMemToHost(void *dst, void *src, size_t size) {
+  MS_EXCEPTION_IF_NULL(dst);
+  MS_EXCEPTION_IF_NULL(src);
+  if (size > 0 && memcpy_s(dst, size, src, size) != EOK) {
+    MS_LOG(EXCEPTION) << "Copy device memory to host failed, size:" << size;
+  }
+}
+
+void CPUPsCache::HashSwapOut(void *hash_table_addr, void *swap_out_value_addr, void *swap_out_index_addr, size_t,
+                             size_t embedding_size, size_t swap_out_size) {
+  MS_EXCEPTION_IF_NULL(hash_table_addr);
+  MS_EXCEPTION_IF_NULL(swap_out_value_addr);
+  MS_EXCEPTION_IF_NULL(swap_out_index_addr);
+  auto hash_table = reinterpret_cast<const float *>(hash_table_addr);
+  auto swap_out_value = reinterpret_cast<float *>(swap_out_value_addr);
+  auto swap_out_index = reinterpret_cast<const int *>(swap_out_index_addr);
+  size_t row_size = embedding_size * sizeof(float);
+  for (size_t i = 0; i < swap_out_size; i++) {
+    if (swap_out_index[i] < 0) {
+      continue;
+    }
+    auto ret = memcpy_s(swap_out_value + i * embedding_size, row_size,
+                        hash_table + IntToSize(swap_out_index[i]) * embedding_size, row_size);
+    if (ret != EOK) {
+      MS_LOG(EXCEPTION) << "Hash swap out memcpy failed.";
+    }
+  }
+}
+
+void CPUPsCache::HashSwapIn(void *hash_table_addr, void *swap_in_value_addr, void *swap_in_index_addr, size_t,
+                            size_t embedding_size, size_t swap_in_size) {
+  MS_EXCEPTION_IF_NULL(hash_table_addr);
+  MS_EXCEPTION_IF_NULL(swap_in_value_addr);
+  MS_EXCEPTION_IF_NULL(swap_in_index_addr);
+  auto hash_table = reinterpret_cast<float *>(hash_table_addr);
+  auto swap_in_value = reinterpret_cast<const float *>(swap_in_value_addr);
+  auto swap_in_index = reinterpret_cast<const int *>(swap_in_index_addr);
+  size_t row_size = embedding_size * sizeof(float);
+  for (size_t i = 0; i < swap_in_size; i++) {
+    if (swap_in_index[i] < 0) {
+      continue;
+    }
+    auto ret = memcpy_s(hash_table + IntToSize(swap_in_index[i]) * embedding_size, row_size,
+                        swap_in_value + i * embedding_size, row_size);
+    if (ret != EOK) {
+      MS_LOG(EXCEPTION) << "Hash swap in memcpy failed.";
+    }
+  }
+}
+}  // namespace cpu
+}  // namespace ps
+}  // namespace mindspore
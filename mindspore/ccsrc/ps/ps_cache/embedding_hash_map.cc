@@ -15,10 +15,81 @@
  */
 
 #include "ps/ps_cache/embedding_hash_map.h"
+#include <algorithm>
 
 namespace mindspore {
 namespace ps {
-int EmbeddingHashMap::ParseData(const int id, int *swap_out_index, int *swap_out_ids, const size_t data_step,
+IdIndexMap::IdIndexMap(size_t max_size) {
+  // The slot of an id is the high log2(table_size) bits of its fibonacci hash.
+  size_t table_size = kMinIdMapSize;
+  shift_ = 64 - 3;
+  while (table_size < 2 * max_size) {
+    table_size <<= 1;
+    shift_--;
+  }
+  mask_ = table_size - 1;
+  keys_.assign(table_size, kEmptyId);
+  values_.assign(table_size, INVALID_INDEX_VALUE);
+}
+
+int IdIndexMap::Find(int64_t id) const {
+  size_t pos = FindSlot(id);
+  return pos == keys_.size() ? INVALID_INDEX_VALUE : values_[pos];
+}
+
+size_t IdIndexMap::FindSlot(int64_t id) const {
+  size_t pos = Slot(id);
+  while (keys_[pos] != kEmptyId) {
+    if (keys_[pos] == id) {
+      return pos;
+    }
+    pos = (pos + 1) & mask_;
+  }
+  return keys_.size();
+}
+
+void IdIndexMap::Insert(int64_t id, int index) {
+  if (id == kEmptyId) {
+    MS_LOG(EXCEPTION) << "The id " << id << " is reserved for the empty slots.";
+  }
+  if (2 * (size_ + 1) > keys_.size()) {
+    MS_LOG(EXCEPTION) << "The id index map is full, size: " << size_ << ", slots: " << keys_.size();
+  }
+  size_t pos = Slot(id);
+  while (keys_[pos] != kEmptyId) {
+    pos = (pos + 1) & mask_;
+  }
+  keys_[pos] = id;
+  values_[pos] = index;
+  size_++;
+}
+
+void IdIndexMap::Erase(int64_t id) {
+  size_t hole = FindSlot(id);
+  if (hole == keys_.size()) {
+    return;
+  }
+  // Move back every following key of the probe which may not skip the hole, the probes need no tombstones then.
+  for (size_t pos = (hole + 1) & mask_; keys_[pos] != kEmptyId; pos = (pos + 1) & mask_) {
+    size_t home = Slot(keys_[pos]);
+    if (((pos - home) & mask_) >= ((pos - hole) & mask_)) {
+      keys_[hole] = keys_[pos];
+      values_[hole] = values_[pos];
+      hole = pos;
+    }
+  }
+  keys_[hole] = kEmptyId;
+  values_[hole] = INVALID_INDEX_VALUE;
+  size_--;
+}
+
+void IdIndexMap::Clear() {
+  std::fill(keys_.begin(), keys_.end(), kEmptyId);
+  std::fill(values_.begin(), values_.end(), INVALID_INDEX_VALUE);
+  size_ = 0;
+}
+
+int EmbeddingHashMap::ParseData(const int64_t id, int *swap_out_index, int64_t *swap_out_ids, const size_t data_step,
                                 const size_t graph_running_step, size_t *swap_out_size) {
   MS_EXCEPTION_IF_NULL(swap_out_index);
   MS_EXCEPTION_IF_NULL(swap_out_ids);
@@ -32,7 +103,7 @@ int EmbeddingHashMap::ParseData(const int id, int *swap_out_index, int *swap_out
     }
     if (hash_map_unit_[hash_index].IsEmpty()) {
       hash_count_++;
-      (void)hash_id_to_index_.emplace(id, hash_index);
+      hash_id_to_index_.Insert(id, hash_index);
       hash_map_unit_[hash_index].set_id(id);
       hash_map_unit_[hash_index].set_step(data_step);
       return hash_index;
@@ -41,8 +112,8 @@ int EmbeddingHashMap::ParseData(const int id, int *swap_out_index, int *swap_out
       swap_out_index[*swap_out_size] = hash_index;
       swap_out_ids[*swap_out_size] = hash_map_unit_[hash_index].id_;
       (*swap_out_size)++;
-      (void)hash_id_to_index_.erase(hash_map_unit_[hash_index].id_);
-      (void)hash_id_to_index_.emplace(id, hash_index);
+      hash_id_to_index_.Erase(hash_map_unit_[hash_index].id_);
+      hash_id_to_index_.Insert(id, hash_index);
       hash_map_unit_[hash_index].set_id(id);
       hash_map_unit_[hash_index].set_step(data_step);
       return hash_index;
@@ -54,9 +125,7 @@ int EmbeddingHashMap::ParseData(const int id, int *swap_out_index, int *swap_out
 void EmbeddingHashMap::DumpHashMap() {
   MS_LOG(INFO) << "Dump hash map info begin, hash_capacity: " << hash_capacity_ << " hash_count: " << hash_count_;
   MS_LOG(INFO) << "Dump hash_id_to_index: ";
-  for (auto iter = hash_id_to_index_.begin(); iter != hash_id_to_index_.end(); ++iter) {
-    MS_LOG(INFO) << "  id: " << iter->first << " index: " << iter->second;
-  }
+  hash_id_to_index_.ForEach([](int64_t id, int index) { MS_LOG(INFO) << "  id: " << id << " index: " << index; });
   MS_LOG(INFO) << "Dump hash_map_unit: ";
   for (size_t i = 0; i < hash_map_unit_.size(); i++) {
     if (!hash_map_unit_[i].IsEmpty()) {
@@ -18,50 +18,96 @@
 #define MINDSPORE_CCSRC_PS_PS_CACHE_EMBEDDING_HASH_MAP_H_
 
 #include <math.h>
+#include <cstdint>
 #include <utility>
 #include <memory>
 #include <vector>
-#include <unordered_map>
 #include "utils/convert_utils_base.h"
 
 namespace mindspore {
 namespace ps {
 static const size_t INVALID_STEP_VALUE = 0;
 static const int INVALID_INDEX_VALUE = -1;
+// 2^64 divided by the golden ratio, the multiplier of the fibonacci hashing.
+static const uint64_t kFibonacciMultiplier = 0x9E3779B97F4A7C15ULL;
+// Marks the empty slots of IdIndexMap, it is not a valid id.
+static const int64_t kEmptyId = INT64_MIN;
+static const size_t kMinIdMapSize = 8;
 
 struct HashMapElement {
-  int id_;
+  int64_t id_;
   size_t step_;
   bool IsEmpty() const { return step_ == INVALID_STEP_VALUE; }
   bool IsExpired(size_t graph_running_step) const { return graph_running_step > step_; }
-  void set_id(int id) { id_ = id; }
+  void set_id(int64_t id) { id_ = id; }
   void set_step(size_t step) { step_ = step; }
 };
 
+// Open addressing map from ids to indexes with linear probing. The keys are kept apart from the values, so a probe
+// scans adjacent keys in one cache line mostly. Erasing shifts the following keys of the probe back instead of
+// leaving tombstones, so the probes stay short under the constant eviction of the cache.
+class IdIndexMap {
+ public:
+  // The table has at least twice the slots of max_size, a probe ends at an empty slot soon.
+  explicit IdIndexMap(size_t max_size);
+  ~IdIndexMap() = default;
+  // Return INVALID_INDEX_VALUE if the id is not in the map.
+  int Find(int64_t id) const;
+  // The id should not be in the map.
+  void Insert(int64_t id, int index);
+  void Erase(int64_t id);
+  void Clear();
+  size_t size() const { return size_; }
+  size_t slot_num() const { return keys_.size(); }
+  template <typename Func>
+  void ForEach(Func &&func) const {
+    for (size_t i = 0; i < keys_.size(); i++) {
+      if (keys_[i] != kEmptyId) {
+        func(keys_[i], values_[i]);
+      }
+    }
+  }
+
+ private:
+  size_t Slot(int64_t id) const {
+    return static_cast<size_t>((static_cast<uint64_t>(id) * kFibonacciMultiplier) >> shift_);
+  }
+  size_t FindSlot(int64_t id) const;
+  std::vector<int64_t> keys_;
+  std::vector<int> values_;
+  size_t mask_;
+  size_t shift_;
+  size_t size_{0};
+};
+
 // Hash table is held in device, HashMap is used to manage hash table in host.
 class EmbeddingHashMap {
  public:
-  EmbeddingHashMap(size_t hash_count, size_t hash_capacity) : hash_count_(hash_count), hash_capacity_(hash_capacity) {
+  EmbeddingHashMap(size_t hash_count, size_t hash_capacity)
+      : hash_count_(hash_count), hash_capacity_(hash_capacity), hash_id_to_index_(hash_capacity) {
     hash_map_unit_.resize(hash_capacity);
   }
   virtual ~EmbeddingHashMap() = default;
-  int ParseData(const int id, int *swap_out_index, int *swap_out_ids, const size_t data_step,
+  int ParseData(const int64_t id, int *swap_out_index, int64_t *swap_out_ids, const size_t data_step,
                 const size_t graph_running_step, size_t *swap_out_size);
-  std::unordered_map<int, int>::const_iterator id_iter(const int id) const { return hash_id_to_index_.find(id); }
-  bool IsIdExist(const std::unordered_map<int, int>::const_iterator iter) const {
-    return iter != hash_id_to_index_.end();
-  }
+  // Return the index of the id in the hash table, or INVALID_INDEX_VALUE if it is not cached. Lookups of different
+  // ids may run concurrently as long as no ParseData runs with them.
+  int GetIndex(const int64_t id) const { return hash_id_to_index_.Find(id); }
   size_t hash_step(const int hash_index) const { return hash_map_unit_[hash_index].step_; }
   void set_hash_step(const int hash_index, const size_t step) { hash_map_unit_[hash_index].set_step(step); }
   void DumpHashMap();
 
  private:
-  int Hash(const int id) { return static_cast<int>((0.6180339 * id - std::floor(0.6180339 * id)) * hash_capacity_); }
+  // Fibonacci hashing in integers, the high 32 bits of the product are scaled to the capacity.
+  int Hash(const int64_t id) const {
+    uint64_t hash = (static_cast<uint64_t>(id) * kFibonacciMultiplier) >> 32;
+    return static_cast<int>((hash * hash_capacity_) >> 32);
+  }
   bool NeedSwap() const { return hash_count_ > FloatToSize(hash_capacity_ * 0.9); }
   size_t hash_count_;
   size_t hash_capacity_;
   std::vector<HashMapElement> hash_map_unit_;
-  std::unordered_map<int, int> hash_id_to_index_;
+  IdIndexMap hash_id_to_index_;
 };
 }  // namespace ps
 }  // namespace mindspore
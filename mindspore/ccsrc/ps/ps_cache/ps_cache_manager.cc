@@ -15,13 +15,47 @@
  */
 
 #include <algorithm>
+#include <atomic>
+#include <climits>
 #include "ps/ps_cache/ps_cache_manager.h"
+#include "ps/ps_context.h"
 #include "utils/log_adapter.h"
 #include "utils/ms_utils.h"
 
 using mindspore::kernel::Address;
 namespace mindspore {
 namespace ps {
+namespace {
+class PsWorker : public PsCacheWorker {
+ public:
+  PsWorker() = default;
+  ~PsWorker() override = default;
+  void Start() override {
+    if (!worker.running()) {
+      Util::SetInternalEnvVar();
+      worker.Run();
+    }
+  }
+  size_t worker_num() const override { return IntToSize(::ps::NumWorkers()); }
+  size_t rank_id() const override { return IntToSize(::ps::MyRank()); }
+  size_t SetParamKey(const std::string &param_name) override { return worker.SetParamKey(param_name); }
+  size_t GetParamKey(const std::string &param_name) override { return worker.GetParamKey(param_name); }
+  void AddEmbeddingTable(size_t key, size_t row_count) override { worker.AddEmbeddingTable(key, row_count); }
+  void InitEmbeddingTable(const std::vector<size_t> &keys, const std::vector<float> &values,
+                          const std::vector<int64_t> &lens) override {
+    worker.InitPSEmbeddingTable(keys, values, lens);
+  }
+  void EmbeddingLookup(size_t key, const ::ps::SArray<int> &lookup_ids, const ::ps::SArray<int> &lengths,
+                       ::ps::SArray<float> *lookup_result) override {
+    worker.DoPSEmbeddingLookup({key}, lookup_ids, lengths, lookup_result, mindspore::ps::kEmbeddingLookupCmd);
+  }
+  void UpdateEmbeddingTable(size_t key, const ::ps::SArray<int> &lookup_ids,
+                            const ::ps::SArray<float> &values) override {
+    worker.UpdateEmbeddingTable({key}, lookup_ids, values);
+  }
+};
+}  // namespace
+
 void PsCacheManager::InsertHashTableSize(const std::string &param_name, size_t cache_vocab_size, size_t embedding_size,
                                          size_t vocab_size) {
   if (cache_vocab_size == 0 || embedding_size == 0 || vocab_size == 0) {
@@ -132,25 +166,36 @@ const Address &PsCacheManager::QueryHashTableAddr(const std::string &param_name)
 
 void PsCacheManager::Initialize() {
   MS_LOG(INFO) << "PS cache initialize.";
-  if (!worker.running()) {
-    Util::SetInternalEnvVar();
-    worker.Run();
+  if (worker_ == nullptr) {
+    worker_ = std::make_shared<PsWorker>();
   }
+  worker_->Start();
   embedding_device_cache_ = std::make_shared<EmbeddingDeviceCache>(batch_elements_, cache_vocab_size_);
   embedding_host_cache_ = std::make_shared<EmbeddingHostCache>(batch_elements_, host_cache_vocab_size_);
   AddEmbeddingTable();
   AllocMemForHashTable();
   SetLocalIdRank();
+  pipeline_ = std::make_unique<PsCachePipeline<PsCacheSwapPlanPtr>>(kPsCachePipelineDepth);
+  // The calling thread takes a part of the tasks too, a single core runs them all on the calling thread.
+  size_t thread_num = std::min(kMaxThreadNum, static_cast<size_t>(std::thread::hardware_concurrency()));
+  if (thread_num > 1) {
+    thread_pool_ = std::make_unique<ServerThreadPool>(thread_num - 1);
+  }
+  auto ps_context = PSContext::instance();
+  if (ps_context->embedding_storage() == kEmbeddingStorageDynamic && ps_context->embedding_admit_threshold() > 1) {
+    admit_threshold_ = LongToSize(ps_context->embedding_admit_threshold());
+    admit_sketch_ = std::make_unique<CountMinSketch>(kAdmitSketchWidth, kAdmitSketchDepth);
+  }
   initialized_ps_cache_ = true;
 }
 
 void PsCacheManager::AddEmbeddingTable() const {
   for (const auto &item : hash_tables_) {
     const auto &param_name = item.first;
-    size_t key = worker.SetParamKey(param_name);
+    size_t key = worker_->SetParamKey(param_name);
     size_t row_count = item.second.vocab_size;
     // if worker role
-    worker.AddEmbeddingTable(key, row_count);
+    worker_->AddEmbeddingTable(key, row_count);
   }
 }
 
@@ -160,7 +205,7 @@ void PsCacheManager::InitParameterServer() {
 
   for (const auto &item : hash_tables_) {
     const auto &param_name = item.first;
-    size_t key = worker.SetParamKey(param_name);
+    size_t key = worker_->SetParamKey(param_name);
     std::vector<size_t> keys{key, key, key, key, key, key};
     std::vector<float> values{
       SizeToFloat(item.second.vocab_size), SizeToFloat(item.second.embedding_size), 1, 1, 1, 1, 1};
@@ -176,7 +221,7 @@ void PsCacheManager::InitParameterServer() {
     lens.push_back(param_init_info.global_seed_);
     lens.push_back(param_init_info.op_seed_);
     // if worker role
-    worker.InitPSEmbeddingTable(keys, values, lens);
+    worker_->InitEmbeddingTable(keys, values, lens);
   }
 
   finish_init_parameter_server_ = true;
@@ -213,8 +258,8 @@ void PsCacheManager::AllocMemForHashTable() {
 }
 
 void PsCacheManager::SetLocalIdRank() {
-  auto worker_num = ::ps::NumWorkers();
-  auto worker_id = ::ps::MyRank();
+  auto worker_num = worker_->worker_num();
+  auto worker_id = worker_->rank_id();
   auto local_shard_size = FloatToSize(std::ceil(SizeToFloat(vocab_size_) / worker_num));
   range_bound_.first = local_shard_size * worker_id;
   range_bound_.second = std::min(range_bound_.first + local_shard_size, vocab_size_);
@@ -255,6 +300,24 @@ void PsCacheManager::IncreaseGraphStep(const std::string &channel_name) {
   set_channel_name(channel_name);
   PsDataPrefetch::GetInstance().TryWakeChannel(channel_name);
   data_prase_.notify_one();
+  // The graph of the step reads the hash tables, its swaps should be done.
+  WaitSwapFinish(graph_step_);
+}
+
+void PsCacheManager::WaitSwapFinish(size_t step) {
+  if (pipeline_ == nullptr) {
+    return;
+  }
+  auto start_time = std::chrono::steady_clock::now();
+  for (int i = 0; i < 10; i++) {
+    if (pipeline_->WaitStep(step, std::chrono::seconds(30))) {
+      profiler_.Record(kGraphWaitPhase, std::chrono::steady_clock::now() - start_time);
+      return;
+    }
+    MS_LOG(INFO) << "Waiting for ps cache swap, graph step:" << step << "...(" << i << " / 10)";
+  }
+  MS_LOG(EXCEPTION) << "Ps cache swap timeout(graph step:" << step
+                    << ", swapped data step:" << pipeline_->finished_step() << ").";
 }
 
 void PsCacheManager::DoProcessData(uint32_t device_id, void *context) {
@@ -266,21 +329,28 @@ void PsCacheManager::DoProcessData(uint32_t device_id, void *context) {
 }
 
 void PsCacheManager::ProcessDataTask(uint32_t device_id, void *context) {
-  MS_EXCEPTION_IF_NULL(embedding_device_cache_);
-  MS_EXCEPTION_IF_NULL(embedding_device_cache_->cache_);
-  embedding_device_cache_->cache_->InitDevice(device_id, context);
+  StartPipeline(device_id, context);
   InitParameterServer();
   while (true) {
     ProcessData();
   }
 }
 
-void PsCacheManager::ProcessData() {
+void PsCacheManager::StartPipeline(uint32_t device_id, void *context) {
   MS_EXCEPTION_IF_NULL(embedding_device_cache_);
   MS_EXCEPTION_IF_NULL(embedding_device_cache_->cache_);
-  struct timeval start_time, end_time;
-  const uint64_t kUSecondInSecond = 1000000;
-  (void)gettimeofday(&start_time, nullptr);
+  MS_EXCEPTION_IF_NULL(pipeline_);
+  // This thread parses the ids of the steps, the swaps of a step with the server and with the device run in two more
+  // threads, which work on the earlier steps meanwhile.
+  pipeline_->AddStage("server", [this](size_t, const PsCacheSwapPlanPtr &plan) { SwapHostAndServer(*plan); });
+  pipeline_->AddStage(
+    "device", [this](size_t, const PsCacheSwapPlanPtr &plan) { SwapDeviceAndHost(*plan); },
+    [this, device_id, context]() { embedding_device_cache_->cache_->InitDevice(device_id, context); });
+  pipeline_->Start();
+}
+
+void PsCacheManager::ProcessData() {
+  MS_EXCEPTION_IF_NULL(pipeline_);
   auto channel = channel_name();
   if (channel.empty()) {
     std::unique_lock<std::mutex> locker(data_mutex_);
@@ -293,8 +363,22 @@ void PsCacheManager::ProcessData() {
     (void)data_prase_.wait_for(locker, std::chrono::milliseconds(100));
     return;
   }
-  IncreaseStep();
   auto data_size = PsDataPrefetch::GetInstance().data_size(channel_name_);
+  ProcessBatch(data, data_size);
+  // Finish the data process and notify data prefetch.
+  PsDataPrefetch::GetInstance().FinalizeData(channel_name_);
+  if (data_step_ % kPsCacheProfileInterval == 0) {
+    MS_LOG(INFO) << "Ps cache average step time of the last " << kPsCacheProfileInterval
+                 << " steps: " << profiler_.Summary(kPsCacheProfileInterval) << ".";
+    profiler_.Reset();
+  }
+}
+
+void PsCacheManager::ProcessBatch(void *data, size_t data_size) {
+  MS_EXCEPTION_IF_NULL(data);
+  MS_EXCEPTION_IF_NULL(pipeline_);
+  auto start_time = std::chrono::steady_clock::now();
+  IncreaseStep();
   auto batch_ids = reinterpret_cast<int *>(data);
   auto batch_ids_len = data_size / sizeof(int);
   std::unique_ptr<int[]> hash_index(new int[batch_ids_len]);
@@ -303,56 +387,241 @@ void PsCacheManager::ProcessData() {
   }
   // Get hash swap in/out index and ids.
   ParseData(batch_ids, batch_ids_len, hash_index.get());
-  for (const auto &item : hash_tables_) {
-    auto key = worker.GetParamKey(item.first);
-    auto hash_info = item.second;
-    HashSwapHostToServer(key, hash_info);
-    HashSwapDeviceToHost(hash_info);
-    HashSwapServerToHost(key, hash_info);
-    HashSwapHostToDevice(hash_info);
-  }
+  auto plan = CreateSwapPlan();
   // Replace the batch_ids by hash index for getNext-op getting hash index as input.
   if (memcpy_s(data, data_size, hash_index.get(), data_size) != EOK) {
     MS_LOG(EXCEPTION) << "Process data memcpy failed.";
   }
+  auto parse_cost = std::chrono::steady_clock::now() - start_time;
+  profiler_.Record(kParsePhase, parse_cost);
+  MS_LOG(DEBUG) << "Ps cache completes parsing data(data step:" << data_step_ << ",graph step:" << graph_running_step_
+                << " channel name:" << channel_name_ << ", time cost:"
+                << std::chrono::duration_cast<std::chrono::milliseconds>(parse_cost).count() << "ms).";
+  // The swaps are left to the pipeline, the graph of the step waits for them in IncreaseGraphStep.
+  pipeline_->Push(data_step_, plan);
+}
+
+PsCacheSwapPlanPtr PsCacheManager::CreateSwapPlan() const {
+  MS_EXCEPTION_IF_NULL(embedding_device_cache_);
+  MS_EXCEPTION_IF_NULL(embedding_host_cache_);
+  auto plan = std::make_shared<PsCacheSwapPlan>();
+  auto copy_swap_index = [](const auto &src, size_t size, auto *dst) {
+    MS_EXCEPTION_IF_NULL(src);
+    dst->assign(src.get(), src.get() + size);
+  };
+  auto device_to_host_size = statistics_info_.device_to_host_size_;
+  auto host_to_device_size = statistics_info_.host_to_device_size_;
+  copy_swap_index(embedding_device_cache_->device_to_host_index, device_to_host_size,
+                  &plan->device_cache_device_to_host_index);
+  copy_swap_index(embedding_host_cache_->device_to_host_index, device_to_host_size,
+                  &plan->host_cache_device_to_host_index);
+  copy_swap_index(embedding_device_cache_->host_to_device_index, host_to_device_size,
+                  &plan->device_cache_host_to_device_index);
+  copy_swap_index(embedding_host_cache_->host_to_device_index, host_to_device_size,
+                  &plan->host_cache_host_to_device_index);
+  copy_swap_index(embedding_host_cache_->host_to_server_index, statistics_info_.host_to_server_size_,
+                  &plan->host_to_server_index);
+  copy_swap_index(embedding_host_cache_->host_to_server_ids, statistics_info_.host_to_server_size_,
+                  &plan->host_to_server_ids);
+  copy_swap_index(embedding_host_cache_->server_to_host_index, statistics_info_.server_to_host_size_,
+                  &plan->server_to_host_index);
+  copy_swap_index(embedding_host_cache_->server_to_host_ids, statistics_info_.server_to_host_size_,
+                  &plan->server_to_host_ids);
+  if (admit_sketch_ != nullptr) {
+    DropNotAdmittedIds(plan.get());
+  }
+  return plan;
+}
+
+// The servers create the rows of the dynamic tables by the pushes, so the rows of the ids which are not admitted
+// are dropped here, and their next lookups read the initial rows. An id whose count decays below the threshold is
+// cold again, like the rows the servers evict.
+void PsCacheManager::DropNotAdmittedIds(PsCacheSwapPlan *plan) const {
+  MS_EXCEPTION_IF_NULL(plan);
+  MS_EXCEPTION_IF_NULL(admit_sketch_);
+  size_t admitted_size = 0;
+  for (size_t i = 0; i < plan->host_to_server_ids.size(); i++) {
+    if (admit_sketch_->Estimate(plan->host_to_server_ids[i]) < admit_threshold_) {
+      continue;
+    }
+    plan->host_to_server_ids[admitted_size] = plan->host_to_server_ids[i];
+    plan->host_to_server_index[admitted_size] = plan->host_to_server_index[i];
+    admitted_size++;
+  }
+  plan->host_to_server_ids.resize(admitted_size);
+  plan->host_to_server_index.resize(admitted_size);
+}
+
+// The steps come in order, so the rows pushed by the earlier steps are on the server before the rows of this step
+// are pulled.
+void PsCacheManager::SwapHostAndServer(const PsCacheSwapPlan &plan) {
+  for (const auto &item : hash_tables_) {
+    auto key = worker_->GetParamKey(item.first);
+    const auto &hash_info = item.second;
+    auto start_time = std::chrono::steady_clock::now();
+    HashSwapHostToServer(key, hash_info, plan);
+    auto push_time = std::chrono::steady_clock::now();
+    profiler_.Record(kHostToServerPhase, push_time - start_time);
+    HashSwapServerToHost(key, hash_info, plan);
+    profiler_.Record(kServerToHostPhase, std::chrono::steady_clock::now() - push_time);
+  }
+}
+
+void PsCacheManager::SwapDeviceAndHost(const PsCacheSwapPlan &plan) {
+  MS_EXCEPTION_IF_NULL(embedding_device_cache_);
+  MS_EXCEPTION_IF_NULL(embedding_device_cache_->cache_);
+  for (const auto &item : hash_tables_) {
+    const auto &hash_info = item.second;
+    auto start_time = std::chrono::steady_clock::now();
+    HashSwapDeviceToHost(hash_info, plan);
+    auto swap_out_time = std::chrono::steady_clock::now();
+    profiler_.Record(kDeviceToHostPhase, swap_out_time - start_time);
+    HashSwapHostToDevice(hash_info, plan);
+    profiler_.Record(kHostToDevicePhase, std::chrono::steady_clock::now() - swap_out_time);
+  }
+  auto sync_time = std::chrono::steady_clock::now();
   embedding_device_cache_->cache_->SynchronizeStream();
-  // Finish the data process and notify data prefetch.
-  PsDataPrefetch::GetInstance().FinalizeData(channel_name_);
-  (void)gettimeofday(&end_time, nullptr);
-  uint64_t cost = kUSecondInSecond * static_cast<uint64_t>(end_time.tv_sec - start_time.tv_sec);
-  cost += static_cast<uint64_t>(end_time.tv_usec - start_time.tv_usec);
-  MS_LOG(DEBUG) << "Ps cache completes processing data(data step:" << data_step_
-                << ",graph step:" << graph_running_step_ << " channel name:" << channel_name_
-                << ", time cost:" << cost / 1000 << "ms).";
+  profiler_.Record(kHostToDevicePhase, std::chrono::steady_clock::now() - sync_time);
 }
 
 void PsCacheManager::ParseData(const int *batch_ids, const size_t batch_ids_len, int *hash_index) {
   MS_EXCEPTION_IF_NULL(batch_ids);
   MS_EXCEPTION_IF_NULL(hash_index);
+  // The deduplication pays off only when the lookups are split over the thread pool.
+  if (thread_pool_ == nullptr || batch_ids_len < kParallelTaskSize) {
+    ParseDataInTurn(batch_ids, batch_ids_len, hash_index);
+  } else {
+    ParseUniqueData(batch_ids, batch_ids_len, hash_index);
+  }
+  // Each 1000 step prints ps cache hit rate.
+  if (data_step_ % 1000 == 0) {
+    statistics_info_.batch_id_unique_count_ = statistics_info_.hash_hit_count_ + statistics_info_.host_to_device_size_;
+    auto hit_rate = SizeToFloat(statistics_info_.hash_hit_count_) / statistics_info_.batch_id_unique_count_;
+    MS_LOG(INFO) << "Ps cache hit rate: " << hit_rate * 100 << "%.";
+  }
+}
+
+void PsCacheManager::ParseDataInTurn(const int *batch_ids, const size_t batch_ids_len, int *hash_index) {
+  MS_EXCEPTION_IF_NULL(embedding_device_cache_);
+  auto device_hash_map = embedding_device_cache_->device_hash_map_;
+  MS_EXCEPTION_IF_NULL(device_hash_map);
+  // The hit ids are marked with the current step before any slot is taken, a repeated id is counted once.
   for (size_t i = 0; i < batch_ids_len; i++) {
+    int64_t id = batch_ids[i];
+    if (id < 0 || static_cast<size_t>(id) < range_bound_.first || static_cast<size_t>(id) >= range_bound_.second) {
+      hash_index[i] = INVALID_INDEX_VALUE;
+      continue;
+    }
+    if (admit_sketch_ != nullptr) {
+      (void)admit_sketch_->Add(id);
+    }
+    auto index = device_hash_map->GetIndex(id);
+    if (index != INVALID_INDEX_VALUE && device_hash_map->hash_step(index) != data_step_) {
+      device_hash_map->set_hash_step(index, data_step_);
+      statistics_info_.hash_hit_count_++;
+    }
+    hash_index[i] = index;
+  }
+  // The misses take slots in turn, a repeated miss finds the slot its first occurrence took.
+  for (size_t i = 0; i < batch_ids_len; i++) {
+    int64_t id = batch_ids[i];
+    if (hash_index[i] != INVALID_INDEX_VALUE || id < 0 || static_cast<size_t>(id) < range_bound_.first ||
+        static_cast<size_t>(id) >= range_bound_.second) {
+      continue;
+    }
     bool need_swap_host_to_device = true;
     bool need_swap_device_to_host = true;
-    auto id = batch_ids[i];
-    if ((id < SizeToInt(range_bound_.first)) || (id >= SizeToInt(range_bound_.second))) {
-      hash_index[i] = -1;
+    hash_index[i] = ParseDeviceData(id, &need_swap_device_to_host, &need_swap_host_to_device);
+    if (need_swap_host_to_device) {
+      ParseHostDataHostToDevice(id);
+    }
+    if (need_swap_device_to_host) {
+      ParseHostDataDeviceToHost();
+    }
+  }
+}
+
+void PsCacheManager::ParseUniqueData(const int *batch_ids, const size_t batch_ids_len, int *hash_index) {
+  // Deduplicate the ids of the batch, each id is looked up and swapped once.
+  std::vector<int64_t> unique_ids;
+  std::vector<int> unique_pos(batch_ids_len, INVALID_INDEX_VALUE);
+  IdIndexMap id_to_unique_pos(batch_ids_len);
+  for (size_t i = 0; i < batch_ids_len; i++) {
+    int64_t id = batch_ids[i];
+    if (id < 0 || static_cast<size_t>(id) < range_bound_.first || static_cast<size_t>(id) >= range_bound_.second) {
       continue;
     }
-    hash_index[i] = ParseDeviceData(id, &need_swap_device_to_host, &need_swap_host_to_device);
+    if (admit_sketch_ != nullptr) {
+      (void)admit_sketch_->Add(id);
+    }
+    auto pos = id_to_unique_pos.Find(id);
+    if (pos == INVALID_INDEX_VALUE) {
+      pos = SizeToInt(unique_ids.size());
+      id_to_unique_pos.Insert(id, pos);
+      unique_ids.push_back(id);
+    }
+    unique_pos[i] = pos;
+  }
+  // The hit ids are marked with the current step before any slot is taken, so they are not swapped out by the misses.
+  std::vector<int> unique_index(unique_ids.size(), INVALID_INDEX_VALUE);
+  statistics_info_.hash_hit_count_ += LookUpDeviceHashMap(unique_ids, &unique_index);
+  // The misses take slots and plan the swaps in turn, as each of them changes the hash maps.
+  for (size_t i = 0; i < unique_ids.size(); i++) {
+    if (unique_index[i] != INVALID_INDEX_VALUE) {
+      continue;
+    }
+    bool need_swap_host_to_device = true;
+    bool need_swap_device_to_host = true;
+    auto id = unique_ids[i];
+    unique_index[i] = ParseDeviceData(id, &need_swap_device_to_host, &need_swap_host_to_device);
     if (need_swap_host_to_device) {
       ParseHostDataHostToDevice(id);
     }
     if (need_swap_device_to_host) {
-      ParseHostDataDeviceToHost(id);
+      ParseHostDataDeviceToHost();
     }
   }
-  // Each 1000 step prints ps cache hit rate.
-  if (data_step_ % 1000 == 0) {
-    statistics_info_.batch_id_unique_count_ = statistics_info_.hash_hit_count_ + statistics_info_.host_to_device_size_;
-    auto hit_rate = SizeToFloat(statistics_info_.hash_hit_count_) / statistics_info_.batch_id_unique_count_;
-    MS_LOG(INFO) << "Ps cache hit rate: " << hit_rate * 100 << "%.";
+  for (size_t i = 0; i < batch_ids_len; i++) {
+    hash_index[i] = unique_pos[i] == INVALID_INDEX_VALUE ? INVALID_INDEX_VALUE : unique_index[unique_pos[i]];
   }
 }
 
+size_t PsCacheManager::LookUpDeviceHashMap(const std::vector<int64_t> &ids, std::vector<int> *indexes) {
+  MS_EXCEPTION_IF_NULL(indexes);
+  MS_EXCEPTION_IF_NULL(embedding_device_cache_);
+  auto device_hash_map = embedding_device_cache_->device_hash_map_;
+  MS_EXCEPTION_IF_NULL(device_hash_map);
+  std::atomic<size_t> hit_count{0};
+  ParallelRun(ids.size(), [this, &device_hash_map, &ids, indexes, &hit_count](size_t begin, size_t end) {
+    size_t task_hit_count = 0;
+    for (size_t i = begin; i < end; i++) {
+      auto index = device_hash_map->GetIndex(ids[i]);
+      if (index != INVALID_INDEX_VALUE) {
+        device_hash_map->set_hash_step(index, data_step_);
+        task_hit_count++;
+      }
+      (*indexes)[i] = index;
+    }
+    hit_count += task_hit_count;
+  });
+  return hit_count;
+}
+
+void PsCacheManager::ParallelRun(size_t size, const std::function<void(size_t, size_t)> &task) {
+  size_t task_num = std::min(size / kParallelTaskSize + 1, kMaxThreadNum);
+  if (task_num == 1 || thread_pool_ == nullptr) {
+    task(0, size);
+    return;
+  }
+  size_t task_size = (size + task_num - 1) / task_num;
+  thread_pool_->ParallelFor(task_num, [size, task_size, &task](size_t i) {
+    size_t begin = i * task_size;
+    if (begin < size) {
+      task(begin, std::min(begin + task_size, size));
+    }
+  });
+}
+
 void PsCacheManager::WaitGraphRun() {
   MS_LOG(INFO) << "Hash table has no space to insert new data and retries within 2 minutes.";
   std::unique_lock<std::mutex> locker(data_mutex_);
@@ -363,14 +632,14 @@ void PsCacheManager::WaitGraphRun() {
   set_current_graph_step();
 }
 
-int PsCacheManager::ParseDeviceData(size_t id, bool *need_swap_device_to_host, bool *need_swap_host_to_device) {
+int PsCacheManager::ParseDeviceData(int64_t id, bool *need_swap_device_to_host, bool *need_swap_host_to_device) {
   MS_EXCEPTION_IF_NULL(need_swap_device_to_host);
   MS_EXCEPTION_IF_NULL(need_swap_host_to_device);
   MS_EXCEPTION_IF_NULL(embedding_device_cache_);
   int *device_to_host_index = embedding_device_cache_->device_to_host_index.get();
-  int *device_to_host_ids = embedding_device_cache_->device_to_host_ids.get();
+  int64_t *device_to_host_ids = embedding_device_cache_->device_to_host_ids.get();
   int *host_to_device_index = embedding_device_cache_->host_to_device_index.get();
-  int *host_to_device_ids = embedding_device_cache_->host_to_device_ids.get();
+  int64_t *host_to_device_ids = embedding_device_cache_->host_to_device_ids.get();
   MS_EXCEPTION_IF_NULL(device_to_host_index);
   MS_EXCEPTION_IF_NULL(device_to_host_ids);
   MS_EXCEPTION_IF_NULL(host_to_device_index);
@@ -378,12 +647,10 @@ int PsCacheManager::ParseDeviceData(size_t id, bool *need_swap_device_to_host, b
 
   auto device_hash_map = embedding_device_cache_->device_hash_map_;
   MS_EXCEPTION_IF_NULL(device_hash_map);
-  int index = 0;
-  auto iter = device_hash_map->id_iter(id);
-  if (device_hash_map->IsIdExist(iter)) {
+  int index = device_hash_map->GetIndex(id);
+  if (index != INVALID_INDEX_VALUE) {
     *need_swap_device_to_host = false;
     *need_swap_host_to_device = false;
-    index = iter->second;
     if (device_hash_map->hash_step(index) != data_step_) {
       statistics_info_.hash_hit_count_++;
       device_hash_map->set_hash_step(index, data_step_);
@@ -407,12 +674,12 @@ int PsCacheManager::ParseDeviceData(size_t id, bool *need_swap_device_to_host, b
   return index;
 }
 
-void PsCacheManager::ParseHostDataHostToDevice(size_t id) {
+void PsCacheManager::ParseHostDataHostToDevice(int64_t id) {
   MS_EXCEPTION_IF_NULL(embedding_host_cache_);
   int *host_to_server_index = embedding_host_cache_->host_to_server_index.get();
-  int *host_to_server_ids = embedding_host_cache_->host_to_server_ids.get();
+  int64_t *host_to_server_ids = embedding_host_cache_->host_to_server_ids.get();
   int *server_to_host_index = embedding_host_cache_->server_to_host_index.get();
-  int *server_to_host_ids = embedding_host_cache_->server_to_host_ids.get();
+  int64_t *server_to_host_ids = embedding_host_cache_->server_to_host_ids.get();
   int *host_to_device_index = embedding_host_cache_->host_to_device_index.get();
   MS_EXCEPTION_IF_NULL(host_to_server_index);
   MS_EXCEPTION_IF_NULL(host_to_server_ids);
@@ -422,17 +689,16 @@ void PsCacheManager::ParseHostDataHostToDevice(size_t id) {
 
   auto host_hash_map = embedding_host_cache_->host_hash_map_;
   MS_EXCEPTION_IF_NULL(host_hash_map);
-  auto iter = host_hash_map->id_iter(id);
-  if (host_hash_map->IsIdExist(iter)) {
-    auto index = iter->second;
+  auto index = host_hash_map->GetIndex(id);
+  if (index != INVALID_INDEX_VALUE) {
     if (host_hash_map->hash_step(index) != data_step_) {
       host_hash_map->set_hash_step(index, data_step_);
     }
     host_to_device_index[statistics_info_.host_to_device_size_ - 1] = index;
   } else {
     while (true) {
-      auto index = host_hash_map->ParseData(id, host_to_server_index, host_to_server_ids, data_step_,
-                                            graph_running_step_, &statistics_info_.host_to_server_size_);
+      index = host_hash_map->ParseData(id, host_to_server_index, host_to_server_ids, data_step_, graph_running_step_,
+                                       &statistics_info_.host_to_server_size_);
       if (index == INVALID_INDEX_VALUE) {
         WaitGraphRun();
         continue;
@@ -445,12 +711,12 @@ void PsCacheManager::ParseHostDataHostToDevice(size_t id) {
   }
 }
 
-void PsCacheManager::ParseHostDataDeviceToHost(size_t id) {
+void PsCacheManager::ParseHostDataDeviceToHost() {
   MS_EXCEPTION_IF_NULL(embedding_device_cache_);
   MS_EXCEPTION_IF_NULL(embedding_host_cache_);
-  int *device_to_host_ids = embedding_device_cache_->device_to_host_ids.get();
+  int64_t *device_to_host_ids = embedding_device_cache_->device_to_host_ids.get();
   int *host_to_server_index = embedding_host_cache_->host_to_server_index.get();
-  int *host_to_server_ids = embedding_host_cache_->host_to_server_ids.get();
+  int64_t *host_to_server_ids = embedding_host_cache_->host_to_server_ids.get();
   int *device_to_host_index = embedding_host_cache_->device_to_host_index.get();
   MS_EXCEPTION_IF_NULL(device_to_host_ids);
   MS_EXCEPTION_IF_NULL(host_to_server_index);
@@ -459,18 +725,17 @@ void PsCacheManager::ParseHostDataDeviceToHost(size_t id) {
 
   auto host_hash_map = embedding_host_cache_->host_hash_map_;
   MS_EXCEPTION_IF_NULL(host_hash_map);
-  int swap_device_to_host_id = device_to_host_ids[statistics_info_.device_to_host_size_ - 1];
-  auto iter = host_hash_map->id_iter(swap_device_to_host_id);
-  if (host_hash_map->IsIdExist(iter)) {
-    auto index = iter->second;
+  int64_t swap_device_to_host_id = device_to_host_ids[statistics_info_.device_to_host_size_ - 1];
+  auto index = host_hash_map->GetIndex(swap_device_to_host_id);
+  if (index != INVALID_INDEX_VALUE) {
     if (host_hash_map->hash_step(index) != data_step_) {
       host_hash_map->set_hash_step(index, data_step_);
     }
     device_to_host_index[statistics_info_.device_to_host_size_ - 1] = index;
   } else {
     while (true) {
-      auto index = host_hash_map->ParseData(id, host_to_server_index, host_to_server_ids, data_step_,
-                                            graph_running_step_, &statistics_info_.host_to_server_size_);
+      index = host_hash_map->ParseData(swap_device_to_host_id, host_to_server_index, host_to_server_ids, data_step_,
+                                       graph_running_step_, &statistics_info_.host_to_server_size_);
       if (index == INVALID_INDEX_VALUE) {
         WaitGraphRun();
         continue;
@@ -507,81 +772,36 @@ void PsCacheManager::LookUpHostHashTable(size_t embedding_size, size_t indices_l
                                          const int *indices_addr, float *output_addr) {
   size_t first_dim_size = host_cache_vocab_size_;
   size_t outer_dim_size = embedding_size;
-
-  size_t thread_num = indices_lens / 10000 + 1;
-  thread_num = thread_num > kMaxThreadNum ? kMaxThreadNum : thread_num;
-  std::thread threads[kMaxThreadNum];
-  size_t task_proc_lens = (indices_lens + thread_num - 1) / thread_num;
-  size_t i;
-  size_t task_offset = 0;
-  MS_LOG(DEBUG) << "Indices lens: " << indices_lens << ", one task proc lens:" << task_proc_lens;
-  for (i = 0; i < thread_num; i++) {
-    if (task_offset >= indices_lens) {
-      break;
-    }
-    MS_LOG(DEBUG) << "Task offset: " << task_offset << ", task process lens:" << task_proc_lens;
-    threads[i] = std::thread(&PsCacheManager::LookUpTableTask, this, task_proc_lens, outer_dim_size, first_dim_size,
-                             hash_table_addr, indices_addr + task_offset, output_addr + task_offset * outer_dim_size);
-    task_offset += task_proc_lens;
-    if (task_offset + task_proc_lens > indices_lens) {
-      task_proc_lens = indices_lens - task_offset;
-    }
-  }
-  for (size_t j = 0; j < i; j++) {
-    threads[j].join();
-  }
+  MS_LOG(DEBUG) << "Indices lens: " << indices_lens;
+  ParallelRun(indices_lens, [&](size_t begin, size_t end) {
+    LookUpTableTask(end - begin, outer_dim_size, first_dim_size, hash_table_addr, indices_addr + begin,
+                    output_addr + begin * outer_dim_size);
+  });
 }
 
-void PsCacheManager::InsertHostHashTable(size_t embedding_size, size_t insert_indices_size, int *insert_indices,
-                                         float *insert_data, float *hash_table_addr) {
+void PsCacheManager::InsertHostHashTable(size_t embedding_size, size_t insert_indices_size, const int *insert_indices,
+                                         const float *insert_data, float *hash_table_addr) {
   size_t first_dim_size = host_cache_vocab_size_;
-  size_t thread_num = insert_indices_size / 10000 + 1;
-  thread_num = thread_num > kMaxThreadNum ? kMaxThreadNum : thread_num;
-  std::thread threads[kMaxThreadNum];
-  size_t task_proc_lens = (insert_indices_size + thread_num - 1) / thread_num;
-  size_t i;
-  size_t task_offset = 0;
-
-  auto insert_hash_table_task = [](size_t insert_indices_size, size_t outer_dim_size, size_t first_dim_size,
-                                   int *insert_indices, float *insert_data, float *hash_table_addr) {
-    auto type_size = sizeof(float);
-    size_t lens = outer_dim_size * type_size;
-    for (size_t i = 0; i < insert_indices_size; ++i) {
+  size_t lens = embedding_size * sizeof(float);
+  ParallelRun(insert_indices_size, [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
       int index = insert_indices[i];
       if (index >= 0 && index < SizeToInt(first_dim_size)) {
-        auto ret = memcpy_s(hash_table_addr + index * outer_dim_size, lens, insert_data + i * outer_dim_size, lens);
+        auto ret = memcpy_s(hash_table_addr + index * embedding_size, lens, insert_data + i * embedding_size, lens);
         if (ret != EOK) {
           MS_LOG(EXCEPTION) << "Insert hash table task memcpy failed.";
         }
       }
     }
-  };
-
-  for (i = 0; i < thread_num; i++) {
-    if (task_offset >= insert_indices_size) {
-      break;
-    }
-    MS_LOG(DEBUG) << "Task offset: " << task_offset << ", task process lens:" << task_proc_lens;
-    threads[i] = std::thread(insert_hash_table_task, task_proc_lens, embedding_size, first_dim_size,
-                             insert_indices + task_offset, insert_data + task_offset * embedding_size, hash_table_addr);
-    task_offset += task_proc_lens;
-    if (task_offset + task_proc_lens > insert_indices_size) {
-      task_proc_lens = insert_indices_size - task_offset;
-    }
-  }
-
-  for (size_t j = 0; j < i; j++) {
-    threads[j].join();
-  }
+  });
 }
 
-void PsCacheManager::HashSwapHostToDevice(const HashTableInfo &hash_info) {
+void PsCacheManager::HashSwapHostToDevice(const HashTableInfo &hash_info, const PsCacheSwapPlan &plan) {
   MS_EXCEPTION_IF_NULL(embedding_device_cache_);
   MS_EXCEPTION_IF_NULL(embedding_device_cache_->cache_);
-  MS_EXCEPTION_IF_NULL(embedding_host_cache_);
-  auto host_cache_host_to_device_index = embedding_host_cache_->host_to_device_index.get();
-  auto device_cache_host_to_device_index = embedding_device_cache_->host_to_device_index.get();
-  auto swap_indices_size = statistics_info_.host_to_device_size_;
+  auto host_cache_host_to_device_index = plan.host_cache_host_to_device_index.data();
+  auto device_cache_host_to_device_index = const_cast<int *>(plan.device_cache_host_to_device_index.data());
+  auto swap_indices_size = plan.device_cache_host_to_device_index.size();
   if (swap_indices_size == 0) {
     return;
   }
@@ -602,13 +822,12 @@ void PsCacheManager::HashSwapHostToDevice(const HashTableInfo &hash_info) {
                                               embedding_size, swap_indices_size);
 }
 
-void PsCacheManager::HashSwapDeviceToHost(const HashTableInfo &hash_info) {
+void PsCacheManager::HashSwapDeviceToHost(const HashTableInfo &hash_info, const PsCacheSwapPlan &plan) {
   MS_EXCEPTION_IF_NULL(embedding_device_cache_);
   MS_EXCEPTION_IF_NULL(embedding_device_cache_->cache_);
-  MS_EXCEPTION_IF_NULL(embedding_host_cache_);
-  auto swap_indices_size = statistics_info_.device_to_host_size_;
-  auto device_cache_device_to_host_index = embedding_device_cache_->device_to_host_index.get();
-  auto host_cache_device_to_host_index = embedding_host_cache_->device_to_host_index.get();
+  auto swap_indices_size = plan.device_cache_device_to_host_index.size();
+  auto device_cache_device_to_host_index = const_cast<int *>(plan.device_cache_device_to_host_index.data());
+  auto host_cache_device_to_host_index = plan.host_cache_device_to_host_index.data();
   if (swap_indices_size == 0) {
     return;
   }
@@ -626,39 +845,31 @@ void PsCacheManager::HashSwapDeviceToHost(const HashTableInfo &hash_info) {
                                                        embedding_device_cache_->hash_swap_value_addr_,
                                                        swap_indices_size * embedding_size * sizeof(float));
   embedding_device_cache_->cache_->SynchronizeStream();
-  InsertHostHashTable(embedding_size, IntToSize(swap_indices_size), host_cache_device_to_host_index,
-                      swap_out_data.get(), host_hash_table_addr);
+  InsertHostHashTable(embedding_size, swap_indices_size, host_cache_device_to_host_index, swap_out_data.get(),
+                      host_hash_table_addr);
 }
 
-void PsCacheManager::HashSwapHostToServer(size_t key, const HashTableInfo &hash_info) {
-  MS_EXCEPTION_IF_NULL(embedding_host_cache_);
-  auto host_to_server_ids = embedding_host_cache_->host_to_server_ids.get();
-  auto host_to_server_index = embedding_host_cache_->host_to_server_index.get();
-  auto swap_indices_size = statistics_info_.host_to_server_size_;
+void PsCacheManager::HashSwapHostToServer(size_t key, const HashTableInfo &hash_info, const PsCacheSwapPlan &plan) {
+  auto host_to_server_ids = plan.host_to_server_ids.data();
+  auto host_to_server_index = plan.host_to_server_index.data();
+  auto swap_indices_size = plan.host_to_server_ids.size();
   if (swap_indices_size == 0) {
     return;
   }
-  ::ps::SArray<int> lookup_ids(swap_indices_size, 0);
+  auto lookup_ids = ToLookupIds(host_to_server_ids, swap_indices_size);
   ::ps::SArray<float> swap_out_data;
   auto embedding_size = hash_info.embedding_size;
   swap_out_data.resize(swap_indices_size * embedding_size);
   auto host_hash_table_addr = reinterpret_cast<float *>(hash_info.host_address.get());
   LookUpHostHashTable(embedding_size, swap_indices_size, host_hash_table_addr, host_to_server_index,
                       swap_out_data.data());
-
-  auto copy_len = swap_indices_size * sizeof(int);
-  auto ret = memcpy_s(lookup_ids.data(), copy_len, host_to_server_ids, copy_len);
-  if (ret != EOK) {
-    MS_LOG(EXCEPTION) << "Lookup id memcpy failed.";
-  }
-  worker.UpdateEmbeddingTable({key}, lookup_ids, swap_out_data);
+  worker_->UpdateEmbeddingTable(key, lookup_ids, swap_out_data);
 }
 
-void PsCacheManager::HashSwapServerToHost(size_t key, const HashTableInfo &hash_info) {
-  MS_EXCEPTION_IF_NULL(embedding_host_cache_);
-  auto swap_indices_size = statistics_info_.server_to_host_size_;
-  auto server_to_host_ids = embedding_host_cache_->server_to_host_ids.get();
-  auto server_to_host_index = embedding_host_cache_->server_to_host_index.get();
+void PsCacheManager::HashSwapServerToHost(size_t key, const HashTableInfo &hash_info, const PsCacheSwapPlan &plan) {
+  auto swap_indices_size = plan.server_to_host_ids.size();
+  auto server_to_host_ids = plan.server_to_host_ids.data();
+  auto server_to_host_index = plan.server_to_host_index.data();
   if (swap_indices_size == 0) {
     return;
   }
@@ -666,14 +877,9 @@ void PsCacheManager::HashSwapServerToHost(size_t key, const HashTableInfo &hash_
   auto embedding_size = hash_info.embedding_size;
   ::ps::SArray<int> lengths{swap_indices_size};
   ::ps::SArray<float> lookup_result(swap_indices_size * embedding_size, 0);
-  ::ps::SArray<int> lookup_ids(swap_indices_size, 0);
-  auto copy_len = swap_indices_size * sizeof(int);
-  auto ret = memcpy_s(lookup_ids.data(), copy_len, server_to_host_ids, copy_len);
-  if (ret != EOK) {
-    MS_LOG(EXCEPTION) << "Lookup id memcpy failed.";
-  }
-  worker.DoPSEmbeddingLookup({key}, lookup_ids, lengths, &lookup_result, mindspore::ps::kEmbeddingLookupCmd);
-  InsertHostHashTable(embedding_size, IntToSize(swap_indices_size), server_to_host_index, lookup_result.data(),
+  auto lookup_ids = ToLookupIds(server_to_host_ids, swap_indices_size);
+  worker_->EmbeddingLookup(key, lookup_ids, lengths, &lookup_result);
+  InsertHostHashTable(embedding_size, swap_indices_size, server_to_host_index, lookup_result.data(),
                       host_hash_table_addr);
 }
 
@@ -702,7 +908,7 @@ void PsCacheManager::HashSwapDeviceOut(int *swap_out_index, ::ps::SArray<float>
   embedding_device_cache_->cache_->RecordEvent();
 }
 
-void PsCacheManager::HashSwapDeviceIn(int *swap_in_ids, int *swap_in_index, const HashTableInfo &hash_info,
+void PsCacheManager::HashSwapDeviceIn(int64_t *swap_in_ids, int *swap_in_index, const HashTableInfo &hash_info,
                                       size_t key) {
   MS_EXCEPTION_IF_NULL(swap_in_ids);
   MS_EXCEPTION_IF_NULL(swap_in_index);
@@ -718,13 +924,8 @@ void PsCacheManager::HashSwapDeviceIn(int *swap_in_ids, int *swap_in_index, cons
   // Get id embs by swap_in_ids in host(Pipeline with hash swap-out in device).
   ::ps::SArray<int> lengths{swap_in_ids_size};
   ::ps::SArray<float> lookup_result(swap_in_ids_size * embedding_size, 0);
-  ::ps::SArray<int> lookup_ids(swap_in_ids_size, 0);
-  auto copy_len = swap_in_ids_size * sizeof(int);
-  auto ret = memcpy_s(lookup_ids.data(), copy_len, swap_in_ids, copy_len);
-  if (ret != EOK) {
-    MS_LOG(EXCEPTION) << "Lookup id memcpy failed.";
-  }
-  worker.DoPSEmbeddingLookup({key}, lookup_ids, lengths, &lookup_result, mindspore::ps::kEmbeddingLookupCmd);
+  auto lookup_ids = ToLookupIds(swap_in_ids, swap_in_ids_size);
+  worker_->EmbeddingLookup(key, lookup_ids, lengths, &lookup_result);
   // Hash swap-in in device.
   embedding_device_cache_->cache_->CopyHostMemToDevice(embedding_device_cache_->hash_swap_value_addr_,
                                                        lookup_result.data(),
@@ -736,7 +937,8 @@ void PsCacheManager::HashSwapDeviceIn(int *swap_in_ids, int *swap_in_index, cons
                                               embedding_size, swap_in_ids_size);
 }
 
-void PsCacheManager::UpdataEmbeddingTable(const ::ps::SArray<float> &swap_out_data, int *swap_out_ids, size_t key) {
+void PsCacheManager::UpdataEmbeddingTable(const ::ps::SArray<float> &swap_out_data, int64_t *swap_out_ids,
+                                          size_t key) {
   MS_EXCEPTION_IF_NULL(embedding_device_cache_);
   MS_EXCEPTION_IF_NULL(embedding_device_cache_->cache_);
   MS_EXCEPTION_IF_NULL(swap_out_ids);
@@ -744,15 +946,23 @@ void PsCacheManager::UpdataEmbeddingTable(const ::ps::SArray<float> &swap_out_da
   if (swap_out_ids_size == 0) {
     return;
   }
-  ::ps::SArray<int> lookup_ids(swap_out_ids_size, 0);
-  auto copy_len = swap_out_ids_size * sizeof(int);
-  auto ret = memcpy_s(lookup_ids.data(), copy_len, swap_out_ids, copy_len);
-  if (ret != EOK) {
-    MS_LOG(EXCEPTION) << "Lookup id memcpy failed.";
-  }
+  auto lookup_ids = ToLookupIds(swap_out_ids, swap_out_ids_size);
   // Need synchronize event to ensure that the swap-out in device is completed.
   embedding_device_cache_->cache_->SynchronizeEvent();
-  worker.UpdateEmbeddingTable({key}, lookup_ids, swap_out_data);
+  worker_->UpdateEmbeddingTable(key, lookup_ids, swap_out_data);
+}
+
+::ps::SArray<int> PsCacheManager::ToLookupIds(const int64_t *ids, size_t size) {
+  MS_EXCEPTION_IF_NULL(ids);
+  ::ps::SArray<int> lookup_ids(size, 0);
+  for (size_t i = 0; i < size; i++) {
+    if (ids[i] < 0 || ids[i] > INT_MAX) {
+      MS_LOG(EXCEPTION) << "The id " << ids[i] << " is out of the range [0, " << INT_MAX
+                        << "] of the ids the servers look up.";
+    }
+    lookup_ids[i] = static_cast<int>(ids[i]);
+  }
+  return lookup_ids;
 }
 
 void PsCacheManager::DumpHashTables() const {
@@ -25,6 +25,7 @@
 #include <utility>
 #include <memory>
 #include <condition_variable>
+#include <functional>
 #include "utils/ms_context.h"
 #include "backend/kernel_compiler/kernel.h"
 #include "utils/shape_utils.h"
@@ -35,11 +36,22 @@
 #include "ps/ps_cache/ps_data/ps_data_prefetch.h"
 #include "ps/ps_cache/embedding_hash_map.h"
 #include "ps/ps_cache/ps_cache_factory.h"
+#include "ps/ps_cache/ps_cache_pipeline.h"
+#include "ps/server_thread_pool.h"
+#include "ps/dynamic_embedding_table.h"
 
 namespace mindspore {
 namespace ps {
 constexpr size_t kHostCacheScaleFactor = 10;
 constexpr size_t kMaxThreadNum = 16;
+// Ids a task of the parallel lookups and copies takes at least.
+constexpr size_t kParallelTaskSize = 10000;
+// Steps in the swap pipeline at most, the ids of the next step are parsed while the previous steps are swapped.
+constexpr size_t kPsCachePipelineDepth = 2;
+constexpr size_t kPsCacheProfileInterval = 1000;
+// Size of the sketch counting the ids of the batches for the admission to the dynamic embedding tables.
+constexpr size_t kAdmitSketchWidth = 1 << 18;
+constexpr size_t kAdmitSketchDepth = 4;
 using mindspore::kernel::Address;
 
 struct HashTableInfo {
@@ -55,9 +67,9 @@ struct HashTableInfo {
 struct EmbeddingDeviceCache {
   EmbeddingDeviceCache(size_t batch_elements, size_t cache_vocab_size) {
     device_to_host_index = std::make_unique<int[]>(batch_elements);
-    device_to_host_ids = std::make_unique<int[]>(batch_elements);
+    device_to_host_ids = std::make_unique<int64_t[]>(batch_elements);
     host_to_device_index = std::make_unique<int[]>(batch_elements);
-    host_to_device_ids = std::make_unique<int[]>(batch_elements);
+    host_to_device_ids = std::make_unique<int64_t[]>(batch_elements);
     device_hash_map_ = std::make_shared<EmbeddingHashMap>(0, cache_vocab_size);
     auto context_ptr = MsContext::GetInstance();
     MS_EXCEPTION_IF_NULL(context_ptr);
@@ -65,9 +77,9 @@ struct EmbeddingDeviceCache {
     cache_ = PsCacheFactory::Get().ps_cache(devcie_target);
   }
   std::unique_ptr<int[]> device_to_host_index;
-  std::unique_ptr<int[]> device_to_host_ids;
+  std::unique_ptr<int64_t[]> device_to_host_ids;
   std::unique_ptr<int[]> host_to_device_index;
-  std::unique_ptr<int[]> host_to_device_ids;
+  std::unique_ptr<int64_t[]> host_to_device_ids;
   int *hash_swap_index_addr_;
   float *hash_swap_value_addr_;
   std::shared_ptr<EmbeddingHashMap> device_hash_map_;
@@ -76,18 +88,20 @@ struct EmbeddingDeviceCache {
 
 struct EmbeddingHostCache {
   EmbeddingHostCache(size_t batch_elements, size_t host_cache_vocab_size) {
-    host_to_server_index = std::make_unique<int[]>(batch_elements);
-    host_to_server_ids = std::make_unique<int[]>(batch_elements);
+    // Both the rows pulled from the server and the rows swapped out of the device take host slots, and each of them may
+    // push a row to the server.
+    host_to_server_index = std::make_unique<int[]>(2 * batch_elements);
+    host_to_server_ids = std::make_unique<int64_t[]>(2 * batch_elements);
     server_to_host_index = std::make_unique<int[]>(batch_elements);
-    server_to_host_ids = std::make_unique<int[]>(batch_elements);
+    server_to_host_ids = std::make_unique<int64_t[]>(batch_elements);
     host_to_device_index = std::make_unique<int[]>(batch_elements);
     device_to_host_index = std::make_unique<int[]>(batch_elements);
     host_hash_map_ = std::make_shared<EmbeddingHashMap>(0, host_cache_vocab_size);
   }
   std::unique_ptr<int[]> host_to_server_index;
-  std::unique_ptr<int[]> host_to_server_ids;
+  std::unique_ptr<int64_t[]> host_to_server_ids;
   std::unique_ptr<int[]> server_to_host_index;
-  std::unique_ptr<int[]> server_to_host_ids;
+  std::unique_ptr<int64_t[]> server_to_host_ids;
   std::unique_ptr<int[]> host_to_device_index;
   std::unique_ptr<int[]> device_to_host_index;
   std::shared_ptr<EmbeddingHashMap> host_hash_map_;
@@ -105,6 +119,41 @@ struct PsCacheStatisticsInfo {
   size_t mem_cache_hit_count_{0};
 };
 
+// The swaps of one data step planned by ParseData. The swap stages of the pipeline work on the plan while the ids of
+// the next step are parsed, so the plan keeps its own copy of the swap index and ids.
+struct PsCacheSwapPlan {
+  // The device slots to swap out and the host slots to keep their values.
+  std::vector<int> device_cache_device_to_host_index;
+  std::vector<int> host_cache_device_to_host_index;
+  // The device slots to swap in and the host slots to read their values.
+  std::vector<int> device_cache_host_to_device_index;
+  std::vector<int> host_cache_host_to_device_index;
+  std::vector<int> host_to_server_index;
+  std::vector<int64_t> host_to_server_ids;
+  std::vector<int> server_to_host_index;
+  std::vector<int64_t> server_to_host_ids;
+};
+using PsCacheSwapPlanPtr = std::shared_ptr<PsCacheSwapPlan>;
+
+// The requests of the ps cache to the servers, which the worker of the ps mode sends in training.
+class PsCacheWorker {
+ public:
+  PsCacheWorker() = default;
+  virtual ~PsCacheWorker() = default;
+  virtual void Start() = 0;
+  virtual size_t worker_num() const = 0;
+  virtual size_t rank_id() const = 0;
+  virtual size_t SetParamKey(const std::string &param_name) = 0;
+  virtual size_t GetParamKey(const std::string &param_name) = 0;
+  virtual void AddEmbeddingTable(size_t key, size_t row_count) = 0;
+  virtual void InitEmbeddingTable(const std::vector<size_t> &keys, const std::vector<float> &values,
+                                  const std::vector<int64_t> &lens) = 0;
+  virtual void EmbeddingLookup(size_t key, const ::ps::SArray<int> &lookup_ids, const ::ps::SArray<int> &lengths,
+                               ::ps::SArray<float> *lookup_result) = 0;
+  virtual void UpdateEmbeddingTable(size_t key, const ::ps::SArray<int> &lookup_ids,
+                                    const ::ps::SArray<float> &values) = 0;
+};
+
 class PsCacheManager {
  public:
   static PsCacheManager &GetInstance() {
@@ -126,6 +175,9 @@ class PsCacheManager {
   void DoProcessData(uint32_t device_id, void *context);
   void IncreaseGraphStep(const std::string &channel_name);
   void DumpHashTables() const;
+  const PsCacheProfiler &profiler() const { return profiler_; }
+  // Replaces the worker of the ps mode before Initialize, such as by a stub in the tests.
+  void set_worker(const std::shared_ptr<PsCacheWorker> &worker) { worker_ = worker; }
 
  private:
   PsCacheManager() = default;
@@ -140,23 +192,42 @@ class PsCacheManager {
   void AllocMemForHashTable();
   void SetLocalIdRank();
   void ProcessDataTask(uint32_t device_id, void *context);
+  void StartPipeline(uint32_t device_id, void *context);
   void ProcessData();
+  // Parse the batch of the next data step, replace its ids by the hash index and push its swaps to the pipeline.
+  void ProcessBatch(void *data, size_t data_size);
   void ParseData(const int *batch_ids, const size_t batch_ids_len, int *hash_index);
+  // Parse the ids of a small batch, or of any batch without the thread pool, one by one in the batch.
+  void ParseDataInTurn(const int *batch_ids, const size_t batch_ids_len, int *hash_index);
+  // Parse the unique ids of a large batch, the lookups of the hits are split over the thread pool.
+  void ParseUniqueData(const int *batch_ids, const size_t batch_ids_len, int *hash_index);
+  PsCacheSwapPlanPtr CreateSwapPlan() const;
+  void DropNotAdmittedIds(PsCacheSwapPlan *plan) const;
+  // The stages of the swap pipeline, the swaps with the server and then the swaps with the device.
+  void SwapHostAndServer(const PsCacheSwapPlan &plan);
+  void SwapDeviceAndHost(const PsCacheSwapPlan &plan);
+  void WaitSwapFinish(size_t step);
+  // Look up the device hash map for the ids in parallel, return the number of the hits.
+  size_t LookUpDeviceHashMap(const std::vector<int64_t> &ids, std::vector<int> *indexes);
+  // Split [0, size) into ranges of kParallelTaskSize at least and run task(begin, end) of them on the thread pool.
+  void ParallelRun(size_t size, const std::function<void(size_t, size_t)> &task);
   void WaitGraphRun();
-  int ParseDeviceData(size_t id, bool *need_swap_device_to_host, bool *need_swap_host_to_device);
-  void ParseHostDataHostToDevice(size_t id);
-  void ParseHostDataDeviceToHost(size_t id);
+  int ParseDeviceData(int64_t id, bool *need_swap_device_to_host, bool *need_swap_host_to_device);
+  void ParseHostDataHostToDevice(int64_t id);
+  void ParseHostDataDeviceToHost();
   void HashSwapDeviceOut(int *swap_out_index, ::ps::SArray<float> *swap_out_data, const HashTableInfo &hash_info);
-  void HashSwapDeviceIn(int *swap_in_ids, int *swap_in_index, const HashTableInfo &hash_info, size_t key);
-  void HashSwapHostToDevice(const HashTableInfo &hash_info);
-  void HashSwapDeviceToHost(const HashTableInfo &hash_info);
-  void HashSwapHostToServer(size_t key, const HashTableInfo &hash_info);
-  void HashSwapServerToHost(size_t key, const HashTableInfo &hash_info);
-  void InsertHostHashTable(size_t embedding_size, size_t insert_indices_size, int *insert_indices, float *insert_data,
-                           float *hash_table_addr);
+  void HashSwapDeviceIn(int64_t *swap_in_ids, int *swap_in_index, const HashTableInfo &hash_info, size_t key);
+  void HashSwapHostToDevice(const HashTableInfo &hash_info, const PsCacheSwapPlan &plan);
+  void HashSwapDeviceToHost(const HashTableInfo &hash_info, const PsCacheSwapPlan &plan);
+  void HashSwapHostToServer(size_t key, const HashTableInfo &hash_info, const PsCacheSwapPlan &plan);
+  void HashSwapServerToHost(size_t key, const HashTableInfo &hash_info, const PsCacheSwapPlan &plan);
+  void InsertHostHashTable(size_t embedding_size, size_t insert_indices_size, const int *insert_indices,
+                           const float *insert_data, float *hash_table_addr);
   void LookUpHostHashTable(size_t embedding_size, size_t indices_lens, const float *hash_table_addr,
                            const int *indices_addr, float *output_addr);
-  void UpdataEmbeddingTable(const ::ps::SArray<float> &swap_out_data, int *swap_out_ids, size_t key);
+  void UpdataEmbeddingTable(const ::ps::SArray<float> &swap_out_data, int64_t *swap_out_ids, size_t key);
+  // The servers look up the rows by int ids, an id out of the range is rejected rather than truncated.
+  static ::ps::SArray<int> ToLookupIds(const int64_t *ids, size_t size);
   void LookUpTableTask(size_t indices_lens, size_t outer_dim_size, size_t first_dim_size, const float *input_addr,
                        const int *indices_addr, float *output_addr);
   bool CheckFinishInsertInitInfo() const;
@@ -173,6 +244,7 @@ class PsCacheManager {
   std::condition_variable insert_init_info_;
 
   std::map<std::string, HashTableInfo> hash_tables_;
+  std::shared_ptr<PsCacheWorker> worker_;
   std::shared_ptr<EmbeddingDeviceCache> embedding_device_cache_;
   std::shared_ptr<EmbeddingHostCache> embedding_host_cache_;
 
@@ -181,6 +253,14 @@ class PsCacheManager {
   size_t host_cache_vocab_size_{0};
   size_t batch_elements_{0};
   PsCacheStatisticsInfo statistics_info_;
+  std::unique_ptr<PsCachePipeline<PsCacheSwapPlanPtr>> pipeline_;
+  // Runs the lookups of the hash maps and the copies of the host hash tables, created once by Initialize.
+  std::unique_ptr<ServerThreadPool> thread_pool_;
+  PsCacheProfiler profiler_;
+  // Counts the ids of the batches when the servers keep dynamic embedding tables with an admit threshold. The server
+  // only sees the misses of the cache, so the admission is decided here.
+  std::unique_ptr<CountMinSketch> admit_sketch_;
+  size_t admit_threshold_{1};
   std::pair<size_t, size_t> range_bound_;
   std::atomic_bool finish_insert_init_info_{false};
   std::atomic_bool finish_init_parameter_server_{false};
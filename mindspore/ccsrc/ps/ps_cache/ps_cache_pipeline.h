@@ -0,0 +1,220 @@
+/**
+ * Copyright 2021 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MINDSPORE_CCSRC_PS_PS_CACHE_PS_CACHE_PIPELINE_H_
+#define MINDSPORE_CCSRC_PS_PS_CACHE_PS_CACHE_PIPELINE_H_
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "utils/log_adapter.h"
+
+namespace mindspore {
+namespace ps {
+enum PsCachePhase {
+  kParsePhase = 0,
+  kHostToServerPhase,
+  kServerToHostPhase,
+  kDeviceToHostPhase,
+  kHostToDevicePhase,
+  kGraphWaitPhase,
+  kPhaseNum
+};
+
+// Accumulates the time of every phase of the ps cache steps, the phases are recorded by different threads.
+class PsCacheProfiler {
+ public:
+  PsCacheProfiler() { Reset(); }
+  ~PsCacheProfiler() = default;
+  void Record(PsCachePhase phase, std::chrono::steady_clock::duration cost) {
+    costs_us_[phase] += std::chrono::duration_cast<std::chrono::microseconds>(cost).count();
+  }
+  uint64_t cost_us(PsCachePhase phase) const { return costs_us_[phase]; }
+  void Reset() {
+    for (auto &cost : costs_us_) {
+      cost = 0;
+    }
+  }
+  // Average cost of every phase in ms over steps.
+  std::string Summary(size_t steps) const {
+    static const char *phase_names[kPhaseNum] = {"parse",          "host to server", "server to host",
+                                                 "device to host", "host to device", "graph wait"};
+    std::ostringstream summary;
+    for (size_t i = 0; i < kPhaseNum; i++) {
+      summary << (i == 0 ? "" : ", ") << phase_names[i] << " "
+              << static_cast<double>(costs_us_[i]) / 1000 / (steps == 0 ? 1 : steps) << "ms";
+    }
+    return summary.str();
+  }
+
+ private:
+  std::atomic_uint64_t costs_us_[kPhaseNum];
+};
+
+// Runs the steps through the stages in order, every stage has a thread and takes the steps in order, so the stages
+// work on different steps at the same time. At most depth steps are in the pipeline, Push blocks until the last
+// stage finishes the oldest one. An exception of a stage stops the pipeline and is thrown again by Push and WaitStep.
+template <typename T>
+class PsCachePipeline {
+ public:
+  using StageTask = std::function<void(size_t step, const T &item)>;
+  explicit PsCachePipeline(size_t depth) : depth_(depth == 0 ? 1 : depth) {}
+  ~PsCachePipeline() { Stop(); }
+
+  // init runs in the thread of the stage before the first step, for the thread bound resources such as devices.
+  void AddStage(const std::string &name, StageTask &&task, std::function<void()> &&init = nullptr) {
+    auto stage = std::make_unique<Stage>();
+    stage->name_ = name;
+    stage->task_ = std::move(task);
+    stage->init_ = std::move(init);
+    stages_.push_back(std::move(stage));
+  }
+
+  void Start() {
+    std::lock_guard<std::mutex> locker(mutex_);
+    if (running_) {
+      return;
+    }
+    running_ = true;
+    for (size_t i = 0; i < stages_.size(); i++) {
+      stages_[i]->thread_ = std::thread(&PsCachePipeline::RunStage, this, i);
+    }
+  }
+
+  void Stop() {
+    {
+      std::lock_guard<std::mutex> locker(mutex_);
+      if (!running_) {
+        return;
+      }
+      running_ = false;
+    }
+    cond_.notify_all();
+    for (auto &stage : stages_) {
+      if (stage->thread_.joinable()) {
+        stage->thread_.join();
+      }
+    }
+  }
+
+  void Push(size_t step, const T &item) {
+    std::unique_lock<std::mutex> locker(mutex_);
+    cond_.wait(locker, [this] { return pushed_num_ - finished_num_ < depth_ || error_ != nullptr || !running_; });
+    RethrowError();
+    if (!running_) {
+      MS_LOG(EXCEPTION) << "The ps cache pipeline is not running, step " << step << " can not be processed.";
+    }
+    pushed_num_++;
+    if (stages_.empty()) {
+      FinishStep(step);
+      return;
+    }
+    stages_.front()->queue_.emplace(step, item);
+    cond_.notify_all();
+  }
+
+  // Return false if the last stage does not finish the step in timeout.
+  template <typename Rep, typename Period>
+  bool WaitStep(size_t step, const std::chrono::duration<Rep, Period> &timeout) {
+    std::unique_lock<std::mutex> locker(mutex_);
+    bool finished =
+      cond_.wait_for(locker, timeout, [this, step] { return finished_step_ >= step || error_ != nullptr; });
+    RethrowError();
+    return finished;
+  }
+
+  size_t finished_step() const {
+    std::lock_guard<std::mutex> locker(mutex_);
+    return finished_step_;
+  }
+
+ private:
+  struct Stage {
+    std::string name_;
+    StageTask task_;
+    std::function<void()> init_;
+    std::queue<std::pair<size_t, T>> queue_;
+    std::thread thread_;
+  };
+
+  void RunStage(size_t index) {
+    auto &stage = stages_[index];
+    try {
+      if (stage->init_) {
+        stage->init_();
+      }
+      while (true) {
+        std::pair<size_t, T> step_item;
+        {
+          std::unique_lock<std::mutex> locker(mutex_);
+          cond_.wait(locker, [this, &stage] { return !stage->queue_.empty() || !running_; });
+          if (!running_) {
+            return;
+          }
+          step_item = std::move(stage->queue_.front());
+          stage->queue_.pop();
+        }
+        stage->task_(step_item.first, step_item.second);
+        std::lock_guard<std::mutex> locker(mutex_);
+        if (index + 1 < stages_.size()) {
+          stages_[index + 1]->queue_.push(std::move(step_item));
+        } else {
+          FinishStep(step_item.first);
+        }
+        cond_.notify_all();
+      }
+    } catch (const std::exception &e) {
+      MS_LOG(ERROR) << "The ps cache pipeline stage " << stage->name_ << " failed: " << e.what();
+      std::lock_guard<std::mutex> locker(mutex_);
+      error_ = std::current_exception();
+      cond_.notify_all();
+    }
+  }
+
+  void FinishStep(size_t step) {
+    finished_step_ = step;
+    finished_num_++;
+  }
+
+  void RethrowError() {
+    if (error_ != nullptr) {
+      std::rethrow_exception(error_);
+    }
+  }
+
+  size_t depth_;
+  std::vector<std::unique_ptr<Stage>> stages_;
+  mutable std::mutex mutex_;
+  std::condition_variable cond_;
+  bool running_{false};
+  size_t pushed_num_{0};
+  size_t finished_num_{0};
+  size_t finished_step_{0};
+  std::exception_ptr error_{nullptr};
+};
+}  // namespace ps
+}  // namespace mindspore
+#endif  // MINDSPORE_CCSRC_PS_PS_CACHE_PS_CACHE_PIPELINE_H_
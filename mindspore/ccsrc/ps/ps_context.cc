@@ -21,6 +21,7 @@
 #include "backend/kernel_compiler/kernel.h"
 #if (ENABLE_CPU && (ENABLE_D || ENABLE_GPU))
 #include "ps/ps_cache/ps_cache_manager.h"
+#include "ps/parameter_server.h"
 #endif
 
 namespace mindspore {
@@ -62,6 +63,14 @@ void PSContext::Reset() {
   is_worker_ = false;
   is_pserver_ = false;
   is_sched_ = false;
+  consistency_mode_ = kConsistencySync;
+  staleness_threshold_ = 0;
+  compression_ = kCompressionNone;
+  topk_ratio_ = kDefaultTopKRatio;
+  embedding_storage_ = kEmbeddingStorageDense;
+  embedding_admit_threshold_ = 1;
+  embedding_ttl_ = 0;
+  embedding_max_rows_ = 0;
 }
 
 std::string PSContext::ms_role() const {
@@ -123,5 +132,88 @@ void PSContext::set_cache_enable(bool cache_enable) const {
   PsDataPrefetch::GetInstance().set_cache_enable(cache_enable);
 #endif
 }
+
+void PSContext::set_consistency_mode(const std::string &consistency_mode) {
+  if (consistency_mode != kConsistencySync && consistency_mode != kConsistencySSP &&
+      consistency_mode != kConsistencyAsync) {
+    MS_LOG(EXCEPTION) << "Consistency mode should be one of sync, ssp and async, but got " << consistency_mode;
+  }
+  consistency_mode_ = consistency_mode;
+}
+
+std::string PSContext::consistency_mode() const { return consistency_mode_; }
+
+void PSContext::set_staleness_threshold(int64_t staleness_threshold) {
+  if (staleness_threshold < 0) {
+    MS_LOG(EXCEPTION) << "Staleness threshold should not be negative, but got " << staleness_threshold;
+  }
+  staleness_threshold_ = staleness_threshold;
+}
+
+int64_t PSContext::staleness_threshold() const { return staleness_threshold_; }
+
+void PSContext::set_compression(const std::string &compression) {
+  if (compression != kCompressionNone && compression != kCompressionFp16 && compression != kCompressionBf16 &&
+      compression != kCompressionTopK) {
+    MS_LOG(EXCEPTION) << "Compression should be one of none, fp16, bf16 and topk, but got " << compression;
+  }
+  compression_ = compression;
+}
+
+std::string PSContext::compression() const { return compression_; }
+
+void PSContext::set_topk_ratio(float topk_ratio) {
+  if (topk_ratio <= 0 || topk_ratio > 1) {
+    MS_LOG(EXCEPTION) << "Topk ratio should be in (0, 1], but got " << topk_ratio;
+  }
+  topk_ratio_ = topk_ratio;
+}
+
+float PSContext::topk_ratio() const { return topk_ratio_; }
+
+void PSContext::set_embedding_storage(const std::string &embedding_storage) {
+  if (embedding_storage != kEmbeddingStorageDense && embedding_storage != kEmbeddingStorageDynamic) {
+    MS_LOG(EXCEPTION) << "Embedding storage should be dense or dynamic, but got " << embedding_storage;
+  }
+  embedding_storage_ = embedding_storage;
+}
+
+std::string PSContext::embedding_storage() const { return embedding_storage_; }
+
+void PSContext::set_embedding_admit_threshold(int64_t embedding_admit_threshold) {
+  if (embedding_admit_threshold < 1) {
+    MS_LOG(EXCEPTION) << "Embedding admit threshold should be at least 1, but got " << embedding_admit_threshold;
+  }
+  embedding_admit_threshold_ = embedding_admit_threshold;
+}
+
+int64_t PSContext::embedding_admit_threshold() const { return embedding_admit_threshold_; }
+
+void PSContext::set_embedding_ttl(int64_t embedding_ttl) {
+  if (embedding_ttl < 0) {
+    MS_LOG(EXCEPTION) << "Embedding ttl should be non-negative, but got " << embedding_ttl;
+  }
+  embedding_ttl_ = embedding_ttl;
+}
+
+int64_t PSContext::embedding_ttl() const { return embedding_ttl_; }
+
+void PSContext::set_embedding_max_rows(int64_t embedding_max_rows) {
+  if (embedding_max_rows < 0) {
+    MS_LOG(EXCEPTION) << "Embedding max rows should be non-negative, but got " << embedding_max_rows;
+  }
+  embedding_max_rows_ = embedding_max_rows;
+}
+
+int64_t PSContext::embedding_max_rows() const { return embedding_max_rows_; }
+
+std::map<uint64_t, DynamicEmbeddingMetrics> PSContext::embedding_metrics() const {
+#if (ENABLE_CPU && (ENABLE_D || ENABLE_GPU))
+  if (is_pserver_) {
+    return ParameterServer<float>::GetInstance().EmbeddingMetrics();
+  }
+#endif
+  return {};
+}
 }  // namespace ps
 }  // namespace mindspore
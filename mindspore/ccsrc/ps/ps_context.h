@@ -17,8 +17,10 @@
 #ifndef MINDSPORE_CCSRC_PS_CONTEXT_H_
 #define MINDSPORE_CCSRC_PS_CONTEXT_H_
 
+#include <map>
 #include <string>
 #include <memory>
+#include "ps/dynamic_embedding_table.h"
 
 namespace mindspore {
 namespace ps {
@@ -28,6 +30,25 @@ constexpr char kEnvRoleOfWorker[] = "MS_WORKER";
 constexpr char kEnvRoleOfScheduler[] = "MS_SCHED";
 constexpr char kEnvRoleOfNotPS[] = "MS_NOT_PS";
 
+// Consistency modes of the parameter server. In sync mode the gradients of all workers are applied together once
+// every step, in ssp (stale synchronous) and async mode the gradients of a worker are applied as they arrive, and
+// in ssp mode a worker waits before pulling when it runs more than staleness_threshold steps ahead of the slowest.
+constexpr char kConsistencySync[] = "sync";
+constexpr char kConsistencySSP[] = "ssp";
+constexpr char kConsistencyAsync[] = "async";
+
+// Compressions of the values sent between the workers and the servers, see ps/compression.h.
+constexpr char kCompressionNone[] = "none";
+constexpr char kCompressionFp16[] = "fp16";
+constexpr char kCompressionBf16[] = "bf16";
+constexpr char kCompressionTopK[] = "topk";
+constexpr float kDefaultTopKRatio = 0.01;
+
+// Storages of the embedding tables of the ps cache on the servers. A dense table holds a row for every id of the
+// vocabulary, a dynamic table creates the rows of the ids as they are admitted, see ps/dynamic_embedding_table.h.
+constexpr char kEmbeddingStorageDense[] = "dense";
+constexpr char kEmbeddingStorageDynamic[] = "dynamic";
+
 class PSContext {
  public:
   ~PSContext() = default;
@@ -52,14 +73,53 @@ class PSContext {
   void InsertAccumuInitInfo(const std::string &param_name, float init_val) const;
   void CloneHashTable(const std::string &dest_param_name, const std::string &src_param_name) const;
   void set_cache_enable(bool cache_enable) const;
+  void set_consistency_mode(const std::string &consistency_mode);
+  std::string consistency_mode() const;
+  void set_staleness_threshold(int64_t staleness_threshold);
+  int64_t staleness_threshold() const;
+  void set_compression(const std::string &compression);
+  std::string compression() const;
+  void set_topk_ratio(float topk_ratio);
+  float topk_ratio() const;
+  void set_embedding_storage(const std::string &embedding_storage);
+  std::string embedding_storage() const;
+  void set_embedding_admit_threshold(int64_t embedding_admit_threshold);
+  int64_t embedding_admit_threshold() const;
+  void set_embedding_ttl(int64_t embedding_ttl);
+  int64_t embedding_ttl() const;
+  void set_embedding_max_rows(int64_t embedding_max_rows);
+  int64_t embedding_max_rows() const;
+  // Metrics of the dynamic embedding tables of this server by key, empty in the other roles.
+  std::map<uint64_t, DynamicEmbeddingMetrics> embedding_metrics() const;
 
  private:
-  PSContext() : ps_enabled_(false), is_worker_(false), is_pserver_(false), is_sched_(false), rank_id_(-1) {}
+  PSContext()
+      : ps_enabled_(false),
+        is_worker_(false),
+        is_pserver_(false),
+        is_sched_(false),
+        rank_id_(-1),
+        consistency_mode_(kConsistencySync),
+        staleness_threshold_(0),
+        compression_(kCompressionNone),
+        topk_ratio_(kDefaultTopKRatio),
+        embedding_storage_(kEmbeddingStorageDense),
+        embedding_admit_threshold_(1),
+        embedding_ttl_(0),
+        embedding_max_rows_(0) {}
   bool ps_enabled_;
   bool is_worker_;
   bool is_pserver_;
   bool is_sched_;
   int rank_id_;
+  std::string consistency_mode_;
+  int64_t staleness_threshold_;
+  std::string compression_;
+  float topk_ratio_;
+  std::string embedding_storage_;
+  int64_t embedding_admit_threshold_;
+  int64_t embedding_ttl_;
+  int64_t embedding_max_rows_;
 };
 }  // namespace ps
 }  // namespace mindspore
@@ -0,0 +1,106 @@
+/**
+ * Copyright 2021 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "ps/server_thread_pool.h"
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <utility>
+
+namespace mindspore {
+namespace ps {
+ServerThreadPool::ServerThreadPool(size_t thread_num) {
+  if (thread_num == 0) {
+    thread_num = 1;
+  }
+  for (size_t i = 0; i < thread_num; i++) {
+    threads_.emplace_back(&ServerThreadPool::Work, this);
+  }
+}
+
+ServerThreadPool::~ServerThreadPool() {
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  task_cv_.notify_all();
+  for (auto &thread : threads_) {
+    if (thread.joinable()) {
+      thread.join();
+    }
+  }
+}
+
+void ServerThreadPool::Submit(std::function<void()> &&task) {
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    tasks_.push(std::move(task));
+  }
+  task_cv_.notify_one();
+}
+
+void ServerThreadPool::ParallelFor(size_t num, const std::function<void(size_t)> &func) {
+  if (num == 0) {
+    return;
+  }
+  struct State {
+    std::atomic<size_t> next{0};
+    size_t done{0};
+    std::mutex mutex;
+    std::condition_variable done_cv;
+  };
+  auto state = std::make_shared<State>();
+  auto run = [state, num, &func]() {
+    size_t finished = 0;
+    for (size_t i = state->next++; i < num; i = state->next++) {
+      func(i);
+      finished++;
+    }
+    if (finished > 0) {
+      std::unique_lock<std::mutex> lock(state->mutex);
+      state->done += finished;
+      if (state->done == num) {
+        state->done_cv.notify_one();
+      }
+    }
+  };
+  // a helper which starts after every task is claimed returns at once, func is not touched once all are done
+  size_t helper_num = std::min(num, threads_.size() + 1) - 1;
+  for (size_t i = 0; i < helper_num; i++) {
+    Submit(run);
+  }
+  run();
+  std::unique_lock<std::mutex> lock(state->mutex);
+  state->done_cv.wait(lock, [&state, num] { return state->done == num; });
+}
+
+void ServerThreadPool::Work() {
+  while (true) {
+    std::function<void()> task;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      task_cv_.wait(lock, [this] { return stop_ || !tasks_.empty(); });
+      if (stop_ && tasks_.empty()) {
+        return;
+      }
+      task = std::move(tasks_.front());
+      tasks_.pop();
+    }
+    task();
+  }
+}
+}  // namespace ps
+}  // namespace mindspore
@@ -0,0 +1,73 @@
+/**
+ * Copyright 2021 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MINDSPORE_CCSRC_PS_SERVER_THREAD_POOL_H_
+#define MINDSPORE_CCSRC_PS_SERVER_THREAD_POOL_H_
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+namespace mindspore {
+namespace ps {
+constexpr size_t kMaxServerThreadNum = 16;
+constexpr size_t kKeyLockNum = 64;
+
+// Thread pool of the parameter server. Requests of the workers are handled on it concurrently, and the optimizers
+// of different keys are run on it in parallel when the weights are updated.
+// The ps cache of the workers runs its lookups and copies of large batches on one too.
+class ServerThreadPool {
+ public:
+  explicit ServerThreadPool(size_t thread_num);
+  ~ServerThreadPool();
+  ServerThreadPool(const ServerThreadPool &) = delete;
+  ServerThreadPool &operator=(const ServerThreadPool &) = delete;
+
+  // Run task on one of the threads of the pool.
+  void Submit(std::function<void()> &&task);
+
+  // Run func(0) ... func(num - 1) on the pool and the calling thread and return when all of them are done. The
+  // calling thread takes tasks too, so it makes progress even when every thread of the pool is busy.
+  void ParallelFor(size_t num, const std::function<void(size_t)> &func);
+
+  size_t thread_num() const { return threads_.size(); }
+
+ private:
+  void Work();
+
+  std::vector<std::thread> threads_;
+  std::queue<std::function<void()>> tasks_;
+  std::mutex mutex_;
+  std::condition_variable task_cv_;
+  bool stop_{false};
+};
+
+// A fixed number of mutexes sharing out the keys of the server, requests on keys in different shards do not wait
+// for each other. The shards never change, so picking the lock of a key needs no lock itself.
+class KeyLocks {
+ public:
+  std::mutex &operator[](uint64_t key) { return mutexes_[key % kKeyLockNum]; }
+
+ private:
+  std::mutex mutexes_[kKeyLockNum];
+};
+}  // namespace ps
+}  // namespace mindspore
+#endif  // MINDSPORE_CCSRC_PS_SERVER_THREAD_POOL_H_
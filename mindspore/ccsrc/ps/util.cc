@@ -26,24 +26,24 @@ namespace ps {
 int64_t Util::rank_id_ = -1;
 
 std::unordered_map<std::string, int64_t> Util::optimizer_to_ids{
-  {kApplyMomentum, 0},
-  {kSparseAdam, 1},
-  {kSparseLazyAdam, 2},
-  {kSparseFtrl, 3},
+  {kApplyMomentum, kApplyMomentumId},
+  {kSparseAdam, kSparseAdamId},
+  {kSparseLazyAdam, kSparseLazyAdamId},
+  {kSparseFtrl, kSparseFtrlId},
 };
 
 std::unordered_map<int64_t, std::string> Util::id_to_optimizers{
-  {0, kApplyMomentum},
-  {1, kSparseAdam},
-  {2, kSparseLazyAdam},
-  {3, kSparseFtrl},
+  {kApplyMomentumId, kApplyMomentum},
+  {kSparseAdamId, kSparseAdam},
+  {kSparseLazyAdamId, kSparseLazyAdam},
+  {kSparseFtrlId, kSparseFtrl},
 };
 
 std::unordered_map<int64_t, std::string> Util::id_to_optimizer_nodes{
-  {0, kApplyMomentumOp},
-  {1, kSparseAdamOp},
-  {2, kSparseLazyAdamOp},
-  {3, kSparseFtrlOp},
+  {kApplyMomentumId, kApplyMomentumOp},
+  {kSparseAdamId, kSparseAdamOp},
+  {kSparseLazyAdamId, kSparseLazyAdamOp},
+  {kSparseFtrlId, kSparseFtrlOp},
 };
 
 bool Util::IsParamServerMode() { return PSContext::instance()->is_ps_enabled(); }
@@ -113,6 +113,10 @@ std::string Util::optimizer_node_name(int64_t id) {
 
 bool Util::is_optimizer(std::string name) { return optimizer_to_ids.count(name) > 0; }
 
+bool Util::is_sparse_optimizer(int64_t id) {
+  return id == kSparseAdamId || id == kSparseLazyAdamId || id == kSparseFtrlId;
+}
+
 int64_t Util::LocalShard(int64_t first_dim, int64_t rank_id, int64_t server_num) {
   std::map<int64_t, int64_t> shard_dims = AllRankLocalShard(first_dim, rank_id, server_num);
   if (shard_dims.count(rank_id) == 0) {
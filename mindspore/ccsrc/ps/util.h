@@ -28,6 +28,9 @@ namespace mindspore {
 namespace ps {
 enum ParamType { kUnKnown = 0, kWeight = 1, kAccumulation = 2 };
 
+// ids of the optimizers sent to the servers
+enum OptimizerId : int64_t { kApplyMomentumId = 0, kSparseAdamId = 1, kSparseLazyAdamId = 2, kSparseFtrlId = 3 };
+
 struct ParamInitInfo {
   ParamType param_type_{kUnKnown};
   size_t global_seed_{0};
@@ -46,6 +49,7 @@ class Util {
   static std::string optimizer_name(int64_t id);
   static std::string optimizer_node_name(int64_t id);
   static bool is_optimizer(std::string name);
+  static bool is_sparse_optimizer(int64_t id);
   static int64_t LocalShard(int64_t first_dim, int64_t rank_id, int64_t server_num);
   static std::map<int64_t, int64_t> AllRankLocalShard(int64_t first_dim, int64_t rank_id, int64_t server_num);
   static void ReduceSparseGradient(float *gradients, int *indices, const size_t indices_size, size_t segment_size,
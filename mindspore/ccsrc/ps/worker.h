@@ -31,6 +31,7 @@
 #include "ps/util.h"
 #include "ps/common.h"
 #include "ps/worker_proxy.h"
+#include "ps/compression.h"
 #include "utils/shape_utils.h"
 #include "ps/ps_cache/ps_data/ps_data_prefetch.h"
 
@@ -71,6 +72,7 @@ class Worker {
 
   bool IsKeyInit(const size_t key);
   void InitPSOptimId(const size_t param_key);
+  void InitPSKeyCodec(const size_t param_key, bool cache_table = false);
   void InitPSOptimInputShapes(const size_t key);
   void InitPSParamData(const std::vector<size_t> &keys, void *origin_addr, size_t size);
   static void EmbeddingLookupIdSlicer(const ::ps::KVPairs<T> &send, const std::vector<::ps::Range> &ranges,
@@ -319,6 +321,25 @@ void Worker<T>::InitPSOptimId(const size_t param_key) {
   kv_worker_->PushData(keys, optim_id_vals, optim_id_lens, kInitWeightToOptimIdCmd);
 }
 
+template <typename T>
+void Worker<T>::InitPSKeyCodec(const size_t param_key, bool cache_table) {
+  CompressCodec codec = StringToCodec(PSContext::instance()->compression());
+  // the sparse gradients and the lookups of the key are rows of its embedding table, the rows of a table of the ps
+  // cache are swapped in and out
+  if (cache_table || Util::is_sparse_optimizer(key_to_optimId_[param_key])) {
+    codec = CastCodec(codec);
+  }
+  if (codec == kCodecNone) {
+    return;
+  }
+  // the servers decode the pushes and encode the pulls of the key with the codec from now on
+  ::ps::SArray<::ps::Key> keys = {param_key};
+  ::ps::SArray<T> codec_vals = {static_cast<T>(codec)};
+  ::ps::SArray<int> codec_lens = {codec_vals.size()};
+  kv_worker_->PushData(keys, codec_vals, codec_lens, kInitKeyCodecCmd);
+  kv_worker_->SetKeyCodec(param_key, codec, cache_table);
+}
+
 template <typename T>
 void Worker<T>::InitPSEmbeddingTable(const std::vector<size_t> &keys, std::vector<T> shapes, const ShapeVector &sizes) {
   bool has_init = IsKeyInit(keys[0]);
@@ -335,6 +356,9 @@ void Worker<T>::InitPSEmbeddingTable(const std::vector<size_t> &keys, std::vecto
                        [](const int64_t &value) { return static_cast<int>(value); });
   kv_worker_->Wait(
     kv_worker_->InitEmbeddingTable(::ps::SArray<::ps::Key>(keys), shapes_val, ::ps::SArray<int>(sizes_int)));
+  if (PsDataPrefetch::GetInstance().cache_enable()) {
+    InitPSKeyCodec(keys[0], true);
+  }
 }
 
 template <typename T>
@@ -373,6 +397,7 @@ void Worker<T>::InitPSParamAndOptim(const AnfNodePtr &input_node, const tensor::
       }
       InitPSOptimId(param_key);
       InitPSOptimInputShapes(param_key);
+      InitPSKeyCodec(param_key);
     }
   }
 }
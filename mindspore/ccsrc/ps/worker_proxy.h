@@ -17,6 +17,7 @@
 #ifndef MINDSPORE_CCSRC_PS_WORKER_PROXY_H_
 #define MINDSPORE_CCSRC_PS_WORKER_PROXY_H_
 
+#include <atomic>
 #include <map>
 #include <numeric>
 #include <functional>
@@ -28,6 +29,7 @@
 #include <vector>
 #include "ps/ps.h"
 #include "ps/util.h"
+#include "ps/compression.h"
 #include "backend/kernel_compiler/common_utils.h"
 #include "ps/ps_context.h"
 
@@ -67,6 +69,7 @@ class WorkerProxy : public ::ps::KVWorker<T> {
 
   void AddEmbeddingTable(const ::ps::Key &key, const size_t &row_count);
   void AddKeyToServerId(const ::ps::Key &key);
+  void SetKeyCodec(const ::ps::Key &key, CompressCodec codec, bool delta_rows = false);
   void EmbeddingLookup(const ::ps::SArray<::ps::Key> &keys, const ::ps::SArray<int> &lookup_ids,
                        const ::ps::SArray<int> &lens, ::ps::SArray<T> *outs, int64_t cmd = 0,
                        const Callback &cb = nullptr, int64_t priority = 0);
@@ -110,6 +113,11 @@ class WorkerProxy : public ::ps::KVWorker<T> {
   void Send(::ps::Customer *customer, int64_t timestamp, bool push, bool pull, int64_t cmd, const ::ps::KVPairs<T> &kvs,
             const Slicer &slicer, std::map<int64_t, int64_t> attrs = {});
   void AddKeyByHashMod(const ::ps::Key &key);
+  CompressCodec KeyCodec(const ::ps::Key &key);
+  std::vector<T> *KeyCodecState(std::unordered_map<::ps::Key, std::vector<T>> *states, const ::ps::Key &key);
+  void EncodeSparseValues(const ::ps::Key &key, size_t grad_index, ::ps::KVPairs<T> *kvs);
+  void KeepSwapInRows(const ::ps::Key &key, const ::ps::KVPairs<T> &kvs, size_t embedding_dim);
+  void EncodeRowDeltas(const ::ps::Key &key, size_t embedding_dim, ::ps::KVPairs<T> *kvs);
 
   void PrepareSparseGradient(const size_t begin, const size_t end, const std::unordered_set<int> &distinct_ids,
                              const std::vector<std::pair<int, T *>> &indice_to_grad, const int *all_indice,
@@ -135,6 +143,20 @@ class WorkerProxy : public ::ps::KVWorker<T> {
   std::unordered_map<int64_t, int64_t> expected_result_count_;
   std::unordered_map<::ps::Key, int64_t> key_to_server_id_;
   std::unordered_map<::ps::Key, size_t> embedding_row_cnt_;
+  // codecs of the keys negotiated with the servers, the residuals of the keys using topk, the weights pulled last
+  // and the ids of the snapshots of the servers they are. The residuals and the weights are guarded by codec_mutex_.
+  std::unordered_map<::ps::Key, CompressCodec> key_codecs_;
+  std::unordered_map<::ps::Key, std::vector<T>> topk_residuals_;
+  std::unordered_map<::ps::Key, std::vector<T>> pull_bases_;
+  std::unordered_map<::ps::Key, uint32_t> pull_snapshot_ids_;
+  // The rows of the tables of the ps cache as they were swapped in from the servers, by id, until they are swapped
+  // out as their deltas against them. Guarded by codec_mutex_.
+  std::unordered_map<::ps::Key, std::unordered_map<::ps::Key, std::vector<T>>> swap_in_rows_;
+  std::mutex codec_mutex_;
+  float topk_ratio_{kDefaultTopKRatio};
+  // bytes of the values sent and received, for comparing the codecs
+  std::atomic<uint64_t> sent_bytes_{0};
+  std::atomic<uint64_t> received_bytes_{0};
 };
 
 template <typename T>
@@ -173,6 +195,56 @@ void WorkerProxy<T>::AddKeyToServerId(const ::ps::Key &key) {
   AddKeyByHashMod(key);
 }
 
+template <typename T>
+void WorkerProxy<T>::SetKeyCodec(const ::ps::Key &key, CompressCodec codec, bool delta_rows) {
+  key_codecs_[key] = codec;
+  topk_ratio_ = PSContext::instance()->topk_ratio();
+  if (delta_rows) {
+    std::lock_guard<std::mutex> lock(codec_mutex_);
+    (void)swap_in_rows_[key];
+  }
+  MS_LOG(INFO) << "The codec of key " << key << " is " << codec << ", rows sent as deltas: " << delta_rows;
+}
+
+template <typename T>
+CompressCodec WorkerProxy<T>::KeyCodec(const ::ps::Key &key) {
+  auto iter = key_codecs_.find(key);
+  return iter == key_codecs_.end() ? kCodecNone : iter->second;
+}
+
+template <typename T>
+std::vector<T> *WorkerProxy<T>::KeyCodecState(std::unordered_map<::ps::Key, std::vector<T>> *states,
+                                              const ::ps::Key &key) {
+  MS_EXCEPTION_IF_NULL(states);
+  std::lock_guard<std::mutex> lock(codec_mutex_);
+  return &(*states)[key];
+}
+
+template <typename T>
+void WorkerProxy<T>::EncodeSparseValues(const ::ps::Key &key, size_t grad_index, ::ps::KVPairs<T> *kvs) {
+  MS_EXCEPTION_IF_NULL(kvs);
+  CompressCodec codec = KeyCodec(key);
+  if (codec == kCodecNone) {
+    return;
+  }
+  // the message to a server without rows of the gradient has no lengths
+  ::ps::SArray<int> lens = kvs->lens;
+  if (lens.empty()) {
+    lens.push_back(kvs->vals.size());
+  }
+  // the indices and the other inputs are sent exactly
+  std::vector<CompressCodec> codecs(lens.size(), kCodecNone);
+  if (grad_index < codecs.size()) {
+    codecs[grad_index] = codec;
+  }
+  ::ps::SArray<T> encoded(EncodedSize(codecs.data(), lens.data(), lens.size(), 0), 0);
+  ::ps::SArray<int> encoded_lens(lens.size(), 0);
+  EncodeValues(codecs.data(), kvs->vals.data(), lens.data(), lens.size(), 0, nullptr, encoded.data(),
+               encoded_lens.data());
+  kvs->vals = encoded;
+  kvs->lens = encoded_lens;
+}
+
 template <typename T>
 void WorkerProxy<T>::EmbeddingLookup(const ::ps::SArray<::ps::Key> &keys, const ::ps::SArray<int> &lookup_ids,
                                      const ::ps::SArray<int> &lens, ::ps::SArray<T> *outs, int64_t cmd,
@@ -252,6 +324,19 @@ void WorkerProxy<T>::PushData(const ::ps::SArray<::ps::Key> &keys, const ::ps::S
   kvs.vals = vals;
   kvs.lens = lens;
   kvs.priority = priority;
+  CompressCodec codec = cmd == 0 ? KeyCodec(keys[0]) : kCodecNone;
+  if (codec != kCodecNone) {
+    T *residual = nullptr;
+    if (codec == kCodecTopK) {
+      auto key_residual = KeyCodecState(&topk_residuals_, keys[0]);
+      key_residual->resize(vals.size(), 0);
+      residual = key_residual->data();
+    }
+    kvs.vals = ::ps::SArray<T>(EncodedSize(codec, lens.data(), lens.size(), topk_ratio_), 0);
+    kvs.lens = ::ps::SArray<int>(lens.size(), 0);
+    EncodeValues(codec, vals.data(), lens.data(), lens.size(), topk_ratio_, residual, kvs.vals.data(),
+                 kvs.lens.data());
+  }
   if (embedding_table_ranges_.count(keys[0])) {
     if (cmd == kInitWeightsCmd) {
       Send(general_customer_.get(), ts, true, false, cmd, kvs, worker_init_embedding_slicer_);
@@ -281,6 +366,7 @@ void WorkerProxy<T>::PushSparseData(const ::ps::SArray<::ps::Key> &keys, const :
     std::map<int64_t, int64_t> attrs{{0, grad_index}, {1, indice_index}, {2, first_dim_size}, {3, outer_dim_size}};
     Send(general_customer_.get(), ts, true, false, cmd, kvs, sparse_slicer_, attrs);
   } else {
+    EncodeSparseValues(keys[0], grad_index, &kvs);
     Send(general_customer_.get(), ts, true, false, cmd, kvs, round_robin_slicer_);
   }
   if (expected_result_count_[ts] < server_num_) {
@@ -297,7 +383,15 @@ void WorkerProxy<T>::PullData(const ::ps::SArray<::ps::Key> &keys, ::ps::SArray<
   ::ps::KVPairs<T> kvs;
   kvs.keys = keys;
   kvs.priority = priority;
-  if (embedding_table_ranges_.count(keys[0])) {
+  bool embedding_table = embedding_table_ranges_.count(keys[0]) > 0;
+  CompressCodec codec = cmd == 0 && !embedding_table ? CastCodec(KeyCodec(keys[0])) : kCodecNone;
+  if (codec != kCodecNone) {
+    // the server sends the snapshot of the weights as the delta against the one this worker holds
+    std::lock_guard<std::mutex> lock(codec_mutex_);
+    kvs.vals = {static_cast<T>(pull_snapshot_ids_[keys[0]])};
+    kvs.lens = {1};
+  }
+  if (embedding_table) {
     Send(general_customer_.get(), ts, false, true, cmd, kvs, broadcast_slicer_);
   } else {
     Send(general_customer_.get(), ts, false, true, cmd, kvs, round_robin_slicer_);
@@ -306,10 +400,32 @@ void WorkerProxy<T>::PullData(const ::ps::SArray<::ps::Key> &keys, ::ps::SArray<
     general_customer_->AddResponse(ts, server_num_ - expected_result_count_[ts]);
   }
   general_customer_->WaitRequest(ts);
+  if (codec != kCodecNone) {
+    // the id of the snapshot followed by its delta, the snapshot whole, or nothing when it is the one held
+    if (vals->empty()) {
+      MS_LOG(EXCEPTION) << "The pull of key " << keys[0] << " has no snapshot id";
+    }
+    auto snapshot_id = static_cast<uint32_t>((*vals)[0]);
+    ::ps::SArray<T> encoded = vals->segment(1, vals->size());
+    size_t segment_num = 0;
+    size_t decoded_size = DecodedSize(encoded.data(), encoded.size(), &segment_num);
+    auto base = KeyCodecState(&pull_bases_, keys[0]);
+    if (segment_num > 0) {
+      base->resize(decoded_size, 0);
+      ::ps::SArray<T> decoded(decoded_size, 0);
+      DecodeValues(encoded.data(), encoded.size(), decoded.data(), decoded.size(), nullptr, base->data());
+      (void)std::copy(decoded.begin(), decoded.end(), base->begin());
+    }
+    *vals = ::ps::SArray<T>(base->size(), 0);
+    (void)std::copy(base->begin(), base->end(), vals->begin());
+    std::lock_guard<std::mutex> lock(codec_mutex_);
+    pull_snapshot_ids_[keys[0]] = snapshot_id;
+  }
 }
 
 template <typename T>
 void WorkerProxy<T>::Finalize() {
+  MS_LOG(INFO) << "Bytes of the values sent by the worker: " << sent_bytes_ << ", received: " << received_bytes_;
   int64_t ts = obj_->NewRequest(::ps::kServerGroup);
   ::ps::KVPairs<T> kvs;
   kvs.keys.push_back(0);
@@ -334,8 +450,22 @@ int64_t WorkerProxy<T>::AddLookupCB(const ::ps::SArray<::ps::Key> &keys, const :
       MS_LOG(EXCEPTION) << "Lookup id is empty.";
     }
     int64_t single_id_len = SizeToLong(lookup_result->size() / lookup_ids.size());
+    // the servers cast the rows with the codec of the table
+    if (CastCodec(KeyCodec(keys[0])) != kCodecNone) {
+      for (auto &s : kvs) {
+        ::ps::SArray<T> encoded = s.vals;
+        size_t segment_num = 0;
+        s.vals = ::ps::SArray<T>(DecodedSize(encoded.data(), encoded.size(), &segment_num), 0);
+        DecodeValues(encoded.data(), encoded.size(), s.vals.data(), s.vals.size());
+        KeepSwapInRows(keys[0], s, LongToSize(single_id_len));
+      }
+    }
     std::unordered_map<Key, std::shared_ptr<std::pair<T *, int64_t>>> id_addr_map;
     for (const auto &s : kvs) {
+      if (s.keys.size() * single_id_len > s.vals.size()) {
+        MS_LOG(EXCEPTION) << "The lookup result of " << s.keys.size() << " ids has " << s.vals.size()
+                          << " values, each id has " << single_id_len;
+      }
       int64_t offset = 0;
       for (size_t i = 0; i < s.keys.size(); i++) {
         const Key &key = s.keys[i];
@@ -383,6 +513,63 @@ int64_t WorkerProxy<T>::AddLookupCB(const ::ps::SArray<::ps::Key> &keys, const :
   return ts;
 }
 
+// Keep the rows of a table of the ps cache as they were swapped in.
+template <typename T>
+void WorkerProxy<T>::KeepSwapInRows(const ::ps::Key &key, const ::ps::KVPairs<T> &kvs, size_t embedding_dim) {
+  std::lock_guard<std::mutex> lock(codec_mutex_);
+  auto rows_iter = swap_in_rows_.find(key);
+  if (rows_iter == swap_in_rows_.end()) {
+    return;
+  }
+  if (kvs.keys.size() * embedding_dim > kvs.vals.size()) {
+    MS_LOG(EXCEPTION) << "The lookup result of " << kvs.keys.size() << " ids has " << kvs.vals.size()
+                      << " values, each id has " << embedding_dim;
+  }
+  for (size_t i = 0; i < kvs.keys.size(); i++) {
+    auto row = kvs.vals.data() + i * embedding_dim;
+    rows_iter->second[kvs.keys[i]].assign(row, row + embedding_dim);
+  }
+}
+
+// Encode the rows of a table of the ps cache sent to a server as their deltas against the rows swapped in, which
+// keeps the rounding of the codec out of the rows of the servers. The rows leave the cache of the worker.
+template <typename T>
+void WorkerProxy<T>::EncodeRowDeltas(const ::ps::Key &key, size_t embedding_dim, ::ps::KVPairs<T> *kvs) {
+  MS_EXCEPTION_IF_NULL(kvs);
+  CompressCodec codec = CastCodec(KeyCodec(key));
+  std::vector<T> base(kvs->vals.size(), 0);
+  bool has_base = true;
+  {
+    std::lock_guard<std::mutex> lock(codec_mutex_);
+    auto rows_iter = swap_in_rows_.find(key);
+    if (codec == kCodecNone || rows_iter == swap_in_rows_.end()) {
+      return;
+    }
+    auto &rows = rows_iter->second;
+    for (size_t i = 1; i < kvs->keys.size(); i++) {
+      auto row_iter = rows.find(kvs->keys[i]);
+      if (row_iter == rows.end() || row_iter->second.size() != embedding_dim) {
+        has_base = false;
+        continue;
+      }
+      (void)std::copy(row_iter->second.begin(), row_iter->second.end(), base.begin() + (i - 1) * embedding_dim);
+      (void)rows.erase(row_iter);
+    }
+  }
+  ::ps::SArray<T> encoded;
+  if (has_base) {
+    encoded = ::ps::SArray<T>(DeltaEncodedSize(codec, kvs->vals.size()), 0);
+    EncodeDelta(codec, kvs->vals.data(), kvs->vals.size(), base.data(), encoded.data());
+  } else {
+    // some rows were not swapped in by this worker, the rows are sent whole
+    int len = SizeToInt(kvs->vals.size());
+    int encoded_len = 0;
+    encoded = ::ps::SArray<T>(EncodedSize(codec, &len, 1, 0), 0);
+    EncodeValues(codec, kvs->vals.data(), &len, 1, 0, nullptr, encoded.data(), &encoded_len);
+  }
+  kvs->vals = encoded;
+}
+
 template <typename T>
 int64_t WorkerProxy<T>::AddGeneralRspCB(const ::ps::SArray<::ps::Key> &keys, ::ps::SArray<T> *vals,
                                         ::ps::SArray<int> *lens, int64_t cmd, const Callback &cb) {
@@ -566,6 +753,7 @@ void WorkerProxy<T>::SparseSlicer(int64_t timestamp, const ::ps::KVPairs<T> &sen
       kvs.vals = no_vals;
       kvs.lens = no_lens;
     }
+    EncodeSparseValues(key, grad_index, &kvs);
     sliced->at(i).first = true;
     expected_result_count_[timestamp] += 1;
   }
@@ -785,6 +973,7 @@ void WorkerProxy<T>::UpdateEmbeddingSlicer(int timestamp, const ::ps::KVPairs<T>
     if (kvs.keys.size() <= 1) {
       sliced->at(i).first = false;
     } else {
+      EncodeRowDeltas(key, embedding_dim, &kvs);
       sliced->at(i).first = true;
       expected_result_count_[timestamp] += 1;
     }
@@ -825,6 +1014,7 @@ void WorkerProxy<T>::ProcessResponse(const ::ps::Message &msg) {
     if (msg.data.size() > (size_t)2) {
       kvs.lens = msg.data[2];
     }
+    received_bytes_ += kvs.vals.size() * sizeof(T);
     mutex_.lock();
     int rsp_server_rank = ::ps::Postoffice::Get()->IDtoRank(msg.meta.sender);
     gathered_response_[ts][rsp_server_rank] = kvs;
@@ -861,6 +1051,7 @@ void WorkerProxy<T>::Send(::ps::Customer *customer, int64_t timestamp, bool push
     if (kvs.keys.size()) {
       msg.AddData(kvs.keys);
       msg.AddData(kvs.vals);
+      sent_bytes_ += kvs.vals.size() * sizeof(T);
       if (kvs.lens.size()) {
         msg.AddData(kvs.lens);
       }
@@ -247,6 +247,7 @@ void PrimitivePy::AddPyAttr(const py::str &name, const py::object &obj) {
     MS_LOG(EXCEPTION) << "Attribute convert error with type: " << std::string(py::str(obj));
   }
   (void)this->AddAttr(attr_name, converted_ret);
+  ++attr_version_;
 }
 
 py::dict PrimitivePy::GetAttrDict() {
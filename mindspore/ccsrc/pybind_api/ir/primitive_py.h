@@ -48,6 +48,8 @@ class PrimitivePy : public Primitive {
   void CopyHookFunction(const PrimitivePtr &primitive) override;
 
   void AddPyAttr(const py::str &name, const py::object &obj);
+  // bumped by every attr set from python, abstracts inferred with other attrs are out of date
+  uint64_t attr_version() const { return attr_version_; }
 
   py::dict GetAttrDict();
   void set_hook(const py::function &hook) { hook_ = hook; }
@@ -75,6 +77,7 @@ class PrimitivePy : public Primitive {
   py::function hook_;
   std::vector<Signature> signatures_;
   static std::map<std::string, py::object> hook_grad_;
+  uint64_t attr_version_ = 0;
 };
 
 using PrimitivePyPtr = std::shared_ptr<PrimitivePy>;
@@ -0,0 +1,180 @@
+/**
+ * Copyright 2021 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "runtime/device/cpu/cpu_data_queue.h"
+#include <cstdlib>
+#include <chrono>
+
+namespace mindspore {
+namespace device {
+namespace cpu {
+CpuDataQueue::CpuDataQueue(size_t capacity)
+    : capacity_(capacity), head_(0), tail_(0), size_(0), reserved_(false), closed_(false) {
+  slots_ = std::make_unique<Slot[]>(capacity_);
+}
+
+CpuDataQueue::~CpuDataQueue() {
+  for (size_t i = 0; i < capacity_; i++) {
+    for (auto &item : slots_[i].items_) {
+      free(item.data_ptr_);
+    }
+  }
+}
+
+CpuQueueStatus CpuDataQueue::Reserve(const std::vector<size_t> &lens, std::vector<DataItemCpu> *items,
+                                     unsigned int timeout_in_sec) {
+  if (items == nullptr || lens.empty()) {
+    return kCpuQueueErrorInput;
+  }
+  std::unique_lock<std::mutex> locker(mutex_);
+  if (!not_full_cond_.wait_for(locker, std::chrono::seconds(timeout_in_sec),
+                               [this] { return closed_ || size_ < capacity_; })) {
+    return kCpuQueueTimeout;
+  }
+  if (closed_) {
+    return kCpuQueueClosed;
+  }
+  if (reserved_) {
+    return kCpuQueueErrorInput;
+  }
+  // The slot is not visible to the consumer until Commit. Buffers only grow, so a batch of the same shape as the
+  // previous one reuses the memory as is.
+  Slot &slot = slots_[tail_];
+  if (slot.items_.size() < lens.size()) {
+    slot.items_.resize(lens.size(), DataItemCpu{0, nullptr});
+    slot.buffer_lens_.resize(lens.size(), 0);
+  }
+  for (size_t i = 0; i < lens.size(); i++) {
+    if (slot.buffer_lens_[i] < lens[i]) {
+      free(slot.items_[i].data_ptr_);
+      slot.items_[i].data_ptr_ = nullptr;
+      slot.buffer_lens_[i] = 0;
+      if (posix_memalign(&slot.items_[i].data_ptr_, kCpuDataQueueAlign, lens[i]) != 0) {
+        slot.items_[i].data_ptr_ = nullptr;
+        return kCpuQueueErrorInput;
+      }
+      slot.buffer_lens_[i] = lens[i];
+    }
+    slot.items_[i].data_len_ = lens[i];
+  }
+  items->assign(slot.items_.begin(), slot.items_.begin() + lens.size());
+  reserved_ = true;
+  return kCpuQueueSuccess;
+}
+
+CpuQueueStatus CpuDataQueue::Commit() {
+  {
+    std::lock_guard<std::mutex> locker(mutex_);
+    if (!reserved_) {
+      return kCpuQueueErrorInput;
+    }
+    reserved_ = false;
+    tail_ = (tail_ + 1) % capacity_;
+    size_++;
+  }
+  not_empty_cond_.notify_one();
+  return kCpuQueueSuccess;
+}
+
+CpuQueueStatus CpuDataQueue::Front(std::vector<DataItemCpu> *items, unsigned int timeout_in_sec) {
+  if (items == nullptr) {
+    return kCpuQueueErrorInput;
+  }
+  std::unique_lock<std::mutex> locker(mutex_);
+  if (!not_empty_cond_.wait_for(locker, std::chrono::seconds(timeout_in_sec),
+                                [this] { return closed_ || size_ > 0; })) {
+    return kCpuQueueTimeout;
+  }
+  if (size_ == 0) {
+    return kCpuQueueClosed;
+  }
+  *items = slots_[head_].items_;
+  return kCpuQueueSuccess;
+}
+
+CpuQueueStatus CpuDataQueue::Pop() {
+  {
+    std::lock_guard<std::mutex> locker(mutex_);
+    if (size_ == 0) {
+      return kCpuQueueErrorInput;
+    }
+    head_ = (head_ + 1) % capacity_;
+    size_--;
+  }
+  not_full_cond_.notify_one();
+  return kCpuQueueSuccess;
+}
+
+void CpuDataQueue::Close() {
+  {
+    std::lock_guard<std::mutex> locker(mutex_);
+    closed_ = true;
+  }
+  not_full_cond_.notify_all();
+  not_empty_cond_.notify_all();
+}
+
+size_t CpuDataQueue::Size() {
+  std::lock_guard<std::mutex> locker(mutex_);
+  return size_;
+}
+
+CpuDataQueueMgr &CpuDataQueueMgr::GetInstance() noexcept {
+  static CpuDataQueueMgr instance;
+  return instance;
+}
+
+std::shared_ptr<CpuDataQueue> CpuDataQueueMgr::Create(const std::string &channel_name, size_t capacity) {
+  std::shared_ptr<CpuDataQueue> queue;
+  {
+    std::lock_guard<std::mutex> locker(mutex_);
+    auto iter = queues_.find(channel_name);
+    if (iter != queues_.end()) {
+      return iter->second;
+    }
+    queue = std::make_shared<CpuDataQueue>(capacity);
+    queues_[channel_name] = queue;
+  }
+  created_cond_.notify_all();
+  return queue;
+}
+
+std::shared_ptr<CpuDataQueue> CpuDataQueueMgr::Get(const std::string &channel_name, unsigned int timeout_in_sec) {
+  std::unique_lock<std::mutex> locker(mutex_);
+  (void)created_cond_.wait_for(locker, std::chrono::seconds(timeout_in_sec),
+                               [this, &channel_name] { return queues_.find(channel_name) != queues_.end(); });
+  auto iter = queues_.find(channel_name);
+  return iter == queues_.end() ? nullptr : iter->second;
+}
+
+void CpuDataQueueMgr::Destroy(const std::string &channel_name) {
+  std::lock_guard<std::mutex> locker(mutex_);
+  auto iter = queues_.find(channel_name);
+  if (iter != queues_.end()) {
+    iter->second->Close();
+    (void)queues_.erase(iter);
+  }
+}
+
+void CpuDataQueueMgr::CloseAll() {
+  std::lock_guard<std::mutex> locker(mutex_);
+  for (auto &iter : queues_) {
+    iter.second->Close();
+  }
+}
+}  // namespace cpu
+}  // namespace device
+}  // namespace mindspore
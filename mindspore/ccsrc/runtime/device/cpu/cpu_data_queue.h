@@ -0,0 +1,123 @@
+/**
+ * Copyright 2021 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MINDSPORE_CCSRC_RUNTIME_DEVICE_CPU_CPU_DATA_QUEUE_H_
+#define MINDSPORE_CCSRC_RUNTIME_DEVICE_CPU_CPU_DATA_QUEUE_H_
+
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#define EXPORT __attribute__((visibility("default")))
+
+namespace mindspore {
+namespace device {
+namespace cpu {
+// Two slots: the graph reads one batch while the dataset writes the next one.
+constexpr size_t kCpuDataQueueCapacity = 2;
+constexpr size_t kCpuDataQueueAlign = 64;
+constexpr unsigned int kCpuDataQueueWaitTimeInSec = 60;
+
+enum CpuQueueStatus : int {
+  kCpuQueueSuccess = 0,
+  kCpuQueueNotExist,
+  kCpuQueueErrorInput,
+  kCpuQueueTimeout,
+  kCpuQueueClosed
+};
+
+struct DataItemCpu {
+  size_t data_len_;
+  void *data_ptr_;
+};
+
+// A bounded single-producer single-consumer queue of staging slots. The memory of every slot is allocated once and
+// reused for the following batches, the producer writes a batch straight into a slot and the consumer binds the slot
+// memory as graph inputs, so a batch is never copied between the dataset and the kernels.
+class CpuDataQueue {
+ public:
+  explicit CpuDataQueue(size_t capacity);
+  ~CpuDataQueue();
+
+  // Producer: get the buffers of the next free slot, sized by lens. Blocks while all slots are in use, so the batches
+  // produced before the consumer starts stay staged in the free slots until it pops them.
+  CpuQueueStatus Reserve(const std::vector<size_t> &lens, std::vector<DataItemCpu> *items,
+                         unsigned int timeout_in_sec);
+  // Producer: hand the slot returned by the last Reserve over to the consumer.
+  CpuQueueStatus Commit();
+  // Consumer: get the buffers of the oldest committed slot. Blocks while no slot is committed, the slots committed
+  // before Close are still returned.
+  CpuQueueStatus Front(std::vector<DataItemCpu> *items, unsigned int timeout_in_sec);
+  // Consumer: give the slot returned by Front back to the producer.
+  CpuQueueStatus Pop();
+  // Wake up both sides, Reserve returns kCpuQueueClosed at once and Front once the committed slots are drained.
+  void Close();
+
+  size_t Size();
+  size_t Capacity() const { return capacity_; }
+
+ private:
+  struct Slot {
+    std::vector<DataItemCpu> items_;
+    std::vector<size_t> buffer_lens_;
+  };
+
+  std::mutex mutex_;
+  std::condition_variable not_full_cond_;
+  std::condition_variable not_empty_cond_;
+  std::unique_ptr<Slot[]> slots_;
+  size_t capacity_;
+  size_t head_;
+  size_t tail_;
+  size_t size_;
+  bool reserved_;
+  bool closed_;
+
+  CpuDataQueue(const CpuDataQueue &) = delete;
+  CpuDataQueue &operator=(const CpuDataQueue &) = delete;
+};
+
+// Process-wide registry of the staging queues, shared by the dataset engine and the CPU runtime by channel name.
+class CpuDataQueueMgr {
+ public:
+  EXPORT static CpuDataQueueMgr &GetInstance() noexcept;
+
+  // Create the queue of the channel, or return it if it already exists.
+  EXPORT std::shared_ptr<CpuDataQueue> Create(const std::string &channel_name, size_t capacity);
+  // Return the queue of the channel, waiting up to timeout_in_sec for its producer to create it.
+  EXPORT std::shared_ptr<CpuDataQueue> Get(const std::string &channel_name, unsigned int timeout_in_sec);
+  EXPORT void Destroy(const std::string &channel_name);
+  EXPORT void CloseAll();
+
+ private:
+  CpuDataQueueMgr() = default;
+  ~CpuDataQueueMgr() = default;
+
+  std::mutex mutex_;
+  std::condition_variable created_cond_;
+  std::map<std::string, std::shared_ptr<CpuDataQueue>> queues_;
+
+  CpuDataQueueMgr(const CpuDataQueueMgr &) = delete;
+  CpuDataQueueMgr &operator=(const CpuDataQueueMgr &) = delete;
+};
+}  // namespace cpu
+}  // namespace device
+}  // namespace mindspore
+
+#endif  // MINDSPORE_CCSRC_RUNTIME_DEVICE_CPU_CPU_DATA_QUEUE_H_
@@ -113,18 +113,18 @@ void CPUKernelRuntime::AssignInputNodeAddress(const session::KernelGraph *kernel
 
 void CPUKernelRuntime::AssignKernelOutputAddress(const session::KernelGraph *kernel_graph) {
   MS_EXCEPTION_IF_NULL(kernel_graph);
-  auto kernels = kernel_graph->execution_order();
+  const auto &kernels = kernel_graph->execution_order();
   for (auto &kernel : kernels) {
     auto kernel_mod = AnfAlgo::GetKernelMod(kernel);
     MS_EXCEPTION_IF_NULL(kernel_mod);
-    auto output_sizes = kernel_mod->GetOutputSizeList();
+    const auto &output_sizes = kernel_mod->GetOutputSizeList();
     for (size_t i = 0; i < output_sizes.size(); ++i) {
       auto output_format = AnfAlgo::GetOutputFormat(kernel, i);
       auto output_type = AnfAlgo::GetOutputDeviceDataType(kernel, i);
       AnfAlgo::SetOutputAddr(CreateDeviceAddress(nullptr, output_sizes[i], output_format, output_type), i,
                              kernel.get());
     }
-    auto workspace_sizes = kernel_mod->GetWorkspaceSizeList();
+    const auto &workspace_sizes = kernel_mod->GetWorkspaceSizeList();
     for (size_t i = 0; i < workspace_sizes.size(); ++i) {
       AnfAlgo::SetWorkspaceAddr(CreateDeviceAddress(nullptr, workspace_sizes[i], kOpFormat_DEFAULT, kNumberTypeFloat32),
                                 i, kernel.get());
@@ -338,11 +338,57 @@ void CPUKernelRuntime::DecreaseSummaryRefCount(const session::NamedSummaryOutput
   resource_manager_.DecreaseSummaryRefCount(summary_outputs);
 }
 
+#ifdef ENABLE_CPUQUE
+void CPUKernelRuntime::BindDatasetIteratorOutputs(const CNodePtr &kernel, kernel::DatasetIteratorCPUKernel *iterator) {
+  MS_EXCEPTION_IF_NULL(iterator);
+  std::vector<DataItemCpu> items;
+  if (!iterator->BindFrontData(&items)) {
+    MS_LOG(EXCEPTION) << "Get data from the dataset queue failed. Trace:" << trace::DumpSourceLines(kernel);
+  }
+  dataset_iterators_.push_back(iterator);
+  for (size_t i = 0; i < items.size(); ++i) {
+    auto device_address = AnfAlgo::GetMutableOutputAddr(kernel, i);
+    MS_EXCEPTION_IF_NULL(device_address);
+    if (bound_addresses_.find(device_address) != bound_addresses_.end()) {
+      continue;
+    }
+    dataset_bound_ptrs_.emplace_back(device_address.get(), device_address->ptr_);
+    device_address->ptr_ = items[i].data_ptr_;
+  }
+}
+
+// Gives the bound dataset slots back when Run leaves, also when a kernel throws, otherwise the producer would wait on
+// a slot that is never popped and the next step would see stale bindings.
+class DatasetIteratorReleaser {
+ public:
+  explicit DatasetIteratorReleaser(CPUKernelRuntime *runtime) : runtime_(runtime) {}
+  ~DatasetIteratorReleaser() { runtime_->ReleaseDatasetIterators(); }
+
+ private:
+  CPUKernelRuntime *runtime_;
+};
+
+void CPUKernelRuntime::ReleaseDatasetIterators() {
+  for (auto &item : dataset_bound_ptrs_) {
+    item.first->ptr_ = item.second;
+  }
+  dataset_bound_ptrs_.clear();
+  for (auto iterator : dataset_iterators_) {
+    iterator->ReleaseFrontData();
+  }
+  dataset_iterators_.clear();
+}
+#endif
+
 bool CPUKernelRuntime::Run(session::KernelGraph *kernel_graph, bool is_task_sink) {
   MS_EXCEPTION_IF_NULL(kernel_graph);
   resource_manager_.IncreaseAddressRefCount(kernel_graph);
+#ifdef ENABLE_CPUQUE
+  // The batch has been consumed when Run returns, the dataset fills the slot while the next step runs.
+  DatasetIteratorReleaser releaser(this);
+#endif
 
-  auto kernels = kernel_graph->execution_order();
+  const auto &kernels = kernel_graph->execution_order();
   for (const auto &kernel : kernels) {
 #ifdef ENABLE_PROFILE
     double start_time = GetTime();
@@ -359,6 +405,12 @@ bool CPUKernelRuntime::Run(session::KernelGraph *kernel_graph, bool is_task_sink
       MS_EXCEPTION_IF_NULL(device_address);
       AddRuntimeAddress(device_address, &kernel_inputs);
     }
+#ifdef ENABLE_CPUQUE
+    auto iterator = dynamic_cast<kernel::DatasetIteratorCPUKernel *>(AnfAlgo::GetKernelMod(kernel));
+    if (iterator != nullptr) {
+      BindDatasetIteratorOutputs(kernel, iterator);
+    }
+#endif
     size_t output_num = AnfAlgo::GetOutputTensorNum(kernel);
     for (size_t i = 0; i < output_num; ++i) {
       auto device_address = AnfAlgo::GetMutableOutputAddr(kernel, i).get();
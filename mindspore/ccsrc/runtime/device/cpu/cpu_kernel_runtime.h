@@ -21,12 +21,16 @@
 #include <string>
 #include <map>
 #include <set>
+#include <utility>
 #include "runtime/device/kernel_runtime.h"
 #include "backend/session/kernel_graph.h"
 #include "backend/session/session_basic.h"
 #include "runtime/device/cpu/cpu_resource_manager.h"
 #include "backend/session/anf_runtime_algorithm.h"
 #include "utils/any.h"
+#ifdef ENABLE_CPUQUE
+#include "backend/kernel_compiler/cpu/dataset_iterator_cpu_kernel.h"
+#endif
 namespace mindspore {
 namespace device {
 namespace cpu {
@@ -63,6 +67,14 @@ class CPUKernelRuntime : public KernelRuntime {
   void AssignInputNodeAddress(const session::KernelGraph *kernel_graph);
   void AssignKernelOutputAddress(const session::KernelGraph *kernel_graph);
   void AddRuntimeAddress(DeviceAddress *address, std::vector<kernel::AddressPtr> *input_list);
+#ifdef ENABLE_CPUQUE
+  // Point the outputs of GetNext at the front slot of the dataset queue, graph outputs keep their own memory.
+  void BindDatasetIteratorOutputs(const CNodePtr &kernel, kernel::DatasetIteratorCPUKernel *iterator);
+  friend class DatasetIteratorReleaser;
+  void ReleaseDatasetIterators();
+  std::vector<std::pair<DeviceAddress *, void *>> dataset_bound_ptrs_;
+  std::vector<kernel::DatasetIteratorCPUKernel *> dataset_iterators_;
+#endif
   CPUResourceManager resource_manager_;
   std::set<DeviceAddressPtr> bound_addresses_;
   std::map<AnfNodePtr, tensor::TensorPtr> input_param_tensor_map_;
@@ -293,6 +293,14 @@ void SetKernelInfo(const CNodePtr &kernel_node) {
   std::vector<std::string> infer_output_formats;
   std::vector<TypeId> infer_output_types;
   MS_LOG(INFO) << "SetKernelInfo, CNode Name: " << AnfAlgo::GetCNodeName(kernel_node);
+#ifdef ENABLE_CPUQUE
+  // GetNext outputs whatever the dataset produces, its build info follows the inferred output types.
+  if (AnfAlgo::GetCNodeName(kernel_node) == kGetNextOpName) {
+    GetOutputInferFormatsAndDtypes(kernel_node, &output_formats, &output_types);
+    SetKernelBuildInfo(input_formats, input_types, output_formats, output_types, kernel_node.get());
+    return;
+  }
+#endif
   auto kernel_attrs =
     kernel::CPUKernelFactory::GetInstance().GetSupportedKernelAttrList(AnfAlgo::GetCNodeName(kernel_node));
   if (kernel_attrs.empty()) {
@@ -649,7 +649,9 @@ class ParallelMode:
     AUTO_PARALLEL = "auto_parallel"
     MODE_LIST = [STAND_ALONE, DATA_PARALLEL, HYBRID_PARALLEL, SEMI_AUTO_PARALLEL, AUTO_PARALLEL]
 
-@args_type_check(enable_ps=bool)
+@args_type_check(enable_ps=bool, consistency_mode=str, staleness_threshold=int, compression=str,
+                 topk_ratio=float, embedding_storage=str, embedding_admit_threshold=int, embedding_ttl=int,
+                 embedding_max_rows=int)
 def set_ps_context(**kwargs):
     """
     Set parameter server training mode context.
@@ -674,12 +676,35 @@ def set_ps_context(**kwargs):
         enable_ps (bool): Whether to enable parameter server training mode.
                           Only after enable_ps is set True, the environment variables will be effective.
                           Default: False.
+        consistency_mode (str): How the parameter server applies the gradients of the workers, one of "sync",
+                          "ssp" and "async". "sync" applies the gradients of all workers together once every step,
+                          "ssp" and "async" apply the gradients of a worker as they arrive. Default: "sync".
+        staleness_threshold (int): Steps a worker may run ahead of the slowest worker in "ssp" mode before its
+                          pulls wait. Default: 0.
+        compression (str): Compression of the gradients pushed and the weights pulled, one of "none", "fp16",
+                          "bf16" and "topk". "fp16" and "bf16" cast both to 16 bits, "topk" pushes the largest
+                          gradients only and adds the rest to the next push. Default: "none".
+        topk_ratio (float): Ratio of the gradients pushed by "topk" compression, in (0, 1]. Default: 0.01.
+        embedding_storage (str): Storage of the embedding tables of the ps cache on the servers, "dense" or
+                          "dynamic". "dense" holds a row for every id of the vocabulary, "dynamic" creates the rows
+                          of the ids as they are admitted and evicts them by embedding_ttl and embedding_max_rows.
+                          Default: "dense".
+        embedding_admit_threshold (int): Occurrences of an id in the batches of a worker before the servers keep
+                          its row, the rows of the ids which are not admitted are not pushed and read their
+                          initial values again. Default: 1.
+        embedding_ttl (int): Rows of a dynamic embedding table not used in this many lookups of the table are
+                          evicted, 0 keeps them. Default: 0.
+        embedding_max_rows (int): Max rows of a dynamic embedding table on a server, the least frequently used
+                          rows are evicted beyond it, 0 does not limit the rows. Default: 0.
 
     Raises:
         ValueError: If input key is not the attribute in parameter server training mode context.
 
     Examples:
         >>> context.set_ps_context(enable_ps=True)
+        >>> context.set_ps_context(consistency_mode="ssp", staleness_threshold=2)
+        >>> context.set_ps_context(compression="topk", topk_ratio=0.01)
+        >>> context.set_ps_context(embedding_storage="dynamic", embedding_admit_threshold=2)
     """
     _set_ps_context(**kwargs)
 
@@ -704,5 +729,13 @@ def reset_ps_context():
     Reset parameter server training mode context attributes to the default values:
 
     - enable_ps: False.
+    - consistency_mode: "sync".
+    - staleness_threshold: 0.
+    - compression: "none".
+    - topk_ratio: 0.01.
+    - embedding_storage: "dense".
+    - embedding_admit_threshold: 1.
+    - embedding_ttl: 0.
+    - embedding_max_rows: 0.
     """
     _reset_ps_context()
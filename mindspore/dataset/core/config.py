@@ -22,7 +22,8 @@ import mindspore._c_dataengine as cde
 
 __all__ = ['set_seed', 'get_seed', 'set_prefetch_size', 'get_prefetch_size', 'set_num_parallel_workers',
            'get_num_parallel_workers', 'set_monitor_sampling_interval', 'get_monitor_sampling_interval', 'load',
-           'get_callback_timeout', 'set_auto_num_workers', 'get_auto_num_workers']
+           'get_callback_timeout', 'set_auto_num_workers', 'get_auto_num_workers', 'set_numa_policy',
+           'get_numa_policy']
 
 INT32_MAX = 2147483647
 UINT32_MAX = 4294967295
@@ -224,6 +225,62 @@ def get_auto_num_workers():
     return _config.get_auto_num_workers()
 
 
+_NUMA_POLICIES = {"none": cde.NumaPolicy.DE_NUMA_POLICY_NONE,
+                  "compact": cde.NumaPolicy.DE_NUMA_POLICY_COMPACT,
+                  "spread": cde.NumaPolicy.DE_NUMA_POLICY_SPREAD}
+
+
+def set_numa_policy(policy, node_set=None):
+    """
+    Set the placement of the pipeline threads on the NUMA nodes of the host. (This feature is turned off by default)
+    The main thread of each op is pinned to the CPUs of its NUMA nodes when the pipeline is launched, and the workers
+    of the op inherit these CPUs. Tensors produced by the workers are allocated on the local node as a result.
+    The placement of each op is shown when the execution tree is printed. It has no effect on single node hosts.
+
+    Args:
+        policy (str): The placement policy, one of
+
+            - "none": leave the threads to the scheduler of the OS.
+            - "compact": run all the ops on the CPUs of `node_set`, by default the node of the thread launching
+              the pipeline.
+            - "spread": pin each op to one node of `node_set`, by default all the nodes, balancing the number of
+              workers on each node.
+
+        node_set (list[int], optional): The ids of the NUMA nodes the pipeline may run on (default=None).
+
+    Raises:
+        ValueError: If policy is not one of "none", "compact" or "spread".
+        ValueError: If node_set is not a list of non-negative int.
+
+    Examples:
+        >>> import mindspore.dataset as ds
+        >>>
+        >>> # Run the pipeline on the CPUs of NUMA node 0 and 1.
+        >>> ds.config.set_numa_policy("compact", [0, 1])
+    """
+    if not isinstance(policy, str) or policy not in _NUMA_POLICIES:
+        raise ValueError("policy should be one of " + str(list(_NUMA_POLICIES)) + ".")
+    if node_set is None:
+        node_set = []
+    if not isinstance(node_set, list) or \
+            not all(isinstance(n, int) and not isinstance(n, bool) and 0 <= n <= INT32_MAX for n in node_set):
+        raise ValueError("node_set should be a list of non-negative int.")
+    _config.set_numa_policy(_NUMA_POLICIES[policy])
+    _config.set_numa_node_set(node_set)
+
+
+def get_numa_policy():
+    """
+    Get the placement of the pipeline threads on the NUMA nodes of the host.
+
+    Returns:
+        Tuple of (str, list[int]), the policy and the configured node set.
+    """
+    policy = _config.get_numa_policy()
+    name = [k for k, v in _NUMA_POLICIES.items() if v == policy][0]
+    return name, _config.get_numa_node_set()
+
+
 def set_callback_timeout(timeout):
     """
     Set the default timeout (in seconds) for DSWaitedCallback.
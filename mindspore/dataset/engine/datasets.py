@@ -194,7 +194,8 @@ class Dataset:
     @check_bucket_batch_by_length
     def bucket_batch_by_length(self, column_names, bucket_boundaries, bucket_batch_sizes,
                                element_length_function=None, pad_info=None,
-                               pad_to_bucket_boundary=False, drop_remainder=False):
+                               pad_to_bucket_boundary=False, drop_remainder=False,
+                               max_tokens_per_batch=0, lookahead_rows=1024):
         """
         Bucket elements according to their lengths. Each bucket will be padded and batched when
         they are full.
@@ -233,6 +234,14 @@ class Dataset:
                 (default=False).
             drop_remainder (bool, optional): If True, will drop the last batch for each
                 bucket if it is not a full batch (default=False).
+            max_tokens_per_batch (int, optional): If positive, rows are not bucketed but packed
+                into batches whose padded size (number of rows times the longest length in the
+                batch) does not exceed this budget, and each batch is padded to its longest row.
+                bucket_boundaries and bucket_batch_sizes must then be empty lists. The length
+                can be a token count or a byte count, as returned by element_length_function
+                (default=0, bucketing is used).
+            lookahead_rows (int, optional): Number of rows sorted by length together before they
+                are packed, only used when max_tokens_per_batch is set (default=1024).
 
         Examples:
             >>> import mindspore.dataset as ds
@@ -260,7 +269,8 @@ class Dataset:
         """
         return BucketBatchByLengthDataset(self, column_names, bucket_boundaries, bucket_batch_sizes,
                                           element_length_function, pad_info,
-                                          pad_to_bucket_boundary, drop_remainder)
+                                          pad_to_bucket_boundary, drop_remainder,
+                                          max_tokens_per_batch, lookahead_rows)
 
     @check_batch
     def batch(self, batch_size, drop_remainder=False, num_parallel_workers=None, per_batch_map=None,
@@ -1760,7 +1770,8 @@ class BucketBatchByLengthDataset(Dataset):
     """
 
     def __init__(self, input_dataset, column_names, bucket_boundaries, bucket_batch_sizes,
-                 element_length_function, pad_info, pad_to_bucket_boundary, drop_remainder):
+                 element_length_function, pad_info, pad_to_bucket_boundary, drop_remainder,
+                 max_tokens_per_batch=0, lookahead_rows=1024):
         super().__init__(children=input_dataset)
 
         self.column_names = replace_none(column_names, [])
@@ -1770,11 +1781,14 @@ class BucketBatchByLengthDataset(Dataset):
         self.pad_info = replace_none(pad_info, {})
         self.pad_to_bucket_boundary = replace_none(pad_to_bucket_boundary, False)
         self.drop_remainder = replace_none(drop_remainder, False)
+        self.max_tokens_per_batch = replace_none(max_tokens_per_batch, 0)
+        self.lookahead_rows = replace_none(lookahead_rows, 1024)
 
     def parse(self, children=None):
         return cde.BucketBatchByLengthNode(children[0], self.column_names, self.bucket_boundaries,
                                            self.bucket_batch_sizes, self.element_length_function, self.pad_info,
-                                           self.pad_to_bucket_boundary, self.drop_remainder)
+                                           self.pad_to_bucket_boundary, self.drop_remainder,
+                                           self.max_tokens_per_batch, self.lookahead_rows)
 
     def get_args(self):
         args = super().get_args()
@@ -1785,6 +1799,8 @@ class BucketBatchByLengthDataset(Dataset):
         args["pad_info"] = self.pad_info
         args["pad_to_bucket_boundary"] = self.pad_to_bucket_boundary
         args["drop_remainder"] = self.drop_remainder
+        args["max_tokens_per_batch"] = self.max_tokens_per_batch
+        args["lookahead_rows"] = self.lookahead_rows
         return args
 
 
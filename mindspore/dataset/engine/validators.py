@@ -24,7 +24,7 @@ from functools import wraps
 import numpy as np
 from mindspore._c_expression import typing
 from ..core.validator_helpers import parse_user_args, type_check, type_check_list, check_value, \
-    INT32_MAX, check_valid_detype, check_dir, check_file, check_sampler_shuffle_shard_options, \
+    INT32_MAX, INT64_MAX, check_valid_detype, check_dir, check_file, check_sampler_shuffle_shard_options, \
     validate_dataset_param_value, check_padding_options, check_gnn_list_or_ndarray, check_num_parallel_workers, \
     check_columns, check_pos_int32, check_valid_str
 
@@ -478,7 +478,8 @@ def check_bucket_batch_by_length(method):
     @wraps(method)
     def new_method(self, *args, **kwargs):
         [column_names, bucket_boundaries, bucket_batch_sizes, element_length_function, pad_info,
-         pad_to_bucket_boundary, drop_remainder], _ = parse_user_args(method, *args, **kwargs)
+         pad_to_bucket_boundary, drop_remainder, max_tokens_per_batch, lookahead_rows], _ = \
+            parse_user_args(method, *args, **kwargs)
 
         nreq_param_list = ['column_names', 'bucket_boundaries', 'bucket_batch_sizes']
 
@@ -493,6 +494,22 @@ def check_bucket_batch_by_length(method):
         if element_length_function is None and len(column_names) != 1:
             raise ValueError("If element_length_function is not specified, exactly one column name should be passed.")
 
+        type_check_list([max_tokens_per_batch, lookahead_rows], (int,), ['max_tokens_per_batch', 'lookahead_rows'])
+        check_value(max_tokens_per_batch, [0, INT64_MAX], "max_tokens_per_batch")
+        if max_tokens_per_batch > 0:
+            # token-budget mode, rows are not bucketed
+            if bucket_boundaries or bucket_batch_sizes:
+                raise ValueError("bucket_boundaries and bucket_batch_sizes must be empty when max_tokens_per_batch "
+                                 "is set.")
+            if pad_to_bucket_boundary:
+                raise ValueError("pad_to_bucket_boundary can not be used with max_tokens_per_batch.")
+            check_pos_int32(lookahead_rows, "lookahead_rows")
+            if pad_info is not None:
+                type_check(pad_info, (dict,), "pad_info")
+                for k, v in pad_info.items():
+                    check_pad_info(k, v)
+            return method(self, *args, **kwargs)
+
         # check bucket_boundaries: must be list of int, positive and strictly increasing
         if not bucket_boundaries:
             raise ValueError("bucket_boundaries cannot be empty.")
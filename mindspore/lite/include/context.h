@@ -69,7 +69,11 @@ struct DeviceContext {
 /// \brief Context defined for holding environment variables during runtime.
 struct Context {
   std::string vendor_name_;
-  int thread_num_ = 2; /**< thread number config for thread pool */
+  int thread_num_ = 2;            /**< thread number config for thread pool */
+  bool enable_parallel_ = false;  /**< run independent branches of the graph concurrently on the thread pool */
+  bool enable_tuning_ = false;    /**< time the candidate kernels of convolutions while compiling, run the fastest */
+  std::string tuning_cache_file_; /**< file keeping tuning results across sessions and processes, may be empty */
+  bool enable_static_memory_plan_ = true; /**< plan the intermediate tensors of a cpu fp32 graph into one arena */
   AllocatorPtr allocator = nullptr;
   DeviceContextVector device_list_ = {{DT_CPU, {false, MID_CPU}}};
 };
@@ -52,6 +52,16 @@ struct MS_API Model {
   /// \return Pointer of MindSpore Lite Model.
   static Model *Import(const char *model_buf, size_t size);
 
+  /// \brief Static method to create a Model pointer from a model file.
+  ///
+  /// \note The file is mapped into memory copy-on-write instead of read into a buffer, so the pages of constant
+  /// weights are shared by all the processes and models importing the same file.
+  ///
+  /// \param[in] model_file Define the path of the model file.
+  ///
+  /// \return Pointer of MindSpore Lite Model.
+  static Model *Import(const char *model_file);
+
   /// \brief Free meta graph temporary buffer
   virtual void Free();
 
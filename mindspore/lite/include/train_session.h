@@ -20,6 +20,7 @@
 #include <tuple>
 #include <unordered_map>
 #include "include/lite_session.h"
+#include "include/errorcode.h"
 
 namespace mindspore {
 namespace session {
@@ -83,6 +84,19 @@ class TrainSession : public session::LiteSession {
   /// \return boolean indication if model is in eval mode
   bool IsEval() { return train_mode_ == false; }
 
+  /// \brief Set the memory saving mode of RunGraph, off by default
+  ///
+  /// \param[in] enable Free activations and gradients after their last use, reuse gradient buffers in place and
+  /// recompute forward activations in the backward pass instead of keeping them alive
+  /// \param[in] checkpoint_interval Number of forward kernels of a recomputed segment, 0 for the square root of the
+  /// number of forward kernels, negative to keep every forward activation
+  ///
+  /// \return STATUS as an error code of compiling graph, STATUS is defined in errorcode.h, RET_NOT_SUPPORT for enabling
+  /// it on a session without memory saving
+  virtual int SetMemorySaving(bool enable, int checkpoint_interval = 0) {
+    return enable ? mindspore::lite::RET_NOT_SUPPORT : mindspore::lite::RET_OK;
+  }
+
  protected:
   bool train_mode_ = false;
 };
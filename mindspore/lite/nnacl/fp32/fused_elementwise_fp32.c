@@ -0,0 +1,105 @@
+/**
+ * Copyright 2021 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "nnacl/fp32/fused_elementwise_fp32.h"
+#include <string.h>
+#include "nnacl/errorcode.h"
+#include "nnacl/fp32/activation_fp32.h"
+#include "nnacl/fp32/arithmetic_fp32.h"
+#include "nnacl/fp32/arithmetic_self_fp32.h"
+
+bool FusedElementwiseIsBinary(int op) { return op >= FusedElementwise_Add && op <= FusedElementwise_Minimum; }
+
+// same nnacl functions as the unfused kernels, so the results do not change
+static int FusedElementwiseStep(const float *src, const float *operand, float *dst, float *buffer, int length, int op,
+                                float alpha) {
+  switch (op) {
+    case FusedElementwise_Add:
+      return ElementAdd(src, operand, dst, length);
+    case FusedElementwise_Sub:
+      return ElementSub(src, operand, dst, length);
+    case FusedElementwise_ReverseSub:
+      return ElementSub(operand, src, dst, length);
+    case FusedElementwise_Mul:
+      return ElementMul(src, operand, dst, length);
+    case FusedElementwise_Div:
+      return ElementDiv(src, operand, dst, length);
+    case FusedElementwise_ReverseDiv:
+      return ElementDiv(operand, src, dst, length);
+    case FusedElementwise_Maximum:
+      return ElementMaximum(src, operand, dst, length);
+    case FusedElementwise_Minimum:
+      return ElementMinimum(src, operand, dst, length);
+    case FusedElementwise_Relu:
+      return Fp32Relu(src, length, dst);
+    case FusedElementwise_Relu6:
+      return Fp32Relu6(src, length, dst);
+    case FusedElementwise_LeakyRelu:
+      return LRelu(src, length, dst, alpha);
+    case FusedElementwise_Sigmoid:
+      return Sigmoid(src, length, dst);
+    case FusedElementwise_Tanh:
+      return Tanh(src, length, dst);
+    case FusedElementwise_Swish:
+      // Swish reads src after writing dst
+      if (src == dst) {
+        int ret = Swish(src, length, buffer);
+        memcpy(dst, buffer, length * sizeof(float));
+        return ret;
+      }
+      return Swish(src, length, dst);
+    case FusedElementwise_HSwish:
+      return HSwish(src, length, dst);
+    case FusedElementwise_HSigmoid:
+      return HSigmoid(src, length, dst);
+    case FusedElementwise_Neg:
+      return ElementNegative(src, dst, length);
+    case FusedElementwise_Abs:
+      return ElementAbs(src, dst, length);
+    case FusedElementwise_Square:
+      return ElementSquare(src, dst, length);
+    case FusedElementwise_Sqrt:
+      return ElementSqrt(src, dst, length);
+    case FusedElementwise_Rsqrt:
+      return ElementRsqrt(src, dst, length);
+    default:
+      return NNACL_ERR;
+  }
+}
+
+int FusedElementwise(const float *src, float *dst, const float *const *operands, const bool *repeated, float *buffer,
+                     int offset, int count, int tile, const FusedElementwiseParameter *param) {
+  if (param->step_num_ <= 0 || param->step_num_ > MAX_FUSED_ELEMENTWISE_STEP || tile <= 0) {
+    return NNACL_PARAM_INVALID;
+  }
+  for (int start = offset; start < offset + count; start += tile) {
+    int length = MSMIN(tile, offset + count - start);
+    const float *tile_src = src + start;
+    float *tile_dst = dst + start;
+    for (int i = 0; i < param->step_num_; ++i) {
+      const float *operand = NULL;
+      if (FusedElementwiseIsBinary(param->ops_[i])) {
+        operand = repeated[i] ? operands[i] : operands[i] + start;
+      }
+      int ret = FusedElementwiseStep(tile_src, operand, tile_dst, buffer, length, param->ops_[i], param->alpha_[i]);
+      if (ret != NNACL_OK) {
+        return ret;
+      }
+      // the tile stays in dst for the rest of the program
+      tile_src = tile_dst;
+    }
+  }
+  return NNACL_OK;
+}
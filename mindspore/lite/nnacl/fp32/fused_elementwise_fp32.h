@@ -0,0 +1,77 @@
+/**
+ * Copyright 2021 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef MINDSPORE_LITE_NNACL_FP32_FUSED_ELEMENTWISE_H_
+#define MINDSPORE_LITE_NNACL_FP32_FUSED_ELEMENTWISE_H_
+
+#include <stdbool.h>
+#include "nnacl/op_base.h"
+
+#define MAX_FUSED_ELEMENTWISE_STEP 16
+// elements run through the whole program at once, the tile, its operands and the scratch buffer stay in L1
+#define FUSED_ELEMENTWISE_TILE 1024
+
+// Steps of the program of a FusedElementwise node, the converter stores them by value so only append new ones.
+// A binary step combines the running value with an operand, the Reverse ones with the running value on the right.
+typedef enum FusedElementwiseOp {
+  FusedElementwise_Add = 0,
+  FusedElementwise_Sub = 1,
+  FusedElementwise_ReverseSub = 2,
+  FusedElementwise_Mul = 3,
+  FusedElementwise_Div = 4,
+  FusedElementwise_ReverseDiv = 5,
+  FusedElementwise_Maximum = 6,
+  FusedElementwise_Minimum = 7,
+  FusedElementwise_Relu = 8,
+  FusedElementwise_Relu6 = 9,
+  FusedElementwise_LeakyRelu = 10,
+  FusedElementwise_Sigmoid = 11,
+  FusedElementwise_Tanh = 12,
+  FusedElementwise_Swish = 13,
+  FusedElementwise_HSwish = 14,
+  FusedElementwise_HSigmoid = 15,
+  FusedElementwise_Neg = 16,
+  FusedElementwise_Abs = 17,
+  FusedElementwise_Square = 18,
+  FusedElementwise_Sqrt = 19,
+  FusedElementwise_Rsqrt = 20,
+  FusedElementwise_OpNum
+} FusedElementwiseOp;
+
+typedef struct FusedElementwiseParameter {
+  OpParameter op_parameter_;
+  int step_num_;
+  int ops_[MAX_FUSED_ELEMENTWISE_STEP];
+  // input tensor holding the operand of a binary step, 0 for the unary ones
+  int operand_index_[MAX_FUSED_ELEMENTWISE_STEP];
+  // slope of LeakyRelu
+  float alpha_[MAX_FUSED_ELEMENTWISE_STEP];
+} FusedElementwiseParameter;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+bool FusedElementwiseIsBinary(int op);
+
+// Run the program of param on the elements [offset, offset + count) of src into dst, tile elements at a time.
+// operands[i] of binary step i holds every element, or when repeated[i] only the tile elements of the first tile,
+// repeated by every tile, offset must then be a multiple of tile. buffer holds tile floats of scratch.
+int FusedElementwise(const float *src, float *dst, const float *const *operands, const bool *repeated, float *buffer,
+                     int offset, int count, int tile, const FusedElementwiseParameter *param);
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // MINDSPORE_LITE_NNACL_FP32_FUSED_ELEMENTWISE_H_
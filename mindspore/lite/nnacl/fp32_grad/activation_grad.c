@@ -22,29 +22,23 @@
 
 inline int ReluGrad(float *src0, float *src1, int length, float *dst) {
   for (int i = 0; i < length; ++i) {
-    dst[i] = src1[i] > 0 ? 1.0f : 0.0f;
+    dst[i] = src0[i] * (src1[i] > 0 ? 1.0f : 0.0f);
   }
-  ElementMul(src0, dst, dst, length);
   return NNACL_OK;
 }
 
 int Relu6Grad(float *src0, float *src1, int length, float *dst) {
   for (int i = 0; i < length; ++i) {
-    if (src1[i] < 0) {
-      dst[i] = 0;
-    } else {
-      dst[i] = src1[i] > 6.0f ? 0.0f : 1.0f;
-    }
+    float mask = (src1[i] < 0 || src1[i] > 6.0f) ? 0.0f : 1.0f;
+    dst[i] = src0[i] * mask;
   }
-  ElementMul(src0, dst, dst, length);
   return NNACL_OK;
 }
 
 int LReluGrad(float *src0, float *src1, int length, float *dst, float alpha) {
   for (int i = 0; i < length; ++i) {
-    dst[i] = src1[i] > 0.0f ? 1.0f : alpha;
+    dst[i] = src0[i] * (src1[i] > 0.0f ? 1.0f : alpha);
   }
-  ElementMul(src0, dst, dst, length);
   return NNACL_OK;
 }
 
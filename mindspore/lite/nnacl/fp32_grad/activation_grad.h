@@ -30,6 +30,7 @@ typedef struct ActivationGradParameter {
 extern "C" {
 #endif
 
+// dst may be src0 or src1, the gradients are computed element by element
 int ReluGrad(float *src0, float *src1, int length, float *dst);
 int Relu6Grad(float *src0, float *src1, int length, float *dst);
 int LReluGrad(float *src0, float *src1, int length, float *dst, float alpha);
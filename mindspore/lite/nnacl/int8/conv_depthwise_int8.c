@@ -18,11 +18,18 @@
 #include <string.h>
 #include "nnacl/quantization/fixed_point.h"
 #include "nnacl/int8/common_func_int8.h"
+#include "nnacl/int8/x86_simd_int8.h"
 
 /*conv depthwise int8 begin*/
 #ifndef ENABLE_ARM
 void ConvDwInt8Row(int32_t *output_ptr, const int8_t *input_ptr, const int16_t *weight_ptr, int num_pixels,
                    int output_channel, int input_step, int8_t input_zp) {
+#ifdef ENABLE_X86_INT8_SIMD
+  if (GetInt8SimdLevel() != Int8SimdScalar) {
+    ConvDwInt8RowX86(output_ptr, input_ptr, weight_ptr, num_pixels, output_channel, input_step, input_zp);
+    return;
+  }
+#endif
   for (int i = 0; i < num_pixels; i++) {
     for (int c = 0; c < output_channel; c++) {
       const int16_t input = input_ptr[c] - input_zp;
@@ -35,6 +42,20 @@ void ConvDwInt8Row(int32_t *output_ptr, const int8_t *input_ptr, const int16_t *
 
 void ConvDwInt8Post(int8_t *dst, int32_t *buffer, int output_w, int channel, int32_t output_zp, int32_t *out_multiplier,
                     int32_t *left_shift, int32_t *right_shift, int32_t acc_min, int32_t acc_max, bool per_channel) {
+#ifdef ENABLE_X86_INT8_SIMD
+  if (GetInt8SimdLevel() != Int8SimdScalar) {
+    if (per_channel) {
+      for (int w = 0; w < output_w; w++) {
+        RequantInt32ToInt8X86(dst + w * channel, buffer + w * channel, channel, output_zp, out_multiplier, left_shift,
+                              right_shift, acc_min, acc_max, true);
+      }
+    } else {
+      RequantInt32ToInt8X86(dst, buffer, output_w * channel, output_zp, out_multiplier, left_shift, right_shift,
+                            acc_min, acc_max, false);
+    }
+    return;
+  }
+#endif
   if (per_channel) {
     // support perchannel
     for (int w = 0; w < output_w; w++) {
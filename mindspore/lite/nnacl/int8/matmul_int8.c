@@ -16,6 +16,7 @@
 
 #include "nnacl/int8/matmul_int8.h"
 #include "nnacl/quantization/fixed_point.h"
+#include "nnacl/int8/x86_simd_int8.h"
 
 void RowMajor2Row2x16MajorInt8(int8_t *src_ptr, int8_t *dst_ptr, int row, int col) {
   int col16 = UP_ROUND(col, C16NUM);
@@ -186,6 +187,13 @@ void MatMulInt8_16x4_r(const int8_t *a, const int8_t *b, int8_t *dst, size_t row
                        size_t stride, const int32_t *input_sum, const int32_t *bias, int32_t *left_shift,
                        int32_t *right_shift, int32_t *multiplier, int32_t output_zp, int32_t mini, int32_t maxi,
                        bool peroc) {
+#ifdef ENABLE_X86_INT8_SIMD
+  if (GetInt8SimdLevel() != Int8SimdScalar) {
+    MatMulInt8_16x4_rX86(a, b, dst, row, col, deep_16, stride, input_sum, bias, left_shift, right_shift, multiplier,
+                         output_zp, mini, maxi, peroc);
+    return;
+  }
+#endif
   /* support per-layer && weight per-channel */
   /*  row4x16-major * row16x4-major => (int8)row-major*/
   for (int r = 0; r < row; r++) {
@@ -254,6 +262,13 @@ void MatMulInt8_4x2_r(const int8_t *a, const int8_t *b, int8_t *dst, size_t row,
 void MatmulInt8Opt(const int8_t *a, const int8_t *b, int8_t *dst, int row, int col, int deep16, const int *a_sums,
                    const int *bias, int mini, int maxi, int out_zp, int32_t *multiplier, int32_t *left_shift,
                    int32_t *right_shift, size_t stride, size_t filter_peroc, int32_t *filter_zp) {
+#ifdef ENABLE_X86_INT8_SIMD
+  if (GetInt8SimdLevel() != Int8SimdScalar) {
+    MatmulInt8OptX86(a, b, dst, row, col, deep16, a_sums, bias, mini, maxi, out_zp, multiplier, left_shift,
+                     right_shift, stride, filter_peroc, filter_zp);
+    return;
+  }
+#endif
   /*
    * row4x16-major * row16x4-major => (int8)row-major
    * support per-layer && weight per-channel
@@ -292,6 +307,13 @@ void MatMulInt8_8x8_r(const int8_t *a, const int8_t *b, int8_t *dst, size_t row,
                       size_t stride, const int32_t *input_sum, const int32_t *bias, int32_t *left_shift,
                       int32_t *right_shift, int32_t *multiplier, int32_t output_zp, int32_t mini, int32_t maxi,
                       size_t per_channel) {
+#ifdef ENABLE_X86_INT8_SIMD
+  if (GetInt8SimdLevel() != Int8SimdScalar) {
+    MatMulInt8_8x8_rX86(a, b, dst, row, col, deep_4, stride, input_sum, bias, left_shift, right_shift, multiplier,
+                        output_zp, mini, maxi, per_channel);
+    return;
+  }
+#endif
   /*  row8x4-major * row4x8-major => (int8)row-major  */
   for (int r = 0; r < row; r++) {
     for (int c = 0; c < col; c++) {
@@ -0,0 +1,422 @@
+/**
+ * Copyright 2021 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "nnacl/int8/x86_simd_int8.h"
+#include <string.h>
+#include "nnacl/quantization/fixed_point.h"
+#ifdef ENABLE_X86_INT8_SIMD
+#include <immintrin.h>
+#endif
+
+static int g_supported_int8_simd_level = -1;
+// -1 until set, the kernels then dispatch to the supported level
+static int g_int8_simd_level = -1;
+
+static Int8SimdLevel DetectInt8SimdLevel(void) {
+#ifdef ENABLE_X86_INT8_SIMD
+  __builtin_cpu_init();
+#ifdef ENABLE_X86_INT8_VNNI
+  if (__builtin_cpu_supports("avx512vnni") && __builtin_cpu_supports("avx512vl") &&
+      __builtin_cpu_supports("avx512bw") && __builtin_cpu_supports("avx2")) {
+    return Int8SimdAvx512Vnni;
+  }
+#endif
+  if (__builtin_cpu_supports("avx2")) {
+    return Int8SimdAvx2;
+  }
+#endif
+  return Int8SimdScalar;
+}
+
+Int8SimdLevel GetSupportedInt8SimdLevel(void) {
+  int level = __atomic_load_n(&g_supported_int8_simd_level, __ATOMIC_RELAXED);
+  if (level < 0) {
+    level = (int)DetectInt8SimdLevel();
+    __atomic_store_n(&g_supported_int8_simd_level, level, __ATOMIC_RELAXED);
+  }
+  return (Int8SimdLevel)level;
+}
+
+Int8SimdLevel GetInt8SimdLevel(void) {
+  int level = __atomic_load_n(&g_int8_simd_level, __ATOMIC_RELAXED);
+  return level < 0 ? GetSupportedInt8SimdLevel() : (Int8SimdLevel)level;
+}
+
+bool SetInt8SimdLevel(Int8SimdLevel level) {
+  if ((int)level < (int)Int8SimdScalar || (int)level > (int)GetSupportedInt8SimdLevel()) {
+    return false;
+  }
+  __atomic_store_n(&g_int8_simd_level, (int)level, __ATOMIC_RELAXED);
+  return true;
+}
+
+#ifdef ENABLE_X86_INT8_SIMD
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#ifdef ENABLE_X86_INT8_VNNI
+#define TARGET_AVX512_VNNI __attribute__((target("avx2,avx512f,avx512bw,avx512vl,avx512vnni")))
+#endif
+
+typedef void (*DotTileFunc)(const int8_t *a, const int8_t *b, int deep, int32_t *dst);
+
+typedef enum InputSumMode {
+  InputSumPerRow = 0,            /* input_sum[r] */
+  InputSumPerRowTimesZp = 1,     /* input_sum[r] * filter_zp[c] */
+  InputSumPerRowAndColumn = 2,   /* input_sum of the row and the column, in blocks of the column tile */
+} InputSumMode;
+
+typedef struct ColumnQuantArgs {
+  int32_t bias[C8NUM];
+  int32_t multiplier[C8NUM];
+  int32_t left_shift[C8NUM];
+  int32_t right_shift[C8NUM];
+  int32_t filter_zp[C8NUM];
+} ColumnQuantArgs;
+
+// Parameters of the num columns from start, repeated every tile lanes up to C8NUM lanes, zero past num.
+static void LoadColumnParams(int32_t *block, const int32_t *params, int start, int num, int tile, bool per_channel) {
+  for (int i = 0; i < C8NUM; i++) {
+    int c = i % tile;
+    block[i] = c < num ? (per_channel ? params[start + c] : params[0]) : 0;
+  }
+}
+
+static void LoadColumnQuantArgs(ColumnQuantArgs *args, const int32_t *bias, const int32_t *multiplier,
+                                const int32_t *left_shift, const int32_t *right_shift, const int32_t *filter_zp,
+                                int start, int num, int tile, bool per_channel) {
+  LoadColumnParams(args->bias, bias, start, num, tile, true);
+  LoadColumnParams(args->multiplier, multiplier, start, num, tile, per_channel);
+  LoadColumnParams(args->left_shift, left_shift, start, num, tile, per_channel);
+  LoadColumnParams(args->right_shift, right_shift, start, num, tile, per_channel);
+  if (filter_zp != NULL) {
+    LoadColumnParams(args->filter_zp, filter_zp, start, num, tile, true);
+  }
+}
+
+// (a * b + 2^30) >> 31 rounds as SaturatingRoundingDoublingHighMul does for both signs of a * b
+static inline TARGET_AVX2 __m256i SaturatingRoundingDoublingHighMulAvx2(__m256i a, __m256i b) {
+  const __m256i rounding = _mm256_set1_epi64x(1ll << 30);
+  __m256i even = _mm256_add_epi64(_mm256_mul_epi32(a, b), rounding);
+  __m256i odd = _mm256_add_epi64(_mm256_mul_epi32(_mm256_srli_epi64(a, 32), _mm256_srli_epi64(b, 32)), rounding);
+  // bits 31 to 62 of the products, in the low dwords of the even and the high dwords of the odd products
+  __m256i result = _mm256_blend_epi32(_mm256_srli_epi64(even, 31), _mm256_slli_epi64(odd, 1), 0xAA);
+  const __m256i int_min = _mm256_set1_epi32(INT32_MIN);
+  __m256i overflow = _mm256_and_si256(_mm256_cmpeq_epi32(a, int_min), _mm256_cmpeq_epi32(b, int_min));
+  return _mm256_blendv_epi8(result, _mm256_set1_epi32(INT32_MAX), overflow);
+}
+
+static inline TARGET_AVX2 __m256i RoundingDivideByPOTAvx2(__m256i x, __m256i exponent) {
+  const __m256i one = _mm256_set1_epi32(1);
+  __m256i mask = _mm256_sub_epi32(_mm256_sllv_epi32(one, exponent), one);
+  __m256i remainder = _mm256_and_si256(x, mask);
+  // half of mask, plus one for negative x
+  __m256i threshold = _mm256_sub_epi32(_mm256_srai_epi32(mask, 1), _mm256_cmpgt_epi32(_mm256_setzero_si256(), x));
+  __m256i result = _mm256_srav_epi32(x, exponent);
+  return _mm256_sub_epi32(result, _mm256_cmpgt_epi32(remainder, threshold));
+}
+
+static inline TARGET_AVX2 __m256i RequantAvx2(__m256i value, __m256i multiplier, __m256i left_shift,
+                                              __m256i right_shift, __m256i out_zp, __m256i mini, __m256i maxi) {
+  value = _mm256_sllv_epi32(value, left_shift);
+  value = SaturatingRoundingDoublingHighMulAvx2(value, multiplier);
+  value = RoundingDivideByPOTAvx2(value, _mm256_sub_epi32(_mm256_setzero_si256(), right_shift));
+  value = _mm256_add_epi32(value, out_zp);
+  return _mm256_max_epi32(mini, _mm256_min_epi32(maxi, value));
+}
+
+// the low bytes of the 8 lanes, as the (int8_t) cast of the C kernels
+static inline TARGET_AVX2 void LowBytesAvx2(__m256i value, int8_t *dst) {
+  const __m256i low_bytes = _mm256_setr_epi8(0, 4, 8, 12, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 0, 4, 8, 12,
+                                             -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+  value = _mm256_shuffle_epi8(value, low_bytes);
+  value = _mm256_permutevar8x32_epi32(value, _mm256_setr_epi32(0, 4, 1, 1, 1, 1, 1, 1));
+  _mm_storel_epi64((__m128i *)dst, _mm256_castsi256_si128(value));
+}
+
+// 4x4 tile of row4x16 major a by row16x4 major b, row major into dst
+static TARGET_AVX2 void DotTile4x16Avx2(const int8_t *a, const int8_t *b, int deep16, int32_t *dst) {
+  for (int r = 0; r < C4NUM; r += C2NUM) {
+    __m256i acc[C2NUM][C4NUM];
+    for (int i = 0; i < C2NUM; i++) {
+      for (int c = 0; c < C4NUM; c++) {
+        acc[i][c] = _mm256_setzero_si256();
+      }
+    }
+    for (int d = 0; d < deep16; d += C16NUM) {
+      const int8_t *a_d = a + d * C4NUM + r * C16NUM;
+      const int8_t *b_d = b + d * C4NUM;
+      __m256i a0 = _mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i *)a_d));
+      __m256i a1 = _mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i *)(a_d + C16NUM)));
+      for (int c = 0; c < C4NUM; c++) {
+        __m256i b_c = _mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i *)(b_d + c * C16NUM)));
+        acc[0][c] = _mm256_add_epi32(acc[0][c], _mm256_madd_epi16(a0, b_c));
+        acc[1][c] = _mm256_add_epi32(acc[1][c], _mm256_madd_epi16(a1, b_c));
+      }
+    }
+    for (int i = 0; i < C2NUM; i++) {
+      __m256i sum =
+        _mm256_hadd_epi32(_mm256_hadd_epi32(acc[i][0], acc[i][1]), _mm256_hadd_epi32(acc[i][2], acc[i][3]));
+      __m128i row_sum = _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+      _mm_storeu_si128((__m128i *)(dst + (r + i) * C4NUM), row_sum);
+    }
+  }
+}
+
+#ifdef ENABLE_X86_INT8_VNNI
+// vpdpbusd multiplies unsigned by signed bytes: a + 128 is multiplied, and 128 times the sums of b are subtracted
+static TARGET_AVX512_VNNI void DotTile4x16Vnni(const int8_t *a, const int8_t *b, int deep16, int32_t *dst) {
+  const __m512i offset = _mm512_set1_epi8((char)0x80);
+  __m512i acc[C4NUM];
+  for (int r = 0; r < C4NUM; r++) {
+    acc[r] = _mm512_setzero_si512();
+  }
+  __m512i correction = _mm512_setzero_si512();
+  for (int d = 0; d < deep16; d += C16NUM) {
+    __m512i b_d = _mm512_loadu_si512((const void *)(b + d * C4NUM));
+    correction = _mm512_dpbusd_epi32(correction, offset, b_d);
+    for (int r = 0; r < C4NUM; r++) {
+      __m128i a_r = _mm_loadu_si128((const __m128i *)(a + d * C4NUM + r * C16NUM));
+      acc[r] = _mm512_dpbusd_epi32(acc[r], _mm512_xor_si512(_mm512_broadcast_i32x4(a_r), offset), b_d);
+    }
+  }
+  // each 128 bits hold 4 partial sums of a column, reduced into rows r and r + 1 of the 4 columns
+  const __m256i order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+  for (int r = 0; r < C4NUM; r += C2NUM) {
+    __m512i row0 = _mm512_sub_epi32(acc[r], correction);
+    __m512i row1 = _mm512_sub_epi32(acc[r + 1], correction);
+    __m256i sum0 = _mm256_hadd_epi32(_mm512_castsi512_si256(row0), _mm512_extracti64x4_epi64(row0, 1));
+    __m256i sum1 = _mm256_hadd_epi32(_mm512_castsi512_si256(row1), _mm512_extracti64x4_epi64(row1, 1));
+    __m256i sum = _mm256_permutevar8x32_epi32(_mm256_hadd_epi32(sum0, sum1), order);
+    _mm256_storeu_si256((__m256i *)(dst + r * C4NUM), sum);
+  }
+}
+#endif
+
+// 8x8 tile of row8x4 major a by row4x8 major b, row major into dst
+static TARGET_AVX2 void DotTile8x4Avx2(const int8_t *a, const int8_t *b, int deep4, int32_t *dst) {
+  const __m256i order = _mm256_setr_epi32(0, 1, 4, 5, 2, 3, 6, 7);
+  for (int r = 0; r < C8NUM; r += C4NUM) {
+    __m256i acc[C4NUM][C2NUM];
+    for (int i = 0; i < C4NUM; i++) {
+      acc[i][0] = _mm256_setzero_si256();
+      acc[i][1] = _mm256_setzero_si256();
+    }
+    for (int d = 0; d < deep4; d += C4NUM) {
+      const int8_t *a_d = a + d * C8NUM + r * C4NUM;
+      const int8_t *b_d = b + d * C8NUM;
+      __m256i b_lo = _mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i *)b_d));
+      __m256i b_hi = _mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i *)(b_d + C16NUM)));
+      for (int i = 0; i < C4NUM; i++) {
+        int32_t a4;
+        memcpy(&a4, a_d + i * C4NUM, sizeof(int32_t));
+        __m256i a_i = _mm256_cvtepi8_epi16(_mm_set1_epi32(a4));
+        acc[i][0] = _mm256_add_epi32(acc[i][0], _mm256_madd_epi16(a_i, b_lo));
+        acc[i][1] = _mm256_add_epi32(acc[i][1], _mm256_madd_epi16(a_i, b_hi));
+      }
+    }
+    for (int i = 0; i < C4NUM; i++) {
+      __m256i sum = _mm256_permutevar8x32_epi32(_mm256_hadd_epi32(acc[i][0], acc[i][1]), order);
+      _mm256_storeu_si256((__m256i *)(dst + (r + i) * C8NUM), sum);
+    }
+  }
+}
+
+#ifdef ENABLE_X86_INT8_VNNI
+static TARGET_AVX512_VNNI void DotTile8x4Vnni(const int8_t *a, const int8_t *b, int deep4, int32_t *dst) {
+  const __m256i offset = _mm256_set1_epi8((char)0x80);
+  __m256i acc[C8NUM];
+  for (int r = 0; r < C8NUM; r++) {
+    acc[r] = _mm256_setzero_si256();
+  }
+  __m256i correction = _mm256_setzero_si256();
+  for (int d = 0; d < deep4; d += C4NUM) {
+    __m256i b_d = _mm256_loadu_si256((const __m256i *)(b + d * C8NUM));
+    correction = _mm256_dpbusd_epi32(correction, offset, b_d);
+    for (int r = 0; r < C8NUM; r++) {
+      int32_t a4;
+      memcpy(&a4, a + d * C8NUM + r * C4NUM, sizeof(int32_t));
+      acc[r] = _mm256_dpbusd_epi32(acc[r], _mm256_xor_si256(_mm256_set1_epi32(a4), offset), b_d);
+    }
+  }
+  for (int r = 0; r < C8NUM; r++) {
+    _mm256_storeu_si256((__m256i *)(dst + r * C8NUM), _mm256_sub_epi32(acc[r], correction));
+  }
+}
+#endif
+
+// row4x16 major a by row16x4 major b, requantized into row major dst, two rows of a column tile per vector
+static TARGET_AVX2 void MatMulInt8Tile4x16X86(const int8_t *a, const int8_t *b, int8_t *dst, int row, int col,
+                                              int deep16, size_t stride, const int32_t *input_sum, InputSumMode mode,
+                                              const int32_t *filter_zp, const int32_t *bias, const int32_t *multiplier,
+                                              const int32_t *left_shift, const int32_t *right_shift, bool per_channel,
+                                              int32_t out_zp, int32_t mini, int32_t maxi) {
+#ifdef ENABLE_X86_INT8_VNNI
+  DotTileFunc dot = GetInt8SimdLevel() == Int8SimdAvx512Vnni ? DotTile4x16Vnni : DotTile4x16Avx2;
+#else
+  DotTileFunc dot = DotTile4x16Avx2;
+#endif
+  int row4 = UP_ROUND(row, C4NUM);
+  const __m256i out_zp_vec = _mm256_set1_epi32(out_zp);
+  const __m256i mini_vec = _mm256_set1_epi32(mini);
+  const __m256i maxi_vec = _mm256_set1_epi32(maxi);
+  for (int c = 0; c < col; c += C4NUM) {
+    int col_num = MSMIN(C4NUM, col - c);
+    ColumnQuantArgs args;
+    LoadColumnQuantArgs(&args, bias, multiplier, left_shift, right_shift,
+                        mode == InputSumPerRowTimesZp ? filter_zp : NULL, c, col_num, C4NUM, per_channel);
+    __m256i bias_vec = _mm256_loadu_si256((const __m256i *)args.bias);
+    __m256i multiplier_vec = _mm256_loadu_si256((const __m256i *)args.multiplier);
+    __m256i left_shift_vec = _mm256_loadu_si256((const __m256i *)args.left_shift);
+    __m256i right_shift_vec = _mm256_loadu_si256((const __m256i *)args.right_shift);
+    __m256i filter_zp_vec = _mm256_loadu_si256((const __m256i *)args.filter_zp);
+    for (int r = 0; r < row; r += C4NUM) {
+      int32_t tile[C4NUM * C4NUM];
+      dot(a + r * deep16, b + c * deep16, deep16, tile);
+      for (int i = r; i < MSMIN(r + C4NUM, row); i += C2NUM) {
+        bool has_next = i + 1 < row;
+        __m256i sums;
+        if (mode == InputSumPerRowAndColumn) {
+          sums = _mm256_loadu_si256((const __m256i *)(input_sum + c * row4 + i * C4NUM));
+        } else {
+          __m128i sum0 = _mm_set1_epi32(input_sum[i]);
+          __m128i sum1 = _mm_set1_epi32(has_next ? input_sum[i + 1] : 0);
+          sums = _mm256_inserti128_si256(_mm256_castsi128_si256(sum0), sum1, 1);
+          if (mode == InputSumPerRowTimesZp) {
+            sums = _mm256_mullo_epi32(sums, filter_zp_vec);
+          }
+        }
+        __m256i value = _mm256_loadu_si256((const __m256i *)(tile + (i - r) * C4NUM));
+        value = _mm256_add_epi32(_mm256_sub_epi32(value, sums), bias_vec);
+        value = RequantAvx2(value, multiplier_vec, left_shift_vec, right_shift_vec, out_zp_vec, mini_vec, maxi_vec);
+        int8_t out[C8NUM];
+        LowBytesAvx2(value, out);
+        memcpy(dst + i * stride + c, out, col_num);
+        if (has_next) {
+          memcpy(dst + (i + 1) * stride + c, out + C4NUM, col_num);
+        }
+      }
+    }
+  }
+}
+
+void MatmulInt8OptX86(const int8_t *a, const int8_t *b, int8_t *dst, int row, int col, int deep16, const int *a_sums,
+                      const int *bias, int mini, int maxi, int out_zp, const int32_t *multiplier,
+                      const int32_t *left_shift, const int32_t *right_shift, size_t stride, size_t filter_peroc,
+                      const int32_t *filter_zp) {
+  MatMulInt8Tile4x16X86(a, b, dst, row, col, deep16, stride, a_sums,
+                        filter_peroc ? InputSumPerRowTimesZp : InputSumPerRow, filter_zp, bias, multiplier,
+                        left_shift, right_shift, filter_peroc, out_zp, mini, maxi);
+}
+
+void MatMulInt8_16x4_rX86(const int8_t *a, const int8_t *b, int8_t *dst, size_t row, size_t col, size_t deep_16,
+                          size_t stride, const int32_t *input_sum, const int32_t *bias, const int32_t *left_shift,
+                          const int32_t *right_shift, const int32_t *multiplier, int32_t output_zp, int32_t mini,
+                          int32_t maxi, bool peroc) {
+  MatMulInt8Tile4x16X86(a, b, dst, row, col, deep_16, stride, input_sum,
+                        peroc ? InputSumPerRowAndColumn : InputSumPerRow, NULL, bias, multiplier, left_shift,
+                        right_shift, peroc, output_zp, mini, maxi);
+}
+
+TARGET_AVX2 void MatMulInt8_8x8_rX86(const int8_t *a, const int8_t *b, int8_t *dst, size_t row, size_t col,
+                                     size_t deep_4, size_t stride, const int32_t *input_sum, const int32_t *bias,
+                                     const int32_t *left_shift, const int32_t *right_shift, const int32_t *multiplier,
+                                     int32_t output_zp, int32_t mini, int32_t maxi, size_t per_channel) {
+#ifdef ENABLE_X86_INT8_VNNI
+  DotTileFunc dot = GetInt8SimdLevel() == Int8SimdAvx512Vnni ? DotTile8x4Vnni : DotTile8x4Avx2;
+#else
+  DotTileFunc dot = DotTile8x4Avx2;
+#endif
+  int row8 = UP_ROUND(row, C8NUM);
+  const __m256i out_zp_vec = _mm256_set1_epi32(output_zp);
+  const __m256i mini_vec = _mm256_set1_epi32(mini);
+  const __m256i maxi_vec = _mm256_set1_epi32(maxi);
+  for (int c = 0; c < (int)col; c += C8NUM) {
+    int col_num = MSMIN(C8NUM, (int)col - c);
+    ColumnQuantArgs args;
+    LoadColumnQuantArgs(&args, bias, multiplier, left_shift, right_shift, NULL, c, col_num, C8NUM, per_channel);
+    __m256i bias_vec = _mm256_loadu_si256((const __m256i *)args.bias);
+    __m256i multiplier_vec = _mm256_loadu_si256((const __m256i *)args.multiplier);
+    __m256i left_shift_vec = _mm256_loadu_si256((const __m256i *)args.left_shift);
+    __m256i right_shift_vec = _mm256_loadu_si256((const __m256i *)args.right_shift);
+    for (int r = 0; r < (int)row; r += C8NUM) {
+      int32_t tile[C8NUM * C8NUM];
+      dot(a + r * deep_4, b + c * deep_4, deep_4, tile);
+      for (int i = r; i < MSMIN(r + C8NUM, (int)row); i++) {
+        __m256i sums = per_channel ? _mm256_loadu_si256((const __m256i *)(input_sum + c * row8 + i * C8NUM))
+                                   : _mm256_set1_epi32(input_sum[i]);
+        __m256i value = _mm256_loadu_si256((const __m256i *)(tile + (i - r) * C8NUM));
+        value = _mm256_add_epi32(_mm256_sub_epi32(value, sums), bias_vec);
+        value = RequantAvx2(value, multiplier_vec, left_shift_vec, right_shift_vec, out_zp_vec, mini_vec, maxi_vec);
+        int8_t out[C8NUM];
+        LowBytesAvx2(value, out);
+        memcpy(dst + i * stride + c, out, col_num);
+      }
+    }
+  }
+}
+
+TARGET_AVX2 void ConvDwInt8RowX86(int32_t *output_ptr, const int8_t *input_ptr, const int16_t *weight_ptr,
+                                  int num_pixels, int output_channel, int input_step, int8_t input_zp) {
+  const __m256i zp = _mm256_set1_epi32(input_zp);
+  for (int i = 0; i < num_pixels; i++) {
+    int c = 0;
+    for (; c + C8NUM <= output_channel; c += C8NUM) {
+      __m256i input = _mm256_cvtepi8_epi32(_mm_loadl_epi64((const __m128i *)(input_ptr + c)));
+      __m256i weight = _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i *)(weight_ptr + c)));
+      __m256i acc = _mm256_loadu_si256((const __m256i *)(output_ptr + c));
+      acc = _mm256_add_epi32(acc, _mm256_mullo_epi32(_mm256_sub_epi32(input, zp), weight));
+      _mm256_storeu_si256((__m256i *)(output_ptr + c), acc);
+    }
+    for (; c < output_channel; c++) {
+      const int16_t input = input_ptr[c] - input_zp;
+      output_ptr[c] += input * weight_ptr[c];
+    }
+    output_ptr += output_channel;
+    input_ptr += input_step;
+  }
+}
+
+TARGET_AVX2 void RequantInt32ToInt8X86(int8_t *dst, const int32_t *src, int num, int32_t output_zp,
+                                       const int32_t *multiplier, const int32_t *left_shift,
+                                       const int32_t *right_shift, int32_t mini, int32_t maxi, bool per_channel) {
+  const __m256i out_zp_vec = _mm256_set1_epi32(output_zp);
+  const __m256i mini_vec = _mm256_set1_epi32(mini);
+  const __m256i maxi_vec = _mm256_set1_epi32(maxi);
+  __m256i multiplier_vec = _mm256_set1_epi32(multiplier[0]);
+  __m256i left_shift_vec = _mm256_set1_epi32(left_shift[0]);
+  __m256i right_shift_vec = _mm256_set1_epi32(right_shift[0]);
+  int i = 0;
+  for (; i + C8NUM <= num; i += C8NUM) {
+    if (per_channel) {
+      multiplier_vec = _mm256_loadu_si256((const __m256i *)(multiplier + i));
+      left_shift_vec = _mm256_loadu_si256((const __m256i *)(left_shift + i));
+      right_shift_vec = _mm256_loadu_si256((const __m256i *)(right_shift + i));
+    }
+    __m256i value = _mm256_loadu_si256((const __m256i *)(src + i));
+    value = RequantAvx2(value, multiplier_vec, left_shift_vec, right_shift_vec, out_zp_vec, mini_vec, maxi_vec);
+    LowBytesAvx2(value, dst + i);
+  }
+  for (; i < num; i++) {
+    int index = per_channel ? i : 0;
+    int32_t value = RoundingDivideByPOT(
+      SaturatingRoundingDoublingHighMul(src[i] * (1 << (unsigned int)left_shift[index]), multiplier[index]),
+      -right_shift[index]);
+    value += output_zp;
+    value = MSMAX(value, mini);
+    value = MSMIN(value, maxi);
+    dst[i] = (int8_t)value;
+  }
+}
+#endif
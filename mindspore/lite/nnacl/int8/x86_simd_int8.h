@@ -0,0 +1,77 @@
+/**
+ * Copyright 2021 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MINDSPORE_LITE_NNACL_INT8_X86_SIMD_INT8_H_
+#define MINDSPORE_LITE_NNACL_INT8_X86_SIMD_INT8_H_
+
+#include <stdbool.h>
+#include "nnacl/op_base.h"
+
+// The x86 int8 kernels are compiled for their own target with function attributes and picked at runtime, so
+// they need no -mavx2 build flag and the library still runs on cpus without avx2.
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__)) && !defined(ENABLE_ARM)
+#define ENABLE_X86_INT8_SIMD
+// the avx512vnni target and cpu feature names need gcc 8 or clang 8, older compilers build the avx2 kernels only
+#if (defined(__clang__) && __clang_major__ >= 8) || (!defined(__clang__) && __GNUC__ >= 8)
+#define ENABLE_X86_INT8_VNNI
+#endif
+#endif
+
+typedef enum Int8SimdLevel { Int8SimdScalar = 0, Int8SimdAvx2 = 1, Int8SimdAvx512Vnni = 2 } Int8SimdLevel;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+/* best level supported by the running cpu, detected once */
+Int8SimdLevel GetSupportedInt8SimdLevel(void);
+
+/* level the int8 kernels dispatch to, the supported level by default */
+Int8SimdLevel GetInt8SimdLevel(void);
+
+/* restrict the int8 kernels to level, mainly for testing and benchmarking, false if the cpu does not support it */
+bool SetInt8SimdLevel(Int8SimdLevel level);
+
+#ifdef ENABLE_X86_INT8_SIMD
+/* same results as the C kernels of the same name without the suffix, bit for bit */
+void MatmulInt8OptX86(const int8_t *a, const int8_t *b, int8_t *dst, int row, int col, int deep16, const int *a_sums,
+                      const int *bias, int mini, int maxi, int out_zp, const int32_t *multiplier,
+                      const int32_t *left_shift, const int32_t *right_shift, size_t stride, size_t filter_peroc,
+                      const int32_t *filter_zp);
+
+void MatMulInt8_16x4_rX86(const int8_t *a, const int8_t *b, int8_t *dst, size_t row, size_t col, size_t deep_16,
+                          size_t stride, const int32_t *input_sum, const int32_t *bias, const int32_t *left_shift,
+                          const int32_t *right_shift, const int32_t *multiplier, int32_t output_zp, int32_t mini,
+                          int32_t maxi, bool peroc);
+
+void MatMulInt8_8x8_rX86(const int8_t *a, const int8_t *b, int8_t *dst, size_t row, size_t col, size_t deep_4,
+                         size_t stride, const int32_t *input_sum, const int32_t *bias, const int32_t *left_shift,
+                         const int32_t *right_shift, const int32_t *multiplier, int32_t output_zp, int32_t mini,
+                         int32_t maxi, size_t per_channel);
+
+void ConvDwInt8RowX86(int32_t *output_ptr, const int8_t *input_ptr, const int16_t *weight_ptr, int num_pixels,
+                      int output_channel, int input_step, int8_t input_zp);
+
+/* requantize num int32 accumulators to int8, with the parameters of element i at i when per_channel, else at 0 */
+void RequantInt32ToInt8X86(int8_t *dst, const int32_t *src, int num, int32_t output_zp, const int32_t *multiplier,
+                           const int32_t *left_shift, const int32_t *right_shift, int32_t mini, int32_t maxi,
+                           bool per_channel);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // MINDSPORE_LITE_NNACL_INT8_X86_SIMD_INT8_H_
@@ -47,6 +47,9 @@
 
 #define MSVALID(left, x, right) (MSMIN((MSMAX(left, x)), right))
 
+// tasks per thread of a launch, the pool deals them out and idle threads steal them from slow or descheduled ones
+#define kTaskPerThread 4
+
 #define DIMENSION_4D 4
 #define DIMENSION_6D 6
 #define kInputIndex 0
@@ -16,6 +16,11 @@
 
 #include "src/common/file_utils.h"
 #include <fcntl.h>
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 #include <cstdlib>
 #include <climits>
 #include "securec/include/securec.h"
@@ -56,6 +61,46 @@ char *ReadFile(const char *file, size_t *size) {
   return buf.release();
 }
 
+#ifndef _WIN32
+char *MapFile(const char *file, size_t *size) {
+  if (file == nullptr) {
+    MS_LOG(ERROR) << "file is nullptr";
+    return nullptr;
+  }
+  MS_ASSERT(size != nullptr);
+  std::string real_path = RealPath(file);
+  int fd = open(real_path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    MS_LOG(ERROR) << "file: " << real_path << " open failed";
+    return nullptr;
+  }
+  struct stat file_stat;
+  if (fstat(fd, &file_stat) != 0 || file_stat.st_size <= 0) {
+    MS_LOG(ERROR) << "file: " << real_path << " is empty or stat failed";
+    close(fd);
+    return nullptr;
+  }
+  *size = static_cast<size_t>(file_stat.st_size);
+  // private writable mapping: pages are shared until a kernel writes to a weight in place
+  auto buf = mmap(nullptr, *size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (buf == MAP_FAILED) {
+    MS_LOG(ERROR) << "mmap file: " << real_path << " failed";
+    return nullptr;
+  }
+  return reinterpret_cast<char *>(buf);
+}
+
+void UnmapFile(char *buf, size_t size) {
+  if (buf == nullptr || size == 0) {
+    return;
+  }
+  if (munmap(buf, size) != 0) {
+    MS_LOG(ERROR) << "munmap buffer failed";
+  }
+}
+#endif
+
 std::string RealPath(const char *path) {
   if (path == nullptr) {
     MS_LOG(ERROR) << "path is nullptr";
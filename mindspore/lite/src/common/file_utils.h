@@ -31,6 +31,13 @@ namespace mindspore {
 namespace lite {
 char *ReadFile(const char *file, size_t *size);
 
+#ifndef _WIN32
+// Map the file into memory copy-on-write, the returned buffer is released by UnmapFile.
+char *MapFile(const char *file, size_t *size);
+
+void UnmapFile(char *buf, size_t size);
+#endif
+
 std::string RealPath(const char *path);
 
 template <typename T>
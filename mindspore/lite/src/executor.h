@@ -35,6 +35,8 @@ class Executor {
                   const KernelCallBack &before = nullptr, const KernelCallBack &after = nullptr);
 
  protected:
+  // the memory saving steps of TrainSession run the kernels without an executor
+  friend class TrainSession;
   static int CheckInputs(const std::vector<Tensor *> &in_tensors);
 };
 
@@ -25,6 +25,10 @@ namespace mindspore::lite {
 InnerContext::InnerContext(const Context *context) {
   this->allocator = context->allocator;
   this->thread_num_ = context->thread_num_;
+  this->enable_parallel_ = context->enable_parallel_;
+  this->enable_tuning_ = context->enable_tuning_;
+  this->tuning_cache_file_ = context->tuning_cache_file_;
+  this->enable_static_memory_plan_ = context->enable_static_memory_plan_;
   this->device_list_.clear();
   for (auto &device_ctx : context->device_list_) {
     this->device_list_.push_back(device_ctx);
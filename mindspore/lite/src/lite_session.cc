@@ -15,6 +15,7 @@
  */
 
 #include "src/lite_session.h"
+#include <algorithm>
 #include <vector>
 #include <utility>
 #include "src/runtime/runtime_api.h"
@@ -34,6 +35,10 @@
 
 namespace mindspore {
 namespace lite {
+namespace {
+constexpr size_t kResizePlanNum = 8;
+}  // namespace
+
 static std::vector<schema::PrimitiveType> packed_op = {
   schema::PrimitiveType_Conv2D, schema::PrimitiveType_DeConv2D, schema::PrimitiveType_DepthwiseConv2D,
   schema::PrimitiveType_DeDepthwiseConv2D, schema::PrimitiveType_MatMul};
@@ -112,6 +117,15 @@ int LiteSession::ConvertTensorsData(const lite::Model *model, size_t tensor_inde
         dst_tensor->set_data(const_cast<unsigned char *>(src_tensor->data()->data()));
       }
     }
+#ifndef SUPPORT_TRAIN
+    // the weights of a model never change, a weight packed for one session of the model is shared by the others
+    dst_tensor->set_weight_id((GetModelId(model) << 32) | static_cast<uint64_t>(tensor_index));
+    if (src_tensor->packedData() != nullptr && src_tensor->packedData()->size() > 0 &&
+        src_tensor->packedLayout() != nullptr) {
+      dst_tensor->set_packed_data(src_tensor->packedData()->data(), src_tensor->packedData()->size(),
+                                  src_tensor->packedLayout()->str(), GetMappedBuffer(model));
+    }
+#endif
   }
   return RET_OK;
 }
@@ -379,6 +393,17 @@ int LiteSession::CompileGraph(Model *model) {
     is_running_.store(false);
     return ret;
   }
+  ret = InitStaticMemoryPlan(true);
+  if (ret != RET_OK) {
+    MS_LOG(ERROR) << "Init static memory plan failed: " << ret;
+    is_running_.store(false);
+    return ret;
+  }
+  std::vector<std::vector<int>> dims;
+  for (auto input : inputs_) {
+    dims.push_back(input->shape());
+  }
+  SaveResizePlan(InputShapeKey(dims));
   is_running_.store(false);
   return RET_OK;
 }
@@ -394,6 +419,190 @@ int LiteSession::PrepareKernels() {
   return RET_OK;
 }
 
+int LiteSession::InitStaticMemoryPlan(bool new_shapes) {
+#ifdef SUPPORT_TRAIN
+  // training keeps activations alive for the backward pass
+  return RET_OK;
+#else
+  // nodes run concurrently by the parallel executor do not follow a single execution order
+  if (!context_->enable_static_memory_plan_ || context_->enable_parallel_ || kernels_.size() != 1 ||
+      kernels_.front()->subgraph_type() != kernel::kCpuFP32SubGraph) {
+    return RET_OK;
+  }
+  auto nodes = reinterpret_cast<kernel::SubGraphKernel *>(kernels_.front())->nodes();
+  for (auto node : nodes) {
+    // output shapes are only known at run time
+    if (node->GetPrimitive() != nullptr && !node->GetPrimitive()->infer_flag()) {
+      MS_LOG(INFO) << "Infer shape of " << node->name() << " is not done, skip static memory plan";
+      return RET_OK;
+    }
+    if (node->Type() == schema::PrimitiveType_Merge || node->Type() == schema::PrimitiveType_Switch ||
+        node->Type() == schema::PrimitiveType_Partial) {
+      return RET_OK;
+    }
+  }
+  auto ret = memory_planner_.Plan(nodes, inputs_, outputs_);
+  if (ret != RET_OK) {
+    MS_LOG(ERROR) << "Plan static memory failed: " << ret;
+    return ret;
+  }
+  return BindStaticMemoryPlan(new_shapes);
+#endif
+}
+
+int LiteSession::BindStaticMemoryPlan(bool new_shapes) {
+  if (memory_planner_.plans().empty()) {
+    if (static_allocator_ != nullptr) {
+      static_allocator_->Clear();
+    }
+    return RET_OK;
+  }
+  if (static_allocator_ == nullptr) {
+    static_allocator_ = new (std::nothrow) StaticAllocator();
+    if (static_allocator_ == nullptr) {
+      MS_LOG(ERROR) << "New StaticAllocator failed";
+      return RET_MEMORY_FAILED;
+    }
+  }
+  // the arena is sized for the largest cached plan at most, plans evicted from the cache do not keep it large. Saving
+  // the plan of new shapes evicts the least recently used one, which is only dropped once the resize succeeded.
+  auto max_arena_size = memory_planner_.arena_size();
+  auto kept_num = new_shapes ? kResizePlanNum - 1 : kResizePlanNum;
+  for (auto iter = resize_plans_.begin(); iter != resize_plans_.end() && kept_num > 0; ++iter, --kept_num) {
+    max_arena_size = std::max(max_arena_size, iter->second.memory_planner.arena_size());
+  }
+  auto ret = static_allocator_->MallocArena(memory_planner_.arena_size(), max_arena_size);
+  if (ret != RET_OK) {
+    MS_LOG(ERROR) << "Malloc static memory arena failed: " << ret;
+    return ret;
+  }
+  for (auto &plan : memory_planner_.plans()) {
+    plan.tensor->FreeData();
+    plan.tensor->set_allocator(static_allocator_);
+    plan.tensor->set_data(static_allocator_->GetBuffer(plan.offset));
+  }
+  MS_LOG(INFO) << "Static memory plan: " << memory_planner_.plans().size()
+               << " tensors, arena size: " << memory_planner_.arena_size()
+               << ", peak live size: " << memory_planner_.peak_live_size()
+               << ", size without reuse: " << memory_planner_.total_tensor_size();
+  return RET_OK;
+}
+
+void LiteSession::ReleaseStaticMemoryPlan(bool keep_arena) {
+  if (static_allocator_ == nullptr) {
+    return;
+  }
+  for (auto &plan : memory_planner_.plans()) {
+    // the arena is cleared or kept as a whole, a buffer that fell back to malloc belongs to the tensor
+    if (static_allocator_->IsArenaBuffer(plan.tensor->data_c())) {
+      plan.tensor->set_data(nullptr);
+    } else {
+      plan.tensor->FreeData();
+    }
+    plan.tensor->set_allocator(this->context_->allocator.get());
+  }
+  memory_planner_.Reset();
+  if (!keep_arena) {
+    static_allocator_->Clear();
+  }
+}
+
+std::string LiteSession::InputShapeKey(const std::vector<std::vector<int>> &dims) {
+  std::string key;
+  for (auto &shape : dims) {
+    for (auto dim : shape) {
+      key += std::to_string(dim) + ",";
+    }
+    key += ";";
+  }
+  return key;
+}
+
+bool LiteSession::IsResizePlanCacheable() {
+  for (auto kernel : kernels_) {
+    if (kernel->subgraph_type() != kernel::kCpuFP32SubGraph && kernel->subgraph_type() != kernel::kCpuFP16SubGraph) {
+      return false;
+    }
+    for (auto node : reinterpret_cast<kernel::SubGraphKernel *>(kernel)->nodes()) {
+      if (node->GetPrimitive() == nullptr || !node->GetPrimitive()->infer_flag()) {
+        return false;
+      }
+      // the shapes of control flow and tensor list outputs depend on the data
+      if (node->Type() == schema::PrimitiveType_Merge || node->Type() == schema::PrimitiveType_Switch ||
+          node->Type() == schema::PrimitiveType_Partial) {
+        return false;
+      }
+      for (auto tensor : node->out_tensors()) {
+        if (tensor->data_type() == kObjectTypeTensorType) {
+          return false;
+        }
+      }
+    }
+  }
+  return true;
+}
+
+std::vector<Tensor *> LiteSession::InferredTensors() {
+  std::vector<Tensor *> tensors;
+  for (auto kernel : kernels_) {
+    for (auto node : reinterpret_cast<kernel::SubGraphKernel *>(kernel)->nodes()) {
+      tensors.insert(tensors.end(), node->out_tensors().begin(), node->out_tensors().end());
+    }
+  }
+  return tensors;
+}
+
+void LiteSession::SaveResizePlan(const std::string &key) {
+  if (!IsResizePlanCacheable()) {
+    return;
+  }
+  auto iter = resize_plan_map_.find(key);
+  if (iter != resize_plan_map_.end()) {
+    resize_plans_.erase(iter->second);
+    resize_plan_map_.erase(iter);
+  }
+  ResizePlan plan;
+  for (auto tensor : InferredTensors()) {
+    plan.shapes.push_back(tensor->shape());
+    plan.formats.push_back(tensor->format());
+    plan.data_types.push_back(tensor->data_type());
+  }
+  plan.memory_planner = memory_planner_;
+  resize_plans_.emplace_front(key, std::move(plan));
+  resize_plan_map_[key] = resize_plans_.begin();
+  DropResizePlans(kResizePlanNum);
+}
+
+void LiteSession::DropResizePlans(size_t keep_num) {
+  while (resize_plans_.size() > keep_num) {
+    resize_plan_map_.erase(resize_plans_.back().first);
+    resize_plans_.pop_back();
+  }
+}
+
+int LiteSession::RestoreResizePlan(const ResizePlan &plan) {
+  auto tensors = InferredTensors();
+  if (tensors.size() != plan.shapes.size()) {
+    MS_LOG(ERROR) << "Resize plan of " << plan.shapes.size() << " tensors does not match " << tensors.size();
+    return RET_ERROR;
+  }
+  for (size_t i = 0; i < tensors.size(); ++i) {
+    tensors[i]->FreeData();
+    tensors[i]->set_shape(plan.shapes[i]);
+    tensors[i]->set_format(plan.formats[i]);
+    tensors[i]->set_data_type(plan.data_types[i]);
+  }
+  for (auto kernel : kernels_) {
+    auto ret = reinterpret_cast<kernel::SubGraphKernel *>(kernel)->ReSizeNodes();
+    if (ret != RET_OK) {
+      MS_LOG(ERROR) << "ReSize nodes of " << kernel->name() << " failed: " << ret;
+      return ret;
+    }
+  }
+  memory_planner_ = plan.memory_planner;
+  return BindStaticMemoryPlan();
+}
+
 std::vector<mindspore::tensor::MSTensor *> LiteSession::GetInputs() const { return this->input_vec_; }
 
 int LiteSession::RunGraph(const KernelCallBack &before, const KernelCallBack &after) {
@@ -499,6 +708,9 @@ LiteSession::~LiteSession() {
     }
     delete tensor;
   }
+  // planned tensors are deleted above, they never free arena buffers
+  delete static_allocator_;
+  static_allocator_ = nullptr;
   // Tensor * in input_map output_map are freed in tensors
   input_map_.clear();
   output_node_map_.clear();
@@ -621,6 +833,21 @@ int LiteSession::Resize(const std::vector<mindspore::tensor::MSTensor *> &inputs
     return ret;
   }
 
+  ReleaseStaticMemoryPlan(true);
+  auto key = InputShapeKey(dims);
+  auto plan_iter = resize_plan_map_.find(key);
+  if (plan_iter != resize_plan_map_.end()) {
+    ret = RestoreResizePlan(plan_iter->second->second);
+    if (ret == RET_OK) {
+      resize_plans_.splice(resize_plans_.begin(), resize_plans_, plan_iter->second);
+      is_running_.store(false);
+      return RET_OK;
+    }
+    MS_LOG(WARNING) << "Restore resize plan failed, resize again: " << ret;
+    ReleaseStaticMemoryPlan(true);
+    resize_plans_.erase(plan_iter->second);
+    resize_plan_map_.erase(plan_iter);
+  }
   ret = ReSizeKernels(kernels_);
   if (ret != RET_OK) {
     ResetInputsShape(old_dims);
@@ -628,9 +855,24 @@ int LiteSession::Resize(const std::vector<mindspore::tensor::MSTensor *> &inputs
     if (resize_ret != RET_OK) {
       MS_LOG(ERROR) << "restore kernel size fail!ret: " << resize_ret;
     }
+    resize_ret = InitStaticMemoryPlan();
+    if (resize_ret != RET_OK) {
+      MS_LOG(ERROR) << "restore static memory plan fail!ret: " << resize_ret;
+    }
     is_running_.store(false);
     return ret;
   }
+  ret = InitStaticMemoryPlan(true);
+  if (ret != RET_OK) {
+    MS_LOG(ERROR) << "Init static memory plan failed: " << ret;
+    is_running_.store(false);
+    return ret;
+  }
+  if (memory_planner_.plans().empty() && static_allocator_ != nullptr) {
+    // the arena kept for the plan of the new shapes is not used
+    static_allocator_->Clear();
+  }
+  SaveResizePlan(key);
   is_running_.store(false);
   return RET_OK;
 }
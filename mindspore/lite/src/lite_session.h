@@ -20,7 +20,9 @@
 #include <memory>
 #include <vector>
 #include <string>
+#include <list>
 #include <unordered_map>
+#include <utility>
 #include <atomic>
 #include "src/lite_kernel.h"
 #include "include/ms_tensor.h"
@@ -31,12 +33,22 @@
 #include "src/executor.h"
 #include "src/tensor.h"
 #include "src/tensorlist.h"
+#include "src/runtime/static_allocator.h"
 #if SUPPORT_GPU
 #include "src/runtime/opencl/opencl_runtime.h"
 #endif
 
 namespace mindspore {
 namespace lite {
+// What Resize derives from one set of input shapes: the shape, format and data type of every tensor produced by a
+// node, and the static memory plan.
+struct ResizePlan {
+  std::vector<std::vector<int>> shapes;
+  std::vector<schema::Format> formats;
+  std::vector<TypeId> data_types;
+  StaticMemoryPlanner memory_planner;
+};
+
 class LiteSession : public session::LiteSession {
  public:
   LiteSession();
@@ -100,6 +112,32 @@ class LiteSession : public session::LiteSession {
 
   static int ReSizeKernels(const std::vector<kernel::LiteKernel *> &kernels);
 
+  // bind intermediate tensors of a single cpu fp32 sub graph to offsets of one arena, so that running the graph does
+  // not malloc or free any of them, new_shapes tells the plan is saved as the resize plan of new shapes
+  int InitStaticMemoryPlan(bool new_shapes = false);
+
+  // keep_arena keeps the arena for the plan of the next shapes to reuse
+  void ReleaseStaticMemoryPlan(bool keep_arena = false);
+
+  // bind the planned tensors of memory_planner_ to their offsets in the arena
+  int BindStaticMemoryPlan(bool new_shapes = false);
+
+  // Resize plans are kept for the kResizePlanNum input shapes used last, restoring one skips the shape inference and
+  // the memory planning, only the kernels whose tensors changed are resized.
+  static std::string InputShapeKey(const std::vector<std::vector<int>> &dims);
+
+  bool IsResizePlanCacheable();
+
+  // tensors whose shape Resize infers, in execution order
+  std::vector<Tensor *> InferredTensors();
+
+  void SaveResizePlan(const std::string &key);
+
+  // drop the least recently used resize plans beyond keep_num
+  void DropResizePlans(size_t keep_num);
+
+  int RestoreResizePlan(const ResizePlan &plan);
+
  private:
   void ResetInputsShape(const std::vector<std::vector<int>> &dims);
 
@@ -128,6 +166,11 @@ class LiteSession : public session::LiteSession {
   std::unordered_map<std::string, mindspore::tensor::MSTensor *> output_tensor_map_;
   Executor *executor_ = nullptr;
   std::atomic<bool> is_running_ = false;
+  StaticAllocator *static_allocator_ = nullptr;
+  StaticMemoryPlanner memory_planner_;
+  // input shape key -- resize plan, most recently used first
+  std::list<std::pair<std::string, ResizePlan>> resize_plans_;
+  std::unordered_map<std::string, std::list<std::pair<std::string, ResizePlan>>::iterator> resize_plan_map_;
 #if SUPPORT_GPU
   opencl::OpenCLRuntimeWrapper ocl_runtime_wrap_;
 #endif
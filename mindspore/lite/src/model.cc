@@ -13,16 +13,104 @@
  * See the License for the specific language governing permissions and
  * limitations under the License.
  */
+#include <memory>
+#include <mutex>
+#include <unordered_map>
 #include "src/ops/primitive_c.h"
 #include "include/model.h"
 #include "src/common/log_adapter.h"
+#include "src/common/file_utils.h"
 #include "src/model_common.h"
 
 namespace mindspore::lite {
+namespace {
+struct MappedBuffer {
+  size_t size = 0;
+  // unmaps the file once the model and every packed weight pointing into it are released
+  std::shared_ptr<const char> holder;
+};
+
+// buf of a model imported from a file -- its mapping, kept out of the public Model struct
+std::mutex mapped_bufs_mutex;
+std::unordered_map<const char *, MappedBuffer> mapped_bufs;
+
+// model -- its id, ids are never reused so a model allocated at the address of a deleted one gets another id
+std::mutex model_ids_mutex;
+std::unordered_map<const Model *, uint64_t> model_ids;
+uint64_t next_model_id = 1;
+}  // namespace
+
+uint64_t GetModelId(const Model *model) {
+  std::lock_guard<std::mutex> lock(model_ids_mutex);
+  auto iter = model_ids.find(model);
+  if (iter != model_ids.end()) {
+    return iter->second;
+  }
+  auto id = next_model_id++;
+  model_ids[model] = id;
+  return id;
+}
+
+size_t GetMappedSize(const Model *model) {
+  std::lock_guard<std::mutex> lock(mapped_bufs_mutex);
+  auto iter = mapped_bufs.find(model->buf);
+  return iter == mapped_bufs.end() ? 0 : iter->second.size;
+}
+
+std::shared_ptr<const char> GetMappedBuffer(const Model *model) {
+  std::lock_guard<std::mutex> lock(mapped_bufs_mutex);
+  auto iter = mapped_bufs.find(model->buf);
+  return iter == mapped_bufs.end() ? nullptr : iter->second.holder;
+}
+
 Model *Model::Import(const char *model_buf, size_t size) { return ImportFromBuffer(model_buf, size, false); }
 
+Model *Model::Import(const char *model_file) {
+  size_t size = 0;
+#ifdef _WIN32
+  std::unique_ptr<char[]> model_buf(ReadFile(model_file, &size));
+  if (model_buf == nullptr) {
+    MS_LOG(ERROR) << "Read model file failed";
+    return nullptr;
+  }
+  return ImportFromBuffer(model_buf.get(), size, false);
+#else
+  auto model_buf = MapFile(model_file, &size);
+  if (model_buf == nullptr) {
+    MS_LOG(ERROR) << "Map model file failed";
+    return nullptr;
+  }
+  auto model = ImportFromBuffer(model_buf, size, true);
+  if (model == nullptr) {
+    UnmapFile(model_buf, size);
+    return nullptr;
+  }
+  MappedBuffer mapped_buf;
+  mapped_buf.size = size;
+  mapped_buf.holder = std::shared_ptr<const char>(model->buf, [size](const char *buf) {
+    UnmapFile(const_cast<char *>(buf), size);
+  });
+  std::lock_guard<std::mutex> lock(mapped_bufs_mutex);
+  mapped_bufs[model->buf] = mapped_buf;
+  return model;
+#endif
+}
+
 void Model::Free() {
   if (this->buf != nullptr) {
+#ifndef _WIN32
+    std::unique_lock<std::mutex> lock(mapped_bufs_mutex);
+    auto iter = mapped_bufs.find(this->buf);
+    if (iter != mapped_bufs.end()) {
+      // unmapped here unless packed weights of sessions still point into it
+      auto holder = std::move(iter->second.holder);
+      mapped_bufs.erase(iter);
+      lock.unlock();
+      holder = nullptr;
+      this->buf = nullptr;
+      return;
+    }
+#endif
     free(this->buf);
     this->buf = nullptr;
   }
@@ -48,5 +136,9 @@ void Model::Destroy() {
   }
 }
 
-Model::~Model() { Destroy(); }
+Model::~Model() {
+  Destroy();
+  std::lock_guard<std::mutex> lock(model_ids_mutex);
+  (void)model_ids.erase(this);
+}
 }  // namespace mindspore::lite
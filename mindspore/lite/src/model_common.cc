@@ -169,6 +169,14 @@ int GenerateModelByVersion(const void *meta_graph, Model *model, const int &sche
   return status;
 }
 
+void DeleteImportingModel(Model *model, bool take_buf) {
+  // a taken buffer stays owned by the caller when importing fails, it may be mapped rather than malloced
+  if (take_buf) {
+    model->buf = nullptr;
+  }
+  delete (model);
+}
+
 Model *ImportFromBuffer(const char *model_buf, size_t size, bool take_buf) {
   if (model_buf == nullptr) {
     MS_LOG(ERROR) << "The model buf is nullptr";
@@ -204,13 +212,13 @@ Model *ImportFromBuffer(const char *model_buf, size_t size, bool take_buf) {
   const void *meta_graph = GetMetaGraphByVerison(model->buf, schema_version);
   if (meta_graph == nullptr) {
     MS_LOG(ERROR) << "meta_graph is nullptr!";
-    delete (model);
+    DeleteImportingModel(model, take_buf);
     return nullptr;
   }
 
   int status = GenerateModelByVersion(meta_graph, model, schema_version);
   if (status != RET_OK) {
-    delete (model);
+    DeleteImportingModel(model, take_buf);
     MS_LOG(ERROR) << "fail to generate model";
     return nullptr;
   }
@@ -219,10 +227,14 @@ Model *ImportFromBuffer(const char *model_buf, size_t size, bool take_buf) {
     MS_LOG(WARNING) << "model version is " << model->version_ << ", inference version is " << Version() << " not equal";
   }
   if (model->sub_graphs_.empty()) {
-    delete (model);
+    DeleteImportingModel(model, take_buf);
     return nullptr;
   }
 
-  return ModelVerify(*model) ? model : nullptr;
+  if (!ModelVerify(*model)) {
+    DeleteImportingModel(model, take_buf);
+    return nullptr;
+  }
+  return model;
 }
 }  // namespace mindspore::lite
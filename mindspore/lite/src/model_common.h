@@ -17,6 +17,7 @@
 #ifndef MINDSPORE_LITE_SRC_MODEL_COMMON_H_
 #define MINDSPORE_LITE_SRC_MODEL_COMMON_H_
 
+#include <memory>
 #include <string>
 #include "src/ops/primitive_c.h"
 #include "include/model.h"
@@ -187,6 +188,18 @@ const void *GetMetaGraphByVerison(const char *buf, const int &schema_version);
 
 int GenerateModelByVersion(const void *meta_graph, Model *model, const int &schema_version);
 
+void DeleteImportingModel(Model *model, bool take_buf);
+
 Model *ImportFromBuffer(const char *model_buf, size_t size, bool take_buf);
+
+// Bytes of model->buf mapped from the model file by Model::Import, 0 if buf is allocated.
+size_t GetMappedSize(const Model *model);
+
+// Owner of the mapping of model->buf, nullptr if buf is allocated. Model::Free only drops its own reference, the
+// file stays mapped while a holder lives.
+std::shared_ptr<const char> GetMappedBuffer(const Model *model);
+
+// Process-wide id of the model, assigned on first use and never given to another model.
+uint64_t GetModelId(const Model *model);
 }  // namespace mindspore::lite
 #endif  // MINDSPORE_LITE_SRC_MODEL_COMMON_H_
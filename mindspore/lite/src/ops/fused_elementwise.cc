@@ -0,0 +1,121 @@
+/**
+ * Copyright 2021 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "src/ops/fused_elementwise.h"
+
+#ifndef PRIMITIVE_WRITEABLE
+#include "src/ops/ops_register.h"
+#endif
+
+namespace mindspore {
+namespace lite {
+#ifdef PRIMITIVE_WRITEABLE
+std::vector<int> FusedElementwise::GetOpTypes() const {
+  return this->primitive_->value.AsFusedElementwise()->opTypes;
+}
+std::vector<int> FusedElementwise::GetOperandIndex() const {
+  return this->primitive_->value.AsFusedElementwise()->operandIndex;
+}
+std::vector<float> FusedElementwise::GetAlpha() const { return this->primitive_->value.AsFusedElementwise()->alpha; }
+
+void FusedElementwise::SetOpTypes(const std::vector<int> &op_types) {
+  this->primitive_->value.AsFusedElementwise()->opTypes = op_types;
+}
+void FusedElementwise::SetOperandIndex(const std::vector<int> &operand_index) {
+  this->primitive_->value.AsFusedElementwise()->operandIndex = operand_index;
+}
+void FusedElementwise::SetAlpha(const std::vector<float> &alpha) {
+  this->primitive_->value.AsFusedElementwise()->alpha = alpha;
+}
+
+#else
+
+std::vector<int> FusedElementwise::GetOpTypes() const {
+  auto fb_vector = this->primitive_->value_as_FusedElementwise()->opTypes();
+  if (fb_vector == nullptr) {
+    return {};
+  }
+  return std::vector<int>(fb_vector->begin(), fb_vector->end());
+}
+std::vector<int> FusedElementwise::GetOperandIndex() const {
+  auto fb_vector = this->primitive_->value_as_FusedElementwise()->operandIndex();
+  if (fb_vector == nullptr) {
+    return {};
+  }
+  return std::vector<int>(fb_vector->begin(), fb_vector->end());
+}
+std::vector<float> FusedElementwise::GetAlpha() const {
+  auto fb_vector = this->primitive_->value_as_FusedElementwise()->alpha();
+  if (fb_vector == nullptr) {
+    return {};
+  }
+  return std::vector<float>(fb_vector->begin(), fb_vector->end());
+}
+
+int FusedElementwise::UnPackToFlatBuilder(const schema::Primitive *primitive, flatbuffers::FlatBufferBuilder *fbb) {
+  MS_ASSERT(nullptr != primitive);
+  MS_ASSERT(nullptr != fbb);
+  auto attr = primitive->value_as_FusedElementwise();
+  if (attr == nullptr) {
+    MS_LOG(ERROR) << "value_as_FusedElementwise return nullptr";
+    return RET_ERROR;
+  }
+  std::vector<int32_t> op_types;
+  if (attr->opTypes() != nullptr) {
+    op_types.assign(attr->opTypes()->begin(), attr->opTypes()->end());
+  }
+  std::vector<int32_t> operand_index;
+  if (attr->operandIndex() != nullptr) {
+    operand_index.assign(attr->operandIndex()->begin(), attr->operandIndex()->end());
+  }
+  std::vector<float> alpha;
+  if (attr->alpha() != nullptr) {
+    alpha.assign(attr->alpha()->begin(), attr->alpha()->end());
+  }
+  auto val_offset = schema::CreateFusedElementwiseDirect(*fbb, &op_types, &operand_index, &alpha);
+  auto prim_offset = schema::CreatePrimitive(*fbb, schema::PrimitiveType_FusedElementwise, val_offset.o);
+  fbb->Finish(prim_offset);
+  return RET_OK;
+}
+
+PrimitiveC *FusedElementwiseCreator(const schema::Primitive *primitive) {
+  return PrimitiveC::NewPrimitiveC<FusedElementwise>(primitive);
+}
+Registry FusedElementwiseRegistry(schema::PrimitiveType_FusedElementwise, FusedElementwiseCreator);
+#endif
+
+int FusedElementwise::InferShape(std::vector<Tensor *> inputs, std::vector<Tensor *> outputs) {
+  MS_ASSERT(this->primitive_ != nullptr);
+  if (inputs.empty() || outputs.size() != 1) {
+    MS_LOG(ERROR) << "FusedElementwise should have inputs and one output, got " << inputs.size() << " inputs and "
+                  << outputs.size() << " outputs";
+    return RET_INPUT_TENSOR_ERROR;
+  }
+  auto input = inputs.front();
+  MS_ASSERT(input != nullptr);
+  auto output = outputs.front();
+  MS_ASSERT(output != nullptr);
+  output->set_data_type(input->data_type());
+  output->set_format(input->format());
+  if (!infer_flag()) {
+    return RET_INFER_INVALID;
+  }
+  // the converter only fuses operands broadcasting to input 0
+  output->set_shape(input->shape());
+  return RET_OK;
+}
+}  // namespace lite
+}  // namespace mindspore
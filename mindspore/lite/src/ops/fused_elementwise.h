@@ -0,0 +1,49 @@
+/**
+ * Copyright 2021 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LITE_MINDSPORE_LITE_C_OPS_FUSED_ELEMENTWISE_H_
+#define LITE_MINDSPORE_LITE_C_OPS_FUSED_ELEMENTWISE_H_
+
+#include <vector>
+
+#include "src/ops/primitive_c.h"
+
+namespace mindspore {
+namespace lite {
+// Chain of elementwise ops fused by the converter, input 0 runs through the steps of GetOpTypes, a binary step
+// reading input GetOperandIndex of its step.
+class FusedElementwise : public PrimitiveC {
+ public:
+  FusedElementwise() = default;
+  ~FusedElementwise() = default;
+#ifdef PRIMITIVE_WRITEABLE
+  MS_DECLARE_PARENT(FusedElementwise, PrimitiveC);
+  explicit FusedElementwise(schema::PrimitiveT *primitive) : PrimitiveC(primitive) {}
+  void SetOpTypes(const std::vector<int> &op_types);
+  void SetOperandIndex(const std::vector<int> &operand_index);
+  void SetAlpha(const std::vector<float> &alpha);
+#else
+  int UnPackToFlatBuilder(const schema::Primitive *primitive, flatbuffers::FlatBufferBuilder *fbb) override;
+#endif
+  int InferShape(std::vector<lite::Tensor *> inputs_, std::vector<lite::Tensor *> outputs_) override;
+  std::vector<int> GetOpTypes() const;
+  std::vector<int> GetOperandIndex() const;
+  std::vector<float> GetAlpha() const;
+};
+}  // namespace lite
+}  // namespace mindspore
+
+#endif  // LITE_MINDSPORE_LITE_C_OPS_FUSED_ELEMENTWISE_H_
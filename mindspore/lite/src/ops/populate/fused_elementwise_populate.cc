@@ -0,0 +1,57 @@
+/**
+ * Copyright 2021 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "src/ops/fused_elementwise.h"
+#include "src/ops/primitive_c.h"
+#include "src/ops/populate/populate_register.h"
+#include "nnacl/fp32/fused_elementwise_fp32.h"
+
+namespace mindspore {
+namespace lite {
+
+OpParameter *PopulateFusedElementwiseParameter(const mindspore::lite::PrimitiveC *primitive) {
+  auto *param = reinterpret_cast<FusedElementwiseParameter *>(malloc(sizeof(FusedElementwiseParameter)));
+  if (param == nullptr) {
+    MS_LOG(ERROR) << "malloc FusedElementwiseParameter failed.";
+    return nullptr;
+  }
+  memset(param, 0, sizeof(FusedElementwiseParameter));
+  param->op_parameter_.type_ = primitive->Type();
+  auto fused =
+    reinterpret_cast<mindspore::lite::FusedElementwise *>(const_cast<mindspore::lite::PrimitiveC *>(primitive));
+  auto op_types = fused->GetOpTypes();
+  auto operand_index = fused->GetOperandIndex();
+  auto alpha = fused->GetAlpha();
+  if (op_types.empty() || op_types.size() > MAX_FUSED_ELEMENTWISE_STEP || operand_index.size() != op_types.size() ||
+      alpha.size() != op_types.size()) {
+    MS_LOG(ERROR) << "Invalid FusedElementwise steps, op types: " << op_types.size()
+                  << ", operand index: " << operand_index.size() << ", alpha: " << alpha.size();
+    free(param);
+    return nullptr;
+  }
+  param->step_num_ = static_cast<int>(op_types.size());
+  for (size_t i = 0; i < op_types.size(); ++i) {
+    param->ops_[i] = op_types[i];
+    param->operand_index_[i] = operand_index[i];
+    param->alpha_[i] = alpha[i];
+  }
+  return reinterpret_cast<OpParameter *>(param);
+}
+
+Registry FusedElementwiseParameterRegistry(schema::PrimitiveType_FusedElementwise, PopulateFusedElementwiseParameter);
+
+}  // namespace lite
+}  // namespace mindspore
@@ -156,6 +156,7 @@
 #include "src/ops/tensorlistreserve.h"
 #include "src/ops/tensorliststack.h"
 #include "src/ops/merge.h"
+#include "src/ops/fused_elementwise.h"
 #include "src/ops/switch.h"
 #include "src/ops/partial.h"
 
@@ -934,6 +935,8 @@ PrimitiveC *PrimitiveC::Create(mindspore::schema::PrimitiveT *primitive) {
       return new (std::nothrow) Merge(primitive);
     case schema::PrimitiveType_Partial:
       return new (std::nothrow) Partial(primitive);
+    case schema::PrimitiveType_FusedElementwise:
+      return new (std::nothrow) FusedElementwise(primitive);
 #ifdef SUPPORT_TRAIN
     case schema::PrimitiveType_ActivationGrad:
       return new (std::nothrow) ActivationGrad(primitive);
@@ -26,6 +26,9 @@
 #include <unordered_set>
 
 namespace mindspore::lite {
+// 6 is empirical value
+constexpr int kDefaultShiftFactor = 6;
+
 struct AllocatorContext {
   int shiftFactor;
   bool lockFlag;
@@ -38,6 +41,7 @@ class Allocator {
   virtual void *Malloc(size_t size) = 0;
   virtual void Free(void *ptr) = 0;
   virtual void SetContext(const AllocatorContext &ctx) {}
+  virtual AllocatorContext GetContext() { return AllocatorContext{kDefaultShiftFactor, false}; }
   virtual size_t GetTotalSize() { return 0; }
   virtual void Clear() {}
   static std::shared_ptr<Allocator> Create();
@@ -50,6 +54,7 @@ class DefaultAllocator : public Allocator {
   DefaultAllocator();
   ~DefaultAllocator() override;
   void SetContext(const AllocatorContext &ctx) override;
+  AllocatorContext GetContext() override { return AllocatorContext{shiftFactor_, lockFlag_}; }
   void *Malloc(size_t size) override;
   void Free(void *ptr) override;
   size_t GetTotalSize() override;
@@ -67,8 +72,7 @@ class DefaultAllocator : public Allocator {
   // <membuf->buf, membuf>
   std::unordered_map<void *, MemBuf *> allocatedList_;
   std::multimap<size_t, MemBuf *> freeList_;
-  // 6 is empirical value
-  int shiftFactor_ = 6;
+  int shiftFactor_ = kDefaultShiftFactor;
   bool lockFlag_ = false;
 };
 
@@ -0,0 +1,213 @@
+/**
+ * Copyright 2021 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "src/runtime/kernel/arm/base/kernel_tuner.h"
+#include <algorithm>
+#include <fstream>
+#include <limits>
+#include <sstream>
+#include <string.h>
+#include "src/common/log_adapter.h"
+#include "src/common/utils.h"
+#include "include/errorcode.h"
+
+using mindspore::lite::RET_OK;
+
+namespace mindspore::kernel {
+namespace {
+constexpr int kTuningRunTimes = 3;
+constexpr char kCacheFieldSeparator = '\t';
+}  // namespace
+
+std::string ConvTuningSignature(const std::string &op, const ConvParameter *conv_param, int thread_num) {
+  std::ostringstream oss;
+  oss << op << ":n" << conv_param->input_batch_ << "h" << conv_param->input_h_ << "w" << conv_param->input_w_ << "c"
+      << conv_param->input_channel_ << "o" << conv_param->output_channel_ << "k" << conv_param->kernel_h_ << "x"
+      << conv_param->kernel_w_ << "s" << conv_param->stride_h_ << "x" << conv_param->stride_w_ << "d"
+      << conv_param->dilation_h_ << "x" << conv_param->dilation_w_ << "p" << conv_param->pad_u_ << "_"
+      << conv_param->pad_d_ << "_" << conv_param->pad_l_ << "_" << conv_param->pad_r_ << "g" << conv_param->group_
+      << "a" << conv_param->act_type_ << "t" << thread_num;
+  return oss.str();
+}
+
+KernelTuner *KernelTuner::GetInstance() {
+  static auto *instance = new KernelTuner();
+  return instance;
+}
+
+std::string KernelTuner::CpuModel() {
+  // model name on x86, implementer and part numbers of the core on arm
+  std::ifstream cpu_info("/proc/cpuinfo");
+  if (!cpu_info.is_open()) {
+    return "unknown";
+  }
+  std::string model;
+  std::string line;
+  while (std::getline(cpu_info, line)) {
+    auto pos = line.find(':');
+    if (pos == std::string::npos || pos == 0) {
+      continue;
+    }
+    auto name = line.substr(0, line.find_last_not_of(" \t", pos - 1) + 1);
+    auto value = line.substr(std::min(line.size(), pos + 2));
+    if (name == "model name" || name == "Hardware" || name == "CPU implementer" || name == "CPU part") {
+      if (model.find(value) == std::string::npos) {
+        model += (model.empty() ? "" : " ") + value;
+      }
+    }
+  }
+  std::replace(model.begin(), model.end(), kCacheFieldSeparator, ' ');
+  return model.empty() ? "unknown" : model;
+}
+
+void KernelTuner::LoadCacheFile(const std::string &cache_file) {
+  if (cache_file.empty() || loaded_files_.find(cache_file) != loaded_files_.end()) {
+    return;
+  }
+  loaded_files_.insert(cache_file);
+  std::ifstream ifs(cache_file);
+  if (!ifs.is_open()) {
+    MS_LOG(INFO) << "Tuning cache file " << cache_file << " does not exist yet";
+    return;
+  }
+  std::string line;
+  while (std::getline(ifs, line)) {
+    auto first = line.find(kCacheFieldSeparator);
+    auto second = line.rfind(kCacheFieldSeparator);
+    if (first == std::string::npos || first == second) {
+      MS_LOG(WARNING) << "Invalid line of tuning cache file: " << line;
+      continue;
+    }
+    // the last result of a key wins
+    results_[line.substr(0, second)] = line.substr(second + 1);
+  }
+}
+
+void KernelTuner::AppendCacheFile(const std::string &cache_file, const std::string &key, const std::string &candidate) {
+  if (cache_file.empty()) {
+    return;
+  }
+  // a line is appended at once, sessions of other processes tuning the same file only add duplicated keys
+  std::ofstream ofs(cache_file, std::ios::app);
+  if (!ofs.is_open()) {
+    MS_LOG(WARNING) << "Open tuning cache file " << cache_file << " failed";
+    return;
+  }
+  ofs << key + kCacheFieldSeparator + candidate + "\n";
+}
+
+uint64_t KernelTuner::TimeCandidate(const std::string &candidate, const OpParameter *parameter, size_t parameter_size,
+                                    const KernelCreator &creator) {
+  // the kernel owns and frees its parameter
+  auto param_copy = reinterpret_cast<OpParameter *>(malloc(parameter_size));
+  if (param_copy == nullptr) {
+    MS_LOG(ERROR) << "Malloc parameter failed";
+    return 0;
+  }
+  memcpy(param_copy, parameter, parameter_size);
+  auto kernel = creator(candidate, param_copy);
+  if (kernel == nullptr) {
+    free(param_copy);
+    return 0;
+  }
+  if (kernel->Init() != RET_OK) {
+    MS_LOG(INFO) << "Init candidate " << candidate << " failed";
+    delete kernel;
+    return 0;
+  }
+  uint64_t best = std::numeric_limits<uint64_t>::max();
+  // one more run warms up the caches
+  for (int i = 0; i <= kTuningRunTimes; i++) {
+    auto start = lite::GetTimeUs();
+    if (kernel->Run() != RET_OK) {
+      MS_LOG(INFO) << "Run candidate " << candidate << " failed";
+      best = 0;
+      break;
+    }
+    if (i > 0) {
+      best = std::min(best, lite::GetTimeUs() - start);
+    }
+  }
+  delete kernel;
+  return best == 0 ? 0 : std::max<uint64_t>(best, 1);
+}
+
+std::string KernelTuner::Select(const std::string &cache_file, const std::string &signature,
+                                const std::vector<std::string> &candidates, const OpParameter *parameter,
+                                size_t parameter_size, const std::vector<lite::Tensor *> &inputs,
+                                const std::vector<lite::Tensor *> &outputs, const KernelCreator &creator) {
+  if (candidates.empty() || parameter == nullptr) {
+    return "";
+  }
+  // sessions compiled concurrently tune one at a time, timing is not disturbed by each other
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (cpu_model_.empty()) {
+    cpu_model_ = CpuModel();
+  }
+  LoadCacheFile(cache_file);
+  auto key = cpu_model_ + kCacheFieldSeparator + signature;
+  auto iter = results_.find(key);
+  if (iter != results_.end() && std::find(candidates.begin(), candidates.end(), iter->second) != candidates.end()) {
+    return iter->second;
+  }
+
+  // scratch data for the tensors without data at compile time
+  std::vector<lite::Tensor *> scratch_tensors;
+  std::vector<void *> scratch_data;
+  for (auto tensor : inputs) {
+    if (tensor->data_c() == nullptr) {
+      scratch_tensors.push_back(tensor);
+    }
+  }
+  for (auto tensor : outputs) {
+    if (tensor->data_c() == nullptr) {
+      scratch_tensors.push_back(tensor);
+    }
+  }
+  for (auto tensor : scratch_tensors) {
+    auto data = calloc(tensor->Size(), 1);
+    if (data == nullptr) {
+      MS_LOG(ERROR) << "Malloc scratch data for tuning failed, size: " << tensor->Size();
+      break;
+    }
+    scratch_data.push_back(data);
+    tensor->set_data(data);
+  }
+  std::string best_candidate;
+  uint64_t best_time = std::numeric_limits<uint64_t>::max();
+  if (scratch_data.size() == scratch_tensors.size()) {
+    for (auto &candidate : candidates) {
+      auto time = TimeCandidate(candidate, parameter, parameter_size, creator);
+      MS_LOG(INFO) << "Tuning " << signature << ", candidate " << candidate << " costs " << time << " us";
+      if (time != 0 && time < best_time) {
+        best_time = time;
+        best_candidate = candidate;
+      }
+    }
+  }
+  for (size_t i = 0; i < scratch_data.size(); i++) {
+    scratch_tensors[i]->set_data(nullptr);
+    free(scratch_data[i]);
+  }
+  if (best_candidate.empty()) {
+    MS_LOG(WARNING) << "No candidate runs for " << signature;
+    return "";
+  }
+  results_[key] = best_candidate;
+  AppendCacheFile(cache_file, key, best_candidate);
+  return best_candidate;
+}
+}  // namespace mindspore::kernel
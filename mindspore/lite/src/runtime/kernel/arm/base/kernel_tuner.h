@@ -0,0 +1,70 @@
+/**
+ * Copyright 2021 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MINDSPORE_LITE_SRC_RUNTIME_KERNEL_ARM_BASE_KERNEL_TUNER_H_
+#define MINDSPORE_LITE_SRC_RUNTIME_KERNEL_ARM_BASE_KERNEL_TUNER_H_
+
+#include <functional>
+#include <mutex>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "src/lite_kernel.h"
+#include "nnacl/conv_parameter.h"
+
+namespace mindspore::kernel {
+// Signature of a convolution node, the shapes and parameters its candidate kernels are timed for.
+std::string ConvTuningSignature(const std::string &op, const ConvParameter *conv_param, int thread_num);
+
+// Process-wide autotuner choosing among the kernels able to run a node the one which runs fastest on this cpu.
+// Results are keyed by cpu model and node signature, and kept in a cache file shared by later sessions: each line
+// holds "<cpu model>\t<signature>\t<candidate>".
+class KernelTuner {
+ public:
+  using KernelCreator = std::function<LiteKernel *(const std::string &candidate, OpParameter *parameter)>;
+
+  static KernelTuner *GetInstance();
+
+  // Return the fastest of candidates for signature, looked up in cache_file or found by creating every candidate on
+  // a copy of the parameter_size bytes parameter, and timing its Run on scratch data of inputs and outputs.
+  // Return an empty string if no candidate runs.
+  std::string Select(const std::string &cache_file, const std::string &signature,
+                     const std::vector<std::string> &candidates, const OpParameter *parameter, size_t parameter_size,
+                     const std::vector<lite::Tensor *> &inputs, const std::vector<lite::Tensor *> &outputs,
+                     const KernelCreator &creator);
+
+  static std::string CpuModel();
+
+ private:
+  KernelTuner() = default;
+  ~KernelTuner() = default;
+
+  void LoadCacheFile(const std::string &cache_file);
+  void AppendCacheFile(const std::string &cache_file, const std::string &key, const std::string &candidate);
+  // Best time of a few runs in microseconds, or 0 if the candidate fails to run.
+  uint64_t TimeCandidate(const std::string &candidate, const OpParameter *parameter, size_t parameter_size,
+                         const KernelCreator &creator);
+
+  std::mutex mutex_;
+  std::string cpu_model_;
+  // cpu model and signature -- fastest candidate
+  std::unordered_map<std::string, std::string> results_;
+  std::set<std::string> loaded_files_;
+};
+}  // namespace mindspore::kernel
+
+#endif  // MINDSPORE_LITE_SRC_RUNTIME_KERNEL_ARM_BASE_KERNEL_TUNER_H_
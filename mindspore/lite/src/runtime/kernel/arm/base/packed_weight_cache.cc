@@ -0,0 +1,166 @@
+/**
+ * Copyright 2021 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "src/runtime/kernel/arm/base/packed_weight_cache.h"
+#include <stdint.h>
+#include <string.h>
+#include <stdlib.h>
+#include "src/common/log_adapter.h"
+#include "include/errorcode.h"
+
+using mindspore::lite::RET_OK;
+
+namespace mindspore::kernel {
+std::string PackedWeightLayout(bool col_major, int tile, int batch, int row, int col) {
+  return (col_major ? "col" : "row") + std::to_string(tile) + "_" + std::to_string(batch) + "x" +
+         std::to_string(row) + "x" + std::to_string(col);
+}
+
+PackedWeightCache *PackedWeightCache::GetInstance() {
+  // never destroyed, kernels of sessions living until exit still release their buffers into it
+  static auto *instance = new PackedWeightCache();
+  return instance;
+}
+
+void *PackedWeightCache::GetOrPack(const std::string &key, size_t packed_size,
+                                   const std::function<int(void *packed)> &pack) {
+  if (!key.empty()) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto iter = entries_.find(key);
+    if (iter != entries_.end()) {
+      iter->second.ref_count++;
+      return iter->second.data;
+    }
+  }
+  // pack outside of the lock, sessions initialized concurrently pack different weights in parallel
+  auto packed = malloc(packed_size);
+  if (packed == nullptr) {
+    MS_LOG(ERROR) << "Malloc packed weight failed, size: " << packed_size;
+    return nullptr;
+  }
+  memset(packed, 0, packed_size);
+  if (pack(packed) != RET_OK) {
+    MS_LOG(ERROR) << "Pack weight failed, key: " << key;
+    free(packed);
+    return nullptr;
+  }
+  if (key.empty()) {
+    return packed;
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto iter = entries_.find(key);
+  if (iter != entries_.end()) {
+    // packed by another session meanwhile
+    free(packed);
+    iter->second.ref_count++;
+    return iter->second.data;
+  }
+  Entry entry;
+  entry.data = packed;
+  entry.size = packed_size;
+  entry.ref_count = 1;
+  entries_[key] = std::move(entry);
+  keys_[packed] = key;
+  return packed;
+}
+
+void *PackedWeightCache::GetOrPack(const lite::Tensor *weight, const std::string &layout, size_t packed_size,
+                                   const std::function<int(void *packed)> &pack) {
+  if (weight == nullptr || weight->data_c() == nullptr || packed_size == 0) {
+    MS_LOG(ERROR) << "Invalid weight to pack, layout: " << layout;
+    return nullptr;
+  }
+  std::string key;
+#ifndef SUPPORT_TRAIN
+  // trained weights are repacked in place, every kernel keeps its own copy
+  if (weight->weight_id() != 0) {
+    key = layout + "|" + std::to_string(packed_size) + "|" + std::to_string(weight->weight_id());
+  }
+#endif
+  auto prepacked = weight->packed_data();
+  if (prepacked == nullptr || weight->packed_layout() != layout || weight->packed_size() != packed_size) {
+    return GetOrPack(key, packed_size, pack);
+  }
+#ifndef SUPPORT_TRAIN
+  if (weight->packed_data_holder() != nullptr) {
+    // the mapped model file is kept alive by the entry, its packed data is used in place without copying
+    auto mapped_key = layout + "|mapped|" + std::to_string(reinterpret_cast<uintptr_t>(prepacked));
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto iter = entries_.find(mapped_key);
+    if (iter != entries_.end()) {
+      iter->second.ref_count++;
+      return iter->second.data;
+    }
+    Entry entry;
+    entry.data = const_cast<void *>(prepacked);
+    entry.size = packed_size;
+    entry.ref_count = 1;
+    entry.holder = weight->packed_data_holder();
+    entries_[mapped_key] = std::move(entry);
+    keys_[const_cast<void *>(prepacked)] = mapped_key;
+    return const_cast<void *>(prepacked);
+  }
+#endif
+  // the model buffer may be freed after compiling, the packed data is copied once into the cache
+  return GetOrPack(key, packed_size, [&](void *packed) {
+    memcpy(packed, prepacked, packed_size);
+    return RET_OK;
+  });
+}
+
+void PackedWeightCache::Release(void *packed) {
+  if (packed == nullptr) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto key_iter = keys_.find(packed);
+  if (key_iter == keys_.end()) {
+    free(packed);
+    return;
+  }
+  auto iter = entries_.find(key_iter->second);
+  if (iter == entries_.end()) {
+    MS_LOG(ERROR) << "Packed weight is not in the cache";
+    keys_.erase(key_iter);
+    free(packed);
+    return;
+  }
+  if (--iter->second.ref_count > 0) {
+    return;
+  }
+  if (iter->second.holder == nullptr) {
+    free(iter->second.data);
+  }
+  entries_.erase(iter);
+  keys_.erase(key_iter);
+}
+
+size_t PackedWeightCache::EntryNum() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return entries_.size();
+}
+
+size_t PackedWeightCache::TotalSize() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  size_t total = 0;
+  for (auto &entry : entries_) {
+    if (entry.second.holder == nullptr) {
+      total += entry.second.size;
+    }
+  }
+  return total;
+}
+}  // namespace mindspore::kernel
@@ -0,0 +1,79 @@
+/**
+ * Copyright 2021 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MINDSPORE_LITE_SRC_RUNTIME_KERNEL_ARM_BASE_PACKED_WEIGHT_CACHE_H_
+#define MINDSPORE_LITE_SRC_RUNTIME_KERNEL_ARM_BASE_PACKED_WEIGHT_CACHE_H_
+
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include "src/tensor.h"
+
+namespace mindspore::kernel {
+// Name of the layout of batch row x col row major matrices packed into column major tiles of tile rows
+// (RowMajor2Col<tile>Major) when col_major, or into row major tiles of tile columns (RowMajor2Row<tile>Major).
+// Tile 0 is the untiled layout. The converter names weights it packs offline the same way.
+std::string PackedWeightLayout(bool col_major, int tile, int batch, int row, int col);
+
+// Process-wide cache of packed constant weights. Sessions created for the same model, in the same or in different
+// threads, pack every weight once and share the packed buffer, which is reference counted and read only.
+// An entry is keyed by the packing layout and by the identity of the weight in its model (Tensor::weight_id), so
+// neither the weight bytes are hashed nor a copy of them is kept to tell weights apart.
+class PackedWeightCache {
+ public:
+  static PackedWeightCache *GetInstance();
+
+  // Return the packed_size bytes buffer holding the data of weight packed as layout, calling pack on a zeroed buffer
+  // on first use, or using the data packed offline instead when it is packed as layout. Data packed offline in a
+  // mapped model file is returned in place, other packed data is copied. A weight which is not read from a model is
+  // packed into a buffer of its own. Every returned buffer must be given back by Release. Return nullptr if malloc or
+  // pack fails.
+  void *GetOrPack(const lite::Tensor *weight, const std::string &layout, size_t packed_size,
+                  const std::function<int(void *packed)> &pack);
+
+  // Release a buffer returned by GetOrPack, a buffer not in the cache is freed.
+  void Release(void *packed);
+
+  size_t EntryNum();
+
+  // bytes of the packed buffers allocated by the cache, packed data used in place is not counted
+  size_t TotalSize();
+
+ private:
+  PackedWeightCache() = default;
+  ~PackedWeightCache() = default;
+
+  struct Entry {
+    void *data = nullptr;
+    size_t size = 0;
+    int ref_count = 0;
+    // set for packed data used in place in a mapped model file, whose data is not freed
+    std::shared_ptr<const char> holder = nullptr;
+  };
+
+  // Return the entry of key, or pack a new one. An empty key is not cached.
+  void *GetOrPack(const std::string &key, size_t packed_size, const std::function<int(void *packed)> &pack);
+
+  std::mutex mutex_;
+  std::unordered_map<std::string, Entry> entries_;
+  // packed buffer -- key of its entry
+  std::unordered_map<void *, std::string> keys_;
+};
+}  // namespace mindspore::kernel
+
+#endif  // MINDSPORE_LITE_SRC_RUNTIME_KERNEL_ARM_BASE_PACKED_WEIGHT_CACHE_H_
@@ -19,6 +19,7 @@
 #include "src/kernel_registry.h"
 #include "src/runtime/runtime_api.h"
 #include "include/errorcode.h"
+#include "nnacl/op_base.h"
 
 using mindspore::kernel::KERNEL_ARCH::kCPU;
 using mindspore::lite::KernelRegistrar;
@@ -33,6 +34,11 @@ using mindspore::schema::ActivationType_SWISH;
 using mindspore::schema::PrimitiveType_Activation;
 
 namespace mindspore::kernel {
+namespace {
+// elements of a task at least, smaller ones cost more to launch than to run
+constexpr int kMinTaskSize = 1024;
+}  // namespace
+
 int ActivationCPUKernel::Init() {
   if (type_ != schema::ActivationType_RELU && type_ != schema::ActivationType_RELU6 &&
       type_ != schema::ActivationType_LEAKY_RELU && type_ != schema::ActivationType_SIGMOID &&
@@ -52,8 +58,11 @@ int ActivationCPUKernel::DoActivation(int task_id) {
   auto output_addr = reinterpret_cast<float *>(out_tensors_.at(0)->MutableData());
   auto length = in_tensors_.at(0)->ElementsNum();
 
-  int stride = UP_DIV(length, thread_count_);
+  int stride = UP_DIV(length, task_num_);
   int count = MSMIN(stride, length - stride * task_id);
+  if (count <= 0) {
+    return RET_OK;
+  }
 
   auto ret = RET_OK;
 
@@ -96,7 +105,9 @@ int ActivationRun(void *cdata, int task_id) {
 }
 
 int ActivationCPUKernel::Run() {
-  int error_code = ParallelLaunch(this->context_->thread_pool_, ActivationRun, this, thread_count_);
+  auto length = in_tensors_.at(0)->ElementsNum();
+  task_num_ = MSMAX(MSMIN(UP_DIV(length, kMinTaskSize), thread_count_ * kTaskPerThread), 1);
+  int error_code = ParallelLaunch(this->context_->thread_pool_, ActivationRun, this, task_num_);
   if (error_code != RET_OK) {
     MS_LOG(ERROR) << "Activation function error error_code[" << error_code << "]";
     return RET_ERROR;
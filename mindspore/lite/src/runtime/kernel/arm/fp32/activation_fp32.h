@@ -42,6 +42,8 @@ class ActivationCPUKernel : public LiteKernel {
 
  private:
   int thread_count_;
+  // more tasks than threads for large inputs
+  int task_num_ = 1;
   int type_;
   float alpha_;
   float min_val_;
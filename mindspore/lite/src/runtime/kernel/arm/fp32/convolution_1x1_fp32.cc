@@ -16,6 +16,7 @@
 
 #include "src/runtime/kernel/arm/fp32/convolution_1x1_fp32.h"
 #include "src/runtime/runtime_api.h"
+#include "src/runtime/kernel/arm/base/packed_weight_cache.h"
 
 using mindspore::lite::RET_ERROR;
 using mindspore::lite::RET_MEMORY_FAILED;
@@ -25,7 +26,7 @@ namespace mindspore::kernel {
 Convolution1x1CPUKernel::~Convolution1x1CPUKernel() {
   FreeTmpBuffer();
   if (weight_ptr_ != nullptr) {
-    free(weight_ptr_);
+    PackedWeightCache::GetInstance()->Release(weight_ptr_);
     weight_ptr_ = nullptr;
   }
   if (matmul_param_ != nullptr) {
@@ -90,20 +91,21 @@ int Convolution1x1CPUKernel::InitConv1x1BiasWeight() {
   }
 
   int size = input_channel * UP_ROUND(output_channel, col_tile) * sizeof(float);
-  int down_size = input_channel * DOWN_DIV(output_channel, col_tile) * col_tile * sizeof(float);
-  weight_ptr_ = reinterpret_cast<float *>(malloc(size));
+  auto origin_weight = reinterpret_cast<float *>(filter_tensor->MutableData());
+  auto layout = PackedWeightLayout(true, col_tile, 1, output_channel, input_channel);
+  weight_ptr_ = reinterpret_cast<float *>(
+    PackedWeightCache::GetInstance()->GetOrPack(filter_tensor, layout, size, [&](void *packed) {
+#ifdef ENABLE_AVX
+      RowMajor2Col16Major(origin_weight, reinterpret_cast<float *>(packed), output_channel, input_channel);
+#else
+      RowMajor2Col8Major(origin_weight, reinterpret_cast<float *>(packed), output_channel, input_channel);
+#endif
+      return RET_OK;
+    }));
   if (weight_ptr_ == nullptr) {
     MS_LOG(ERROR) << "Conv1x1 Malloc weight_ptr_ error!";
     return RET_ERROR;
   }
-  memset(reinterpret_cast<char *>(weight_ptr_) + down_size, 0, size - down_size);
-#ifdef ENABLE_AVX
-  RowMajor2Col16Major(reinterpret_cast<float *>(filter_tensor->MutableData()), weight_ptr_, output_channel,
-                      input_channel);
-#else
-  RowMajor2Col8Major(reinterpret_cast<float *>(filter_tensor->MutableData()), weight_ptr_, output_channel,
-                     input_channel);
-#endif
   return RET_OK;
 }
 
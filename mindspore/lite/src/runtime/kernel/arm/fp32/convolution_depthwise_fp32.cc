@@ -22,6 +22,7 @@
 #include "include/errorcode.h"
 #include "src/runtime/runtime_api.h"
 #include "src/runtime/kernel/arm/base/dequant.h"
+#include "src/runtime/kernel/arm/base/kernel_tuner.h"
 
 using mindspore::kernel::KERNEL_ARCH::kCPU;
 using mindspore::lite::KernelRegistrar;
@@ -119,6 +120,39 @@ int ConvolutionDepthwiseCPUKernel::Run() {
   return RET_OK;
 }
 
+kernel::LiteKernel *CpuConvDwFp32KernelTune(const std::vector<lite::Tensor *> &inputs,
+                                            const std::vector<lite::Tensor *> &outputs, OpParameter *op_parameter,
+                                            const InnerContext *ctx, const mindspore::lite::PrimitiveC *primitive) {
+  auto conv_param = reinterpret_cast<ConvParameter *>(op_parameter);
+  std::vector<std::string> candidates = {"generic", "sliding_window"};
+#ifdef ENABLE_ARM64
+  if (CheckConvDwUseIndirectBuffer(conv_param)) {
+    candidates.emplace_back("indirect");
+  }
+#endif
+  auto creator = [&](const std::string &candidate, OpParameter *parameter) -> kernel::LiteKernel * {
+    if (candidate == "sliding_window") {
+      return new (std::nothrow) kernel::ConvolutionDepthwiseSWCPUKernel(parameter, inputs, outputs, ctx, primitive);
+#ifdef ENABLE_ARM64
+    } else if (candidate == "indirect") {
+      return new (std::nothrow)
+        kernel::ConvolutionDepthwiseIndirectCPUKernel(parameter, inputs, outputs, ctx, primitive);
+#endif
+    }
+    return new (std::nothrow) kernel::ConvolutionDepthwiseCPUKernel(parameter, inputs, outputs, ctx, primitive);
+  };
+  conv_param->input_batch_ = inputs[kInputIndex]->Batch();
+  conv_param->output_channel_ = outputs[kOutputIndex]->Channel();
+  auto signature = ConvTuningSignature("DepthwiseConv2D_fp32", conv_param, ctx->thread_num_);
+  auto candidate = KernelTuner::GetInstance()->Select(ctx->tuning_cache_file_, signature, candidates, op_parameter,
+                                                      sizeof(ConvParameter), inputs, outputs, creator);
+  if (candidate.empty()) {
+    return nullptr;
+  }
+  MS_LOG(DEBUG) << "Run " << conv_param->op_parameter_.name_ << " with tuned kernel " << candidate;
+  return creator(candidate, op_parameter);
+}
+
 kernel::LiteKernel *CpuConvDwFp32KernelCreator(const std::vector<lite::Tensor *> &inputs,
                                                const std::vector<lite::Tensor *> &outputs, OpParameter *opParameter,
                                                const InnerContext *ctx, const kernel::KernelKey &desc,
@@ -147,8 +181,11 @@ kernel::LiteKernel *CpuConvDwFp32KernelCreator(const std::vector<lite::Tensor *>
     conv_param->input_channel_ = inputs[kInputIndex]->Channel();
     conv_param->output_h_ = outputs[kOutputIndex]->Height();
     conv_param->output_w_ = outputs[kOutputIndex]->Width();
+    if (ctx->enable_tuning_) {
+      kernel = CpuConvDwFp32KernelTune(inputs, outputs, opParameter, ctx, primitive);
+    }
 #ifdef ENABLE_ARM64
-    if (CheckConvDwUseIndirectBuffer(conv_param)) {
+    if (kernel == nullptr && CheckConvDwUseIndirectBuffer(conv_param)) {
       kernel =
         new (std::nothrow) kernel::ConvolutionDepthwiseIndirectCPUKernel(opParameter, inputs, outputs, ctx, primitive);
     }
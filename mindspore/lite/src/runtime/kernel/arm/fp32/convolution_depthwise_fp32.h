@@ -43,6 +43,11 @@ class ConvolutionDepthwiseCPUKernel : public ConvolutionBaseCPUKernel {
   float *input_ptr_ = nullptr;
   float *output_ptr_ = nullptr;
 };
+
+// Time the depthwise kernels able to run the node and create the fastest one, nullptr if none of them runs.
+kernel::LiteKernel *CpuConvDwFp32KernelTune(const std::vector<lite::Tensor *> &inputs,
+                                            const std::vector<lite::Tensor *> &outputs, OpParameter *op_parameter,
+                                            const lite::InnerContext *ctx, const mindspore::lite::PrimitiveC *primitive);
 }  // namespace mindspore::kernel
 
 #endif  // MINDSPORE_LITE_SRC_RUNTIME_KERNEL_ARM_FP32_CONVOLUTION_DEPTHWISE_H_
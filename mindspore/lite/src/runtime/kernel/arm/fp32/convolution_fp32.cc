@@ -25,6 +25,8 @@
 #include "include/errorcode.h"
 #include "src/runtime/runtime_api.h"
 #include "src/runtime/kernel/arm/base/dequant.h"
+#include "src/runtime/kernel/arm/base/packed_weight_cache.h"
+#include "src/runtime/kernel/arm/base/kernel_tuner.h"
 
 using mindspore::kernel::KERNEL_ARCH::kCPU;
 using mindspore::lite::KernelRegistrar;
@@ -51,17 +53,20 @@ int ConvolutionCPUKernel::InitWeightBias() {
   int pack_weight_size = oc_block_num * in_channel * kernel_plane;
 
   auto origin_weight = reinterpret_cast<float *>(filter_tensor->data_c());
-  packed_weight_ = reinterpret_cast<float *>(malloc(pack_weight_size * sizeof(float)));
+  auto layout = PackedWeightLayout(true, oc_block, 1, out_channel, in_channel * kernel_plane);
+  packed_weight_ = reinterpret_cast<float *>(PackedWeightCache::GetInstance()->GetOrPack(
+    filter_tensor, layout, pack_weight_size * sizeof(float), [&](void *packed) {
+#ifdef ENABLE_AVX
+      RowMajor2Col16Major(origin_weight, reinterpret_cast<float *>(packed), out_channel, in_channel * kernel_plane);
+#else
+      RowMajor2Col8Major(origin_weight, reinterpret_cast<float *>(packed), out_channel, in_channel * kernel_plane);
+#endif
+      return RET_OK;
+    }));
   if (packed_weight_ == nullptr) {
     MS_LOG(ERROR) << "malloc packed weight failed.";
     return RET_ERROR;
   }
-  memset(packed_weight_, 0, pack_weight_size * sizeof(float));
-#ifdef ENABLE_AVX
-  RowMajor2Col16Major(origin_weight, packed_weight_, out_channel, in_channel * kernel_plane);
-#else
-  RowMajor2Col8Major(origin_weight, packed_weight_, out_channel, in_channel * kernel_plane);
-#endif
 
   bias_data_ = reinterpret_cast<float *>(malloc(oc_block_num * sizeof(float)));
   if (bias_data_ == nullptr) {
@@ -269,11 +274,53 @@ lite::Tensor *CreateOutputTensor(std::vector<int> out_shape, const std::vector<l
   return out_tensor;
 }
 
+kernel::LiteKernel *CpuConvFp32KernelTune(const std::vector<lite::Tensor *> &inputs,
+                                          const std::vector<lite::Tensor *> &outputs, OpParameter *op_parameter,
+                                          const InnerContext *ctx, const mindspore::lite::PrimitiveC *primitive,
+                                          bool use_winograd, int out_unit) {
+  auto conv_param = reinterpret_cast<ConvParameter *>(op_parameter);
+  // im2col runs every convolution
+  std::vector<std::string> candidates = {"im2col"};
+  if (conv_param->kernel_h_ == 1 && conv_param->kernel_w_ == 1) {
+    candidates.emplace_back("1x1");
+  }
+  if (use_winograd) {
+    candidates.emplace_back("winograd");
+  }
+  if (candidates.size() == 1) {
+    return nullptr;
+  }
+  auto creator = [&](const std::string &candidate, OpParameter *parameter) -> kernel::LiteKernel * {
+    if (candidate == "1x1") {
+      return new (std::nothrow) kernel::Convolution1x1CPUKernel(parameter, inputs, outputs, ctx, primitive);
+    } else if (candidate == "winograd") {
+      return new (std::nothrow)
+        kernel::ConvolutionWinogradCPUKernel(parameter, inputs, outputs, ctx, primitive, out_unit);
+    }
+    return new (std::nothrow) kernel::ConvolutionCPUKernel(parameter, inputs, outputs, ctx, primitive);
+  };
+  conv_param->input_batch_ = inputs.front()->Batch();
+  auto signature = ConvTuningSignature("Conv2D_fp32", conv_param, ctx->thread_num_);
+  auto candidate = KernelTuner::GetInstance()->Select(ctx->tuning_cache_file_, signature, candidates, op_parameter,
+                                                      sizeof(ConvParameter), inputs, outputs, creator);
+  if (candidate.empty()) {
+    return nullptr;
+  }
+  MS_LOG(DEBUG) << "Run " << conv_param->op_parameter_.name_ << " with tuned kernel " << candidate;
+  return creator(candidate, op_parameter);
+}
+
 kernel::LiteKernel *CpuConvFp32KernelSelect(const std::vector<lite::Tensor *> &inputs,
                                             const std::vector<lite::Tensor *> &outputs, OpParameter *op_parameter,
                                             const InnerContext *ctx, const mindspore::lite::PrimitiveC *primitive,
                                             bool use_winograd, int out_unit) {
   auto conv_param = reinterpret_cast<ConvParameter *>(op_parameter);
+  if (ctx->enable_tuning_ && primitive != nullptr && primitive->infer_flag()) {
+    auto kernel = CpuConvFp32KernelTune(inputs, outputs, op_parameter, ctx, primitive, use_winograd, out_unit);
+    if (kernel != nullptr) {
+      return kernel;
+    }
+  }
   if (conv_param->kernel_h_ == 1 && conv_param->kernel_w_ == 1) {
     return new (std::nothrow) kernel::Convolution1x1CPUKernel(op_parameter, inputs, outputs, ctx, primitive);
   } else if (use_winograd) {
@@ -21,6 +21,7 @@
 #include "src/lite_kernel.h"
 #include "nnacl/op_base.h"
 #include "src/runtime/kernel/arm/base/convolution_base.h"
+#include "src/runtime/kernel/arm/base/packed_weight_cache.h"
 #include "nnacl/fp32/conv_fp32.h"
 
 namespace mindspore::kernel {
@@ -32,7 +33,7 @@ class ConvolutionCPUKernel : public ConvolutionBaseCPUKernel {
       : ConvolutionBaseCPUKernel(parameter, inputs, outputs, ctx, primitive) {}
   ~ConvolutionCPUKernel() override {
     if (packed_weight_ != nullptr) {
-      free(packed_weight_);
+      PackedWeightCache::GetInstance()->Release(packed_weight_);
       packed_weight_ = nullptr;
     }
   }
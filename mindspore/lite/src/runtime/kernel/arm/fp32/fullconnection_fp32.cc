@@ -15,7 +15,9 @@
  */
 
 #include "src/runtime/kernel/arm/fp32/fullconnection_fp32.h"
+#include <string>
 #include "src/runtime/runtime_api.h"
+#include "src/runtime/kernel/arm/base/packed_weight_cache.h"
 using mindspore::lite::RET_ERROR;
 using mindspore::lite::RET_MEMORY_FAILED;
 using mindspore::lite::RET_OK;
@@ -32,7 +34,7 @@ void FullconnectionCPUKernel::FreeBuf() {
     a_pack_ptr_ = nullptr;
   }
   if (b_pack_ptr_ != nullptr) {
-    free(b_pack_ptr_);
+    PackedWeightCache::GetInstance()->Release(b_pack_ptr_);
     b_pack_ptr_ = nullptr;
   }
   if (bias_ptr_ != nullptr) {
@@ -94,22 +96,35 @@ int FullconnectionCPUKernel::ReSize() {
   }
   memset(a_pack_ptr_, 0, row_tmp * fc_param_->deep_ * sizeof(float));
 
+  fc_param_->a_const_ = (in_tensors_.at(0)->data_c() != nullptr);
+  fc_param_->b_const_ = (in_tensors_.at(1)->data_c() != nullptr);
   int col_tmp = is_vector_input_ ? fc_param_->col_ : fc_param_->col_8_;
-  b_pack_ptr_ = reinterpret_cast<float *>(malloc(col_tmp * fc_param_->deep_ * sizeof(float)));
+  if (fc_param_->b_const_) {
+    // constant weight is packed once per process and shared by the kernels of all sessions
+    auto b_src = reinterpret_cast<float *>(in_tensors_.at(1)->MutableData());
+    auto layout = is_vector_input_ ? PackedWeightLayout(false, 0, 1, fc_param_->col_, fc_param_->deep_)
+                                   : PackedWeightLayout(true, col_tile, 1, fc_param_->col_, fc_param_->deep_);
+    b_pack_ptr_ = reinterpret_cast<float *>(PackedWeightCache::GetInstance()->GetOrPack(
+      in_tensors_.at(1), layout, col_tmp * fc_param_->deep_ * sizeof(float), [&](void *packed) {
+        InitMatrixB(b_src, reinterpret_cast<float *>(packed));
+        return RET_OK;
+      }));
+  } else {
+    b_pack_ptr_ = reinterpret_cast<float *>(malloc(col_tmp * fc_param_->deep_ * sizeof(float)));
+    if (b_pack_ptr_ != nullptr) {
+      memset(b_pack_ptr_, 0, col_tmp * fc_param_->deep_ * sizeof(float));
+    }
+  }
   if (b_pack_ptr_ == nullptr) {
     FreeBuf();
     return RET_MEMORY_FAILED;
   }
-  memset(b_pack_ptr_, 0, col_tmp * fc_param_->deep_ * sizeof(float));
 
-  fc_param_->a_const_ = (in_tensors_.at(0)->data_c() != nullptr);
-  fc_param_->b_const_ = (in_tensors_.at(1)->data_c() != nullptr);
   if (fc_param_->a_const_) {
     InitMatrixA(reinterpret_cast<float *>(in_tensors_.at(0)->MutableData()), a_pack_ptr_);
     a_ptr_ = a_pack_ptr_;
   }
   if (fc_param_->b_const_) {
-    InitMatrixB(reinterpret_cast<float *>(in_tensors_.at(1)->MutableData()), b_pack_ptr_);
     b_ptr_ = b_pack_ptr_;
   }
   return RET_OK;
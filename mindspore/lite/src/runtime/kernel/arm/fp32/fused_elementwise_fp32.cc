@@ -0,0 +1,169 @@
+/**
+ * Copyright 2021 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "src/runtime/kernel/arm/fp32/fused_elementwise_fp32.h"
+#include "schema/model_generated.h"
+#include "src/kernel_registry.h"
+#include "src/runtime/runtime_api.h"
+#include "include/errorcode.h"
+#include "nnacl/op_base.h"
+
+using mindspore::kernel::KERNEL_ARCH::kCPU;
+using mindspore::lite::KernelRegistrar;
+using mindspore::lite::RET_ERROR;
+using mindspore::lite::RET_OK;
+using mindspore::schema::PrimitiveType_FusedElementwise;
+
+namespace mindspore::kernel {
+int FusedElementwiseCPUKernel::Init() {
+  for (int i = 0; i < param_->step_num_; ++i) {
+    if (param_->ops_[i] < 0 || param_->ops_[i] >= FusedElementwise_OpNum) {
+      MS_LOG(ERROR) << "FusedElementwise not support op type: " << param_->ops_[i];
+      return RET_ERROR;
+    }
+    if (FusedElementwiseIsBinary(param_->ops_[i]) &&
+        (param_->operand_index_[i] < 0 || param_->operand_index_[i] >= static_cast<int>(in_tensors_.size()))) {
+      MS_LOG(ERROR) << "FusedElementwise step " << i << " operand index " << param_->operand_index_[i]
+                    << " out of range, input num: " << in_tensors_.size();
+      return RET_ERROR;
+    }
+  }
+  if (!InferShapeDone()) {
+    return RET_OK;
+  }
+  return ReSize();
+}
+
+int FusedElementwiseCPUKernel::ReSize() {
+  auto input = in_tensors_.at(0);
+  element_num_ = input->ElementsNum();
+  int channel = input->shape().empty() ? 1 : input->shape().back();
+  operand_mode_.assign(param_->step_num_, kOperandFull);
+  bool per_channel = false;
+  for (int i = 0; i < param_->step_num_; ++i) {
+    if (!FusedElementwiseIsBinary(param_->ops_[i])) {
+      continue;
+    }
+    auto operand = in_tensors_.at(param_->operand_index_[i]);
+    if (operand->ElementsNum() == element_num_) {
+      operand_mode_[i] = kOperandFull;
+    } else if (operand->ElementsNum() == 1) {
+      operand_mode_[i] = kOperandScalar;
+    } else if (operand->ElementsNum() == channel && !operand->shape().empty() && operand->shape().back() == channel) {
+      operand_mode_[i] = kOperandChannel;
+      per_channel = true;
+    } else {
+      MS_LOG(ERROR) << "FusedElementwise step " << i << " operand of " << operand->ElementsNum()
+                    << " elements does not broadcast to " << element_num_ << " elements";
+      return RET_ERROR;
+    }
+  }
+  // a tile starts at a channel boundary, so a per channel operand repeats the same way in every tile
+  tile_ = per_channel ? MSMAX(FUSED_ELEMENTWISE_TILE / channel, 1) * channel : FUSED_ELEMENTWISE_TILE;
+  repeated_operands_.assign(param_->step_num_, std::vector<float>());
+  for (int i = 0; i < param_->step_num_; ++i) {
+    repeated_[i] = operand_mode_[i] != kOperandFull;
+    if (repeated_[i]) {
+      repeated_operands_[i].resize(tile_);
+    }
+  }
+  task_num_ = MSMAX(MSMIN(UP_DIV(element_num_, tile_), thread_count_ * kTaskPerThread), 1);
+  buffer_.resize(static_cast<size_t>(tile_) * task_num_);
+  return RET_OK;
+}
+
+void FusedElementwiseCPUKernel::FillRepeatedOperands() {
+  for (int i = 0; i < param_->step_num_; ++i) {
+    if (!FusedElementwiseIsBinary(param_->ops_[i])) {
+      continue;
+    }
+    auto operand = reinterpret_cast<const float *>(in_tensors_.at(param_->operand_index_[i])->MutableData());
+    if (operand_mode_[i] == kOperandFull) {
+      operands_[i] = operand;
+      continue;
+    }
+    auto &repeated = repeated_operands_[i];
+    int size = operand_mode_[i] == kOperandScalar ? 1 : in_tensors_.at(param_->operand_index_[i])->ElementsNum();
+    for (int j = 0; j < tile_; ++j) {
+      repeated[j] = operand[j % size];
+    }
+    operands_[i] = repeated.data();
+  }
+}
+
+int FusedElementwiseCPUKernel::DoFusedElementwise(int task_id) {
+  auto input = reinterpret_cast<const float *>(in_tensors_.at(0)->MutableData());
+  auto output = reinterpret_cast<float *>(out_tensors_.at(0)->MutableData());
+  int tile_num = UP_DIV(element_num_, tile_);
+  int stride = UP_DIV(tile_num, task_num_) * tile_;
+  int offset = stride * task_id;
+  int count = MSMIN(stride, element_num_ - offset);
+  if (count <= 0) {
+    return RET_OK;
+  }
+  auto buffer = buffer_.data() + static_cast<size_t>(tile_) * task_id;
+  auto ret = FusedElementwise(input, output, operands_, repeated_, buffer, offset, count, tile_, param_);
+  if (ret != RET_OK) {
+    MS_LOG(ERROR) << "FusedElementwise error, ret: " << ret;
+  }
+  return ret;
+}
+
+int FusedElementwiseRun(void *cdata, int task_id) {
+  auto kernel = reinterpret_cast<FusedElementwiseCPUKernel *>(cdata);
+  auto error_code = kernel->DoFusedElementwise(task_id);
+  if (error_code != RET_OK) {
+    MS_LOG(ERROR) << "FusedElementwiseRun error task_id[" << task_id << "] error_code[" << error_code << "]";
+    return RET_ERROR;
+  }
+  return RET_OK;
+}
+
+int FusedElementwiseCPUKernel::Run() {
+  FillRepeatedOperands();
+  int error_code = ParallelLaunch(this->context_->thread_pool_, FusedElementwiseRun, this, task_num_);
+  if (error_code != RET_OK) {
+    MS_LOG(ERROR) << "FusedElementwise function error error_code[" << error_code << "]";
+    return RET_ERROR;
+  }
+  return RET_OK;
+}
+
+kernel::LiteKernel *CpuFusedElementwiseFp32KernelCreator(const std::vector<lite::Tensor *> &inputs,
+                                                         const std::vector<lite::Tensor *> &outputs,
+                                                         OpParameter *opParameter, const lite::InnerContext *ctx,
+                                                         const kernel::KernelKey &desc,
+                                                         const mindspore::lite::PrimitiveC *primitive) {
+  MS_ASSERT(opParameter != nullptr);
+  MS_ASSERT(desc.type == schema::PrimitiveType_FusedElementwise);
+  auto *kernel = new (std::nothrow) FusedElementwiseCPUKernel(opParameter, inputs, outputs, ctx, primitive);
+  if (kernel == nullptr) {
+    MS_LOG(ERROR) << "kernel is nullptr.";
+    free(opParameter);
+    return nullptr;
+  }
+  auto ret = kernel->Init();
+  if (ret != RET_OK) {
+    MS_LOG(ERROR) << "Init kernel failed, name: " << opParameter->name_ << ", type: "
+                  << schema::EnumNamePrimitiveType(static_cast<schema::PrimitiveType>(opParameter->type_));
+    delete kernel;
+    return nullptr;
+  }
+  return kernel;
+}
+
+REG_KERNEL(kCPU, kNumberTypeFloat32, PrimitiveType_FusedElementwise, CpuFusedElementwiseFp32KernelCreator)
+}  // namespace mindspore::kernel
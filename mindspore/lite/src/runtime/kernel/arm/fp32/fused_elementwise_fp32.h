@@ -0,0 +1,63 @@
+/**
+ * Copyright 2021 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MINDSPORE_LITE_SRC_RUNTIME_KERNEL_ARM_FP32_FUSED_ELEMENTWISE_H_
+#define MINDSPORE_LITE_SRC_RUNTIME_KERNEL_ARM_FP32_FUSED_ELEMENTWISE_H_
+
+#include <vector>
+#include "src/lite_kernel.h"
+#include "nnacl/fp32/fused_elementwise_fp32.h"
+
+namespace mindspore::kernel {
+// Runs a chain of elementwise ops fused by the converter tile by tile, so the intermediate results stay in cache
+// instead of going through a tensor each.
+class FusedElementwiseCPUKernel : public LiteKernel {
+ public:
+  FusedElementwiseCPUKernel(OpParameter *param, const std::vector<lite::Tensor *> &inputs,
+                            const std::vector<lite::Tensor *> &outputs, const lite::InnerContext *ctx,
+                            const mindspore::lite::PrimitiveC *primitive)
+      : LiteKernel(param, inputs, outputs, ctx, primitive), thread_count_(ctx->thread_num_) {
+    param_ = reinterpret_cast<FusedElementwiseParameter *>(param);
+  }
+  ~FusedElementwiseCPUKernel() override = default;
+
+  int Init() override;
+  int ReSize() override;
+  int Run() override;
+  int DoFusedElementwise(int task_id);
+
+ private:
+  enum OperandMode { kOperandFull, kOperandScalar, kOperandChannel };
+
+  void FillRepeatedOperands();
+
+  FusedElementwiseParameter *param_ = nullptr;
+  int thread_count_;
+  // a few tiles per task, more tasks than threads
+  int task_num_ = 1;
+  int element_num_ = 0;
+  int tile_ = FUSED_ELEMENTWISE_TILE;
+  std::vector<OperandMode> operand_mode_;
+  // tile elements of the scalar and per channel operands, repeated over the tiles
+  std::vector<std::vector<float>> repeated_operands_;
+  const float *operands_[MAX_FUSED_ELEMENTWISE_STEP] = {nullptr};
+  bool repeated_[MAX_FUSED_ELEMENTWISE_STEP] = {false};
+  // tile floats of scratch per task
+  std::vector<float> buffer_;
+};
+}  // namespace mindspore::kernel
+
+#endif  // MINDSPORE_LITE_SRC_RUNTIME_KERNEL_ARM_FP32_FUSED_ELEMENTWISE_H_
@@ -15,11 +15,13 @@
  */
 
 #include "src/runtime/kernel/arm/fp32/matmul_fp32.h"
+#include <string>
 #include "include/errorcode.h"
 #include "nnacl/fp32/matmul_fp32.h"
 #include "src/runtime/runtime_api.h"
 #include "src/kernel_registry.h"
 #include "src/runtime/kernel/arm/base/dequant.h"
+#include "src/runtime/kernel/arm/base/packed_weight_cache.h"
 
 using mindspore::lite::RET_ERROR;
 using mindspore::lite::RET_INPUT_TENSOR_ERROR;
@@ -37,7 +39,7 @@ MatmulCPUKernel::~MatmulCPUKernel() {
     a_pack_ptr_ = nullptr;
   }
   if (b_pack_ptr_ != nullptr) {
-    free(b_pack_ptr_);
+    PackedWeightCache::GetInstance()->Release(b_pack_ptr_);
     b_pack_ptr_ = nullptr;
   }
   if (bias_ptr_ != nullptr) {
@@ -52,7 +54,8 @@ void MatmulCPUKernel::FreeTmpBuffer() {
     a_pack_ptr_ = nullptr;
   }
   if (b_pack_ptr_ != nullptr) {
-    params_->b_const_ ? free(b_pack_ptr_) : context_->allocator->Free(b_pack_ptr_);
+    params_->b_const_ ? PackedWeightCache::GetInstance()->Release(b_pack_ptr_)
+                      : context_->allocator->Free(b_pack_ptr_);
     b_pack_ptr_ = nullptr;
   }
 }
@@ -121,7 +124,19 @@ int MatmulCPUKernel::MallocMatrixBBuffer() {
 
   int col_tmp = is_vector_a_ ? params_->col_ : params_->col_8_;
   if (params_->b_const_) {
-    b_pack_ptr_ = reinterpret_cast<float *>(malloc(params_->batch * col_tmp * params_->deep_ * sizeof(float)));
+    // constant matrix B is packed once per process and shared by the kernels of all sessions, the layout follows
+    // InitMatrixB
+    auto b_src = reinterpret_cast<float *>(in_tensors_.at(1)->data_c());
+    int tile = is_vector_a_ ? 0 : col_tile;
+    auto layout = params_->b_transpose_
+                    ? PackedWeightLayout(!is_vector_a_, tile, params_->batch, params_->col_, params_->deep_)
+                    : PackedWeightLayout(is_vector_a_, tile, params_->batch, params_->deep_, params_->col_);
+    b_pack_ptr_ = reinterpret_cast<float *>(PackedWeightCache::GetInstance()->GetOrPack(
+      in_tensors_.at(1), layout, params_->batch * col_tmp * params_->deep_ * sizeof(float),
+      [&](void *packed) {
+        InitMatrixB(b_src, reinterpret_cast<float *>(packed));
+        return RET_OK;
+      }));
   } else {
     b_pack_ptr_ =
       reinterpret_cast<float *>(context_->allocator->Malloc(params_->batch * col_tmp * params_->deep_ * sizeof(float)));
@@ -262,7 +277,6 @@ int MatmulCPUKernel::Init() {
       MS_LOG(ERROR) << "Matmul fp32 malloc matrix B buffer failed";
       return RET_ERROR;
     }
-    InitMatrixB(reinterpret_cast<float *>(in_tensors_.at(1)->data_c()), b_pack_ptr_);
     b_ptr_ = b_pack_ptr_;
     // init bias
     ret = InitBias();
@@ -332,7 +346,8 @@ int MatmulCPUKernel::Run() {
   }
   if (!params_->b_const_ || IsTrain()) {
     if (b_pack_ptr_ != nullptr) {
-      params_->b_const_ ? free(b_pack_ptr_) : context_->allocator->Free(b_pack_ptr_);
+      params_->b_const_ ? PackedWeightCache::GetInstance()->Release(b_pack_ptr_)
+                      : context_->allocator->Free(b_pack_ptr_);
       b_pack_ptr_ = nullptr;
     }
     auto ret = MallocMatrixBBuffer();
@@ -378,7 +393,8 @@ int MatmulCPUKernel::Run() {
     a_pack_ptr_ = nullptr;
   }
   if (!params_->b_const_ || IsTrain()) {
-    params_->b_const_ ? free(b_pack_ptr_) : context_->allocator->Free(b_pack_ptr_);
+    params_->b_const_ ? PackedWeightCache::GetInstance()->Release(b_pack_ptr_)
+                      : context_->allocator->Free(b_pack_ptr_);
     b_pack_ptr_ = nullptr;
   }
   return RET_OK;
@@ -13,100 +13,272 @@
  * See the License for the specific language governing permissions and
  * limitations under the License.
  */
-
+#include <algorithm>
 #include <utility>
 #include "src/runtime/parallel_executor.h"
 #include "src/runtime/runtime_api.h"
 
-#define MAX_THREAD_NUM 8
 namespace mindspore::lite {
-ParallelExecutor::~ParallelExecutor() { DestroyThreadPool(thread_pool_); }
 int ParallelExecutor::Prepare(const std::vector<mindspore::kernel::LiteKernel *> &kernels) {
-  thread_pool_ = CreateLiteThreadPool(MAX_THREAD_NUM, NO_BIND);
-  if (thread_pool_ == nullptr) {
-    MS_LOG(ERROR) << "Memory error: fail to new ThreadPool";
+  if (kernels.empty()) {
+    return RET_OK;
+  }
+  auto context = kernels.front()->context();
+  if (context == nullptr || context->thread_pool_ == nullptr) {
+    MS_LOG(ERROR) << "Thread pool of context is nullptr";
     return RET_ERROR;
   }
+  // share the thread pool, and so the thread number and bind mode, of the session
+  thread_pool_ = context->thread_pool_;
+  worker_num_ = std::max(1, std::min(context->thread_num_, static_cast<int>(kernels.size())));
+  queues_.clear();
+  for (int i = 0; i < worker_num_; i++) {
+    queues_.emplace_back(std::make_unique<WorkerQueue>());
+  }
+  InitTopology(kernels);
   return RET_OK;
 }
 
-static int RunKernel(void *data, int index) {
-  auto *executor = reinterpret_cast<ParallelExecutor *>(data);
-  auto kernel = executor->GetReadyKernel(index);
-  auto ret = kernel->Run();
-  executor->SetResult(index, ret);
-  if (0 != ret) {
-    MS_LOG(ERROR) << "run kernel failed, name: " << kernel->name();
-    return 0;
+void ParallelExecutor::InitTopology(const std::vector<kernel::LiteKernel *> &kernels) {
+  kernels_ = kernels;
+  std::unordered_map<kernel::LiteKernel *, size_t> kernel_index;
+  for (size_t i = 0; i < kernels.size(); i++) {
+    kernel_index[kernels[i]] = i;
   }
+  in_degree_.assign(kernels.size(), 0);
+  successors_.assign(kernels.size(), {});
+  for (size_t i = 0; i < kernels.size(); i++) {
+    for (auto out : kernels[i]->out_kernels()) {
+      auto iter = kernel_index.find(out);
+      if (iter == kernel_index.end() || IsContain(successors_[i], iter->second)) {
+        continue;
+      }
+      successors_[i].push_back(iter->second);
+      in_degree_[iter->second]++;
+    }
+  }
+  ref_count_.reset(new std::atomic<size_t>[kernels.size()]);
+}
 
-  ret = kernel->FreeInWorkTensor();
-  if (RET_OK != ret) {
-    MS_LOG(ERROR) << "FreeInWorkTensor failed, name: " << kernel->name();
-    return ret;
+void ParallelExecutor::PushReadyKernel(int worker_id, size_t index) {
+  {
+    auto &queue = queues_.at(worker_id);
+    std::lock_guard<std::mutex> lock(queue->mutex);
+    queue->kernels.push_back(index);
   }
-  return 0;
+  {
+    std::lock_guard<std::mutex> lock(wait_mutex_);
+    ready_num_++;
+  }
+  wait_cond_.notify_all();
 }
 
-int ParallelExecutor::Run(std::vector<Tensor *> &in_tensors, std::vector<Tensor *> &out_tensors,
-                          std::vector<kernel::LiteKernel *> &kernels, Allocator *allocator,
-                          const KernelCallBack &before, const KernelCallBack &after) {
-  MS_ASSERT(nullptr != allocator);
-  for (auto &inTensor : in_tensors) {
-    if (inTensor == nullptr) {
-      MS_LOG(ERROR) << "Graph input tensor is nullptr";
-      return RET_ERROR;
+bool ParallelExecutor::PopReadyKernel(int worker_id, size_t *index) {
+  bool popped = false;
+  // the newest kernel of the own queue is likely to find its inputs in cache
+  {
+    auto &queue = queues_.at(worker_id);
+    std::lock_guard<std::mutex> lock(queue->mutex);
+    if (!queue->kernels.empty()) {
+      *index = queue->kernels.back();
+      queue->kernels.pop_back();
+      popped = true;
     }
-    if (inTensor->format() != schema::Format::Format_NHWC) {
-      MS_LOG(ERROR) << "Model input tensor should be NHWC";
-      return RET_ERROR;
+  }
+  for (int i = 1; !popped && i < worker_num_; i++) {
+    auto &queue = queues_.at((worker_id + i) % worker_num_);
+    std::lock_guard<std::mutex> lock(queue->mutex);
+    if (!queue->kernels.empty()) {
+      *index = queue->kernels.front();
+      queue->kernels.pop_front();
+      popped = true;
     }
   }
-  kernel::LiteKernelUtil::InitTensorInitRefCount(kernels);
+  if (popped) {
+    std::lock_guard<std::mutex> lock(wait_mutex_);
+    ready_num_--;
+  }
+  return popped;
+}
 
-  for (auto kernel : kernels) {
-    if (kernel->in_kernels().empty()) {
-      readyKernels.emplace_back(kernel);
-      continue;
+int ParallelExecutor::RunKernel(kernel::LiteKernel *kernel) {
+  auto ret = kernel->PreProcess();
+  if (RET_OK != ret) {
+    MS_LOG(ERROR) << "PreProcess kernel failed, name: " << kernel->name();
+    return ret;
+  }
+  ret = kernel->Run(*before_, *after_);
+  if (RET_OK != ret) {
+    MS_LOG(ERROR) << "run kernel failed, name: " << kernel->name();
+    return ret;
+  }
+  std::lock_guard<std::mutex> lock(post_process_mutex_);
+  ret = kernel->PostProcess();
+  if (RET_OK != ret) {
+    MS_LOG(ERROR) << "PostProcess kernel failed, name: " << kernel->name();
+    return ret;
+  }
+  return RET_OK;
+}
+
+ParallelExecutor::NestedLaunch *ParallelExecutor::ClaimNestedTask(int *task_id) {
+  for (auto launch : nested_launches_) {
+    if (launch->next_task < launch->task_num) {
+      *task_id = launch->next_task++;
+      return launch;
     }
-    refCount[kernel] = kernel->in_kernels().size();
   }
-  std::vector<kernel::LiteKernel *> newReadyKernels;
-  while (!readyKernels.empty()) {
-    results.resize(readyKernels.size(), RET_OK);
-    if (0 != ParallelLaunch(thread_pool_, RunKernel, this, readyKernels.size())) {
-      MS_LOG(ERROR) << "ParallelLaunch failed ";
-      return RET_ERROR;
+  return nullptr;
+}
+
+void ParallelExecutor::RunNestedTask(NestedLaunch *launch, int task_id) {
+  launch->job(launch->content, task_id);
+  {
+    std::lock_guard<std::mutex> lock(wait_mutex_);
+    launch->unfinished--;
+  }
+  wait_cond_.notify_all();
+}
+
+int ParallelExecutor::RunNestedLaunch(int (*job)(void *, int), void *content, int task_num) {
+  NestedLaunch launch;
+  launch.job = job;
+  launch.content = content;
+  launch.task_num = task_num;
+  launch.unfinished = task_num;
+  {
+    std::lock_guard<std::mutex> lock(wait_mutex_);
+    nested_launches_.push_back(&launch);
+  }
+  wait_cond_.notify_all();
+  // the caller takes tasks too, then waits for the ones taken by the idle workers
+  while (true) {
+    int task_id = 0;
+    {
+      std::unique_lock<std::mutex> lock(wait_mutex_);
+      if (launch.next_task >= launch.task_num) {
+        nested_launches_.erase(std::find(nested_launches_.begin(), nested_launches_.end(), &launch));
+        wait_cond_.wait(lock, [&launch] { return launch.unfinished == 0; });
+        return RET_OK;
+      }
+      task_id = launch.next_task++;
     }
+    RunNestedTask(&launch, task_id);
+  }
+}
 
-    if (std::find_if(results.begin(), results.end(), [](const int &ret) { return (ret != 0); }) != results.end()) {
-      return RET_ERROR;
+int ParallelExecutor::RunWorker(int worker_id) {
+  while (!Done()) {
+    size_t index = 0;
+    if (!PopReadyKernel(worker_id, &index)) {
+      NestedLaunch *launch = nullptr;
+      int task_id = 0;
+      {
+        std::unique_lock<std::mutex> lock(wait_mutex_);
+        wait_cond_.wait(lock, [this, &launch, &task_id] {
+          return ready_num_ > 0 || Done() || (launch = ClaimNestedTask(&task_id)) != nullptr;
+        });
+      }
+      if (launch != nullptr) {
+        RunNestedTask(launch, task_id);
+      }
+      continue;
     }
-    newReadyKernels.clear();
-    for (auto completed : readyKernels) {
-      for (auto out : completed->out_kernels()) {
-        auto iter = refCount.find(out);
-        if (iter == refCount.end()) {
-          continue;
-        }
-        (iter->second)--;
-        if (iter->second <= 0) {
-          newReadyKernels.emplace_back(iter->first);
-          refCount.erase(iter);
-        }
+    if (RunKernel(kernels_[index]) != RET_OK) {
+      {
+        std::lock_guard<std::mutex> lock(wait_mutex_);
+        failed_.store(true);
       }
-
-      auto ret = completed->FreeInWorkTensor();
-      if (RET_OK != ret) {
-        MS_LOG(ERROR) << "FreeInWorkTensor failed, name: " << completed->name();
-        return ret;
+      wait_cond_.notify_all();
+      return RET_ERROR;
+    }
+    for (auto successor : successors_[index]) {
+      if (ref_count_[successor].fetch_sub(1) == 1) {
+        PushReadyKernel(worker_id, successor);
       }
     }
-    readyKernels.clear();
-    readyKernels = std::move(newReadyKernels);
+    {
+      std::lock_guard<std::mutex> lock(wait_mutex_);
+      finished_num_++;
+    }
+    if (Done()) {
+      wait_cond_.notify_all();
+    }
   }
-
   return RET_OK;
 }
 
+static int RunWorkerFunc(void *data, int index) {
+  auto *executor = reinterpret_cast<ParallelExecutor *>(data);
+  return executor->RunWorker(index);
+}
+
+static int RunNestedLaunchFunc(void *data, int (*job)(void *, int), void *content, int task_num) {
+  auto *executor = reinterpret_cast<ParallelExecutor *>(data);
+  return executor->RunNestedLaunch(job, content, task_num);
+}
+
+int ParallelExecutor::Run(std::vector<Tensor *> &in_tensors, std::vector<Tensor *> &out_tensors,
+                          std::vector<kernel::LiteKernel *> &kernels, Allocator *allocator,
+                          const KernelCallBack &before, const KernelCallBack &after) {
+  MS_ASSERT(nullptr != allocator);
+  if (kernels.empty()) {
+    return RET_OK;
+  }
+  if (kernels.front()->Type() != schema::PrimitiveType_Merge) {
+    auto ret = this->CheckInputs(in_tensors);
+    if (ret != RET_OK) {
+      MS_LOG(ERROR) << "CheckInputs failed";
+      return ret;
+    }
+  }
+  if (thread_pool_ == nullptr || kernels != kernels_) {
+    auto ret = Prepare(kernels);
+    if (ret != RET_OK) {
+      MS_LOG(ERROR) << "Prepare parallel executor failed";
+      return ret;
+    }
+  }
+#ifdef SUPPORT_TRAIN
+  for (auto out_tensor : out_tensors) {  // increase RefCount of output tensors, such that Run will not free them
+    out_tensor->set_ref_count(out_tensor->ref_count() + 1);
+  }
+#endif
+  before_ = &before;
+  after_ = &after;
+  finished_num_.store(0);
+  failed_.store(false);
+  ready_num_ = 0;
+  size_t ready_num = 0;
+  for (size_t i = 0; i < kernels_.size(); i++) {
+    ref_count_[i].store(in_degree_[i]);
+    if (in_degree_[i] == 0) {
+      PushReadyKernel(static_cast<int>(ready_num++ % worker_num_), i);
+    }
+  }
+  // kernels running concurrently malloc and free through the same allocator, the mode of the caller is restored after
+  AllocatorContext allocator_context;
+  if (allocator != nullptr) {
+    allocator_context = allocator->GetContext();
+    allocator->SetContext(AllocatorContext{allocator_context.shiftFactor, true});
+  }
+  SetNestedLaunchHandler(thread_pool_, RunNestedLaunchFunc, this);
+  auto ret = ParallelLaunch(thread_pool_, RunWorkerFunc, this, worker_num_);
+  SetNestedLaunchHandler(thread_pool_, nullptr, nullptr);
+  if (allocator != nullptr) {
+    allocator->SetContext(allocator_context);
+  }
+  for (auto &queue : queues_) {
+    queue->kernels.clear();
+  }
+  if (ret != 0 || failed_.load()) {
+    MS_LOG(ERROR) << "Run kernels in parallel failed";
+    return RET_ERROR;
+  }
+  if (finished_num_.load() != kernels_.size()) {
+    MS_LOG(ERROR) << "Only " << finished_num_.load() << " of " << kernels_.size() << " kernels are run";
+    return RET_ERROR;
+  }
+  return RET_OK;
+}
 }  // namespace mindspore::lite
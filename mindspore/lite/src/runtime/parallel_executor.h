@@ -17,6 +17,12 @@
 #ifndef MINDSPORE_LITE_SRC_RUNTIME_PARALLEL_EXECUTOR_H_
 #define MINDSPORE_LITE_SRC_RUNTIME_PARALLEL_EXECUTOR_H_
 
+#include <atomic>
+#include <cstdint>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
 #include <vector>
 #include <unordered_map>
 #include "src/runtime/allocator.h"
@@ -25,24 +31,69 @@
 #include "src/executor.h"
 
 namespace mindspore::lite {
+// Dataflow executor: every worker of the context thread pool pops a ready kernel from its own queue, or steals one
+// from another worker, and a finished kernel pushes the successors whose last producer it was. Workers without a
+// ready kernel block until one is pushed, and meanwhile take tasks of the ParallelLaunch issued by running kernels,
+// so a kernel alone on the critical path still runs on all threads.
 class ParallelExecutor : public Executor {
  public:
   ParallelExecutor() = default;
-  ~ParallelExecutor() override;
+  ~ParallelExecutor() override = default;
 
   int Prepare(const std::vector<kernel::LiteKernel *> &kernels) override;
 
   int Run(std::vector<Tensor *> &in_tensors, std::vector<Tensor *> &out_tensors,
           std::vector<kernel::LiteKernel *> &kernels, Allocator *allocator = nullptr,
           const KernelCallBack &before = nullptr, const KernelCallBack &after = nullptr) override;
-  inline kernel::LiteKernel *GetReadyKernel(const int index) const { return readyKernels.at(index); }
-  inline void SetResult(const int index, const int result) { results.at(index) = result; }
+
+  int RunWorker(int worker_id);
+
+  // runs a ParallelLaunch of a kernel, issued while the pool is busy with the workers
+  int RunNestedLaunch(int (*job)(void *, int), void *content, int task_num);
 
  private:
-  std::unordered_map<kernel::LiteKernel *, size_t> refCount;
-  std::vector<kernel::LiteKernel *> readyKernels;
-  std::vector<int> results;
+  struct WorkerQueue {
+    std::mutex mutex;
+    std::deque<size_t> kernels;
+  };
+
+  // the tasks of a nested launch, claimed and finished under wait_mutex_
+  struct NestedLaunch {
+    int (*job)(void *, int) = nullptr;
+    void *content = nullptr;
+    int task_num = 0;
+    int next_task = 0;
+    int unfinished = 0;
+  };
+
+  void InitTopology(const std::vector<kernel::LiteKernel *> &kernels);
+  void PushReadyKernel(int worker_id, size_t index);
+  bool PopReadyKernel(int worker_id, size_t *index);
+  int RunKernel(kernel::LiteKernel *kernel);
+  // claim a task of the oldest nested launch with tasks left, under wait_mutex_
+  NestedLaunch *ClaimNestedTask(int *task_id);
+  void RunNestedTask(NestedLaunch *launch, int task_id);
+  bool Done() const { return finished_num_.load() >= kernels_.size() || failed_.load(); }
+
+  std::vector<kernel::LiteKernel *> kernels_;
+  // number of predecessors inside the executed kernels, and indexes of the successors
+  std::vector<size_t> in_degree_;
+  std::vector<std::vector<size_t>> successors_;
+  std::unique_ptr<std::atomic<size_t>[]> ref_count_;
+  std::vector<std::unique_ptr<WorkerQueue>> queues_;
+  std::atomic<size_t> finished_num_ = 0;
+  std::atomic<bool> failed_ = false;
+  // idle workers and the callers of nested launches wait here for ready kernels, nested tasks or the end of the run
+  std::mutex wait_mutex_;
+  std::condition_variable wait_cond_;
+  int64_t ready_num_ = 0;
+  std::deque<NestedLaunch *> nested_launches_;
+  // ref count and data of tensors shared by concurrent consumers are released under this lock
+  std::mutex post_process_mutex_;
+  const KernelCallBack *before_ = nullptr;
+  const KernelCallBack *after_ = nullptr;
   struct ThreadPool *thread_pool_ = nullptr;
+  int worker_num_ = 1;
 };
 
 }  // namespace mindspore::lite
@@ -0,0 +1,188 @@
+/**
+ * Copyright 2021 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "src/runtime/static_allocator.h"
+#include <algorithm>
+#include <unordered_map>
+#include "src/common/log_adapter.h"
+#include "src/common/utils.h"
+#include "src/lite_kernel.h"
+#include "src/tensor.h"
+#include "include/errorcode.h"
+
+namespace mindspore::lite {
+namespace {
+size_t AlignSize(size_t size) { return (size + kStaticMemoryAlign - 1) / kStaticMemoryAlign * kStaticMemoryAlign; }
+}  // namespace
+
+StaticAllocator::~StaticAllocator() { Clear(); }
+
+void *StaticAllocator::Malloc(size_t size) {
+  if (size > MAX_MALLOC_SIZE) {
+    MS_LOG(ERROR) << "MallocData out of max_size, size: " << size;
+    return nullptr;
+  }
+  MS_LOG(WARNING) << "Tensor of size " << size << " is not in the static memory plan, fall back to malloc";
+  return malloc(size);
+}
+
+void StaticAllocator::Free(void *ptr) {
+  if (ptr == nullptr || IsArenaBuffer(ptr)) {
+    return;
+  }
+  free(ptr);
+}
+
+void StaticAllocator::Clear() {
+  if (arena_ != nullptr) {
+    free(arena_);
+    arena_ = nullptr;
+  }
+  arena_size_ = 0;
+  arena_capacity_ = 0;
+}
+
+int StaticAllocator::MallocArena(size_t size, size_t max_capacity) {
+  if (arena_ != nullptr && size != 0 && size <= arena_capacity_ && arena_capacity_ <= max_capacity) {
+    arena_size_ = size;
+    return RET_OK;
+  }
+  Clear();
+  if (size == 0) {
+    return RET_OK;
+  }
+  if (size > MAX_MALLOC_SIZE) {
+    MS_LOG(ERROR) << "Static memory arena out of max_size, size: " << size;
+    return RET_ERROR;
+  }
+  // aligned_alloc requires the size to be a multiple of the alignment
+  arena_ = aligned_alloc(kStaticMemoryAlign, AlignSize(size));
+  if (arena_ == nullptr) {
+    MS_LOG(ERROR) << "Malloc static memory arena failed, size: " << size;
+    return RET_MEMORY_FAILED;
+  }
+  arena_size_ = size;
+  arena_capacity_ = size;
+  return RET_OK;
+}
+
+void *StaticAllocator::GetBuffer(size_t offset) const {
+  if (arena_ == nullptr || offset >= arena_size_) {
+    return nullptr;
+  }
+  return reinterpret_cast<char *>(arena_) + offset;
+}
+
+bool StaticAllocator::IsArenaBuffer(const void *ptr) const {
+  auto begin = reinterpret_cast<const char *>(arena_);
+  auto p = reinterpret_cast<const char *>(ptr);
+  return arena_ != nullptr && p >= begin && p < begin + arena_size_;
+}
+
+bool StaticMemoryPlanner::IsPlannable(Tensor *tensor) {
+  if (tensor == nullptr || tensor->category() != Tensor::VAR) {
+    return false;
+  }
+  // tensor list and string tensors manage their own buffers
+  if (tensor->data_type() == kObjectTypeTensorType || tensor->data_type() == kObjectTypeString) {
+    return false;
+  }
+  return tensor->Size() > 0;
+}
+
+void StaticMemoryPlanner::Reset() {
+  plans_.clear();
+  arena_size_ = 0;
+  peak_live_size_ = 0;
+  total_tensor_size_ = 0;
+}
+
+int StaticMemoryPlanner::Plan(const std::vector<kernel::LiteKernel *> &nodes, const std::vector<Tensor *> &graph_inputs,
+                              const std::vector<Tensor *> &graph_outputs) {
+  Reset();
+  std::unordered_map<Tensor *, size_t> plan_index;
+  for (size_t i = 0; i < nodes.size(); i++) {
+    auto node = nodes.at(i);
+    MS_ASSERT(node != nullptr);
+    for (auto tensor : node->out_tensors()) {
+      if (!IsPlannable(tensor) || IsContain(graph_inputs, tensor) || IsContain(graph_outputs, tensor)) {
+        continue;
+      }
+      if (plan_index.find(tensor) != plan_index.end()) {
+        MS_LOG(ERROR) << "Tensor is produced by more than one node, node: " << node->name();
+        Reset();
+        return RET_ERROR;
+      }
+      plan_index[tensor] = plans_.size();
+      TensorMemoryPlan plan;
+      plan.tensor = tensor;
+      plan.size = AlignSize(tensor->Size());
+      plan.first_use = i;
+      plan.last_use = i;
+      plans_.emplace_back(plan);
+    }
+    for (auto tensor : node->in_tensors()) {
+      auto iter = plan_index.find(tensor);
+      if (iter != plan_index.end()) {
+        plans_.at(iter->second).last_use = i;
+      }
+    }
+  }
+
+  for (size_t i = 0; i < nodes.size(); i++) {
+    size_t live_size = 0;
+    for (auto &plan : plans_) {
+      if (plan.first_use <= i && i <= plan.last_use) {
+        live_size += plan.size;
+      }
+    }
+    peak_live_size_ = std::max(peak_live_size_, live_size);
+  }
+
+  std::vector<size_t> order(plans_.size());
+  for (size_t i = 0; i < order.size(); i++) {
+    order[i] = i;
+  }
+  std::stable_sort(order.begin(), order.end(),
+                   [this](size_t a, size_t b) { return plans_.at(a).size > plans_.at(b).size; });
+  std::vector<size_t> placed;
+  for (auto index : order) {
+    auto &plan = plans_.at(index);
+    // placed tensors whose lifetime intersects, sorted by offset
+    std::vector<const TensorMemoryPlan *> conflicts;
+    for (auto placed_index : placed) {
+      auto &other = plans_.at(placed_index);
+      if (other.first_use <= plan.last_use && plan.first_use <= other.last_use) {
+        conflicts.push_back(&other);
+      }
+    }
+    std::sort(conflicts.begin(), conflicts.end(),
+              [](const TensorMemoryPlan *a, const TensorMemoryPlan *b) { return a->offset < b->offset; });
+    size_t offset = 0;
+    for (auto other : conflicts) {
+      if (offset + plan.size <= other->offset) {
+        break;
+      }
+      offset = std::max(offset, other->offset + other->size);
+    }
+    plan.offset = offset;
+    arena_size_ = std::max(arena_size_, offset + plan.size);
+    total_tensor_size_ += plan.size;
+    placed.push_back(index);
+  }
+  return RET_OK;
+}
+}  // namespace mindspore::lite
@@ -0,0 +1,102 @@
+/**
+ * Copyright 2021 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MINDSPORE_LITE_SRC_RUNTIME_STATIC_ALLOCATOR_H_
+#define MINDSPORE_LITE_SRC_RUNTIME_STATIC_ALLOCATOR_H_
+
+#include <cstdint>
+#include <vector>
+#include "src/runtime/allocator.h"
+
+namespace mindspore::kernel {
+class LiteKernel;
+}
+
+namespace mindspore::lite {
+class Tensor;
+
+constexpr auto kStaticAllocatorName = "static";
+constexpr size_t kStaticMemoryAlign = 64;
+
+// Owns one aligned arena whose regions are handed out by offset at compile time. Tensors bound to it keep their
+// data pointer across runs, so FreeData is a no-op for them and MallocData returns early.
+class StaticAllocator : public Allocator {
+ public:
+  StaticAllocator() { name = kStaticAllocatorName; }
+  ~StaticAllocator() override;
+  // only reached by tensors outside of the plan, e.g. after an unexpected shape change
+  void *Malloc(size_t size) override;
+  void Free(void *ptr) override;
+  size_t GetTotalSize() override { return arena_size_; }
+  void Clear() override;
+
+  // Keeps the current arena when it holds size bytes and is at most max_capacity, so resizing back and forth between
+  // shapes does not reallocate, and an arena grown for shapes no longer used is given back.
+  int MallocArena(size_t size, size_t max_capacity = SIZE_MAX);
+  size_t arena_capacity() const { return arena_capacity_; }
+  void *GetBuffer(size_t offset) const;
+  bool IsArenaBuffer(const void *ptr) const;
+
+ private:
+  void *arena_ = nullptr;
+  size_t arena_size_ = 0;
+  size_t arena_capacity_ = 0;
+};
+
+inline bool IsStaticAllocator(const Allocator *allocator) {
+  return allocator != nullptr && allocator->name == kStaticAllocatorName;
+}
+
+struct TensorMemoryPlan {
+  Tensor *tensor = nullptr;
+  size_t size = 0;
+  // index of the producing node and of the last consuming node in execution order
+  size_t first_use = 0;
+  size_t last_use = 0;
+  size_t offset = 0;
+};
+
+// Computes the lifetime of every intermediate tensor from the execution order of the nodes and packs them into one
+// arena, largest tensor first, at the lowest offset not overlapping any placed tensor whose lifetime intersects.
+class StaticMemoryPlanner {
+ public:
+  StaticMemoryPlanner() = default;
+  ~StaticMemoryPlanner() = default;
+
+  int Plan(const std::vector<kernel::LiteKernel *> &nodes, const std::vector<Tensor *> &graph_inputs,
+           const std::vector<Tensor *> &graph_outputs);
+
+  void Reset();
+
+  const std::vector<TensorMemoryPlan> &plans() const { return plans_; }
+  // bytes of the arena
+  size_t arena_size() const { return arena_size_; }
+  // largest sum of simultaneously live tensors, the lower bound of any plan
+  size_t peak_live_size() const { return peak_live_size_; }
+  // sum of all planned tensors, what is needed without any reuse
+  size_t total_tensor_size() const { return total_tensor_size_; }
+
+ private:
+  static bool IsPlannable(Tensor *tensor);
+
+  std::vector<TensorMemoryPlan> plans_;
+  size_t arena_size_ = 0;
+  size_t peak_live_size_ = 0;
+  size_t total_tensor_size_ = 0;
+};
+}  // namespace mindspore::lite
+
+#endif  // MINDSPORE_LITE_SRC_RUNTIME_STATIC_ALLOCATOR_H_
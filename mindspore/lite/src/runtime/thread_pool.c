@@ -18,14 +18,22 @@
 #define _GNU_SOURCE
 #include <pthread.h>
 #include <stdatomic.h>
+#include <stdint.h>
 #include <semaphore.h>
 #include <string.h>
 #include <stdlib.h>
+#include <sched.h>
 
 #ifdef __ANDROID__
 #define BIND_CORE
 #include <unistd.h>
-#include <sched.h>
+#endif
+
+#ifdef __linux__
+#define USE_FUTEX
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
 #endif
 
 #ifdef THREAD_POOL_DEBUG
@@ -44,25 +52,41 @@
 #define RET_TP_SYSTEM_ERROR (-1)
 
 #define MAX_THREAD_NUM (8)
+// polls of an idle worker for the next launch before it blocks
 #define DEFAULT_SPIN_COUNT (30000)
+// polls of the master for the tasks still run by the workers before it blocks
+#define MASTER_SPIN_COUNT (2000)
+#define SPIN_YIELD_INTERVAL (64)
+#define CACHE_LINE_SIZE (64)
+
+// The task ids of a launch left to a thread, packed with the launch generation into one word, so that the owner
+// taking from the front and the thieves taking from the back agree by a single compare exchange.
+#define RANGE_BITS (20)
+#define RANGE_MASK ((UINT64_C(1) << RANGE_BITS) - 1)
+#define GEN_MASK ((UINT64_C(1) << (64 - 2 * RANGE_BITS)) - 1)
+#define MAX_LAUNCH_TASK_NUM ((int)RANGE_MASK)
 
 typedef struct {
-  int (*func)(void *arg, int);
-  void *content;
-} Task;
+  atomic_uint_least64_t value;
+  char padding[CACHE_LINE_SIZE - sizeof(atomic_uint_least64_t)];
+} TaskRange;
+
+// a counter threads block on until it changes, a futex where available
+typedef struct {
+  atomic_int value;
+#ifndef USE_FUTEX
+  pthread_mutex_t mutex;
+  pthread_cond_t cond;
+#endif
+} WaitWord;
 
 typedef struct Thread {
   void *thread_pool;
   int thread_id;
   struct Thread *next;
   pthread_t pthread;
-  Task *task_list[MAX_TASK_NUM];
-  atomic_int task_size;
-  atomic_int head;
-  atomic_int tail;
   atomic_bool activate;
   atomic_bool is_running;
-  sem_t sem;
   sem_t sem_inited;
 } Thread;
 
@@ -78,8 +102,96 @@ typedef struct ThreadPool {
   int thread_num;
   BindMode mode;
   atomic_bool is_alive;
+  atomic_bool is_launching;
+  // takes over the launches issued while the pool is busy, see SetNestedLaunchHandler
+  _Atomic(uintptr_t) nested_handler;
+  _Atomic(uintptr_t) nested_handler_data;
+  // job of the current launch, read by the workers after they see its epoch
+  _Atomic(uintptr_t) func;
+  _Atomic(uintptr_t) content;
+  // task ids left to every thread, the master is the last one
+  TaskRange ranges[MAX_THREAD_NUM];
+  // bumped by every launch and by destroy, idle workers block on it
+  WaitWord epoch;
+  // tasks of the current launch not finished yet, the master blocks on it
+  WaitWord unfinished;
+  atomic_int sleeping_num;
+  atomic_bool master_waiting;
 } ThreadPool;
 
+static void WaitWordInit(WaitWord *word) {
+  atomic_init(&word->value, 0);
+#ifndef USE_FUTEX
+  pthread_mutex_init(&word->mutex, NULL);
+  pthread_cond_init(&word->cond, NULL);
+#endif
+}
+
+static void WaitWordDestroy(WaitWord *word) {
+#ifndef USE_FUTEX
+  pthread_mutex_destroy(&word->mutex);
+  pthread_cond_destroy(&word->cond);
+#endif
+}
+
+// block while the word still holds value, may return spuriously
+static void WaitWordWait(WaitWord *word, int value) {
+#ifdef USE_FUTEX
+  syscall(SYS_futex, &word->value, FUTEX_WAIT_PRIVATE, value, NULL, NULL, 0);
+#else
+  pthread_mutex_lock(&word->mutex);
+  while (atomic_load(&word->value) == value) {
+    pthread_cond_wait(&word->cond, &word->mutex);
+  }
+  pthread_mutex_unlock(&word->mutex);
+#endif
+}
+
+// wake every thread blocked on the word, after changing its value
+static void WaitWordWake(WaitWord *word) {
+#ifdef USE_FUTEX
+  syscall(SYS_futex, &word->value, FUTEX_WAKE_PRIVATE, INT32_MAX, NULL, NULL, 0);
+#else
+  pthread_mutex_lock(&word->mutex);
+  pthread_cond_broadcast(&word->cond);
+  pthread_mutex_unlock(&word->mutex);
+#endif
+}
+
+static inline void SpinPause(int spin_count) {
+  if (spin_count % SPIN_YIELD_INTERVAL == SPIN_YIELD_INTERVAL - 1) {
+    sched_yield();
+    return;
+  }
+#if defined(__x86_64__) || defined(__i386__)
+  __asm__ __volatile__("pause");
+#elif defined(__aarch64__) || defined(__arm__)
+  __asm__ __volatile__("yield");
+#endif
+}
+
+static inline uint64_t MakeRange(uint64_t gen, uint64_t begin, uint64_t end) {
+  return ((gen & GEN_MASK) << (2 * RANGE_BITS)) | (begin << RANGE_BITS) | end;
+}
+
+// take one task id of generation gen from the front (owner) or the back (thief) of range
+static bool ClaimTask(TaskRange *range, uint64_t gen, bool from_front, int *task_id) {
+  uint64_t old_value = atomic_load_explicit(&range->value, memory_order_acquire);
+  while (true) {
+    uint64_t begin = (old_value >> RANGE_BITS) & RANGE_MASK;
+    uint64_t end = old_value & RANGE_MASK;
+    if ((old_value >> (2 * RANGE_BITS)) != (gen & GEN_MASK) || begin >= end) {
+      return false;
+    }
+    uint64_t new_value = from_front ? MakeRange(gen, begin + 1, end) : MakeRange(gen, begin, end - 1);
+    if (atomic_compare_exchange_weak_explicit(&range->value, &old_value, new_value, memory_order_acq_rel,
+                                              memory_order_acquire)) {
+      *task_id = (int)(from_front ? begin : end - 1);
+      return true;
+    }
+  }
+}
+
 Thread *GetThread(struct ThreadPool *thread_pool, int thread_id) {
   if (thread_pool == NULL) {
     LOG_ERROR("get thread pool instane failed, thread_id: %d", thread_id);
@@ -116,17 +228,14 @@ void FreeThread(ThreadList *thread_list, Thread *thread) {
     LOG_ERROR("thread is nullptr");
     return;
   }
-  // only support sequential release
+  // only support sequential release, the thread has been woken up by the epoch of destroy
   thread_list->head = thread->next;
-  sem_post(&thread->sem);
-  while (true) {
-    if (thread != NULL && !thread->is_running) {
-      (void)sem_destroy(&thread->sem);
-      free(thread);
-      thread = NULL;
-      break;
-    }
+  int spin_count = 0;
+  while (atomic_load(&thread->is_running)) {
+    SpinPause(spin_count++);
   }
+  (void)sem_destroy(&thread->sem_inited);
+  free(thread);
 }
 
 #ifdef BIND_CORE
@@ -602,90 +711,72 @@ int BindThreads(struct ThreadPool *thread_pool, bool is_bind, int mode) {
 #endif
 }
 
-bool PushTaskToQueue(struct ThreadPool *thread_pool, int thread_id, Task *task) {
-  Thread *thread = GetThread(thread_pool, thread_id);
-  if (thread == NULL) {
-    LOG_ERROR("get thread failed, thread_id: %d", thread_id);
-    return false;
-  }
-  const int tail_index = atomic_load_explicit(&thread->tail, memory_order_relaxed);
-  int next = (tail_index + 1) % MAX_TASK_NUM;
-  if (next == atomic_load_explicit(&thread->head, memory_order_acquire)) {
-    return false;
+static void FinishTask(struct ThreadPool *thread_pool) {
+  if (atomic_fetch_sub(&thread_pool->unfinished.value, 1) == 1 && atomic_load(&thread_pool->master_waiting)) {
+    WaitWordWake(&thread_pool->unfinished);
   }
-  thread->task_list[tail_index] = task;
-  atomic_store_explicit(&thread->tail, next, memory_order_release);
-  atomic_fetch_add_explicit(&thread->task_size, 1, memory_order_relaxed);
-  sem_post(&thread->sem);
-  return true;
 }
 
-bool PopTaskFromQueue(Thread *thread, Task **task) {
-  if (thread == NULL) {
-    LOG_ERROR("thread is nullptr");
-    return false;
-  }
-  if (atomic_load_explicit(&thread->task_size, memory_order_relaxed) == 0) {
-    return false;
-  }
-  const int head_index = atomic_load_explicit(&thread->head, memory_order_relaxed);
-  if (head_index == atomic_load_explicit(&thread->tail, memory_order_acquire)) {
-    return false;
+// Run the tasks of generation gen left to thread_id, then steal the ones left to the others from the back, one at a
+// time, until no task is left to claim.
+static void RunTasks(struct ThreadPool *thread_pool, int thread_id, uint64_t gen, int (*func)(void *, int),
+                     void *content) {
+  int task_id = 0;
+  int thread_num = thread_pool->thread_num;
+  while (true) {
+    bool claimed = ClaimTask(&thread_pool->ranges[thread_id], gen, true, &task_id);
+    for (int i = 1; !claimed && i < thread_num; ++i) {
+      claimed = ClaimTask(&thread_pool->ranges[(thread_id + i) % thread_num], gen, false, &task_id);
+    }
+    if (!claimed) {
+      return;
+    }
+    func(content, task_id);
+    FinishTask(thread_pool);
   }
-  *task = thread->task_list[head_index];
-  atomic_store_explicit(&thread->head, (head_index + 1) % MAX_TASK_NUM, memory_order_release);
-  return true;
 }
 
-void WaitAllThread(struct ThreadPool *thread_pool) {
-  if (thread_pool == NULL) {
-    LOG_ERROR("get thread pool instane failed");
-    return;
-  }
-  bool k_success_flag = false;
-  while (!k_success_flag) {
-    k_success_flag = true;
-    for (int i = 0; i < thread_pool->thread_num - 1; ++i) {
-      Thread *thread = GetThread(thread_pool, i);
-      if (thread == NULL) {
-        LOG_ERROR("get thread failed, thread_id: %d", i);
-        return;
-      }
-      if (atomic_load_explicit(&thread->task_size, memory_order_acquire) != 0) {
-        k_success_flag = false;
-        break;
-      }
+static void WaitTasks(struct ThreadPool *thread_pool) {
+  for (int spin_count = 0; spin_count < MASTER_SPIN_COUNT; ++spin_count) {
+    if (atomic_load(&thread_pool->unfinished.value) == 0) {
+      return;
     }
+    SpinPause(spin_count);
+  }
+  atomic_store(&thread_pool->master_waiting, true);
+  int unfinished;
+  while ((unfinished = atomic_load(&thread_pool->unfinished.value)) != 0) {
+    WaitWordWait(&thread_pool->unfinished, unfinished);
   }
+  atomic_store(&thread_pool->master_waiting, false);
 }
 
-int DistributeTask(struct ThreadPool *thread_pool, Task *task, int task_num) {
+int DistributeTask(struct ThreadPool *thread_pool, int (*func)(void *, int), void *content, int task_num) {
   if (thread_pool == NULL) {
     LOG_ERROR("get thread pool instane failed");
     return RET_TP_ERROR;
   }
-  if (task_num > thread_pool->thread_num || task_num <= 1) {
+  if (func == NULL || task_num <= 1 || task_num > MAX_LAUNCH_TASK_NUM) {
     LOG_ERROR("invalid task num: %d, thread num: %d", task_num, thread_pool->thread_num);
     return RET_TP_ERROR;
   }
-  bool k_success_flag = false;
-  int size = thread_pool->thread_num < task_num ? thread_pool->thread_num : task_num;
-  for (int i = 0; i < size - 1; ++i) {
-    do {
-      k_success_flag = true;
-      if (!PushTaskToQueue(thread_pool, i, task)) {
-        k_success_flag = false;
-      }
-    } while (!k_success_flag);
-  }
-  // master thread
-  if (task->func == NULL) {
-    LOG_ERROR("task->func is nullptr");
-    return RET_TP_ERROR;
-  }
-  task->func(task->content, size - 1);
-  // wait
-  WaitAllThread(thread_pool);
+  int thread_num = thread_pool->thread_num;
+  uint64_t gen = (uint64_t)(unsigned int)atomic_load(&thread_pool->epoch.value) + 1;
+  atomic_store(&thread_pool->func, (uintptr_t)func);
+  atomic_store(&thread_pool->content, (uintptr_t)content);
+  atomic_store(&thread_pool->unfinished.value, task_num);
+  // contiguous task ids per thread, the master takes the last ones as before
+  for (int i = 0; i < thread_num; ++i) {
+    uint64_t begin = (uint64_t)task_num * i / thread_num;
+    uint64_t end = (uint64_t)task_num * (i + 1) / thread_num;
+    atomic_store(&thread_pool->ranges[i].value, MakeRange(gen, begin, end));
+  }
+  atomic_store(&thread_pool->epoch.value, (int)gen);
+  if (atomic_load(&thread_pool->sleeping_num) > 0) {
+    WaitWordWake(&thread_pool->epoch);
+  }
+  RunTasks(thread_pool, thread_num - 1, gen, func, content);
+  WaitTasks(thread_pool);
   return RET_TP_OK;
 }
 
@@ -695,56 +786,82 @@ int AddTask(struct ThreadPool *thread_pool, int func(void *, int), void *content
     return RET_TP_ERROR;
   }
   // if single thread, run master thread
-  if (thread_pool->thread_num <= 1 || task_num <= 1) {
+  bool expected = false;
+  if (thread_pool->thread_num <= 1 || task_num <= 1 || task_num > MAX_LAUNCH_TASK_NUM) {
+    for (int i = 0; i < task_num; ++i) {
+      func(content, i);
+    }
+    return RET_TP_OK;
+  }
+  // the pool is already running a launch of another caller (e.g. a kernel run by the parallel executor): the owner of
+  // that launch shares the tasks with its idle threads if it registered a handler, otherwise run master thread
+  if (!atomic_compare_exchange_strong(&thread_pool->is_launching, &expected, true)) {
+    NestedLaunchHandler handler = (NestedLaunchHandler)atomic_load(&thread_pool->nested_handler);
+    if (handler != NULL) {
+      return handler((void *)atomic_load(&thread_pool->nested_handler_data), func, content, task_num);
+    }
     for (int i = 0; i < task_num; ++i) {
       func(content, i);
     }
     return RET_TP_OK;
   }
-  Task task;
-  task.func = func;
-  task.content = content;
-  return DistributeTask(thread_pool, &task, task_num);
+  int ret = DistributeTask(thread_pool, func, content, task_num);
+  atomic_store(&thread_pool->is_launching, false);
+  return ret;
 }
 
 int ParallelLaunch(struct ThreadPool *thread_pool, int (*func)(void *, int), void *content, int task_num) {
   return AddTask(thread_pool, func, content, task_num);
 }
 
+void SetNestedLaunchHandler(struct ThreadPool *thread_pool, NestedLaunchHandler handler, void *handler_data) {
+  if (thread_pool == NULL) {
+    LOG_ERROR("get thread pool instane failed");
+    return;
+  }
+  atomic_store(&thread_pool->nested_handler_data, (uintptr_t)handler_data);
+  atomic_store(&thread_pool->nested_handler, (uintptr_t)handler);
+}
+
+// Spin for the next launch while the pool is active, then block until it comes.
+static int WaitLaunch(struct ThreadPool *thread_pool, Thread *thread, int last_epoch) {
+  int epoch = atomic_load(&thread_pool->epoch.value);
+  for (int spin_count = 0; epoch == last_epoch && atomic_load(&thread->activate) && spin_count < DEFAULT_SPIN_COUNT;
+       ++spin_count) {
+    SpinPause(spin_count);
+    epoch = atomic_load(&thread_pool->epoch.value);
+  }
+  if (epoch != last_epoch) {
+    return epoch;
+  }
+  atomic_fetch_add(&thread_pool->sleeping_num, 1);
+  while ((epoch = atomic_load(&thread_pool->epoch.value)) == last_epoch) {
+    WaitWordWait(&thread_pool->epoch, last_epoch);
+  }
+  atomic_fetch_sub(&thread_pool->sleeping_num, 1);
+  return epoch;
+}
+
 void ThreadRun(Thread *thread) {
-  thread->is_running = true;
   ThreadPool *thread_pool = (ThreadPool *)(thread->thread_pool);
   if (thread_pool == NULL) {
     LOG_ERROR("get thread pool instane failed");
     thread->is_running = false;
     return;
   }
-  Task *task = NULL;
-  int thread_id = thread->thread_id;
-  int spin_count = 0;
+  int epoch = atomic_load(&thread_pool->epoch.value);
   sem_post(&thread->sem_inited);
-  while (thread_pool->is_alive) {
-    while (thread->activate) {
-      if (PopTaskFromQueue(thread, &task)) {
-        if (task->func == NULL) {
-          LOG_ERROR("task->func is nullptr");
-          return;
-        }
-        task->func(task->content, thread_id);
-        atomic_fetch_sub_explicit(&thread->task_size, 1, memory_order_release);
-        spin_count = 0;
-        sem_trywait(&thread->sem);
-      } else {
-        sched_yield();
-        spin_count++;
-      }
-      if (spin_count == DEFAULT_SPIN_COUNT) {
-        break;
-      }
+  while (true) {
+    epoch = WaitLaunch(thread_pool, thread, epoch);
+    if (!atomic_load(&thread_pool->is_alive)) {
+      break;
     }
-    sem_wait(&thread->sem);
+    // a job read after its launch finished is never called, as no task of the epoch is left to claim
+    int (*func)(void *, int) = (int (*)(void *, int))atomic_load(&thread_pool->func);
+    void *content = (void *)atomic_load(&thread_pool->content);
+    RunTasks(thread_pool, thread->thread_id, (uint64_t)(unsigned int)epoch, func, content);
   }
-  thread->is_running = false;
+  atomic_store(&thread->is_running, false);
 }
 
 void PushThreadToList(struct ThreadPool *thread_pool, Thread *thread) {
@@ -780,13 +897,9 @@ int CreateNewThread(struct ThreadPool *thread_pool, int thread_id) {
   }
   thread->thread_pool = thread_pool;
   thread->thread_id = thread_id;
-  thread->head = ATOMIC_VAR_INIT(0);
-  thread->tail = ATOMIC_VAR_INIT(0);
-  thread->task_size = ATOMIC_VAR_INIT(0);
   thread->activate = ATOMIC_VAR_INIT(true);
   thread->is_running = ATOMIC_VAR_INIT(true);
   thread->next = NULL;
-  sem_init(&thread->sem, 0, 0);
   sem_init(&thread->sem_inited, 0, 0);
   PushThreadToList(thread_pool, thread);
   pthread_create(&thread->pthread, NULL, (void *)ThreadRun, thread);
@@ -818,8 +931,20 @@ ThreadPool *CreateThreadPool(int thread_num, int mode) {
   }
   thread_pool->thread_num = thread_num > MAX_THREAD_NUM ? MAX_THREAD_NUM : thread_num;
   thread_pool->is_alive = ATOMIC_VAR_INIT(true);
+  thread_pool->is_launching = ATOMIC_VAR_INIT(false);
+  atomic_init(&thread_pool->nested_handler, 0);
+  atomic_init(&thread_pool->nested_handler_data, 0);
   thread_pool->mode = mode;
   thread_pool->thread_list = NULL;
+  atomic_init(&thread_pool->func, 0);
+  atomic_init(&thread_pool->content, 0);
+  for (int i = 0; i < MAX_THREAD_NUM; ++i) {
+    atomic_init(&thread_pool->ranges[i].value, 0);
+  }
+  WaitWordInit(&thread_pool->epoch);
+  WaitWordInit(&thread_pool->unfinished);
+  atomic_init(&thread_pool->sleeping_num, 0);
+  atomic_init(&thread_pool->master_waiting, false);
   if (thread_num > 1) {
     thread_pool->thread_list = (ThreadList *)malloc(sizeof(ThreadList));
     if (thread_pool->thread_list == NULL) {
@@ -862,7 +987,6 @@ void ActivateThreadPool(struct ThreadPool *thread_pool) {
   }
   Thread *thread = thread_list->head;
   while (thread != NULL) {
-    sem_post(&thread->sem);
     thread->activate = true;
     thread = thread->next;
   }
@@ -878,6 +1002,7 @@ void DeactivateThreadPool(struct ThreadPool *thread_pool) {
     LOG_ERROR("thread pool's list is null");
     return;
   }
+  // inactive threads block right after a launch instead of spinning for the next one
   Thread *thread = thread_list->head;
   while (thread != NULL) {
     thread->activate = false;
@@ -896,6 +1021,8 @@ void DestroyThreadPool(struct ThreadPool *thread_pool) {
   }
   DeactivateThreadPool(thread_pool);
   thread_pool->is_alive = false;
+  atomic_fetch_add(&thread_pool->epoch.value, 1);
+  WaitWordWake(&thread_pool->epoch);
   LOG_ERROR("DestroyThreadPool thread num : %d", thread_pool->thread_num);
   for (int i = 0; i < thread_pool->thread_num - 1; ++i) {
     Thread *thread = GetThread(thread_pool, i);
@@ -905,6 +1032,8 @@ void DestroyThreadPool(struct ThreadPool *thread_pool) {
   }
   free(thread_pool->thread_list);
   thread_pool->thread_list = NULL;
+  WaitWordDestroy(&thread_pool->epoch);
+  WaitWordDestroy(&thread_pool->unfinished);
   LOG_INFO("destroy thread pool success");
 }
 
@@ -19,8 +19,6 @@
 
 #include <stdbool.h>
 
-#define MAX_TASK_NUM (2)
-
 /// \brief BindMode defined for holding bind cpu strategy argument.
 typedef enum {
   NO_BIND_MODE = 0, /**< no bind */
@@ -33,7 +31,10 @@ struct ThreadPool;
 struct ThreadPool *CreateThreadPool(int thread_num, int mode);
 
 /**
- *
+ * run job(content, task_id) for every task_id in [0, task_num) and return when all of them finished, the calling
+ * thread runs tasks too. task_num may exceed the thread num: tasks are dealt out in contiguous ranges and idle threads
+ * steal from the others, so small tasks balance the load over threads descheduled or bound to slower cores.
+ * A launch issued while the pool is running another one runs in the calling thread.
  * @param session_index, support multi session
  * @param job
  * @param content
@@ -41,6 +42,16 @@ struct ThreadPool *CreateThreadPool(int thread_num, int mode);
  */
 int ParallelLaunch(struct ThreadPool *thread_pool, int (*job)(void *, int), void *content, int task_num);
 
+typedef int (*NestedLaunchHandler)(void *handler_data, int (*job)(void *, int), void *content, int task_num);
+
+/**
+ * let handler run the launches issued while the pool is running another launch, instead of the calling thread alone,
+ * e.g. the parallel executor hands them to its workers waiting for a ready kernel. Set it while no launch is running.
+ * @param handler, NULL to run such launches in the calling thread again
+ * @param handler_data
+ */
+void SetNestedLaunchHandler(struct ThreadPool *thread_pool, NestedLaunchHandler handler, void *handler_data);
+
 /**
  * bind each thread to specified cpu core
  * @param is_bind
@@ -27,6 +27,21 @@ using mindspore::lite::RET_INFER_ERR;
 using mindspore::lite::RET_INFER_INVALID;
 using mindspore::lite::RET_OK;
 
+namespace {
+std::vector<std::vector<int>> TensorsOf(const LiteKernel *kernel) {
+  auto node_tensors = kernel->in_tensors();
+  node_tensors.insert(node_tensors.end(), kernel->out_tensors().begin(), kernel->out_tensors().end());
+  std::vector<std::vector<int>> tensors;
+  for (auto tensor : node_tensors) {
+    std::vector<int> desc = {static_cast<int>(tensor->data_type()), static_cast<int>(tensor->format())};
+    auto shape = tensor->shape();
+    desc.insert(desc.end(), shape.begin(), shape.end());
+    tensors.push_back(desc);
+  }
+  return tensors;
+}
+}  // namespace
+
 int SubGraphKernel::Prepare() {
   for (auto node : this->nodes_) {
     if (node == nullptr) {
@@ -137,9 +152,11 @@ int SubGraphKernel::ReSize(bool is_interrupt) {
     if (!is_interrupt) {
       ret = kernel->ReSize();
       if (ret != RET_OK) {
+        resized_tensors_.erase(kernel);
         MS_LOG(ERROR) << "kernel " << kernel->name() << " resize fail!ret = " << ret;
         return ret;
       }
+      resized_tensors_[kernel] = TensorsOf(kernel);
     }
   }
   if (is_interrupt) {
@@ -149,6 +166,29 @@ int SubGraphKernel::ReSize(bool is_interrupt) {
   return RET_OK;
 }
 
+int SubGraphKernel::ReSizeNodes() {
+  for (auto kernel : nodes_) {
+    if (kernel == nullptr || kernel->GetPrimitive() == nullptr) {
+      MS_LOG(ERROR) << "input kernel or its primitive is nullptr!";
+      return RET_ERROR;
+    }
+    const_cast<mindspore::lite::PrimitiveC *>(kernel->GetPrimitive())->set_infer_flag(true);
+    auto tensors = TensorsOf(kernel);
+    auto iter = resized_tensors_.find(kernel);
+    if (iter != resized_tensors_.end() && iter->second == tensors) {
+      continue;
+    }
+    auto ret = kernel->ReSize();
+    if (ret != RET_OK) {
+      resized_tensors_.erase(kernel);
+      MS_LOG(ERROR) << "kernel " << kernel->name() << " resize fail!ret = " << ret;
+      return ret;
+    }
+    resized_tensors_[kernel] = tensors;
+  }
+  return RET_OK;
+}
+
 void SubGraphKernel::InitOutTensorInitRefCount() {
   for (auto *node : nodes_) {
     node->InitOutTensorInitRefCount();
@@ -166,7 +206,11 @@ int CpuSubGraph::Prepare() {
       tensor->set_allocator(this->context_->allocator.get());
     }
   }
-  return RET_OK;
+  if (this->executor_ == nullptr) {
+    MS_LOG(ERROR) << "executor is nullptr";
+    return RET_ERROR;
+  }
+  return this->executor_->Prepare(this->nodes_);
 }
 
 void CpuFp16SubGraph::FreeOriginInputData() {
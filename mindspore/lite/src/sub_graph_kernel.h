@@ -19,9 +19,11 @@
 
 #include <utility>
 #include <string>
+#include <unordered_map>
 #include <vector>
 #include "src/lite_kernel.h"
 #include "src/executor.h"
+#include "src/runtime/parallel_executor.h"
 #include "src/common/log_adapter.h"
 #ifdef ENABLE_ARM64
 #include "src/common/utils.h"
@@ -84,6 +86,11 @@ class SubGraphKernel : public LiteKernel {
 
   int ReSize(bool is_interrupt);
 
+  // Resize the nodes to the shapes already set on their output tensors, without inferring them. A node whose input and
+  // output tensors still have the shapes, formats and data types of its last resize is skipped, the others still pay
+  // for their ReSize, which packs weights or rebuilds the per-shape state only the kernel knows.
+  int ReSizeNodes();
+
   void InitOutTensorInitRefCount() override;
 
   std::string ToString() const override;
@@ -97,6 +104,8 @@ class SubGraphKernel : public LiteKernel {
   // exit nodes in nodes
   std::vector<LiteKernel *> out_nodes_;
   mindspore::lite::Executor *executor_ = nullptr;
+  // shapes, formats and data types of the tensors of a node at its last resize by ReSize or ReSizeNodes
+  std::unordered_map<LiteKernel *, std::vector<std::vector<int>>> resized_tensors_;
 };
 
 class CpuSubGraph : public SubGraphKernel {
@@ -106,7 +115,11 @@ class CpuSubGraph : public SubGraphKernel {
                        const std::vector<LiteKernel *> &nodes, const lite::InnerContext *ctx)
       : SubGraphKernel(inputs, outputs, in_kernels, out_kernels, nodes, ctx) {
     subgraph_type_ = kCpuFP32SubGraph;
-    this->executor_ = new (std::nothrow) mindspore::lite::CpuExecutor;
+    if (ctx != nullptr && ctx->enable_parallel_) {
+      this->executor_ = new (std::nothrow) mindspore::lite::ParallelExecutor;
+    } else {
+      this->executor_ = new (std::nothrow) mindspore::lite::CpuExecutor;
+    }
   }
 
   ~CpuSubGraph() override { delete this->executor_; }
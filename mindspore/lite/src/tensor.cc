@@ -22,6 +22,7 @@
 #include "src/tensor.h"
 #include "securec/include/securec.h"
 #include "include/errorcode.h"
+#include "src/runtime/static_allocator.h"
 
 namespace mindspore {
 namespace lite {
@@ -302,6 +303,10 @@ int Tensor::FreeData() {
   if (nullptr == this->data_) {
     return RET_OK;
   }
+  // buffers in the static memory plan are reused by every run, a fallback buffer of the allocator is freed
+  if (IsStaticAllocator(allocator_) && reinterpret_cast<StaticAllocator *>(allocator_)->IsArenaBuffer(this->data_)) {
+    return RET_OK;
+  }
   if (nullptr == allocator_) {
     free(this->data_);
     this->data_ = nullptr;
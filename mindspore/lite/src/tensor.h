@@ -134,6 +134,29 @@ class Tensor : public mindspore::tensor::MSTensor {
 
   bool IsScalar();
 
+  // weight packed offline by the converter, read only and owned by the model
+  const void *packed_data() const { return packed_data_; }
+
+  // keeps the mapped model file holding packed_data alive, nullptr if the model buffer is allocated
+  const std::shared_ptr<const char> &packed_data_holder() const { return packed_data_holder_; }
+
+  size_t packed_size() const { return packed_size_; }
+
+  const std::string &packed_layout() const { return packed_layout_; }
+
+  void set_packed_data(const void *packed_data, size_t packed_size, const std::string &packed_layout,
+                       const std::shared_ptr<const char> &packed_data_holder = nullptr) {
+    packed_data_ = packed_data;
+    packed_size_ = packed_size;
+    packed_layout_ = packed_layout;
+    packed_data_holder_ = packed_data_holder;
+  }
+
+  // identity of the constant data in the model it is read from, 0 if it is not a model weight
+  uint64_t weight_id() const { return weight_id_; }
+
+  void set_weight_id(uint64_t weight_id) { weight_id_ = weight_id; }
+
   void Prepare() {
     if (allocator_ != nullptr) {
       data_ = allocator_->Prepare(data_);
@@ -167,6 +190,11 @@ class Tensor : public mindspore::tensor::MSTensor {
   std::vector<QuantArg> quant_params_;
   std::vector<float> quant_clusters_;
   mindspore::lite::Allocator *allocator_ = nullptr;
+  const void *packed_data_ = nullptr;
+  size_t packed_size_ = 0;
+  std::string packed_layout_;
+  std::shared_ptr<const char> packed_data_holder_ = nullptr;
+  uint64_t weight_id_ = 0;
 };
 
 inline size_t DataTypeSize(const TypeId type) {
@@ -17,8 +17,10 @@
 #include "src/train/train_session.h"
 #include <sys/stat.h>
 #include <algorithm>
+#include <cmath>
 #include <utility>
 #include <vector>
+#include <unordered_set>
 #include <iostream>
 #include <fstream>
 #include <memory>
@@ -127,6 +129,9 @@ int TrainSession::RunGraph(const KernelCallBack &before, const KernelCallBack &a
     MS_LOG(ERROR) << "context is null";
     return lite::RET_NULL_PTR;
   }
+  if (memory_saving_) {
+    return RunMemorySavingSteps(train_mode_ ? train_steps_ : eval_steps_, before, after);
+  }
   auto run_kernel = (train_mode_) ? train_kernels_ : inference_kernels_;
   lite::CpuExecutor executor;
   if (before == nullptr && after == nullptr) {
@@ -192,6 +197,267 @@ int TrainSession::Eval() {
   return RET_OK;
 }
 
+int TrainSession::SetMemorySaving(bool enable, int checkpoint_interval) {
+  memory_saving_ = false;
+  train_steps_.clear();
+  eval_steps_.clear();
+  if (!enable) {
+    return RET_OK;
+  }
+  checkpoint_interval_ = checkpoint_interval;
+  auto ret =
+    CompileMemorySavingSteps(train_kernels_, train_output_node_map_, train_output_tensor_map_, true, &train_steps_);
+  if (ret != RET_OK) {
+    MS_LOG(ERROR) << "Compile memory saving steps of train mode failed";
+    train_steps_.clear();
+    return ret;
+  }
+  ret = CompileMemorySavingSteps(inference_kernels_, eval_output_node_map_, eval_output_tensor_map_, false,
+                                 &eval_steps_);
+  if (ret != RET_OK) {
+    MS_LOG(ERROR) << "Compile memory saving steps of eval mode failed";
+    train_steps_.clear();
+    eval_steps_.clear();
+    return ret;
+  }
+  memory_saving_ = true;
+  return RET_OK;
+}
+
+int TrainSession::CompileMemorySavingSteps(
+  const std::vector<kernel::LiteKernel *> &kernels,
+  const std::unordered_map<std::string, std::vector<mindspore::tensor::MSTensor *>> &output_node_map,
+  const std::unordered_map<std::string, mindspore::tensor::MSTensor *> &output_tensor_map, bool train_mode,
+  std::vector<MemorySavingStep> *steps) {
+  if (kernels.empty()) {
+    MS_LOG(ERROR) << "No kernel to run";
+    return RET_ERROR;
+  }
+  // inputs, outputs and weights outlive RunGraph, the other tensors only live between their write and last read
+  std::unordered_set<lite::Tensor *> persistent(inputs_.begin(), inputs_.end());
+  for (auto &node : output_node_map) {
+    for (auto tensor : node.second) {
+      persistent.insert(static_cast<lite::Tensor *>(tensor));
+    }
+  }
+  for (auto &tensor : output_tensor_map) {
+    persistent.insert(static_cast<lite::Tensor *>(tensor.second));
+  }
+  auto is_transient = [&persistent](lite::Tensor *tensor) {
+    return tensor->category() == lite::Tensor::VAR && persistent.find(tensor) == persistent.end();
+  };
+
+  // forward kernels of train mode, split into segments run again as a whole
+  std::vector<std::vector<kernel::LiteKernel *>> segments;
+  std::unordered_map<kernel::LiteKernel *, size_t> segment_index;
+  if (train_mode && checkpoint_interval_ >= 0 && inference_kernels_.size() < kernels.size()) {
+    std::vector<kernel::LiteKernel *> forward;
+    std::copy_if(kernels.begin(), kernels.end(), std::back_inserter(forward),
+                 [this](kernel::LiteKernel *kernel) { return IsContain(inference_kernels_, kernel); });
+    size_t interval = checkpoint_interval_ > 0 ? static_cast<size_t>(checkpoint_interval_)
+                                               : static_cast<size_t>(std::ceil(std::sqrt(forward.size())));
+    for (size_t i = 0; i < forward.size(); i++) {
+      if (i % interval == 0) {
+        segments.emplace_back();
+      }
+      segments.back().push_back(forward[i]);
+      segment_index[forward[i]] = segments.size() - 1;
+    }
+  }
+
+  // outputs of a segment read in the forward pass by its own kernels only are dropped after their last forward read
+  // and recomputed before their first backward read: tensor -- its segment
+  std::unordered_map<lite::Tensor *, size_t> dropped;
+  for (size_t s = 0; s < segments.size(); s++) {
+    if (!std::all_of(segments[s].begin(), segments[s].end(),
+                     [this](const kernel::LiteKernel *kernel) { return IsRecomputable(kernel); })) {
+      continue;
+    }
+    for (auto producer : segments[s]) {
+      for (auto tensor : producer->out_tensors()) {
+        if (!is_transient(tensor)) {
+          continue;
+        }
+        bool droppable = true;
+        size_t last_forward_read = 0;
+        size_t first_backward_read = kernels.size();
+        for (size_t i = 0; i < kernels.size() && droppable; i++) {
+          if (!IsContain(kernels[i]->in_tensors(), tensor)) {
+            continue;
+          }
+          auto iter = segment_index.find(kernels[i]);
+          if (iter == segment_index.end()) {
+            droppable = !IsLossKernel(kernels[i]);
+            first_backward_read = std::min(first_backward_read, i);
+          } else {
+            droppable = iter->second == s;
+            last_forward_read = i;
+          }
+        }
+        if (droppable && last_forward_read < first_backward_read && first_backward_read < kernels.size()) {
+          dropped[tensor] = s;
+        }
+      }
+    }
+  }
+
+  steps->clear();
+  std::vector<bool> recomputed(segments.size(), false);
+  for (auto kernel : kernels) {
+    if (segment_index.find(kernel) == segment_index.end()) {
+      for (auto tensor : kernel->in_tensors()) {
+        auto iter = dropped.find(tensor);
+        if (iter == dropped.end() || recomputed[iter->second]) {
+          continue;
+        }
+        recomputed[iter->second] = true;
+        for (auto forward_kernel : segments[iter->second]) {
+          MemorySavingStep step;
+          step.kernel = forward_kernel;
+          step.recompute = true;
+          steps->push_back(step);
+        }
+      }
+    }
+    MemorySavingStep step;
+    step.kernel = kernel;
+    steps->push_back(step);
+  }
+
+  // a transient tensor is freed after an access not followed by a read, its next access if any writes it again
+  std::unordered_map<lite::Tensor *, bool> read_later;
+  for (auto step = steps->rbegin(); step != steps->rend(); ++step) {
+    auto &in_tensors = step->kernel->in_tensors();
+    auto &out_tensors = step->kernel->out_tensors();
+    for (auto tensors : {&in_tensors, &out_tensors}) {
+      for (auto tensor : *tensors) {
+        auto iter = read_later.find(tensor);
+        if (is_transient(tensor) && (iter == read_later.end() || !iter->second) &&
+            !IsContain(step->free_tensors, tensor)) {
+          step->free_tensors.push_back(tensor);
+        }
+      }
+    }
+    for (auto tensor : out_tensors) {
+      read_later[tensor] = false;
+    }
+    for (auto tensor : in_tensors) {
+      read_later[tensor] = true;
+    }
+  }
+
+  // gradients dying at an element-wise grad kernel hold its output, forward activations are not reused as a recompute
+  // may write them again
+  std::unordered_set<lite::Tensor *> activations;
+  for (auto kernel : inference_kernels_) {
+    activations.insert(kernel->out_tensors().begin(), kernel->out_tensors().end());
+  }
+  size_t recompute_num = 0;
+  size_t in_place_num = 0;
+  for (auto &step : *steps) {
+    recompute_num += step.recompute ? 1 : 0;
+    if (!train_mode || step.recompute || !IsInPlaceGrad(step.kernel) || step.kernel->out_tensors().size() != 1 ||
+        !is_transient(step.kernel->out_tensors().front())) {
+      continue;
+    }
+    auto &in_tensors = step.kernel->in_tensors();
+    for (auto tensor : in_tensors) {
+      if (is_transient(tensor) && activations.find(tensor) == activations.end() &&
+          IsContain(step.free_tensors, tensor) && std::count(in_tensors.begin(), in_tensors.end(), tensor) == 1 &&
+          tensor != step.kernel->out_tensors().front()) {
+        step.in_place_tensor = tensor;
+        in_place_num++;
+        break;
+      }
+    }
+  }
+
+  // transient bytes kept by the steps at most, against every transient tensor kept alive without memory saving
+  std::unordered_set<lite::Tensor *> live;
+  std::unordered_set<lite::Tensor *> all_transient;
+  size_t live_size = 0;
+  size_t peak_size = 0;
+  for (auto &step : *steps) {
+    if (step.in_place_tensor != nullptr && live.erase(step.in_place_tensor) > 0) {
+      live_size -= step.in_place_tensor->Size();
+    }
+    for (auto tensor : step.kernel->out_tensors()) {
+      if (is_transient(tensor) && live.insert(tensor).second) {
+        live_size += tensor->Size();
+      }
+      if (is_transient(tensor)) {
+        all_transient.insert(tensor);
+      }
+    }
+    peak_size = std::max(peak_size, live_size);
+    for (auto tensor : step.free_tensors) {
+      if (live.erase(tensor) > 0) {
+        live_size -= tensor->Size();
+      }
+    }
+  }
+  size_t total_size = 0;
+  for (auto tensor : all_transient) {
+    total_size += tensor->Size();
+  }
+  MS_LOG(INFO) << (train_mode ? "Train" : "Eval") << " memory saving steps: " << steps->size()
+               << ", recomputed kernels: " << recompute_num << ", in place gradients: " << in_place_num
+               << ", peak transient size: " << peak_size << ", transient size without memory saving: " << total_size;
+  return RET_OK;
+}
+
+int TrainSession::RunMemorySavingSteps(const std::vector<MemorySavingStep> &steps, const KernelCallBack &before,
+                                       const KernelCallBack &after) {
+  auto ret = Executor::CheckInputs(this->inputs_);
+  if (ret != RET_OK) {
+    MS_LOG(ERROR) << "CheckInputs failed";
+    return ret;
+  }
+  // the steps free the tensors, PostProcess and its reference counting are not used
+  for (auto &step : steps) {
+    auto kernel = step.kernel;
+    lite::Tensor *in_place_tensor = nullptr;
+    if (step.in_place_tensor != nullptr) {
+      auto out_tensor = kernel->out_tensors().front();
+      auto primitive = kernel->GetPrimitive();
+      if ((primitive == nullptr || primitive->infer_flag()) && step.in_place_tensor->data_c() != nullptr &&
+          step.in_place_tensor->data_type() == out_tensor->data_type() &&
+          step.in_place_tensor->Size() == out_tensor->Size()) {
+        out_tensor->FreeData();
+        out_tensor->set_allocator(step.in_place_tensor->allocator());
+        out_tensor->set_data(step.in_place_tensor->data_c());
+        in_place_tensor = step.in_place_tensor;
+      }
+    }
+    ret = kernel->PreProcess();
+    if (ret == RET_OK) {
+      ret = kernel->Run(before, after);
+    }
+    if (in_place_tensor != nullptr) {
+      in_place_tensor->set_data(nullptr);
+    }
+    if (ret != RET_OK) {
+      MS_LOG(ERROR) << "run kernel failed, name: " << kernel->name() << (step.recompute ? " (recompute)" : "");
+      return ret;
+    }
+    for (auto tensor : step.free_tensors) {
+      tensor->FreeData();
+    }
+  }
+  return RET_OK;
+}
+
+bool TrainSession::IsRecomputable(const kernel::LiteKernel *kernel) const {
+  // kernels updating statistics or drawing random masks in train mode give other results when run again
+  return !(kernel->Type() == schema::PrimitiveType_BatchNorm || kernel->Type() == schema::PrimitiveType_FusedBatchNorm ||
+           kernel->Type() == schema::PrimitiveType_Dropout || IsLossKernel(kernel));
+}
+
+bool TrainSession::IsInPlaceGrad(const kernel::LiteKernel *kernel) const {
+  return (kernel->Type() == schema::PrimitiveType_ActivationGrad ||
+          kernel->Type() == schema::PrimitiveType_DropoutGrad || kernel->Type() == schema::PrimitiveType_NegGrad);
+}
+
 void TrainSession::CompileEvalOutputs() {
   eval_output_node_map_.clear();
   eval_output_tensor_map_.clear();
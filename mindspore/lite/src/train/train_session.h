@@ -59,6 +59,7 @@ class TrainSession : virtual public session::TrainSession, virtual public lite::
 
   int Train() override;
   int Eval() override;
+  int SetMemorySaving(bool enable, int checkpoint_interval = 0) override;
 
   void BindThread(bool if_bind) override { return lite::LiteSession::BindThread(if_bind); }
   std::vector<tensor::MSTensor *> GetInputs() const override { return lite::LiteSession::GetInputs(); }
@@ -93,6 +94,26 @@ class TrainSession : virtual public session::TrainSession, virtual public lite::
   virtual void CompileTrainOutputs();
   virtual void CompileEvalOutputs();
 
+  // A kernel run of the memory saving mode. Forward kernels dropping their outputs are run a second time, marked as
+  // recompute, right before the backward kernel first reading one of them.
+  struct MemorySavingStep {
+    kernel::LiteKernel *kernel = nullptr;
+    bool recompute = false;
+    // input whose buffer the first output takes over, as it is not used after the step
+    lite::Tensor *in_place_tensor = nullptr;
+    // tensors freed after the step
+    std::vector<lite::Tensor *> free_tensors;
+  };
+  int CompileMemorySavingSteps(
+    const std::vector<kernel::LiteKernel *> &kernels,
+    const std::unordered_map<std::string, std::vector<mindspore::tensor::MSTensor *>> &output_node_map,
+    const std::unordered_map<std::string, mindspore::tensor::MSTensor *> &output_tensor_map, bool train_mode,
+    std::vector<MemorySavingStep> *steps);
+  int RunMemorySavingSteps(const std::vector<MemorySavingStep> &steps, const KernelCallBack &before,
+                           const KernelCallBack &after);
+  bool IsRecomputable(const kernel::LiteKernel *kernel) const;
+  bool IsInPlaceGrad(const kernel::LiteKernel *kernel) const;
+
   TrainModel *model_ = nullptr;
   std::unordered_map<std::string, std::vector<mindspore::tensor::MSTensor *>> orig_output_node_map_;
   std::unordered_map<std::string, mindspore::tensor::MSTensor *> orig_output_tensor_map_;
@@ -106,6 +127,11 @@ class TrainSession : virtual public session::TrainSession, virtual public lite::
   std::vector<kernel::LiteKernel *> inference_kernels_;
   std::vector<kernel::LiteKernel *> train_kernels_;
 
+  bool memory_saving_ = false;
+  int checkpoint_interval_ = 0;
+  std::vector<MemorySavingStep> train_steps_;
+  std::vector<MemorySavingStep> eval_steps_;
+
  private:
   void BuildInferenceKernelsRecursive(kernel::LiteKernel *ker, std::vector<kernel::LiteKernel *> *req_kernels);
 };
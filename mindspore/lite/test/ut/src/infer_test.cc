@@ -14,8 +14,13 @@
  * limitations under the License.
  */
 
+#include <chrono>
 #include <cmath>
+#include <cstdio>
+#include <fstream>
 #include <memory>
+#include <string>
+#include <vector>
 #include "schema/inner/model_generated.h"
 #include "mindspore/lite/include/model.h"
 #include "common/common_test.h"
@@ -24,7 +29,12 @@
 #include "include/errorcode.h"
 #include "src/common/log_adapter.h"
 #include "src/lite_session.h"
+#include "src/model_common.h"
 #include "src/runtime/parallel_executor.h"
+#include "src/runtime/kernel/arm/base/packed_weight_cache.h"
+#include "src/runtime/kernel/arm/base/kernel_tuner.h"
+#include "nnacl/op_base.h"
+#include "nnacl/fp32/matmul_fp32.h"
 
 namespace mindspore {
 class InferTest : public mindspore::CommonTest {
@@ -328,6 +338,568 @@ TEST_F(InferTest, TestParallelExecutor) {
   MS_LOG(INFO) << "Passed";
 }
 
+class SessionWithStaticMemoryPlan : public lite::LiteSession {
+ public:
+  SessionWithStaticMemoryPlan() = default;
+  const lite::StaticMemoryPlanner &memory_planner() const { return this->memory_planner_; }
+  size_t context_allocator_size() const { return this->context_->allocator->GetTotalSize(); }
+  size_t resize_plan_num() const { return this->resize_plans_.size(); }
+  bool has_resize_plan(const std::vector<std::vector<int>> &dims) const {
+    return this->resize_plan_map_.count(InputShapeKey(dims)) > 0;
+  }
+  size_t arena_capacity() const { return this->static_allocator_->arena_capacity(); }
+  void ReleaseStaticMemoryPlan() { lite::LiteSession::ReleaseStaticMemoryPlan(); }
+};
+
+// in0 + in1 -> t2, t2 + in1 -> t3, ..., the last Add writes the graph output
+lite::Model *BuildAddChainModel(int node_num) {
+  auto meta_graph = std::make_shared<schema::MetaGraphT>();
+  meta_graph->name = "graph";
+  for (int i = 0; i < node_num; i++) {
+    auto node = std::make_unique<schema::CNodeT>();
+    node->inputIndex = {static_cast<uint32_t>(i == 0 ? 0 : i + 1), 1};
+    node->outputIndex = {static_cast<uint32_t>(i + 2)};
+    node->primitive = std::make_unique<schema::PrimitiveT>();
+    node->primitive->value.type = schema::PrimitiveType_Add;
+    node->primitive->value.value = new schema::AddT;
+    node->name = "Add" + std::to_string(i);
+    meta_graph->nodes.emplace_back(std::move(node));
+  }
+  meta_graph->inputIndex = {0, 1};
+  meta_graph->outputIndex = {static_cast<uint32_t>(node_num + 1)};
+  for (int i = 0; i < node_num + 2; i++) {
+    auto tensor = std::make_unique<schema::TensorT>();
+    tensor->nodeType = i < 2 ? schema::NodeType::NodeType_ValueNode : schema::NodeType::NodeType_Parameter;
+    tensor->format = schema::Format_NHWC;
+    tensor->dataType = TypeId::kNumberTypeFloat32;
+    if (i < 2) {
+      tensor->dims = {1, 28, 28, 3};
+    }
+    tensor->offset = -1;
+    meta_graph->allTensors.emplace_back(std::move(tensor));
+  }
+  flatbuffers::FlatBufferBuilder builder(1024);
+  auto offset = schema::MetaGraph::Pack(builder, meta_graph.get());
+  builder.Finish(offset);
+  return lite::Model::Import(reinterpret_cast<char *>(builder.GetBufferPointer()), builder.GetSize());
+}
+
+std::vector<float> RunAddChain(session::LiteSession *session) {
+  auto inputs = session->GetInputs();
+  for (size_t i = 0; i < inputs.size(); i++) {
+    auto data = reinterpret_cast<float *>(inputs[i]->MutableData());
+    for (int j = 0; j < inputs[i]->ElementsNum(); j++) {
+      data[j] = static_cast<float>((j % 17) * (i + 1)) * 0.25f;
+    }
+  }
+  if (session->RunGraph() != lite::RET_OK) {
+    return {};
+  }
+  auto out_tensor = session->GetOutputs().begin()->second;
+  auto out_data = reinterpret_cast<float *>(out_tensor->MutableData());
+  return std::vector<float>(out_data, out_data + out_tensor->ElementsNum());
+}
+
+TEST_F(InferTest, TestStaticMemoryPlan) {
+  constexpr int kNodeNum = 6;
+  auto model = BuildAddChainModel(kNodeNum);
+  ASSERT_NE(nullptr, model);
+  // each session owns its own allocator
+  lite::Context context;
+  context.device_list_[0].device_info_.cpu_device_info_.cpu_bind_mode_ = lite::NO_BIND;
+  context.thread_num_ = 2;
+
+  lite::Context dynamic_context = context;
+  dynamic_context.enable_static_memory_plan_ = false;
+  auto dynamic_session = new SessionWithStaticMemoryPlan();
+  ASSERT_EQ(lite::RET_OK, dynamic_session->Init(&dynamic_context));
+  ASSERT_EQ(lite::RET_OK, dynamic_session->CompileGraph(model));
+  ASSERT_TRUE(dynamic_session->memory_planner().plans().empty());
+  auto expect = RunAddChain(dynamic_session);
+  ASSERT_EQ(28 * 28 * 3, expect.size());
+  auto dynamic_size = dynamic_session->context_allocator_size();
+
+  auto static_session = new SessionWithStaticMemoryPlan();
+  ASSERT_EQ(lite::RET_OK, static_session->Init(&context));
+  ASSERT_EQ(lite::RET_OK, static_session->CompileGraph(model));
+  auto &planner = static_session->memory_planner();
+  // every Add output but the graph output is planned
+  ASSERT_EQ(kNodeNum - 1, planner.plans().size());
+  ASSERT_GE(planner.arena_size(), planner.peak_live_size());
+  ASSERT_LT(planner.arena_size(), planner.total_tensor_size());
+  ASSERT_LE(planner.arena_size(), dynamic_size);
+  std::vector<void *> planned_data;
+  for (auto &plan : planner.plans()) {
+    planned_data.push_back(plan.tensor->data_c());
+  }
+  ASSERT_EQ(expect, RunAddChain(static_session));
+  // the second run reuses the planned buffers and still gives the same result
+  ASSERT_EQ(expect, RunAddChain(static_session));
+  for (size_t i = 0; i < planner.plans().size(); i++) {
+    ASSERT_EQ(planned_data[i], planner.plans()[i].tensor->data_c());
+  }
+  MS_LOG(INFO) << "static arena size: " << planner.arena_size() << ", dynamic allocator size: " << dynamic_size;
+
+  // resize re-plans the arena for the new shapes
+  auto old_arena_size = planner.arena_size();
+  std::vector<std::vector<int>> dims = {{1, 14, 14, 3}, {1, 14, 14, 3}};
+  ASSERT_EQ(lite::RET_OK, dynamic_session->Resize(dynamic_session->GetInputs(), dims));
+  ASSERT_EQ(lite::RET_OK, static_session->Resize(static_session->GetInputs(), dims));
+  ASSERT_EQ(kNodeNum - 1, planner.plans().size());
+  ASSERT_LT(planner.arena_size(), old_arena_size);
+  expect = RunAddChain(dynamic_session);
+  ASSERT_EQ(14 * 14 * 3, expect.size());
+  ASSERT_EQ(expect, RunAddChain(static_session));
+
+  delete static_session;
+  delete dynamic_session;
+  delete model;
+}
+
+TEST_F(InferTest, TestStaticAllocatorFreeData) {
+  lite::StaticAllocator allocator;
+  ASSERT_EQ(lite::RET_OK, allocator.MallocArena(256));
+  // a planned tensor keeps its arena buffer
+  lite::Tensor planned(kNumberTypeFloat32, {4});
+  planned.set_allocator(&allocator);
+  planned.set_data(allocator.GetBuffer(64));
+  ASSERT_EQ(lite::RET_OK, planned.FreeData());
+  ASSERT_EQ(allocator.GetBuffer(64), planned.data_c());
+  planned.set_data(nullptr);
+  // a tensor outside of the plan falls back to malloc, its buffer is freed like a dynamic one
+  lite::Tensor fallback(kNumberTypeFloat32, {4});
+  fallback.set_allocator(&allocator);
+  ASSERT_EQ(lite::RET_OK, fallback.MallocData());
+  ASSERT_NE(nullptr, fallback.data_c());
+  ASSERT_FALSE(allocator.IsArenaBuffer(fallback.data_c()));
+  ASSERT_EQ(lite::RET_OK, fallback.FreeData());
+  ASSERT_EQ(nullptr, fallback.data_c());
+}
+
+TEST_F(InferTest, TestReleaseStaticMemoryPlanFreesFallback) {
+  auto model = BuildAddChainModel(4);
+  ASSERT_NE(nullptr, model);
+  lite::Context context;
+  context.device_list_[0].device_info_.cpu_device_info_.cpu_bind_mode_ = lite::NO_BIND;
+  auto session = new SessionWithStaticMemoryPlan();
+  ASSERT_EQ(lite::RET_OK, session->Init(&context));
+  ASSERT_EQ(lite::RET_OK, session->CompileGraph(model));
+  auto &planner = session->memory_planner();
+  ASSERT_LE(2, planner.plans().size());
+  // a planned tensor that fell back to malloc, as after an unexpected shape change
+  auto fallback = planner.plans().front().tensor;
+  auto arena_tensor = planner.plans().back().tensor;
+  fallback->set_data(nullptr);
+  ASSERT_EQ(lite::RET_OK, fallback->MallocData());
+  ASSERT_NE(nullptr, fallback->data_c());
+  ASSERT_NE(nullptr, arena_tensor->data_c());
+  session->ReleaseStaticMemoryPlan();
+  // the fallback buffer is freed (checked by the leak sanitizer), the arena buffer is only unbound
+  ASSERT_EQ(nullptr, fallback->data_c());
+  ASSERT_EQ(nullptr, arena_tensor->data_c());
+  ASSERT_TRUE(planner.plans().empty());
+
+  delete session;
+  delete model;
+}
+
+TEST_F(InferTest, TestResizePlanCache) {
+  constexpr int kNodeNum = 6;
+  auto model = BuildAddChainModel(kNodeNum);
+  ASSERT_NE(nullptr, model);
+  lite::Context context;
+  context.device_list_[0].device_info_.cpu_device_info_.cpu_bind_mode_ = lite::NO_BIND;
+  context.thread_num_ = 2;
+  auto session = new SessionWithStaticMemoryPlan();
+  ASSERT_EQ(lite::RET_OK, session->Init(&context));
+  ASSERT_EQ(lite::RET_OK, session->CompileGraph(model));
+  // the compiled shapes are cached too
+  ASSERT_EQ(1, session->resize_plan_num());
+  auto &planner = session->memory_planner();
+  std::vector<void *> planned_data;
+  for (auto &plan : planner.plans()) {
+    planned_data.push_back(plan.tensor->data_c());
+  }
+  auto expect_large = RunAddChain(session);
+  ASSERT_EQ(28 * 28 * 3, expect_large.size());
+  auto large_arena_size = planner.arena_size();
+
+  std::vector<std::vector<int>> small_dims = {{1, 14, 14, 3}, {1, 14, 14, 3}};
+  std::vector<std::vector<int>> large_dims = {{1, 28, 28, 3}, {1, 28, 28, 3}};
+  ASSERT_EQ(lite::RET_OK, session->Resize(session->GetInputs(), small_dims));
+  ASSERT_EQ(2, session->resize_plan_num());
+  auto expect_small = RunAddChain(session);
+  ASSERT_EQ(14 * 14 * 3, expect_small.size());
+  for (int i = 0; i < 3; i++) {
+    // restored from the cache, with the same results and the same planned buffers
+    ASSERT_EQ(lite::RET_OK, session->Resize(session->GetInputs(), large_dims));
+    ASSERT_EQ(kNodeNum - 1, planner.plans().size());
+    for (size_t j = 0; j < planner.plans().size(); j++) {
+      ASSERT_EQ(planned_data[j], planner.plans()[j].tensor->data_c());
+    }
+    ASSERT_EQ(expect_large, RunAddChain(session));
+    ASSERT_EQ(lite::RET_OK, session->Resize(session->GetInputs(), small_dims));
+    ASSERT_EQ(expect_small, RunAddChain(session));
+    ASSERT_EQ(2, session->resize_plan_num());
+  }
+  // the least recently used shapes are dropped
+  for (int i = 1; i <= 10; i++) {
+    std::vector<std::vector<int>> dims = {{1, i, 2, 3}, {1, i, 2, 3}};
+    ASSERT_EQ(lite::RET_OK, session->Resize(session->GetInputs(), dims));
+    ASSERT_EQ(static_cast<size_t>(i * 2 * 3), RunAddChain(session).size());
+  }
+  ASSERT_EQ(8, session->resize_plan_num());
+  // the arena grown for the dropped large shapes is given back
+  ASSERT_GE(session->arena_capacity(), planner.arena_size());
+  ASSERT_LT(session->arena_capacity(), large_arena_size);
+  // shapes failing to resize drop no plan
+  std::vector<std::vector<int>> least_recent_dims = {{1, 3, 2, 3}, {1, 3, 2, 3}};
+  ASSERT_TRUE(session->has_resize_plan(least_recent_dims));
+  std::vector<std::vector<int>> invalid_dims = {{1, 4, 2, 3}, {1, 5, 2, 3}};
+  ASSERT_NE(lite::RET_OK, session->Resize(session->GetInputs(), invalid_dims));
+  ASSERT_EQ(8, session->resize_plan_num());
+  ASSERT_TRUE(session->has_resize_plan(least_recent_dims));
+  ASSERT_EQ(static_cast<size_t>(10 * 2 * 3), RunAddChain(session).size());
+
+  delete session;
+  delete model;
+}
+
+// branch_num independent chains of depth Add nodes on in0 and in1, summed up by a chain of Add nodes like the
+// concatenated branches of an Inception block
+lite::Model *BuildMultiBranchAddModel(int branch_num, int depth, const std::vector<int> &dims) {
+  auto meta_graph = std::make_shared<schema::MetaGraphT>();
+  meta_graph->name = "graph";
+  uint32_t tensor_num = 2;
+  auto add_node = [&](uint32_t in0, uint32_t in1) {
+    auto node = std::make_unique<schema::CNodeT>();
+    node->inputIndex = {in0, in1};
+    node->outputIndex = {tensor_num};
+    node->primitive = std::make_unique<schema::PrimitiveT>();
+    node->primitive->value.type = schema::PrimitiveType_Add;
+    node->primitive->value.value = new schema::AddT;
+    node->name = "Add" + std::to_string(meta_graph->nodes.size());
+    meta_graph->nodes.emplace_back(std::move(node));
+    return tensor_num++;
+  };
+  std::vector<uint32_t> branch_outputs;
+  for (int i = 0; i < branch_num; i++) {
+    auto output = add_node(0, 1);
+    for (int j = 1; j < depth; j++) {
+      output = add_node(output, 1);
+    }
+    branch_outputs.push_back(output);
+  }
+  auto output = branch_outputs.front();
+  for (int i = 1; i < branch_num; i++) {
+    output = add_node(output, branch_outputs[i]);
+  }
+  meta_graph->inputIndex = {0, 1};
+  meta_graph->outputIndex = {output};
+  for (uint32_t i = 0; i < tensor_num; i++) {
+    auto tensor = std::make_unique<schema::TensorT>();
+    tensor->nodeType = i < 2 ? schema::NodeType::NodeType_ValueNode : schema::NodeType::NodeType_Parameter;
+    tensor->format = schema::Format_NHWC;
+    tensor->dataType = TypeId::kNumberTypeFloat32;
+    if (i < 2) {
+      tensor->dims = dims;
+    }
+    tensor->offset = -1;
+    meta_graph->allTensors.emplace_back(std::move(tensor));
+  }
+  flatbuffers::FlatBufferBuilder builder(1024);
+  auto offset = schema::MetaGraph::Pack(builder, meta_graph.get());
+  builder.Finish(offset);
+  return lite::Model::Import(reinterpret_cast<char *>(builder.GetBufferPointer()), builder.GetSize());
+}
+
+TEST_F(InferTest, TestParallelExecutorMultiBranch) {
+  auto model = BuildMultiBranchAddModel(4, 8, {1, 112, 112, 32});
+  ASSERT_NE(nullptr, model);
+  lite::Context context;
+  context.device_list_[0].device_info_.cpu_device_info_.cpu_bind_mode_ = lite::NO_BIND;
+  context.thread_num_ = 4;
+  auto sequential_session = session::LiteSession::CreateSession(&context);
+  ASSERT_NE(nullptr, sequential_session);
+  ASSERT_EQ(lite::RET_OK, sequential_session->CompileGraph(model));
+  context.enable_parallel_ = true;
+  auto parallel_session = session::LiteSession::CreateSession(&context);
+  ASSERT_NE(nullptr, parallel_session);
+  ASSERT_EQ(lite::RET_OK, parallel_session->CompileGraph(model));
+
+  auto expect = RunAddChain(sequential_session);
+  ASSERT_EQ(112 * 112 * 32, expect.size());
+  ASSERT_EQ(expect, RunAddChain(parallel_session));
+
+  constexpr int kLoopCount = 20;
+  for (auto session : {sequential_session, parallel_session}) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < kLoopCount; i++) {
+      ASSERT_EQ(lite::RET_OK, session->RunGraph());
+    }
+    auto cost = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    MS_LOG(INFO) << (session == parallel_session ? "parallel" : "sequential")
+                 << " executor, average cost: " << cost / kLoopCount << " ms";
+  }
+  ASSERT_EQ(expect, RunAddChain(parallel_session));
+
+  delete parallel_session;
+  delete sequential_session;
+  delete model;
+}
+
+// 3x3 stride 2 Conv2D followed by a 1x1 Conv2D, both packing their constant weights at Init
+std::shared_ptr<schema::MetaGraphT> BuildConvChainGraph(float weight_scale) {
+  auto meta_graph = std::make_shared<schema::MetaGraphT>();
+  meta_graph->name = "graph";
+  auto add_conv = [&](uint32_t input, uint32_t weight, uint32_t output, int channel_in, int channel_out, int kernel,
+                      int stride) {
+    auto node = std::make_unique<schema::CNodeT>();
+    node->inputIndex = {input, weight};
+    node->outputIndex = {output};
+    node->primitive = std::make_unique<schema::PrimitiveT>();
+    node->primitive->value.type = schema::PrimitiveType_Conv2D;
+    auto primitive = new schema::Conv2DT;
+    primitive->padMode = schema::PadMode_SAME_UPPER;
+    primitive->channelIn = channel_in;
+    primitive->channelOut = channel_out;
+    primitive->format = schema::Format_NHWC;
+    primitive->strideH = stride;
+    primitive->strideW = stride;
+    primitive->kernelH = kernel;
+    primitive->kernelW = kernel;
+    primitive->dilateH = 1;
+    primitive->dilateW = 1;
+    primitive->group = 1;
+    node->primitive->value.value = primitive;
+    node->name = "Conv2D" + std::to_string(meta_graph->nodes.size());
+    meta_graph->nodes.emplace_back(std::move(node));
+  };
+  add_conv(0, 1, 2, 3, 16, 3, 2);
+  add_conv(2, 3, 4, 16, 8, 1, 1);
+  meta_graph->inputIndex = {0};
+  meta_graph->outputIndex = {4};
+  const std::vector<std::vector<int>> weight_dims = {{16, 3, 3, 3}, {8, 1, 1, 16}};
+  for (uint32_t i = 0; i < 5; i++) {
+    auto tensor = std::make_unique<schema::TensorT>();
+    tensor->nodeType =
+      (i == 2 || i == 4) ? schema::NodeType::NodeType_Parameter : schema::NodeType::NodeType_ValueNode;
+    tensor->format = (i == 1 || i == 3) ? schema::Format_KHWC : schema::Format_NHWC;
+    tensor->dataType = TypeId::kNumberTypeFloat32;
+    if (i == 0) {
+      tensor->dims = {1, 14, 14, 3};
+    } else if (i == 1 || i == 3) {
+      tensor->dims = weight_dims[i / 2];
+      int element_num = 1;
+      for (auto dim : tensor->dims) {
+        element_num *= dim;
+      }
+      std::vector<float> weight(element_num);
+      for (int j = 0; j < element_num; j++) {
+        weight[j] = static_cast<float>((j * (i + 2)) % 11 - 5) * weight_scale;
+      }
+      tensor->data.resize(element_num * sizeof(float));
+      memcpy(tensor->data.data(), weight.data(), tensor->data.size());
+    }
+    tensor->offset = -1;
+    meta_graph->allTensors.emplace_back(std::move(tensor));
+  }
+  return meta_graph;
+}
+
+std::string SerializeGraph(const schema::MetaGraphT *meta_graph) {
+  flatbuffers::FlatBufferBuilder builder(1024);
+  auto offset = schema::MetaGraph::Pack(builder, meta_graph);
+  builder.Finish(offset);
+  return std::string(reinterpret_cast<char *>(builder.GetBufferPointer()), builder.GetSize());
+}
+
+#ifndef SUPPORT_TRAIN
+// trained weights change in place, the cache hands out private buffers then
+TEST_F(InferTest, TestPackedWeightCache) {
+  auto model_buf = SerializeGraph(BuildConvChainGraph(0.1f).get());
+  auto model = lite::Model::Import(model_buf.data(), model_buf.size());
+  ASSERT_NE(nullptr, model);
+  // the same model imported again from a mapped file, at another address
+  std::string model_path = "./packed_weight_cache_test.ms";
+  std::ofstream model_file(model_path, std::ios::binary);
+  model_file.write(model_buf.data(), model_buf.size());
+  model_file.close();
+  auto mapped_model = lite::Model::Import(model_path.c_str());
+  ASSERT_NE(nullptr, mapped_model);
+  ASSERT_EQ(model_buf.size(), lite::GetMappedSize(mapped_model));
+  ASSERT_NE(lite::GetModelId(model), lite::GetModelId(mapped_model));
+  ASSERT_EQ(lite::GetModelId(model), lite::GetModelId(model));
+
+  auto cache = kernel::PackedWeightCache::GetInstance();
+  auto base_entry_num = cache->EntryNum();
+  auto base_size = cache->TotalSize();
+  lite::Context context;
+  context.device_list_[0].device_info_.cpu_device_info_.cpu_bind_mode_ = lite::NO_BIND;
+  context.thread_num_ = 2;
+  auto session0 = session::LiteSession::CreateSession(&context);
+  ASSERT_NE(nullptr, session0);
+  ASSERT_EQ(lite::RET_OK, session0->CompileGraph(model));
+  auto entry_num = cache->EntryNum();
+  auto total_size = cache->TotalSize();
+  // one packed weight per Conv2D
+  ASSERT_EQ(base_entry_num + 2, entry_num);
+  ASSERT_GT(total_size, base_size);
+
+  // another session of the same model packs nothing more
+  auto session1 = session::LiteSession::CreateSession(&context);
+  ASSERT_NE(nullptr, session1);
+  ASSERT_EQ(lite::RET_OK, session1->CompileGraph(model));
+  ASSERT_EQ(entry_num, cache->EntryNum());
+  ASSERT_EQ(total_size, cache->TotalSize());
+  // the model imported again is another model, its weights are packed once for its sessions
+  auto session2 = session::LiteSession::CreateSession(&context);
+  ASSERT_NE(nullptr, session2);
+  ASSERT_EQ(lite::RET_OK, session2->CompileGraph(mapped_model));
+  auto session3 = session::LiteSession::CreateSession(&context);
+  ASSERT_NE(nullptr, session3);
+  ASSERT_EQ(lite::RET_OK, session3->CompileGraph(mapped_model));
+  ASSERT_EQ(entry_num + 2, cache->EntryNum());
+  ASSERT_EQ(total_size * 2 - base_size, cache->TotalSize());
+
+  auto expect = RunAddChain(session0);
+  ASSERT_EQ(7 * 7 * 8, expect.size());
+  ASSERT_EQ(expect, RunAddChain(session1));
+  ASSERT_EQ(expect, RunAddChain(session2));
+  ASSERT_EQ(expect, RunAddChain(session3));
+
+  // the packed weights live until the last session using them is deleted
+  delete session0;
+  ASSERT_EQ(entry_num + 2, cache->EntryNum());
+  delete session1;
+  delete session2;
+  ASSERT_EQ(entry_num, cache->EntryNum());
+  delete session3;
+  ASSERT_EQ(base_entry_num, cache->EntryNum());
+  ASSERT_EQ(base_size, cache->TotalSize());
+  delete mapped_model;
+  delete model;
+  std::remove(model_path.c_str());
+}
+
+std::vector<float> RunConvChain(const schema::MetaGraphT *meta_graph, const std::string &tuning_cache_file = "") {
+  auto model_buf = SerializeGraph(meta_graph);
+  auto model = lite::Model::Import(model_buf.data(), model_buf.size());
+  if (model == nullptr) {
+    return {};
+  }
+  lite::Context context;
+  context.device_list_[0].device_info_.cpu_device_info_.cpu_bind_mode_ = lite::NO_BIND;
+  if (!tuning_cache_file.empty()) {
+    context.enable_tuning_ = true;
+    context.tuning_cache_file_ = tuning_cache_file;
+  }
+  auto session = session::LiteSession::CreateSession(&context);
+  std::vector<float> result;
+  if (session != nullptr && session->CompileGraph(model) == lite::RET_OK) {
+    result = RunAddChain(session);
+  }
+  delete session;
+  delete model;
+  return result;
+}
+
+TEST_F(InferTest, TestPrepackedWeight) {
+#ifdef ENABLE_AVX
+  constexpr int kColTile = C16NUM;
+#else
+  constexpr int kColTile = C8NUM;
+#endif
+  auto graph = BuildConvChainGraph(0.1f);
+  auto expect = RunConvChain(graph.get());
+  ASSERT_EQ(7 * 7 * 8, expect.size());
+
+  // weights packed the way the converter stores them are copied by the kernels instead of packed, so a graph of
+  // other weights carrying the packed copies of the weights above gives the same result
+  auto other_graph = BuildConvChainGraph(0.3f);
+  ASSERT_NE(expect, RunConvChain(other_graph.get()));
+  for (auto index : {1, 3}) {
+    auto &weight = graph->allTensors.at(index);
+    int out_channel = weight->dims.at(0);
+    int deep = weight->dims.at(1) * weight->dims.at(2) * weight->dims.at(3);
+    std::vector<float> packed(UP_ROUND(out_channel, kColTile) * deep, 0.0f);
+    auto src = reinterpret_cast<const float *>(weight->data.data());
+    kColTile == C16NUM ? RowMajor2Col16Major(src, packed.data(), out_channel, deep)
+                       : RowMajor2Col8Major(src, packed.data(), out_channel, deep);
+    auto &other_weight = other_graph->allTensors.at(index);
+    other_weight->packedData.resize(packed.size() * sizeof(float));
+    memcpy(other_weight->packedData.data(), packed.data(), other_weight->packedData.size());
+    other_weight->packedLayout = kernel::PackedWeightLayout(true, kColTile, 1, out_channel, deep);
+  }
+  ASSERT_EQ(expect, RunConvChain(other_graph.get()));
+
+  // the packed data of a mapped model file is used in place, and stays mapped after the model is freed
+  std::string model_path = "./prepacked_weight_test.ms";
+  auto model_buf = SerializeGraph(other_graph.get());
+  std::ofstream model_file(model_path, std::ios::binary);
+  model_file.write(model_buf.data(), model_buf.size());
+  model_file.close();
+  auto mapped_model = lite::Model::Import(model_path.c_str());
+  ASSERT_NE(nullptr, mapped_model);
+  auto cache = kernel::PackedWeightCache::GetInstance();
+  auto base_entry_num = cache->EntryNum();
+  auto base_size = cache->TotalSize();
+  lite::Context context;
+  context.device_list_[0].device_info_.cpu_device_info_.cpu_bind_mode_ = lite::NO_BIND;
+  auto session = session::LiteSession::CreateSession(&context);
+  ASSERT_NE(nullptr, session);
+  ASSERT_EQ(lite::RET_OK, session->CompileGraph(mapped_model));
+  ASSERT_EQ(base_entry_num + 2, cache->EntryNum());
+  ASSERT_EQ(base_size, cache->TotalSize());
+  mapped_model->Free();
+  ASSERT_EQ(expect, RunAddChain(session));
+  delete session;
+  ASSERT_EQ(base_entry_num, cache->EntryNum());
+  delete mapped_model;
+  std::remove(model_path.c_str());
+
+  // a layout of another target is ignored
+  for (auto index : {1, 3}) {
+    other_graph->allTensors.at(index)->packedLayout += "_other";
+  }
+  ASSERT_NE(expect, RunConvChain(other_graph.get()));
+}
+
+size_t CountLines(const std::string &file) {
+  std::ifstream ifs(file);
+  size_t count = 0;
+  std::string line;
+  while (std::getline(ifs, line)) {
+    count++;
+  }
+  return count;
+}
+
+TEST_F(InferTest, TestConvTuning) {
+  auto graph = BuildConvChainGraph(0.1f);
+  auto expect = RunConvChain(graph.get());
+  ASSERT_EQ(7 * 7 * 8, expect.size());
+
+  // only the 1x1 convolution has more than one candidate, the 3x3 one of stride 2 runs im2col
+  std::string cache_file = "./conv_tuning_cache.txt";
+  std::remove(cache_file.c_str());
+  ASSERT_EQ(expect, RunConvChain(graph.get(), cache_file));
+  ASSERT_EQ(1, CountLines(cache_file));
+  std::ifstream ifs(cache_file);
+  std::string line;
+  ASSERT_TRUE(static_cast<bool>(std::getline(ifs, line)));
+  ASSERT_EQ(0, line.find(kernel::KernelTuner::CpuModel() + "\t"));
+  ASSERT_NE(std::string::npos, line.find("Conv2D_fp32:n1h7w7c16o8k1x1"));
+  auto candidate = line.substr(line.rfind('\t') + 1);
+  ASSERT_TRUE(candidate == "im2col" || candidate == "1x1");
+
+  // later sessions reuse the result
+  ASSERT_EQ(expect, RunConvChain(graph.get(), cache_file));
+  ASSERT_EQ(1, CountLines(cache_file));
+  std::remove(cache_file.c_str());
+}
+#endif
+
 TEST_F(InferTest, TestModel) {
   auto buf = new char *[1];
   size_t model_size;
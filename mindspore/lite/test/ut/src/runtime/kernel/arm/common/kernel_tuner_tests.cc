@@ -0,0 +1,229 @@
+/**
+ * Copyright 2021 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <typeinfo>
+#include <unordered_map>
+#include <vector>
+#include "common/common_test.h"
+#include "src/lite_kernel.h"
+#include "src/inner_context.h"
+#include "src/ops/conv2d.h"
+#include "src/runtime/kernel/arm/fp32/convolution_depthwise_fp32.h"
+#include "src/runtime/kernel/arm/fp32/convolution_depthwise_slidewindow_fp32.h"
+#include "src/runtime/kernel/arm/fp32/convolution_depthwise_indirect_fp32.h"
+// a tuner of its own reloads the cache file like a new process does
+#define private public
+#include "src/runtime/kernel/arm/base/kernel_tuner.h"
+#undef private
+
+namespace mindspore {
+class TestKernelTuner : public mindspore::CommonTest {
+ public:
+  TestKernelTuner() = default;
+};
+
+namespace {
+// Runs in the time given by its candidate name, "init_fails" and "run_fails" fail.
+class SleepKernel : public kernel::LiteKernel {
+ public:
+  SleepKernel(OpParameter *parameter, const std::string &candidate)
+      : LiteKernel(parameter, {}, {}, nullptr, nullptr), candidate_(candidate) {}
+  ~SleepKernel() override = default;
+
+  int Init() override { return candidate_ == "init_fails" ? lite::RET_ERROR : lite::RET_OK; }
+  int ReSize() override { return lite::RET_OK; }
+  int Run() override {
+    if (candidate_ == "run_fails") {
+      return lite::RET_ERROR;
+    }
+    static const std::map<std::string, int> sleep_ms = {{"fast", 1}, {"slow", 8}};
+    std::this_thread::sleep_for(std::chrono::milliseconds(sleep_ms.at(candidate_)));
+    return lite::RET_OK;
+  }
+
+ private:
+  std::string candidate_;
+};
+
+std::vector<std::string> ReadLines(const std::string &file) {
+  std::ifstream ifs(file);
+  std::vector<std::string> lines;
+  std::string line;
+  while (std::getline(ifs, line)) {
+    lines.push_back(line);
+  }
+  return lines;
+}
+
+std::string SelectSleepKernel(kernel::KernelTuner *tuner, const std::string &cache_file,
+                              const std::string &signature, const std::vector<std::string> &candidates,
+                              std::vector<std::string> *created) {
+  OpParameter parameter = {};
+  return tuner->Select(cache_file, signature, candidates, &parameter, sizeof(OpParameter), {}, {},
+                       [created](const std::string &candidate, OpParameter *param) -> kernel::LiteKernel * {
+                         created->push_back(candidate);
+                         return new (std::nothrow) SleepKernel(param, candidate);
+                       });
+}
+}  // namespace
+
+// The fastest candidate which runs is selected and saved, a new tuner loads it from the cache file without timing.
+TEST_F(TestKernelTuner, SelectAndReloadCache) {
+  std::string cache_file = "./kernel_tuner_test_cache.txt";
+  std::remove(cache_file.c_str());
+  std::string signature = "Sleep:n1t1";
+  std::vector<std::string> candidates = {"slow", "init_fails", "fast", "run_fails"};
+
+  kernel::KernelTuner tuner;
+  std::vector<std::string> created;
+  ASSERT_EQ("fast", SelectSleepKernel(&tuner, cache_file, signature, candidates, &created));
+  ASSERT_EQ(candidates, created);
+  auto lines = ReadLines(cache_file);
+  ASSERT_EQ(1, lines.size());
+  ASSERT_EQ(kernel::KernelTuner::CpuModel() + "\t" + signature + "\tfast", lines[0]);
+  // the same tuner keeps the result
+  created.clear();
+  ASSERT_EQ("fast", SelectSleepKernel(&tuner, cache_file, signature, candidates, &created));
+  ASSERT_TRUE(created.empty());
+
+  // a new tuner, an invalid line and a slower result saved later for the same key, the last one wins
+  {
+    std::ofstream ofs(cache_file, std::ios::app);
+    ofs << "invalid line\n";
+    ofs << kernel::KernelTuner::CpuModel() + "\t" + signature + "\tslow\n";
+  }
+  kernel::KernelTuner reloaded_tuner;
+  ASSERT_EQ("slow", SelectSleepKernel(&reloaded_tuner, cache_file, signature, candidates, &created));
+  ASSERT_TRUE(created.empty());
+  // a saved candidate the node cannot run any more is tuned again
+  ASSERT_EQ("fast", SelectSleepKernel(&reloaded_tuner, cache_file, signature, {"fast", "run_fails"}, &created));
+  ASSERT_EQ(2, created.size());
+  ASSERT_EQ(4, ReadLines(cache_file).size());
+
+  // results of another cpu are not used
+  std::string other_file = "./kernel_tuner_test_other_cpu.txt";
+  {
+    std::ofstream ofs(other_file);
+    ofs << "other cpu\t" + signature + "\tslow\n";
+  }
+  kernel::KernelTuner other_tuner;
+  created.clear();
+  ASSERT_EQ("fast", SelectSleepKernel(&other_tuner, other_file, signature, candidates, &created));
+  ASSERT_EQ(candidates, created);
+  std::remove(cache_file.c_str());
+  std::remove(other_file.c_str());
+}
+
+// 3x3 depthwise convolution of 8 channels on a 10x10 input, pad 0
+TEST_F(TestKernelTuner, ConvDwFp32Tune) {
+  constexpr int kChannel = 8;
+  constexpr int kInputHW = 10;
+  constexpr int kOutputHW = kInputHW - 2;
+  lite::InnerContext ctx;
+  ctx.thread_num_ = 2;
+  ctx.device_list_[0].device_info_.cpu_device_info_.cpu_bind_mode_ = lite::NO_BIND;
+  ASSERT_EQ(lite::RET_OK, ctx.Init());
+  ctx.enable_tuning_ = true;
+  ctx.tuning_cache_file_ = "./conv_dw_tuning_test_cache.txt";
+  std::remove(ctx.tuning_cache_file_.c_str());
+
+  lite::Tensor input(kNumberTypeFloat32, {1, kInputHW, kInputHW, kChannel}, schema::Format_NHWC);
+  lite::Tensor weight(kNumberTypeFloat32, {kChannel, 3, 3, 1}, schema::Format_NHWC, lite::Tensor::CONST_TENSOR);
+  lite::Tensor bias(kNumberTypeFloat32, {kChannel}, schema::Format_NHWC, lite::Tensor::CONST_TENSOR);
+  lite::Tensor output(kNumberTypeFloat32, {1, kOutputHW, kOutputHW, kChannel}, schema::Format_NHWC);
+  for (auto tensor : {&input, &weight, &bias}) {
+    ASSERT_EQ(lite::RET_OK, tensor->MallocData());
+    auto data = reinterpret_cast<float *>(tensor->MutableData());
+    for (int i = 0; i < tensor->ElementsNum(); i++) {
+      data[i] = static_cast<float>(i % 7 - 3) * 0.5f;
+    }
+  }
+  std::vector<lite::Tensor *> inputs = {&input, &weight, &bias};
+  std::vector<lite::Tensor *> outputs = {&output};
+  lite::Conv2D primitive;
+  auto new_conv_param = [&]() {
+    auto conv_param = reinterpret_cast<ConvParameter *>(malloc(sizeof(ConvParameter)));
+    memset(conv_param, 0, sizeof(ConvParameter));
+    conv_param->op_parameter_.type_ = schema::PrimitiveType_DepthwiseConv2D;
+    conv_param->input_batch_ = 1;
+    conv_param->input_h_ = kInputHW;
+    conv_param->input_w_ = kInputHW;
+    conv_param->input_channel_ = kChannel;
+    conv_param->output_batch_ = 1;
+    conv_param->output_h_ = kOutputHW;
+    conv_param->output_w_ = kOutputHW;
+    conv_param->output_channel_ = kChannel;
+    conv_param->kernel_h_ = 3;
+    conv_param->kernel_w_ = 3;
+    conv_param->stride_h_ = 1;
+    conv_param->stride_w_ = 1;
+    conv_param->dilation_h_ = 1;
+    conv_param->dilation_w_ = 1;
+    conv_param->group_ = kChannel;
+    return reinterpret_cast<OpParameter *>(conv_param);
+  };
+
+  // the reference output of the generic kernel
+  auto generic = new kernel::ConvolutionDepthwiseCPUKernel(new_conv_param(), inputs, outputs, &ctx, &primitive);
+  ASSERT_EQ(lite::RET_OK, generic->Init());
+  ASSERT_EQ(lite::RET_OK, generic->Run());
+  auto output_data = reinterpret_cast<float *>(output.MutableData());
+  std::vector<float> expect(output_data, output_data + output.ElementsNum());
+  delete generic;
+
+  // the tuned kernel is the candidate saved for the node, and gives the same output
+  auto tuned = kernel::CpuConvDwFp32KernelTune(inputs, outputs, new_conv_param(), &ctx, &primitive);
+  ASSERT_NE(nullptr, tuned);
+  auto lines = ReadLines(ctx.tuning_cache_file_);
+  ASSERT_EQ(1, lines.size());
+  ASSERT_EQ(0, lines[0].find(kernel::KernelTuner::CpuModel() + "\tDepthwiseConv2D_fp32:n1h10w10c8o8k3x3s1x1"));
+  auto candidate = lines[0].substr(lines[0].rfind('\t') + 1);
+  if (candidate == "sliding_window") {
+    ASSERT_NE(nullptr, dynamic_cast<kernel::ConvolutionDepthwiseSWCPUKernel *>(tuned));
+#ifdef ENABLE_ARM64
+  } else if (candidate == "indirect") {
+    ASSERT_NE(nullptr, dynamic_cast<kernel::ConvolutionDepthwiseIndirectCPUKernel *>(tuned));
+#endif
+  } else {
+    ASSERT_EQ("generic", candidate);
+    ASSERT_NE(nullptr, dynamic_cast<kernel::ConvolutionDepthwiseCPUKernel *>(tuned));
+  }
+  memset(output_data, 0, output.Size());
+  ASSERT_EQ(lite::RET_OK, tuned->Init());
+  ASSERT_EQ(lite::RET_OK, tuned->Run());
+  ASSERT_EQ(0, CompareOutputData(output_data, expect.data(), output.ElementsNum(), 0.0001));
+  std::string tuned_type = typeid(*tuned).name();
+  delete tuned;
+
+  // a second node of the same shapes takes the saved candidate
+  auto again = kernel::CpuConvDwFp32KernelTune(inputs, outputs, new_conv_param(), &ctx, &primitive);
+  ASSERT_NE(nullptr, again);
+  ASSERT_EQ(tuned_type, typeid(*again).name());
+  ASSERT_EQ(1, ReadLines(ctx.tuning_cache_file_).size());
+  delete again;
+  std::remove(ctx.tuning_cache_file_.c_str());
+}
+}  // namespace mindspore
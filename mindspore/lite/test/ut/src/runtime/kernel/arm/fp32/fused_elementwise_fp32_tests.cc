@@ -0,0 +1,191 @@
+/**
+ * Copyright 2021 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include "common/common_test.h"
+#include "nnacl/fp32/activation_fp32.h"
+#include "nnacl/fp32/arithmetic_fp32.h"
+#include "nnacl/fp32/fused_elementwise_fp32.h"
+#include "src/kernel_registry.h"
+#include "src/lite_kernel.h"
+
+namespace mindspore {
+class TestFusedElementwiseFp32 : public mindspore::CommonTest {
+ public:
+  TestFusedElementwiseFp32() {}
+};
+
+// x * channel_scale + y, swish, y / that, relu6, leaky relu, matching the unfused kernels bit for bit
+TEST_F(TestFusedElementwiseFp32, ChainMatchesUnfused) {
+  const int channel = 40;
+  const int num = 5000;
+  const int tile = FUSED_ELEMENTWISE_TILE / channel * channel;
+  std::vector<float> x(num);
+  std::vector<float> y(num);
+  std::vector<float> scale(channel);
+  for (int i = 0; i < num; ++i) {
+    x[i] = static_cast<float>((i * 37) % 101 - 50) / 10;
+    y[i] = static_cast<float>((i * 13) % 17 + 1) / 7;
+  }
+  for (int i = 0; i < channel; ++i) {
+    scale[i] = 0.5f + i * 0.1f;
+  }
+  std::vector<float> repeated_scale(tile);
+  for (int i = 0; i < tile; ++i) {
+    repeated_scale[i] = scale[i % channel];
+  }
+
+  FusedElementwiseParameter param;
+  memset(&param, 0, sizeof(FusedElementwiseParameter));
+  int ops[] = {FusedElementwise_Mul,        FusedElementwise_Add,   FusedElementwise_Swish,
+               FusedElementwise_ReverseDiv, FusedElementwise_Relu6, FusedElementwise_LeakyRelu};
+  param.step_num_ = 6;
+  for (int i = 0; i < param.step_num_; ++i) {
+    param.ops_[i] = ops[i];
+  }
+  param.alpha_[5] = 0.2f;
+  const float *operands[MAX_FUSED_ELEMENTWISE_STEP] = {repeated_scale.data(), y.data(), nullptr, y.data()};
+  bool repeated[MAX_FUSED_ELEMENTWISE_STEP] = {true, false, false, false};
+  std::vector<float> buffer(tile);
+  std::vector<float> output(num);
+  // two parts, as two threads of the kernel
+  int part = UP_DIV(UP_DIV(num, tile), 2) * tile;
+  ASSERT_EQ(FusedElementwise(x.data(), output.data(), operands, repeated, buffer.data(), 0, part, tile, &param),
+            NNACL_OK);
+  ASSERT_EQ(FusedElementwise(x.data(), output.data(), operands, repeated, buffer.data(), part, num - part, tile,
+                             &param),
+            NNACL_OK);
+
+  std::vector<float> expect(num);
+  std::vector<float> temp(num);
+  for (int i = 0; i < num; ++i) {
+    temp[i] = x[i] * scale[i % channel];
+  }
+  ElementAdd(temp.data(), y.data(), temp.data(), num);
+  Swish(temp.data(), num, expect.data());
+  ElementDiv(y.data(), expect.data(), temp.data(), num);
+  Fp32Relu6(temp.data(), num, expect.data());
+  LRelu(expect.data(), num, temp.data(), 0.2f);
+  for (int i = 0; i < num; ++i) {
+    ASSERT_EQ(output[i], temp[i]) << "index " << i;
+  }
+}
+
+namespace {
+// x * y + s - c, relu, with y of the shape of x, scalar s and per channel c
+std::vector<float> ExpectFullScalarChannel(const std::vector<float> &x, const std::vector<float> &y, float s,
+                                           const std::vector<float> &c) {
+  std::vector<float> expect(x.size());
+  for (size_t i = 0; i < x.size(); ++i) {
+    float value = x[i] * y[i];
+    value = value + s;
+    value = value - c[i % c.size()];
+    expect[i] = value > 0 ? value : 0;
+  }
+  return expect;
+}
+
+void FillInput(std::vector<float> *x, std::vector<float> *y) {
+  for (size_t i = 0; i < x->size(); ++i) {
+    (*x)[i] = static_cast<float>((i * 29) % 83 - 41) / 9;
+    (*y)[i] = static_cast<float>((i * 7) % 23 + 1) / 11;
+  }
+}
+}  // namespace
+
+// the kernel picks the full, scalar and per channel operand modes at ReSize, again after the shapes change
+TEST_F(TestFusedElementwiseFp32, ReSizeBroadcastModes) {
+  const int channel = 24;
+  std::vector<int> shape = {2, 5, 7, channel};
+  int num = 2 * 5 * 7 * channel;
+  std::vector<float> x(num);
+  std::vector<float> y(num);
+  std::vector<float> s = {0.75f};
+  std::vector<float> c(channel);
+  std::vector<float> output(num);
+  FillInput(&x, &y);
+  for (int i = 0; i < channel; ++i) {
+    c[i] = static_cast<float>(i - 12) / 5;
+  }
+  lite::Tensor x_tensor(kNumberTypeFloat32, shape);
+  lite::Tensor y_tensor(kNumberTypeFloat32, shape);
+  lite::Tensor s_tensor(kNumberTypeFloat32, {1});
+  lite::Tensor c_tensor(kNumberTypeFloat32, {1, channel});
+  lite::Tensor output_tensor(kNumberTypeFloat32, shape);
+  x_tensor.set_data(x.data());
+  y_tensor.set_data(y.data());
+  s_tensor.set_data(s.data());
+  c_tensor.set_data(c.data());
+  output_tensor.set_data(output.data());
+  std::vector<lite::Tensor *> inputs = {&x_tensor, &y_tensor, &s_tensor, &c_tensor};
+  std::vector<lite::Tensor *> outputs = {&output_tensor};
+
+  auto param = reinterpret_cast<FusedElementwiseParameter *>(malloc(sizeof(FusedElementwiseParameter)));
+  ASSERT_NE(param, nullptr);
+  memset(param, 0, sizeof(FusedElementwiseParameter));
+  param->op_parameter_.type_ = schema::PrimitiveType_FusedElementwise;
+  int ops[] = {FusedElementwise_Mul, FusedElementwise_Add, FusedElementwise_Sub, FusedElementwise_Relu};
+  int operand_index[] = {1, 2, 3, 0};
+  param->step_num_ = 4;
+  for (int i = 0; i < param->step_num_; ++i) {
+    param->ops_[i] = ops[i];
+    param->operand_index_[i] = operand_index[i];
+  }
+  kernel::KernelKey desc = {kernel::KERNEL_ARCH::kCPU, kNumberTypeFloat32, schema::PrimitiveType_FusedElementwise};
+  auto creator = lite::KernelRegistry::GetInstance()->GetCreator(desc);
+  ASSERT_NE(creator, nullptr);
+  lite::InnerContext ctx;
+  ctx.thread_num_ = 3;
+  ASSERT_EQ(lite::RET_OK, ctx.Init());
+  auto kernel = creator(inputs, outputs, reinterpret_cast<OpParameter *>(param), &ctx, desc, nullptr);
+  ASSERT_NE(kernel, nullptr);
+  ASSERT_EQ(lite::RET_OK, kernel->Run());
+  auto expect = ExpectFullScalarChannel(x, y, s[0], c);
+  for (int i = 0; i < num; ++i) {
+    ASSERT_EQ(expect[i], output[i]) << "index " << i;
+  }
+
+  // a smaller input of the same channel number, the tile stays a multiple of the channel
+  std::vector<int> new_shape = {3, 11, channel};
+  num = 3 * 11 * channel;
+  x.assign(num, 0.0f);
+  y.assign(num, 0.0f);
+  output.assign(num, 0.0f);
+  FillInput(&x, &y);
+  x_tensor.set_shape(new_shape);
+  y_tensor.set_shape(new_shape);
+  output_tensor.set_shape(new_shape);
+  x_tensor.set_data(x.data());
+  y_tensor.set_data(y.data());
+  output_tensor.set_data(output.data());
+  ASSERT_EQ(lite::RET_OK, kernel->ReSize());
+  ASSERT_EQ(lite::RET_OK, kernel->Run());
+  expect = ExpectFullScalarChannel(x, y, s[0], c);
+  for (int i = 0; i < num; ++i) {
+    ASSERT_EQ(expect[i], output[i]) << "index " << i;
+  }
+
+  // an operand of neither the shape of the input, one element nor one per channel is rejected
+  c_tensor.set_shape({5});
+  EXPECT_NE(lite::RET_OK, kernel->ReSize());
+
+  for (auto tensor : {&x_tensor, &y_tensor, &s_tensor, &c_tensor, &output_tensor}) {
+    tensor->set_data(nullptr);
+  }
+  delete kernel;
+}
+}  // namespace mindspore
@@ -29,6 +29,7 @@
 #include "include/errorcode.h"
 #include "src/common/log_adapter.h"
 #include "src/common/file_utils.h"
+#include "src/runtime/allocator.h"
 #include "src/kernel_registry.h"
 #include "src/runtime/kernel/arm/fp32_grad/convolution.h"
 
@@ -524,6 +525,79 @@ TEST_F(NetworkTest, efficient_net) {
   ASSERT_EQ(res, 0);
 }
 
+void CompareOutputs(session::TrainSession *session, session::TrainSession *saving_session) {
+  auto outputs = session->GetOutputs();
+  auto saving_outputs = saving_session->GetOutputs();
+  ASSERT_EQ(outputs.size(), saving_outputs.size());
+  for (auto &output : outputs) {
+    auto saving_output = saving_outputs[output.first];
+    ASSERT_NE(nullptr, saving_output);
+    ASSERT_EQ(output.second->Size(), saving_output->Size());
+    EXPECT_EQ(0, memcmp(output.second->MutableData(), saving_output->MutableData(), output.second->Size()))
+      << "output " << output.first;
+  }
+}
+
+TEST_F(NetworkTest, lenet_memory_saving) {
+  lite::Context context;
+  context.device_list_[0].device_info_.cpu_device_info_.cpu_bind_mode_ = lite::NO_BIND;
+  context.thread_num_ = 1;
+  std::string net = "./test_data/nets/lenet_train.ms";
+  // the pool of each allocator grows to the high-water of the buffers its session keeps at once
+  context.allocator = lite::Allocator::Create();
+  auto allocator = context.allocator;
+  auto session = session::TrainSession::CreateSession(net, &context, true);
+  ASSERT_NE(session, nullptr);
+  context.allocator = lite::Allocator::Create();
+  auto saving_allocator = context.allocator;
+  auto saving_session = session::TrainSession::CreateSession(net, &context, true);
+  ASSERT_NE(saving_session, nullptr);
+  ASSERT_EQ(lite::RET_OK, saving_session->SetMemorySaving(true, 2));
+
+  size_t x_size = 0;
+  size_t y_size = 0;
+  auto x = lite::ReadFile("./test_data/nets/x_lenet.bin", &x_size);
+  auto y = lite::ReadFile("./test_data/nets/y_lenet.bin", &y_size);
+  ASSERT_NE(nullptr, x);
+  ASSERT_NE(nullptr, y);
+  for (auto train_session : {session, saving_session}) {
+    for (auto input : train_session->GetInputs()) {
+      memset(input->MutableData(), 0, input->Size());
+      if (input->Size() == x_size) {
+        memcpy(input->MutableData(), x, x_size);
+      } else if (input->Size() == y_size) {
+        memcpy(input->MutableData(), y, y_size);
+      }
+    }
+  }
+  delete[] x;
+  delete[] y;
+
+  // recomputed activations and gradients computed in place give the same results bit for bit
+  for (int i = 0; i < 3; i++) {
+    ASSERT_EQ(lite::RET_OK, session->RunGraph());
+    ASSERT_EQ(lite::RET_OK, saving_session->RunGraph());
+    CompareOutputs(session, saving_session);
+  }
+  MS_LOG(INFO) << "Allocator high-water of lenet training: " << allocator->GetTotalSize()
+               << " bytes, with memory saving: " << saving_allocator->GetTotalSize() << " bytes";
+  EXPECT_LT(saving_allocator->GetTotalSize(), allocator->GetTotalSize());
+  session->Eval();
+  saving_session->Eval();
+  ASSERT_EQ(lite::RET_OK, session->RunGraph());
+  ASSERT_EQ(lite::RET_OK, saving_session->RunGraph());
+  CompareOutputs(session, saving_session);
+
+  ASSERT_EQ(lite::RET_OK, saving_session->SetMemorySaving(false));
+  session->Train();
+  saving_session->Train();
+  ASSERT_EQ(lite::RET_OK, session->RunGraph());
+  ASSERT_EQ(lite::RET_OK, saving_session->RunGraph());
+  CompareOutputs(session, saving_session);
+  delete session;
+  delete saving_session;
+}
+
 TEST_F(NetworkTest, mobileface_net) {
   char *buf = nullptr;
   size_t net_size = 0;
@@ -0,0 +1,194 @@
+/**
+ * Copyright 2021 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <random>
+#include <vector>
+#include "common/common_test.h"
+#include "nnacl/int8/matmul_int8.h"
+#include "nnacl/int8/conv_depthwise_int8.h"
+#include "nnacl/int8/x86_simd_int8.h"
+
+namespace mindspore {
+class TestX86SimdInt8 : public mindspore::CommonTest {
+ public:
+  TestX86SimdInt8() {}
+
+  void TearDown() override { SetInt8SimdLevel(GetSupportedInt8SimdLevel()); }
+
+  // levels above scalar the running cpu supports
+  std::vector<Int8SimdLevel> SimdLevels() {
+    std::vector<Int8SimdLevel> levels;
+    for (auto level : {Int8SimdAvx2, Int8SimdAvx512Vnni}) {
+      if (level <= GetSupportedInt8SimdLevel()) {
+        levels.push_back(level);
+      }
+    }
+    return levels;
+  }
+
+  int Random(int min, int max) { return std::uniform_int_distribution<int>(min, max)(engine_); }
+
+  void FillRandom(int8_t *data, int size) {
+    for (int i = 0; i < size; i++) {
+      data[i] = static_cast<int8_t>(Random(INT8_MIN, INT8_MAX));
+    }
+  }
+
+  void FillRandom(int32_t *data, int size, int min, int max) {
+    for (int i = 0; i < size; i++) {
+      data[i] = Random(min, max);
+    }
+  }
+
+  std::mt19937 engine_{2021};
+};
+
+struct RequantTestArgs {
+  std::vector<int32_t> input_sum;
+  std::vector<int32_t> bias;
+  std::vector<int32_t> multiplier;
+  std::vector<int32_t> left_shift;
+  std::vector<int32_t> right_shift;
+  std::vector<int32_t> filter_zp;
+  int32_t out_zp;
+  int32_t mini;
+  int32_t maxi;
+};
+
+TEST_F(TestX86SimdInt8, MatmulBitExact) {
+  auto levels = SimdLevels();
+  if (levels.empty()) {
+    MS_LOG(INFO) << "No int8 simd level supported, skip";
+    return;
+  }
+  for (int iter = 0; iter < 100; iter++) {
+    int row = Random(1, 37);
+    int col = Random(1, 29);
+    int deep = Random(1, 70);
+    int stride = col + Random(0, 3);
+    // big enough for the row4x16 and the row8x4 layouts of a and b
+    int a_size = UP_ROUND(row, C8NUM) * UP_ROUND(deep, C16NUM);
+    int b_size = UP_ROUND(col, C8NUM) * UP_ROUND(deep, C16NUM);
+    std::vector<int8_t> a(a_size);
+    std::vector<int8_t> b(b_size);
+    RequantTestArgs args;
+    args.input_sum.resize(UP_ROUND(row, C8NUM) * UP_ROUND(col, C8NUM));
+    args.bias.resize(col);
+    args.multiplier.resize(col);
+    args.left_shift.resize(col);
+    args.right_shift.resize(col);
+    args.filter_zp.resize(col);
+    FillRandom(args.input_sum.data(), args.input_sum.size(), -200000, 200000);
+    FillRandom(args.bias.data(), col, -300000, 300000);
+    FillRandom(args.multiplier.data(), col, 1 << 29, INT32_MAX);
+    FillRandom(args.left_shift.data(), col, 0, 2);
+    FillRandom(args.right_shift.data(), col, -12, 0);
+    FillRandom(args.filter_zp.data(), col, -20, 20);
+    args.out_zp = Random(-10, 10);
+    args.mini = Random(INT8_MIN, -100);
+    args.maxi = Random(90, INT8_MAX);
+    for (int per_channel = 0; per_channel < 2; per_channel++) {
+      auto run = [&](int kernel, std::vector<int8_t> *dst) {
+        dst->assign(row * stride, 0);
+        if (kernel == 0) {
+          MatmulInt8Opt(a.data(), b.data(), dst->data(), row, col, UP_ROUND(deep, C16NUM), args.input_sum.data(),
+                        args.bias.data(), args.mini, args.maxi, args.out_zp, args.multiplier.data(),
+                        args.left_shift.data(), args.right_shift.data(), stride, per_channel, args.filter_zp.data());
+        } else if (kernel == 1) {
+          MatMulInt8_16x4_r(a.data(), b.data(), dst->data(), row, col, UP_ROUND(deep, C16NUM), stride,
+                            args.input_sum.data(), args.bias.data(), args.left_shift.data(), args.right_shift.data(),
+                            args.multiplier.data(), args.out_zp, args.mini, args.maxi, per_channel);
+        } else {
+          MatMulInt8_8x8_r(a.data(), b.data(), dst->data(), row, col, UP_ROUND(deep, C4NUM), stride,
+                           args.input_sum.data(), args.bias.data(), args.left_shift.data(), args.right_shift.data(),
+                           args.multiplier.data(), args.out_zp, args.mini, args.maxi, per_channel);
+        }
+      };
+      for (int kernel = 0; kernel < 3; kernel++) {
+        FillRandom(a.data(), a_size);
+        FillRandom(b.data(), b_size);
+        std::vector<int8_t> expect;
+        ASSERT_TRUE(SetInt8SimdLevel(Int8SimdScalar));
+        run(kernel, &expect);
+        for (auto level : levels) {
+          std::vector<int8_t> output;
+          ASSERT_TRUE(SetInt8SimdLevel(level));
+          run(kernel, &output);
+          ASSERT_EQ(expect, output) << "kernel " << kernel << ", level " << level << ", row " << row << ", col "
+                                    << col << ", deep " << deep << ", per channel " << per_channel;
+        }
+      }
+    }
+  }
+}
+
+TEST_F(TestX86SimdInt8, ConvDwBitExact) {
+  if (GetSupportedInt8SimdLevel() < Int8SimdAvx2) {
+    MS_LOG(INFO) << "No int8 simd level supported, skip";
+    return;
+  }
+  for (int iter = 0; iter < 50; iter++) {
+    ConvParameter conv_param;
+    memset(&conv_param, 0, sizeof(ConvParameter));
+    conv_param.input_batch_ = conv_param.output_batch_ = 1;
+    conv_param.input_h_ = Random(3, 12);
+    conv_param.input_w_ = Random(3, 12);
+    conv_param.input_channel_ = conv_param.output_channel_ = Random(1, 40);
+    conv_param.kernel_h_ = conv_param.kernel_w_ = 3;
+    conv_param.stride_h_ = conv_param.stride_w_ = Random(1, 2);
+    conv_param.dilation_h_ = conv_param.dilation_w_ = 1;
+    conv_param.pad_u_ = conv_param.pad_l_ = 1;
+    conv_param.output_h_ = (conv_param.input_h_ - 1) / conv_param.stride_h_ + 1;
+    conv_param.output_w_ = (conv_param.input_w_ - 1) / conv_param.stride_w_ + 1;
+    conv_param.thread_num_ = 1;
+    int channel = conv_param.output_channel_;
+    QuantArg input_quant_arg = {0.1, Random(-5, 5)};
+    QuantArg output_quant_arg = {0.1, Random(-5, 5)};
+    std::vector<int32_t> multiplier(channel);
+    std::vector<int32_t> left_shift(channel, 0);
+    std::vector<int32_t> right_shift(channel);
+    std::vector<int32_t> bias(channel);
+    FillRandom(multiplier.data(), channel, 1 << 29, INT32_MAX);
+    FillRandom(right_shift.data(), channel, -12, -4);
+    FillRandom(bias.data(), channel, -1000, 1000);
+    int32_t act_min = INT8_MIN;
+    int32_t act_max = INT8_MAX;
+    conv_param.conv_quant_arg_.input_quant_args_ = &input_quant_arg;
+    conv_param.conv_quant_arg_.output_quant_args_ = &output_quant_arg;
+    conv_param.conv_quant_arg_.quant_multiplier_ = multiplier.data();
+    conv_param.conv_quant_arg_.left_shift_ = left_shift.data();
+    conv_param.conv_quant_arg_.right_shift_ = right_shift.data();
+    conv_param.conv_quant_arg_.out_act_min_ = &act_min;
+    conv_param.conv_quant_arg_.out_act_max_ = &act_max;
+    conv_param.conv_quant_arg_.per_channel_ = iter % 2 == 0 ? FILTER_PER_CHANNEL : 0;
+
+    std::vector<int8_t> input(conv_param.input_h_ * conv_param.input_w_ * channel);
+    FillRandom(input.data(), input.size());
+    std::vector<int16_t> weight(conv_param.kernel_h_ * conv_param.kernel_w_ * channel);
+    for (auto &value : weight) {
+      value = static_cast<int16_t>(Random(-255, 255));
+    }
+    std::vector<int32_t> row_buffer(conv_param.output_w_ * channel);
+    std::vector<int8_t> expect(conv_param.output_h_ * conv_param.output_w_ * channel);
+    std::vector<int8_t> output(expect.size());
+    ASSERT_TRUE(SetInt8SimdLevel(Int8SimdScalar));
+    ConvDwInt8(expect.data(), row_buffer.data(), input.data(), weight.data(), bias.data(), &conv_param, 0);
+    ASSERT_TRUE(SetInt8SimdLevel(Int8SimdAvx2));
+    ConvDwInt8(output.data(), row_buffer.data(), input.data(), weight.data(), bias.data(), &conv_param, 0);
+    ASSERT_EQ(expect, output) << "channel " << channel << ", stride " << conv_param.stride_h_;
+  }
+}
+}  // namespace mindspore
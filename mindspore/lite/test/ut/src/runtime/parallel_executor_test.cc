@@ -0,0 +1,140 @@
+/**
+ * Copyright 2021 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "common/common_test.h"
+#include "src/inner_context.h"
+#include "src/lite_kernel.h"
+#include "src/runtime/allocator.h"
+#include "src/runtime/parallel_executor.h"
+#include "src/runtime/runtime_api.h"
+
+namespace mindspore {
+namespace {
+constexpr int kMaxNestedTaskNum = 32;
+
+// Checks that its producers finished before it runs, and optionally issues a ParallelLaunch of its own.
+class NestedLaunchKernel : public kernel::LiteKernel {
+ public:
+  NestedLaunchKernel(const lite::InnerContext *ctx, const std::string &name, int nested_task_num)
+      : LiteKernel(nullptr, {}, {}, ctx, nullptr), nested_task_num_(nested_task_num) {
+    set_name(name);
+  }
+  ~NestedLaunchKernel() override = default;
+
+  int Run() override {
+    for (auto in_kernel : in_kernels()) {
+      if (!static_cast<NestedLaunchKernel *>(in_kernel)->done_.load()) {
+        order_violation_num_++;
+      }
+    }
+    if (nested_task_num_ > 0) {
+      ParallelLaunch(context_->thread_pool_, NestedTask, this, nested_task_num_);
+    } else {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    done_ = true;
+    return lite::RET_OK;
+  }
+
+  void Reset() {
+    done_ = false;
+    for (auto &hit : task_hits_) {
+      hit = 0;
+    }
+    thread_ids_.clear();
+  }
+
+  static int NestedTask(void *cdata, int task_id) {
+    auto kernel = reinterpret_cast<NestedLaunchKernel *>(cdata);
+    kernel->task_hits_[task_id]++;
+    {
+      std::lock_guard<std::mutex> lock(kernel->mutex_);
+      kernel->thread_ids_.push_back(std::this_thread::get_id());
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    return lite::RET_OK;
+  }
+
+  int nested_task_num_;
+  std::atomic<bool> done_ = false;
+  std::atomic<int> order_violation_num_ = 0;
+  std::atomic<int> task_hits_[kMaxNestedTaskNum] = {};
+  std::mutex mutex_;
+  std::vector<std::thread::id> thread_ids_;
+};
+}  // namespace
+
+class ParallelExecutorTest : public mindspore::CommonTest {
+ public:
+  ParallelExecutorTest() = default;
+};
+
+// k0 -> {k1, k2} -> k3 -> k4: k3 and k4 run alone, their launches must still use the idle workers
+TEST_F(ParallelExecutorTest, NestedLaunchUsesIdleWorkers) {
+  lite::Context context;
+  context.thread_num_ = 4;
+  context.device_list_[0].device_info_.cpu_device_info_.cpu_bind_mode_ = lite::NO_BIND;
+  lite::InnerContext ctx(&context);
+  ASSERT_EQ(lite::RET_OK, ctx.Init());
+  std::vector<std::unique_ptr<NestedLaunchKernel>> owners;
+  const int nested_task_nums[] = {0, 8, 0, 16, kMaxNestedTaskNum};
+  for (int i = 0; i < 5; i++) {
+    owners.emplace_back(std::make_unique<NestedLaunchKernel>(&ctx, "k" + std::to_string(i), nested_task_nums[i]));
+  }
+  auto link = [&owners](int from, int to) {
+    owners[from]->AddOutKernel(owners[to].get());
+    owners[to]->AddInKernel(owners[from].get());
+  };
+  link(0, 1);
+  link(0, 2);
+  link(1, 3);
+  link(2, 3);
+  link(3, 4);
+  std::vector<kernel::LiteKernel *> kernels;
+  for (auto &owner : owners) {
+    kernels.push_back(owner.get());
+  }
+  lite::ParallelExecutor executor;
+  lite::DefaultAllocator allocator;
+  std::vector<lite::Tensor *> inputs;
+  std::vector<lite::Tensor *> outputs;
+  for (int round = 0; round < 20; round++) {
+    for (auto &owner : owners) {
+      owner->Reset();
+    }
+    ASSERT_EQ(lite::RET_OK, executor.Run(inputs, outputs, kernels, &allocator));
+    for (auto &owner : owners) {
+      ASSERT_TRUE(owner->done_.load()) << owner->name();
+      ASSERT_EQ(0, owner->order_violation_num_.load()) << owner->name();
+      for (int i = 0; i < kMaxNestedTaskNum; i++) {
+        ASSERT_EQ(i < owner->nested_task_num_ ? 1 : 0, owner->task_hits_[i].load()) << owner->name() << " task " << i;
+      }
+    }
+    // the locked mode is only needed while the kernels run concurrently
+    ASSERT_FALSE(allocator.GetContext().lockFlag);
+  }
+  auto &ids = owners.back()->thread_ids_;
+  std::sort(ids.begin(), ids.end());
+  ASSERT_GT(std::unique(ids.begin(), ids.end()) - ids.begin(), 1);
+}
+}  // namespace mindspore
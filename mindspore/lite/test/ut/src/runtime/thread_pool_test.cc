@@ -0,0 +1,181 @@
+/**
+ * Copyright 2021 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+#include "common/common_test.h"
+#include "src/runtime/runtime_api.h"
+
+namespace mindspore {
+namespace {
+constexpr int kThreadNum = 4;
+
+// counts the runs of every task id of one launch
+struct TaskHits {
+  explicit TaskHits(int task_num) : hits(task_num) {}
+  std::vector<std::atomic<int>> hits;
+  std::atomic<int> wrong_id_num = 0;
+  // tasks whose id is a multiple of slow_every sleep, so the others steal the rest of their range
+  int slow_every = 0;
+  ThreadPool *nested_pool = nullptr;
+  int nested_task_num = 0;
+  std::atomic<int> nested_error_num = 0;
+};
+
+int CountTask(void *cdata, int task_id) {
+  auto task_hits = reinterpret_cast<TaskHits *>(cdata);
+  if (task_id < 0 || task_id >= static_cast<int>(task_hits->hits.size())) {
+    task_hits->wrong_id_num++;
+    return 0;
+  }
+  task_hits->hits[task_id]++;
+  if (task_hits->slow_every > 0 && task_id % task_hits->slow_every == 0) {
+    std::this_thread::sleep_for(std::chrono::microseconds(200));
+  }
+  return 0;
+}
+
+bool AllRunOnce(const TaskHits &task_hits) {
+  if (task_hits.wrong_id_num != 0) {
+    return false;
+  }
+  for (auto &hit : task_hits.hits) {
+    if (hit != 1) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// a launch on the same pool from inside a task of another one
+int NestedTask(void *cdata, int task_id) {
+  auto task_hits = reinterpret_cast<TaskHits *>(cdata);
+  CountTask(cdata, task_id);
+  TaskHits nested(task_hits->nested_task_num);
+  if (ParallelLaunch(task_hits->nested_pool, CountTask, &nested, task_hits->nested_task_num) != 0 ||
+      !AllRunOnce(nested)) {
+    task_hits->nested_error_num++;
+  }
+  return 0;
+}
+
+void FreeThreadPool(ThreadPool *thread_pool) {
+  DestroyThreadPool(thread_pool);
+  free(thread_pool);
+}
+}  // namespace
+
+class ThreadPoolTest : public mindspore::CommonTest {
+ public:
+  ThreadPoolTest() = default;
+  void SetUp() override {
+    thread_pool_ = CreateThreadPool(kThreadNum, NO_BIND_MODE);
+    ASSERT_NE(thread_pool_, nullptr);
+    ActivateThreadPool(thread_pool_);
+  }
+  void TearDown() override { FreeThreadPool(thread_pool_); }
+
+ protected:
+  ThreadPool *thread_pool_ = nullptr;
+};
+
+// every task id runs exactly once, for task nums below, at and far above the thread num
+TEST_F(ThreadPoolTest, ManyTasksRunOnce) {
+  for (int task_num : {1, 2, 3, kThreadNum, kThreadNum + 1, 64, 1000, 100000}) {
+    for (int i = 0; i < 20; ++i) {
+      TaskHits task_hits(task_num);
+      ASSERT_EQ(0, ParallelLaunch(thread_pool_, CountTask, &task_hits, task_num));
+      ASSERT_TRUE(AllRunOnce(task_hits)) << "task num " << task_num;
+    }
+  }
+}
+
+// slow tasks keep their owner busy while the other threads steal the rest of its range
+TEST_F(ThreadPoolTest, UnevenTasksRunOnce) {
+  for (int slow_every : {1, 7, 64}) {
+    TaskHits task_hits(256);
+    task_hits.slow_every = slow_every;
+    ASSERT_EQ(0, ParallelLaunch(thread_pool_, CountTask, &task_hits, 256));
+    ASSERT_TRUE(AllRunOnce(task_hits)) << "slow every " << slow_every;
+  }
+}
+
+// a launch issued by a task of the running launch runs in the calling thread
+TEST_F(ThreadPoolTest, NestedLaunch) {
+  TaskHits task_hits(64);
+  task_hits.nested_pool = thread_pool_;
+  task_hits.nested_task_num = 33;
+  ASSERT_EQ(0, ParallelLaunch(thread_pool_, NestedTask, &task_hits, 64));
+  ASSERT_TRUE(AllRunOnce(task_hits));
+  ASSERT_EQ(0, task_hits.nested_error_num);
+}
+
+// launches of several callers at once, the ones finding the pool busy run in their own thread
+TEST_F(ThreadPoolTest, ConcurrentLaunches) {
+  constexpr int kCallerNum = 4;
+  constexpr int kLaunchNum = 200;
+  std::atomic<int> error_num = 0;
+  std::vector<std::thread> callers;
+  for (int i = 0; i < kCallerNum; ++i) {
+    callers.emplace_back([this, i, &error_num]() {
+      for (int j = 0; j < kLaunchNum; ++j) {
+        int task_num = 2 + (i * kLaunchNum + j) % 97;
+        TaskHits task_hits(task_num);
+        if (ParallelLaunch(thread_pool_, CountTask, &task_hits, task_num) != 0 || !AllRunOnce(task_hits)) {
+          error_num++;
+        }
+      }
+    });
+  }
+  for (auto &caller : callers) {
+    caller.join();
+  }
+  ASSERT_EQ(0, error_num);
+}
+
+// inactive workers block on the epoch between launches and are woken by the next one
+TEST_F(ThreadPoolTest, LaunchAfterWorkersBlock) {
+  DeactivateThreadPool(thread_pool_);
+  for (int i = 0; i < 10; ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    TaskHits task_hits(500);
+    task_hits.slow_every = 50;
+    ASSERT_EQ(0, ParallelLaunch(thread_pool_, CountTask, &task_hits, 500));
+    ASSERT_TRUE(AllRunOnce(task_hits));
+  }
+  ActivateThreadPool(thread_pool_);
+  TaskHits task_hits(500);
+  ASSERT_EQ(0, ParallelLaunch(thread_pool_, CountTask, &task_hits, 500));
+  ASSERT_TRUE(AllRunOnce(task_hits));
+}
+
+// pools destroyed right after a launch, with workers spinning or blocked
+TEST_F(ThreadPoolTest, CreateDestroyCycles) {
+  for (int i = 0; i < 50; ++i) {
+    auto thread_pool = CreateThreadPool(1 + i % kThreadNum, NO_BIND_MODE);
+    ASSERT_NE(thread_pool, nullptr);
+    if (i % 2 == 0) {
+      ActivateThreadPool(thread_pool);
+    }
+    TaskHits task_hits(100);
+    ASSERT_EQ(0, ParallelLaunch(thread_pool, CountTask, &task_hits, 100));
+    ASSERT_TRUE(AllRunOnce(task_hits));
+    FreeThreadPool(thread_pool);
+  }
+}
+}  // namespace mindspore
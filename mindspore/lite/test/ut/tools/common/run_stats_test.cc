@@ -0,0 +1,93 @@
+/**
+ * Copyright 2021 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <sstream>
+#include <string>
+#include <vector>
+#include "common/common_test.h"
+#include "tools/common/run_stats.h"
+
+namespace mindspore {
+class RunStatsTest : public mindspore::CommonTest {
+ public:
+  RunStatsTest() = default;
+};
+
+TEST_F(RunStatsTest, TestPercentile) {
+  EXPECT_EQ(0, lite::Percentile({}, 50));
+  EXPECT_EQ(7, lite::Percentile({7}, 0));
+  EXPECT_EQ(7, lite::Percentile({7}, 99.9));
+
+  std::vector<uint64_t> times;
+  for (uint64_t i = 1; i <= 1000; i++) {
+    times.push_back(i);
+  }
+  EXPECT_EQ(1, lite::Percentile(times, 0));
+  EXPECT_EQ(500, lite::Percentile(times, 50));
+  EXPECT_EQ(900, lite::Percentile(times, 90));
+  EXPECT_EQ(990, lite::Percentile(times, 99));
+  EXPECT_EQ(999, lite::Percentile(times, 99.9));
+  EXPECT_EQ(1000, lite::Percentile(times, 100));
+  // nearest rank, not interpolated
+  EXPECT_EQ(20, lite::Percentile({10, 20, 30, 40}, 50));
+  EXPECT_EQ(30, lite::Percentile({10, 20, 30, 40}, 51));
+}
+
+TEST_F(RunStatsTest, TestComputeLatencyStats) {
+  auto empty = lite::ComputeLatencyStats({});
+  EXPECT_EQ(0, empty.max);
+  EXPECT_EQ(0, empty.p999);
+
+  // unsorted input
+  std::vector<uint64_t> times;
+  for (uint64_t i = 100; i > 0; i--) {
+    times.push_back(i * 10);
+  }
+  auto stats = lite::ComputeLatencyStats(times);
+  EXPECT_EQ(10, stats.min);
+  EXPECT_EQ(1000, stats.max);
+  EXPECT_EQ(505, stats.avg);
+  EXPECT_EQ(500, stats.p50);
+  EXPECT_EQ(900, stats.p90);
+  EXPECT_EQ(990, stats.p99);
+  EXPECT_EQ(1000, stats.p999);
+}
+
+TEST_F(RunStatsTest, TestJson) {
+  lite::LatencyStats stats;
+  stats.min = 1;
+  stats.max = 9;
+  stats.avg = 5;
+  stats.p50 = 4;
+  stats.p90 = 8;
+  stats.p99 = 9;
+  stats.p999 = 9;
+  std::ostringstream out;
+  lite::WriteJsonLatency(&out, stats);
+  EXPECT_EQ("{\"min\": 1, \"max\": 9, \"avg\": 5, \"p50\": 4, \"p90\": 8, \"p99\": 9, \"p999\": 9}", out.str());
+
+  EXPECT_EQ("mobilenet_v2.ms", lite::JsonEscape("mobilenet_v2.ms"));
+  EXPECT_EQ("a\\\"b\\\\c\\nd\\te\\u0001", lite::JsonEscape("a\"b\\c\nd\te\x01"));
+}
+
+TEST_F(RunStatsTest, TestMemory) {
+#ifdef __linux__
+  EXPECT_GT(lite::GetPeakRssKb(), 0);
+  std::vector<char> buffer(1 << 20, 1);
+  EXPECT_GE(lite::GetHeapInUse(), buffer.size());
+#endif
+}
+}  // namespace mindspore
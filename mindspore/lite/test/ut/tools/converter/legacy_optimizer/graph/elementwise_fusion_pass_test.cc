@@ -0,0 +1,195 @@
+/**
+ * Copyright 2021 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <memory>
+#include <string>
+#include <vector>
+#include "schema/inner/model_generated.h"
+#include "common/common_test.h"
+#include "include/errorcode.h"
+#include "nnacl/fp32/fused_elementwise_fp32.h"
+#include "tools/converter/legacy_optimizer/graph/elementwise_fusion_pass.h"
+
+namespace mindspore {
+class ElementwiseFusionPassTest : public mindspore::CommonTest {
+ public:
+  ElementwiseFusionPassTest() = default;
+};
+
+namespace {
+const std::vector<int> kShape = {1, 4, 4, 8};
+
+uint32_t AddTensor(schema::MetaGraphT *graph, const std::vector<int> &dims, bool is_const) {
+  auto tensor = std::make_unique<schema::TensorT>();
+  tensor->dataType = kNumberTypeFloat32;
+  tensor->dims = dims;
+  tensor->format = schema::Format_NHWC;
+  tensor->nodeType = is_const ? schema::NodeType_ValueNode : schema::NodeType_Parameter;
+  if (is_const) {
+    int element_num = 1;
+    for (auto dim : dims) {
+      element_num *= dim;
+    }
+    tensor->data.resize(element_num * sizeof(float), 0);
+  }
+  graph->allTensors.emplace_back(std::move(tensor));
+  return graph->allTensors.size() - 1;
+}
+
+// the output of the node, a tensor of kShape
+uint32_t AddNode(schema::MetaGraphT *graph, schema::PrimitiveType type, void *primitive,
+                 const std::vector<uint32_t> &inputs) {
+  auto node = std::make_unique<schema::CNodeT>();
+  node->name = "node" + std::to_string(graph->nodes.size());
+  node->inputIndex = inputs;
+  node->outputIndex = {AddTensor(graph, kShape, false)};
+  node->primitive = std::make_unique<schema::PrimitiveT>();
+  node->primitive->value.type = type;
+  node->primitive->value.value = primitive;
+  graph->nodes.emplace_back(std::move(node));
+  return graph->nodes.back()->outputIndex.front();
+}
+
+schema::AddT *NewAdd(schema::ActivationType activation_type) {
+  auto add = new schema::AddT;
+  add->activationType = activation_type;
+  return add;
+}
+
+schema::ActivationT *NewActivation(schema::ActivationType type) {
+  auto activation = new schema::ActivationT;
+  activation->type = type;
+  return activation;
+}
+
+schema::ScaleT *NewScale(int axis, schema::ActivationType activation_type) {
+  auto scale = new schema::ScaleT;
+  scale->axis = axis;
+  scale->activationType = activation_type;
+  return scale;
+}
+
+// the tensors of indexes, which the pass renumbers when it removes the intermediate ones
+std::vector<schema::TensorT *> Tensors(const schema::MetaGraphT &graph, const std::vector<uint32_t> &indexes) {
+  std::vector<schema::TensorT *> tensors;
+  for (auto index : indexes) {
+    tensors.push_back(graph.allTensors.at(index).get());
+  }
+  return tensors;
+}
+
+void ExpectFused(const schema::MetaGraphT &graph, size_t node_index, const std::vector<int> &ops,
+                 const std::vector<int> &operand_index, const std::vector<schema::TensorT *> &inputs,
+                 const std::vector<schema::TensorT *> &outputs) {
+  auto &node = graph.nodes.at(node_index);
+  ASSERT_EQ(schema::PrimitiveType_FusedElementwise, node->primitive->value.type);
+  auto fused = node->primitive->value.AsFusedElementwise();
+  EXPECT_EQ(ops, fused->opTypes);
+  EXPECT_EQ(operand_index, fused->operandIndex);
+  EXPECT_EQ(ops.size(), fused->alpha.size());
+  EXPECT_EQ(inputs, Tensors(graph, node->inputIndex));
+  EXPECT_EQ(outputs, Tensors(graph, node->outputIndex));
+  // the other nodes of the chain are left isolated for IsolatedNodeRemovePass
+  for (size_t i = node_index + 1; i < graph.nodes.size(); ++i) {
+    EXPECT_TRUE(graph.nodes.at(i)->inputIndex.empty());
+    EXPECT_TRUE(graph.nodes.at(i)->outputIndex.empty());
+  }
+}
+}  // namespace
+
+// x * scalar, + per channel with relu, sigmoid
+TEST_F(ElementwiseFusionPassTest, TestFuseChain) {
+  auto graph = std::make_unique<schema::MetaGraphT>();
+  auto x = AddTensor(graph.get(), kShape, false);
+  auto scalar = AddTensor(graph.get(), {1}, true);
+  auto channel = AddTensor(graph.get(), {8}, true);
+  auto mul = AddNode(graph.get(), schema::PrimitiveType_Mul, new schema::MulT, {x, scalar});
+  auto add = AddNode(graph.get(), schema::PrimitiveType_Add, NewAdd(schema::ActivationType_RELU), {mul, channel});
+  auto y = AddNode(graph.get(), schema::PrimitiveType_Activation, NewActivation(schema::ActivationType_SIGMOID), {add});
+  graph->inputIndex = {x};
+  graph->outputIndex = {y};
+  auto inputs = Tensors(*graph, {x, scalar, channel});
+  auto outputs = Tensors(*graph, {y});
+  auto tensor_num = graph->allTensors.size();
+
+  ASSERT_EQ(lite::RET_OK, lite::ElementwiseFusionPass().Run(graph.get()));
+  ExpectFused(*graph, 0, {FusedElementwise_Mul, FusedElementwise_Add, FusedElementwise_Relu, FusedElementwise_Sigmoid},
+              {1, 2, 0, 0}, inputs, outputs);
+  EXPECT_EQ(tensor_num - 2, graph->allTensors.size());
+  EXPECT_EQ(outputs, Tensors(*graph, graph->outputIndex));
+}
+
+// the running value is the second input of Sub
+TEST_F(ElementwiseFusionPassTest, TestReverseOperand) {
+  auto graph = std::make_unique<schema::MetaGraphT>();
+  auto x = AddTensor(graph.get(), kShape, false);
+  auto channel = AddTensor(graph.get(), {1, 8}, true);
+  auto sub = AddNode(graph.get(), schema::PrimitiveType_Sub, new schema::SubT, {channel, x});
+  auto y = AddNode(graph.get(), schema::PrimitiveType_Abs, new schema::AbsT, {sub});
+  graph->inputIndex = {x};
+  graph->outputIndex = {y};
+  auto inputs = Tensors(*graph, {x, channel});
+  auto outputs = Tensors(*graph, {y});
+
+  ASSERT_EQ(lite::RET_OK, lite::ElementwiseFusionPass().Run(graph.get()));
+  ExpectFused(*graph, 0, {FusedElementwise_ReverseSub, FusedElementwise_Abs}, {1, 0}, inputs, outputs);
+}
+
+// Scale over the last axis is a Mul and an Add step, then its activation
+TEST_F(ElementwiseFusionPassTest, TestFuseScale) {
+  auto graph = std::make_unique<schema::MetaGraphT>();
+  auto x = AddTensor(graph.get(), kShape, false);
+  auto scale = AddTensor(graph.get(), {8}, true);
+  auto offset = AddTensor(graph.get(), {8}, true);
+  auto scaled =
+    AddNode(graph.get(), schema::PrimitiveType_Scale, NewScale(-1, schema::ActivationType_RELU6), {x, scale, offset});
+  auto y = AddNode(graph.get(), schema::PrimitiveType_Sqrt, new schema::SqrtT, {scaled});
+  graph->inputIndex = {x};
+  graph->outputIndex = {y};
+  auto inputs = Tensors(*graph, {x, scale, offset});
+  auto outputs = Tensors(*graph, {y});
+
+  ASSERT_EQ(lite::RET_OK, lite::ElementwiseFusionPass().Run(graph.get()));
+  ExpectFused(*graph, 0, {FusedElementwise_Mul, FusedElementwise_Add, FusedElementwise_Relu6, FusedElementwise_Sqrt},
+              {1, 2, 0, 0}, inputs, outputs);
+}
+
+// an intermediate result read twice, a Scale over a middle axis and a graph output inside the chain are not fused
+TEST_F(ElementwiseFusionPassTest, TestNoChange) {
+  auto graph = std::make_unique<schema::MetaGraphT>();
+  auto x = AddTensor(graph.get(), kShape, false);
+  auto scalar = AddTensor(graph.get(), {1}, true);
+  auto mul = AddNode(graph.get(), schema::PrimitiveType_Mul, new schema::MulT, {x, scalar});
+  auto neg = AddNode(graph.get(), schema::PrimitiveType_Neg, new schema::NegT, {mul});
+  auto add = AddNode(graph.get(), schema::PrimitiveType_Add, NewAdd(schema::ActivationType_NO_ACTIVATION), {mul, x});
+  auto scale = AddTensor(graph.get(), {4}, true);
+  auto scaled =
+    AddNode(graph.get(), schema::PrimitiveType_Scale, NewScale(1, schema::ActivationType_NO_ACTIVATION), {add, scale});
+  auto abs = AddNode(graph.get(), schema::PrimitiveType_Abs, new schema::AbsT, {scaled});
+  auto sqrt = AddNode(graph.get(), schema::PrimitiveType_Sqrt, new schema::SqrtT, {neg});
+  graph->inputIndex = {x};
+  graph->outputIndex = {abs, neg, sqrt};
+  auto node_num = graph->nodes.size();
+  auto tensor_num = graph->allTensors.size();
+
+  EXPECT_EQ(lite::RET_NO_CHANGE, lite::ElementwiseFusionPass().Run(graph.get()));
+  EXPECT_EQ(tensor_num, graph->allTensors.size());
+  for (size_t i = 0; i < node_num; ++i) {
+    EXPECT_NE(schema::PrimitiveType_FusedElementwise, graph->nodes.at(i)->primitive->value.type);
+    EXPECT_FALSE(graph->nodes.at(i)->outputIndex.empty());
+  }
+}
+}  // namespace mindspore
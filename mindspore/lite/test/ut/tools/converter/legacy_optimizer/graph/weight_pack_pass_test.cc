@@ -0,0 +1,141 @@
+/**
+ * Copyright 2021 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cstring>
+#include <memory>
+#include <vector>
+#include "schema/inner/model_generated.h"
+#include "common/common_test.h"
+#include "include/errorcode.h"
+#include "nnacl/op_base.h"
+#include "nnacl/fp32/matmul_fp32.h"
+#include "src/runtime/kernel/arm/base/packed_weight_cache.h"
+#include "tools/converter/legacy_optimizer/graph/weight_pack_pass.h"
+
+namespace mindspore {
+class WeightPackPassTest : public mindspore::CommonTest {
+ public:
+  WeightPackPassTest() = default;
+};
+
+namespace {
+uint32_t AddTensor(schema::MetaGraphT *graph, const std::vector<int> &dims, bool is_weight) {
+  auto tensor = std::make_unique<schema::TensorT>();
+  tensor->dataType = kNumberTypeFloat32;
+  tensor->dims = dims;
+  tensor->format = is_weight ? schema::Format_KHWC : schema::Format_NHWC;
+  tensor->nodeType = is_weight ? schema::NodeType_ValueNode : schema::NodeType_Parameter;
+  if (is_weight) {
+    int element_num = 1;
+    for (auto dim : dims) {
+      element_num *= dim;
+    }
+    std::vector<float> data(element_num);
+    for (int i = 0; i < element_num; i++) {
+      data[i] = static_cast<float>(i % 13 - 6) * 0.5f;
+    }
+    tensor->data.resize(element_num * sizeof(float));
+    memcpy(tensor->data.data(), data.data(), tensor->data.size());
+  }
+  graph->allTensors.emplace_back(std::move(tensor));
+  return graph->allTensors.size() - 1;
+}
+
+void AddNode(schema::MetaGraphT *graph, schema::PrimitiveType type, void *primitive, uint32_t weight) {
+  auto node = std::make_unique<schema::CNodeT>();
+  node->name = "node" + std::to_string(graph->nodes.size());
+  node->inputIndex = {AddTensor(graph, {1, 8, 8, 4}, false), weight};
+  node->outputIndex = {AddTensor(graph, {}, false)};
+  node->primitive = std::make_unique<schema::PrimitiveT>();
+  node->primitive->value.type = type;
+  node->primitive->value.value = primitive;
+  graph->nodes.emplace_back(std::move(node));
+}
+
+schema::Conv2DT *NewConv2D(int kernel, int stride) {
+  auto conv = new schema::Conv2DT;
+  conv->group = 1;
+  conv->kernelH = kernel;
+  conv->kernelW = kernel;
+  conv->strideH = stride;
+  conv->strideW = stride;
+  conv->dilateH = 1;
+  conv->dilateW = 1;
+  return conv;
+}
+
+std::vector<uint8_t> PackRef(const schema::TensorT *weight, bool col_major, int batch, int row, int col) {
+  int tiled_row = col_major ? UP_ROUND(row, C8NUM) : row;
+  int tiled_col = col_major ? col : UP_ROUND(col, C8NUM);
+  std::vector<float> packed(batch * tiled_row * tiled_col, 0.0f);
+  auto src = reinterpret_cast<const float *>(weight->data.data());
+  for (int i = 0; i < batch; i++) {
+    col_major ? RowMajor2Col8Major(src + i * row * col, packed.data() + i * tiled_row * tiled_col, row, col)
+              : RowMajor2Row8Major(src + i * row * col, packed.data() + i * tiled_row * tiled_col, row, col);
+  }
+  std::vector<uint8_t> bytes(packed.size() * sizeof(float));
+  memcpy(bytes.data(), packed.data(), bytes.size());
+  return bytes;
+}
+}  // namespace
+
+// Conv2D, FullConnection and MatMul weights get the layout the kernels pack to, winograd and quantized ones do not.
+TEST_F(WeightPackPassTest, TestPackLayouts) {
+  auto graph = std::make_unique<schema::MetaGraphT>();
+  auto conv_weight = AddTensor(graph.get(), {10, 3, 3, 4}, true);
+  AddNode(graph.get(), schema::PrimitiveType_Conv2D, NewConv2D(3, 2), conv_weight);
+  auto winograd_weight = AddTensor(graph.get(), {10, 3, 3, 4}, true);
+  AddNode(graph.get(), schema::PrimitiveType_Conv2D, NewConv2D(3, 1), winograd_weight);
+  auto fc_weight = AddTensor(graph.get(), {12, 256}, true);
+  AddNode(graph.get(), schema::PrimitiveType_FullConnection, new schema::FullConnectionT, fc_weight);
+  auto matmul_weight = AddTensor(graph.get(), {2, 4, 9}, true);
+  AddNode(graph.get(), schema::PrimitiveType_MatMul, new schema::MatMulT, matmul_weight);
+  auto quant_weight = AddTensor(graph.get(), {12, 256}, true);
+  AddNode(graph.get(), schema::PrimitiveType_FullConnection, new schema::FullConnectionT, quant_weight);
+  graph->nodes.back()->quantType = schema::QuantType_WeightQuant;
+  auto origin_data = graph->allTensors.at(conv_weight)->data;
+
+  lite::WeightPackPass pass(C8NUM);
+  ASSERT_EQ(lite::RET_OK, pass.Run(graph.get()));
+
+  auto &conv = graph->allTensors.at(conv_weight);
+  EXPECT_EQ(kernel::PackedWeightLayout(true, C8NUM, 1, 10, 36), conv->packedLayout);
+  EXPECT_EQ(PackRef(conv.get(), true, 1, 10, 36), conv->packedData);
+  EXPECT_EQ(origin_data, conv->data);
+  auto &fc = graph->allTensors.at(fc_weight);
+  EXPECT_EQ(kernel::PackedWeightLayout(true, C8NUM, 1, 12, 256), fc->packedLayout);
+  EXPECT_EQ(PackRef(fc.get(), true, 1, 12, 256), fc->packedData);
+  auto &matmul = graph->allTensors.at(matmul_weight);
+  EXPECT_EQ(kernel::PackedWeightLayout(false, C8NUM, 2, 4, 9), matmul->packedLayout);
+  EXPECT_EQ(PackRef(matmul.get(), false, 2, 4, 9), matmul->packedData);
+  for (auto index : {winograd_weight, quant_weight}) {
+    EXPECT_TRUE(graph->allTensors.at(index)->packedLayout.empty());
+    EXPECT_TRUE(graph->allTensors.at(index)->packedData.empty());
+  }
+
+  // packed weights are not packed again
+  ASSERT_EQ(lite::RET_OK, pass.Run(graph.get()));
+  EXPECT_EQ(PackRef(conv.get(), true, 1, 10, 36), conv->packedData);
+}
+
+TEST_F(WeightPackPassTest, TestNoChangeAndInvalidTile) {
+  auto graph = std::make_unique<schema::MetaGraphT>();
+  auto weight = AddTensor(graph.get(), {10, 3, 3, 4}, true);
+  AddNode(graph.get(), schema::PrimitiveType_Conv2D, NewConv2D(3, 1), weight);
+  EXPECT_EQ(lite::RET_NO_CHANGE, lite::WeightPackPass(C8NUM).Run(graph.get()));
+  EXPECT_EQ(lite::RET_ERROR, lite::WeightPackPass(C4NUM).Run(graph.get()));
+}
+}  // namespace mindspore
@@ -0,0 +1,164 @@
+/**
+ * Copyright 2021 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cstring>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+#include "common/common_test.h"
+#include "ir/func_graph.h"
+#include "ir/primitive.h"
+#include "tools/converter/quantizer/post_training_quantizer.h"
+
+namespace mindspore {
+namespace lite {
+namespace quant {
+class PostTrainingQuantizerTest : public mindspore::CommonTest {
+ public:
+  PostTrainingQuantizerTest() = default;
+};
+
+namespace {
+constexpr int kBinNum = 2048;
+const char kNodeName[] = "conv";
+
+// batches of one tensor, with repeated extremes, signed zeros and zeros skipped by the histogram
+std::vector<std::vector<float>> RandomBatches(size_t batch_num, size_t batch_size) {
+  std::mt19937 engine(7);
+  std::normal_distribution<float> dist(0.0f, 3.0f);
+  std::vector<std::vector<float>> batches(batch_num);
+  for (auto &batch : batches) {
+    for (size_t i = 0; i < batch_size; i++) {
+      batch.push_back(dist(engine));
+    }
+    batch.push_back(0.0f);
+    batch.push_back(-0.0f);
+    batch.push_back(12.5f);
+    batch.push_back(-12.5f);
+  }
+  return batches;
+}
+
+DivergInfoMap NewDivergInfoMap(const CNodePtr &cnode, const std::string &method_x) {
+  DivergInfoMap infos;
+  infos[kNodeName].push_back(std::make_unique<DivergInfo>(cnode, kBinNum, 8, 255, 0, method_x));
+  return infos;
+}
+
+bool BitEqual(float a, float b) { return memcmp(&a, &b, sizeof(float)) == 0; }
+
+void ExpectBitEqual(const std::vector<float> &expect, const std::vector<float> &actual) {
+  ASSERT_EQ(expect.size(), actual.size());
+  for (size_t i = 0; i < expect.size(); i++) {
+    ASSERT_TRUE(BitEqual(expect[i], actual[i])) << "index " << i << ": " << expect[i] << " vs " << actual[i];
+  }
+}
+
+// both calibration passes and the threshold of batches on one info, as with session_num 1
+DivergInfoMap CalibrateSerial(const CNodePtr &cnode, const std::string &method_x,
+                              const std::vector<std::vector<float>> &batches) {
+  auto infos = NewDivergInfoMap(cnode, method_x);
+  auto &info = infos[kNodeName][0];
+  for (auto &batch : batches) {
+    info->RecordMaxValue(batch);
+    info->RecordMaxValueArray(batch);
+  }
+  info->UpdateInterval();
+  for (auto &batch : batches) {
+    info->UpdateHistogram(batch);
+  }
+  Calibrator::ApplyBinCounts(&infos);
+  info->ComputeThreshold();
+  return infos;
+}
+
+// the same split into contiguous shards merged in batch order, as PostTrainingQuantizer::RunCalibrationShards does
+DivergInfoMap CalibrateSharded(const CNodePtr &cnode, const std::string &method_x,
+                               const std::vector<std::vector<float>> &batches, size_t shard_num) {
+  auto infos = NewDivergInfoMap(cnode, method_x);
+  auto run_shards = [&](const std::function<void(DivergInfo *, const std::vector<float> &)> &record,
+                        const std::function<void(DivergInfo *dst, const DivergInfo &src)> &merge) {
+    std::vector<DivergInfoMap> shards(shard_num);
+    size_t begin = 0;
+    for (size_t i = 0; i < shard_num; i++) {
+      size_t end = begin + batches.size() / shard_num + (i < batches.size() % shard_num ? 1 : 0);
+      Calibrator::CopyDivergInfo(infos, &shards[i]);
+      for (size_t b = begin; b < end; b++) {
+        record(shards[i][kNodeName][0].get(), batches[b]);
+      }
+      begin = end;
+    }
+    for (auto &shard : shards) {
+      Calibrator::MergeDivergInfo(shard, &infos, merge);
+    }
+  };
+  run_shards(
+    [](DivergInfo *info, const std::vector<float> &batch) {
+      info->RecordMaxValue(batch);
+      info->RecordMaxValueArray(batch);
+    },
+    [](DivergInfo *dst, const DivergInfo &src) { dst->MergeMaxValue(src); });
+  infos[kNodeName][0]->UpdateInterval();
+  run_shards([](DivergInfo *info, const std::vector<float> &batch) { info->UpdateHistogram(batch); },
+             [](DivergInfo *dst, const DivergInfo &src) { dst->MergeBinCounts(src); });
+  Calibrator::ApplyBinCounts(&infos);
+  infos[kNodeName][0]->ComputeThreshold();
+  return infos;
+}
+}  // namespace
+
+// counting values per bin and adding the counts gives the histogram adding 1.0f per value did, up to saturation
+TEST_F(PostTrainingQuantizerTest, TestApplyBinCounts) {
+  DivergInfo info(nullptr, 4, 8, 255, 0, kMethodKL);
+  info.bin_counts = {0, 1, 1000, 16777300};
+  auto expect = info.histogram;
+  for (size_t i = 0; i < expect.size(); i++) {
+    for (uint64_t j = 0; j < info.bin_counts[i]; j++) {
+      expect[i] += 1.0f;
+    }
+  }
+  info.ApplyBinCounts();
+  ExpectBitEqual(expect, info.histogram);
+  EXPECT_TRUE(info.bin_counts.empty());
+}
+
+TEST_F(PostTrainingQuantizerTest, TestShardedCalibrationMatchesSerial) {
+  auto graph = std::make_shared<FuncGraph>();
+  auto cnode = graph->NewCNode(std::vector<AnfNodePtr>{NewValueNode(std::make_shared<Primitive>("Conv2D"))});
+  cnode->set_fullname_with_scope(kNodeName);
+  auto batches = RandomBatches(13, 997);
+  for (auto method_x : {kMethodKL, kMethodMaxMin, kMethodOutlier}) {
+    auto serial = CalibrateSerial(cnode, method_x, batches);
+    auto &expect = serial[kNodeName][0];
+    for (size_t shard_num : {2, 3, 5, 13}) {
+      auto sharded = CalibrateSharded(cnode, method_x, batches, shard_num);
+      auto &actual = sharded[kNodeName][0];
+      ASSERT_TRUE(BitEqual(expect->max, actual->max));
+      ASSERT_TRUE(BitEqual(expect->min, actual->min));
+      ExpectBitEqual(expect->max_datas, actual->max_datas);
+      ExpectBitEqual(expect->min_datas, actual->min_datas);
+      ASSERT_TRUE(BitEqual(expect->interval, actual->interval));
+      ExpectBitEqual(expect->histogram, actual->histogram);
+      ASSERT_TRUE(BitEqual(expect->best_T, actual->best_T)) << method_x << " with " << shard_num << " shards";
+      ASSERT_TRUE(BitEqual(expect->percent_result.first, actual->percent_result.first));
+      ASSERT_TRUE(BitEqual(expect->percent_result.second, actual->percent_result.second));
+    }
+  }
+}
+}  // namespace quant
+}  // namespace lite
+}  // namespace mindspore
@@ -18,14 +18,21 @@
 #define __STDC_FORMAT_MACROS
 #include <cinttypes>
 #undef __STDC_FORMAT_MACROS
+#ifdef __linux__
+#endif
 #include <algorithm>
+#include <atomic>
 #include <utility>
 #include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 #include "include/context.h"
 #include "include/ms_tensor.h"
 #include "include/version.h"
 #include "src/common/common.h"
 #include "src/runtime/runtime_api.h"
+#include "nnacl/int8/x86_simd_int8.h"
 
 namespace mindspore {
 namespace lite {
@@ -325,24 +332,74 @@ int Benchmark::CompareDataGetTotalBiasAndSize(const std::string &name, tensor::M
   return RET_OK;
 }
 
+namespace {
+// threads competing for the cpu with the ones of the benchmark while they live
+class BusyThreads {
+ public:
+  explicit BusyThreads(int thread_num) {
+    for (int i = 0; i < thread_num; i++) {
+      threads_.emplace_back([this]() {
+        uint64_t value = 0;
+        while (!stop_.load(std::memory_order_relaxed)) {
+          value = value * 6364136223846793005ULL + 1442695040888963407ULL;
+        }
+        sink_ += value;
+      });
+    }
+  }
+
+  ~BusyThreads() {
+    stop_ = true;
+    for (auto &thread : threads_) {
+      thread.join();
+    }
+  }
+
+ private:
+  std::atomic<bool> stop_{false};
+  std::atomic<uint64_t> sink_{0};
+  std::vector<std::thread> threads_;
+};
+
+void PrintLatencyStats(const std::string &title, const LatencyStats &stats) {
+  MS_LOG(INFO) << title << ", P50RunTime = " << stats.p50 / 1000.0f << ", P90RunTime = " << stats.p90 / 1000.0f
+               << ", P99RunTime = " << stats.p99 / 1000.0f << ", P999RunTime = " << stats.p999 / 1000.0f;
+  printf("%s, P50RunTime = %f ms, P90RunTime = %f ms, P99RunTime = %f ms, P999RunTime = %f ms\n", title.c_str(),
+         stats.p50 / 1000.0f, stats.p90 / 1000.0f, stats.p99 / 1000.0f, stats.p999 / 1000.0f);
+}
+}  // namespace
+
 int Benchmark::MarkPerformance() {
   MS_LOG(INFO) << "Running warm up loops...";
   std::cout << "Running warm up loops..." << std::endl;
   for (int i = 0; i < flags_->warm_up_loop_count_; i++) {
+    auto start = GetTimeUs();
     auto status = session_->RunGraph();
     if (status != 0) {
       MS_LOG(ERROR) << "Inference error " << status;
       std::cerr << "Inference error " << status << std::endl;
       return status;
     }
+    heap_high_water_ = std::max(heap_high_water_, GetHeapInUse());
+    if (i == 0) {
+      // together with PrepareTime the latency of a cold start
+      auto end = GetTimeUs();
+      first_run_time_ = end - start;
+      MS_LOG(INFO) << "FirstRunTime = " << (end - start) / 1000.0f << " ms";
+      std::cout << "FirstRunTime = " << (end - start) / 1000.0f << " ms" << std::endl;
+    }
   }
 
   MS_LOG(INFO) << "Running benchmark loops...";
   std::cout << "Running benchmark loops..." << std::endl;
-  uint64_t time_min = 1000000;
-  uint64_t time_max = 0;
-  uint64_t time_avg = 0;
-
+  std::unique_ptr<BusyThreads> busy_threads;
+  if (flags_->busy_threads_ > 0) {
+    MS_LOG(INFO) << "BusyThreads = " << flags_->busy_threads_;
+    std::cout << "BusyThreads = " << flags_->busy_threads_ << std::endl;
+    busy_threads = std::make_unique<BusyThreads>(flags_->busy_threads_);
+  }
+  std::vector<uint64_t> times;
+  times.reserve(flags_->loop_count_);
   for (int i = 0; i < flags_->loop_count_; i++) {
     session_->BindThread(true);
     auto start = GetTimeUs();
@@ -355,12 +412,11 @@ int Benchmark::MarkPerformance() {
     }
 
     auto end = GetTimeUs();
-    auto time = end - start;
-    time_min = std::min(time_min, time);
-    time_max = std::max(time_max, time);
-    time_avg += time;
+    times.push_back(end - start);
     session_->BindThread(false);
+    heap_high_water_ = std::max(heap_high_water_, GetHeapInUse());
   }
+  busy_threads.reset();
 
   if (flags_->time_profiling_) {
     const std::vector<std::string> per_op_name = {"opName", "avg(ms)", "percent", "calledTimes", "opTotalTime"};
@@ -370,13 +426,265 @@ int Benchmark::MarkPerformance() {
   }
 
   if (flags_->loop_count_ > 0) {
-    time_avg /= flags_->loop_count_;
+    perf_stats_ = ComputeLatencyStats(times);
     MS_LOG(INFO) << "Model = " << flags_->model_file_.substr(flags_->model_file_.find_last_of(DELIM_SLASH) + 1).c_str()
-                 << ", NumThreads = " << flags_->num_threads_ << ", MinRunTime = " << time_min / 1000.0f
-                 << ", MaxRuntime = " << time_max / 1000.0f << ", AvgRunTime = " << time_avg / 1000.0f;
+                 << ", NumThreads = " << flags_->num_threads_ << ", MinRunTime = " << perf_stats_.min / 1000.0f
+                 << ", MaxRuntime = " << perf_stats_.max / 1000.0f << ", AvgRunTime = " << perf_stats_.avg / 1000.0f;
     printf("Model = %s, NumThreads = %d, MinRunTime = %f ms, MaxRuntime = %f ms, AvgRunTime = %f ms\n",
            flags_->model_file_.substr(flags_->model_file_.find_last_of(DELIM_SLASH) + 1).c_str(), flags_->num_threads_,
-           time_min / 1000.0f, time_max / 1000.0f, time_avg / 1000.0f);
+           perf_stats_.min / 1000.0f, perf_stats_.max / 1000.0f, perf_stats_.avg / 1000.0f);
+    PrintLatencyStats("LoopCount = " + std::to_string(flags_->loop_count_), perf_stats_);
+  }
+  peak_rss_kb_ = GetPeakRssKb();
+  MS_LOG(INFO) << "PeakRSS = " << peak_rss_kb_ << " KB, HeapHighWater = " << heap_high_water_ / 1024 << " KB";
+  printf("PeakRSS = %zu KB, HeapHighWater = %zu KB\n", peak_rss_kb_, heap_high_water_ / 1024);
+  return RET_OK;
+}
+
+session::LiteSession *Benchmark::CreateCompiledSession(const std::string &model_file, const Context *context) {
+  size_t size = 0;
+  char *graph_buf = ReadFile(model_file.c_str(), &size);
+  if (graph_buf == nullptr) {
+    MS_LOG(ERROR) << "Read model file failed: " << model_file;
+    return nullptr;
+  }
+  auto model = std::shared_ptr<Model>(lite::Model::Import(graph_buf, size));
+  delete[](graph_buf);
+  if (model == nullptr) {
+    MS_LOG(ERROR) << "Import model file failed: " << model_file;
+    return nullptr;
+  }
+  auto session = session::LiteSession::CreateSession(context);
+  if (session == nullptr) {
+    MS_LOG(ERROR) << "CreateSession failed: " << model_file;
+    return nullptr;
+  }
+  if (session->CompileGraph(model.get()) != RET_OK) {
+    MS_LOG(ERROR) << "CompileGraph failed: " << model_file;
+    delete session;
+    return nullptr;
+  }
+  if (!flags_->resize_dims_.empty() && session->Resize(session->GetInputs(), flags_->resize_dims_) != RET_OK) {
+    MS_LOG(ERROR) << "Input tensor resize failed: " << model_file;
+    delete session;
+    return nullptr;
+  }
+  model->Free();
+  return session;
+}
+
+int Benchmark::CopyInputs(session::LiteSession *session) {
+  auto inputs = session->GetInputs();
+  if (inputs.size() != ms_inputs_.size()) {
+    MS_LOG(ERROR) << "Session has " << inputs.size() << " inputs, benchmarked session has " << ms_inputs_.size();
+    return RET_ERROR;
+  }
+  for (size_t i = 0; i < inputs.size(); i++) {
+    if (inputs[i]->data_type() != ms_inputs_[i]->data_type() || inputs[i]->Size() != ms_inputs_[i]->Size()) {
+      MS_LOG(ERROR) << "Input " << i << " of session differs from the benchmarked session";
+      return RET_ERROR;
+    }
+    memcpy(inputs[i]->MutableData(), ms_inputs_[i]->MutableData(), inputs[i]->Size());
+  }
+  return RET_OK;
+}
+
+int Benchmark::TimeRunGraph(session::LiteSession *session, std::vector<uint64_t> *times,
+                            const std::function<void()> &after_warm_up) {
+  int warm_up_status = RET_OK;
+  for (int i = 0; i < flags_->warm_up_loop_count_ && warm_up_status == RET_OK; i++) {
+    warm_up_status = session->RunGraph();
+  }
+  // called on failure too, the caller may be waiting for every session to warm up
+  if (after_warm_up != nullptr) {
+    after_warm_up();
+  }
+  if (warm_up_status != RET_OK) {
+    MS_LOG(ERROR) << "Inference error " << warm_up_status;
+    return warm_up_status;
+  }
+  for (int i = 0; i < flags_->loop_count_; i++) {
+    session->BindThread(true);
+    auto start = GetTimeUs();
+    auto status = session->RunGraph();
+    auto time = GetTimeUs() - start;
+    session->BindThread(false);
+    if (status != RET_OK) {
+      MS_LOG(ERROR) << "Inference error " << status;
+      return status;
+    }
+    times->push_back(time);
+  }
+  return RET_OK;
+}
+
+int Benchmark::MarkFp32Comparison(const Context *context) {
+  MS_LOG(INFO) << "MarkFp32Comparison";
+  std::cout << "MarkFp32Comparison" << std::endl;
+  auto session = std::shared_ptr<session::LiteSession>(CreateCompiledSession(flags_->fp32_model_file_, context));
+  if (session == nullptr) {
+    std::cerr << "Compile float32 model failed: " << flags_->fp32_model_file_ << std::endl;
+    return RET_ERROR;
+  }
+  if (CopyInputs(session.get()) != RET_OK) {
+    std::cerr << "Inputs of the float32 model differ from the quantized model" << std::endl;
+    return RET_ERROR;
+  }
+  if (session_->RunGraph() != RET_OK || session->RunGraph() != RET_OK) {
+    MS_LOG(ERROR) << "Inference error";
+    std::cerr << "Inference error" << std::endl;
+    return RET_ERROR;
+  }
+
+  // outputs of both models, by the tensor names the converter keeps
+  printf("%-32s %16s %16s %16s\n", "Output", "MeanAbsError", "MaxAbsError", "CosineSimilarity");
+  for (auto &name : session->GetOutputTensorNames()) {
+    auto fp32_output = session->GetOutputByTensorName(name);
+    auto quant_output = session_->GetOutputByTensorName(name);
+    if (fp32_output == nullptr || quant_output == nullptr || fp32_output->data_type() != kNumberTypeFloat32 ||
+        quant_output->data_type() != kNumberTypeFloat32 || fp32_output->Size() != quant_output->Size()) {
+      printf("%-32s %16s\n", name.c_str(), "not comparable");
+      continue;
+    }
+    auto fp32_data = reinterpret_cast<const float *>(fp32_output->MutableData());
+    auto quant_data = reinterpret_cast<const float *>(quant_output->MutableData());
+    double total_error = 0;
+    double max_error = 0;
+    double dot = 0;
+    double fp32_norm = 0;
+    double quant_norm = 0;
+    int num = fp32_output->ElementsNum();
+    for (int i = 0; i < num; i++) {
+      double error = std::fabs(fp32_data[i] - quant_data[i]);
+      total_error += error;
+      max_error = std::max(max_error, error);
+      dot += static_cast<double>(fp32_data[i]) * quant_data[i];
+      fp32_norm += static_cast<double>(fp32_data[i]) * fp32_data[i];
+      quant_norm += static_cast<double>(quant_data[i]) * quant_data[i];
+    }
+    double cosine = fp32_norm > 0 && quant_norm > 0 ? dot / std::sqrt(fp32_norm * quant_norm) : 0;
+    printf("%-32s %16f %16f %16f\n", name.c_str(), num > 0 ? total_error / num : 0, max_error, cosine);
+  }
+
+  std::vector<uint64_t> times;
+  auto status = TimeRunGraph(session.get(), &times);
+  if (status != RET_OK) {
+    MS_LOG(ERROR) << "Run float32 model error " << status;
+    std::cerr << "Run float32 model error " << status << std::endl;
+    return status;
+  }
+  auto fp32_stats = ComputeLatencyStats(times);
+  printf("%-32s %16s %16s %16s %16s\n", "Model", "MinRunTime(ms)", "MaxRunTime(ms)", "AvgRunTime(ms)",
+         "P99RunTime(ms)");
+  printf("%-32s %16f %16f %16f %16f\n",
+         flags_->model_file_.substr(flags_->model_file_.find_last_of(DELIM_SLASH) + 1).c_str(),
+         perf_stats_.min / 1000.0f, perf_stats_.max / 1000.0f, perf_stats_.avg / 1000.0f, perf_stats_.p99 / 1000.0f);
+  printf("%-32s %16f %16f %16f %16f\n",
+         flags_->fp32_model_file_.substr(flags_->fp32_model_file_.find_last_of(DELIM_SLASH) + 1).c_str(),
+         fp32_stats.min / 1000.0f, fp32_stats.max / 1000.0f, fp32_stats.avg / 1000.0f, fp32_stats.p99 / 1000.0f);
+  if (perf_stats_.avg > 0) {
+    printf("Speedup of the quantized model = %f\n", static_cast<float>(fp32_stats.avg) / perf_stats_.avg);
+  }
+  return RET_OK;
+}
+
+int Benchmark::MarkConcurrency(const Context *context) {
+  MS_LOG(INFO) << "MarkConcurrency, NumSessions = " << flags_->num_sessions_;
+  std::cout << "MarkConcurrency, NumSessions = " << flags_->num_sessions_ << std::endl;
+  // sessions are not thread safe, every thread runs its own, sharing the packed weights of the model
+  std::vector<std::shared_ptr<session::LiteSession>> sessions;
+  for (int i = 0; i < flags_->num_sessions_; i++) {
+    auto session = std::shared_ptr<session::LiteSession>(CreateCompiledSession(flags_->model_file_, context));
+    if (session == nullptr || CopyInputs(session.get()) != RET_OK) {
+      std::cerr << "Create session " << i << " failed" << std::endl;
+      return RET_ERROR;
+    }
+    sessions.push_back(session);
+  }
+  std::vector<std::vector<uint64_t>> times(sessions.size());
+  std::vector<int> status(sessions.size(), RET_OK);
+  // the qps clock starts once every session is warmed up, the benchmark loops start together
+  std::mutex warm_up_mutex;
+  std::condition_variable warm_up_cond;
+  size_t warmed_up_num = 0;
+  bool start_loops = false;
+  auto wait_for_start = [&]() {
+    std::unique_lock<std::mutex> lock(warm_up_mutex);
+    warmed_up_num++;
+    warm_up_cond.notify_all();
+    warm_up_cond.wait(lock, [&]() { return start_loops; });
+  };
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < sessions.size(); i++) {
+    threads.emplace_back([&, i]() { status[i] = TimeRunGraph(sessions[i].get(), &times[i], wait_for_start); });
+  }
+  uint64_t start = 0;
+  {
+    std::unique_lock<std::mutex> lock(warm_up_mutex);
+    warm_up_cond.wait(lock, [&]() { return warmed_up_num == sessions.size(); });
+    start = GetTimeUs();
+    start_loops = true;
+  }
+  warm_up_cond.notify_all();
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  auto wall_time = GetTimeUs() - start;
+  std::vector<uint64_t> all_times;
+  for (size_t i = 0; i < sessions.size(); i++) {
+    if (status[i] != RET_OK) {
+      MS_LOG(ERROR) << "Run session " << i << " error " << status[i];
+      std::cerr << "Run session " << i << " error " << status[i] << std::endl;
+      return status[i];
+    }
+    all_times.insert(all_times.end(), times[i].begin(), times[i].end());
+  }
+  heap_high_water_ = std::max(heap_high_water_, GetHeapInUse());
+  peak_rss_kb_ = GetPeakRssKb();
+  concurrent_stats_ = ComputeLatencyStats(all_times);
+  concurrent_qps_ = wall_time > 0 ? all_times.size() * 1000000.0 / wall_time : 0;
+  MS_LOG(INFO) << "NumSessions = " << flags_->num_sessions_ << ", QPS = " << concurrent_qps_
+               << ", AvgRunTime = " << concurrent_stats_.avg / 1000.0f;
+  printf("NumSessions = %d, QPS = %f, AvgRunTime = %f ms\n", flags_->num_sessions_, concurrent_qps_,
+         concurrent_stats_.avg / 1000.0f);
+  PrintLatencyStats("NumSessions = " + std::to_string(flags_->num_sessions_), concurrent_stats_);
+  printf("PeakRSS = %zu KB, HeapHighWater = %zu KB\n", peak_rss_kb_, heap_high_water_ / 1024);
+  return RET_OK;
+}
+
+int Benchmark::WriteJsonResult() {
+  std::ofstream out(flags_->output_json_file_);
+  if (!out.is_open()) {
+    MS_LOG(ERROR) << "Open json file failed: " << flags_->output_json_file_;
+    std::cerr << "Open json file failed: " << flags_->output_json_file_ << std::endl;
+    return RET_ERROR;
+  }
+  // times in us
+  out << "{\n";
+  out << "  \"model\": \""
+      << JsonEscape(flags_->model_file_.substr(flags_->model_file_.find_last_of(DELIM_SLASH) + 1)) << "\",\n";
+  out << "  \"device\": \"" << JsonEscape(flags_->device_) << "\",\n";
+  out << "  \"num_threads\": " << flags_->num_threads_ << ",\n";
+  out << "  \"loop_count\": " << flags_->loop_count_ << ",\n";
+  out << "  \"busy_threads\": " << flags_->busy_threads_ << ",\n";
+  out << "  \"prepare_time\": " << prepare_time_ << ",\n";
+  out << "  \"first_run_time\": " << first_run_time_ << ",\n";
+  out << "  \"latency\": ";
+  WriteJsonLatency(&out, perf_stats_);
+  out << ",\n";
+  out << "  \"memory\": {\"peak_rss_kb\": " << peak_rss_kb_ << ", \"heap_high_water_bytes\": " << heap_high_water_
+      << "}";
+  if (flags_->num_sessions_ > 1) {
+    out << ",\n  \"concurrency\": {\"num_sessions\": " << flags_->num_sessions_ << ", \"qps\": " << concurrent_qps_
+        << ", \"latency\": ";
+    WriteJsonLatency(&out, concurrent_stats_);
+    out << "}";
+  }
+  out << "\n}\n";
+  out.close();
+  if (out.fail()) {
+    MS_LOG(ERROR) << "Write json file failed: " << flags_->output_json_file_;
+    return RET_ERROR;
   }
   return RET_OK;
 }
@@ -504,6 +812,7 @@ int Benchmark::RunBenchmark() {
   }
 
   context->thread_num_ = flags_->num_threads_;
+  context->enable_parallel_ = flags_->enable_parallel_;
 
   session_ = session::LiteSession::CreateSession(context.get());
   if (session_ == nullptr) {
@@ -511,12 +820,17 @@ int Benchmark::RunBenchmark() {
     std::cout << "CreateSession failed while running ", model_name.c_str();
     return RET_ERROR;
   }
+  auto start_compile_time = GetTimeUs();
   auto ret = session_->CompileGraph(model.get());
   if (ret != RET_OK) {
     MS_LOG(ERROR) << "CompileGraph failed while running ", model_name.c_str();
     std::cout << "CompileGraph failed while running ", model_name.c_str();
     return ret;
   }
+  // kernel Init, packing weights not packed by the converter, takes most of the cold start
+  auto end_compile_time = GetTimeUs();
+  MS_LOG(INFO) << "CompileGraphTime = " << (end_compile_time - start_compile_time) / 1000.0f << " ms";
+  std::cout << "CompileGraphTime = " << (end_compile_time - start_compile_time) / 1000.0f << " ms" << std::endl;
   if (!flags_->resize_dims_.empty()) {
     ret = session_->Resize(session_->GetInputs(), flags_->resize_dims_);
     if (ret != RET_OK) {
@@ -530,6 +844,7 @@ int Benchmark::RunBenchmark() {
   }
   ms_inputs_ = session_->GetInputs();
   auto end_prepare_time = GetTimeUs();
+  prepare_time_ = end_prepare_time - start_prepare_time;
   MS_LOG(INFO) << "PrepareTime = " << (end_prepare_time - start_prepare_time) / 1000 << " ms";
   std::cout << "PrepareTime = " << (end_prepare_time - start_prepare_time) / 1000 << " ms" << std::endl;
 
@@ -561,6 +876,30 @@ int Benchmark::RunBenchmark() {
       std::cout << "Run MarkPerformance error: " << status << std::endl;
       return status;
     }
+    if (!flags_->fp32_model_file_.empty()) {
+      status = MarkFp32Comparison(context.get());
+      if (status != 0) {
+        MS_LOG(ERROR) << "Run MarkFp32Comparison error: " << status;
+        std::cout << "Run MarkFp32Comparison error: " << status << std::endl;
+        return status;
+      }
+    }
+    if (flags_->num_sessions_ > 1) {
+      status = MarkConcurrency(context.get());
+      if (status != 0) {
+        MS_LOG(ERROR) << "Run MarkConcurrency error: " << status;
+        std::cout << "Run MarkConcurrency error: " << status << std::endl;
+        return status;
+      }
+    }
+    if (!flags_->output_json_file_.empty()) {
+      status = WriteJsonResult();
+      if (status != 0) {
+        MS_LOG(ERROR) << "Write json result error: " << status;
+        std::cout << "Write json result error: " << status << std::endl;
+        return status;
+      }
+    }
   }
   return RET_OK;
 }
@@ -656,8 +995,15 @@ int Benchmark::Init() {
   MS_LOG(INFO) << "AccuracyThreshold = " << this->flags_->accuracy_threshold_;
   MS_LOG(INFO) << "WarmUpLoopCount = " << this->flags_->warm_up_loop_count_;
   MS_LOG(INFO) << "NumThreads = " << this->flags_->num_threads_;
+  MS_LOG(INFO) << "EnableParallel = " << this->flags_->enable_parallel_;
   MS_LOG(INFO) << "Fp16Priority = " << this->flags_->enable_fp16_;
   MS_LOG(INFO) << "calibDataPath = " << this->flags_->benchmark_data_file_;
+  MS_LOG(INFO) << "Fp32ModelPath = " << this->flags_->fp32_model_file_;
+  MS_LOG(INFO) << "NumSessions = " << this->flags_->num_sessions_;
+  MS_LOG(INFO) << "OutputJsonPath = " << this->flags_->output_json_file_;
+  // int8 kernels of x86 dispatch to 0 for C, 1 for AVX2 and 2 for AVX-512 VNNI
+  MS_LOG(INFO) << "Int8SimdLevel = " << GetInt8SimdLevel();
+  std::cout << "Int8SimdLevel = " << GetInt8SimdLevel() << std::endl;
 
   if (this->flags_->loop_count_ < 1) {
     MS_LOG(ERROR) << "LoopCount:" << this->flags_->loop_count_ << " must be greater than 0";
@@ -671,6 +1017,18 @@ int Benchmark::Init() {
     return RET_ERROR;
   }
 
+  if (this->flags_->busy_threads_ < 0) {
+    MS_LOG(ERROR) << "busyThreads:" << this->flags_->busy_threads_ << " must not be negative";
+    std::cerr << "busyThreads:" << this->flags_->busy_threads_ << " must not be negative" << std::endl;
+    return RET_ERROR;
+  }
+
+  if (this->flags_->num_sessions_ < 1) {
+    MS_LOG(ERROR) << "numSessions:" << this->flags_->num_sessions_ << " must be greater than 0";
+    std::cerr << "numSessions:" << this->flags_->num_sessions_ << " must be greater than 0" << std::endl;
+    return RET_ERROR;
+  }
+
   if (this->flags_->cpu_bind_mode_ == 2) {
     MS_LOG(INFO) << "cpuBindMode = MID_CPU";
     std::cout << "cpuBindMode = MID_CPU" << std::endl;
@@ -27,13 +27,16 @@
 #include <string>
 #include <vector>
 #include <memory>
+#include <functional>
 #include <cfloat>
 #include <utility>
 #include "include/model.h"
 #include "tools/common/flag_parser.h"
+#include "tools/common/run_stats.h"
 #include "src/common/file_utils.h"
 #include "src/common/utils.h"
 #include "include/lite_session.h"
+#include "include/context.h"
 
 namespace mindspore::lite {
 enum MS_API InDataType { kImage = 0, kBinary = 1 };
@@ -66,8 +69,18 @@ class MS_API BenchmarkFlags : public virtual FlagParser {
     AddFlag(&BenchmarkFlags::loop_count_, "loopCount", "Run loop count", 10);
     AddFlag(&BenchmarkFlags::num_threads_, "numThreads", "Run threads number", 2);
     AddFlag(&BenchmarkFlags::enable_fp16_, "enableFp16", "Enable float16", false);
+    AddFlag(&BenchmarkFlags::enable_parallel_, "enableParallel",
+            "Run independent branches of the graph concurrently on the thread pool", false);
     AddFlag(&BenchmarkFlags::warm_up_loop_count_, "warmUpLoopCount", "Run warm up loop", 3);
     AddFlag(&BenchmarkFlags::time_profiling_, "timeProfiling", "Run time profiling", false);
+    AddFlag(&BenchmarkFlags::fp32_model_file_, "fp32ModelFile",
+            "Float32 model the quantized modelFile comes from, run on the same input and shown side by side", "");
+    AddFlag(&BenchmarkFlags::num_sessions_, "numSessions",
+            "Sessions of the model run concurrently, each in its own thread, to measure throughput", 1);
+    AddFlag(&BenchmarkFlags::busy_threads_, "busyThreads",
+            "Threads spinning on the cpu while the benchmark loops run, to measure the latency under contention", 0);
+    AddFlag(&BenchmarkFlags::output_json_file_, "outputJsonFile",
+            "Write the latency, memory and throughput results to this json file", "");
     // MarkAccuracy
     AddFlag(&BenchmarkFlags::benchmark_data_file_, "benchmarkDataFile", "Benchmark data file path", "");
     AddFlag(&BenchmarkFlags::benchmark_data_type_, "benchmarkDataType",
@@ -95,8 +108,13 @@ class MS_API BenchmarkFlags : public virtual FlagParser {
   int loop_count_ = 10;
   int num_threads_ = 2;
   bool enable_fp16_ = false;
+  bool enable_parallel_ = false;
   int warm_up_loop_count_ = 3;
   bool time_profiling_ = false;
+  std::string fp32_model_file_;
+  int num_sessions_ = 1;
+  int busy_threads_ = 0;
+  std::string output_json_file_;
   // MarkAccuracy
   std::string benchmark_data_file_;
   std::string benchmark_data_type_ = "FLOAT";
@@ -228,6 +246,25 @@ class MS_API Benchmark {
 
   int MarkAccuracy();
 
+  // read, import and compile model_file into a new session, resized like session_
+  session::LiteSession *CreateCompiledSession(const std::string &model_file, const Context *context);
+
+  // copy the input data of session_ into the inputs of session
+  int CopyInputs(session::LiteSession *session);
+
+  // warm up and benchmark loops of session, appending the run time of every loop to times, and calling
+  // after_warm_up, if set, in between
+  int TimeRunGraph(session::LiteSession *session, std::vector<uint64_t> *times,
+                   const std::function<void()> &after_warm_up = nullptr);
+
+  // run the float32 model on the input of the quantized one, print their outputs and run times side by side
+  int MarkFp32Comparison(const Context *context);
+
+  // run numSessions sessions of the model in parallel threads, print the aggregate throughput and latencies
+  int MarkConcurrency(const Context *context);
+
+  int WriteJsonResult();
+
  private:
   BenchmarkFlags *flags_;
   session::LiteSession *session_{nullptr};
@@ -249,6 +286,16 @@ class MS_API Benchmark {
 
   KernelCallBack before_call_back_;
   KernelCallBack after_call_back_;
+
+  // results of MarkPerformance and MarkConcurrency, times in us
+  uint64_t prepare_time_ = 0;
+  uint64_t first_run_time_ = 0;
+  LatencyStats perf_stats_;
+  LatencyStats concurrent_stats_;
+  double concurrent_qps_ = 0;
+  // peak resident set size of the process and high-water of the heap bytes in use after a run, 0 if unknown
+  size_t peak_rss_kb_ = 0;
+  size_t heap_high_water_ = 0;
 };
 
 int MS_API RunBenchmark(int argc, const char **argv);
@@ -0,0 +1,118 @@
+/**
+ * Copyright 2021 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tools/common/run_stats.h"
+#ifdef __linux__
+#include <malloc.h>
+#include <sys/resource.h>
+#endif
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+namespace mindspore {
+namespace lite {
+uint64_t Percentile(const std::vector<uint64_t> &sorted_times, double percent) {
+  if (sorted_times.empty()) {
+    return 0;
+  }
+  // the epsilon keeps 99.9% of 1000 at rank 999 despite rounding
+  auto rank = static_cast<size_t>(std::ceil(percent / 100 * sorted_times.size() - 1e-6));
+  return sorted_times[std::min(std::max(rank, static_cast<size_t>(1)), sorted_times.size()) - 1];
+}
+
+LatencyStats ComputeLatencyStats(std::vector<uint64_t> times) {
+  LatencyStats stats;
+  if (times.empty()) {
+    return stats;
+  }
+  std::sort(times.begin(), times.end());
+  stats.min = times.front();
+  stats.max = times.back();
+  uint64_t total = 0;
+  for (auto time : times) {
+    total += time;
+  }
+  stats.avg = total / times.size();
+  stats.p50 = Percentile(times, 50);
+  stats.p90 = Percentile(times, 90);
+  stats.p99 = Percentile(times, 99);
+  stats.p999 = Percentile(times, 99.9);
+  return stats;
+}
+
+void WriteJsonLatency(std::ostream *out, const LatencyStats &stats) {
+  *out << "{\"min\": " << stats.min << ", \"max\": " << stats.max << ", \"avg\": " << stats.avg
+       << ", \"p50\": " << stats.p50 << ", \"p90\": " << stats.p90 << ", \"p99\": " << stats.p99
+       << ", \"p999\": " << stats.p999 << "}";
+}
+
+std::string JsonEscape(const std::string &str) {
+  std::string escaped;
+  escaped.reserve(str.size());
+  for (auto c : str) {
+    switch (c) {
+      case '"':
+        escaped += "\\\"";
+        break;
+      case '\\':
+        escaped += "\\\\";
+        break;
+      case '\n':
+        escaped += "\\n";
+        break;
+      case '\t':
+        escaped += "\\t";
+        break;
+      default:
+        if (static_cast<unsigned char>(c) < 0x20) {
+          char code[8];
+          snprintf(code, sizeof(code), "\\u%04x", static_cast<unsigned char>(c));
+          escaped += code;
+        } else {
+          escaped += c;
+        }
+        break;
+    }
+  }
+  return escaped;
+}
+
+size_t GetPeakRssKb() {
+#ifdef __linux__
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) == 0) {
+    // kilobytes on linux
+    return static_cast<size_t>(usage.ru_maxrss);
+  }
+#endif
+  return 0;
+}
+
+size_t GetHeapInUse() {
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+  // the int fields of mallinfo wrap above 2 GB
+  struct mallinfo2 info = mallinfo2();
+  return info.uordblks + info.hblkhd;
+#elif defined(__linux__)
+  struct mallinfo info = mallinfo();
+  return static_cast<size_t>(info.uordblks) + static_cast<size_t>(info.hblkhd);
+#else
+  return 0;
+#endif
+}
+}  // namespace lite
+}  // namespace mindspore
@@ -0,0 +1,57 @@
+/**
+ * Copyright 2021 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MINDSPORE_LITE_TOOLS_COMMON_RUN_STATS_H
+#define MINDSPORE_LITE_TOOLS_COMMON_RUN_STATS_H
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace mindspore {
+namespace lite {
+// run times in us
+struct LatencyStats {
+  uint64_t min = 0;
+  uint64_t max = 0;
+  uint64_t avg = 0;
+  uint64_t p50 = 0;
+  uint64_t p90 = 0;
+  uint64_t p99 = 0;
+  uint64_t p999 = 0;
+};
+
+// nearest rank percentile of sorted times, 0 if there is none
+uint64_t Percentile(const std::vector<uint64_t> &sorted_times, double percent);
+
+LatencyStats ComputeLatencyStats(std::vector<uint64_t> times);
+
+// write stats as a json object
+void WriteJsonLatency(std::ostream *out, const LatencyStats &stats);
+
+// str as the content of a json string, quotes, backslashes and control characters escaped
+std::string JsonEscape(const std::string &str);
+
+// peak resident set size of the process in KB, 0 if unknown
+size_t GetPeakRssKb();
+
+// heap bytes in use, 0 if unknown
+size_t GetHeapInUse();
+}  // namespace lite
+}  // namespace mindspore
+
+#endif  // MINDSPORE_LITE_TOOLS_COMMON_RUN_STATS_H
@@ -19,6 +19,7 @@
 #include <string>
 #include <algorithm>
 #include "ir/dtype/type_id.h"
+#include "nnacl/op_base.h"
 
 namespace mindspore {
 namespace lite {
@@ -46,6 +47,10 @@ Flags::Flags() {
           "whether the model is going to be trained on device."
           "true | false",
           "false");
+  AddFlag(&Flags::packWeightTargetIn, "packWeightTarget",
+          "Store fp32 weights also packed for the kernels of the target, so that they are not packed at runtime. "
+          "NONE | ARM64 | ARM32 | X86_SSE | X86_AVX",
+          "NONE");
 }
 
 int Flags::Init(int argc, const char **argv) {
@@ -158,6 +163,18 @@ int Flags::Init(int argc, const char **argv) {
     return RET_INPUT_PARAM_INVALID;
   }
 
+  if (this->packWeightTargetIn == "NONE") {
+    this->packWeightTile = 0;
+  } else if (this->packWeightTargetIn == "ARM64" || this->packWeightTargetIn == "ARM32" ||
+             this->packWeightTargetIn == "X86_SSE") {
+    this->packWeightTile = C8NUM;
+  } else if (this->packWeightTargetIn == "X86_AVX") {
+    this->packWeightTile = C16NUM;
+  } else {
+    std::cerr << "INPUT ILLEGAL: packWeightTarget must be NONE|ARM64|ARM32|X86_SSE|X86_AVX";
+    return RET_INPUT_PARAM_INVALID;
+  }
+
   if (this->trainModel == true) {
     if (this->fmk != FmkType_MS) {
       std::cerr << "INPUT ILLEGAL: train model convertor supporting only MINDIR format";
@@ -175,6 +192,10 @@ int Flags::Init(int argc, const char **argv) {
       std::cerr << "INPUT ILLEGAL: train model convertor is not supporting quantization";
       return RET_INPUT_PARAM_INVALID;
     }
+    if (this->packWeightTile != 0) {
+      std::cerr << "INPUT ILLEGAL: train model convertor is not supporting weight packing";
+      return RET_INPUT_PARAM_INVALID;
+    }
   }
   return RET_OK;
 }
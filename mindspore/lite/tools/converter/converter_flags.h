@@ -65,6 +65,9 @@ class Flags : public virtual mindspore::lite::FlagParser {
   std::string quantWeightChannel;
   std::string trainModelIn;
   bool trainModel = false;
+  // used for offline weight packing, col tile of the target kernels, 0 if weights are not packed
+  std::string packWeightTargetIn;
+  int packWeightTile = 0;
 };
 }  // namespace converter
 }  // namespace lite
@@ -37,6 +37,8 @@
 #include "tools/converter/legacy_optimizer/graph/tensor_name_pass.h"
 #include "tools/converter/legacy_optimizer/graph/infer_quant_param_pass.h"
 #include "tools/converter/legacy_optimizer/graph/set_unused_quant_param_to_default_pass.h"
+#include "tools/converter/legacy_optimizer/graph/weight_pack_pass.h"
+#include "tools/converter/legacy_optimizer/graph/elementwise_fusion_pass.h"
 
 using std::string;
 namespace mindspore::lite {
@@ -144,6 +146,30 @@ int GraphDefTransform::Transform(const converter::Flags &ctx) {
     }
   }
 
+  // fuse fp32 elementwise chains, the pass needs every shape
+  if (ctx.quantType == schema::QuantType_QUANT_NONE && !ctx.trainModel) {
+    Optimizer sortOptimizer;
+    sortOptimizer.AddPass(new (std::nothrow) TopologicalSortPass());
+    status = sortOptimizer.Run(graphDefT);
+    if (status != RET_OK && status != RET_NO_CHANGE) {
+      MS_LOG(ERROR) << "Run topologicalOptimizer graphPasses Failed";
+      return status;
+    }
+    InferShapePass infer_shape_pass;
+    if (infer_shape_pass.Run(graphDefT) == RET_OK) {
+      Optimizer elementwiseFusionOptimizer;
+      elementwiseFusionOptimizer.AddPass(new (std::nothrow) ElementwiseFusionPass());
+      elementwiseFusionOptimizer.AddPass(new (std::nothrow) IsolatedNodeRemovePass());
+      status = elementwiseFusionOptimizer.Run(graphDefT);
+      if (status != RET_OK && status != RET_NO_CHANGE) {
+        MS_LOG(ERROR) << "Run elementwiseFusionOptimizer graphPasses Failed";
+        return status;
+      }
+    } else {
+      MS_LOG(INFO) << "Shapes are not known before runtime, skip elementwise fusion";
+    }
+  }
+
   // do quantization
   {
     Optimizer tensorQuantOptimizer;
@@ -191,6 +217,17 @@ int GraphDefTransform::Transform(const converter::Flags &ctx) {
     }
   }
 
+  // pack weights for the runtime kernels of the target
+  if (ctx.packWeightTile != 0) {
+    Optimizer weightPackOptimizer;
+    weightPackOptimizer.AddPass(new (std::nothrow) WeightPackPass(ctx.packWeightTile));
+    status = weightPackOptimizer.Run(graphDefT);
+    if (status != RET_OK && status != RET_NO_CHANGE) {
+      MS_LOG(ERROR) << "Run weightPackOptimizer graphPasses Failed";
+      return status;
+    }
+  }
+
   // tensor name
   {
     Optimizer nameOptimizer;
@@ -0,0 +1,316 @@
+/**
+ * Copyright 2021 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tools/converter/legacy_optimizer/graph/elementwise_fusion_pass.h"
+#include <algorithm>
+#include <string>
+#include "src/common/log_adapter.h"
+#include "include/errorcode.h"
+#include "schema/inner/model_generated.h"
+#include "nnacl/fp32/fused_elementwise_fp32.h"
+
+namespace mindspore {
+namespace lite {
+namespace {
+constexpr size_t kMinChainLength = 2;
+
+bool IsKnownFloatTensor(const schema::TensorT &tensor) {
+  return tensor.dataType == kNumberTypeFloat32 && !tensor.dims.empty() &&
+         std::all_of(tensor.dims.begin(), tensor.dims.end(), [](int32_t dim) { return dim > 0; });
+}
+
+int64_t ElementNum(const std::vector<int32_t> &dims) {
+  int64_t num = 1;
+  for (auto dim : dims) {
+    num *= dim;
+  }
+  return num;
+}
+
+// the runtime kernel takes operands of the shape of the running value, a single element or one per channel
+bool IsBroadcastOperand(const schema::TensorT &operand, const std::vector<int32_t> &dims) {
+  if (!IsKnownFloatTensor(operand) || operand.dims.size() > dims.size()) {
+    return false;
+  }
+  auto num = ElementNum(operand.dims);
+  return operand.dims == dims || num == 1 || (num == dims.back() && operand.dims.back() == dims.back());
+}
+
+bool GetActivationStep(int type, float alpha, std::vector<int> *ops, std::vector<float> *alphas) {
+  int op;
+  switch (type) {
+    case schema::ActivationType_NO_ACTIVATION:
+      return true;
+    case schema::ActivationType_RELU:
+      op = FusedElementwise_Relu;
+      break;
+    case schema::ActivationType_RELU6:
+      op = FusedElementwise_Relu6;
+      break;
+    case schema::ActivationType_LEAKY_RELU:
+      op = FusedElementwise_LeakyRelu;
+      break;
+    case schema::ActivationType_SIGMOID:
+      op = FusedElementwise_Sigmoid;
+      break;
+    case schema::ActivationType_TANH:
+      op = FusedElementwise_Tanh;
+      break;
+    case schema::ActivationType_SWISH:
+      op = FusedElementwise_Swish;
+      break;
+    case schema::ActivationType_HSWISH:
+      op = FusedElementwise_HSwish;
+      break;
+    case schema::ActivationType_HSIGMOID:
+      op = FusedElementwise_HSigmoid;
+      break;
+    default:
+      return false;
+  }
+  ops->push_back(op);
+  alphas->push_back(alpha);
+  return true;
+}
+}  // namespace
+
+bool ElementwiseFusionPass::GetSteps(const schema::MetaGraphT &graph, const schema::CNodeT &node,
+                                     uint32_t running_input, std::vector<Step> *steps) {
+  if (node.outputIndex.size() != 1 || node.quantType != schema::QuantType_QUANT_NONE) {
+    return false;
+  }
+  auto &output = graph.allTensors.at(node.outputIndex.front());
+  auto &running = graph.allTensors.at(node.inputIndex.at(running_input));
+  if (!IsKnownFloatTensor(*output) || !IsKnownFloatTensor(*running) || output->dims != running->dims) {
+    return false;
+  }
+  std::vector<int> ops;
+  std::vector<float> alphas;
+  auto &value = node.primitive->value;
+  switch (value.type) {
+    case schema::PrimitiveType_Add:
+    case schema::PrimitiveType_Sub:
+    case schema::PrimitiveType_Mul:
+    case schema::PrimitiveType_Div:
+    case schema::PrimitiveType_Maximum:
+    case schema::PrimitiveType_Minimum: {
+      if (node.inputIndex.size() != 2 || node.inputIndex.at(0) == node.inputIndex.at(1)) {
+        return false;
+      }
+      auto operand = node.inputIndex.at(1 - running_input);
+      if (!IsBroadcastOperand(*graph.allTensors.at(operand), running->dims)) {
+        return false;
+      }
+      bool reverse = running_input == 1;
+      int activation_type = schema::ActivationType_NO_ACTIVATION;
+      if (value.type == schema::PrimitiveType_Add) {
+        ops.push_back(FusedElementwise_Add);
+        activation_type = value.AsAdd()->activationType;
+      } else if (value.type == schema::PrimitiveType_Sub) {
+        ops.push_back(reverse ? FusedElementwise_ReverseSub : FusedElementwise_Sub);
+        activation_type = value.AsSub()->activationType;
+      } else if (value.type == schema::PrimitiveType_Mul) {
+        ops.push_back(FusedElementwise_Mul);
+        activation_type = value.AsMul()->activationType;
+      } else if (value.type == schema::PrimitiveType_Div) {
+        ops.push_back(reverse ? FusedElementwise_ReverseDiv : FusedElementwise_Div);
+        activation_type = value.AsDiv()->activationType;
+      } else {
+        ops.push_back(value.type == schema::PrimitiveType_Maximum ? FusedElementwise_Maximum
+                                                                  : FusedElementwise_Minimum);
+      }
+      alphas.push_back(0.0f);
+      // the unfused kernels only apply relu and relu6 to their result
+      if (activation_type != schema::ActivationType_NO_ACTIVATION && activation_type != schema::ActivationType_RELU &&
+          activation_type != schema::ActivationType_RELU6) {
+        return false;
+      }
+      GetActivationStep(activation_type, 0.0f, &ops, &alphas);
+      steps->push_back({ops.front(), operand, alphas.front()});
+      if (ops.size() > 1) {
+        steps->push_back({ops.back(), 0, alphas.back()});
+      }
+      return true;
+    }
+    case schema::PrimitiveType_Scale: {
+      // x * scale + offset as a Mul and an Add step, the scale and offset spanning the dims from axis on
+      if (running_input != 0 || node.inputIndex.size() < 2 || node.inputIndex.size() > 3) {
+        return false;
+      }
+      auto scale = value.AsScale();
+      auto axis = scale->axis < 0 ? scale->axis + static_cast<int>(running->dims.size()) : scale->axis;
+      for (size_t i = 1; i < node.inputIndex.size(); ++i) {
+        auto &operand = graph.allTensors.at(node.inputIndex.at(i));
+        if (node.inputIndex.at(i) == node.inputIndex.front() || axis < 0 ||
+            axis + operand->dims.size() != running->dims.size() || !IsBroadcastOperand(*operand, running->dims)) {
+          return false;
+        }
+      }
+      if (scale->activationType != schema::ActivationType_NO_ACTIVATION &&
+          scale->activationType != schema::ActivationType_RELU &&
+          scale->activationType != schema::ActivationType_RELU6) {
+        return false;
+      }
+      // the Scale kernel may contract the multiply and add to one fma, the fused one rounds the product first
+      steps->push_back({FusedElementwise_Mul, node.inputIndex.at(1), 0.0f});
+      if (node.inputIndex.size() == 3) {
+        steps->push_back({FusedElementwise_Add, node.inputIndex.at(2), 0.0f});
+      }
+      GetActivationStep(scale->activationType, 0.0f, &ops, &alphas);
+      if (!ops.empty()) {
+        steps->push_back({ops.front(), 0, alphas.front()});
+      }
+      return true;
+    }
+    case schema::PrimitiveType_Activation: {
+      auto activation = value.AsActivation();
+      if (node.inputIndex.size() != 1 || activation->type == schema::ActivationType_NO_ACTIVATION ||
+          !GetActivationStep(activation->type, activation->alpha, &ops, &alphas)) {
+        return false;
+      }
+      break;
+    }
+    case schema::PrimitiveType_Neg:
+      ops.push_back(FusedElementwise_Neg);
+      break;
+    case schema::PrimitiveType_Abs:
+      ops.push_back(FusedElementwise_Abs);
+      break;
+    case schema::PrimitiveType_Square:
+      ops.push_back(FusedElementwise_Square);
+      break;
+    case schema::PrimitiveType_Sqrt:
+      ops.push_back(FusedElementwise_Sqrt);
+      break;
+    case schema::PrimitiveType_Rsqrt:
+      ops.push_back(FusedElementwise_Rsqrt);
+      break;
+    default:
+      return false;
+  }
+  if (node.inputIndex.size() != 1) {
+    return false;
+  }
+  steps->push_back({ops.front(), 0, alphas.empty() ? 0.0f : alphas.front()});
+  return true;
+}
+
+int ElementwiseFusionPass::GetRunningInput(const schema::MetaGraphT &graph, const schema::CNodeT &node) {
+  if (node.inputIndex.empty() || node.outputIndex.size() != 1) {
+    return -1;
+  }
+  std::vector<Step> steps;
+  for (size_t i = 0; i < node.inputIndex.size() && i < 2; ++i) {
+    if (GetSteps(graph, node, i, &steps)) {
+      return static_cast<int>(i);
+    }
+  }
+  return -1;
+}
+
+STATUS ElementwiseFusionPass::FuseChain(schema::MetaGraphT *graph, const std::vector<size_t> &chain,
+                                        uint32_t running_input, const std::vector<Step> &steps) {
+  auto attr = std::make_unique<schema::FusedElementwiseT>();
+  std::vector<uint32_t> inputs = {running_input};
+  for (auto &step : steps) {
+    attr->opTypes.push_back(step.op);
+    attr->alpha.push_back(step.alpha);
+    if (!FusedElementwiseIsBinary(step.op)) {
+      attr->operandIndex.push_back(0);
+      continue;
+    }
+    auto iter = std::find(inputs.begin(), inputs.end(), step.operand);
+    attr->operandIndex.push_back(static_cast<int>(iter - inputs.begin()));
+    if (iter == inputs.end()) {
+      inputs.push_back(step.operand);
+    }
+  }
+  auto &head = graph->nodes.at(chain.front());
+  auto &tail = graph->nodes.at(chain.back());
+  MS_LOG(INFO) << "Fuse " << chain.size() << " elementwise nodes from " << head->name << " to " << tail->name;
+  auto outputs = tail->outputIndex;
+  for (size_t i = 1; i < chain.size(); ++i) {
+    auto &node = graph->nodes.at(chain[i]);
+    fused_tensors_.insert(graph->nodes.at(chain[i - 1])->outputIndex.front());
+    node->inputIndex.clear();
+    node->outputIndex.clear();
+  }
+  auto primitive = std::make_unique<schema::PrimitiveT>();
+  primitive->value.type = schema::PrimitiveType_FusedElementwise;
+  primitive->value.value = attr.release();
+  head->primitive = std::move(primitive);
+  head->inputIndex = inputs;
+  head->outputIndex = outputs;
+  return RET_OK;
+}
+
+STATUS ElementwiseFusionPass::Run(schema::MetaGraphT *graph) {
+  MS_ASSERT(graph != nullptr);
+  fused_tensors_.clear();
+  for (size_t i = 0; i < graph->nodes.size(); ++i) {
+    auto &head = graph->nodes.at(i);
+    auto running_input = GetRunningInput(*graph, *head);
+    if (running_input < 0) {
+      continue;
+    }
+    std::vector<size_t> chain = {i};
+    std::vector<Step> steps;
+    GetSteps(*graph, *head, running_input, &steps);
+    while (true) {
+      auto tensor = graph->nodes.at(chain.back())->outputIndex.front();
+      if (std::find(graph->outputIndex.begin(), graph->outputIndex.end(), tensor) != graph->outputIndex.end()) {
+        break;
+      }
+      auto post = GetLinkedPostIdx(*graph, tensor);
+      if (post.size() != 1) {
+        break;
+      }
+      auto &next = graph->nodes.at(post.front());
+      auto input_iter = std::find(next->inputIndex.begin(), next->inputIndex.end(), tensor);
+      if (input_iter - next->inputIndex.begin() >= 2 ||
+          std::count(next->inputIndex.begin(), next->inputIndex.end(), tensor) != 1) {
+        break;
+      }
+      std::vector<Step> next_steps;
+      if (!GetSteps(*graph, *next, input_iter - next->inputIndex.begin(), &next_steps) ||
+          steps.size() + next_steps.size() > MAX_FUSED_ELEMENTWISE_STEP) {
+        break;
+      }
+      chain.push_back(post.front());
+      steps.insert(steps.end(), next_steps.begin(), next_steps.end());
+    }
+    if (chain.size() < kMinChainLength) {
+      continue;
+    }
+    auto status = FuseChain(graph, chain, head->inputIndex.at(running_input), steps);
+    if (status != RET_OK) {
+      MS_LOG(ERROR) << "FuseChain failed, node: " << head->name;
+      return status;
+    }
+  }
+  if (fused_tensors_.empty()) {
+    return RET_NO_CHANGE;
+  }
+  // the intermediate tensors of the chains are not used anymore
+  auto status = RemoveTensor(graph, std::vector<uint32_t>(fused_tensors_.begin(), fused_tensors_.end()), true);
+  if (status != RET_OK) {
+    MS_LOG(ERROR) << "Remove fused tensors failed";
+    return status;
+  }
+  return RET_OK;
+}
+}  // namespace lite
+}  // namespace mindspore
@@ -0,0 +1,62 @@
+/**
+ * Copyright 2021 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MINDSPORE_LITE_TOOLS_CONVERTER_LEGACY_OPTIMIZER_GRAPH_ELEMENTWISE_FUSION_PASS_H
+#define MINDSPORE_LITE_TOOLS_CONVERTER_LEGACY_OPTIMIZER_GRAPH_ELEMENTWISE_FUSION_PASS_H
+
+#include <memory>
+#include <set>
+#include <vector>
+#include "tools/converter/optimizer.h"
+#include "tools/common/graph_util.h"
+
+namespace mindspore {
+namespace lite {
+// Replace chains of fp32 elementwise ops (arithmetic with a scalar, per channel or same shape operand, activations
+// and unary math), each intermediate result read only by the next op of the chain, by one FusedElementwise node
+// running the ops of the chain tile by tile. Scale is fused as a Mul and an Add step. Cast is not fused, the chain
+// runs on fp32 only and a Cast breaks it. Needs the tensor shapes, InferShapePass runs before it.
+class ElementwiseFusionPass : public GraphPass {
+ public:
+  ElementwiseFusionPass() = default;
+
+  ~ElementwiseFusionPass() override = default;
+
+  STATUS Run(schema::MetaGraphT *graph) override;
+
+ private:
+  struct Step {
+    int op = 0;
+    // tensor of the operand of a binary step
+    uint32_t operand = 0;
+    float alpha = 0.0f;
+  };
+
+  // Append the steps of node, whose input running_input holds the running value, false if node can not be fused
+  bool GetSteps(const schema::MetaGraphT &graph, const schema::CNodeT &node, uint32_t running_input,
+                std::vector<Step> *steps);
+
+  // Input of node to run the chain on when it starts one, -1 if none
+  int GetRunningInput(const schema::MetaGraphT &graph, const schema::CNodeT &node);
+
+  STATUS FuseChain(schema::MetaGraphT *graph, const std::vector<size_t> &chain, uint32_t running_input,
+                   const std::vector<Step> &steps);
+
+  std::set<uint32_t> fused_tensors_;
+};
+}  // namespace lite
+}  // namespace mindspore
+#endif  // MINDSPORE_LITE_TOOLS_CONVERTER_LEGACY_OPTIMIZER_GRAPH_ELEMENTWISE_FUSION_PASS_H
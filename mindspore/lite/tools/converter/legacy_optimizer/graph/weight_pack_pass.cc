@@ -0,0 +1,153 @@
+/**
+ * Copyright 2021 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tools/converter/legacy_optimizer/graph/weight_pack_pass.h"
+#include <cstring>
+#include <string>
+#include <vector>
+#include "nnacl/op_base.h"
+#include "nnacl/fp32/matmul_fp32.h"
+#include "src/runtime/kernel/arm/base/packed_weight_cache.h"
+
+namespace mindspore::lite {
+namespace {
+constexpr size_t kWeightIndex = 1;
+
+schema::TensorT *GetPackableWeight(schema::MetaGraphT *graph, const std::unique_ptr<schema::CNodeT> &node) {
+  if (node->quantType != schema::QuantType_QUANT_NONE || node->inputIndex.size() <= kWeightIndex) {
+    return nullptr;
+  }
+  auto weight = graph->allTensors.at(node->inputIndex.at(kWeightIndex)).get();
+  if (weight->nodeType != schema::NodeType_ValueNode || weight->dataType != kNumberTypeFloat32 ||
+      weight->data.empty() || !weight->quantParams.empty()) {
+    return nullptr;
+  }
+  int element_num = 1;
+  for (auto dim : weight->dims) {
+    element_num *= dim;
+  }
+  if (weight->data.size() != element_num * sizeof(float)) {
+    return nullptr;
+  }
+  return weight;
+}
+}  // namespace
+
+STATUS WeightPackPass::PackWeight(schema::TensorT *weight, bool col_major, int batch, int row, int col) {
+  auto layout = kernel::PackedWeightLayout(col_major, col_tile_, batch, row, col);
+  if (!weight->packedLayout.empty()) {
+    // shared by another node, the kernels whose layout differs pack at runtime
+    return RET_OK;
+  }
+  // the tiled dimension is rounded up and zero padded
+  int tiled_row = col_major ? UP_ROUND(row, col_tile_) : row;
+  int tiled_col = col_major ? col : UP_ROUND(col, col_tile_);
+  std::vector<float> packed(static_cast<size_t>(batch) * tiled_row * tiled_col, 0.0f);
+  auto src = reinterpret_cast<const float *>(weight->data.data());
+  for (int i = 0; i < batch; i++) {
+    auto batch_src = src + i * row * col;
+    auto batch_dst = packed.data() + i * tiled_row * tiled_col;
+    if (col_major) {
+      col_tile_ == C16NUM ? RowMajor2Col16Major(batch_src, batch_dst, row, col)
+                          : RowMajor2Col8Major(batch_src, batch_dst, row, col);
+    } else {
+      col_tile_ == C16NUM ? RowMajor2Row16Major(batch_src, batch_dst, row, col)
+                          : RowMajor2Row8Major(batch_src, batch_dst, row, col);
+    }
+  }
+  weight->packedData.resize(packed.size() * sizeof(float));
+  memcpy(weight->packedData.data(), packed.data(), weight->packedData.size());
+  weight->packedLayout = layout;
+  return RET_OK;
+}
+
+STATUS WeightPackPass::PackConv2D(schema::MetaGraphT *graph, const std::unique_ptr<schema::CNodeT> &node) {
+  auto conv = node->primitive->value.AsConv2D();
+  auto weight = GetPackableWeight(graph, node);
+  if (conv == nullptr || weight == nullptr || conv->group != 1 || weight->format != schema::Format_KHWC ||
+      weight->dims.size() != 4) {
+    return RET_NO_CHANGE;
+  }
+  // square kernels of stride and dilation 1 run as winograd, whose layout depends on the input shape
+  if (conv->kernelH == conv->kernelW && conv->kernelH != 1 && conv->strideH == 1 && conv->strideW == 1 &&
+      conv->dilateH == 1 && conv->dilateW == 1) {
+    return RET_NO_CHANGE;
+  }
+  auto out_channel = weight->dims.at(0);
+  auto deep = weight->dims.at(1) * weight->dims.at(2) * weight->dims.at(3);
+  return PackWeight(weight, true, 1, out_channel, deep);
+}
+
+STATUS WeightPackPass::PackFullConnection(schema::MetaGraphT *graph, const std::unique_ptr<schema::CNodeT> &node) {
+  auto weight = GetPackableWeight(graph, node);
+  if (weight == nullptr || weight->dims.size() != 2) {
+    return RET_NO_CHANGE;
+  }
+  // the layout of inputs of more than one row, a single row input on arm multiplies the original weight
+  return PackWeight(weight, true, 1, weight->dims.at(0), weight->dims.at(1));
+}
+
+STATUS WeightPackPass::PackMatMul(schema::MetaGraphT *graph, const std::unique_ptr<schema::CNodeT> &node) {
+  auto matmul = node->primitive->value.AsMatMul();
+  auto weight = GetPackableWeight(graph, node);
+  if (matmul == nullptr || weight == nullptr || weight->dims.size() < 2) {
+    return RET_NO_CHANGE;
+  }
+  int batch = 1;
+  for (size_t i = 0; i < weight->dims.size() - 2; i++) {
+    batch *= weight->dims.at(i);
+  }
+  auto row = weight->dims.at(weight->dims.size() - 2);
+  auto col = weight->dims.at(weight->dims.size() - 1);
+  // transposed B of col x deep is packed into column major tiles, B of deep x col into row major tiles
+  return PackWeight(weight, matmul->transposeB, batch, row, col);
+}
+
+STATUS WeightPackPass::Run(schema::MetaGraphT *graph) {
+  MS_ASSERT(graph != nullptr);
+  if (col_tile_ != C8NUM && col_tile_ != C16NUM) {
+    MS_LOG(ERROR) << "Unsupported col tile of packed weight: " << col_tile_;
+    return RET_ERROR;
+  }
+  bool changed = false;
+  for (auto &node : graph->nodes) {
+    if (node == nullptr || node->primitive == nullptr) {
+      MS_LOG(ERROR) << " node or node->primitive is nullptr";
+      return RET_ERROR;
+    }
+    STATUS status = RET_NO_CHANGE;
+    switch (node->primitive->value.type) {
+      case schema::PrimitiveType_Conv2D:
+        status = PackConv2D(graph, node);
+        break;
+      case schema::PrimitiveType_FullConnection:
+        status = PackFullConnection(graph, node);
+        break;
+      case schema::PrimitiveType_MatMul:
+        status = PackMatMul(graph, node);
+        break;
+      default:
+        break;
+    }
+    if (status != RET_OK && status != RET_NO_CHANGE) {
+      MS_LOG(ERROR) << "Pack weight of node failed, name: " << node->name;
+      return status;
+    }
+    changed = changed || status == RET_OK;
+  }
+  return changed ? RET_OK : RET_NO_CHANGE;
+}
+}  // namespace mindspore::lite
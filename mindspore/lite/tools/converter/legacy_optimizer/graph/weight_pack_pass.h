@@ -0,0 +1,52 @@
+/**
+ * Copyright 2021 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MINDSPORE_LITE_TOOLS_CONVERTER_LEGACY_OPTIMIZER_GRAPH_WEIGHT_PACK_PASS_H
+#define MINDSPORE_LITE_TOOLS_CONVERTER_LEGACY_OPTIMIZER_GRAPH_WEIGHT_PACK_PASS_H
+
+#include <memory>
+#include "tools/converter/optimizer.h"
+#include "tools/common/graph_util.h"
+
+namespace mindspore {
+namespace lite {
+// Store the fp32 weights of Conv2D, FullConnection and MatMul packed into the tile layout the runtime kernels of the
+// target pack them to at Init, next to the original data. Kernels initialized with the layout copy the packed data
+// instead of repacking, the others still pack the original data.
+class WeightPackPass : public GraphPass {
+ public:
+  explicit WeightPackPass(int col_tile) : col_tile_(col_tile) {}
+
+  ~WeightPackPass() override = default;
+
+  STATUS Run(schema::MetaGraphT *graph) override;
+
+ private:
+  STATUS PackConv2D(schema::MetaGraphT *graph, const std::unique_ptr<schema::CNodeT> &node);
+
+  STATUS PackFullConnection(schema::MetaGraphT *graph, const std::unique_ptr<schema::CNodeT> &node);
+
+  STATUS PackMatMul(schema::MetaGraphT *graph, const std::unique_ptr<schema::CNodeT> &node);
+
+  // Pack batch row x col matrices of weight into column major tiles of col_tile_ rows (col_major), or row major
+  // tiles of col_tile_ columns.
+  STATUS PackWeight(schema::TensorT *weight, bool col_major, int batch, int row, int col);
+
+  int col_tile_;
+};
+}  // namespace lite
+}  // namespace mindspore
+#endif  // MINDSPORE_LITE_TOOLS_CONVERTER_LEGACY_OPTIMIZER_GRAPH_WEIGHT_PACK_PASS_H
@@ -17,6 +17,7 @@
 #include "tools/converter/quantizer/post_training_quantizer.h"
 #include <dirent.h>
 #include <sys/stat.h>
+#include <atomic>
 #include <future>
 #include <map>
 #include <memory>
@@ -44,6 +45,39 @@ using std::string;
 using std::vector;
 
 namespace mindspore::lite::quant {
+namespace {
+// bin + count, bit for bit what adding 1.0f count times gives: the sum becomes an integer after a few additions,
+// then stays exact up to 2^24, where float no longer holds the next integer and the sum stops growing
+float AddCountToBin(float bin, uint64_t count) {
+  constexpr float kFloatIntegerLimit = 16777216.0f;
+  while (count > 0 && (bin != std::floor(bin) || bin > kFloatIntegerLimit)) {
+    bin += 1.0f;
+    count--;
+  }
+  if (count == 0) {
+    return bin;
+  }
+  return static_cast<float>(std::min(static_cast<double>(bin) + count, static_cast<double>(kFloatIntegerLimit)));
+}
+
+// the threshold search of every info is independent, spread the infos over the cores
+void ComputeThresholds(const std::vector<DivergInfo *> &infos) {
+  size_t thread_num = std::min(infos.size(), static_cast<size_t>(std::max(1u, std::thread::hardware_concurrency())));
+  std::atomic<size_t> next_info{0};
+  std::vector<std::future<void>> workers;
+  for (size_t i = 0; i < thread_num; i++) {
+    workers.push_back(std::async(std::launch::async, [&infos, &next_info]() {
+      for (size_t index = next_info++; index < infos.size(); index = next_info++) {
+        infos[index]->ComputeThreshold();
+      }
+    }));
+  }
+  for (auto &worker : workers) {
+    worker.get();
+  }
+}
+}  // namespace
+
 STATUS DivergInfo::RecordMaxValue(const std::vector<float> &datas) {
   for (float data : datas) {
     max = std::max(data, max);
@@ -82,12 +116,39 @@ STATUS DivergInfo::UpdateHistogram(const std::vector<float> &data) {
       MS_LOG(ERROR) << "divisor 'interval' cannot be 0.";
       return RET_ERROR;
     }
+    if (this->bin_counts.size() != this->histogram.size()) {
+      this->bin_counts.resize(this->histogram.size(), 0);
+    }
     int bin_index = std::min(static_cast<int>(std::fabs(value) / this->interval), bin_num - 1);
-    this->histogram[bin_index]++;
+    this->bin_counts[bin_index]++;
   }
   return RET_OK;
 }
 
+void DivergInfo::ApplyBinCounts() {
+  for (size_t i = 0; i < this->bin_counts.size() && i < this->histogram.size(); i++) {
+    this->histogram[i] = AddCountToBin(this->histogram[i], this->bin_counts[i]);
+  }
+  this->bin_counts.clear();
+}
+
+void DivergInfo::MergeMaxValue(const DivergInfo &other) {
+  // other saw later batches, on ties std::max and std::min keep its value like RecordMaxValue keeps the later one
+  this->max = std::max(other.max, this->max);
+  this->min = std::min(other.min, this->min);
+  this->max_datas.insert(this->max_datas.end(), other.max_datas.begin(), other.max_datas.end());
+  this->min_datas.insert(this->min_datas.end(), other.min_datas.begin(), other.min_datas.end());
+}
+
+void DivergInfo::MergeBinCounts(const DivergInfo &other) {
+  if (this->bin_counts.size() < other.bin_counts.size()) {
+    this->bin_counts.resize(other.bin_counts.size(), 0);
+  }
+  for (size_t i = 0; i < other.bin_counts.size(); i++) {
+    this->bin_counts[i] += other.bin_counts[i];
+  }
+}
+
 void DivergInfo::DumpHistogram() {
   MS_LOG(INFO) << "Print node " << cnode->fullname_with_scope() << " histogram";
   for (float item : this->histogram) {
@@ -307,12 +368,15 @@ STATUS Calibrator::RecordMaxValue(const vector<float> &data, const std::unique_p
 }
 
 STATUS Calibrator::ComputeThreshold() {
+  std::vector<DivergInfo *> infos;
   for (auto &kv : this->outputs_diverg_info_) {
     auto &outputs_diverg_info = kv.second;
     for (auto &diverg_info : outputs_diverg_info) {
-      diverg_info->ComputeThreshold();
+      infos.push_back(diverg_info.get());
     }
   }
+  ComputeThresholds(infos);
+  infos.clear();
   // node A's input may be node B's output, no need to re-compute the node A's input quant param which is the same as
   for (auto &kv : this->inputs_diverg_info_) {
     auto &input_infos = kv.second;
@@ -340,10 +404,11 @@ STATUS Calibrator::ComputeThreshold() {
         }
       }
       if (!already_computed) {
-        input_infos[i]->ComputeThreshold();
+        infos.push_back(input_infos[i].get());
       }
     }
   }
+  ComputeThresholds(infos);
   return RET_OK;
 }
 
@@ -364,6 +429,42 @@ STATUS Calibrator::UpdateDataFrequency(const vector<float> &data, const std::uni
   return RET_OK;
 }
 
+void Calibrator::ApplyBinCounts(DivergInfoMap *diverg_info) {
+  MS_ASSERT(diverg_info != nullptr);
+  for (auto &kv : *diverg_info) {
+    for (auto &info : kv.second) {
+      info->ApplyBinCounts();
+    }
+  }
+}
+
+void Calibrator::CopyDivergInfo(const DivergInfoMap &src, DivergInfoMap *dst) {
+  MS_ASSERT(dst != nullptr);
+  dst->clear();
+  for (auto &kv : src) {
+    auto &infos = (*dst)[kv.first];
+    for (auto &info : kv.second) {
+      infos.push_back(std::make_unique<DivergInfo>(*info));
+    }
+  }
+}
+
+void Calibrator::MergeDivergInfo(const DivergInfoMap &src, DivergInfoMap *dst,
+                                 const std::function<void(DivergInfo *dst, const DivergInfo &src)> &merge) {
+  MS_ASSERT(dst != nullptr);
+  for (auto &kv : src) {
+    auto &dst_infos = (*dst)[kv.first];
+    for (size_t i = 0; i < kv.second.size(); i++) {
+      if (i < dst_infos.size()) {
+        merge(dst_infos[i].get(), *kv.second[i]);
+      } else {
+        // added by the inference callbacks for the extra inputs of concat and add or the extra outputs of a node
+        dst_infos.push_back(std::make_unique<DivergInfo>(*kv.second[i]));
+      }
+    }
+  }
+}
+
 STATUS Calibrator::AddQuantizedOp(const CNodePtr &node) {
   if (node == nullptr) {
     MS_LOG(ERROR) << "To be quantized node is null";
@@ -528,6 +629,8 @@ STATUS Calibrator::ReadConfig() {
       config_param_.batch_count = std::stoul(value);
     } else if (key == "thread_num") {
       config_param_.thread_num = std::stoul(value);
+    } else if (key == "session_num") {
+      config_param_.session_num = std::max(std::stoul(value), 1ul);
     } else if (key == "method_x") {
       if (value != kMethodKL && value != kMethodMaxMin && value != kMethodOutlier) {
         MS_LOG(WARNING) << "unsupported method_x: " << value << ". Use default value.";
@@ -550,6 +653,7 @@ STATUS Calibrator::ReadConfig() {
   MS_LOG(DEBUG) << "batch_count: " << config_param_.batch_count << "  "
                 << "method_x: " << config_param_.method_x << "  "
                 << "thread_num: " << config_param_.thread_num << " "
+                << "session_num: " << config_param_.session_num << " "
                 << "bias_correction: " << config_param_.bias_correction;
 
   delete[] resolved_path;
@@ -1034,20 +1138,94 @@ STATUS PostTrainingQuantizer::CheckFp32TensorVec(const std::string &node_name,
   return RET_OK;
 }
 
+STATUS PostTrainingQuantizer::CreateParallelSessions(Model *model, const Context &ctx) {
+  parallel_sessions_.clear();
+  for (size_t i = 1; i < calibrator_->GetSessionNum(); i++) {
+    auto session = std::shared_ptr<mindspore::lite::LiteSession>(
+      dynamic_cast<mindspore::lite::LiteSession *>(session::LiteSession::CreateSession(&ctx)));
+    if (session == nullptr) {
+      MS_LOG(ERROR) << "create session failed!";
+      return RET_ERROR;
+    }
+    auto ret = session->CompileGraph(model);
+    if (ret != lite::RET_OK) {
+      MS_LOG(ERROR) << "compile graph error";
+      return RET_ERROR;
+    }
+    parallel_sessions_.push_back(session);
+  }
+  return RET_OK;
+}
+
+/**
+ * 1. split the batches into one contiguous range per session
+ * 2. run shard of every session in parallel on its own copy of the divergence infos
+ * 3. merge the copies into the calibrator in batch order, the same as running all batches on one session
+ **/
+STATUS PostTrainingQuantizer::RunCalibrationShards(
+  const CalibrationShard &shard, const std::function<void(DivergInfo *dst, const DivergInfo &src)> &merge) {
+  std::vector<mindspore::lite::LiteSession *> sessions{fp32_session_};
+  for (auto &session : parallel_sessions_) {
+    sessions.push_back(session.get());
+  }
+  size_t batch_num = calibrator_->GetBatchNum();
+  size_t shard_num = std::min(sessions.size(), batch_num);
+  if (shard_num == 0) {
+    return RET_OK;
+  }
+  std::vector<DivergInfoMap> inputs_diverg_info(shard_num);
+  std::vector<DivergInfoMap> outputs_diverg_info(shard_num);
+  std::vector<std::future<STATUS>> results;
+  size_t begin = 0;
+  for (size_t i = 0; i < shard_num; i++) {
+    size_t end = begin + batch_num / shard_num + (i < batch_num % shard_num ? 1 : 0);
+    Calibrator::CopyDivergInfo(*calibrator_->GetInputDivergInfo(), &inputs_diverg_info[i]);
+    Calibrator::CopyDivergInfo(*calibrator_->GetOutputDivergInfo(), &outputs_diverg_info[i]);
+    results.push_back(std::async(std::launch::async, shard, sessions[i], begin, end, &inputs_diverg_info[i],
+                                 &outputs_diverg_info[i]));
+    begin = end;
+  }
+  STATUS status = RET_OK;
+  for (auto &result : results) {
+    auto ret = result.get();
+    if (ret != RET_OK) {
+      status = ret;
+    }
+  }
+  if (status != RET_OK) {
+    return status;
+  }
+  for (size_t i = 0; i < shard_num; i++) {
+    Calibrator::MergeDivergInfo(inputs_diverg_info[i], calibrator_->GetInputDivergInfo(), merge);
+    Calibrator::MergeDivergInfo(outputs_diverg_info[i], calibrator_->GetOutputDivergInfo(), merge);
+  }
+  return RET_OK;
+}
+
+STATUS PostTrainingQuantizer::DoInference() {
+  return RunCalibrationShards(
+    [this](mindspore::lite::LiteSession *session, size_t begin, size_t end, DivergInfoMap *inputs_diverg_info,
+           DivergInfoMap *outputs_diverg_info) {
+      return DoInference(session, begin, end, inputs_diverg_info, outputs_diverg_info);
+    },
+    [](DivergInfo *dst, const DivergInfo &src) { dst->MergeMaxValue(src); });
+}
+
 /**
  * 1. create input tensor
  * 2. insert callback to session
  * 3. run session
  **/
-STATUS PostTrainingQuantizer::DoInference() {
+STATUS PostTrainingQuantizer::DoInference(mindspore::lite::LiteSession *session, size_t begin, size_t end,
+                                          DivergInfoMap *inputs_diverg_info, DivergInfoMap *outputs_diverg_info) {
   // get input tensor
-  vector<mindspore::tensor::MSTensor *> inputs = fp32_session_->GetInputs();
+  vector<mindspore::tensor::MSTensor *> inputs = session->GetInputs();
   if (inputs.size() != calibrator_->GetInputNum()) {
     MS_LOG(ERROR) << "model's input tensor cnt: " << inputs.size() << " != " << calibrator_->GetInputNum();
     return RET_ERROR;
   }
 
-  for (size_t i = 0; i < calibrator_->GetBatchNum(); i++) {
+  for (size_t i = begin; i < end; i++) {
     // set multi-input data
     for (size_t input_index = 0; input_index < inputs.size(); input_index++) {
       STATUS status = calibrator_->GenerateInputData(input_index, i, inputs[input_index]);
@@ -1060,7 +1238,7 @@ STATUS PostTrainingQuantizer::DoInference() {
     KernelCallBack beforeCallBack = [&](const std::vector<mindspore::tensor::MSTensor *> &beforeInputs,
                                         const std::vector<mindspore::tensor::MSTensor *> &beforeOutputs,
                                         const CallBackParam &callParam) -> bool {
-      auto diverg_info_map = calibrator_->GetInputDivergInfo();
+      auto diverg_info_map = inputs_diverg_info;
       if (diverg_info_map->find(callParam.node_name) == diverg_info_map->end()) {
         return true;
       }
@@ -1090,7 +1268,7 @@ STATUS PostTrainingQuantizer::DoInference() {
     KernelCallBack afterCallBack = [&](const std::vector<mindspore::tensor::MSTensor *> &afterInputs,
                                        const std::vector<mindspore::tensor::MSTensor *> &afterOutputs,
                                        const CallBackParam &callParam) -> bool {
-      auto diverg_info_map = calibrator_->GetOutputDivergInfo();
+      auto diverg_info_map = outputs_diverg_info;
       if (diverg_info_map->find(callParam.node_name) == diverg_info_map->end()) {
         return true;
       }
@@ -1114,7 +1292,7 @@ STATUS PostTrainingQuantizer::DoInference() {
       }
       return true;
     };
-    auto status = fp32_session_->RunGraph(beforeCallBack, afterCallBack);
+    auto status = session->RunGraph(beforeCallBack, afterCallBack);
     if (status != RET_OK) {
       MS_LOG(ERROR) << "run model failed!";
       return RET_ERROR;
@@ -1501,14 +1679,31 @@ STATUS PostTrainingQuantizer::BiasCorrection(const FuncGraphPtr &func_graph) {
 }
 
 STATUS PostTrainingQuantizer::CollectDataFrequency() {
+  auto status = RunCalibrationShards(
+    [this](mindspore::lite::LiteSession *session, size_t begin, size_t end, DivergInfoMap *inputs_diverg_info,
+           DivergInfoMap *outputs_diverg_info) {
+      return CollectDataFrequency(session, begin, end, inputs_diverg_info, outputs_diverg_info);
+    },
+    [](DivergInfo *dst, const DivergInfo &src) { dst->MergeBinCounts(src); });
+  if (status != RET_OK) {
+    return status;
+  }
+  calibrator_->ApplyBinCounts(calibrator_->GetInputDivergInfo());
+  calibrator_->ApplyBinCounts(calibrator_->GetOutputDivergInfo());
+  return RET_OK;
+}
+
+STATUS PostTrainingQuantizer::CollectDataFrequency(mindspore::lite::LiteSession *session, size_t begin, size_t end,
+                                                   DivergInfoMap *inputs_diverg_info,
+                                                   DivergInfoMap *outputs_diverg_info) {
   // get input tensor
-  vector<mindspore::tensor::MSTensor *> inputs = fp32_session_->GetInputs();
+  vector<mindspore::tensor::MSTensor *> inputs = session->GetInputs();
   if (inputs.size() != calibrator_->GetInputNum()) {
     MS_LOG(ERROR) << "model's input tensor cnt: " << inputs.size() << " != " << calibrator_->GetInputNum();
     return RET_ERROR;
   }
 
-  for (size_t i = 0; i < calibrator_->GetBatchNum(); i++) {
+  for (size_t i = begin; i < end; i++) {
     // set multi-input data
     for (size_t input_index = 0; input_index < inputs.size(); input_index++) {
       STATUS status = calibrator_->GenerateInputData(input_index, i, inputs[input_index]);
@@ -1521,7 +1716,7 @@ STATUS PostTrainingQuantizer::CollectDataFrequency() {
     KernelCallBack beforeCallBack = [&](const std::vector<mindspore::tensor::MSTensor *> &beforeInputs,
                                         const std::vector<mindspore::tensor::MSTensor *> &beforeOutputs,
                                         const CallBackParam &callParam) {
-      auto diverg_info_map = calibrator_->GetInputDivergInfo();
+      auto diverg_info_map = inputs_diverg_info;
       if (diverg_info_map->find(callParam.node_name) == diverg_info_map->end()) {
         return true;
       }
@@ -1543,7 +1738,7 @@ STATUS PostTrainingQuantizer::CollectDataFrequency() {
     KernelCallBack afterCallBack = [&](const std::vector<mindspore::tensor::MSTensor *> &after_inputs,
                                        const std::vector<mindspore::tensor::MSTensor *> &after_outputs,
                                        const CallBackParam &call_param) {
-      auto diverg_info_map = calibrator_->GetOutputDivergInfo();
+      auto diverg_info_map = outputs_diverg_info;
       if (diverg_info_map->find(call_param.node_name) == diverg_info_map->end()) {
         return true;
       }
@@ -1561,7 +1756,7 @@ STATUS PostTrainingQuantizer::CollectDataFrequency() {
       }
       return true;
     };
-    auto status = fp32_session_->RunGraph(beforeCallBack, afterCallBack);
+    auto status = session->RunGraph(beforeCallBack, afterCallBack);
     if (status != RET_OK) {
       MS_LOG(ERROR) << "run model failed!";
       return RET_ERROR;
@@ -1622,6 +1817,10 @@ STATUS PostTrainingQuantizer::DoQuantize(FuncGraphPtr func_graph) {
     MS_LOG(ERROR) << "compile graph error";
     return RET_ERROR;
   }
+  status = CreateParallelSessions(model, ctx);
+  if (status != RET_OK) {
+    return status;
+  }
 
   MS_LOG(INFO) << "start to update divergence's max value";
   status = DoInference();
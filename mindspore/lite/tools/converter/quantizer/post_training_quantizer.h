@@ -23,6 +23,7 @@
 #include <vector>
 #include <cfloat>
 #include <map>
+#include <functional>
 #include <utility>
 #include "src/lite_session.h"
 #include "tools/converter/quantizer/quantizer.h"
@@ -31,6 +32,10 @@
 
 namespace mindspore::lite::quant {
 class Calibrator;
+struct DivergInfo;
+
+// node name -- divergence info of each of its inputs or outputs
+using DivergInfoMap = std::unordered_map<std::string, std::vector<std::unique_ptr<DivergInfo>>>;
 
 struct MaxMin {
  public:
@@ -48,6 +53,8 @@ struct ConfigParam {
   uint32_t batch_count{100};
   std::string method_x{kMethodKL};
   uint32_t thread_num{1};
+  // fp32 sessions running the calibration batches in parallel, each with thread_num threads
+  uint32_t session_num{1};
   bool bias_correction{false};
 };
 
@@ -72,6 +79,8 @@ class PostTrainingQuantizer : public Quantizer {
 
   mindspore::lite::LiteSession *fp32_session_;
   mindspore::lite::LiteSession *int8_session_;
+  // session_num - 1 more fp32 sessions of the same model calibrating in parallel with fp32_session_
+  std::vector<std::shared_ptr<mindspore::lite::LiteSession>> parallel_sessions_;
 
   std::map<std::string, std::vector<float>> fp32_op_input_map;           // concurency
   std::map<std::string, std::vector<float>> fp32_op_output_ch_mean_map;  // concurency
@@ -97,12 +106,27 @@ class PostTrainingQuantizer : public Quantizer {
   STATUS CheckFp32TensorVec(const std::string &node_name,
                             const std::vector<mindspore::tensor::MSTensor *> &tensor_vec) const;
 
+  // run shard on every session over a contiguous range of the calibration batches in parallel, each on its own copy
+  // of the divergence infos, then fold the copies into the calibrator in batch order with merge
+  using CalibrationShard = std::function<STATUS(mindspore::lite::LiteSession *session, size_t begin, size_t end,
+                                                DivergInfoMap *inputs_diverg_info, DivergInfoMap *outputs_diverg_info)>;
+  STATUS RunCalibrationShards(const CalibrationShard &shard,
+                              const std::function<void(DivergInfo *dst, const DivergInfo &src)> &merge);
+
+  STATUS CreateParallelSessions(Model *model, const Context &ctx);
+
   STATUS DoInference();
 
+  STATUS DoInference(mindspore::lite::LiteSession *session, size_t begin, size_t end, DivergInfoMap *inputs_diverg_info,
+                     DivergInfoMap *outputs_diverg_info);
+
   STATUS UpdateDivergInverval();
 
   STATUS CollectDataFrequency();
 
+  STATUS CollectDataFrequency(mindspore::lite::LiteSession *session, size_t begin, size_t end,
+                              DivergInfoMap *inputs_diverg_info, DivergInfoMap *outputs_diverg_info);
+
   STATUS ComputeThreshold();
 
   STATUS QuantNode();
@@ -121,6 +145,8 @@ class PostTrainingQuantizer : public Quantizer {
 
 struct DivergInfo {
   std::vector<float> histogram;
+  // values per bin counted by UpdateHistogram and not yet added to histogram
+  std::vector<uint64_t> bin_counts;
   CNodePtr cnode;
   int bin_num;
   float interval = 0;
@@ -157,6 +183,14 @@ struct DivergInfo {
 
   STATUS UpdateHistogram(const std::vector<float> &data);
 
+  // add bin_counts to histogram, bit for bit the same as adding every value to it one by one
+  void ApplyBinCounts();
+
+  // fold the statistics other collected over later batches into this one
+  void MergeMaxValue(const DivergInfo &other);
+
+  void MergeBinCounts(const DivergInfo &other);
+
   void DumpHistogram();
 
   STATUS ComputeThreshold();
@@ -182,6 +216,8 @@ class Calibrator {
 
   uint32_t GetThreadNum() const { return config_param_.thread_num; }
 
+  uint32_t GetSessionNum() const { return config_param_.session_num; }
+
   std::string GetMethodX() const { return config_param_.method_x; }
 
   bool GetBiasCorrection() const { return config_param_.bias_correction; }
@@ -196,6 +232,14 @@ class Calibrator {
     std::unordered_map<std::string, std::vector<std::unique_ptr<DivergInfo>>> *diverg_info);
 
   static STATUS UpdateDataFrequency(const std::vector<float> &data, const std::unique_ptr<DivergInfo> &diverg_info);
+
+  static void ApplyBinCounts(DivergInfoMap *diverg_info);
+
+  static void CopyDivergInfo(const DivergInfoMap &src, DivergInfoMap *dst);
+
+  // merge the infos of src into dst, appending copies of the infos dst does not have yet
+  static void MergeDivergInfo(const DivergInfoMap &src, DivergInfoMap *dst,
+                              const std::function<void(DivergInfo *dst, const DivergInfo &src)> &merge);
   void Dump();
 
   STATUS ComputeThreshold();
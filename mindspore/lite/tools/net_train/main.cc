@@ -14,14 +14,13 @@
  * limitations under the License.
  */
 
-#include <malloc.h>
 #include "tools/net_train/net_train.h"
 #include "include/version.h"
+#include "tools/common/run_stats.h"
 
 int main(int argc, const char **argv) {
   MS_LOG(INFO) << mindspore::lite::Version();
   int res = mindspore::lite::RunNetTrain(argc, argv);
-  struct mallinfo info = mallinfo();
-  std::cout << "total allocation: " << info.arena << "\n";
+  std::cout << "heap in use: " << mindspore::lite::GetHeapInUse() << "\n";
   return res;
 }
@@ -25,6 +25,7 @@
 #include "include/context.h"
 #include "src/runtime/runtime_api.h"
 #include "include/version.h"
+#include "tools/common/run_stats.h"
 
 namespace mindspore {
 namespace lite {
@@ -231,6 +232,7 @@ int NetTrain::MarkPerformance() {
   uint64_t time_min = 1000000;
   uint64_t time_max = 0;
   uint64_t time_avg = 0;
+  size_t heap_high_water = 0;
 
   for (int i = 0; i < flags_->epochs_; i++) {
     session_->BindThread(true);
@@ -248,6 +250,8 @@ int NetTrain::MarkPerformance() {
     time_min = std::min(time_min, time);
     time_max = std::max(time_max, time);
     time_avg += time;
+    // the allocator of the session keeps the buffers it frees, so after a run this is the high-water of its pool
+    heap_high_water = std::max(heap_high_water, GetHeapInUse());
     session_->BindThread(false);
   }
 
@@ -266,6 +270,11 @@ int NetTrain::MarkPerformance() {
     printf("Model = %s, NumThreads = %d, MinRunTime = %f ms, MaxRuntime = %f ms, AvgRunTime = %f ms\n",
            flags_->model_file_.substr(flags_->model_file_.find_last_of(DELIM_SLASH) + 1).c_str(), flags_->num_threads_,
            time_min / 1000.0f, time_max / 1000.0f, time_avg / 1000.0f);
+    auto peak_rss_kb = GetPeakRssKb();
+    MS_LOG(INFO) << "MemorySaving = " << flags_->memory_saving_ << ", PeakRSS = " << peak_rss_kb
+                 << " KB, HeapHighWater = " << heap_high_water / 1024 << " KB";
+    printf("MemorySaving = %d, PeakRSS = %zu KB, HeapHighWater = %zu KB\n", flags_->memory_saving_, peak_rss_kb,
+           heap_high_water / 1024);
   }
   return RET_OK;
 }
@@ -413,6 +422,14 @@ int NetTrain::RunNetTrain() {
   }
 
   session_->Train();
+  if (flags_->memory_saving_) {
+    auto ret = session_->SetMemorySaving(true, flags_->checkpoint_interval_);
+    if (ret != RET_OK) {
+      MS_LOG(ERROR) << "SetMemorySaving failed while running " << model_name.c_str();
+      std::cout << "SetMemorySaving failed while running " << model_name.c_str() << std::endl;
+      return RET_ERROR;
+    }
+  }
 
   ms_inputs_ = session_->GetInputs();
   auto end_prepare_time = GetTimeUs();
@@ -59,6 +59,10 @@ class MS_API NetTrainFlags : public virtual FlagParser {
     AddFlag(&NetTrainFlags::warm_up_loop_count_, "warmUpLoopCount", "Run warm up loop", 0);
     AddFlag(&NetTrainFlags::time_profiling_, "timeProfiling", "Run time profiling", false);
     AddFlag(&NetTrainFlags::epochs_, "epochs", "Number of training epochs to run", 1);
+    AddFlag(&NetTrainFlags::memory_saving_, "memorySaving",
+            "Free activations after their last use and recompute them in the backward pass", false);
+    AddFlag(&NetTrainFlags::checkpoint_interval_, "checkpointInterval",
+            "Forward kernels per recomputed segment of memorySaving, 0 for the square root of their number", 0);
     // MarkAccuracy
     AddFlag(&NetTrainFlags::data_file_, "expectedDataFile", "Expected results data file path", "");
     AddFlag(&NetTrainFlags::export_file_, "exportFile", "MS File to export trained model into", "");
@@ -84,6 +88,8 @@ class MS_API NetTrainFlags : public virtual FlagParser {
   int warm_up_loop_count_ = 0;
   bool time_profiling_;
   int epochs_ = 1;
+  bool memory_saving_ = false;
+  int checkpoint_interval_ = 0;
   // MarkAccuracy
   std::string data_file_;
   std::string data_type_ = "FLOAT";
@@ -32,11 +32,27 @@ def ps_context():
     return _ps_context
 
 _set_ps_context_func_map = {
-    "enable_ps": ps_context().set_ps_enable
+    "enable_ps": ps_context().set_ps_enable,
+    "consistency_mode": ps_context().set_consistency_mode,
+    "staleness_threshold": ps_context().set_staleness_threshold,
+    "compression": ps_context().set_compression,
+    "topk_ratio": ps_context().set_topk_ratio,
+    "embedding_storage": ps_context().set_embedding_storage,
+    "embedding_admit_threshold": ps_context().set_embedding_admit_threshold,
+    "embedding_ttl": ps_context().set_embedding_ttl,
+    "embedding_max_rows": ps_context().set_embedding_max_rows
 }
 
 _get_ps_context_func_map = {
-    "enable_ps": ps_context().is_ps_enabled
+    "enable_ps": ps_context().is_ps_enabled,
+    "consistency_mode": ps_context().consistency_mode,
+    "staleness_threshold": ps_context().staleness_threshold,
+    "compression": ps_context().compression,
+    "topk_ratio": ps_context().topk_ratio,
+    "embedding_storage": ps_context().embedding_storage,
+    "embedding_admit_threshold": ps_context().embedding_admit_threshold,
+    "embedding_ttl": ps_context().embedding_ttl,
+    "embedding_max_rows": ps_context().embedding_max_rows
 }
 
 def _get_ps_mode_rank():
@@ -69,12 +85,35 @@ def _set_ps_context(**kwargs):
         enable_ps (bool): Whether to enable parameter server training mode.
                           Only after enable_ps is set True, the environment variables will be effective.
                           Default: False.
+        consistency_mode (str): How the parameter server applies the gradients of the workers, one of "sync",
+                          "ssp" and "async". "sync" applies the gradients of all workers together once every step,
+                          "ssp" and "async" apply the gradients of a worker as they arrive. Default: "sync".
+        staleness_threshold (int): Steps a worker may run ahead of the slowest worker in "ssp" mode before its
+                          pulls wait. Default: 0.
+        compression (str): Compression of the gradients pushed and the weights pulled, one of "none", "fp16",
+                          "bf16" and "topk". "fp16" and "bf16" cast both to 16 bits, "topk" pushes the largest
+                          gradients only and adds the rest to the next push. Default: "none".
+        topk_ratio (float): Ratio of the gradients pushed by "topk" compression, in (0, 1]. Default: 0.01.
+        embedding_storage (str): Storage of the embedding tables of the ps cache on the servers, "dense" or
+                          "dynamic". "dense" holds a row for every id of the vocabulary, "dynamic" creates the rows
+                          of the ids as they are admitted and evicts them by embedding_ttl and embedding_max_rows.
+                          Default: "dense".
+        embedding_admit_threshold (int): Occurrences of an id in the batches of a worker before the servers keep
+                          its row, the rows of the ids which are not admitted are not pushed and read their
+                          initial values again. Default: 1.
+        embedding_ttl (int): Rows of a dynamic embedding table not used in this many lookups of the table are
+                          evicted, 0 keeps them. Default: 0.
+        embedding_max_rows (int): Max rows of a dynamic embedding table on a server, the least frequently used
+                          rows are evicted beyond it, 0 does not limit the rows. Default: 0.
 
     Raises:
         ValueError: If input key is not the attribute in parameter server training mode context.
 
     Examples:
         >>> context.set_ps_context(enable_ps=True)
+        >>> context.set_ps_context(consistency_mode="ssp", staleness_threshold=2)
+        >>> context.set_ps_context(compression="topk", topk_ratio=0.01)
+        >>> context.set_ps_context(embedding_storage="dynamic", embedding_admit_threshold=2)
     """
     for key, value in kwargs.items():
         if key not in _set_ps_context_func_map:
@@ -106,6 +145,14 @@ def _reset_ps_context():
     Reset parameter server training mode context attributes to the default values:
 
     - enable_ps: False.
+    - consistency_mode: "sync".
+    - staleness_threshold: 0.
+    - compression: "none".
+    - topk_ratio: 0.01.
+    - embedding_storage: "dense".
+    - embedding_admit_threshold: 1.
+    - embedding_ttl: 0.
+    - embedding_max_rows: 0.
     """
     ps_context().reset()
 
@@ -135,3 +182,16 @@ def _clone_hash_table(dest_param_name, src_param_name):
 
 def _set_cache_enable(cache_enable):
     ps_context().set_cache_enable(cache_enable)
+
+def _get_embedding_metrics():
+    """
+    Get the metrics of the dynamic embedding tables of this server, empty in the other roles.
+
+    Returns:
+        dict, the metrics of each table by its key, a dict of row_num, memory_bytes, lookup_ids, lookup_hits,
+        admitted_ids, rejected_ids, ttl_evicted_rows, lfu_evicted_rows and lookup_seconds.
+    """
+    metric_names = ("row_num", "memory_bytes", "lookup_ids", "lookup_hits", "admitted_ids", "rejected_ids",
+                    "ttl_evicted_rows", "lfu_evicted_rows", "lookup_seconds")
+    return {key: {name: getattr(metrics, name) for name in metric_names}
+            for key, metrics in ps_context().embedding_metrics().items()}
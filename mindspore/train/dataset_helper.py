@@ -47,8 +47,8 @@ def connect_network_with_dataset(network, dataset_helper):
     data channel corresponding to the 'queue_name' and passed to the input network during forward computation.
 
     Note:
-        In the case of running the network on Ascend/GPU in graph mode, this function will wrap the input network with
-        'GetNext', in other cases, the input network will be returned with no change.
+        In the case of running the network on Ascend/GPU/CPU in graph mode, this function will wrap the input network
+        with 'GetNext', in other cases, the input network will be returned with no change.
         The 'GetNext' is required to get data only in sink mode, so this function is not applicable to no-sink mode.
 
     Args:
@@ -122,8 +122,8 @@ def connect_network_with_dataset(network, dataset_helper):
 
         return network
 
-    if not hasattr(dataset, '__me_inited__') and (context.get_context("device_target") == "Ascend" or \
-            context.get_context("device_target") == "GPU") and not context.get_context("enable_ge"):
+    if not hasattr(dataset, '__me_inited__') and context.get_context("device_target") in ("Ascend", "GPU", "CPU") \
+            and not context.get_context("enable_ge"):
         dataset.__me_inited__ = True
 
         dataset_types, dataset_shapes = dataset_helper.types_shapes()
@@ -179,8 +179,7 @@ class DatasetHelper:
                          (context.get_context("device_target") == "GPU"):
                         iterclass = _DatasetIterMSLoopSink
                     elif context.get_context("device_target") == "CPU":
-                        raise RuntimeError(
-                            "Currently dataset sink mode is not supported when the device target is CPU.")
+                        iterclass = _DatasetIterMSCPU
                 else:
                     iterclass = _DatasetIterPyNative
             self.iter = iterclass(dataset, sink_size, epoch_num)
@@ -335,6 +334,19 @@ class _DatasetIterMSLoopSink(_DatasetIter):
         self.op = op
 
 
+class _DatasetIterMSCPU(_DatasetIter):
+    """Iter for context (device_target=CPU), each step of the network fetches one batch with GetNext."""
+
+    def __init__(self, dataset, sink_size, epoch_num):
+        super().__init__(dataset, sink_size, epoch_num)
+        self.sink_count = sink_size
+
+        def op():
+            return tuple()
+
+        self.op = op
+
+
 class _DatasetIterMS(_DatasetIter):
     """Iter for MS(enable_loop_sink=False)."""
 
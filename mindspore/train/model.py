@@ -19,7 +19,6 @@ import os
 import math
 import numpy as np
 
-from mindspore import log as logger
 from ..common.tensor import Tensor
 from ..nn.metrics import get_metrics
 from .._checkparam import check_input_data, check_output_data, Validator
@@ -349,7 +348,7 @@ class Model:
             callbacks (list): List of callback objects which should be executed while training. Default: None.
             dataset_sink_mode (bool): Determine whether the data should be passed through the dataset channel.
                                       Default: True.
-                                      Configure pynative mode or CPU, the training process will be performed with
+                                      Configure pynative mode, the training process will be performed with
                                       dataset not sink.
             sink_size (int): Control the amount of data in each sink. Default: -1.
         """
@@ -383,10 +382,6 @@ class Model:
         with _CallbackManager(callbacks) as list_callback:
             if not dataset_sink_mode:
                 self._train_process(epoch, train_dataset, list_callback, cb_params)
-            elif context.get_context("device_target") == "CPU":
-                logger.warning("The CPU cannot support dataset sink mode currently."
-                               "So the training process will be performed with dataset not sink.")
-                self._train_process(epoch, train_dataset, list_callback, cb_params)
             else:
                 self._train_dataset_sink_process(epoch, train_dataset, list_callback, cb_params, sink_size)
 
@@ -534,7 +529,7 @@ class Model:
         """
         Training API where the iteration is controlled by python front-end.
 
-        When setting pynative mode or CPU, the training process will be performed with dataset not sink.
+        When setting pynative mode, the training process will be performed with dataset not sink.
 
         Note:
             If dataset_sink_mode is True, data will be sent to device. If device is Ascend, features
@@ -553,7 +548,7 @@ class Model:
                                      function respectively.
             callbacks (list): List of callback objects which should be executed while training. Default: None.
             dataset_sink_mode (bool): Determines whether to pass the data through dataset channel. Default: True.
-                                      Configure pynative mode or CPU, the training process will be performed with
+                                      Configure pynative mode, the training process will be performed with
                                       dataset not sink.
             sink_size (int): Control the amount of data in each sink.
                              If sink_size = -1, sink the complete dataset for each epoch.
@@ -667,7 +662,7 @@ class Model:
         """
         Evaluation API where the iteration is controlled by python front-end.
 
-        Configure to pynative mode or CPU, the evaluating process will be performed with dataset non-sink mode.
+        Configure to pynative mode, the evaluating process will be performed with dataset non-sink mode.
 
         Note:
             If dataset_sink_mode is True, data will be sent to device. If device is Ascend, features
@@ -704,11 +699,6 @@ class Model:
 
         self._clear_metrics()
 
-        if context.get_context("device_target") == "CPU" and dataset_sink_mode:
-            dataset_sink_mode = False
-            logger.warning("CPU cannot support dataset sink mode currently."
-                           "So the evaluating process will be performed with dataset non-sink mode.")
-
         with _CallbackManager(callbacks) as list_callback:
             if dataset_sink_mode:
                 return self._eval_dataset_sink_process(valid_dataset, list_callback, cb_params)
@@ -0,0 +1,58 @@
+# Copyright 2021 Huawei Technologies Co., Ltd
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+# http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ============================================================================
+
+"""Eager op dispatch benchmark, small ops in a loop where the dispatch overhead dominates."""
+
+import time
+import numpy as np
+
+from mindspore import Tensor
+from mindspore import context
+from mindspore.ops import operations as P
+
+context.set_context(mode=context.PYNATIVE_MODE, device_target="CPU")
+
+warmup_steps = 10
+steps = 2000
+
+
+def run_ops(x, y, add, mul, relu):
+    out = add(x, y)
+    out = mul(out, y)
+    return relu(out)
+
+
+def test_op_dispatch():
+    """Ops per second of repeated small ops, every op after the warmup hits the op cache"""
+    add = P.TensorAdd()
+    mul = P.Mul()
+    relu = P.ReLU()
+    x = Tensor(np.random.randn(2, 8).astype(np.float32))
+    y = Tensor(np.random.randn(2, 8).astype(np.float32))
+    for _ in range(warmup_steps):
+        out = run_ops(x, y, add, mul, relu)
+    start = time.time()
+    for _ in range(steps):
+        out = run_ops(x, y, add, mul, relu)
+    cost = time.time() - start
+    ops_per_sec = 3 * steps / cost
+    print("op dispatch: {:.1f} ops/sec, {:.2f} us/op".format(ops_per_sec, cost * 1e6 / (3 * steps)))
+
+    expect = np.maximum((x.asnumpy() + y.asnumpy()) * y.asnumpy(), 0)
+    assert np.allclose(out.asnumpy(), expect, rtol=1e-5, atol=1e-5)
+
+
+if __name__ == '__main__':
+    test_op_dispatch()
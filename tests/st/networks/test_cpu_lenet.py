@@ -16,11 +16,14 @@ import numpy as np
 import pytest
 
 import mindspore.context as context
+import mindspore.dataset as ds
 import mindspore.nn as nn
 from mindspore import Tensor
 from mindspore.nn import TrainOneStepCell, WithLossCell
 from mindspore.nn.optim import Momentum
 from mindspore.ops import operations as P
+from mindspore.train import Model
+from mindspore.train.callback import Callback
 
 context.set_context(mode=context.GRAPH_MODE, device_target="CPU")
 
@@ -79,3 +82,48 @@ def test_lenet():
     label = Tensor(np.ones([32]).astype(np.int32))
     net = LeNet()
     train(net, data, label)
+
+
+class StepLossCallback(Callback):
+    def __init__(self):
+        super(StepLossCallback, self).__init__()
+        self.losses = []
+
+    def step_end(self, run_context):
+        cb_params = run_context.original_args()
+        self.losses.append(cb_params.net_outputs.asnumpy())
+
+
+def create_dataset(step_num):
+    np.random.seed(1)
+    data = np.random.randn(step_num * 32, 1, 32, 32).astype(np.float32)
+    label = np.random.randint(0, 10, [step_num * 32]).astype(np.int32)
+    dataset = ds.NumpySlicesDataset({"data": data, "label": label}, shuffle=False)
+    return dataset.batch(32, drop_remainder=True)
+
+
+def train_with_model(net, step_num, dataset_sink_mode):
+    optimizer = Momentum(filter(lambda x: x.requires_grad, net.get_parameters()), 0.01, 0.9)
+    criterion = nn.SoftmaxCrossEntropyWithLogits(sparse=True, reduction='mean')
+    model = Model(net, loss_fn=criterion, optimizer=optimizer)
+    callback = StepLossCallback()
+    model.train(1, create_dataset(step_num), callbacks=[callback], dataset_sink_mode=dataset_sink_mode)
+    return callback.losses
+
+
+@pytest.mark.level0
+@pytest.mark.platform_x86_cpu
+@pytest.mark.env_onecard
+def test_lenet_dataset_sink():
+    """The batches reach the graph through the cpu dataset queue, the first ones sent before the compile included."""
+    step_num = 4
+    sink_net = LeNet()
+    normal_net = LeNet()
+    for name, param in normal_net.parameters_dict().items():
+        param.set_data(Tensor(sink_net.parameters_dict()[name].asnumpy()))
+    sink_losses = train_with_model(sink_net, step_num, dataset_sink_mode=True)
+    normal_losses = train_with_model(normal_net, step_num, dataset_sink_mode=False)
+    assert len(sink_losses) == step_num
+    assert np.allclose(np.array(sink_losses), np.array(normal_losses), rtol=1e-4, atol=1e-5)
+    for name, param in sink_net.parameters_dict().items():
+        assert np.allclose(param.asnumpy(), normal_net.parameters_dict()[name].asnumpy(), rtol=1e-4, atol=1e-5)
@@ -0,0 +1,54 @@
+# Copyright 2021 Huawei Technologies Co., Ltd
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+# http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ============================================================================
+import os
+import re
+import pytest
+
+worker_num = 2
+
+
+def run_job(compression, topk_ratio, port):
+    """Run a training job on a loopback cluster, return the train time and the accuracy of every worker"""
+    return_code = os.system(
+        "bash shell_run_test.sh Ascend /home/workspace/mindspore_dataset/mnist {} 1 127.0.0.1 {} {} {}".format(
+            worker_num, port, compression, topk_ratio)
+    )
+    assert return_code == 0
+    train_times = []
+    accuracies = []
+    for i in range(worker_num):
+        with open("worker_{}/worker_{}.log".format(i, i)) as f:
+            log = f.read()
+        train_times.append(float(re.findall(r"Train time: ([\d.]+)", log)[-1]))
+        accuracies.append(float(re.findall(r"Accuracy: ([\d.]+)", log)[-1]))
+    print("compression {}: train time {:.1f}s, accuracy {}".format(compression, max(train_times), accuracies))
+    return max(train_times), accuracies
+
+
+@pytest.mark.level0
+@pytest.mark.platform_arm_ascend_training
+@pytest.mark.platform_x86_ascend_training
+@pytest.mark.env_onecard
+def test_compression_ps_ascend_lenet():
+    """
+    Train with every compression of the pushes and the pulls. The bytes each worker sent and received are logged
+    when it finalizes, the model converges with all of them.
+    """
+    port = 8086
+    for compression, topk_ratio in (("none", 0.01), ("fp16", 0.01), ("bf16", 0.01), ("topk", 0.1)):
+        _, accuracies = run_job(compression, topk_ratio, port)
+        port += 1
+        for acc in accuracies:
+            assert acc > 0.85
@@ -0,0 +1,71 @@
+# Copyright 2021 Huawei Technologies Co., Ltd
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+# http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ============================================================================
+import os
+import re
+import pytest
+
+worker_num = 4
+# seconds a worker sleeps after a random quarter of its steps
+straggler_delay = 0.05
+
+
+def run_job(consistency_mode, staleness_threshold, port):
+    """Run a training job, return the train time of the fastest worker and the accuracy of every worker"""
+    return_code = os.system(
+        "bash shell_run_test.sh Ascend /home/workspace/mindspore_dataset/mnist {} 1 127.0.0.1 {} {} {} {}".format(
+            worker_num, port, consistency_mode, staleness_threshold, straggler_delay)
+    )
+    assert return_code == 0
+    train_times = []
+    accuracies = []
+    for i in range(worker_num):
+        with open("worker_{}/worker_{}.log".format(i, i)) as f:
+            log = f.read()
+        train_times.append(float(re.findall(r"Train time: ([\d.]+)", log)[-1]))
+        accuracies.append(float(re.findall(r"Accuracy: ([\d.]+)", log)[-1]))
+    print("{} mode, staleness threshold {}: fastest worker train time {:.1f}s, accuracy {}".format(
+        consistency_mode, staleness_threshold, min(train_times), accuracies))
+    return min(train_times), accuracies
+
+
+@pytest.mark.level0
+@pytest.mark.platform_arm_ascend_training
+@pytest.mark.platform_x86_ascend_training
+@pytest.mark.env_onecard
+def test_ssp_ps_ascend_lenet():
+    """
+    A job with straggling workers converges in every consistency mode.
+    """
+    for port, (consistency_mode, staleness_threshold) in enumerate([("sync", 0), ("ssp", 3), ("async", 0)], 8083):
+        _, accuracies = run_job(consistency_mode, staleness_threshold, port)
+        for acc in accuracies:
+            assert acc > 0.90
+
+
+@pytest.mark.level1
+@pytest.mark.platform_arm_ascend_training
+@pytest.mark.platform_x86_ascend_training
+@pytest.mark.env_onecard
+def test_ssp_ps_ascend_lenet_train_time():
+    """
+    In sync mode every step waits for the slowest worker of the step. In ssp and async mode a worker which was
+    delayed catches up later instead, so the job is faster. The train times depend on the load of the machine, so
+    this comparison is kept out of the level0 gate.
+    """
+    sync_time, _ = run_job("sync", 0, 8086)
+    ssp_time, _ = run_job("ssp", 3, 8087)
+    async_time, _ = run_job("async", 0, 8088)
+    assert async_time < sync_time
+    assert ssp_time < sync_time
@@ -0,0 +1,90 @@
+/**
+ * Copyright 2021 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <chrono>
+#include <functional>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+#include "common/common_test.h"
+#include "lite_cv/lite_mat.h"
+#include "lite_cv/image_process.h"
+#include "lite_cv/image_process_simd.h"
+#include "utils/log_adapter.h"
+
+using namespace mindspore::dataset;
+class MindDataImageProcessBenchmark : public UT::Common {
+ public:
+  MindDataImageProcessBenchmark() {}
+};
+
+namespace {
+LiteMat RandomMat(int w, int h, int c, uint32_t seed) {
+  LiteMat mat(w, h, c, LDataType::UINT8);
+  std::mt19937 rng(seed);
+  uint8_t *ptr = mat;
+  for (int i = 0; i < w * h * c; i++) {
+    ptr[i] = static_cast<uint8_t>(rng());
+  }
+  return mat;
+}
+}  // namespace
+
+// Per function timing of every supported level against the scalar path, for a typical 1080p input
+TEST_F(MindDataImageProcessBenchmark, SimdLevels1080p) {
+  SimdLevel origin = GetSimdLevel();
+  const int w = 1920;
+  const int h = 1080;
+  const int loop = 20;
+  LiteMat bgr = RandomMat(w, h, 3, 3);
+  LiteMat yuv = RandomMat(w, h * 3 / 2, 1, 5);
+  LiteMat resized;
+  LiteMat float_mat;
+  LiteMat norm_mat;
+  LiteMat yuv_bgr;
+  LiteMat affine_mat;
+  std::vector<float> means = {0.485, 0.456, 0.406};
+  std::vector<float> stds = {0.229, 0.224, 0.225};
+  double M[6] = {0.866, -0.5, 40.3, 0.5, 0.866, -17.9};
+
+  std::vector<SimdLevel> levels = {SimdLevel::kScalar};
+  for (auto level : {SimdLevel::kSSE41, SimdLevel::kAVX2, SimdLevel::kNEON}) {
+    if (SetSimdLevel(level)) {
+      levels.push_back(level);
+    }
+  }
+  for (auto level : levels) {
+    ASSERT_TRUE(SetSimdLevel(level));
+    std::vector<std::pair<std::string, std::function<bool()>>> funcs = {
+      {"ResizeBilinear", [&]() { return ResizeBilinear(bgr, resized, 1280, 720); }},
+      {"ConvertTo", [&]() { return ConvertTo(bgr, float_mat, 1.0 / 255); }},
+      {"SubStractMeanNormalize", [&]() { return SubStractMeanNormalize(float_mat, norm_mat, means, stds); }},
+      {"NV21ToBGR", [&]() { return InitFromPixel(yuv, LPixelType::NV212BGR, LDataType::UINT8, w, h, yuv_bgr); }},
+      {"Affine", [&]() { return Affine(bgr, affine_mat, M, {1920, 1080}, UINT8_C3(0, 0, 0)); }}};
+    for (auto &func : funcs) {
+      // The first call allocates the output, it is not timed.
+      ASSERT_TRUE(func.second());
+      auto start = std::chrono::steady_clock::now();
+      for (int i = 0; i < loop; i++) {
+        ASSERT_TRUE(func.second());
+      }
+      auto end = std::chrono::steady_clock::now();
+      double cost = std::chrono::duration<double, std::milli>(end - start).count() / loop;
+      MS_LOG(WARNING) << "simd level " << static_cast<int>(level) << ", " << func.first << ": " << cost << " ms";
+    }
+  }
+  SetSimdLevel(origin);
+}
@@ -0,0 +1,98 @@
+/**
+ * Copyright 2021 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <chrono>
+#include <random>
+#include <vector>
+#include "common/common_test.h"
+#include "ps/compression.h"
+
+namespace mindspore {
+namespace ps {
+class CompressionBenchmark : public UT::Common {
+ public:
+  CompressionBenchmark() = default;
+};
+
+namespace {
+constexpr size_t kGradSize = 1 << 20;
+constexpr size_t kRounds = 10;
+
+std::vector<float> RandomValues(size_t num) {
+  std::mt19937 engine(2021);
+  std::normal_distribution<float> distribution(0, 1);
+  std::vector<float> values(num);
+  for (auto &value : values) {
+    value = distribution(engine);
+  }
+  return values;
+}
+
+double GigaBytesPerSecond(size_t num, const std::chrono::steady_clock::time_point &start) {
+  std::chrono::duration<double> cost = std::chrono::steady_clock::now() - start;
+  return kRounds * num * sizeof(float) / 1e9 / cost.count();
+}
+}  // namespace
+
+// Bytes sent for a 1M gradient with every codec, and the encode and decode throughput.
+TEST_F(CompressionBenchmark, Throughput) {
+  std::vector<int> lens = {1, kGradSize, 1};
+  auto src = RandomValues(kGradSize + 2);
+  for (auto codec : {kCodecNone, kCodecFp16, kCodecBf16, kCodecTopK}) {
+    std::vector<float> residual(src.size(), 0);
+    std::vector<int> encoded_lens(lens.size());
+    std::vector<float> encoded(EncodedSize(codec, lens.data(), lens.size(), kDefaultTopKRatio));
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < kRounds; i++) {
+      EncodeValues(codec, src.data(), lens.data(), lens.size(), kDefaultTopKRatio, residual.data(), encoded.data(),
+                   encoded_lens.data());
+    }
+    double encode_speed = GigaBytesPerSecond(src.size(), start);
+    std::vector<float> decoded(src.size());
+    start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < kRounds; i++) {
+      DecodeValues(encoded.data(), encoded.size(), decoded.data(), decoded.size());
+    }
+    double decode_speed = GigaBytesPerSecond(src.size(), start);
+    MS_LOG(WARNING) << "codec " << codec << ": " << encoded.size() * sizeof(float) << " bytes of "
+                    << src.size() * sizeof(float) << ", encode " << encode_speed << " GB/s, decode " << decode_speed
+                    << " GB/s";
+  }
+}
+
+// The delta encoding of a 1M weight pulled in 16 bits, which also decodes it against the base of the receiver.
+TEST_F(CompressionBenchmark, DeltaThroughput) {
+  auto weight = RandomValues(kGradSize);
+  for (auto codec : {kCodecFp16, kCodecBf16}) {
+    std::vector<float> sender_base(kGradSize, 0);
+    std::vector<float> receiver_base(kGradSize, 0);
+    std::vector<float> encoded(DeltaEncodedSize(codec, kGradSize));
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < kRounds; i++) {
+      EncodeDelta(codec, weight.data(), kGradSize, sender_base.data(), encoded.data());
+    }
+    double encode_speed = GigaBytesPerSecond(kGradSize, start);
+    std::vector<float> decoded(kGradSize);
+    start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < kRounds; i++) {
+      DecodeValues(encoded.data(), encoded.size(), decoded.data(), decoded.size(), nullptr, receiver_base.data());
+    }
+    double decode_speed = GigaBytesPerSecond(kGradSize, start);
+    MS_LOG(WARNING) << "codec " << codec << " delta: encode " << encode_speed << " GB/s, decode " << decode_speed
+                    << " GB/s";
+  }
+}
+}  // namespace ps
+}  // namespace mindspore
@@ -0,0 +1,114 @@
+/**
+ * Copyright 2021 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <random>
+#include <vector>
+#include "common/common_test.h"
+#include "ps/dynamic_embedding_table.h"
+
+namespace mindspore {
+namespace ps {
+class DynamicEmbeddingTableBenchmark : public UT::Common {
+ public:
+  DynamicEmbeddingTableBenchmark() = default;
+};
+
+namespace {
+constexpr size_t kVocabSize = 1 << 20;
+constexpr size_t kBatchSize = 1 << 14;
+constexpr size_t kRounds = 50;
+constexpr size_t kDim = 16;
+
+// Zipf like ids, most lookups are on a few ids.
+std::vector<std::vector<size_t>> LongTailBatches() {
+  std::mt19937_64 engine(2021);
+  std::uniform_real_distribution<double> distribution(0, 1);
+  std::vector<std::vector<size_t>> batches(kRounds, std::vector<size_t>(kBatchSize));
+  for (auto &batch : batches) {
+    for (auto &id : batch) {
+      id = static_cast<size_t>(std::pow(static_cast<double>(kVocabSize), distribution(engine))) - 1;
+    }
+  }
+  return batches;
+}
+}  // namespace
+
+// Lookup throughput and memory of a long tail of ids, against a dense table which holds a row for every id.
+TEST_F(DynamicEmbeddingTableBenchmark, Lookup) {
+  auto batches = LongTailBatches();
+  std::vector<float> dense(kVocabSize * kDim, 0.01f);
+  std::vector<float> output(kBatchSize * kDim);
+  auto start = std::chrono::steady_clock::now();
+  for (const auto &batch : batches) {
+    for (size_t i = 0; i < batch.size(); i++) {
+      (void)memcpy(output.data() + i * kDim, dense.data() + batch[i] * kDim, kDim * sizeof(float));
+    }
+  }
+  std::chrono::duration<double> dense_cost = std::chrono::steady_clock::now() - start;
+
+  DynamicEmbeddingConfig config;
+  config.admit_threshold = 2;
+  DynamicEmbeddingTable table(kDim, config, DynamicEmbeddingInit());
+  for (const auto &batch : batches) {
+    table.Lookup(batch.data(), batch.size(), output.data());
+  }
+  auto metrics = table.metrics();
+  EXPECT_EQ(metrics.lookup_ids, kRounds * kBatchSize);
+  double lookups = static_cast<double>(kRounds * kBatchSize);
+  MS_LOG(WARNING) << "Dense table: " << dense.size() * sizeof(float) << " bytes, " << lookups / dense_cost.count()
+                  << " lookups/s. Dynamic table: " << metrics.memory_bytes << " bytes, " << metrics.row_num
+                  << " rows, " << lookups / metrics.lookup_seconds << " lookups/s, hits " << metrics.lookup_hits
+                  << ", rejected " << metrics.rejected_ids;
+}
+
+// Lookups of a few hot ids with a ttl after a burst of ids grew the table, the rows of the burst expire meanwhile.
+TEST_F(DynamicEmbeddingTableBenchmark, LookupAfterBurst) {
+  constexpr size_t kTtl = 512;
+  constexpr size_t kBurstRounds = 256;
+  constexpr size_t kHotIdNum = 4096;
+  constexpr size_t kHotBatchSize = 64;
+  constexpr size_t kHotRounds = 20000;
+  std::mt19937_64 engine(2021);
+  std::uniform_int_distribution<size_t> burst_distribution(0, kVocabSize * 4);
+  std::uniform_int_distribution<size_t> hot_distribution(0, kHotIdNum - 1);
+  DynamicEmbeddingConfig config;
+  config.ttl = kTtl;
+  DynamicEmbeddingTable table(kDim, config, DynamicEmbeddingInit());
+  std::vector<size_t> batch(kBatchSize);
+  std::vector<float> output(kBatchSize * kDim);
+  for (size_t round = 0; round < kBurstRounds; round++) {
+    for (auto &id : batch) {
+      id = burst_distribution(engine);
+    }
+    table.Lookup(batch.data(), batch.size(), output.data());
+  }
+  batch.resize(kHotBatchSize);
+  auto start = std::chrono::steady_clock::now();
+  for (size_t round = 0; round < kHotRounds; round++) {
+    for (auto &id : batch) {
+      id = hot_distribution(engine);
+    }
+    table.Lookup(batch.data(), batch.size(), output.data());
+  }
+  std::chrono::duration<double> cost = std::chrono::steady_clock::now() - start;
+  EXPECT_LE(table.row_num(), kHotIdNum);
+  MS_LOG(WARNING) << "Lookup of " << kHotBatchSize << " hot ids after a burst: " << cost.count() / kHotRounds * 1e6
+                  << " us, rows " << table.row_num() << ", ttl evicted rows " << table.metrics().ttl_evicted_rows;
+}
+}  // namespace ps
+}  // namespace mindspore
@@ -0,0 +1,182 @@
+/**
+ * Copyright 2021 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <chrono>
+#include <future>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include "common/common_test.h"
+#define private public
+#include "ps/parameter_server.h"
+#undef private
+
+namespace mindspore {
+namespace ps {
+class ParameterServerBenchmark : public UT::Common {
+ public:
+  ParameterServerBenchmark() = default;
+};
+
+namespace {
+using Server = ParameterServer<float>;
+constexpr size_t kKeyNum = 64;
+constexpr size_t kWeightSize = 4096;
+constexpr size_t kRounds = 20;
+constexpr float kInitWeight = 1.0f;
+constexpr float kGrad = 0.5f;
+constexpr float kLearningRate = 0.01f;
+constexpr float kMomentumValue = 0.9f;
+
+// Send a request of a worker to the pool of the server and wait for the response, as ServerHandler and the
+// workers do, without the van in between.
+::ps::KVPairs<float> Request(Server *server, int cmd, bool push, int sender, const ::ps::KVPairs<float> &req) {
+  ::ps::KVMeta meta;
+  meta.cmd = cmd;
+  meta.push = push;
+  meta.sender = sender;
+  meta.timestamp = 0;
+  meta.customer_id = 0;
+  ::ps::KVPairs<float> res;
+  std::promise<void> done;
+  server->thread_pool_->Submit([&]() {
+    server->handler_->Handle(meta, req, &res);
+    done.set_value();
+  });
+  done.get_future().wait();
+  return res;
+}
+
+bool Ready(Server *server, int cmd, int sender, Key key) {
+  ::ps::KVPairs<float> req;
+  req.keys.push_back(key);
+  return Request(server, cmd, false, sender, req).vals[0] > 0;
+}
+
+// A server of kKeyNum ApplyMomentum keys. The optimizers are set directly, the init requests build them from the
+// func graph of the server.
+std::unique_ptr<Server> NewServer(size_t worker_num, const std::string &consistency_mode) {
+  std::unique_ptr<Server> server(new Server());
+  server->pserver_num_ = 1;
+  server->worker_num_ = worker_num;
+  server->sync_mode_ = consistency_mode == kConsistencySync;
+  server->staleness_threshold_ = consistency_mode == kConsistencySSP ? 1 : UINT64_MAX;
+  server->handler_.reset(new Server::ServerHandler(server.get()));
+  server->handler_->Init();
+  server->InitOptimInfoBuilders();
+  server->thread_pool_.reset(new ServerThreadPool(kMaxServerThreadNum));
+  for (Key key = 0; key < kKeyNum; key++) {
+    server->weight_key_to_optims_[key] = kApplyMomentum;
+    server->optimizers_[key] = std::make_shared<kernel::ps::ApplyMomentumPSKernel>(0, 1, worker_num);
+    server->optim_inputs_shape_[key] = std::make_shared<InputsShape>();
+    ::ps::KVPairs<float> init;
+    init.keys.push_back(key);
+    init.vals = Values(kWeightSize, kInitWeight);
+    init.lens.push_back(kWeightSize);
+    Request(server.get(), kInitWeightsCmd, true, 0, init);
+  }
+  if (server->sync_mode_) {
+    server->thread_.reset(new std::thread(&Server::UpdateWeights, server.get()));
+  }
+  return server;
+}
+
+void StopServer(Server *server) {
+  server->Finalize();
+  if (server->thread_ != nullptr) {
+    server->thread_->join();
+  }
+}
+
+// Every worker pushes a gradient on each key and then pulls each key, kRounds times, asking whether the key is
+// ready before each request as the workers do. Returns the pushes and pulls per second.
+double RunWorkers(Server *server, size_t worker_num) {
+  auto start = std::chrono::steady_clock::now();
+  std::vector<std::thread> workers;
+  for (size_t w = 0; w < worker_num; w++) {
+    workers.emplace_back([server, w]() {
+      int sender = static_cast<int>(w);
+      ::ps::KVPairs<float> push;
+      push.vals.push_back(kLearningRate);
+      push.vals.append(Values(kWeightSize, kGrad));
+      push.vals.push_back(kMomentumValue);
+      push.lens.push_back(1);
+      push.lens.push_back(static_cast<int>(kWeightSize));
+      push.lens.push_back(1);
+      push.keys.push_back(0);
+      for (size_t round = 0; round < kRounds; round++) {
+        for (size_t k = 0; k < kKeyNum; k++) {
+          Key key = (k + w) % kKeyNum;
+          while (!Ready(server, kCheckReadyForPushCmd, sender, key)) {
+            std::this_thread::yield();
+          }
+          push.keys[0] = key;
+          Request(server, 0, true, sender, push);
+        }
+        for (size_t k = 0; k < kKeyNum; k++) {
+          Key key = (k + w) % kKeyNum;
+          while (!Ready(server, kCheckReadyForPullCmd, sender, key)) {
+            std::this_thread::yield();
+          }
+          ::ps::KVPairs<float> pull;
+          pull.keys.push_back(key);
+          Request(server, 0, false, sender, pull);
+        }
+      }
+    });
+  }
+  for (auto &worker : workers) {
+    worker.join();
+  }
+  std::chrono::duration<double> cost = std::chrono::steady_clock::now() - start;
+  return 2.0 * worker_num * kRounds * kKeyNum / cost.count();
+}
+
+// the weight after steps momentum updates of grad
+float ExpectedWeight(size_t steps, float grad) {
+  float weight = kInitWeight;
+  float accumulation = 0;
+  for (size_t i = 0; i < steps; i++) {
+    accumulation = accumulation * kMomentumValue + grad;
+    weight -= accumulation * kLearningRate;
+  }
+  return weight;
+}
+}  // namespace
+
+// Push and pull requests per second of 1 to 8 workers on one server, in each consistency mode. The sync mode
+// averages the gradients of all the workers in one update per round, the others apply every gradient divided by
+// the worker number as it comes.
+TEST_F(ParameterServerBenchmark, PushPullQps) {
+  for (std::string mode : {kConsistencySync, kConsistencySSP, kConsistencyAsync}) {
+    for (size_t worker_num = 1; worker_num <= 8; worker_num *= 2) {
+      auto server = NewServer(worker_num, mode);
+      double qps = RunWorkers(server.get(), worker_num);
+      StopServer(server.get());
+      MS_LOG(WARNING) << "consistency mode " << mode << ", workers " << worker_num << ", push/pull qps " << qps;
+
+      bool sync = mode == kConsistencySync;
+      float expected = sync ? ExpectedWeight(kRounds, kGrad) : ExpectedWeight(kRounds * worker_num, kGrad / worker_num);
+      for (Key key = 0; key < kKeyNum; key++) {
+        auto &weight = *server->weights_.at(key);
+        EXPECT_NEAR(weight[0], expected, 1e-4);
+        EXPECT_NEAR(weight[kWeightSize - 1], expected, 1e-4);
+      }
+    }
+  }
+}
+}  // namespace ps
+}  // namespace mindspore
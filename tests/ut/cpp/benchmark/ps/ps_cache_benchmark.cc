@@ -0,0 +1,180 @@
+/**
+ * Copyright 2021 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <chrono>
+#include <cmath>
+#include <memory>
+#include <random>
+#include <unordered_map>
+#include <vector>
+#include "common/common_test.h"
+#define private public
+#include "ps/ps_cache/ps_cache_manager.h"
+#undef private
+
+namespace mindspore {
+namespace ps {
+class PsCacheBenchmark : public UT::Common {
+ public:
+  PsCacheBenchmark() = default;
+};
+
+namespace {
+constexpr size_t kVocabSize = 1 << 19;
+constexpr size_t kCacheVocabSize = 1 << 16;
+constexpr size_t kBatchSize = 1 << 14;
+constexpr size_t kSteps = 100;
+
+// Batches of ids skewed to the small ids as the frequent ones, a part of each batch repeats.
+std::vector<std::vector<int>> SkewedBatches() {
+  std::mt19937_64 engine(2021);
+  std::uniform_real_distribution<double> distribution(0, 1);
+  std::vector<std::vector<int>> batches(kSteps, std::vector<int>(kBatchSize));
+  for (auto &batch : batches) {
+    for (auto &id : batch) {
+      id = static_cast<int>(kVocabSize * std::pow(distribution(engine), 3));
+    }
+  }
+  return batches;
+}
+
+// A cache without the worker, the hash maps and the swap buffers are set as Initialize sets them.
+std::unique_ptr<PsCacheManager> NewManager(bool thread_pool) {
+  std::unique_ptr<PsCacheManager> manager(new PsCacheManager());
+  manager->batch_elements_ = kBatchSize;
+  manager->vocab_size_ = kVocabSize;
+  manager->cache_vocab_size_ = kCacheVocabSize;
+  manager->host_cache_vocab_size_ = kCacheVocabSize * kHostCacheScaleFactor;
+  manager->range_bound_ = {0, kVocabSize};
+  manager->embedding_device_cache_ = std::make_shared<EmbeddingDeviceCache>(kBatchSize, kCacheVocabSize);
+  manager->embedding_host_cache_ = std::make_shared<EmbeddingHostCache>(kBatchSize, manager->host_cache_vocab_size_);
+  if (thread_pool) {
+    manager->thread_pool_ = std::make_unique<ServerThreadPool>(kMaxThreadNum - 1);
+  }
+  return manager;
+}
+
+// ParseData before the batching, every id of the batch is parsed in turn, the repeated ones too.
+void ParseDataPerId(PsCacheManager *manager, const int *batch_ids, size_t batch_ids_len, int *hash_index) {
+  for (size_t i = 0; i < batch_ids_len; i++) {
+    int64_t id = batch_ids[i];
+    if (id < 0 || static_cast<size_t>(id) >= kVocabSize) {
+      hash_index[i] = INVALID_INDEX_VALUE;
+      continue;
+    }
+    bool need_swap_host_to_device = true;
+    bool need_swap_device_to_host = true;
+    hash_index[i] = manager->ParseDeviceData(id, &need_swap_device_to_host, &need_swap_host_to_device);
+    if (need_swap_host_to_device) {
+      manager->ParseHostDataHostToDevice(id);
+    }
+    if (need_swap_device_to_host) {
+      manager->ParseHostDataDeviceToHost();
+    }
+  }
+}
+
+// Parse the batches as ProcessData does while the graph runs the previous step, return the seconds per step and
+// the ids swapped in from the host in all.
+template <typename Parse>
+double RunSteps(PsCacheManager *manager, const std::vector<std::vector<int>> &batches, Parse &&parse,
+                size_t *swap_in_count) {
+  std::vector<int> hash_index(kBatchSize);
+  *swap_in_count = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (const auto &batch : batches) {
+    manager->graph_step_ = manager->data_step_;
+    manager->IncreaseStep();
+    manager->statistics_info_ = PsCacheStatisticsInfo();
+    parse(manager, batch.data(), batch.size(), hash_index.data());
+    *swap_in_count += manager->statistics_info_.host_to_device_size_;
+  }
+  std::chrono::duration<double> cost = std::chrono::steady_clock::now() - start;
+  return cost.count() / batches.size();
+}
+}  // namespace
+
+// Lookups of a batch of ids with the open addressing map and with std::unordered_map, which the hash map used before.
+TEST_F(PsCacheBenchmark, IdIndexMapLookUp) {
+  constexpr size_t kCacheSize = 1 << 20;
+  constexpr size_t kLookUpBatchSize = 1 << 16;
+  constexpr size_t kRounds = 20;
+  std::mt19937_64 engine(2021);
+  std::uniform_int_distribution<int64_t> distribution(0, 1LL << 40);
+  std::vector<int64_t> cached_ids(kCacheSize);
+  for (auto &id : cached_ids) {
+    id = distribution(engine);
+  }
+  IdIndexMap map(kCacheSize);
+  std::unordered_map<int64_t, int> unordered_map;
+  for (size_t i = 0; i < cached_ids.size(); i++) {
+    if (map.Find(cached_ids[i]) == INVALID_INDEX_VALUE) {
+      map.Insert(cached_ids[i], static_cast<int>(i));
+      unordered_map[cached_ids[i]] = static_cast<int>(i);
+    }
+  }
+  // half of the batch hits the cache
+  std::vector<int64_t> batch(kLookUpBatchSize);
+  for (size_t i = 0; i < batch.size(); i++) {
+    batch[i] = i % 2 == 0 ? cached_ids[(i * 7919) % cached_ids.size()] : distribution(engine);
+  }
+
+  size_t map_hits = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (size_t round = 0; round < kRounds; round++) {
+    for (auto id : batch) {
+      map_hits += map.Find(id) != INVALID_INDEX_VALUE;
+    }
+  }
+  std::chrono::duration<double> map_cost = std::chrono::steady_clock::now() - start;
+  size_t unordered_map_hits = 0;
+  start = std::chrono::steady_clock::now();
+  for (size_t round = 0; round < kRounds; round++) {
+    for (auto id : batch) {
+      unordered_map_hits += unordered_map.find(id) != unordered_map.end();
+    }
+  }
+  std::chrono::duration<double> unordered_map_cost = std::chrono::steady_clock::now() - start;
+  EXPECT_EQ(map_hits, unordered_map_hits);
+  double lookups = static_cast<double>(kRounds * kLookUpBatchSize);
+  MS_LOG(WARNING) << "Lookups per second of " << kCacheSize << " cached ids, open addressing map: "
+                  << lookups / map_cost.count() << ", unordered_map: " << lookups / unordered_map_cost.count();
+}
+
+// ParseData of skewed batches, id by id as before, on the calling thread alone and with the lookups on the thread pool.
+TEST_F(PsCacheBenchmark, ParseData) {
+  auto batches = SkewedBatches();
+  auto parse_data = [](PsCacheManager *manager, const int *batch_ids, size_t batch_ids_len, int *hash_index) {
+    manager->ParseData(batch_ids, batch_ids_len, hash_index);
+  };
+  auto per_id_manager = NewManager(false);
+  size_t per_id_swap_in_count = 0;
+  double per_id_cost = RunSteps(per_id_manager.get(), batches, ParseDataPerId, &per_id_swap_in_count);
+  auto in_turn_manager = NewManager(false);
+  size_t in_turn_swap_in_count = 0;
+  double in_turn_cost = RunSteps(in_turn_manager.get(), batches, parse_data, &in_turn_swap_in_count);
+  auto batched_manager = NewManager(true);
+  size_t batched_swap_in_count = 0;
+  double batched_cost = RunSteps(batched_manager.get(), batches, parse_data, &batched_swap_in_count);
+  // both parses never swap out an id of the batch they parse, so they swap in no more than the old one, and the same
+  EXPECT_LE(batched_swap_in_count, per_id_swap_in_count);
+  EXPECT_EQ(in_turn_swap_in_count, batched_swap_in_count);
+  MS_LOG(WARNING) << "ParseData of " << kBatchSize << " ids, ms per step, id by id: " << per_id_cost * 1000
+                  << ", calling thread: " << in_turn_cost * 1000 << ", thread pool: " << batched_cost * 1000
+                  << ", ids swapped in, id by id: " << per_id_swap_in_count << ", calling thread: "
+                  << in_turn_swap_in_count << ", thread pool: " << batched_swap_in_count;
+}
+}  // namespace ps
+}  // namespace mindspore
@@ -0,0 +1,107 @@
+/**
+ * Copyright 2021 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "common/common_test.h"
+#include "ps/core/tcp_client.h"
+#include "ps/core/tcp_server.h"
+
+namespace mindspore {
+namespace ps {
+namespace core {
+class TcpBenchmark : public UT::Common {
+ public:
+  TcpBenchmark() = default;
+};
+
+namespace {
+constexpr size_t kTotalBytes = 1 << 26;
+constexpr size_t kMaxMessageNum = 100000;
+
+// Send message_num messages of message_size bytes over the loopback, in the data of the messages or as raw segments
+// received into a buffer of the server, and return the seconds until the server received all of them.
+double SendMessages(size_t message_size, size_t message_num, bool use_segment) {
+  TcpServer server("127.0.0.1", 0);
+  std::vector<unsigned char> receive_buffer(message_size);
+  std::mutex mutex;
+  std::condition_variable cond;
+  size_t received = 0;
+  size_t received_bytes = 0;
+  server.SetSegmentAllocator([&](const TcpConnection &, const CommMessage &, size_t, size_t len) -> void * {
+    return len <= receive_buffer.size() ? receive_buffer.data() : nullptr;
+  });
+  server.SetMessageCallback([&](const TcpServer &, const TcpConnection &, const CommMessage &message) {
+    std::lock_guard<std::mutex> lock(mutex);
+    received_bytes += message.data().size() + (use_segment ? message.segment_lens(0) : 0);
+    if (++received == message_num) {
+      cond.notify_one();
+    }
+  });
+  server.Init();
+  std::thread server_thread([&]() { server.Start(); });
+
+  TcpClient client("127.0.0.1", server.BoundPort());
+  client.Init();
+  std::thread client_thread([&]() { client.Start(); });
+
+  std::string payload(message_size, 'a');
+  auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < message_num; ++i) {
+    CommMessage message;
+    message.mutable_pb_meta()->set_request_id(i);
+    if (use_segment) {
+      client.SendMessage(message, {{payload.data(), payload.size()}});
+    } else {
+      message.set_data(payload);
+      client.SendMessage(message);
+    }
+  }
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    EXPECT_TRUE(cond.wait_for(lock, std::chrono::seconds(60), [&]() { return received == message_num; }));
+  }
+  std::chrono::duration<double> cost = std::chrono::steady_clock::now() - start;
+  EXPECT_EQ(received_bytes, message_size * message_num);
+
+  // the event loop of the client returns when its buffer event is freed
+  client.Stop();
+  client_thread.join();
+  TcpClient::StopEventBase();
+  server.Stop();
+  server_thread.join();
+  return cost.count();
+}
+}  // namespace
+
+// Throughput of the messages of various sizes over the loopback, the small messages are coalesced.
+TEST_F(TcpBenchmark, LoopbackThroughput) {
+  for (size_t message_size : {64, 1024, 65536, 1 << 20}) {
+    size_t message_num = std::min(kTotalBytes / message_size, kMaxMessageNum);
+    for (bool use_segment : {false, true}) {
+      double cost = SendMessages(message_size, message_num, use_segment);
+      MS_LOG(WARNING) << "Message size " << message_size << (use_segment ? " in segment" : " in data") << ": "
+                      << message_num / cost << " messages/s, " << message_size * message_num / cost / 1e6 << " MB/s";
+    }
+  }
+}
+}  // namespace core
+}  // namespace ps
+}  // namespace mindspore
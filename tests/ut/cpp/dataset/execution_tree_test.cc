@@ -13,7 +13,9 @@
  * See the License for the specific language governing permissions and
  * limitations under the License.
  */
+#include <sstream>
 #include <string>
+#include <vector>
 #include "minddata/dataset/util/circular_pool.h"
 #include "minddata/dataset/core/client.h"
 #include "minddata/dataset/engine/execution_tree.h"
@@ -142,3 +144,55 @@ TEST_F(MindDataTestExecutionTree, TestExecutionTree2) {
 TEST_F(MindDataTestExecutionTree, TestExecutionTree3) {
   MS_LOG(INFO) << "Doing MindDataTestExecutionTree3.";
 }
+
+// Parse the cpu lists of the numa nodes as found in sysfs
+TEST_F(MindDataTestExecutionTree, TestNumaCpuList) {
+  MS_LOG(INFO) << "Doing MindDataTestExecutionTree-TestNumaCpuList.";
+  std::vector<int32_t> cpus;
+  EXPECT_TRUE(NumaPlacement::ParseCpuList("0-3,8,10-11\n", &cpus).IsOk());
+  EXPECT_EQ(cpus, std::vector<int32_t>({0, 1, 2, 3, 8, 10, 11}));
+
+  cpus.clear();
+  EXPECT_TRUE(NumaPlacement::ParseCpuList("", &cpus).IsOk());
+  EXPECT_TRUE(cpus.empty());
+
+  EXPECT_TRUE(NumaPlacement::ParseCpuList("3-1", &cpus).IsError());
+  EXPECT_TRUE(NumaPlacement::ParseCpuList("0-a", &cpus).IsError());
+}
+
+// Launch a tree under each numa policy, the placement must not change the output
+TEST_F(MindDataTestExecutionTree, TestNumaPolicy) {
+  MS_LOG(INFO) << "Doing MindDataTestExecutionTree-TestNumaPolicy.";
+  std::shared_ptr<ConfigManager> cfg = GlobalContext::config_manager();
+  for (auto policy : {NumaPolicy::kCompact, NumaPolicy::kSpread}) {
+    cfg->set_numa_policy(policy);
+    auto my_tree = std::make_shared<ExecutionTree>();
+    std::string dataset_path = datasets_root_path_ + "/testDataset1/testDataset1.data";
+    std::shared_ptr<TFReaderOp> my_tfreader_op;
+    TFReaderOp::Builder()
+        .SetDatasetFilesList({dataset_path})
+        .SetRowsPerBuffer(2)
+        .SetWorkerConnectorSize(2)
+        .SetNumWorkers(2)
+        .Build(&my_tfreader_op);
+    my_tree->AssociateNode(my_tfreader_op);
+    my_tree->AssignRoot(my_tfreader_op);
+    ASSERT_TRUE(my_tree->Prepare().IsOk());
+    ASSERT_TRUE(my_tree->Launch().IsOk());
+
+    std::ostringstream ss;
+    ss << *my_tree;
+    EXPECT_NE(ss.str().find("Numa policy"), std::string::npos);
+
+    DatasetIterator di(my_tree);
+    TensorRow buffer;
+    int32_t row_count = 0;
+    ASSERT_TRUE(di.FetchNextTensorRow(&buffer).IsOk());
+    while (!buffer.empty()) {
+      row_count++;
+      ASSERT_TRUE(di.FetchNextTensorRow(&buffer).IsOk());
+    }
+    EXPECT_EQ(row_count, 10);
+  }
+  cfg->set_numa_policy(NumaPolicy::kNone);
+}
@@ -17,10 +17,12 @@
 #include "common/common.h"
 #include "lite_cv/lite_mat.h"
 #include "lite_cv/image_process.h"
+#include "lite_cv/image_process_simd.h"
 #include <opencv2/opencv.hpp>
 #include <opencv2/imgproc/types_c.h>
 
 #include <fstream>
+#include <random>
 
 using namespace mindspore::dataset;
 class MindDataImageProcess : public UT::Common {
@@ -879,3 +881,135 @@ TEST_F(MindDataImageProcess, TestMultiplyFloat) {
                     static_cast<FLOAT32_C1 *>(dst_float.data_ptr_)[i].c1);
   }
 }
+
+// Vector levels the running CPU supports, every one of them must give the same bytes as the scalar path
+std::vector<SimdLevel> SupportedSimdLevels() {
+  std::vector<SimdLevel> levels;
+  SimdLevel origin = GetSimdLevel();
+  for (auto level : {SimdLevel::kSSE41, SimdLevel::kAVX2, SimdLevel::kNEON}) {
+    if (SetSimdLevel(level)) {
+      levels.push_back(level);
+    }
+  }
+  SetSimdLevel(origin);
+  return levels;
+}
+
+LiteMat RandomMat(int w, int h, int c, uint32_t seed) {
+  LiteMat mat(w, h, c, LDataType::UINT8);
+  std::mt19937 rng(seed);
+  uint8_t *ptr = mat;
+  for (int i = 0; i < w * h * c; i++) {
+    ptr[i] = static_cast<uint8_t>(rng());
+  }
+  return mat;
+}
+
+bool SameBytes(const LiteMat &a, const LiteMat &b) {
+  if (a.width_ != b.width_ || a.height_ != b.height_ || a.channel_ != b.channel_ || a.data_type_ != b.data_type_) {
+    return false;
+  }
+  return memcmp(a.data_ptr_, b.data_ptr_, a.width_ * a.height_ * a.channel_ * a.elem_size_) == 0;
+}
+
+TEST_F(MindDataImageProcess, TestSimdLevel) {
+  SimdLevel origin = GetSimdLevel();
+  EXPECT_TRUE(SetSimdLevel(SimdLevel::kScalar));
+  EXPECT_EQ(GetSimdLevel(), SimdLevel::kScalar);
+  EXPECT_TRUE(SetSimdLevel(GetSupportedSimdLevel()));
+  EXPECT_EQ(GetSimdLevel(), GetSupportedSimdLevel());
+  if (GetSupportedSimdLevel() != SimdLevel::kNEON) {
+    EXPECT_FALSE(SetSimdLevel(SimdLevel::kNEON));
+    EXPECT_EQ(GetSimdLevel(), GetSupportedSimdLevel());
+  }
+  SetSimdLevel(origin);
+}
+
+TEST_F(MindDataImageProcess, TestSimdResizeBitExact) {
+  SimdLevel origin = GetSimdLevel();
+  // odd sizes leave a scalar tail on every row, up and down scaling take both row update branches
+  std::vector<std::vector<int>> cases = {{333, 251, 3, 224, 224}, {97, 61, 3, 301, 133}, {333, 251, 1, 201, 199},
+                                         {64, 48, 1, 17, 9}};
+  for (auto &c : cases) {
+    LiteMat src = RandomMat(c[0], c[1], c[2], c[0]);
+    LiteMat expect;
+    ASSERT_TRUE(SetSimdLevel(SimdLevel::kScalar));
+    ASSERT_TRUE(ResizeBilinear(src, expect, c[3], c[4]));
+    for (auto level : SupportedSimdLevels()) {
+      ASSERT_TRUE(SetSimdLevel(level));
+      LiteMat dst;
+      ASSERT_TRUE(ResizeBilinear(src, dst, c[3], c[4]));
+      EXPECT_TRUE(SameBytes(expect, dst)) << "simd level " << static_cast<int>(level);
+    }
+  }
+  SetSimdLevel(origin);
+}
+
+TEST_F(MindDataImageProcess, TestSimdConvertNormalizeBitExact) {
+  SimdLevel origin = GetSimdLevel();
+  LiteMat src = RandomMat(227, 131, 3, 7);
+  std::vector<float> means = {0.485, 0.456, 0.406};
+  std::vector<float> stds = {0.229, 0.224, 0.225};
+  std::vector<std::vector<float>> mean_cases = {means, {}, means};
+  std::vector<std::vector<float>> std_cases = {stds, stds, {}};
+  for (double scale : {1.0, 1.0 / 255, 0.017}) {
+    LiteMat expect_float;
+    ASSERT_TRUE(SetSimdLevel(SimdLevel::kScalar));
+    ASSERT_TRUE(ConvertTo(src, expect_float, scale));
+    for (auto level : SupportedSimdLevels()) {
+      ASSERT_TRUE(SetSimdLevel(level));
+      LiteMat dst_float;
+      ASSERT_TRUE(ConvertTo(src, dst_float, scale));
+      EXPECT_TRUE(SameBytes(expect_float, dst_float)) << "simd level " << static_cast<int>(level);
+
+      for (size_t i = 0; i < mean_cases.size(); i++) {
+        LiteMat expect_norm;
+        LiteMat dst_norm;
+        ASSERT_TRUE(SetSimdLevel(SimdLevel::kScalar));
+        ASSERT_TRUE(SubStractMeanNormalize(expect_float, expect_norm, mean_cases[i], std_cases[i]));
+        ASSERT_TRUE(SetSimdLevel(level));
+        ASSERT_TRUE(SubStractMeanNormalize(expect_float, dst_norm, mean_cases[i], std_cases[i]));
+        EXPECT_TRUE(SameBytes(expect_norm, dst_norm)) << "simd level " << static_cast<int>(level);
+      }
+    }
+  }
+  SetSimdLevel(origin);
+}
+
+TEST_F(MindDataImageProcess, TestSimdYUVBitExact) {
+  SimdLevel origin = GetSimdLevel();
+  for (int w : {64, 101, 37}) {
+    int h = 18;
+    LiteMat yuv = RandomMat(w, h * 3 / 2 + 1, 1, w);
+    for (auto pixel_type : {LPixelType::NV212BGR, LPixelType::NV122BGR}) {
+      LiteMat expect;
+      ASSERT_TRUE(SetSimdLevel(SimdLevel::kScalar));
+      ASSERT_TRUE(InitFromPixel(yuv, pixel_type, LDataType::UINT8, w, h, expect));
+      for (auto level : SupportedSimdLevels()) {
+        ASSERT_TRUE(SetSimdLevel(level));
+        LiteMat dst;
+        ASSERT_TRUE(InitFromPixel(yuv, pixel_type, LDataType::UINT8, w, h, dst));
+        EXPECT_TRUE(SameBytes(expect, dst)) << "simd level " << static_cast<int>(level);
+      }
+    }
+  }
+  SetSimdLevel(origin);
+}
+
+TEST_F(MindDataImageProcess, TestSimdAffineBitExact) {
+  SimdLevel origin = GetSimdLevel();
+  size_t rows = 123;
+  size_t cols = 157;
+  LiteMat src = RandomMat(cols, rows, 3, 11);
+  double M[6] = {0.866, -0.5, 40.3, 0.5, 0.866, -17.9};
+  LiteMat expect;
+  ASSERT_TRUE(SetSimdLevel(SimdLevel::kScalar));
+  ASSERT_TRUE(Affine(src, expect, M, {cols, rows}, UINT8_C3(0, 0, 0)));
+  for (auto level : SupportedSimdLevels()) {
+    ASSERT_TRUE(SetSimdLevel(level));
+    LiteMat dst;
+    ASSERT_TRUE(Affine(src, dst, M, {cols, rows}, UINT8_C3(0, 0, 0)));
+    EXPECT_TRUE(SameBytes(expect, dst)) << "simd level " << static_cast<int>(level);
+  }
+  SetSimdLevel(origin);
+}
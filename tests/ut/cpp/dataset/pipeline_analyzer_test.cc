@@ -0,0 +1,140 @@
+/**
+ * Copyright 2021 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "common/common.h"
+#include "gtest/gtest.h"
+#include "minddata/dataset/engine/perf/pipeline_analyzer.h"
+
+using namespace mindspore::dataset;
+
+class MindDataTestPipelineAnalyzer : public UT::Common {
+ public:
+  MindDataTestPipelineAnalyzer() {}
+
+  // Stats of a source op feeding a map op feeding a batch op, the pipeline output
+  std::vector<OpPerfStats> MakePipeline() {
+    OpPerfStats source;
+    source.op_id = 2;
+    source.op_type = "TFReaderOp";
+    source.num_workers = 4;
+    source.num_threads = 5;
+    source.is_leaf = true;
+    source.cpu_util = 0.3;
+    OpPerfStats map;
+    map.op_id = 1;
+    map.op_type = "MapOp";
+    map.num_workers = 4;
+    map.num_threads = 5;
+    map.cpu_util = 0.3;
+    OpPerfStats batch;
+    batch.op_id = 0;
+    batch.op_type = "BatchOp";
+    batch.num_workers = 1;
+    batch.num_threads = 2;
+    batch.is_pipeline_output = true;
+    batch.cpu_util = 0.1;
+    return {source, map, batch};
+  }
+};
+
+// A map op slower than the rest of the pipeline: its input queue is full while its output queue is empty
+TEST_F(MindDataTestPipelineAnalyzer, TestSlowMapComputeBound) {
+  auto ops = MakePipeline();
+  ops[0].output_occupancy = 0.95;
+  ops[0].back_pressure = 0.9;
+  ops[1].input_occupancy = 0.95;
+  ops[1].output_occupancy = 0.02;
+  ops[1].starvation = 0.0;
+  ops[1].output_empty = 0.9;
+  ops[1].cpu_util = 0.95;
+  ops[2].input_occupancy = 0.02;
+  ops[2].starvation = 0.9;
+  ops[2].output_occupancy = 0.01;
+  PerfReport report = PipelineAnalyzer::Analyze(ops, 32, 16);
+  EXPECT_EQ(report.bottleneck_op_id, 1);
+  EXPECT_FALSE(report.consumer_bound);
+  ASSERT_EQ(report.suggestions.size(), 1);
+  EXPECT_EQ(report.suggestions[0].op_id, 1);
+  EXPECT_EQ(report.suggestions[0].setting, "num_parallel_workers");
+  EXPECT_EQ(report.suggestions[0].current, 4);
+  EXPECT_EQ(report.suggestions[0].suggested, 8);
+}
+
+// With all the cpus busy, the idle workers of other ops are given back instead
+TEST_F(MindDataTestPipelineAnalyzer, TestSlowMapCpuSaturated) {
+  auto ops = MakePipeline();
+  ops[0].num_workers = 8;
+  ops[0].num_threads = 9;
+  ops[0].cpu_util = 0.05;
+  ops[0].output_occupancy = 1.0;
+  ops[0].back_pressure = 1.0;
+  ops[1].input_occupancy = 1.0;
+  ops[1].output_occupancy = 0.0;
+  ops[1].cpu_util = 1.0;
+  ops[2].input_occupancy = 0.0;
+  PerfReport report = PipelineAnalyzer::Analyze(ops, 5, 16);
+  EXPECT_EQ(report.bottleneck_op_id, 1);
+  ASSERT_EQ(report.suggestions.size(), 1);
+  EXPECT_EQ(report.suggestions[0].op_id, 2);
+  EXPECT_EQ(report.suggestions[0].current, 8);
+  EXPECT_EQ(report.suggestions[0].suggested, 1);
+}
+
+// A slow source with idle threads is waiting on IO, more workers are suggested even with a low cpu use
+TEST_F(MindDataTestPipelineAnalyzer, TestSlowSource) {
+  auto ops = MakePipeline();
+  ops[0].output_occupancy = 0.05;
+  ops[0].cpu_util = 0.1;
+  ops[1].input_occupancy = 0.05;
+  ops[1].starvation = 0.9;
+  ops[1].output_occupancy = 0.05;
+  ops[2].input_occupancy = 0.05;
+  PerfReport report = PipelineAnalyzer::Analyze(ops, 32, 16);
+  EXPECT_EQ(report.bottleneck_op_id, 2);
+  ASSERT_EQ(report.suggestions.size(), 1);
+  EXPECT_EQ(report.suggestions[0].suggested, 8);
+}
+
+// A full pipeline output means the pipeline keeps up with the consumer
+TEST_F(MindDataTestPipelineAnalyzer, TestConsumerBound) {
+  auto ops = MakePipeline();
+  for (auto &op : ops) {
+    op.input_occupancy = op.is_leaf ? 1.0 : 0.9;
+    op.output_occupancy = 0.9;
+    op.back_pressure = 0.8;
+  }
+  PerfReport report = PipelineAnalyzer::Analyze(ops, 32, 16);
+  EXPECT_TRUE(report.consumer_bound);
+  EXPECT_EQ(report.bottleneck_op_id, -1);
+  EXPECT_TRUE(report.suggestions.empty());
+}
+
+// A bursty producer gets a deeper queue
+TEST_F(MindDataTestPipelineAnalyzer, TestBurstyQueue) {
+  auto ops = MakePipeline();
+  ops[0].output_occupancy = 0.9;
+  ops[1].input_occupancy = 0.9;
+  ops[1].output_occupancy = 0.4;
+  ops[1].back_pressure = 0.3;
+  ops[1].output_empty = 0.4;
+  ops[1].cpu_util = 0.9;
+  ops[2].input_occupancy = 0.4;
+  ops[2].output_occupancy = 0.3;
+  PerfReport report = PipelineAnalyzer::Analyze(ops, 32, 16);
+  EXPECT_EQ(report.bottleneck_op_id, 1);
+  ASSERT_EQ(report.suggestions.size(), 2);
+  EXPECT_EQ(report.suggestions[1].setting, "prefetch_size");
+  EXPECT_EQ(report.suggestions[1].suggested, 32);
+}
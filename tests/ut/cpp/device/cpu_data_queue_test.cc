@@ -0,0 +1,145 @@
+/**
+ * Copyright 2021 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <chrono>
+#include <cstring>
+#include <future>
+#include <thread>
+#include <vector>
+#include "common/common_test.h"
+#include "runtime/device/cpu/cpu_data_queue.h"
+
+namespace mindspore {
+namespace device {
+namespace cpu {
+class TestCpuDataQueue : public UT::Common {
+ public:
+  TestCpuDataQueue() = default;
+};
+
+namespace {
+// Long enough to never expire in the tests, a test that waits for it has hung.
+constexpr unsigned int kLongTimeoutInSec = 60;
+constexpr auto kPromptly = std::chrono::seconds(5);
+
+void PushValue(CpuDataQueue *queue, int value) {
+  std::vector<DataItemCpu> items;
+  ASSERT_EQ(queue->Reserve({sizeof(int)}, &items, kLongTimeoutInSec), kCpuQueueSuccess);
+  ASSERT_EQ(items.size(), 1);
+  (void)memcpy(items[0].data_ptr_, &value, sizeof(int));
+  ASSERT_EQ(queue->Commit(), kCpuQueueSuccess);
+}
+}  // namespace
+
+// The batches go through the slots in order and the slot memory is reused.
+TEST_F(TestCpuDataQueue, TestFifoAndSlotReuse) {
+  CpuDataQueue queue(kCpuDataQueueCapacity);
+  std::vector<void *> slot_ptrs;
+  for (int i = 0; i < 6; i++) {
+    PushValue(&queue, i);
+    std::vector<DataItemCpu> items;
+    ASSERT_EQ(queue.Front(&items, kLongTimeoutInSec), kCpuQueueSuccess);
+    ASSERT_EQ(items.size(), 1);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(items[0].data_ptr_) % kCpuDataQueueAlign, 0);
+    EXPECT_EQ(*static_cast<int *>(items[0].data_ptr_), i);
+    slot_ptrs.push_back(items[0].data_ptr_);
+    ASSERT_EQ(queue.Pop(), kCpuQueueSuccess);
+  }
+  for (size_t i = kCpuDataQueueCapacity; i < slot_ptrs.size(); i++) {
+    EXPECT_EQ(slot_ptrs[i], slot_ptrs[i - kCpuDataQueueCapacity]);
+  }
+  EXPECT_EQ(queue.Size(), 0);
+}
+
+// A full queue times out, commit without reserve and pop without a front slot are rejected.
+TEST_F(TestCpuDataQueue, TestFullAndErrorInput) {
+  CpuDataQueue queue(kCpuDataQueueCapacity);
+  EXPECT_EQ(queue.Commit(), kCpuQueueErrorInput);
+  EXPECT_EQ(queue.Pop(), kCpuQueueErrorInput);
+  std::vector<DataItemCpu> items;
+  EXPECT_EQ(queue.Reserve({}, &items, 0), kCpuQueueErrorInput);
+  for (size_t i = 0; i < kCpuDataQueueCapacity; i++) {
+    PushValue(&queue, static_cast<int>(i));
+  }
+  EXPECT_EQ(queue.Reserve({sizeof(int)}, &items, 0), kCpuQueueTimeout);
+  EXPECT_EQ(queue.Size(), kCpuDataQueueCapacity);
+}
+
+// The batches produced before the consumer starts, as during the graph compile, wait in the slots and none is lost.
+TEST_F(TestCpuDataQueue, TestBatchesKeptUntilConsumerStarts) {
+  constexpr int kBatchNum = 5;
+  CpuDataQueue queue(kCpuDataQueueCapacity);
+  auto producer = std::async(std::launch::async, [&queue] {
+    for (int i = 0; i < kBatchNum; i++) {
+      PushValue(&queue, i);
+    }
+  });
+  // the producer fills the free slots, then waits for the consumer instead of dropping the next batches
+  EXPECT_EQ(producer.wait_for(std::chrono::milliseconds(100)), std::future_status::timeout);
+  EXPECT_EQ(queue.Size(), kCpuDataQueueCapacity);
+  for (int i = 0; i < kBatchNum; i++) {
+    std::vector<DataItemCpu> items;
+    ASSERT_EQ(queue.Front(&items, kLongTimeoutInSec), kCpuQueueSuccess);
+    EXPECT_EQ(*static_cast<int *>(items[0].data_ptr_), i);
+    ASSERT_EQ(queue.Pop(), kCpuQueueSuccess);
+  }
+  ASSERT_EQ(producer.wait_for(kPromptly), std::future_status::ready);
+  EXPECT_EQ(queue.Size(), 0);
+}
+
+// Stopping the channel as DeviceQueueOp::StopSend does wakes up a producer waiting for a free slot at once.
+TEST_F(TestCpuDataQueue, TestStopWakesBlockedProducer) {
+  const std::string channel = "TestStopWakesBlockedProducer";
+  auto &mgr = CpuDataQueueMgr::GetInstance();
+  auto queue = mgr.Create(channel, kCpuDataQueueCapacity);
+  ASSERT_NE(queue, nullptr);
+  EXPECT_EQ(mgr.Get(channel, 0), queue);
+  for (size_t i = 0; i < kCpuDataQueueCapacity; i++) {
+    PushValue(queue.get(), static_cast<int>(i));
+  }
+  auto blocked = std::async(std::launch::async, [&queue] {
+    std::vector<DataItemCpu> items;
+    return queue->Reserve({sizeof(int)}, &items, kLongTimeoutInSec);
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  mgr.Destroy(channel);
+  ASSERT_EQ(blocked.wait_for(kPromptly), std::future_status::ready);
+  EXPECT_EQ(blocked.get(), kCpuQueueClosed);
+  EXPECT_EQ(mgr.Get(channel, 0), nullptr);
+}
+
+// After eof the consumer still reads the committed batches, then front returns closed instead of waiting.
+TEST_F(TestCpuDataQueue, TestEofDrainsThenCloses) {
+  const std::string channel = "TestEofDrainsThenCloses";
+  auto &mgr = CpuDataQueueMgr::GetInstance();
+  auto queue = mgr.Create(channel, kCpuDataQueueCapacity);
+  PushValue(queue.get(), 7);
+  mgr.Destroy(channel);
+
+  std::vector<DataItemCpu> items;
+  ASSERT_EQ(queue->Front(&items, kLongTimeoutInSec), kCpuQueueSuccess);
+  EXPECT_EQ(*static_cast<int *>(items[0].data_ptr_), 7);
+  ASSERT_EQ(queue->Pop(), kCpuQueueSuccess);
+
+  auto waiting = std::async(std::launch::async, [&queue] {
+    std::vector<DataItemCpu> front_items;
+    return queue->Front(&front_items, kLongTimeoutInSec);
+  });
+  ASSERT_EQ(waiting.wait_for(kPromptly), std::future_status::ready);
+  EXPECT_EQ(waiting.get(), kCpuQueueClosed);
+}
+}  // namespace cpu
+}  // namespace device
+}  // namespace mindspore
@@ -0,0 +1,249 @@
+/**
+ * Copyright 2021 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cmath>
+#include <cstring>
+#include <random>
+#include <vector>
+#include "common/common_test.h"
+#include "ps/compression.h"
+
+namespace mindspore {
+namespace ps {
+class TestCompression : public UT::Common {
+ public:
+  TestCompression() = default;
+  virtual ~TestCompression() = default;
+
+  void SetUp() override {}
+  void TearDown() override {}
+
+  std::vector<float> RandomValues(size_t num) {
+    std::normal_distribution<float> distribution(0, 1);
+    std::vector<float> values(num);
+    for (auto &value : values) {
+      value = distribution(engine_);
+    }
+    return values;
+  }
+
+  std::vector<float> Encode(CompressCodec codec, const std::vector<float> &src, const std::vector<int> &lens,
+                            float *residual, std::vector<int> *encoded_lens) {
+    std::vector<float> encoded(EncodedSize(codec, lens.data(), lens.size(), kDefaultTopKRatio));
+    encoded_lens->resize(lens.size());
+    EncodeValues(codec, src.data(), lens.data(), lens.size(), kDefaultTopKRatio, residual, encoded.data(),
+                 encoded_lens->data());
+    return encoded;
+  }
+
+  std::vector<float> Decode(const std::vector<float> &encoded, std::vector<int> *lens) {
+    size_t segment_num = 0;
+    std::vector<float> decoded(DecodedSize(encoded.data(), encoded.size(), &segment_num));
+    lens->resize(segment_num);
+    DecodeValues(encoded.data(), encoded.size(), decoded.data(), decoded.size(), lens->data());
+    return decoded;
+  }
+
+  std::mt19937 engine_{2021};
+};
+
+TEST_F(TestCompression, HalfRoundTrip) {
+  std::vector<float> src = {0.0f, -0.0f, 1.0f, -2.5f, 65504.0f, 1e-7f, 6.1e-5f, 1e6f, INFINITY, 0.333333f};
+  std::vector<float> expect = {0.0f, -0.0f, 1.0f, -2.5f, 65504.0f, 1.1920929e-7f, 6.0975552e-5f, INFINITY, INFINITY,
+                               0.33325195f};
+  std::vector<uint16_t> half(src.size());
+  std::vector<float> dst(src.size());
+  FloatToHalf(src.data(), src.size(), half.data());
+  HalfToFloat(half.data(), half.size(), dst.data());
+  for (size_t i = 0; i < src.size(); i++) {
+    EXPECT_EQ(dst[i], expect[i]) << "index " << i;
+  }
+  EXPECT_EQ(half[1], 0x8000);
+
+  auto values = RandomValues(1000);
+  half.resize(values.size());
+  dst.resize(values.size());
+  FloatToHalf(values.data(), values.size(), half.data());
+  HalfToFloat(half.data(), half.size(), dst.data());
+  for (size_t i = 0; i < values.size(); i++) {
+    EXPECT_NEAR(dst[i], values[i], std::fabs(values[i]) / 1024);
+  }
+}
+
+TEST_F(TestCompression, Bf16RoundTrip) {
+  auto values = RandomValues(1000);
+  values.push_back(NAN);
+  std::vector<uint16_t> bf16(values.size());
+  std::vector<float> dst(values.size());
+  FloatToBf16(values.data(), values.size(), bf16.data());
+  Bf16ToFloat(bf16.data(), bf16.size(), dst.data());
+  for (size_t i = 0; i + 1 < values.size(); i++) {
+    EXPECT_NEAR(dst[i], values[i], std::fabs(values[i]) / 128);
+  }
+  EXPECT_TRUE(std::isnan(dst.back()));
+}
+
+TEST_F(TestCompression, TopKErrorFeedback) {
+  std::vector<float> src = {0.1f, -5.0f, 0.2f, 3.0f, -0.3f, 0.0f};
+  std::vector<float> residual(src.size(), 0);
+  std::vector<uint32_t> indices(2);
+  std::vector<float> values(2);
+  TopKSparsify(src.data(), src.size(), 2, residual.data(), indices.data(), values.data());
+  EXPECT_EQ(indices, std::vector<uint32_t>({1, 3}));
+  EXPECT_EQ(values, std::vector<float>({-5.0f, 3.0f}));
+  EXPECT_EQ(residual, std::vector<float>({0.1f, 0.0f, 0.2f, 0.0f, -0.3f, 0.0f}));
+
+  // what was not sent is added to the next gradient
+  std::vector<float> next = {0.0f, 0.0f, 0.0f, 0.0f, -0.3f, 0.1f};
+  TopKSparsify(next.data(), next.size(), 2, residual.data(), indices.data(), values.data());
+  EXPECT_EQ(indices, std::vector<uint32_t>({2, 4}));
+  EXPECT_FLOAT_EQ(values[1], -0.6f);
+}
+
+TEST_F(TestCompression, EncodeSegments) {
+  // a scalar segment, such as the learning rate, is not compressed
+  std::vector<int> lens = {1, 4096, 1};
+  auto src = RandomValues(4098);
+  for (auto codec : {kCodecNone, kCodecFp16, kCodecBf16, kCodecTopK}) {
+    std::vector<float> residual(src.size(), 0);
+    std::vector<int> encoded_lens;
+    auto encoded = Encode(codec, src, lens, residual.data(), &encoded_lens);
+    std::vector<int> decoded_lens;
+    auto decoded = Decode(encoded, &decoded_lens);
+    EXPECT_EQ(decoded_lens, lens);
+    ASSERT_EQ(decoded.size(), src.size());
+    EXPECT_EQ(decoded[0], src[0]);
+    EXPECT_EQ(decoded.back(), src.back());
+    if (codec == kCodecTopK) {
+      // the decoded gradient and the residual add up to the gradient
+      for (size_t i = 1; i + 1 < src.size(); i++) {
+        EXPECT_FLOAT_EQ(decoded[i] + residual[i], src[i]);
+      }
+      EXPECT_EQ(encoded_lens[1], 2 + 1 + 2 * 41);
+    } else if (codec != kCodecNone) {
+      EXPECT_EQ(encoded_lens[1], 2 + 2048);
+    }
+  }
+}
+
+// the indices of a sparse gradient are sent exactly, its values with the codec
+TEST_F(TestCompression, EncodeSegmentCodecs) {
+  constexpr size_t kRowNum = 2048;
+  std::vector<int> lens = {1, kRowNum, kRowNum};
+  auto src = RandomValues(1 + 2 * kRowNum);
+  for (size_t i = 0; i < kRowNum; i++) {
+    uint32_t indice = 100000 + i;
+    memcpy(&src[1 + kRowNum + i], &indice, sizeof(indice));
+  }
+  std::vector<CompressCodec> codecs = {kCodecNone, kCodecFp16, kCodecNone};
+  std::vector<float> encoded(EncodedSize(codecs.data(), lens.data(), lens.size(), 0));
+  std::vector<int> encoded_lens(lens.size());
+  EncodeValues(codecs.data(), src.data(), lens.data(), lens.size(), 0, nullptr, encoded.data(), encoded_lens.data());
+  EXPECT_EQ(encoded_lens, std::vector<int>({2 + 1, 2 + kRowNum / 2, 2 + kRowNum}));
+  std::vector<int> decoded_lens;
+  auto decoded = Decode(encoded, &decoded_lens);
+  EXPECT_EQ(decoded_lens, lens);
+  EXPECT_EQ(0, memcmp(&decoded[1 + kRowNum], &src[1 + kRowNum], kRowNum * sizeof(float)));
+  EXPECT_NEAR(decoded[1], src[1], std::fabs(src[1]) / 1024);
+  EXPECT_EQ(CastCodec(kCodecTopK), kCodecNone);
+  EXPECT_EQ(CastCodec(kCodecBf16), kCodecBf16);
+}
+
+// the sender tracks what the receiver decodes, so the weights of the receiver follow the sent ones within the
+// rounding of one delta, and stay exact once they stop moving
+TEST_F(TestCompression, DeltaEncoding) {
+  constexpr size_t kWeightSize = 4096;
+  auto weight = RandomValues(kWeightSize);
+  for (auto &value : weight) {
+    value += 10.0f;
+  }
+  std::vector<float> sender_base(kWeightSize, 0);
+  std::vector<float> receiver_base(kWeightSize, 0);
+  std::vector<float> encoded(DeltaEncodedSize(kCodecFp16, kWeightSize));
+  std::vector<float> decoded(kWeightSize);
+  for (size_t step = 0; step < 10; step++) {
+    for (size_t i = 0; i < kWeightSize; i++) {
+      weight[i] -= 1e-3f * std::sin(static_cast<float>(i + step));
+    }
+    EncodeDelta(kCodecFp16, weight.data(), kWeightSize, sender_base.data(), encoded.data());
+    size_t segment_num = 0;
+    ASSERT_EQ(DecodedSize(encoded.data(), encoded.size(), &segment_num), kWeightSize);
+    DecodeValues(encoded.data(), encoded.size(), decoded.data(), decoded.size(), nullptr, receiver_base.data());
+    receiver_base = decoded;
+    EXPECT_EQ(0, memcmp(sender_base.data(), receiver_base.data(), kWeightSize * sizeof(float)));
+  }
+  // the first delta was the weight in fp16, the later ones are within the fp16 rounding of the small deltas
+  for (size_t i = 0; i < kWeightSize; i++) {
+    EXPECT_NEAR(decoded[i], weight[i], 1e-4) << "index " << i;
+  }
+  for (size_t step = 0; step < 2; step++) {
+    EncodeDelta(kCodecFp16, weight.data(), kWeightSize, sender_base.data(), encoded.data());
+    DecodeValues(encoded.data(), encoded.size(), decoded.data(), decoded.size(), nullptr, receiver_base.data());
+    receiver_base = decoded;
+  }
+  for (size_t i = 0; i < kWeightSize; i++) {
+    EXPECT_NEAR(decoded[i], weight[i], 1e-6) << "index " << i;
+  }
+
+  // a delta has no meaning without the base
+  EXPECT_THROW(DecodeValues(encoded.data(), encoded.size(), decoded.data(), decoded.size()), std::runtime_error);
+}
+
+// segments whose declared lengths do not fit in the encoded values or in the destination are rejected
+TEST_F(TestCompression, DecodeCorruptSegments) {
+  std::vector<int> lens = {1, 4096};
+  auto src = RandomValues(4097);
+  for (auto codec : {kCodecNone, kCodecFp16, kCodecTopK}) {
+    std::vector<float> residual(src.size(), 0);
+    std::vector<int> encoded_lens;
+    auto encoded = Encode(codec, src, lens, residual.data(), &encoded_lens);
+    std::vector<float> dst(src.size());
+    size_t segment_num = 0;
+
+    // truncated in the header and in the payload of the last segment
+    for (size_t size : {encoded.size() - 1, static_cast<size_t>(encoded_lens[0] + 1)}) {
+      EXPECT_THROW(DecodedSize(encoded.data(), size, &segment_num), std::runtime_error) << "codec " << codec;
+      EXPECT_THROW(DecodeValues(encoded.data(), size, dst.data(), dst.size()), std::runtime_error);
+    }
+    // a destination too small for the declared length
+    EXPECT_THROW(DecodeValues(encoded.data(), encoded.size(), dst.data(), dst.size() - 1), std::runtime_error);
+
+    // a length larger than the values that follow
+    auto corrupt = encoded;
+    uint32_t num = 1 << 30;
+    memcpy(&corrupt[encoded_lens[0] + 1], &num, sizeof(num));
+    if (codec != kCodecTopK) {
+      EXPECT_THROW(DecodedSize(corrupt.data(), corrupt.size(), &segment_num), std::runtime_error);
+    }
+    EXPECT_THROW(DecodeValues(corrupt.data(), corrupt.size(), dst.data(), dst.size()), std::runtime_error);
+  }
+
+  std::vector<float> dst(8);
+  size_t segment_num = 0;
+  // an unknown codec
+  std::vector<float> unknown = {0, 0, 1.0f};
+  uint32_t bits[2] = {7, 1};
+  memcpy(unknown.data(), bits, sizeof(bits));
+  EXPECT_THROW(DecodedSize(unknown.data(), unknown.size(), &segment_num), std::runtime_error);
+  // more topk values than the length of the segment
+  std::vector<float> topk(3 + 2 * 4);
+  uint32_t topk_bits[3] = {kCodecTopK, 2, 4};
+  memcpy(topk.data(), topk_bits, sizeof(topk_bits));
+  EXPECT_THROW(DecodedSize(topk.data(), topk.size(), &segment_num), std::runtime_error);
+  EXPECT_THROW(DecodeValues(topk.data(), topk.size(), dst.data(), dst.size()), std::runtime_error);
+}
+}  // namespace ps
+}  // namespace mindspore
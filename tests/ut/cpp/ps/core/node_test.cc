@@ -0,0 +1,108 @@
+/**
+ * Copyright 2021 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "ps/core/node.h"
+#include "common/common_test.h"
+
+#include <event2/buffer.h>
+#include <event2/bufferevent.h>
+#include <event2/event.h>
+
+#include <string>
+#include <vector>
+
+namespace mindspore {
+namespace ps {
+namespace core {
+// A node without the scheduler, only its receive path is used.
+class ReceiveNode : public Node {
+ public:
+  bool Start(const uint32_t &) override { return true; }
+  bool Stop() override { return true; }
+  bool Finish(const uint32_t &) override { return true; }
+
+  using Node::AllocateSendDataSegment;
+  using Node::ProcessSendDataResp;
+  using Node::receive_messages_;
+};
+
+class TestNode : public UT::Common {
+ public:
+  TestNode() = default;
+  virtual ~TestNode() = default;
+
+  // The frame of a response with the data in the message followed by two raw segments.
+  std::vector<unsigned char> ResponseFrame(const CommMessage &message, const std::string &first,
+                                           const std::string &second) {
+    struct event_base *base = event_base_new();
+    struct bufferevent *pair[2];
+    EXPECT_EQ(bufferevent_pair_new(base, BEV_OPT_CLOSE_ON_FREE, pair), 0);
+    EXPECT_EQ(bufferevent_enable(pair[1], EV_READ), 0);
+    TcpMessageWriter writer;
+    writer.Init(pair[0]);
+    writer.SendMessage(message, {{first.data(), first.size()}, {second.data(), second.size()}});
+    (void)event_base_loop(base, EVLOOP_NONBLOCK);
+    struct evbuffer *input = bufferevent_get_input(pair[1]);
+    std::vector<unsigned char> frame(evbuffer_get_length(input));
+    EXPECT_EQ(evbuffer_remove(input, frame.data(), frame.size()), static_cast<int>(frame.size()));
+    writer.Reset();
+    bufferevent_free(pair[0]);
+    bufferevent_free(pair[1]);
+    event_base_free(base);
+    return frame;
+  }
+};
+
+// The segments of a data response are received straight into the response kept for its request.
+TEST_F(TestNode, SendDataSegmentsReceivedIntoResponse) {
+  ReceiveNode node;
+  TcpMessageHandler handler;
+  handler.SetSegmentAllocator([&](const CommMessage &message, size_t, size_t len) -> void * {
+    return node.AllocateSendDataSegment(message, len);
+  });
+  handler.SetCallback([&](const CommMessage &message) {
+    // nothing was appended to the data of the message
+    EXPECT_EQ(message.data(), "meta");
+    node.ProcessSendDataResp(message);
+  });
+
+  CommMessage message;
+  message.mutable_pb_meta()->set_cmd(NodeCommand::SEND_DATA);
+  message.mutable_pb_meta()->set_request_id(3);
+  message.mutable_pb_meta()->set_rank_id(1);
+  message.set_data("meta");
+  std::string payload(100000, 'x');
+  auto frame = ResponseFrame(message, "abc", payload);
+  handler.ReceiveMessage(frame.data(), frame.size());
+
+  ASSERT_EQ(node.receive_messages_.count(3), 1);
+  ASSERT_EQ(node.receive_messages_[3].count(1), 1);
+  const CommMessage &response = node.receive_messages_[3][1];
+  EXPECT_EQ(response.pb_meta().request_id(), 3);
+  EXPECT_EQ(response.data(), "metaabc" + payload);
+}
+
+// The segments of the other commands are left to the message.
+TEST_F(TestNode, OtherSegmentsAppendedToMessage) {
+  ReceiveNode node;
+  CommMessage message;
+  message.mutable_pb_meta()->set_cmd(NodeCommand::HEARTBEAT);
+  EXPECT_EQ(node.AllocateSendDataSegment(message, 10), nullptr);
+  EXPECT_TRUE(node.receive_messages_.empty());
+}
+}  // namespace core
+}  // namespace ps
+}  // namespace mindspore
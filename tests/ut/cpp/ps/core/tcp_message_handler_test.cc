@@ -17,8 +17,15 @@
 #include "ps/core/tcp_message_handler.h"
 #include "common/common_test.h"
 
+#include <event2/buffer.h>
+#include <event2/bufferevent.h>
+#include <event2/event.h>
+
+#include <functional>
 #include <memory>
+#include <string>
 #include <thread>
+#include <vector>
 
 namespace mindspore {
 namespace ps {
@@ -31,6 +38,36 @@ class TestTcpMessageHandler : public UT::Common {
 
   void SetUp() override {}
   void TearDown() override {}
+
+  // The frames written by a TcpMessageWriter to one end of a buffer event pair and read from the other end.
+  std::vector<unsigned char> WriteFrames(const std::function<void(TcpMessageWriter *)> &send) {
+    struct event_base *base = event_base_new();
+    struct bufferevent *pair[2];
+    EXPECT_EQ(bufferevent_pair_new(base, BEV_OPT_CLOSE_ON_FREE, pair), 0);
+    EXPECT_EQ(bufferevent_enable(pair[1], EV_READ), 0);
+    TcpMessageWriter writer;
+    writer.Init(pair[0]);
+    send(&writer);
+    // the coalesced frames are flushed by the event loop
+    (void)event_base_loop(base, EVLOOP_NONBLOCK);
+    struct evbuffer *input = bufferevent_get_input(pair[1]);
+    std::vector<unsigned char> frames(evbuffer_get_length(input));
+    EXPECT_EQ(evbuffer_remove(input, frames.data(), frames.size()), static_cast<int>(frames.size()));
+    writer.Reset();
+    bufferevent_free(pair[0]);
+    bufferevent_free(pair[1]);
+    event_base_free(base);
+    return frames;
+  }
+
+  std::vector<unsigned char> SegmentFrame(const std::string &payload) {
+    return WriteFrames([&](TcpMessageWriter *writer) {
+      CommMessage message;
+      message.set_data("meta");
+      std::string small_segment = "abc";
+      writer->SendMessage(message, {{small_segment.data(), small_segment.size()}, {payload.data(), payload.size()}});
+    });
+  }
 };
 
 TEST_F(TestTcpMessageHandler, 8_Header_1003_Data) {
@@ -158,6 +195,95 @@ TEST_F(TestTcpMessageHandler, 8_Header_4080_Data_8_Header_4080_data) {
 
   handler.ReceiveMessage(result, 4080);
 }
+TEST_F(TestTcpMessageHandler, Segments_Appended_To_Data) {
+  std::string payload(5000, 'x');
+  auto frame = SegmentFrame(payload);
+  for (size_t chunk : {1, 7, 4096, 100000}) {
+    TcpMessageHandler handler;
+    size_t received = 0;
+    handler.SetCallback([&](const CommMessage &message) {
+      EXPECT_EQ(message.data(), "meta" + std::string("abc") + payload);
+      EXPECT_EQ(message.segment_lens_size(), 2);
+      EXPECT_EQ(message.segment_lens(1), payload.size());
+      received++;
+    });
+    for (size_t i = 0; i < frame.size(); i += chunk) {
+      handler.ReceiveMessage(frame.data() + i, std::min(chunk, frame.size() - i));
+    }
+    EXPECT_EQ(received, 1);
+  }
+}
+
+TEST_F(TestTcpMessageHandler, Segment_Allocator) {
+  std::string payload(100000, 'y');
+  auto frame = SegmentFrame(payload);
+  TcpMessageHandler handler;
+  std::string segment_buffer(payload.size(), 0);
+  handler.SetSegmentAllocator([&](const CommMessage &message, size_t index, size_t len) -> void * {
+    EXPECT_EQ(message.segment_lens(index), len);
+    // the first segment is appended to the data
+    return index == 1 ? &segment_buffer[0] : nullptr;
+  });
+  size_t received = 0;
+  handler.SetCallback([&](const CommMessage &message) {
+    EXPECT_EQ(message.data(), "metaabc");
+    received++;
+  });
+
+  struct evbuffer *input = evbuffer_new();
+  size_t half = frame.size() / 2;
+  EXPECT_EQ(evbuffer_add(input, frame.data(), half), 0);
+  handler.ReceiveMessage(input);
+  EXPECT_EQ(received, 0);
+  EXPECT_EQ(evbuffer_get_length(input), 0);
+  EXPECT_EQ(evbuffer_add(input, frame.data() + half, frame.size() - half), 0);
+  handler.ReceiveMessage(input);
+  EXPECT_EQ(received, 1);
+  EXPECT_EQ(segment_buffer, payload);
+  evbuffer_free(input);
+}
+
+TEST_F(TestTcpMessageHandler, Empty_Message) {
+  TcpMessageHandler handler;
+  size_t received = 0;
+  handler.SetCallback([&](const CommMessage &message) {
+    EXPECT_EQ(message.data().size(), 0);
+    received++;
+  });
+  auto frames = WriteFrames([](TcpMessageWriter *writer) {
+    writer->SendMessage(CommMessage());
+    writer->SendMessage(CommMessage());
+  });
+  EXPECT_EQ(frames.size(), 2 * kHeaderLen);
+  handler.ReceiveMessage(frames.data(), frames.size());
+  EXPECT_EQ(received, 2);
+}
+
+TEST_F(TestTcpMessageHandler, Coalesced_Messages_In_Order) {
+  std::string payload(kCoalesceFrameSize, 'z');
+  auto frames = WriteFrames([&](TcpMessageWriter *writer) {
+    for (uint64_t i = 0; i < 1000; ++i) {
+      CommMessage message;
+      message.mutable_pb_meta()->set_request_id(i);
+      if (i % 100 == 99) {
+        // a large message flushes the coalesced ones first
+        writer->SendMessage(message, {{payload.data(), payload.size()}});
+      } else {
+        message.set_data("small");
+        writer->SendMessage(message);
+      }
+    }
+  });
+  TcpMessageHandler handler;
+  uint64_t next_request_id = 0;
+  handler.SetCallback([&](const CommMessage &message) {
+    EXPECT_EQ(message.pb_meta().request_id(), next_request_id);
+    EXPECT_EQ(message.data().size(), next_request_id % 100 == 99 ? payload.size() : 5);
+    next_request_id++;
+  });
+  handler.ReceiveMessage(frames.data(), frames.size());
+  EXPECT_EQ(next_request_id, 1000);
+}
 }  // namespace core
 }  // namespace ps
 }  // namespace mindspore
\ No newline at end of file
@@ -0,0 +1,222 @@
+/**
+ * Copyright 2021 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cmath>
+#include <vector>
+#include "common/common_test.h"
+#include "ps/dynamic_embedding_table.h"
+
+namespace mindspore {
+namespace ps {
+class TestDynamicEmbeddingTable : public UT::Common {
+ public:
+  TestDynamicEmbeddingTable() = default;
+  virtual ~TestDynamicEmbeddingTable() = default;
+
+  void SetUp() override {}
+  void TearDown() override {}
+
+  std::vector<float> Lookup(DynamicEmbeddingTable *table, const std::vector<size_t> &ids) {
+    std::vector<float> output(ids.size() * table->embedding_size());
+    table->Lookup(ids.data(), ids.size(), output.data());
+    return output;
+  }
+
+  static constexpr size_t kEmbeddingSize = 8;
+};
+
+TEST_F(TestDynamicEmbeddingTable, CountMinSketch) {
+  CountMinSketch sketch(1024, 4);
+  for (int64_t id = 0; id < 500; id++) {
+    for (int64_t i = 0; i <= id % 5; i++) {
+      (void)sketch.Add(id);
+    }
+  }
+  // the counts are never underestimated
+  size_t exact = 0;
+  for (int64_t id = 0; id < 500; id++) {
+    auto count = sketch.Estimate(id);
+    EXPECT_GE(count, id % 5 + 1);
+    exact += count == id % 5 + 1;
+  }
+  EXPECT_GT(exact, 450);
+  EXPECT_EQ(sketch.Estimate(100000), 0);
+}
+
+TEST_F(TestDynamicEmbeddingTable, LookupAndUpdate) {
+  DynamicEmbeddingTable table(kEmbeddingSize, DynamicEmbeddingConfig(), DynamicEmbeddingInit());
+  // ids beyond 2^32, more than the initial rows so the table grows
+  std::vector<size_t> ids;
+  for (size_t i = 0; i < 3000; i++) {
+    ids.push_back((i << 33) + 7);
+  }
+  auto initial = Lookup(&table, ids);
+  EXPECT_EQ(table.row_num(), ids.size());
+  EXPECT_NE(initial[0], initial[kEmbeddingSize]);
+  float sum = 0;
+  for (auto value : initial) {
+    sum += value * value;
+  }
+  // random normal with stddev 0.01
+  EXPECT_NEAR(std::sqrt(sum / initial.size()), 0.01, 0.001);
+
+  std::vector<float> values(ids.size() * kEmbeddingSize);
+  for (size_t i = 0; i < values.size(); i++) {
+    values[i] = static_cast<float>(i);
+  }
+  table.Update(ids.data(), ids.size(), values.data());
+  EXPECT_EQ(Lookup(&table, ids), values);
+  auto metrics = table.metrics();
+  EXPECT_EQ(metrics.lookup_ids, 2 * ids.size());
+  EXPECT_EQ(metrics.lookup_hits, ids.size());
+  EXPECT_EQ(metrics.admitted_ids, ids.size());
+  EXPECT_GT(metrics.memory_bytes, ids.size() * kEmbeddingSize * sizeof(float));
+}
+
+TEST_F(TestDynamicEmbeddingTable, Admission) {
+  DynamicEmbeddingConfig config;
+  config.admit_threshold = 3;
+  DynamicEmbeddingInit init;
+  init.random_normal = false;
+  init.value = 0.5;
+  DynamicEmbeddingTable table(kEmbeddingSize, config, init);
+  std::vector<size_t> ids = {1, 2};
+  for (size_t i = 0; i < 2; i++) {
+    EXPECT_EQ(Lookup(&table, ids), std::vector<float>(ids.size() * kEmbeddingSize, 0.5f));
+  }
+  EXPECT_EQ(table.row_num(), 0);
+  // the third lookup admits the ids
+  EXPECT_EQ(Lookup(&table, ids), std::vector<float>(ids.size() * kEmbeddingSize, 0.5f));
+  EXPECT_EQ(table.row_num(), 2);
+  std::vector<float> values(ids.size() * kEmbeddingSize, 1.0f);
+  table.Update(ids.data(), ids.size(), values.data());
+  EXPECT_EQ(Lookup(&table, ids), values);
+  EXPECT_EQ(table.metrics().rejected_ids, 4);
+
+  // the update of an id which is not admitted keeps its values
+  std::vector<size_t> new_id = {3};
+  std::vector<float> new_values(kEmbeddingSize, 2.0f);
+  EXPECT_EQ(Lookup(&table, new_id), std::vector<float>(kEmbeddingSize, 0.5f));
+  table.Update(new_id.data(), new_id.size(), new_values.data());
+  EXPECT_EQ(table.row_num(), 3);
+  EXPECT_EQ(Lookup(&table, new_id), new_values);
+}
+
+// with a threshold of 0 the lookups create no rows, the updates do
+TEST_F(TestDynamicEmbeddingTable, AdmissionByUpdates) {
+  DynamicEmbeddingConfig config;
+  config.admit_threshold = 0;
+  DynamicEmbeddingTable table(kEmbeddingSize, config, DynamicEmbeddingInit());
+  std::vector<size_t> ids = {1, 2};
+  auto initial = Lookup(&table, ids);
+  EXPECT_EQ(Lookup(&table, ids), initial);
+  EXPECT_EQ(table.row_num(), 0);
+  std::vector<float> values(kEmbeddingSize, 1.0f);
+  table.Update(ids.data(), 1, values.data());
+  EXPECT_EQ(table.row_num(), 1);
+  auto rows = Lookup(&table, ids);
+  EXPECT_EQ(std::vector<float>(rows.begin(), rows.begin() + kEmbeddingSize), values);
+  EXPECT_EQ(std::vector<float>(rows.begin() + kEmbeddingSize, rows.end()),
+            std::vector<float>(initial.begin() + kEmbeddingSize, initial.end()));
+  auto metrics = table.metrics();
+  EXPECT_EQ(metrics.lookup_hits, 1);
+  EXPECT_EQ(metrics.rejected_ids, 5);
+  EXPECT_EQ(metrics.admitted_ids, 1);
+}
+
+TEST_F(TestDynamicEmbeddingTable, TtlEviction) {
+  DynamicEmbeddingConfig config;
+  config.ttl = 16;
+  DynamicEmbeddingTable table(kEmbeddingSize, config, DynamicEmbeddingInit());
+  std::vector<size_t> cold_ids = {100, 200};
+  std::vector<size_t> hot_ids = {300};
+  auto cold_rows = Lookup(&table, cold_ids);
+  std::vector<float> values(cold_ids.size() * kEmbeddingSize, 1.0f);
+  table.Update(cold_ids.data(), cold_ids.size(), values.data());
+  for (size_t i = 0; i < 2 * config.ttl; i++) {
+    (void)Lookup(&table, hot_ids);
+  }
+  EXPECT_EQ(table.row_num(), 1);
+  EXPECT_EQ(table.metrics().ttl_evicted_rows, 2);
+  // an evicted id gets its initial row back
+  EXPECT_EQ(Lookup(&table, cold_ids), cold_rows);
+}
+
+// A row lives ttl lookups after its last use exactly, a use of the row in between restarts its ttl.
+TEST_F(TestDynamicEmbeddingTable, TtlEvictionOrder) {
+  DynamicEmbeddingConfig config;
+  config.ttl = 4;
+  DynamicEmbeddingTable table(kEmbeddingSize, config, DynamicEmbeddingInit());
+  (void)Lookup(&table, {1, 2, 3});
+  (void)Lookup(&table, {4});
+  std::vector<size_t> id = {2};
+  std::vector<float> values(kEmbeddingSize, 1.0f);
+  table.Update(id.data(), id.size(), values.data());
+  for (size_t i = 0; i < config.ttl - 1; i++) {
+    (void)Lookup(&table, {5});
+  }
+  // the rows of 1 and 3 are ttl lookups old and kept, the updated row of 2 is as old as the row of 4
+  EXPECT_EQ(table.row_num(), 5);
+  (void)Lookup(&table, {5});
+  EXPECT_EQ(table.row_num(), 3);
+  EXPECT_EQ(table.metrics().ttl_evicted_rows, 2);
+  (void)Lookup(&table, {5});
+  EXPECT_EQ(table.row_num(), 1);
+  EXPECT_EQ(table.metrics().ttl_evicted_rows, 4);
+  // the freed rows are reused and ordered again
+  (void)Lookup(&table, {1, 2});
+  for (size_t i = 0; i < config.ttl + 1; i++) {
+    (void)Lookup(&table, {2});
+  }
+  EXPECT_EQ(table.row_num(), 1);
+  EXPECT_EQ(table.metrics().ttl_evicted_rows, 6);
+}
+
+TEST_F(TestDynamicEmbeddingTable, LfuEviction) {
+  DynamicEmbeddingConfig config;
+  config.max_rows = 64;
+  DynamicEmbeddingTable table(kEmbeddingSize, config, DynamicEmbeddingInit());
+  std::vector<size_t> hot_ids;
+  for (size_t id = 0; id < 32; id++) {
+    hot_ids.push_back(id);
+  }
+  for (size_t i = 0; i < 10; i++) {
+    (void)Lookup(&table, hot_ids);
+  }
+  for (size_t id = 1000; id < 2000; id++) {
+    (void)Lookup(&table, {id});
+  }
+  EXPECT_LE(table.row_num(), config.max_rows);
+  EXPECT_GT(table.metrics().lfu_evicted_rows, 0);
+  (void)Lookup(&table, hot_ids);
+  EXPECT_EQ(table.metrics().lookup_hits, 9 * hot_ids.size() + hot_ids.size());
+}
+
+TEST_F(TestDynamicEmbeddingTable, ToDense) {
+  DynamicEmbeddingTable table(kEmbeddingSize, DynamicEmbeddingConfig(), DynamicEmbeddingInit());
+  std::vector<size_t> ids = {3, 12, 1000};
+  std::vector<float> values(ids.size() * kEmbeddingSize, 2.0f);
+  table.Update(ids.data(), ids.size(), values.data());
+  std::vector<float> dense(10 * kEmbeddingSize);
+  table.ToDense(5, 15, dense.data());
+  EXPECT_EQ(dense[(12 - 5) * kEmbeddingSize], 2.0f);
+  EXPECT_NE(dense[0], 2.0f);
+  std::vector<size_t> missing_id = {5};
+  EXPECT_EQ(Lookup(&table, missing_id), std::vector<float>(dense.begin(), dense.begin() + kEmbeddingSize));
+}
+
+}  // namespace ps
+}  // namespace mindspore
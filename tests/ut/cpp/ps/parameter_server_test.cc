@@ -0,0 +1,411 @@
+/**
+ * Copyright 2021 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "common/common_test.h"
+#define private public
+#include "ps/parameter_server.h"
+#undef private
+
+namespace mindspore {
+namespace ps {
+namespace {
+using Server = ParameterServer<float>;
+constexpr size_t kWorkerNum = 2;
+constexpr size_t kKeyNum = 2;
+constexpr size_t kWeightSize = 4;
+constexpr float kLearningRateValue = 0.1f;
+constexpr float kMomentumValue = 0.0f;
+}  // namespace
+
+// The consistency checks of the servers, driven step by step on one thread. The pushes and the updates are the
+// ones the request handlers and the update thread run.
+class TestParameterServer : public UT::Common {
+ public:
+  TestParameterServer() = default;
+  virtual ~TestParameterServer() = default;
+
+  void SetUp() override {}
+  void TearDown() override { server_.reset(); }
+
+  void InitServer(const std::string &consistency_mode, uint64_t staleness_threshold) {
+    server_.reset(new Server());
+    server_->pserver_num_ = 1;
+    server_->worker_num_ = kWorkerNum;
+    server_->sync_mode_ = consistency_mode == kConsistencySync;
+    server_->staleness_threshold_ = consistency_mode == kConsistencySSP ? staleness_threshold : UINT64_MAX;
+    server_->InitOptimInfoBuilders();
+    for (Key key = 0; key < kKeyNum; key++) {
+      AddKey(key, kWeightSize);
+    }
+  }
+
+  void AddKey(Key key, size_t weight_size) {
+    server_->InitWeight(key, std::make_shared<Weight>(weight_size, 1.0f));
+    server_->InitGrad(key, std::make_shared<Grad>(weight_size, 0.0f));
+    // the init requests build the optimizers from the func graph of the server
+    server_->weight_key_to_optims_[key] = kApplyMomentum;
+    server_->optimizers_[key] = std::make_shared<kernel::ps::ApplyMomentumPSKernel>(0, 1, kWorkerNum);
+    server_->optim_inputs_shape_[key] = std::make_shared<InputsShape>();
+  }
+
+  // a request of sender run by the handler of the server
+  ::ps::KVPairs<float> Request(bool push, int sender, const ::ps::KVPairs<float> &req, int cmd = 0) {
+    ::ps::KVMeta meta;
+    meta.cmd = cmd;
+    meta.push = push;
+    meta.sender = sender;
+    meta.timestamp = 0;
+    meta.customer_id = 0;
+    Server::ServerHandler handler(server_.get());
+    handler.Init();
+    ::ps::KVPairs<float> res;
+    handler.Handle(meta, req, &res);
+    return res;
+  }
+
+  // a push of a gradient of 1.0 from sender, as HandlePushReq passes it on
+  void Push(Key key, int sender) {
+    Keys keys = {key};
+    Values values(kWeightSize + 2, 1.0f);
+    values[0] = kLearningRateValue;
+    values[kWeightSize + 1] = kMomentumValue;
+    Lengths lengths = {1, static_cast<int>(kWeightSize), 1};
+    server_->AccumGrad(keys, values, lengths, sender);
+  }
+
+  // what the update thread does once ReadyForUpdateWeights holds
+  void UpdateWeights() {
+    {
+      std::unique_lock<std::mutex> round_lock(server_->round_mutex_);
+      ASSERT_TRUE(server_->ReadyForUpdateWeights());
+    }
+    for (Key key = 0; key < kKeyNum; key++) {
+      server_->UpdateWeight(key);
+    }
+    server_->ResetGradAccumCount();
+  }
+
+  std::unique_ptr<Server> server_;
+};
+
+// a key is pushed by every worker, then updated once, then pulled by every worker before the next push
+TEST_F(TestParameterServer, SyncMode) {
+  InitServer(kConsistencySync, 0);
+  for (Key key = 0; key < kKeyNum; key++) {
+    EXPECT_TRUE(server_->ReadyForPush(key));
+    EXPECT_FALSE(server_->ReadyForPull(key, 0));
+  }
+  for (int sender = 0; sender < static_cast<int>(kWorkerNum); sender++) {
+    Push(0, sender);
+  }
+  // the other key still waits for its gradients
+  {
+    std::unique_lock<std::mutex> round_lock(server_->round_mutex_);
+    EXPECT_FALSE(server_->ReadyForUpdateWeights());
+  }
+  EXPECT_FALSE(server_->ReadyForPull(0, 0));
+  for (int sender = 0; sender < static_cast<int>(kWorkerNum); sender++) {
+    Push(1, sender);
+  }
+  // every key has the gradients of the round, no push before the update
+  EXPECT_FALSE(server_->ReadyForPush(0));
+  EXPECT_FALSE(server_->ReadyForPush(1));
+  EXPECT_EQ(server_->versions_.at(0), 0);
+
+  UpdateWeights();
+  EXPECT_EQ(server_->versions_.at(0), 1);
+  // the mean gradient of 1.0 once
+  EXPECT_FLOAT_EQ((*server_->weights_.at(0))[0], 1.0f - kLearningRateValue);
+  EXPECT_TRUE(server_->ReadyForPull(0, 0));
+  EXPECT_FALSE(server_->ReadyForPush(0));
+  server_->weight(0);
+  EXPECT_TRUE(server_->ReadyForPull(0, 1));
+  EXPECT_FALSE(server_->ReadyForPush(0));
+  server_->weight(0);
+  // every worker pulled the key, the next round may push it
+  EXPECT_FALSE(server_->ReadyForPull(0, 0));
+  EXPECT_TRUE(server_->ReadyForPush(0));
+  EXPECT_FALSE(server_->ReadyForPush(1));
+}
+
+// a worker may pull while it is at most staleness_threshold pushes ahead of the slowest worker on the key
+TEST_F(TestParameterServer, SspMode) {
+  InitServer(kConsistencySSP, 1);
+  EXPECT_TRUE(server_->ReadyForPull(0, 0));
+  EXPECT_TRUE(server_->ReadyForPull(0, 1));
+  Push(0, 0);
+  // worker 1 has not pushed, the slowest clock is 0
+  EXPECT_EQ(server_->worker_clocks_.at(0).at(0), 1);
+  EXPECT_TRUE(server_->ReadyForPull(0, 0));
+  Push(0, 0);
+  EXPECT_FALSE(server_->ReadyForPull(0, 0));
+  EXPECT_TRUE(server_->ReadyForPull(0, 1));
+  // the clocks are per key
+  EXPECT_TRUE(server_->ReadyForPull(1, 0));
+  // pushes are never held back, the gradient is applied as it comes
+  EXPECT_TRUE(server_->ReadyForPush(0));
+  EXPECT_EQ(server_->versions_.at(0), 2);
+  Push(0, 1);
+  EXPECT_TRUE(server_->ReadyForPull(0, 0));
+  Push(0, 0);
+  EXPECT_FALSE(server_->ReadyForPull(0, 0));
+  Push(0, 1);
+  EXPECT_TRUE(server_->ReadyForPull(0, 0));
+  EXPECT_EQ(server_->versions_.at(0), 5);
+  EXPECT_EQ(server_->versions_.at(1), 0);
+}
+
+// a threshold of 0 is lockstep, a worker pulls only when no worker is behind it
+TEST_F(TestParameterServer, SspModeZeroThreshold) {
+  InitServer(kConsistencySSP, 0);
+  Push(0, 0);
+  EXPECT_FALSE(server_->ReadyForPull(0, 0));
+  EXPECT_TRUE(server_->ReadyForPull(0, 1));
+  Push(0, 1);
+  EXPECT_TRUE(server_->ReadyForPull(0, 0));
+  EXPECT_TRUE(server_->ReadyForPull(0, 1));
+}
+
+// nothing waits, every gradient divided by the worker number is applied as it comes
+TEST_F(TestParameterServer, AsyncMode) {
+  InitServer(kConsistencyAsync, 0);
+  for (int i = 0; i < 5; i++) {
+    Push(0, 0);
+    EXPECT_TRUE(server_->ReadyForPush(0));
+    EXPECT_TRUE(server_->ReadyForPull(0, 0));
+    EXPECT_TRUE(server_->ReadyForPull(0, 1));
+  }
+  EXPECT_EQ(server_->versions_.at(0), 5);
+  EXPECT_FLOAT_EQ((*server_->weights_.at(0))[0], 1.0f - 5 * kLearningRateValue / kWorkerNum);
+  // the pulls take no tokens
+  server_->weight(0);
+  EXPECT_TRUE(server_->ReadyForPull(0, 0));
+  EXPECT_EQ(server_->tokens_.at(0), 0);
+}
+
+// the pushes of a key with a codec are decoded, its pulls are deltas between the snapshots of the weights shared by
+// the workers
+TEST_F(TestParameterServer, CompressedPushPull) {
+  InitServer(kConsistencyAsync, 0);
+  constexpr size_t kLargeSize = 2 * kMinCompressSize;
+  constexpr Key kKey = kKeyNum;
+  AddKey(kKey, kLargeSize);
+  server_->key_codecs_[kKey] = kCodecFp16;
+
+  ::ps::KVPairs<float> push;
+  push.keys.push_back(kKey);
+  std::vector<float> push_vals(kLargeSize + 2, 0.5f);
+  push_vals[0] = kLearningRateValue;
+  push_vals[kLargeSize + 1] = kMomentumValue;
+  std::vector<int> push_lens = {1, static_cast<int>(kLargeSize), 1};
+  push.vals = Values(EncodedSize(kCodecFp16, push_lens.data(), push_lens.size(), 0), 0);
+  push.lens = Lengths(push_lens.size(), 0);
+  EncodeValues(kCodecFp16, push_vals.data(), push_lens.data(), push_lens.size(), 0, nullptr, push.vals.data(),
+               push.lens.data());
+  Request(true, 0, push);
+  auto &weight = *server_->weights_.at(kKey);
+  EXPECT_FLOAT_EQ(weight[0], 1.0f - 0.5f * kLearningRateValue / kWorkerNum);
+
+  // what a worker holds, and its pull, which decodes the response as the worker does
+  struct PullState {
+    uint32_t snapshot_id = 0;
+    std::vector<float> weight;
+  };
+  auto pull = [&](int sender, PullState *state) {
+    ::ps::KVPairs<float> req;
+    req.keys.push_back(kKey);
+    req.vals.push_back(static_cast<float>(state->snapshot_id));
+    req.lens.push_back(1);
+    auto res = Request(false, sender, req);
+    EXPECT_FALSE(res.vals.empty());
+    state->snapshot_id = static_cast<uint32_t>(res.vals[0]);
+    if (res.vals.size() > 1) {
+      state->weight.resize(kLargeSize, 0);
+      std::vector<float> decoded(kLargeSize);
+      DecodeValues(res.vals.data() + 1, res.vals.size() - 1, decoded.data(), decoded.size(), nullptr,
+                   state->weight.data());
+      state->weight = decoded;
+    }
+    return res.vals.size();
+  };
+  PullState first;
+  PullState second;
+  const auto &snapshot = server_->pull_snapshots_.at(kKey);
+  for (size_t step = 0; step < 3; step++) {
+    // steps smaller than the fp16 precision of the weights
+    for (size_t i = 0; i < kLargeSize; i++) {
+      weight[i] += 1e-4f * (i % 7);
+    }
+    server_->versions_.at(kKey)++;
+    EXPECT_LT(pull(0, &first), kLargeSize);
+    EXPECT_EQ(first.snapshot_id, snapshot.id);
+    EXPECT_EQ(0, memcmp(first.weight.data(), snapshot.values.data(), kLargeSize * sizeof(float)));
+  }
+  for (size_t i = 0; i < kLargeSize; i++) {
+    EXPECT_NEAR(first.weight[i], weight[i], 1e-6) << "index " << i;
+  }
+  // the weights did not change, the pull has the snapshot id only
+  EXPECT_EQ(pull(0, &first), 1);
+
+  // the other worker holds no snapshot yet, it is sent the current one whole
+  EXPECT_GT(pull(1, &second), kLargeSize);
+  EXPECT_EQ(second.weight, first.weight);
+
+  // after an update both workers hold the previous snapshot and are sent the same delta
+  for (size_t i = 0; i < kLargeSize; i++) {
+    weight[i] -= 2e-4f;
+  }
+  server_->versions_.at(kKey)++;
+  size_t first_size = pull(0, &first);
+  EXPECT_LT(first_size, kLargeSize);
+  EXPECT_EQ(pull(1, &second), first_size);
+  EXPECT_EQ(second.weight, first.weight);
+  EXPECT_EQ(0, memcmp(first.weight.data(), snapshot.values.data(), kLargeSize * sizeof(float)));
+  // a pull without a snapshot id is sent the weights whole
+  ::ps::KVPairs<float> whole_pull;
+  whole_pull.keys.push_back(kKey);
+  auto res = Request(false, 0, whole_pull);
+  EXPECT_EQ(std::vector<float>(res.vals.begin(), res.vals.end()), std::vector<float>(weight.begin(), weight.end()));
+}
+
+// the rows of a table of the ps cache with a codec are swapped in cast and swapped out as their deltas against the
+// rows swapped in, the rows of the server keep their precision
+TEST_F(TestParameterServer, CompressedEmbeddingRows) {
+  InitServer(kConsistencySync, 0);
+  server_->dynamic_embedding_ = true;
+  PsDataPrefetch::GetInstance().set_cache_enable(true);
+  constexpr Key kTableKey = kKeyNum;
+  constexpr size_t kVocabSize = 100;
+  constexpr size_t kEmbeddingSize = kMinCompressSize;
+  auto shapes = std::make_shared<std::vector<std::shared_ptr<std::vector<size_t>>>>();
+  shapes->push_back(std::make_shared<std::vector<size_t>>(std::vector<size_t>{kVocabSize, kEmbeddingSize}));
+  shapes->push_back(std::make_shared<std::vector<size_t>>(std::vector<size_t>{2}));
+  shapes->push_back(std::make_shared<std::vector<size_t>>(std::vector<size_t>{2, kEmbeddingSize}));
+  ParamInitInfo param_init_info;
+  param_init_info.param_type_ = kAccumulation;
+  param_init_info.init_val_ = 1.0001f;
+  server_->InitEmbeddingTable(kTableKey, shapes, param_init_info);
+  PsDataPrefetch::GetInstance().set_cache_enable(false);
+  server_->key_codecs_[kTableKey] = kCodecFp16;
+
+  ::ps::KVPairs<float> lookup;
+  lookup.keys = {kTableKey, 3, 7};
+  auto res = Request(true, 0, lookup, kEmbeddingLookupCmd);
+  EXPECT_LT(res.vals.size(), 2 * kEmbeddingSize);
+  std::vector<float> swap_in(2 * kEmbeddingSize);
+  DecodeValues(res.vals.data(), res.vals.size(), swap_in.data(), swap_in.size());
+  EXPECT_EQ(swap_in[0], 1.0f);
+
+  // the worker trains the rows and swaps them out
+  std::vector<float> trained(swap_in.size());
+  for (size_t i = 0; i < trained.size(); i++) {
+    trained[i] = swap_in[i] + 0.01f;
+  }
+  ::ps::KVPairs<float> update;
+  update.keys = {kTableKey, 3, 7};
+  update.vals = Values(DeltaEncodedSize(kCodecFp16, trained.size()), 0);
+  EncodeDelta(kCodecFp16, trained.data(), trained.size(), swap_in.data(), update.vals.data());
+  Request(true, 0, update, kUpdateEmbeddingsCmd);
+  // a row swapped out whole overwrites the row of the server
+  update.keys = {kTableKey, 9};
+  int len = static_cast<int>(kEmbeddingSize);
+  int encoded_len = 0;
+  update.vals = Values(EncodedSize(kCodecFp16, &len, 1, 0), 0);
+  EncodeValues(kCodecFp16, trained.data(), &len, 1, 0, nullptr, update.vals.data(), &encoded_len);
+  Request(true, 0, update, kUpdateEmbeddingsCmd);
+  // reading the rows to add the deltas to is not a lookup
+  auto table = server_->dynamic_tables_.at(kTableKey);
+  EXPECT_EQ(table->metrics().lookup_ids, 2);
+
+  LookupIds lookup_ids = {3, 7, 9};
+  std::vector<float> rows(3 * kEmbeddingSize);
+  table->Read(lookup_ids.data(), lookup_ids.size(), rows.data());
+  for (size_t i = 0; i < 2 * kEmbeddingSize; i++) {
+    EXPECT_NEAR(rows[i], 1.0101f, 1e-5) << "index " << i;
+  }
+  EXPECT_NEAR(rows[2 * kEmbeddingSize], trained[0], 1e-3);
+  // truncated deltas are rejected
+  update.keys = {kTableKey, 3, 7};
+  update.vals = Values(DeltaEncodedSize(kCodecFp16, kEmbeddingSize), 0);
+  EncodeDelta(kCodecFp16, trained.data(), kEmbeddingSize, swap_in.data(), update.vals.data());
+  EXPECT_THROW(Request(true, 0, update, kUpdateEmbeddingsCmd), std::runtime_error);
+}
+
+// the table of a ps cache key is a dynamic table, its rows are created by the pushes of the workers
+TEST_F(TestParameterServer, DynamicEmbeddingTable) {
+  InitServer(kConsistencySync, 0);
+  server_->dynamic_embedding_ = true;
+  PsDataPrefetch::GetInstance().set_cache_enable(true);
+  constexpr Key kTableKey = kKeyNum;
+  constexpr size_t kVocabSize = 100;
+  constexpr size_t kEmbeddingSize = 4;
+  auto shapes = std::make_shared<std::vector<std::shared_ptr<std::vector<size_t>>>>();
+  shapes->push_back(std::make_shared<std::vector<size_t>>(std::vector<size_t>{kVocabSize, kEmbeddingSize}));
+  shapes->push_back(std::make_shared<std::vector<size_t>>(std::vector<size_t>{2}));
+  shapes->push_back(std::make_shared<std::vector<size_t>>(std::vector<size_t>{2, kEmbeddingSize}));
+  ParamInitInfo param_init_info;
+  param_init_info.param_type_ = kAccumulation;
+  param_init_info.init_val_ = 0.5f;
+  server_->InitEmbeddingTable(kTableKey, shapes, param_init_info);
+  PsDataPrefetch::GetInstance().set_cache_enable(false);
+  ASSERT_EQ(server_->dynamic_tables_.count(kTableKey), 1);
+  auto table = server_->dynamic_tables_.at(kTableKey);
+  EXPECT_TRUE(server_->weights_.at(kTableKey)->empty());
+
+  // a lookup reads the initial rows and creates none
+  LookupIds lookup_ids = {3, 7};
+  ::ps::KVPairs<float> res;
+  server_->DoEmbeddingLookup(kTableKey, lookup_ids, &res);
+  EXPECT_EQ(std::vector<float>(res.vals.begin(), res.vals.end()), std::vector<float>(2 * kEmbeddingSize, 0.5f));
+  ASSERT_EQ(res.lens.size(), 1);
+  EXPECT_EQ(res.lens[0], 2 * kEmbeddingSize);
+  EXPECT_EQ(table->row_num(), 0);
+
+  LookupIds update_ids = {7};
+  server_->UpdateEmbeddings(kTableKey, update_ids, Values(kEmbeddingSize, 2.0f));
+  EXPECT_EQ(table->row_num(), 1);
+  EXPECT_THROW(server_->UpdateEmbeddings(kTableKey, update_ids, Values(kEmbeddingSize + 1, 2.0f)),
+               std::runtime_error);
+  ::ps::KVPairs<float> updated_res;
+  server_->DoEmbeddingLookup(kTableKey, lookup_ids, &updated_res);
+  std::vector<float> expected_rows(kEmbeddingSize, 0.5f);
+  expected_rows.resize(2 * kEmbeddingSize, 2.0f);
+  EXPECT_EQ(std::vector<float>(updated_res.vals.begin(), updated_res.vals.end()), expected_rows);
+  auto metrics = server_->EmbeddingMetrics();
+  ASSERT_EQ(metrics.count(kTableKey), 1);
+  EXPECT_EQ(metrics.at(kTableKey).row_num, 1);
+  EXPECT_EQ(metrics.at(kTableKey).lookup_ids, 4);
+  EXPECT_EQ(metrics.at(kTableKey).lookup_hits, 1);
+
+  // the dense table written back to the parameter holds the pushed rows and the initial ones
+  auto param = std::make_shared<Parameter>(std::make_shared<mindspore::FuncGraph>());
+  param->set_default_param(std::make_shared<tensor::Tensor>(kNumberTypeFloat32, std::vector<int64_t>{1}));
+  server_->embedding_tables_[kTableKey] = param;
+  server_->SyncEmbeddingTables();
+  auto tensor = param->default_param()->cast<tensor::TensorPtr>();
+  ASSERT_EQ(static_cast<size_t>(tensor->data().nbytes()), kVocabSize * kEmbeddingSize * sizeof(float));
+  auto dense = reinterpret_cast<float *>(tensor->data_c());
+  for (size_t id = 0; id < kVocabSize; id++) {
+    EXPECT_EQ(dense[id * kEmbeddingSize], id == 7 ? 2.0f : 0.5f) << "id " << id;
+  }
+}
+}  // namespace ps
+}  // namespace mindspore
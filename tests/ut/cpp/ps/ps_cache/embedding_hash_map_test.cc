@@ -0,0 +1,114 @@
+/**
+ * Copyright 2021 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <random>
+#include <unordered_map>
+#include <vector>
+#include "common/common_test.h"
+#include "ps/ps_cache/embedding_hash_map.h"
+
+namespace mindspore {
+namespace ps {
+class TestEmbeddingHashMap : public UT::Common {
+ public:
+  TestEmbeddingHashMap() = default;
+  virtual ~TestEmbeddingHashMap() = default;
+
+  void SetUp() override {}
+  void TearDown() override {}
+
+  std::vector<int64_t> RandomIds(size_t num, int64_t max_id) {
+    std::uniform_int_distribution<int64_t> distribution(0, max_id);
+    std::vector<int64_t> ids(num);
+    for (auto &id : ids) {
+      id = distribution(engine_);
+    }
+    return ids;
+  }
+
+  std::mt19937_64 engine_{2021};
+};
+
+TEST_F(TestEmbeddingHashMap, IdIndexMap) {
+  constexpr size_t kMaxSize = 1000;
+  IdIndexMap map(kMaxSize);
+  std::unordered_map<int64_t, int> expect;
+  // ids beyond 2^31 and negative ids
+  auto ids = RandomIds(20 * kMaxSize, (1LL << 40));
+  ids[0] = -1;
+  ids[1] = (1LL << 62) + 7;
+  for (size_t i = 0; i < ids.size(); i++) {
+    auto id = ids[i];
+    if (expect.count(id) == 0 && expect.size() < kMaxSize) {
+      map.Insert(id, static_cast<int>(i));
+      expect[id] = static_cast<int>(i);
+    }
+    // erase an earlier id to move the remaining keys of its probe back
+    auto erased = ids[i / 2];
+    if (i % 3 == 0 && expect.count(erased) != 0) {
+      map.Erase(erased);
+      (void)expect.erase(erased);
+    }
+    ASSERT_EQ(map.size(), expect.size());
+  }
+  for (auto id : ids) {
+    auto iter = expect.find(id);
+    EXPECT_EQ(map.Find(id), iter == expect.end() ? INVALID_INDEX_VALUE : iter->second) << "id " << id;
+  }
+  size_t count = 0;
+  map.ForEach([&expect, &count](int64_t id, int index) {
+    EXPECT_EQ(expect[id], index);
+    count++;
+  });
+  EXPECT_EQ(count, expect.size());
+  map.Clear();
+  EXPECT_EQ(map.size(), 0);
+  EXPECT_EQ(map.Find(ids[0]), INVALID_INDEX_VALUE);
+}
+
+TEST_F(TestEmbeddingHashMap, ParseData) {
+  constexpr size_t kCapacity = 100;
+  // ids beyond 2^31
+  constexpr int64_t kIdBase = (1LL << 40) + 1;
+  EmbeddingHashMap hash_map(0, kCapacity);
+  std::vector<int> swap_out_index(kCapacity);
+  std::vector<int64_t> swap_out_ids(kCapacity);
+  size_t swap_out_size = 0;
+  // fill every slot at step 1
+  for (int64_t id = kIdBase; id < kIdBase + static_cast<int64_t>(kCapacity); id++) {
+    auto index = hash_map.ParseData(id, swap_out_index.data(), swap_out_ids.data(), 1, 0, &swap_out_size);
+    ASSERT_NE(index, INVALID_INDEX_VALUE);
+    EXPECT_EQ(hash_map.GetIndex(id), index);
+  }
+  EXPECT_EQ(swap_out_size, 0);
+  // nothing is expired while the graph runs step 0
+  EXPECT_EQ(hash_map.ParseData(-5, swap_out_index.data(), swap_out_ids.data(), 2, 0, &swap_out_size),
+            INVALID_INDEX_VALUE);
+  EXPECT_EQ(swap_out_size, 0);
+  // the graph has run step 1, the new id swaps an expired one out
+  auto index = hash_map.ParseData(-5, swap_out_index.data(), swap_out_ids.data(), 2, 2, &swap_out_size);
+  ASSERT_NE(index, INVALID_INDEX_VALUE);
+  EXPECT_EQ(hash_map.GetIndex(-5), index);
+  EXPECT_EQ(hash_map.hash_step(index), 2);
+  ASSERT_EQ(swap_out_size, 1);
+  EXPECT_EQ(swap_out_index[0], index);
+  // the whole id is swapped out
+  EXPECT_GE(swap_out_ids[0], kIdBase);
+  EXPECT_LT(swap_out_ids[0], kIdBase + static_cast<int64_t>(kCapacity));
+  EXPECT_EQ(hash_map.GetIndex(swap_out_ids[0]), INVALID_INDEX_VALUE);
+}
+}  // namespace ps
+}  // namespace mindspore
@@ -0,0 +1,315 @@
+/**
+ * Copyright 2021 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <climits>
+#include <map>
+#include <memory>
+#include <random>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "common/common_test.h"
+#include "utils/ms_context.h"
+#define private public
+#include "ps/ps_cache/ps_cache_manager.h"
+#undef private
+
+namespace mindspore {
+namespace ps {
+// The servers behind a stub worker, the row of an id is filled with the id until the id is updated.
+class StubPsCacheWorker : public PsCacheWorker {
+ public:
+  explicit StubPsCacheWorker(size_t embedding_size) : embedding_size_(embedding_size) {}
+  ~StubPsCacheWorker() override = default;
+  void Start() override { started_ = true; }
+  size_t worker_num() const override { return 1; }
+  size_t rank_id() const override { return 0; }
+  size_t SetParamKey(const std::string &param_name) override {
+    return keys_.emplace(param_name, keys_.size()).first->second;
+  }
+  size_t GetParamKey(const std::string &param_name) override { return keys_.at(param_name); }
+  void AddEmbeddingTable(size_t key, size_t row_count) override { row_counts_[key] = row_count; }
+  void InitEmbeddingTable(const std::vector<size_t> &keys, const std::vector<float> &,
+                          const std::vector<int64_t> &) override {
+    init_keys_.push_back(keys.at(0));
+  }
+  void EmbeddingLookup(size_t key, const ::ps::SArray<int> &lookup_ids, const ::ps::SArray<int> &,
+                       ::ps::SArray<float> *lookup_result) override {
+    const auto &rows = rows_[key];
+    for (size_t i = 0; i < lookup_ids.size(); i++) {
+      auto iter = rows.find(lookup_ids[i]);
+      for (size_t j = 0; j < embedding_size_; j++) {
+        (*lookup_result)[i * embedding_size_ + j] = iter == rows.end() ? lookup_ids[i] : iter->second[j];
+      }
+    }
+    lookup_count_ += lookup_ids.size();
+  }
+  void UpdateEmbeddingTable(size_t key, const ::ps::SArray<int> &lookup_ids,
+                            const ::ps::SArray<float> &values) override {
+    ASSERT_EQ(values.size(), lookup_ids.size() * embedding_size_);
+    for (size_t i = 0; i < lookup_ids.size(); i++) {
+      auto row = values.begin() + i * embedding_size_;
+      rows_[key][lookup_ids[i]].assign(row, row + embedding_size_);
+    }
+    update_count_ += lookup_ids.size();
+  }
+
+  size_t embedding_size_;
+  bool started_{false};
+  std::map<std::string, size_t> keys_;
+  std::map<size_t, size_t> row_counts_;
+  std::vector<size_t> init_keys_;
+  std::map<size_t, std::map<int, std::vector<float>>> rows_;
+  size_t lookup_count_{0};
+  size_t update_count_{0};
+};
+
+class TestPsCacheManager : public UT::Common {
+ public:
+  TestPsCacheManager() = default;
+  virtual ~TestPsCacheManager() = default;
+
+  void SetUp() override {}
+  void TearDown() override { manager_.reset(); }
+
+  // A cache of the ids [0, vocab_size) without the worker, the hash maps and the swap buffers are set as Initialize
+  // sets them.
+  void InitManager(size_t batch_elements, size_t cache_vocab_size, size_t vocab_size) {
+    manager_.reset(new PsCacheManager());
+    manager_->batch_elements_ = batch_elements;
+    manager_->vocab_size_ = vocab_size;
+    manager_->cache_vocab_size_ = cache_vocab_size;
+    manager_->host_cache_vocab_size_ = cache_vocab_size * kHostCacheScaleFactor;
+    manager_->range_bound_ = {0, vocab_size};
+    manager_->embedding_device_cache_ = std::make_shared<EmbeddingDeviceCache>(batch_elements, cache_vocab_size);
+    manager_->embedding_host_cache_ =
+      std::make_shared<EmbeddingHostCache>(batch_elements, manager_->host_cache_vocab_size_);
+  }
+
+  // Parse the ids of the next data step as ProcessData does, while the graph runs the previous step.
+  std::vector<int> Parse(const std::vector<int> &batch_ids) {
+    manager_->graph_step_ = manager_->data_step_;
+    manager_->IncreaseStep();
+    manager_->statistics_info_ = PsCacheStatisticsInfo();
+    std::vector<int> hash_index(batch_ids.size());
+    manager_->ParseData(batch_ids.data(), batch_ids.size(), hash_index.data());
+    return hash_index;
+  }
+
+  std::vector<int64_t> SwapIds(const std::unique_ptr<int64_t[]> &ids, size_t size) {
+    return std::vector<int64_t>(ids.get(), ids.get() + size);
+  }
+
+  std::unique_ptr<PsCacheManager> manager_;
+};
+
+// The repeated ids of a batch share their slot, the ids out of the range of the worker get no slot.
+TEST_F(TestPsCacheManager, ParseDataBatch) {
+  InitManager(8, 100, 1000);
+  std::vector<int> batch_ids = {5, 7, 5, 1000, -1, 7, 9, 5};
+  auto hash_index = Parse(batch_ids);
+  const auto &info = manager_->statistics_info_;
+  EXPECT_EQ(info.hash_hit_count_, 0);
+  EXPECT_EQ(info.host_to_device_size_, 3);
+  EXPECT_EQ(info.device_to_host_size_, 0);
+  // every miss is looked up on the server once, in the order of the batch
+  ASSERT_EQ(info.server_to_host_size_, 3);
+  EXPECT_EQ(SwapIds(manager_->embedding_host_cache_->server_to_host_ids, 3), std::vector<int64_t>({5, 7, 9}));
+  EXPECT_EQ(hash_index[0], hash_index[2]);
+  EXPECT_EQ(hash_index[0], hash_index[7]);
+  EXPECT_EQ(hash_index[1], hash_index[5]);
+  EXPECT_EQ(hash_index[3], INVALID_INDEX_VALUE);
+  EXPECT_EQ(hash_index[4], INVALID_INDEX_VALUE);
+  EXPECT_EQ(std::set<int>({hash_index[0], hash_index[1], hash_index[6]}).size(), 3);
+  auto device_hash_map = manager_->embedding_device_cache_->device_hash_map_;
+  for (size_t i : {0, 1, 6}) {
+    EXPECT_EQ(device_hash_map->GetIndex(batch_ids[i]), hash_index[i]);
+    EXPECT_EQ(device_hash_map->hash_step(hash_index[i]), 1);
+  }
+
+  // the next step hits every id and swaps nothing
+  auto next_hash_index = Parse(batch_ids);
+  EXPECT_EQ(next_hash_index, hash_index);
+  EXPECT_EQ(info.hash_hit_count_, 3);
+  EXPECT_EQ(info.host_to_device_size_, 0);
+  EXPECT_EQ(info.server_to_host_size_, 0);
+  EXPECT_EQ(device_hash_map->hash_step(hash_index[0]), 2);
+}
+
+// The hits of a batch are marked before its misses take slots, so a miss swaps out none of the ids the batch uses.
+TEST_F(TestPsCacheManager, ParseDataSwapOut) {
+  InitManager(5, 10, 1000);
+  auto first_hash_index = Parse({0, 1, 2, 3, 4});
+  Parse({5, 6, 7, 8, 9});
+  // every slot is taken, the ids of step 1 have expired while the graph runs step 2
+  auto hash_index = Parse({0, 10, 11, 12, 13});
+  const auto &info = manager_->statistics_info_;
+  EXPECT_EQ(hash_index[0], first_hash_index[0]);
+  EXPECT_EQ(info.hash_hit_count_, 1);
+  EXPECT_EQ(info.host_to_device_size_, 4);
+  ASSERT_EQ(info.device_to_host_size_, 4);
+  auto swap_out_ids = SwapIds(manager_->embedding_device_cache_->device_to_host_ids, 4);
+  EXPECT_EQ(std::set<int64_t>(swap_out_ids.begin(), swap_out_ids.end()), std::set<int64_t>({1, 2, 3, 4}));
+  // the slots of the ids swapped out are the ones the new ids take
+  std::set<int> swap_out_index(manager_->embedding_device_cache_->device_to_host_index.get(),
+                               manager_->embedding_device_cache_->device_to_host_index.get() + 4);
+  EXPECT_EQ(swap_out_index, std::set<int>(hash_index.begin() + 1, hash_index.end()));
+  // the rows swapped out are kept in the slots of their ids in the host hash table
+  auto host_hash_map = manager_->embedding_host_cache_->host_hash_map_;
+  for (size_t i = 0; i < swap_out_ids.size(); i++) {
+    EXPECT_EQ(manager_->embedding_host_cache_->device_to_host_index[i], host_hash_map->GetIndex(swap_out_ids[i]));
+  }
+}
+
+// A small batch is parsed id by id, yet its hits are marked before its misses take slots.
+TEST_F(TestPsCacheManager, ParseDataInTurnKeepsHits) {
+  InitManager(5, 10, 1000);
+  auto first_hash_index = Parse({0, 1, 2, 3, 4});
+  Parse({5, 6, 7, 8, 9});
+  // the hit comes last and the misses repeat
+  auto hash_index = Parse({10, 11, 10, 12, 0});
+  const auto &info = manager_->statistics_info_;
+  EXPECT_EQ(hash_index[4], first_hash_index[0]);
+  EXPECT_EQ(hash_index[0], hash_index[2]);
+  EXPECT_EQ(info.hash_hit_count_, 1);
+  EXPECT_EQ(info.host_to_device_size_, 3);
+  ASSERT_EQ(info.device_to_host_size_, 3);
+  auto swap_out_ids = SwapIds(manager_->embedding_device_cache_->device_to_host_ids, 3);
+  EXPECT_EQ(std::set<int64_t>(swap_out_ids.begin(), swap_out_ids.end()).count(0), 0);
+}
+
+// The lookups of a large batch are split over the thread pool and find what the calling thread alone finds.
+TEST_F(TestPsCacheManager, ParseDataOnThreadPool) {
+  constexpr size_t kBatchSize = 5 * kParallelTaskSize;
+  InitManager(kBatchSize, 2 * kBatchSize, 10 * kBatchSize);
+  manager_->thread_pool_ = std::make_unique<ServerThreadPool>(3);
+  std::vector<int> batch_ids(kBatchSize);
+  for (size_t i = 0; i < kBatchSize; i++) {
+    batch_ids[i] = static_cast<int>((i * 7919) % (10 * kBatchSize));
+  }
+  auto hash_index = Parse(batch_ids);
+  EXPECT_EQ(manager_->statistics_info_.hash_hit_count_, 0);
+  EXPECT_EQ(manager_->statistics_info_.host_to_device_size_, kBatchSize);
+  auto next_hash_index = Parse(batch_ids);
+  EXPECT_EQ(manager_->statistics_info_.hash_hit_count_, kBatchSize);
+  EXPECT_EQ(next_hash_index, hash_index);
+}
+
+// The ids of the batches are counted for the dynamic tables of the servers, the rows of the ids seen fewer times than
+// the threshold are not pushed.
+TEST_F(TestPsCacheManager, DropNotAdmittedIds) {
+  InitManager(4, 100, 1000);
+  manager_->admit_threshold_ = 2;
+  manager_->admit_sketch_ = std::make_unique<CountMinSketch>(kAdmitSketchWidth, kAdmitSketchDepth);
+  // the hits count too
+  Parse({1, 2, 3, 3});
+  Parse({1, -1, 1000, 4});
+  PsCacheSwapPlan plan;
+  plan.host_to_server_ids = {1, 2, 3, 4, 5};
+  plan.host_to_server_index = {10, 11, 12, 13, 14};
+  manager_->DropNotAdmittedIds(&plan);
+  EXPECT_EQ(plan.host_to_server_ids, std::vector<int64_t>({1, 3}));
+  EXPECT_EQ(plan.host_to_server_index, std::vector<int>({10, 12}));
+  EXPECT_EQ(manager_->admit_sketch_->Estimate(1000), 0);
+}
+
+// The manager on the cpu cache and a stub worker. The batch of the next step is processed before the graph runs the
+// step, the rows go through the device, the host and the servers, and the graph reads the updates of the earlier steps.
+TEST_F(TestPsCacheManager, ProcessBatchWithStubWorker) {
+  constexpr size_t kSteps = 300;
+  constexpr size_t kBatchSize = 16;
+  constexpr size_t kCacheVocabSize = 64;
+  constexpr int kVocabSize = 5000;
+  constexpr size_t kEmbeddingSize = 4;
+  const std::string param_name = "embedding_table";
+  auto context = MsContext::GetInstance();
+  auto device_target = context->get_param<std::string>(MS_CTX_DEVICE_TARGET);
+  context->set_param<std::string>(MS_CTX_DEVICE_TARGET, kCPUDevice);
+  auto stub_worker = std::make_shared<StubPsCacheWorker>(kEmbeddingSize);
+  manager_.reset(new PsCacheManager());
+  manager_->set_worker(stub_worker);
+  manager_->set_batch_elements(kBatchSize);
+  manager_->InsertHashTableSize(param_name, kCacheVocabSize, kEmbeddingSize, kVocabSize);
+  manager_->Initialize();
+  manager_->InsertWeightInitInfo(param_name, 0, 0);
+  manager_->StartPipeline(0, nullptr);
+  manager_->InitParameterServer();
+  context->set_param<std::string>(MS_CTX_DEVICE_TARGET, device_target);
+  EXPECT_TRUE(stub_worker->started_);
+  auto key = stub_worker->GetParamKey(param_name);
+  EXPECT_EQ(stub_worker->row_counts_[key], kVocabSize);
+  EXPECT_EQ(stub_worker->init_keys_, std::vector<size_t>({key}));
+  EXPECT_EQ(manager_->range_bound_, std::make_pair(size_t(0), size_t(kVocabSize)));
+
+  std::mt19937 engine(2021);
+  std::uniform_int_distribution<int> distribution(0, kVocabSize - 1);
+  std::vector<std::vector<int>> batches(kSteps + 1);
+  for (size_t step = 1; step <= kSteps; step++) {
+    std::set<int> ids;
+    while (ids.size() < kBatchSize) {
+      (void)ids.insert(distribution(engine));
+    }
+    batches[step].assign(ids.begin(), ids.end());
+  }
+  // ProcessBatch replaces the ids of the batch by their slots on the device
+  std::vector<std::vector<int>> hash_index(batches);
+  auto process_batch = [this, &hash_index](size_t step) {
+    manager_->ProcessBatch(hash_index[step].data(), hash_index[step].size() * sizeof(int));
+  };
+  auto table = reinterpret_cast<float *>(manager_->QueryHashTableAddr(param_name).addr);
+  std::vector<float> updates(kVocabSize, 0);
+  process_batch(1);
+  for (size_t step = 1; step <= kSteps; step++) {
+    if (step < kSteps) {
+      process_batch(step + 1);
+    }
+    // as IncreaseGraphStep does, without the data channel
+    manager_->graph_step_++;
+    manager_->WaitSwapFinish(step);
+    for (size_t i = 0; i < batches[step].size(); i++) {
+      auto id = batches[step][i];
+      ASSERT_NE(hash_index[step][i], INVALID_INDEX_VALUE);
+      float *row = table + hash_index[step][i] * kEmbeddingSize;
+      EXPECT_EQ(row[0], id + updates[id]) << "step " << step << ", id " << id;
+      EXPECT_EQ(row[kEmbeddingSize - 1], id + updates[id]);
+      for (size_t j = 0; j < kEmbeddingSize; j++) {
+        row[j] += 1;
+      }
+      updates[id] += 1;
+    }
+  }
+  manager_->pipeline_->Stop();
+  // the host cache is too small for the ids, so the rows went to the servers and came back
+  EXPECT_GT(stub_worker->update_count_, 0);
+  EXPECT_GT(stub_worker->lookup_count_, stub_worker->update_count_);
+}
+
+// The ids are sent to the servers as int, the ones out of its range are rejected.
+TEST_F(TestPsCacheManager, ToLookupIds) {
+  std::vector<int64_t> ids = {0, 5, INT_MAX};
+  auto lookup_ids = PsCacheManager::ToLookupIds(ids.data(), ids.size());
+  ASSERT_EQ(lookup_ids.size(), ids.size());
+  for (size_t i = 0; i < ids.size(); i++) {
+    EXPECT_EQ(lookup_ids[i], ids[i]);
+  }
+  ids.push_back(static_cast<int64_t>(INT_MAX) + 1);
+  EXPECT_THROW(PsCacheManager::ToLookupIds(ids.data(), ids.size()), std::runtime_error);
+  ids = {-1};
+  EXPECT_THROW(PsCacheManager::ToLookupIds(ids.data(), ids.size()), std::runtime_error);
+}
+}  // namespace ps
+}  // namespace mindspore
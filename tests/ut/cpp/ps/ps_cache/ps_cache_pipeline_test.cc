@@ -0,0 +1,306 @@
+/**
+ * Copyright 2021 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <set>
+#include <stdexcept>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "common/common_test.h"
+#include "ps/ps_cache/embedding_hash_map.h"
+#include "ps/ps_cache/ps_cache_factory.h"
+#include "ps/ps_cache/ps_cache_pipeline.h"
+#include "utils/ms_context.h"
+
+namespace mindspore {
+namespace ps {
+class TestPsCachePipeline : public UT::Common {
+ public:
+  TestPsCachePipeline() = default;
+  virtual ~TestPsCachePipeline() = default;
+
+  void SetUp() override {}
+  void TearDown() override {}
+};
+
+TEST_F(TestPsCachePipeline, StagesInOrder) {
+  constexpr size_t kSteps = 50;
+  PsCachePipeline<size_t> pipeline(2);
+  std::vector<std::vector<size_t>> stage_steps(3);
+  std::atomic_size_t in_flight{0};
+  size_t max_in_flight = 0;
+  for (size_t i = 0; i < stage_steps.size(); i++) {
+    auto task = [&stage_steps, &in_flight, &max_in_flight, i](size_t step, const size_t &item) {
+      EXPECT_EQ(item, step * 10);
+      stage_steps[i].push_back(step);
+      if (i == 0) {
+        max_in_flight = std::max(max_in_flight, in_flight.load());
+      } else if (i == 2) {
+        in_flight--;
+      }
+    };
+    pipeline.AddStage("stage" + std::to_string(i), task);
+  }
+  pipeline.Start();
+  for (size_t step = 1; step <= kSteps; step++) {
+    in_flight++;
+    pipeline.Push(step, step * 10);
+  }
+  EXPECT_TRUE(pipeline.WaitStep(kSteps, std::chrono::seconds(10)));
+  EXPECT_EQ(pipeline.finished_step(), kSteps);
+  for (const auto &steps : stage_steps) {
+    ASSERT_EQ(steps.size(), kSteps);
+    for (size_t i = 0; i < kSteps; i++) {
+      EXPECT_EQ(steps[i], i + 1);
+    }
+  }
+  // Push blocks while two steps are in the pipeline.
+  EXPECT_LE(max_in_flight, 3);
+  pipeline.Stop();
+}
+
+// The stages work on different steps at the same time: the second stage of step 1 waits for the first stage of
+// step 2, which never happens if the stages run the steps one by one.
+TEST_F(TestPsCachePipeline, StagesOverlap) {
+  constexpr size_t kSteps = 10;
+  PsCachePipeline<size_t> pipeline(2);
+  std::mutex mutex;
+  std::condition_variable cond;
+  bool second_step_started = false;
+  bool overlapped = false;
+  pipeline.AddStage("stage0", [&](size_t step, const size_t &) {
+    if (step == 2) {
+      std::lock_guard<std::mutex> lock(mutex);
+      second_step_started = true;
+      cond.notify_all();
+    }
+  });
+  pipeline.AddStage("stage1", [&](size_t step, const size_t &) {
+    if (step == 1) {
+      std::unique_lock<std::mutex> lock(mutex);
+      overlapped = cond.wait_for(lock, std::chrono::seconds(10), [&]() { return second_step_started; });
+    }
+  });
+  pipeline.AddStage("stage2", [](size_t, const size_t &) {});
+  pipeline.Start();
+  for (size_t step = 1; step <= kSteps; step++) {
+    pipeline.Push(step, step);
+  }
+  EXPECT_TRUE(pipeline.WaitStep(kSteps, std::chrono::seconds(20)));
+  EXPECT_TRUE(overlapped);
+  pipeline.Stop();
+}
+
+TEST_F(TestPsCachePipeline, StageException) {
+  PsCachePipeline<size_t> pipeline(2);
+  pipeline.AddStage("fail", [](size_t step, const size_t &) {
+    if (step == 3) {
+      throw std::runtime_error("swap failed");
+    }
+  });
+  pipeline.Start();
+  for (size_t step = 1; step <= 3; step++) {
+    pipeline.Push(step, step);
+  }
+  EXPECT_THROW(pipeline.WaitStep(3, std::chrono::seconds(10)), std::runtime_error);
+  EXPECT_EQ(pipeline.finished_step(), 2);
+}
+
+TEST_F(TestPsCachePipeline, CpuPsCacheSwap) {
+  constexpr size_t kRows = 8;
+  constexpr size_t kEmbeddingSize = 4;
+  auto cache = PsCacheFactory::Get().ps_cache(kCPUDevice);
+  ASSERT_NE(cache, nullptr);
+  auto table = reinterpret_cast<float *>(cache->MallocMemory(kRows * kEmbeddingSize * sizeof(float)));
+  auto swap_value = reinterpret_cast<float *>(cache->MallocMemory(kRows * kEmbeddingSize * sizeof(float)));
+  auto swap_index = reinterpret_cast<int *>(cache->MallocMemory(kRows * sizeof(int)));
+  std::vector<float> values = {1, 1, 1, 1, 2, 2, 2, 2};
+  std::vector<int> index = {5, 2};
+  cache->CopyHostMemToDevice(swap_value, values.data(), values.size() * sizeof(float));
+  cache->CopyHostMemToDevice(swap_index, index.data(), index.size() * sizeof(int));
+  cache->HashSwapIn(table, swap_value, swap_index, kRows, kEmbeddingSize, index.size());
+  EXPECT_EQ(table[5 * kEmbeddingSize], 1);
+  EXPECT_EQ(table[2 * kEmbeddingSize + 3], 2);
+
+  index = {2, INVALID_INDEX_VALUE, 5};
+  cache->CopyHostMemToDevice(swap_index, index.data(), index.size() * sizeof(int));
+  cache->HashSwapOut(table, swap_value, swap_index, kRows, kEmbeddingSize, index.size());
+  std::vector<float> swap_out(index.size() * kEmbeddingSize);
+  cache->CopyDeviceMemToHost(swap_out.data(), swap_value, swap_out.size() * sizeof(float));
+  cache->SynchronizeStream();
+  EXPECT_EQ(swap_out[0], 2);
+  EXPECT_EQ(swap_out[2 * kEmbeddingSize], 1);
+}
+
+// Runs the steps of the ps cache on a host only table as PsCacheManager does: the ids are parsed ahead, the rows
+// missing in the host are pulled by the server stage and the device stage swaps the rows out and in. The graph of a
+// step waits for the swaps of the step, then it reads and updates the rows of the ids.
+TEST_F(TestPsCachePipeline, HostOnlyTable) {
+  constexpr size_t kSteps = 200;
+  constexpr size_t kBatchSize = 16;
+  constexpr size_t kCacheSize = 64;
+  constexpr int kVocabSize = 500;
+  constexpr size_t kEmbeddingSize = 4;
+  struct SwapPlan {
+    std::vector<int> swap_out_index;
+    std::vector<int64_t> swap_out_ids;
+    std::vector<int> swap_in_index;
+    std::vector<int> swap_in_ids;
+    std::vector<bool> swap_in_from_host;
+    std::vector<float> server_rows;
+  };
+  auto cache = PsCacheFactory::Get().ps_cache(kCPUDevice);
+  ASSERT_NE(cache, nullptr);
+  auto table = reinterpret_cast<float *>(cache->MallocMemory(kCacheSize * kEmbeddingSize * sizeof(float)));
+  auto swap_value = reinterpret_cast<float *>(cache->MallocMemory(kBatchSize * kEmbeddingSize * sizeof(float)));
+  auto swap_index = reinterpret_cast<int *>(cache->MallocMemory(kBatchSize * sizeof(int)));
+  EmbeddingHashMap device_hash_map(0, kCacheSize);
+  // The rows swapped out of the device, written and read by the device stage only.
+  std::unordered_map<int64_t, std::vector<float>> host_rows;
+  std::set<int64_t> host_ids;
+  std::vector<std::vector<int>> step_index(kSteps + 1);
+  std::atomic_size_t graph_step{0};
+  // Set when the graph stops early, so the parse thread returns and can be joined.
+  std::atomic_bool stopped{false};
+
+  PsCachePipeline<std::shared_ptr<SwapPlan>> pipeline(2);
+  pipeline.AddStage("server", [](size_t, const std::shared_ptr<SwapPlan> &plan) {
+    // The row of id on the server is id.
+    for (size_t i = 0; i < plan->swap_in_ids.size(); i++) {
+      if (!plan->swap_in_from_host[i]) {
+        plan->server_rows.insert(plan->server_rows.end(), kEmbeddingSize, static_cast<float>(plan->swap_in_ids[i]));
+      }
+    }
+  });
+  pipeline.AddStage("device", [&](size_t, const std::shared_ptr<SwapPlan> &plan) {
+    std::vector<float> values(kBatchSize * kEmbeddingSize);
+    auto swap_out_size = plan->swap_out_index.size();
+    if (swap_out_size > 0) {
+      cache->CopyHostMemToDevice(swap_index, plan->swap_out_index.data(), swap_out_size * sizeof(int));
+      cache->HashSwapOut(table, swap_value, swap_index, kCacheSize, kEmbeddingSize, swap_out_size);
+      cache->CopyDeviceMemToHost(values.data(), swap_value, swap_out_size * kEmbeddingSize * sizeof(float));
+      for (size_t i = 0; i < plan->swap_out_ids.size(); i++) {
+        auto row = values.begin() + i * kEmbeddingSize;
+        host_rows[plan->swap_out_ids[i]].assign(row, row + kEmbeddingSize);
+      }
+    }
+    size_t server_pos = 0;
+    for (size_t i = 0; i < plan->swap_in_ids.size(); i++) {
+      const float *row = plan->server_rows.data() + server_pos;
+      if (plan->swap_in_from_host[i]) {
+        row = host_rows.at(plan->swap_in_ids[i]).data();
+      } else {
+        server_pos += kEmbeddingSize;
+      }
+      std::copy(row, row + kEmbeddingSize, values.begin() + i * kEmbeddingSize);
+    }
+    cache->CopyHostMemToDevice(swap_value, values.data(), plan->swap_in_ids.size() * kEmbeddingSize * sizeof(float));
+    cache->CopyHostMemToDevice(swap_index, plan->swap_in_index.data(), plan->swap_in_index.size() * sizeof(int));
+    cache->HashSwapIn(table, swap_value, swap_index, kCacheSize, kEmbeddingSize, plan->swap_in_index.size());
+    cache->SynchronizeStream();
+  });
+  pipeline.Start();
+
+  std::mt19937 engine(2021);
+  std::uniform_int_distribution<int> distribution(0, kVocabSize - 1);
+  std::vector<std::vector<int>> batches(kSteps + 1);
+  for (size_t step = 1; step <= kSteps; step++) {
+    std::set<int> ids;
+    while (ids.size() < kBatchSize) {
+      (void)ids.insert(distribution(engine));
+    }
+    batches[step].assign(ids.begin(), ids.end());
+  }
+  // Parses the ids ahead of the graph, the slots of the steps from the graph step on are kept.
+  auto parse_task = [&]() {
+    for (size_t step = 1; step <= kSteps; step++) {
+      auto plan = std::make_shared<SwapPlan>();
+      plan->swap_out_index.resize(kBatchSize);
+      plan->swap_out_ids.resize(kBatchSize);
+      size_t swap_out_size = 0;
+      // The hits are marked with the step first, so they are not swapped out by the misses.
+      for (auto id : batches[step]) {
+        int index = device_hash_map.GetIndex(id);
+        if (index != INVALID_INDEX_VALUE) {
+          device_hash_map.set_hash_step(index, step);
+        }
+        step_index[step].push_back(index);
+      }
+      for (size_t i = 0; i < batches[step].size(); i++) {
+        auto id = batches[step][i];
+        if (step_index[step][i] != INVALID_INDEX_VALUE) {
+          continue;
+        }
+        int index;
+        while ((index = device_hash_map.ParseData(id, plan->swap_out_index.data(), plan->swap_out_ids.data(), step,
+                                                  graph_step, &swap_out_size)) == INVALID_INDEX_VALUE) {
+          if (stopped) {
+            return;
+          }
+          std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        step_index[step][i] = index;
+        plan->swap_in_index.push_back(index);
+        plan->swap_in_ids.push_back(id);
+        plan->swap_in_from_host.push_back(host_ids.count(id) != 0);
+      }
+      plan->swap_out_index.resize(swap_out_size);
+      plan->swap_out_ids.resize(swap_out_size);
+      host_ids.insert(plan->swap_out_ids.begin(), plan->swap_out_ids.end());
+      try {
+        pipeline.Push(step, plan);
+      } catch (const std::exception &) {
+        // the pipeline failed or was stopped, the graph reports it
+        return;
+      }
+    }
+  };
+  std::thread parse_thread(parse_task);
+
+  std::vector<float> updates(kVocabSize, 0);
+  for (size_t step = 1; step <= kSteps; step++) {
+    graph_step = step;
+    bool step_finished = false;
+    EXPECT_NO_THROW(step_finished = pipeline.WaitStep(step, std::chrono::seconds(10)));
+    EXPECT_TRUE(step_finished) << "step " << step;
+    if (!step_finished) {
+      break;
+    }
+    for (size_t i = 0; i < batches[step].size(); i++) {
+      auto id = batches[step][i];
+      float *row = table + step_index[step][i] * kEmbeddingSize;
+      EXPECT_EQ(row[0], id + updates[id]) << "step " << step << ", id " << id;
+      EXPECT_EQ(row[kEmbeddingSize - 1], id + updates[id]);
+      for (size_t j = 0; j < kEmbeddingSize; j++) {
+        row[j] += 1;
+      }
+      updates[id] += 1;
+    }
+  }
+  stopped = true;
+  pipeline.Stop();
+  parse_thread.join();
+  EXPECT_GT(host_ids.size(), 0);
+}
+}  // namespace ps
+}  // namespace mindspore
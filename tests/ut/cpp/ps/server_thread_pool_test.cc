@@ -0,0 +1,94 @@
+/**
+ * Copyright 2021 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <atomic>
+#include <future>
+#include <mutex>
+#include <vector>
+#include "common/common_test.h"
+#include "ps/server_thread_pool.h"
+
+namespace mindspore {
+namespace ps {
+class TestServerThreadPool : public UT::Common {
+ public:
+  TestServerThreadPool() = default;
+  virtual ~TestServerThreadPool() = default;
+
+  void SetUp() override {}
+  void TearDown() override {}
+};
+
+TEST_F(TestServerThreadPool, Submit) {
+  ServerThreadPool pool(4);
+  std::atomic<int> count{0};
+  std::vector<std::future<void>> futures;
+  for (int i = 0; i < 100; i++) {
+    auto done = std::make_shared<std::promise<void>>();
+    futures.push_back(done->get_future());
+    pool.Submit([&count, done]() {
+      count++;
+      done->set_value();
+    });
+  }
+  for (auto &future : futures) {
+    future.wait();
+  }
+  EXPECT_EQ(count, 100);
+}
+
+TEST_F(TestServerThreadPool, ParallelFor) {
+  ServerThreadPool pool(3);
+  std::vector<int> visits(1000, 0);
+  pool.ParallelFor(visits.size(), [&visits](size_t i) { visits[i]++; });
+  for (auto visit : visits) {
+    EXPECT_EQ(visit, 1);
+  }
+  pool.ParallelFor(0, [](size_t i) { FAIL(); });
+}
+
+TEST_F(TestServerThreadPool, ParallelForOnBusyPool) {
+  ServerThreadPool pool(2);
+  std::promise<void> release;
+  auto released = release.get_future().share();
+  for (size_t i = 0; i < pool.thread_num(); i++) {
+    pool.Submit([released]() { released.wait(); });
+  }
+  // every thread of the pool is blocked, the calling thread runs all of the tasks
+  std::atomic<int> count{0};
+  pool.ParallelFor(10, [&count](size_t i) { count++; });
+  EXPECT_EQ(count, 10);
+  release.set_value();
+}
+
+// keys in one shard share a mutex, so a key locked on one thread blocks the keys of its shard only
+TEST_F(TestServerThreadPool, KeyLocks) {
+  KeyLocks key_locks;
+  EXPECT_EQ(&key_locks[3], &key_locks[3 + kKeyLockNum]);
+  EXPECT_NE(&key_locks[3], &key_locks[4]);
+  auto try_lock = [&key_locks](uint64_t key) {
+    bool locked = key_locks[key].try_lock();
+    if (locked) {
+      key_locks[key].unlock();
+    }
+    return locked;
+  };
+  std::unique_lock<std::mutex> lock(key_locks[3]);
+  EXPECT_TRUE(std::async(std::launch::async, try_lock, 4).get());
+  EXPECT_FALSE(std::async(std::launch::async, try_lock, 3 + kKeyLockNum).get());
+}
+}  // namespace ps
+}  // namespace mindspore
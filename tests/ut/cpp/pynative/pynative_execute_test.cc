@@ -14,12 +14,21 @@
  * limitations under the License.
  */
 #include <iostream>
+#include <map>
 #include <memory>
+#include <set>
+#include <stack>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
 #include "common/common_test.h"
 #include "pipeline/jit/parse/python_adapter.h"
 #include "pipeline/jit/parse/data_converter.h"
 #include "frontend/operator/ops.h"
+#define private public
 #include "pipeline/pynative/pynative_execute.h"
+#undef private
 #include "utils/ms_context.h"
 #include "utils/utils.h"
 
@@ -68,6 +77,92 @@ OpExecInfoPtr ConstructOpExecInfo() {
   return PynativeExecutor::GetInstance()->GenerateOpExecInfo(args);
 }
 
+// Infer the output of the op like RunOpInner, the abstract is cached on a miss, and the graph info the op would run
+// with is built. Return whether the abstract was found in the cache.
+bool InferOp(const py::object &prim, const std::string &op_name, const py::tuple &op_inputs, ShapeVector *shape,
+             std::string *graph_info) {
+  auto executor = PynativeExecutor::GetInstance();
+  auto op_exec_info = executor->GenerateOpExecInfo(py::make_tuple(prim, op_name, op_inputs));
+  abstract::AbstractBasePtrList args_spec_list;
+  std::vector<bool> op_masks;
+  (void)executor->MakeCNode(op_exec_info, &op_masks, &args_spec_list);
+  op_exec_info->inputs_mask = op_masks;
+  bool is_find = false;
+  executor->GetOpOutputAbstract(op_exec_info, args_spec_list, &is_find);
+  bool add_to_cache = !is_find && !op_exec_info->is_dynamic_shape;
+  if (add_to_cache) {
+    executor->CacheOpOutputAbstract(op_exec_info, args_spec_list);
+  }
+  *graph_info = GetSingleOpGraphInfo(op_exec_info, {});
+  if (add_to_cache) {
+    executor->CacheGraphInfoSuffix(op_exec_info, args_spec_list);
+  }
+  auto output_shape = op_exec_info->abstract->BuildShape()->cast<abstract::ShapePtr>();
+  MS_EXCEPTION_IF_NULL(output_shape);
+  *shape = output_shape->shape();
+  return is_find;
+}
+
+// The output shape of DropoutGenMask depends on the values of its shape input, it is inferred again on each hit.
+TEST_F(TestPynativeExecute, TestForceInferPrimCache) {
+  py::object mask_prim = py::module::import("mindspore.ops.operations").attr("DropoutGenMask")();
+  py::object tensor_py_module = py::module::import("mindspore.common.tensor").attr("Tensor");
+  py::object float32 = py::module::import("mindspore.common.dtype").attr("float32");
+  py::object keep_prob = tensor_py_module(0.5, float32);
+  py::tuple small_inputs = py::make_tuple(py::make_tuple(2, 4), keep_prob);
+  py::tuple large_inputs = py::make_tuple(py::make_tuple(16, 16), keep_prob);
+
+  ShapeVector shape;
+  std::string small_graph_info;
+  std::string large_graph_info;
+  std::string graph_info;
+  ASSERT_FALSE(InferOp(mask_prim, "DropoutGenMask", small_inputs, &shape, &small_graph_info));
+  // 16 bytes of mask per 128 elements
+  ASSERT_EQ(shape, ShapeVector{16});
+  ASSERT_TRUE(InferOp(mask_prim, "DropoutGenMask", small_inputs, &shape, &graph_info));
+  ASSERT_EQ(shape, ShapeVector{16});
+  ASSERT_EQ(graph_info, small_graph_info);
+  ASSERT_FALSE(InferOp(mask_prim, "DropoutGenMask", large_inputs, &shape, &large_graph_info));
+  ASSERT_EQ(shape, ShapeVector{32});
+  ASSERT_NE(large_graph_info, small_graph_info);
+  ASSERT_TRUE(InferOp(mask_prim, "DropoutGenMask", small_inputs, &shape, &graph_info));
+  ASSERT_EQ(shape, ShapeVector{16});
+  ASSERT_EQ(graph_info, small_graph_info);
+  ASSERT_TRUE(InferOp(mask_prim, "DropoutGenMask", large_inputs, &shape, &graph_info));
+  ASSERT_EQ(shape, ShapeVector{32});
+  ASSERT_EQ(graph_info, large_graph_info);
+}
+
+// An attr set between two calls of the same prim on the same inputs misses the cache, and changes the op graph run.
+TEST_F(TestPynativeExecute, TestAttrChangedPrimCache) {
+  py::object reduce_sum = py::module::import("mindspore.ops.operations").attr("ReduceSum")(false);
+  py::object tensor_py_module = py::module::import("mindspore.common.tensor").attr("Tensor");
+  py::object np_py_module = py::module::import("numpy");
+  py::object x = tensor_py_module(np_py_module.attr("ones")(py::make_tuple(2, 3), np_py_module.attr("float32")));
+  py::tuple inputs = py::make_tuple(x, 1);
+
+  ShapeVector shape;
+  std::string graph_info;
+  std::string keep_dims_graph_info;
+  std::string cached_graph_info;
+  ASSERT_FALSE(InferOp(reduce_sum, "ReduceSum", inputs, &shape, &graph_info));
+  ASSERT_EQ(shape, ShapeVector{2});
+  ASSERT_TRUE(InferOp(reduce_sum, "ReduceSum", inputs, &shape, &cached_graph_info));
+  ASSERT_EQ(shape, ShapeVector{2});
+  ASSERT_EQ(cached_graph_info, graph_info);
+
+  auto prim = py::cast<PrimitivePyPtr>(reduce_sum);
+  auto attr_version = prim->attr_version();
+  (void)reduce_sum.attr("add_prim_attr")("keep_dims", true);
+  ASSERT_GT(prim->attr_version(), attr_version);
+  ASSERT_FALSE(InferOp(reduce_sum, "ReduceSum", inputs, &shape, &keep_dims_graph_info));
+  ASSERT_EQ(shape, (ShapeVector{2, 1}));
+  ASSERT_NE(keep_dims_graph_info, graph_info);
+  ASSERT_TRUE(InferOp(reduce_sum, "ReduceSum", inputs, &shape, &cached_graph_info));
+  ASSERT_EQ(shape, (ShapeVector{2, 1}));
+  ASSERT_EQ(cached_graph_info, keep_dims_graph_info);
+}
+
 TEST_F(TestPynativeExecute, TestCreateContext) {
   auto ctx3 = MsContext::GetInstance();
   ASSERT_EQ(ctx3->backend_policy(), "vm");
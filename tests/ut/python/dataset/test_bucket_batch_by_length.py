@@ -496,6 +496,63 @@ def test_bucket_batch_invalid_column():
         assert "BucketBatchByLength: Couldn't find the specified column in the dataset" in str(info.value)
 
 
+def test_bucket_batch_max_tokens_per_batch():
+    dataset = ds.GeneratorDataset((lambda: generate_sequential(10)), ["col1"])
+
+    # lengths 1 to 10, each batch must fit 12 tokens once padded to its longest row
+    dataset = dataset.bucket_batch_by_length(["col1"], [], [], max_tokens_per_batch=12, lookahead_rows=100)
+
+    expected_shapes = [(3, 3), (2, 5), (1, 6), (1, 7), (1, 8), (1, 9), (1, 10)]
+    expected_first_batch = [[0, 0, 0],
+                            [0, 1, 0],
+                            [0, 1, 2]]
+
+    output = []
+    for data in dataset.create_dict_iterator(num_epochs=1, output_numpy=True):
+        output.append(data["col1"])
+
+    assert len(output) == len(expected_shapes)
+    for batch, shape in zip(output, expected_shapes):
+        assert batch.shape == shape
+        assert batch.shape[0] * batch.shape[1] <= 12 or batch.shape[0] == 1
+    np.testing.assert_array_equal(output[0], expected_first_batch)
+
+
+def test_bucket_batch_max_tokens_per_batch_drop_remainder():
+    dataset = ds.GeneratorDataset((lambda: generate_sequential(10)), ["col1"])
+
+    # the last batch of the epoch does not fill the budget and is dropped
+    dataset = dataset.bucket_batch_by_length(["col1"], [], [], drop_remainder=True,
+                                             max_tokens_per_batch=12, lookahead_rows=100)
+
+    num_batches = 0
+    for data in dataset.create_dict_iterator(num_epochs=1, output_numpy=True):
+        assert data["col1"].shape[1] < 10
+        num_batches += 1
+
+    assert num_batches == 6
+
+
+def test_bucket_batch_max_tokens_per_batch_invalid_input():
+    dataset = ds.GeneratorDataset((lambda: generate_sequential(10)), ["col1"])
+
+    with pytest.raises(ValueError) as info:
+        _ = dataset.bucket_batch_by_length(["col1"], [1, 2], [1, 2, 3], max_tokens_per_batch=12)
+    assert "must be empty when max_tokens_per_batch is set" in str(info.value)
+
+    with pytest.raises(ValueError) as info:
+        _ = dataset.bucket_batch_by_length(["col1"], [], [], pad_to_bucket_boundary=True, max_tokens_per_batch=12)
+    assert "pad_to_bucket_boundary can not be used with max_tokens_per_batch" in str(info.value)
+
+    with pytest.raises(ValueError) as info:
+        _ = dataset.bucket_batch_by_length(["col1"], [], [], max_tokens_per_batch=-1)
+    assert "max_tokens_per_batch" in str(info.value)
+
+    with pytest.raises(ValueError) as info:
+        _ = dataset.bucket_batch_by_length(["col1"], [], [], max_tokens_per_batch=12, lookahead_rows=0)
+    assert "lookahead_rows" in str(info.value)
+
+
 if __name__ == '__main__':
     test_bucket_batch_invalid_input()
     test_bucket_batch_multi_bucket_no_padding()
@@ -511,3 +568,6 @@ if __name__ == '__main__':
     test_bucket_batch_three_columns()
     test_bucket_batch_get_dataset_size()
     test_bucket_batch_invalid_column()
+    test_bucket_batch_max_tokens_per_batch()
+    test_bucket_batch_max_tokens_per_batch_drop_remainder()
+    test_bucket_batch_max_tokens_per_batch_invalid_input()
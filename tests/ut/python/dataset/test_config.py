@@ -386,6 +386,36 @@ def test_auto_num_workers():
     assert saved_config == ds.config.get_auto_num_workers()
 
 
+def test_numa_policy():
+    """
+    Test numa policy can be set and the pipeline runs under each policy.
+    """
+    saved_policy, saved_node_set = ds.config.get_numa_policy()
+    assert saved_policy == "none"
+    for policy in ["compact", "spread"]:
+        ds.config.set_numa_policy(policy)
+        assert ds.config.get_numa_policy() == (policy, [])
+        data = ds.TFRecordDataset(DATA_DIR, SCHEMA_DIR, shuffle=False)
+        data = data.map(operations=[c_vision.Decode()], input_columns=["image"], num_parallel_workers=2)
+        assert sum(1 for _ in data.create_dict_iterator(num_epochs=1, output_numpy=True)) == 3
+    ds.config.set_numa_policy(saved_policy, saved_node_set)
+    assert ds.config.get_numa_policy() == (saved_policy, saved_node_set)
+
+
+def test_numa_policy_error():
+    """
+    Test numa policy with invalid input
+    """
+    for policy, node_set in [("local", None), (1, None), ("compact", 0), ("spread", [0, -1]), ("spread", [True])]:
+        err_msg = ""
+        try:
+            ds.config.set_numa_policy(policy, node_set)
+        except ValueError as e:
+            err_msg = str(e)
+        assert "policy should be one of" in err_msg or "node_set should be a list" in err_msg
+    assert ds.config.get_numa_policy() == ("none", [])
+
+
 if __name__ == '__main__':
     test_basic()
     test_get_seed()
@@ -398,3 +428,5 @@ if __name__ == '__main__':
     test_deterministic_python_seed_multi_thread()
     test_auto_num_workers_error()
     test_auto_num_workers()
+    test_numa_policy()
+    test_numa_policy_error()
@@ -17,6 +17,7 @@ Testing profiling support in DE
 """
 import json
 import os
+import time
 import numpy as np
 import mindspore.dataset as ds
 
@@ -26,6 +27,14 @@ SCHEMA_FILE = "../data/dataset/testTFTestAllTypes/datasetSchema.json"
 
 PIPELINE_FILE = "./pipeline_profiling_1.json"
 DATASET_ITERATOR_FILE = "./dataset_iterator_profiling_1.txt"
+ANALYSIS_FILE = "./pipeline_analysis_1.json"
+ANALYSIS_TEXT_FILE = "./pipeline_analysis_1.txt"
+
+
+def remove_analysis_files():
+    for file in [ANALYSIS_FILE, ANALYSIS_TEXT_FILE]:
+        if os.path.exists(file):
+            os.remove(file)
 
 
 def test_profiling_simple_pipeline():
@@ -48,6 +57,7 @@ def test_profiling_simple_pipeline():
     os.remove(PIPELINE_FILE)
     assert os.path.exists(DATASET_ITERATOR_FILE) is True
     os.remove(DATASET_ITERATOR_FILE)
+    remove_analysis_files()
     del os.environ['PROFILING_MODE']
     del os.environ['MINDDATA_PROFILING_DIR']
 
@@ -88,6 +98,7 @@ def test_profiling_complex_pipeline():
     os.remove(PIPELINE_FILE)
     assert os.path.exists(DATASET_ITERATOR_FILE) is True
     os.remove(DATASET_ITERATOR_FILE)
+    remove_analysis_files()
     del os.environ['PROFILING_MODE']
     del os.environ['MINDDATA_PROFILING_DIR']
 
@@ -117,13 +128,56 @@ def test_profiling_sampling_iterval():
     os.remove(PIPELINE_FILE)
     assert os.path.exists(DATASET_ITERATOR_FILE) is True
     os.remove(DATASET_ITERATOR_FILE)
+    remove_analysis_files()
 
     ds.config.set_monitor_sampling_interval(interval_origin)
     del os.environ['PROFILING_MODE']
     del os.environ['MINDDATA_PROFILING_DIR']
 
 
+def test_profiling_analyzer_slow_map():
+    """
+    Generator -> Map (deliberately slowed) -> Batch, the analyzer must report the map op as the bottleneck
+    """
+    os.environ['PROFILING_MODE'] = 'true'
+    os.environ['MINDDATA_PROFILING_DIR'] = '.'
+    os.environ['DEVICE_ID'] = '1'
+
+    def slow_op(x):
+        time.sleep(0.005)
+        return x
+
+    source = [(np.array([x]),) for x in range(256)]
+    data1 = ds.GeneratorDataset(source, ["data"])
+    data1 = data1.map(operations=[slow_op], input_columns=["data"], num_parallel_workers=1)
+    data1 = data1.batch(8)
+
+    for _ in data1.create_tuple_iterator(num_epochs=1):
+        pass
+
+    with open(ANALYSIS_FILE) as f:
+        reports = json.load(f)
+    # The first report covers the epoch, a short one may follow for the shutdown of the pipeline
+    assert reports
+    report = reports[0]
+    op_types = {op["op_id"]: op["op_type"] for op in report["op_info"]}
+    assert op_types[report["bottleneck_op_id"]] == "MapOp"
+    assert not report["consumer_bound"]
+    suggestion = report["suggestions"][0]
+    assert suggestion["setting"] == "num_parallel_workers"
+    assert suggestion["current"] == 1
+    assert suggestion["suggested"] > 1
+    assert os.path.exists(ANALYSIS_TEXT_FILE) is True
+
+    os.remove(PIPELINE_FILE)
+    os.remove(DATASET_ITERATOR_FILE)
+    remove_analysis_files()
+    del os.environ['PROFILING_MODE']
+    del os.environ['MINDDATA_PROFILING_DIR']
+
+
 if __name__ == "__main__":
     test_profiling_simple_pipeline()
     test_profiling_complex_pipeline()
     test_profiling_sampling_iterval()
+    test_profiling_analyzer_slow_map()